@@ -7,7 +7,26 @@
 
 # Device Defender library source files.
 set( DEFENDER_SOURCES
-     "${CMAKE_CURRENT_LIST_DIR}/source/defender.c" )
+     "${CMAKE_CURRENT_LIST_DIR}/source/defender.c"
+     "${CMAKE_CURRENT_LIST_DIR}/source/defender_topic_table.c"
+     "${CMAKE_CURRENT_LIST_DIR}/source/defender_bulk.c"
+     "${CMAKE_CURRENT_LIST_DIR}/source/defender_response.c"
+     "${CMAKE_CURRENT_LIST_DIR}/source/defender_index.c"
+     "${CMAKE_CURRENT_LIST_DIR}/source/defender_connection_table.c"
+     "${CMAKE_CURRENT_LIST_DIR}/source/defender_sort.c"
+     "${CMAKE_CURRENT_LIST_DIR}/source/defender_escape.c"
+     "${CMAKE_CURRENT_LIST_DIR}/source/defender_writer.c"
+     "${CMAKE_CURRENT_LIST_DIR}/source/defender_metric_segment.c"
+     "${CMAKE_CURRENT_LIST_DIR}/source/defender_netstat.c"
+     "${CMAKE_CURRENT_LIST_DIR}/source/defender_flow_table.c"
+     "${CMAKE_CURRENT_LIST_DIR}/source/defender_rate.c"
+     "${CMAKE_CURRENT_LIST_DIR}/source/defender_thing_store.c"
+     "${CMAKE_CURRENT_LIST_DIR}/source/defender_slab.c"
+     "${CMAKE_CURRENT_LIST_DIR}/source/defender_history.c"
+     "${CMAKE_CURRENT_LIST_DIR}/source/defender_name_dict.c"
+     "${CMAKE_CURRENT_LIST_DIR}/source/defender_name_filter.c"
+     "${CMAKE_CURRENT_LIST_DIR}/source/defender_bound_matcher.c"
+     "${CMAKE_CURRENT_LIST_DIR}/source/defender_retry.c" )
 
 # Device Defender library public include directories.
 set( DEFENDER_INCLUDE_PUBLIC_DIRS
@@ -36,6 +36,26 @@
 /* Defender API include. */
 #include "defender.h"
 
+/**
+ * @brief Mask and value of the packet type in the first byte of an MQTT
+ * packet.
+ */
+#define MQTT_PACKET_TYPE_MASK         0xF0U
+#define MQTT_PACKET_TYPE_PUBLISH      0x30U
+
+/**
+ * @brief Mask and position of the QoS in the first byte of a PUBLISH packet.
+ */
+#define MQTT_PUBLISH_QOS_MASK         0x06U
+#define MQTT_PUBLISH_QOS_SHIFT        1U
+
+/**
+ * @brief Length of the topic length and of the packet identifier in the
+ * variable header of a PUBLISH packet.
+ */
+#define MQTT_TOPIC_LENGTH_LENGTH      2U
+#define MQTT_PACKET_ID_LENGTH         2U
+
 /**
  * @brief Get the topic length for a given defender API.
  *
@@ -62,6 +82,24 @@ static uint16_t getTopicLength( uint16_t thingNameLength,
 static void writeFormatAndSuffix( char * pBuffer,
                                   DefenderTopic_t api );
 
+/**
+ * @brief Check if a part of a topic is equal to a literal.
+ *
+ * With #DEFENDER_USE_WORD_COMPARE set to 1, the part and the literal are
+ * compared 8 bytes at a time, and the last 8 bytes overlap the previous ones
+ * when the length is not a multiple of 8. The literal loads are constant, so
+ * a 12 byte literal takes two loads, two XORs and an OR.
+ *
+ * @param[in] pTopic Starting location of the part of the topic.
+ * @param[in] pLiteral The literal.
+ * @param[in] length The length of the literal, at least 8.
+ *
+ * @return 1 if they are equal; 0 otherwise.
+ */
+static uint8_t matchLiteral( const char * pTopic,
+                             const char * pLiteral,
+                             size_t length );
+
 /**
  * @brief Check if the unparsed topic so far starts with the defender prefix.
  *
@@ -254,6 +292,39 @@ static void writeFormatAndSuffix( char * pBuffer,
 }
 /*-----------------------------------------------------------*/
 
+static uint8_t matchLiteral( const char * pTopic,
+                             const char * pLiteral,
+                             size_t length )
+{
+    uint8_t isEqual;
+
+    #if ( DEFENDER_USE_WORD_COMPARE == 1 )
+        uint64_t topicWord, literalWord, difference = 0U;
+        size_t offset;
+
+        assert( length >= sizeof( uint64_t ) );
+
+        for( offset = 0U; ( offset + sizeof( uint64_t ) ) < length; offset += sizeof( uint64_t ) )
+        {
+            ( void ) memcpy( &( topicWord ), &( pTopic[ offset ] ), sizeof( uint64_t ) );
+            ( void ) memcpy( &( literalWord ), &( pLiteral[ offset ] ), sizeof( uint64_t ) );
+            difference |= topicWord ^ literalWord;
+        }
+
+        offset = length - sizeof( uint64_t );
+        ( void ) memcpy( &( topicWord ), &( pTopic[ offset ] ), sizeof( uint64_t ) );
+        ( void ) memcpy( &( literalWord ), &( pLiteral[ offset ] ), sizeof( uint64_t ) );
+        difference |= topicWord ^ literalWord;
+
+        isEqual = ( difference == 0U ) ? 1U : 0U;
+    #else
+        isEqual = ( memcmp( pTopic, pLiteral, length ) == 0 ) ? 1U : 0U;
+    #endif
+
+    return isEqual;
+}
+/*-----------------------------------------------------------*/
+
 static DefenderStatus_t matchPrefix( const char * pRemainingTopic,
                                      uint16_t remainingTopicLength )
 {
@@ -263,9 +334,9 @@ static DefenderStatus_t matchPrefix( const char * pRemainingTopic,
 
     if( remainingTopicLength >= DEFENDER_API_LENGTH_PREFIX )
     {
-        if( strncmp( pRemainingTopic,
-                     DEFENDER_API_PREFIX,
-                     ( size_t ) DEFENDER_API_LENGTH_PREFIX ) == 0 )
+        if( matchLiteral( pRemainingTopic,
+                          DEFENDER_API_PREFIX,
+                          ( size_t ) DEFENDER_API_LENGTH_PREFIX ) == 1U )
         {
             ret = DefenderSuccess;
         }
@@ -314,9 +385,9 @@ static DefenderStatus_t matchBridge( const char * pRemainingTopic,
 
     if( remainingTopicLength >= DEFENDER_API_LENGTH_BRIDGE )
     {
-        if( strncmp( pRemainingTopic,
-                     DEFENDER_API_BRIDGE,
-                     ( size_t ) DEFENDER_API_LENGTH_BRIDGE ) == 0 )
+        if( matchLiteral( pRemainingTopic,
+                          DEFENDER_API_BRIDGE,
+                          ( size_t ) DEFENDER_API_LENGTH_BRIDGE ) == 1U )
         {
             ret = DefenderSuccess;
         }
@@ -462,6 +533,32 @@ DefenderStatus_t Defender_GetTopic( char * pBuffer,
 }
 /*-----------------------------------------------------------*/
 
+DefenderStatus_t Defender_GetTopicLength( uint16_t thingNameLength,
+                                          DefenderTopic_t api,
+                                          uint16_t * pOutLength )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+
+    if( ( thingNameLength == 0U ) || ( thingNameLength > DEFENDER_THINGNAME_MAX_LENGTH ) ||
+        ( api <= DefenderInvalidTopic ) || ( api >= DefenderMaxTopic ) ||
+        ( pOutLength == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. thingNameLength: %u, api: %d, pOutLength: %p.",
+                    ( unsigned int ) thingNameLength,
+                    api,
+                    ( void * ) pOutLength ) );
+    }
+    else
+    {
+        *pOutLength = getTopicLength( thingNameLength, api );
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
 DefenderStatus_t Defender_MatchTopic( const char * pTopic,
                                       uint16_t topicLength,
                                       DefenderTopic_t * pOutApi,
@@ -571,3 +668,66 @@ DefenderStatus_t Defender_MatchTopic( const char * pTopic,
     return ret;
 }
 /*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_MatchPublish( uint8_t packetType,
+                                        const uint8_t * pVariableHeader,
+                                        uint32_t length,
+                                        DefenderTopic_t * pOutApi,
+                                        const char ** ppOutThingName,
+                                        uint16_t * pOutThingNameLength,
+                                        uint32_t * pOutPayloadOffset )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    uint32_t qos = 0U, topicLength = 0U, payloadOffset = 0U;
+
+    if( ( pVariableHeader == NULL ) || ( pOutApi == NULL ) || ( pOutPayloadOffset == NULL ) ||
+        ( ( packetType & MQTT_PACKET_TYPE_MASK ) != MQTT_PACKET_TYPE_PUBLISH ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. packetType: 0x%02X, pVariableHeader: %p, pOutApi: %p, pOutPayloadOffset: %p.",
+                    ( unsigned int ) packetType,
+                    ( const void * ) pVariableHeader,
+                    ( void * ) pOutApi,
+                    ( void * ) pOutPayloadOffset ) );
+    }
+    else
+    {
+        qos = ( ( uint32_t ) packetType & MQTT_PUBLISH_QOS_MASK ) >> MQTT_PUBLISH_QOS_SHIFT;
+
+        if( length >= MQTT_TOPIC_LENGTH_LENGTH )
+        {
+            /* The topic length is big endian. */
+            topicLength = ( ( uint32_t ) pVariableHeader[ 0 ] << 8 ) | ( uint32_t ) pVariableHeader[ 1 ];
+            payloadOffset = MQTT_TOPIC_LENGTH_LENGTH + topicLength + ( ( qos > 0U ) ? MQTT_PACKET_ID_LENGTH : 0U );
+        }
+
+        if( ( qos > 2U ) || ( length < MQTT_TOPIC_LENGTH_LENGTH ) || ( length < payloadOffset ) )
+        {
+            ret = DefenderError;
+            LogError( ( "Malformed PUBLISH packet. packetType: 0x%02X, length: %u, topicLength: %u.",
+                        ( unsigned int ) packetType,
+                        ( unsigned int ) length,
+                        ( unsigned int ) topicLength ) );
+        }
+    }
+
+    if( ret == DefenderSuccess )
+    {
+        /* The topic is matched in place. Its bytes are UTF-8, the same as the
+         * bytes of a topic string. */
+        ret = Defender_MatchTopic( ( const char * ) &( pVariableHeader[ MQTT_TOPIC_LENGTH_LENGTH ] ),
+                                   ( uint16_t ) topicLength,
+                                   pOutApi,
+                                   ppOutThingName,
+                                   pOutThingNameLength );
+    }
+
+    if( ret == DefenderSuccess )
+    {
+        *pOutPayloadOffset = payloadOffset;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,220 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_bound_matcher.c
+ * @brief Implementation of the matcher of the Device Defender topics of one
+ * thing.
+ */
+
+/* Standard includes. */
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Bound matcher include. */
+#include "defender_bound_matcher.h"
+
+/**
+ * @brief Distance from the end of a response topic to the first letter of
+ * "accepted" or "rejected".
+ */
+#define BOUND_MATCHER_SUFFIX_DISTANCE    ( DEFENDER_API_LENGTH_ACCEPTED_SUFFIX - 1U )
+
+/**
+ * @brief Get the key of a topic in the table of a bound matcher.
+ *
+ * The first letter of the report format tells "json" from "cbor", and the
+ * letter #BOUND_MATCHER_SUFFIX_DISTANCE bytes from the end tells "accepted"
+ * from "rejected". In publish topics, that letter is in the bridge, and is
+ * the same for both formats. The low bits of the two letters combined are
+ * different for the topics of the same length.
+ *
+ * @param[in] pMatcher The bound matcher.
+ * @param[in] pTopic The topic.
+ * @param[in] topicLength The length of the topic, either the publish or the
+ * response topic length.
+ *
+ * @return The key, less than #DEFENDER_BOUND_MATCHER_KEY_COUNT.
+ */
+static uint8_t getKey( const DefenderBoundMatcher_t * pMatcher,
+                       const char * pTopic,
+                       uint16_t topicLength );
+
+/*-----------------------------------------------------------*/
+
+static uint8_t getKey( const DefenderBoundMatcher_t * pMatcher,
+                       const char * pTopic,
+                       uint16_t topicLength )
+{
+    uint16_t formatOffset = pMatcher->publishLength - DEFENDER_API_LENGTH_JSON_FORMAT;
+    uint8_t key;
+
+    assert( topicLength >= pMatcher->publishLength );
+
+    key = ( uint8_t ) pTopic[ formatOffset ] ^ ( uint8_t ) pTopic[ topicLength - BOUND_MATCHER_SUFFIX_DISTANCE ];
+
+    return ( uint8_t ) ( key % DEFENDER_BOUND_MATCHER_KEY_COUNT );
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_BoundMatcherInit( DefenderBoundMatcher_t * pMatcher,
+                                            char * pBuffer,
+                                            uint32_t bufferLength,
+                                            const char * pThingName,
+                                            uint16_t thingNameLength )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    uint16_t offset = 0U, topicLength = 0U;
+    uint8_t * pSlot;
+    uint32_t i;
+
+    if( ( pMatcher == NULL ) || ( pBuffer == NULL ) || ( pThingName == NULL ) ||
+        ( thingNameLength == 0U ) || ( thingNameLength > DEFENDER_THINGNAME_MAX_LENGTH ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pMatcher: %p, pBuffer: %p, pThingName: %p, thingNameLength: %u.",
+                    ( void * ) pMatcher,
+                    ( void * ) pBuffer,
+                    ( const void * ) pThingName,
+                    ( unsigned int ) thingNameLength ) );
+    }
+    else if( bufferLength < ( uint32_t ) DEFENDER_BOUND_MATCHER_BUFFER_LENGTH( thingNameLength ) )
+    {
+        ret = DefenderBufferTooSmall;
+
+        LogError( ( "The buffer is too small for the topics. bufferLength: %u, required: %u.",
+                    ( unsigned int ) bufferLength,
+                    ( unsigned int ) DEFENDER_BOUND_MATCHER_BUFFER_LENGTH( thingNameLength ) ) );
+    }
+    else
+    {
+        ( void ) memset( pMatcher->slots, 0, sizeof( pMatcher->slots ) );
+        pMatcher->pTopics = pBuffer;
+        pMatcher->publishLength = ( uint16_t ) DEFENDER_API_LENGTH_JSON_PUBLISH( ( uint32_t ) thingNameLength );
+        pMatcher->responseLength = ( uint16_t ) DEFENDER_API_LENGTH_JSON_ACCEPTED( ( uint32_t ) thingNameLength );
+
+        for( i = 0U; i < ( uint32_t ) DefenderMaxTopic; i++ )
+        {
+            /* The buffer is long enough for all topics, and the longest is
+             * written last. */
+            ret = Defender_GetTopic( &( pBuffer[ offset ] ),
+                                     DEFENDER_API_MAX_LENGTH( thingNameLength ),
+                                     pThingName,
+                                     thingNameLength,
+                                     ( DefenderTopic_t ) i,
+                                     &( topicLength ) );
+            assert( ret == DefenderSuccess );
+
+            pMatcher->topicOffsets[ i ] = offset;
+            pMatcher->topicLengths[ i ] = topicLength;
+            offset += topicLength;
+
+            pSlot = &( pMatcher->slots[ ( topicLength == pMatcher->publishLength ) ? 0U : 1U ]
+                       [ getKey( pMatcher, &( pBuffer[ pMatcher->topicOffsets[ i ] ] ), topicLength ) ] );
+            assert( *pSlot == 0U );
+            *pSlot = ( uint8_t ) ( i + 1U );
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_BoundMatcherMatch( const DefenderBoundMatcher_t * pMatcher,
+                                             const char * pTopic,
+                                             uint16_t topicLength,
+                                             DefenderTopic_t * pOutApi )
+{
+    DefenderStatus_t ret = DefenderNoMatch;
+    uint8_t slot = 0U;
+
+    if( ( pMatcher == NULL ) || ( pMatcher->pTopics == NULL ) || ( pTopic == NULL ) || ( pOutApi == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pMatcher: %p, pTopic: %p, pOutApi: %p.",
+                    ( const void * ) pMatcher,
+                    ( const void * ) pTopic,
+                    ( void * ) pOutApi ) );
+    }
+    else
+    {
+        if( topicLength == pMatcher->publishLength )
+        {
+            slot = pMatcher->slots[ 0 ][ getKey( pMatcher, pTopic, topicLength ) ];
+        }
+        else if( topicLength == pMatcher->responseLength )
+        {
+            slot = pMatcher->slots[ 1 ][ getKey( pMatcher, pTopic, topicLength ) ];
+        }
+        else
+        {
+            /* Empty else MISRA 15.7 */
+        }
+
+        if( ( slot != 0U ) &&
+            ( memcmp( pTopic, &( pMatcher->pTopics[ pMatcher->topicOffsets[ slot - 1U ] ] ), topicLength ) == 0 ) )
+        {
+            ret = DefenderSuccess;
+            *pOutApi = ( DefenderTopic_t ) ( slot - 1U );
+        }
+        else
+        {
+            *pOutApi = DefenderInvalidTopic;
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_BoundMatcherGetTopic( const DefenderBoundMatcher_t * pMatcher,
+                                                DefenderTopic_t api,
+                                                const char ** ppOutTopic,
+                                                uint16_t * pOutTopicLength )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+
+    if( ( pMatcher == NULL ) || ( pMatcher->pTopics == NULL ) || ( ppOutTopic == NULL ) ||
+        ( pOutTopicLength == NULL ) || ( api <= DefenderInvalidTopic ) || ( api >= DefenderMaxTopic ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pMatcher: %p, api: %d, ppOutTopic: %p, pOutTopicLength: %p.",
+                    ( const void * ) pMatcher,
+                    ( int ) api,
+                    ( void * ) ppOutTopic,
+                    ( void * ) pOutTopicLength ) );
+    }
+    else
+    {
+        *ppOutTopic = &( pMatcher->pTopics[ pMatcher->topicOffsets[ api ] ] );
+        *pOutTopicLength = pMatcher->topicLengths[ api ];
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
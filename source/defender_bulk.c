@@ -0,0 +1,221 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_bulk.c
+ * @brief Implementation of bulk Device Defender topic generation.
+ */
+
+/* Standard includes. */
+#include <assert.h>
+#include <stddef.h>
+
+/* Bulk API include. */
+#include "defender_bulk.h"
+
+/**
+ * @brief Check that the offsets of a range of things match their topic lengths.
+ *
+ * @param[in] pOffsets The offsets calculated by #Defender_GetTopicOffsets.
+ * @param[in] ppThingNames Array of thing names.
+ * @param[in] pThingNameLengths Array of thing name lengths.
+ * @param[in] first Index of the first thing in the range.
+ * @param[in] last Index one past the last thing in the range.
+ * @param[in] api The defender API value.
+ *
+ * @return #DefenderSuccess if the offsets are consistent;
+ * #DefenderBadParameter otherwise.
+ */
+static DefenderStatus_t validateRange( const uint32_t * pOffsets,
+                                       const char * const * ppThingNames,
+                                       const uint16_t * pThingNameLengths,
+                                       uint32_t first,
+                                       uint32_t last,
+                                       DefenderTopic_t api );
+/*-----------------------------------------------------------*/
+
+static DefenderStatus_t validateRange( const uint32_t * pOffsets,
+                                       const char * const * ppThingNames,
+                                       const uint16_t * pThingNameLengths,
+                                       uint32_t first,
+                                       uint32_t last,
+                                       DefenderTopic_t api )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    uint32_t i = 0U;
+    uint16_t topicLength = 0U;
+
+    assert( pOffsets != NULL );
+    assert( ppThingNames != NULL );
+    assert( pThingNameLengths != NULL );
+
+    for( i = first; i < last; i++ )
+    {
+        if( ( ppThingNames[ i ] == NULL ) ||
+            ( Defender_GetTopicLength( pThingNameLengths[ i ], api, &( topicLength ) ) != DefenderSuccess ) ||
+            ( pOffsets[ i + 1U ] < pOffsets[ i ] ) ||
+            ( ( pOffsets[ i + 1U ] - pOffsets[ i ] ) != ( uint32_t ) topicLength ) )
+        {
+            ret = DefenderBadParameter;
+
+            LogError( ( "Thing name or offsets do not match. Index: %u, thingNameLength: %u, "
+                        "offset: %u, next offset: %u.",
+                        ( unsigned int ) i,
+                        ( unsigned int ) pThingNameLengths[ i ],
+                        ( unsigned int ) pOffsets[ i ],
+                        ( unsigned int ) pOffsets[ i + 1U ] ) );
+            break;
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_GetTopicOffsets( const uint16_t * pThingNameLengths,
+                                           uint32_t thingCount,
+                                           DefenderTopic_t api,
+                                           uint32_t * pOutOffsets )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    uint32_t i = 0U, offset = 0U;
+    uint16_t topicLength = 0U;
+
+    if( ( pThingNameLengths == NULL ) ||
+        ( thingCount == UINT32_MAX ) ||
+        ( api <= DefenderInvalidTopic ) || ( api >= DefenderMaxTopic ) ||
+        ( pOutOffsets == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pThingNameLengths: %p, thingCount: %u, "
+                    "api: %d, pOutOffsets: %p.",
+                    ( const void * ) pThingNameLengths,
+                    ( unsigned int ) thingCount,
+                    api,
+                    ( void * ) pOutOffsets ) );
+    }
+
+    for( i = 0U; ( ret == DefenderSuccess ) && ( i < thingCount ); i++ )
+    {
+        if( Defender_GetTopicLength( pThingNameLengths[ i ], api, &( topicLength ) ) != DefenderSuccess )
+        {
+            ret = DefenderBadParameter;
+
+            LogError( ( "Invalid thing name length. Index: %u, thingNameLength: %u.",
+                        ( unsigned int ) i,
+                        ( unsigned int ) pThingNameLengths[ i ] ) );
+        }
+        else
+        {
+            if( ( uint32_t ) topicLength > ( UINT32_MAX - offset ) )
+            {
+                ret = DefenderBadParameter;
+
+                LogError( ( "The topics of %u things do not fit in 32 bits.",
+                            ( unsigned int ) thingCount ) );
+            }
+            else
+            {
+                pOutOffsets[ i ] = offset;
+                offset += topicLength;
+            }
+        }
+    }
+
+    if( ret == DefenderSuccess )
+    {
+        pOutOffsets[ thingCount ] = offset;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_GetTopicRange( char * pBuffer,
+                                         uint32_t bufferLength,
+                                         const uint32_t * pOffsets,
+                                         const char * const * ppThingNames,
+                                         const uint16_t * pThingNameLengths,
+                                         uint32_t first,
+                                         uint32_t last,
+                                         DefenderTopic_t api )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    uint32_t i = 0U;
+    uint16_t topicLength = 0U;
+
+    if( ( pBuffer == NULL ) ||
+        ( pOffsets == NULL ) ||
+        ( ppThingNames == NULL ) ||
+        ( pThingNameLengths == NULL ) ||
+        ( first > last ) ||
+        ( api <= DefenderInvalidTopic ) || ( api >= DefenderMaxTopic ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pBuffer: %p, pOffsets: %p, ppThingNames: %p, "
+                    "pThingNameLengths: %p, first: %u, last: %u, api: %d.",
+                    ( void * ) pBuffer,
+                    ( const void * ) pOffsets,
+                    ( const void * ) ppThingNames,
+                    ( const void * ) pThingNameLengths,
+                    ( unsigned int ) first,
+                    ( unsigned int ) last,
+                    api ) );
+    }
+
+    if( ret == DefenderSuccess )
+    {
+        ret = validateRange( pOffsets, ppThingNames, pThingNameLengths, first, last, api );
+    }
+
+    if( ( ret == DefenderSuccess ) && ( pOffsets[ last ] > bufferLength ) )
+    {
+        ret = DefenderBufferTooSmall;
+
+        LogError( ( "The buffer is too small to hold the topics. "
+                    "Provided buffer size: %u, Required buffer size: %u.",
+                    ( unsigned int ) bufferLength,
+                    ( unsigned int ) pOffsets[ last ] ) );
+    }
+
+    if( ret == DefenderSuccess )
+    {
+        for( i = first; i < last; i++ )
+        {
+            /* The range is validated above, so this call cannot fail and
+             * writes exactly pOffsets[ i + 1 ] - pOffsets[ i ] bytes. */
+            ( void ) Defender_GetTopic( &( pBuffer[ pOffsets[ i ] ] ),
+                                        ( uint16_t ) ( pOffsets[ i + 1U ] - pOffsets[ i ] ),
+                                        ppThingNames[ i ],
+                                        pThingNameLengths[ i ],
+                                        api,
+                                        &( topicLength ) );
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
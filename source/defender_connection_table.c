@@ -0,0 +1,645 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_connection_table.c
+ * @brief Implementation of the established connections table.
+ */
+
+/* Standard includes. */
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Connection table include. */
+#include "defender_connection_table.h"
+
+/* Sort include. */
+#include "defender_sort.h"
+
+/* Writer include. */
+#include "defender_writer.h"
+
+/**
+ * @brief Number of radix sort passes: one for the interface, two for each
+ * port and four for the address.
+ */
+#define CONNECTION_TABLE_SORT_PASSES    9U
+
+/**
+ * @brief Number of connections whose keep flags are computed at a time by
+ * the dedup and filter loops.
+ */
+#define CONNECTION_TABLE_BLOCK_SIZE     64U
+
+/**
+ * @brief Parts of the established connections object.
+ */
+#define CONNECTIONS_START               "{\"" DEFENDER_REPORT_CONNECTIONS_KEY "\":["
+#define CONNECTION_INTERFACE_START      "{\"" DEFENDER_REPORT_LOCAL_INTERFACE_KEY "\":\""
+#define CONNECTION_INTERFACE_END        "\","
+#define CONNECTION_LOCAL_PORT_START     "\"" DEFENDER_REPORT_LOCAL_PORT_KEY "\":"
+#define CONNECTION_REMOTE_ADDR_START    ",\"" DEFENDER_REPORT_REMOTE_ADDR_KEY "\":\""
+#define CONNECTION_END                  "\"}"
+#define CONNECTIONS_TOTAL_START         "],\"" DEFENDER_REPORT_TOTAL_KEY "\":"
+
+/**
+ * @brief Check that the arrays of a connection table are set.
+ *
+ * @param[in] pTable The connection table.
+ *
+ * @return #DefenderSuccess if the table is valid;
+ * #DefenderBadParameter otherwise.
+ */
+static DefenderStatus_t validateTable( const DefenderConnectionTable_t * pTable );
+
+/**
+ * @brief Get the sort digits of a block of connections for a radix sort
+ * pass.
+ *
+ * Pass 0 uses the interface, passes 1 and 2 the local port, passes 3 and 4
+ * the remote port and passes 5 to 8 the remote address, least significant
+ * byte first.
+ *
+ * @param[in] pList The connection table.
+ * @param[in] start The index of the first connection of the block.
+ * @param[in] length The number of connections in the block.
+ * @param[in] pass The radix sort pass.
+ * @param[out] pDigits The digit of each connection of the block.
+ */
+static void getDigits( const void * pList,
+                       uint32_t start,
+                       uint32_t length,
+                       uint32_t pass,
+                       uint8_t * pDigits );
+
+/**
+ * @brief Copy a block of connections of a table to their positions in
+ * another table for a radix sort pass.
+ *
+ * @param[in] pSource The table to read.
+ * @param[in] start The index of the first connection of the block in
+ * pSource.
+ * @param[in] length The number of connections in the block.
+ * @param[out] pDestination The table to write.
+ * @param[in] pIndices The index in pDestination of each connection of the
+ * block.
+ */
+static void moveConnections( const void * pSource,
+                             uint32_t start,
+                             uint32_t length,
+                             void * pDestination,
+                             const uint32_t * pIndices );
+
+/**
+ * @brief Copy a connection from one table to another.
+ *
+ * @param[in] pSource The table to read.
+ * @param[in] sourceIndex The index of the connection in pSource.
+ * @param[out] pDestination The table to write.
+ * @param[in] destinationIndex The index of the connection in pDestination.
+ */
+static void copyConnection( const DefenderConnectionTable_t * pSource,
+                            uint32_t sourceIndex,
+                            DefenderConnectionTable_t * pDestination,
+                            uint32_t destinationIndex );
+
+/**
+ * @brief Flag the connections of a block which differ from the connection
+ * before them.
+ *
+ * The loop has no branches and compiles to SIMD compares.
+ *
+ * @param[in] pTable The connection table.
+ * @param[in] blockStart The index of the first connection of the block. Must
+ * be at least 1.
+ * @param[in] blockLength The number of connections in the block.
+ * @param[out] pKeep One flag per connection of the block.
+ */
+static void markChanged( const DefenderConnectionTable_t * pTable,
+                         uint32_t blockStart,
+                         uint32_t blockLength,
+                         uint8_t * pKeep );
+
+/**
+ * @brief Flag the local ports of a block which are in a range.
+ *
+ * @param[in] pLocalPorts The local ports of the block.
+ * @param[in] blockLength The number of connections in the block.
+ * @param[in] minLocalPort The lowest local port of the range.
+ * @param[in] range The highest local port of the range minus minLocalPort.
+ * @param[out] pKeep One flag per connection of the block.
+ */
+static void markInRange( const uint16_t * pLocalPorts,
+                         uint32_t blockLength,
+                         uint16_t minLocalPort,
+                         uint16_t range,
+                         uint8_t * pKeep );
+
+/**
+ * @brief Move the kept connections of a block to the front of a table.
+ *
+ * Every connection is copied and the write position only moves past kept
+ * connections, so the loop has no branch on the flags.
+ *
+ * @param[in] pTable The connection table.
+ * @param[in] blockStart The index of the first connection of the block.
+ * @param[in] pKeep One flag per connection of the block, 1 to keep it.
+ * @param[in] blockLength The number of connections in the block.
+ * @param[in] writeIndex The index to write the first kept connection at.
+ *
+ * @return The index after the last kept connection.
+ */
+static uint32_t compactBlock( DefenderConnectionTable_t * pTable,
+                              uint32_t blockStart,
+                              const uint8_t * pKeep,
+                              uint32_t blockLength,
+                              uint32_t writeIndex );
+
+/**
+ * @brief Append one connection object to the serializer output.
+ *
+ * @param[in] pWriter The serializer state.
+ * @param[in] pTable The connection table.
+ * @param[in] index The index of the connection.
+ * @param[in] ppInterfaceNames Array of interface names.
+ * @param[in] pInterfaceNameLengths Array of interface name lengths.
+ * @param[in] interfaceCount Number of entries in the above arrays.
+ */
+static void writeConnection( DefenderWriter_t * pWriter,
+                             const DefenderConnectionTable_t * pTable,
+                             uint32_t index,
+                             const char * const * ppInterfaceNames,
+                             const uint16_t * pInterfaceNameLengths,
+                             uint8_t interfaceCount );
+/*-----------------------------------------------------------*/
+
+static DefenderStatus_t validateTable( const DefenderConnectionTable_t * pTable )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+
+    if( ( pTable == NULL ) ||
+        ( pTable->pRemoteAddresses == NULL ) ||
+        ( pTable->pRemotePorts == NULL ) ||
+        ( pTable->pLocalPorts == NULL ) ||
+        ( pTable->pInterfaceIds == NULL ) ||
+        ( pTable->count > pTable->capacity ) )
+    {
+        ret = DefenderBadParameter;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+static void getDigits( const void * pList,
+                       uint32_t start,
+                       uint32_t length,
+                       uint32_t pass,
+                       uint8_t * pDigits )
+{
+    const DefenderConnectionTable_t * pTable = ( const DefenderConnectionTable_t * ) pList;
+    uint32_t i = 0U, shift = 0U;
+
+    assert( pass < CONNECTION_TABLE_SORT_PASSES );
+
+    if( pass == 0U )
+    {
+        ( void ) memcpy( pDigits, &( pTable->pInterfaceIds[ start ] ), length );
+    }
+    else if( pass < 3U )
+    {
+        shift = ( pass - 1U ) * 8U;
+
+        for( i = 0U; i < length; i++ )
+        {
+            pDigits[ i ] = ( uint8_t ) ( ( ( uint32_t ) pTable->pLocalPorts[ start + i ] >> shift ) & 0xFFU );
+        }
+    }
+    else if( pass < 5U )
+    {
+        shift = ( pass - 3U ) * 8U;
+
+        for( i = 0U; i < length; i++ )
+        {
+            pDigits[ i ] = ( uint8_t ) ( ( ( uint32_t ) pTable->pRemotePorts[ start + i ] >> shift ) & 0xFFU );
+        }
+    }
+    else
+    {
+        shift = ( pass - 5U ) * 8U;
+
+        for( i = 0U; i < length; i++ )
+        {
+            pDigits[ i ] = ( uint8_t ) ( ( pTable->pRemoteAddresses[ start + i ] >> shift ) & 0xFFU );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void moveConnections( const void * pSource,
+                             uint32_t start,
+                             uint32_t length,
+                             void * pDestination,
+                             const uint32_t * pIndices )
+{
+    uint32_t i = 0U;
+
+    for( i = 0U; i < length; i++ )
+    {
+        copyConnection( ( const DefenderConnectionTable_t * ) pSource, start + i,
+                        ( DefenderConnectionTable_t * ) pDestination, pIndices[ i ] );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void copyConnection( const DefenderConnectionTable_t * pSource,
+                            uint32_t sourceIndex,
+                            DefenderConnectionTable_t * pDestination,
+                            uint32_t destinationIndex )
+{
+    pDestination->pRemoteAddresses[ destinationIndex ] = pSource->pRemoteAddresses[ sourceIndex ];
+    pDestination->pRemotePorts[ destinationIndex ] = pSource->pRemotePorts[ sourceIndex ];
+    pDestination->pLocalPorts[ destinationIndex ] = pSource->pLocalPorts[ sourceIndex ];
+    pDestination->pInterfaceIds[ destinationIndex ] = pSource->pInterfaceIds[ sourceIndex ];
+}
+/*-----------------------------------------------------------*/
+
+static void markChanged( const DefenderConnectionTable_t * pTable,
+                         uint32_t blockStart,
+                         uint32_t blockLength,
+                         uint8_t * pKeep )
+{
+    const uint32_t * pAddresses = &( pTable->pRemoteAddresses[ blockStart - 1U ] );
+    const uint16_t * pRemotePorts = &( pTable->pRemotePorts[ blockStart - 1U ] );
+    const uint16_t * pLocalPorts = &( pTable->pLocalPorts[ blockStart - 1U ] );
+    const uint8_t * pInterfaceIds = &( pTable->pInterfaceIds[ blockStart - 1U ] );
+    uint32_t i = 0U;
+
+    assert( blockStart > 0U );
+    assert( blockLength <= CONNECTION_TABLE_BLOCK_SIZE );
+
+    for( i = 0U; i < blockLength; i++ )
+    {
+        pKeep[ i ] = ( uint8_t ) ( ( uint8_t ) ( pAddresses[ i + 1U ] != pAddresses[ i ] ) |
+                                   ( uint8_t ) ( pRemotePorts[ i + 1U ] != pRemotePorts[ i ] ) |
+                                   ( uint8_t ) ( pLocalPorts[ i + 1U ] != pLocalPorts[ i ] ) |
+                                   ( uint8_t ) ( pInterfaceIds[ i + 1U ] != pInterfaceIds[ i ] ) );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void markInRange( const uint16_t * pLocalPorts,
+                         uint32_t blockLength,
+                         uint16_t minLocalPort,
+                         uint16_t range,
+                         uint8_t * pKeep )
+{
+    uint32_t i = 0U;
+
+    assert( blockLength <= CONNECTION_TABLE_BLOCK_SIZE );
+
+    /* Ports below minLocalPort wrap around to large values, so one unsigned
+     * comparison checks both ends of the range. */
+    for( i = 0U; i < blockLength; i++ )
+    {
+        pKeep[ i ] = ( uint8_t ) ( ( uint16_t ) ( pLocalPorts[ i ] - minLocalPort ) <= range );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t compactBlock( DefenderConnectionTable_t * pTable,
+                              uint32_t blockStart,
+                              const uint8_t * pKeep,
+                              uint32_t blockLength,
+                              uint32_t writeIndex )
+{
+    uint32_t i = 0U, nextIndex = writeIndex;
+
+    for( i = 0U; i < blockLength; i++ )
+    {
+        assert( nextIndex <= ( blockStart + i ) );
+
+        copyConnection( pTable, blockStart + i, pTable, nextIndex );
+        nextIndex += pKeep[ i ];
+    }
+
+    return nextIndex;
+}
+/*-----------------------------------------------------------*/
+
+static void writeConnection( DefenderWriter_t * pWriter,
+                             const DefenderConnectionTable_t * pTable,
+                             uint32_t index,
+                             const char * const * ppInterfaceNames,
+                             const uint16_t * pInterfaceNameLengths,
+                             uint8_t interfaceCount )
+{
+    uint8_t interfaceId = pTable->pInterfaceIds[ index ];
+    uint32_t address = pTable->pRemoteAddresses[ index ];
+
+    if( interfaceId < interfaceCount )
+    {
+        Defender_WriteBytes( pWriter, CONNECTION_INTERFACE_START, STRING_LITERAL_LENGTH( CONNECTION_INTERFACE_START ) );
+        Defender_WriteEscaped( pWriter, ppInterfaceNames[ interfaceId ], pInterfaceNameLengths[ interfaceId ] );
+        Defender_WriteBytes( pWriter, CONNECTION_INTERFACE_END, STRING_LITERAL_LENGTH( CONNECTION_INTERFACE_END ) );
+    }
+    else
+    {
+        Defender_WriteBytes( pWriter, "{", 1U );
+    }
+
+    Defender_WriteBytes( pWriter, CONNECTION_LOCAL_PORT_START, STRING_LITERAL_LENGTH( CONNECTION_LOCAL_PORT_START ) );
+    Defender_WriteDecimal( pWriter, pTable->pLocalPorts[ index ] );
+    Defender_WriteBytes( pWriter, CONNECTION_REMOTE_ADDR_START, STRING_LITERAL_LENGTH( CONNECTION_REMOTE_ADDR_START ) );
+    Defender_WriteIpv4Address( pWriter, address );
+    Defender_WriteBytes( pWriter, ":", 1U );
+    Defender_WriteDecimal( pWriter, pTable->pRemotePorts[ index ] );
+    Defender_WriteBytes( pWriter, CONNECTION_END, STRING_LITERAL_LENGTH( CONNECTION_END ) );
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_ConnectionTableInit( DefenderConnectionTable_t * pTable,
+                                               uint32_t * pRemoteAddresses,
+                                               uint16_t * pRemotePorts,
+                                               uint16_t * pLocalPorts,
+                                               uint8_t * pInterfaceIds,
+                                               uint32_t capacity )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+
+    if( ( pTable == NULL ) ||
+        ( pRemoteAddresses == NULL ) ||
+        ( pRemotePorts == NULL ) ||
+        ( pLocalPorts == NULL ) ||
+        ( pInterfaceIds == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pTable: %p, pRemoteAddresses: %p, "
+                    "pRemotePorts: %p, pLocalPorts: %p, pInterfaceIds: %p.",
+                    ( void * ) pTable,
+                    ( void * ) pRemoteAddresses,
+                    ( void * ) pRemotePorts,
+                    ( void * ) pLocalPorts,
+                    ( void * ) pInterfaceIds ) );
+    }
+    else
+    {
+        pTable->pRemoteAddresses = pRemoteAddresses;
+        pTable->pRemotePorts = pRemotePorts;
+        pTable->pLocalPorts = pLocalPorts;
+        pTable->pInterfaceIds = pInterfaceIds;
+        pTable->count = 0U;
+        pTable->capacity = capacity;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_ConnectionTableAdd( DefenderConnectionTable_t * pTable,
+                                              uint32_t remoteAddress,
+                                              uint16_t remotePort,
+                                              uint16_t localPort,
+                                              uint8_t interfaceId )
+{
+    DefenderStatus_t ret = validateTable( pTable );
+
+    if( ret != DefenderSuccess )
+    {
+        LogError( ( "Invalid connection table. pTable: %p.", ( void * ) pTable ) );
+    }
+    else if( pTable->count == pTable->capacity )
+    {
+        ret = DefenderBufferTooSmall;
+
+        LogError( ( "The connection table is full. Capacity: %u.",
+                    ( unsigned int ) pTable->capacity ) );
+    }
+    else
+    {
+        pTable->pRemoteAddresses[ pTable->count ] = remoteAddress;
+        pTable->pRemotePorts[ pTable->count ] = remotePort;
+        pTable->pLocalPorts[ pTable->count ] = localPort;
+        pTable->pInterfaceIds[ pTable->count ] = interfaceId;
+        pTable->count++;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_ConnectionTableSort( DefenderConnectionTable_t * pTable,
+                                               DefenderConnectionTable_t * pScratchTable )
+{
+    DefenderStatus_t ret = validateTable( pTable );
+    const DefenderConnectionTable_t * pSource = pTable;
+
+    if( ret == DefenderSuccess )
+    {
+        ret = validateTable( pScratchTable );
+    }
+
+    if( ( ret != DefenderSuccess ) ||
+        ( pTable == pScratchTable ) ||
+        ( pScratchTable->capacity < pTable->count ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pTable: %p, pScratchTable: %p.",
+                    ( void * ) pTable,
+                    ( void * ) pScratchTable ) );
+    }
+    else if( pTable->count > 1U )
+    {
+        pSource = Defender_RadixSort( pTable, pScratchTable, pTable->count,
+                                      CONNECTION_TABLE_SORT_PASSES, getDigits, moveConnections );
+
+        if( pSource != pTable )
+        {
+            ( void ) memcpy( pTable->pRemoteAddresses, pSource->pRemoteAddresses, pTable->count * sizeof( uint32_t ) );
+            ( void ) memcpy( pTable->pRemotePorts, pSource->pRemotePorts, pTable->count * sizeof( uint16_t ) );
+            ( void ) memcpy( pTable->pLocalPorts, pSource->pLocalPorts, pTable->count * sizeof( uint16_t ) );
+            ( void ) memcpy( pTable->pInterfaceIds, pSource->pInterfaceIds, pTable->count * sizeof( uint8_t ) );
+        }
+    }
+    else
+    {
+        /* Empty else MISRA 15.7 */
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_ConnectionTableDedup( DefenderConnectionTable_t * pTable )
+{
+    DefenderStatus_t ret = validateTable( pTable );
+    uint8_t keep[ CONNECTION_TABLE_BLOCK_SIZE ];
+    uint32_t blockStart = 1U, blockLength = 0U, writeIndex = 1U;
+
+    if( ret != DefenderSuccess )
+    {
+        LogError( ( "Invalid connection table. pTable: %p.", ( void * ) pTable ) );
+    }
+    else if( pTable->count > 1U )
+    {
+        /* The first connection is always kept. Every other connection is kept
+         * if it differs from the one before it. */
+        for( blockStart = 1U; blockStart < pTable->count; blockStart += blockLength )
+        {
+            blockLength = pTable->count - blockStart;
+
+            if( blockLength > CONNECTION_TABLE_BLOCK_SIZE )
+            {
+                blockLength = CONNECTION_TABLE_BLOCK_SIZE;
+            }
+
+            markChanged( pTable, blockStart, blockLength, keep );
+            writeIndex = compactBlock( pTable, blockStart, keep, blockLength, writeIndex );
+        }
+
+        pTable->count = writeIndex;
+    }
+    else
+    {
+        /* Empty else MISRA 15.7 */
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_ConnectionTableFilterLocalPort( DefenderConnectionTable_t * pTable,
+                                                          uint16_t minLocalPort,
+                                                          uint16_t maxLocalPort )
+{
+    DefenderStatus_t ret = validateTable( pTable );
+    uint8_t keep[ CONNECTION_TABLE_BLOCK_SIZE ];
+    uint32_t blockStart = 0U, blockLength = 0U, writeIndex = 0U;
+    uint16_t range = 0U;
+
+    if( ( ret != DefenderSuccess ) || ( minLocalPort > maxLocalPort ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pTable: %p, minLocalPort: %u, maxLocalPort: %u.",
+                    ( void * ) pTable,
+                    ( unsigned int ) minLocalPort,
+                    ( unsigned int ) maxLocalPort ) );
+    }
+    else
+    {
+        range = ( uint16_t ) ( maxLocalPort - minLocalPort );
+
+        for( blockStart = 0U; blockStart < pTable->count; blockStart += blockLength )
+        {
+            blockLength = pTable->count - blockStart;
+
+            if( blockLength > CONNECTION_TABLE_BLOCK_SIZE )
+            {
+                blockLength = CONNECTION_TABLE_BLOCK_SIZE;
+            }
+
+            markInRange( &( pTable->pLocalPorts[ blockStart ] ), blockLength, minLocalPort, range, keep );
+            writeIndex = compactBlock( pTable, blockStart, keep, blockLength, writeIndex );
+        }
+
+        pTable->count = writeIndex;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_ConnectionTableSerialize( const DefenderConnectionTable_t * pTable,
+                                                    const char * const * ppInterfaceNames,
+                                                    const uint16_t * pInterfaceNameLengths,
+                                                    uint8_t interfaceCount,
+                                                    char * pBuffer,
+                                                    uint32_t bufferLength,
+                                                    uint32_t * pOutLength )
+{
+    DefenderStatus_t ret = validateTable( pTable );
+    DefenderWriter_t writer;
+    uint32_t i = 0U;
+
+    if( ( ret != DefenderSuccess ) ||
+        ( ( interfaceCount > 0U ) && ( ( ppInterfaceNames == NULL ) || ( pInterfaceNameLengths == NULL ) ) ) ||
+        ( pBuffer == NULL ) ||
+        ( pOutLength == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pTable: %p, ppInterfaceNames: %p, "
+                    "pInterfaceNameLengths: %p, interfaceCount: %u, pBuffer: %p, pOutLength: %p.",
+                    ( const void * ) pTable,
+                    ( const void * ) ppInterfaceNames,
+                    ( const void * ) pInterfaceNameLengths,
+                    ( unsigned int ) interfaceCount,
+                    ( void * ) pBuffer,
+                    ( void * ) pOutLength ) );
+    }
+    else
+    {
+        Defender_WriterInit( &( writer ), pBuffer, bufferLength );
+
+        Defender_WriteBytes( &( writer ), CONNECTIONS_START, STRING_LITERAL_LENGTH( CONNECTIONS_START ) );
+
+        for( i = 0U; ( i < pTable->count ) && ( writer.status == DefenderSuccess ); i++ )
+        {
+            if( i > 0U )
+            {
+                Defender_WriteBytes( &( writer ), ",", 1U );
+            }
+
+            writeConnection( &( writer ), pTable, i, ppInterfaceNames, pInterfaceNameLengths, interfaceCount );
+        }
+
+        Defender_WriteBytes( &( writer ), CONNECTIONS_TOTAL_START, STRING_LITERAL_LENGTH( CONNECTIONS_TOTAL_START ) );
+        Defender_WriteDecimal( &( writer ), pTable->count );
+        Defender_WriteBytes( &( writer ), "}", 1U );
+
+        ret = writer.status;
+
+        if( ret == DefenderSuccess )
+        {
+            *pOutLength = writer.length;
+        }
+        else if( ret == DefenderBufferTooSmall )
+        {
+            LogError( ( "The buffer is too small for %u connections. bufferLength: %u.",
+                        ( unsigned int ) pTable->count,
+                        ( unsigned int ) bufferLength ) );
+        }
+        else
+        {
+            LogError( ( "Invalid interface name." ) );
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
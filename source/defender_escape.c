@@ -0,0 +1,431 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_escape.c
+ * @brief Implementation of escaping strings for JSON reports.
+ */
+
+/* Standard includes. */
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Escape API include. */
+#include "defender_escape.h"
+
+#if ( DEFENDER_USE_SIMD == 1 ) && defined( __AVX2__ )
+    #include <immintrin.h>
+    #define ESCAPE_USE_AVX2
+    #define ESCAPE_BLOCK_SIZE    32U
+#elif ( DEFENDER_USE_SIMD == 1 ) && defined( __ARM_NEON ) && defined( __aarch64__ )
+    #include <arm_neon.h>
+    #define ESCAPE_USE_NEON
+    #define ESCAPE_BLOCK_SIZE    16U
+#else
+    #define ESCAPE_BLOCK_SIZE    8U
+#endif
+
+/**
+ * @brief A 64-bit word with every byte set to the given byte.
+ */
+#define ESCAPE_REPEAT( byte )    ( UINT64_C( 0x0101010101010101 ) * ( uint64_t ) ( byte ) )
+
+/**
+ * @brief Length of the longest escape, \\u00XX.
+ */
+#define ESCAPE_MAX_LENGTH        6U
+
+/**
+ * @brief The escaped string being written.
+ */
+typedef struct EscapeOutput
+{
+    char * pBuffer;        /**< The output buffer. */
+    uint32_t bufferLength; /**< Length of the output buffer. */
+    uint32_t length;       /**< Number of bytes written. */
+} EscapeOutput_t;
+
+/**
+ * @brief Check whether a block has no byte which needs escaping or checking.
+ *
+ * @param[in] pBlock The block of #ESCAPE_BLOCK_SIZE bytes.
+ *
+ * @return 1 if all bytes of the block can be copied as they are; 0 otherwise.
+ */
+static uint8_t isCleanBlock( const uint8_t * pBlock );
+
+/**
+ * @brief Check whether a byte needs escaping or checking.
+ *
+ * @param[in] byte The byte.
+ *
+ * @return 1 for quotes, backslashes, control characters and non-ASCII bytes;
+ * 0 otherwise.
+ */
+static uint8_t isSpecialByte( uint8_t byte );
+
+/**
+ * @brief Find the first byte of a string which needs escaping or checking.
+ *
+ * @param[in] pString The string.
+ * @param[in] start The position to start at.
+ * @param[in] length The length of the string.
+ *
+ * @return The position of the byte, or length if there is none.
+ */
+static uint32_t findSpecialByte( const uint8_t * pString,
+                                 uint32_t start,
+                                 uint32_t length );
+
+/**
+ * @brief Get the length of a valid UTF-8 sequence.
+ *
+ * Overlong encodings, surrogates and code points above U+10FFFF are invalid.
+ *
+ * @param[in] pBytes The bytes, starting with a non-ASCII byte.
+ * @param[in] available The number of bytes left in the string.
+ *
+ * @return The length of the sequence, or 0 if it is not valid.
+ */
+static uint32_t getUtf8Length( const uint8_t * pBytes,
+                               uint32_t available );
+
+/**
+ * @brief Append bytes to the escaped string.
+ *
+ * @param[in] pOutput The escaped string.
+ * @param[in] pBytes The bytes.
+ * @param[in] length The number of bytes.
+ *
+ * @return #DefenderSuccess if the bytes fit in the buffer;
+ * #DefenderBufferTooSmall otherwise.
+ */
+static DefenderStatus_t appendBytes( EscapeOutput_t * pOutput,
+                                     const uint8_t * pBytes,
+                                     uint32_t length );
+
+/**
+ * @brief Escape or check the byte found by #findSpecialByte.
+ *
+ * @param[in] pString The string.
+ * @param[in] length The length of the string.
+ * @param[in,out] pIndex The position of the byte, moved past the byte or the
+ * UTF-8 sequence it starts.
+ * @param[in] pOutput The escaped string.
+ *
+ * @return #DefenderSuccess if the byte is written;
+ * #DefenderBufferTooSmall if it does not fit in the buffer;
+ * #DefenderError if it does not start a valid UTF-8 sequence.
+ */
+static DefenderStatus_t escapeSpecialByte( const uint8_t * pString,
+                                           uint32_t length,
+                                           uint32_t * pIndex,
+                                           EscapeOutput_t * pOutput );
+/*-----------------------------------------------------------*/
+
+#if defined( ESCAPE_USE_AVX2 )
+
+    static uint8_t isCleanBlock( const uint8_t * pBlock )
+    {
+        __m256i bytes = _mm256_loadu_si256( ( const __m256i * ) pBlock );
+        __m256i special;
+
+        /* Bytes from 0x80 are negative, so one signed comparison finds both
+         * control characters and non-ASCII bytes. */
+        special = _mm256_cmpgt_epi8( _mm256_set1_epi8( 0x20 ), bytes );
+        special = _mm256_or_si256( special, _mm256_cmpeq_epi8( bytes, _mm256_set1_epi8( '"' ) ) );
+        special = _mm256_or_si256( special, _mm256_cmpeq_epi8( bytes, _mm256_set1_epi8( '\\' ) ) );
+
+        return ( _mm256_movemask_epi8( special ) == 0 ) ? 1U : 0U;
+    }
+/*-----------------------------------------------------------*/
+
+#elif defined( ESCAPE_USE_NEON )
+
+    static uint8_t isCleanBlock( const uint8_t * pBlock )
+    {
+        uint8x16_t bytes = vld1q_u8( pBlock );
+        uint8x16_t special;
+
+        special = vorrq_u8( vcltq_u8( bytes, vdupq_n_u8( 0x20U ) ),
+                            vcgeq_u8( bytes, vdupq_n_u8( 0x80U ) ) );
+        special = vorrq_u8( special, vceqq_u8( bytes, vdupq_n_u8( ( uint8_t ) '"' ) ) );
+        special = vorrq_u8( special, vceqq_u8( bytes, vdupq_n_u8( ( uint8_t ) '\\' ) ) );
+
+        return ( vmaxvq_u8( special ) == 0U ) ? 1U : 0U;
+    }
+/*-----------------------------------------------------------*/
+
+#else /* if defined( ESCAPE_USE_AVX2 ) */
+
+    static uint8_t isCleanBlock( const uint8_t * pBlock )
+    {
+        uint64_t word, quotes, backslashes, special;
+        uint64_t ones = ESCAPE_REPEAT( 0x01U ), highBits = ESCAPE_REPEAT( 0x80U );
+
+        ( void ) memcpy( &( word ), pBlock, sizeof( word ) );
+
+        /* The usual "has a byte below n" tests. A borrow can mark a byte after
+         * a matching byte, but never marks a word without one, so the order
+         * of the bytes in the word does not matter. */
+        quotes = word ^ ESCAPE_REPEAT( '"' );
+        backslashes = word ^ ESCAPE_REPEAT( '\\' );
+        special = word |
+                  ( ( word - ESCAPE_REPEAT( 0x20U ) ) & ~word ) |
+                  ( ( quotes - ones ) & ~quotes ) |
+                  ( ( backslashes - ones ) & ~backslashes );
+
+        return ( ( special & highBits ) == 0U ) ? 1U : 0U;
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* if defined( ESCAPE_USE_AVX2 ) */
+
+static uint8_t isSpecialByte( uint8_t byte )
+{
+    return ( ( byte < 0x20U ) || ( byte >= 0x80U ) || ( byte == ( uint8_t ) '"' ) || ( byte == ( uint8_t ) '\\' ) ) ? 1U : 0U;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t findSpecialByte( const uint8_t * pString,
+                                 uint32_t start,
+                                 uint32_t length )
+{
+    uint32_t index = start;
+
+    while( ( ( length - index ) >= ESCAPE_BLOCK_SIZE ) &&
+           ( isCleanBlock( &( pString[ index ] ) ) == 1U ) )
+    {
+        index += ESCAPE_BLOCK_SIZE;
+    }
+
+    /* The byte is in the next block, or in the last bytes of the string. */
+    while( ( index < length ) && ( isSpecialByte( pString[ index ] ) == 0U ) )
+    {
+        index++;
+    }
+
+    return index;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t getUtf8Length( const uint8_t * pBytes,
+                               uint32_t available )
+{
+    uint32_t length = 0U, i = 0U;
+    uint8_t lowest = 0x80U, highest = 0xBFU;
+
+    assert( pBytes[ 0 ] >= 0x80U );
+
+    /* The limits on the second byte rule out overlong encodings (E0, F0),
+     * surrogates (ED) and code points above U+10FFFF (F4). */
+    if( ( pBytes[ 0 ] >= 0xC2U ) && ( pBytes[ 0 ] <= 0xDFU ) )
+    {
+        length = 2U;
+    }
+    else if( ( pBytes[ 0 ] >= 0xE0U ) && ( pBytes[ 0 ] <= 0xEFU ) )
+    {
+        length = 3U;
+        lowest = ( pBytes[ 0 ] == 0xE0U ) ? 0xA0U : 0x80U;
+        highest = ( pBytes[ 0 ] == 0xEDU ) ? 0x9FU : 0xBFU;
+    }
+    else if( ( pBytes[ 0 ] >= 0xF0U ) && ( pBytes[ 0 ] <= 0xF4U ) )
+    {
+        length = 4U;
+        lowest = ( pBytes[ 0 ] == 0xF0U ) ? 0x90U : 0x80U;
+        highest = ( pBytes[ 0 ] == 0xF4U ) ? 0x8FU : 0xBFU;
+    }
+    else
+    {
+        /* Continuation bytes, C0, C1 and F5 to FF cannot start a sequence. */
+    }
+
+    if( length > available )
+    {
+        length = 0U;
+    }
+    else if( length > 0U )
+    {
+        if( ( pBytes[ 1 ] < lowest ) || ( pBytes[ 1 ] > highest ) )
+        {
+            length = 0U;
+        }
+
+        for( i = 2U; ( i < length ) && ( length > 0U ); i++ )
+        {
+            if( ( pBytes[ i ] < 0x80U ) || ( pBytes[ i ] > 0xBFU ) )
+            {
+                length = 0U;
+            }
+        }
+    }
+    else
+    {
+        /* Empty else MISRA 15.7 */
+    }
+
+    return length;
+}
+/*-----------------------------------------------------------*/
+
+static DefenderStatus_t appendBytes( EscapeOutput_t * pOutput,
+                                     const uint8_t * pBytes,
+                                     uint32_t length )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+
+    if( length > ( pOutput->bufferLength - pOutput->length ) )
+    {
+        ret = DefenderBufferTooSmall;
+    }
+    else
+    {
+        ( void ) memcpy( &( pOutput->pBuffer[ pOutput->length ] ), pBytes, length );
+        pOutput->length += length;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+static DefenderStatus_t escapeSpecialByte( const uint8_t * pString,
+                                           uint32_t length,
+                                           uint32_t * pIndex,
+                                           EscapeOutput_t * pOutput )
+{
+    /* Letters of the control characters with a two character escape. */
+    static const char shortEscapes[ 0x20 ] =
+    {
+        '\0', '\0', '\0', '\0', '\0', '\0', '\0', '\0', 'b',  't',  'n',  '\0', 'f',  'r',  '\0', '\0',
+        '\0', '\0', '\0', '\0', '\0', '\0', '\0', '\0', '\0', '\0', '\0', '\0', '\0', '\0', '\0', '\0'
+    };
+    static const char hexDigits[] = "0123456789abcdef";
+    DefenderStatus_t ret = DefenderSuccess;
+    uint8_t escape[ ESCAPE_MAX_LENGTH ] = { ( uint8_t ) '\\', ( uint8_t ) 'u', ( uint8_t ) '0', ( uint8_t ) '0', 0U, 0U };
+    uint8_t byte = pString[ *pIndex ];
+    uint32_t sequenceLength = 0U;
+
+    if( byte >= 0x80U )
+    {
+        sequenceLength = getUtf8Length( &( pString[ *pIndex ] ), length - *pIndex );
+
+        if( sequenceLength == 0U )
+        {
+            ret = DefenderError;
+
+            LogError( ( "Invalid UTF-8 sequence at position %u.", ( unsigned int ) *pIndex ) );
+        }
+        else
+        {
+            ret = appendBytes( pOutput, &( pString[ *pIndex ] ), sequenceLength );
+        }
+    }
+    else
+    {
+        sequenceLength = 1U;
+
+        if( byte >= 0x20U )
+        {
+            /* A quote or a backslash. */
+            escape[ 1 ] = byte;
+            ret = appendBytes( pOutput, escape, 2U );
+        }
+        else if( shortEscapes[ byte ] != '\0' )
+        {
+            escape[ 1 ] = ( uint8_t ) shortEscapes[ byte ];
+            ret = appendBytes( pOutput, escape, 2U );
+        }
+        else
+        {
+            escape[ 4 ] = ( uint8_t ) hexDigits[ byte >> 4 ];
+            escape[ 5 ] = ( uint8_t ) hexDigits[ byte & 0x0FU ];
+            ret = appendBytes( pOutput, escape, ESCAPE_MAX_LENGTH );
+        }
+    }
+
+    *pIndex += sequenceLength;
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_EscapeString( const char * pString,
+                                        uint32_t stringLength,
+                                        char * pBuffer,
+                                        uint32_t bufferLength,
+                                        uint32_t * pOutLength )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    const uint8_t * pBytes = ( const uint8_t * ) pString;
+    EscapeOutput_t output;
+    uint32_t index = 0U, runEnd = 0U;
+
+    if( ( pString == NULL ) ||
+        ( pBuffer == NULL ) ||
+        ( pOutLength == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pString: %p, pBuffer: %p, pOutLength: %p.",
+                    ( const void * ) pString,
+                    ( void * ) pBuffer,
+                    ( void * ) pOutLength ) );
+    }
+    else
+    {
+        output.pBuffer = pBuffer;
+        output.bufferLength = bufferLength;
+        output.length = 0U;
+
+        while( ( index < stringLength ) && ( ret == DefenderSuccess ) )
+        {
+            runEnd = findSpecialByte( pBytes, index, stringLength );
+            ret = appendBytes( &( output ), &( pBytes[ index ] ), runEnd - index );
+            index = runEnd;
+
+            if( ( ret == DefenderSuccess ) && ( index < stringLength ) )
+            {
+                ret = escapeSpecialByte( pBytes, stringLength, &( index ), &( output ) );
+            }
+        }
+
+        if( ret == DefenderSuccess )
+        {
+            *pOutLength = output.length;
+        }
+        else if( ret == DefenderBufferTooSmall )
+        {
+            LogError( ( "The buffer is too small for the escaped string. bufferLength: %u.",
+                        ( unsigned int ) bufferLength ) );
+        }
+        else
+        {
+            /* Empty else MISRA 15.7 */
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
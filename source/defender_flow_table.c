@@ -0,0 +1,356 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_flow_table.c
+ * @brief Implementation of the flow table.
+ */
+
+/* Standard includes. */
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Flow table include. */
+#include "defender_flow_table.h"
+
+/**
+ * @brief Multipliers of the flow hash. They are odd and have well mixed bits.
+ */
+#define FLOW_TABLE_HASH_MULTIPLIER_1    UINT64_C( 0x9E3779B97F4A7C15 )
+#define FLOW_TABLE_HASH_MULTIPLIER_2    UINT64_C( 0xC2B2AE3D27D4EB4F )
+
+/**
+ * @brief Get the home slot of a flow.
+ *
+ * @param[in] pFlow The flow.
+ * @param[in] slotMask The slot count minus one.
+ *
+ * @return The slot.
+ */
+static uint32_t hashFlow( const DefenderFlow_t * pFlow,
+                          uint32_t slotMask );
+
+/**
+ * @brief Check whether two flows have the same tuple.
+ *
+ * @param[in] pFirst The first flow.
+ * @param[in] pSecond The second flow.
+ *
+ * @return 1 if the tuples are equal; 0 otherwise.
+ */
+static uint8_t isSameFlow( const DefenderFlow_t * pFirst,
+                           const DefenderFlow_t * pSecond );
+
+/**
+ * @brief Find the slot of a flow, or the empty slot where it would be
+ * inserted.
+ *
+ * @param[in] pTable The flow table.
+ * @param[in] pFlow The flow.
+ * @param[out] pSlot The slot.
+ *
+ * @return 1 if the flow is in the table; 0 otherwise.
+ */
+static uint8_t findSlot( const DefenderFlowTable_t * pTable,
+                         const DefenderFlow_t * pFlow,
+                         uint32_t * pSlot );
+
+/**
+ * @brief Empty a slot, and move the slots after it back so that every flow
+ * can still be reached from its home slot.
+ *
+ * @param[in] pTable The flow table.
+ * @param[in] slot The slot to empty.
+ */
+static void clearSlot( DefenderFlowTable_t * pTable,
+                       uint32_t slot );
+
+/*-----------------------------------------------------------*/
+
+static uint32_t hashFlow( const DefenderFlow_t * pFlow,
+                          uint32_t slotMask )
+{
+    uint64_t addresses, ports;
+
+    addresses = ( ( uint64_t ) pFlow->sourceAddress << 32 ) | pFlow->destinationAddress;
+    ports = ( ( uint64_t ) pFlow->sourcePort << 24 ) | ( ( uint64_t ) pFlow->destinationPort << 8 ) | pFlow->protocol;
+    addresses = ( addresses * FLOW_TABLE_HASH_MULTIPLIER_1 ) ^ ( ports * FLOW_TABLE_HASH_MULTIPLIER_2 );
+
+    /* The high bits of a product depend on all bits of its factors. */
+    return ( uint32_t ) ( addresses >> 32 ) & slotMask;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t isSameFlow( const DefenderFlow_t * pFirst,
+                           const DefenderFlow_t * pSecond )
+{
+    return ( ( pFirst->sourceAddress == pSecond->sourceAddress ) &&
+             ( pFirst->destinationAddress == pSecond->destinationAddress ) &&
+             ( pFirst->sourcePort == pSecond->sourcePort ) &&
+             ( pFirst->destinationPort == pSecond->destinationPort ) &&
+             ( pFirst->protocol == pSecond->protocol ) ) ? 1U : 0U;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t findSlot( const DefenderFlowTable_t * pTable,
+                         const DefenderFlow_t * pFlow,
+                         uint32_t * pSlot )
+{
+    uint32_t slotMask = pTable->slotCount - 1U;
+    uint32_t slot = hashFlow( pFlow, slotMask );
+    uint8_t found = 0U;
+
+    /* There are more slots than flows, so the search ends at an empty slot
+     * if the flow is not found. */
+    while( ( found == 0U ) && ( pTable->pSlots[ slot ] != 0U ) )
+    {
+        if( isSameFlow( &( pTable->pFlows[ pTable->pSlots[ slot ] - 1U ] ), pFlow ) == 1U )
+        {
+            found = 1U;
+        }
+        else
+        {
+            slot = ( slot + 1U ) & slotMask;
+        }
+    }
+
+    *pSlot = slot;
+
+    return found;
+}
+/*-----------------------------------------------------------*/
+
+static void clearSlot( DefenderFlowTable_t * pTable,
+                       uint32_t slot )
+{
+    uint32_t slotMask = pTable->slotCount - 1U;
+    uint32_t hole = slot, next = ( slot + 1U ) & slotMask, home;
+
+    while( pTable->pSlots[ next ] != 0U )
+    {
+        home = hashFlow( &( pTable->pFlows[ pTable->pSlots[ next ] - 1U ] ), slotMask );
+
+        /* The flow in the next slot can fill the hole unless its home slot
+         * lies after the hole, up to the next slot. */
+        if( ( ( next - home ) & slotMask ) >= ( ( next - hole ) & slotMask ) )
+        {
+            pTable->pSlots[ hole ] = pTable->pSlots[ next ];
+            hole = next;
+        }
+
+        next = ( next + 1U ) & slotMask;
+    }
+
+    pTable->pSlots[ hole ] = 0U;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_FlowTableInit( DefenderFlowTable_t * pTable,
+                                         DefenderFlow_t * pFlows,
+                                         uint32_t capacity,
+                                         uint32_t * pSlots,
+                                         uint32_t slotCount )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+
+    if( ( pTable == NULL ) ||
+        ( pFlows == NULL ) ||
+        ( pSlots == NULL ) ||
+        ( slotCount <= capacity ) ||
+        ( ( slotCount & ( slotCount - 1U ) ) != 0U ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pTable: %p, pFlows: %p, capacity: %u, "
+                    "pSlots: %p, slotCount: %u.",
+                    ( void * ) pTable,
+                    ( void * ) pFlows,
+                    ( unsigned int ) capacity,
+                    ( void * ) pSlots,
+                    ( unsigned int ) slotCount ) );
+    }
+    else
+    {
+        pTable->pFlows = pFlows;
+        pTable->count = 0U;
+        pTable->capacity = capacity;
+        pTable->pSlots = pSlots;
+        pTable->slotCount = slotCount;
+        ( void ) memset( pSlots, 0, ( size_t ) slotCount * sizeof( uint32_t ) );
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_FlowTableUpdate( DefenderFlowTable_t * pTable,
+                                           const DefenderFlow_t * pFlow )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    uint32_t slot = 0U;
+
+    if( ( pTable == NULL ) || ( pTable->pFlows == NULL ) || ( pTable->pSlots == NULL ) || ( pFlow == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pTable: %p, pFlow: %p.",
+                    ( void * ) pTable,
+                    ( const void * ) pFlow ) );
+    }
+    else if( findSlot( pTable, pFlow, &( slot ) ) == 1U )
+    {
+        pTable->pFlows[ pTable->pSlots[ slot ] - 1U ].bytesOriginal = pFlow->bytesOriginal;
+        pTable->pFlows[ pTable->pSlots[ slot ] - 1U ].bytesReply = pFlow->bytesReply;
+
+        if( pFlow->tcpState != DEFENDER_FLOW_TCP_STATE_NONE )
+        {
+            pTable->pFlows[ pTable->pSlots[ slot ] - 1U ].tcpState = pFlow->tcpState;
+        }
+    }
+    else if( pTable->count == pTable->capacity )
+    {
+        ret = DefenderBufferTooSmall;
+
+        LogError( ( "The flow table is full. capacity: %u.",
+                    ( unsigned int ) pTable->capacity ) );
+    }
+    else
+    {
+        pTable->pFlows[ pTable->count ] = *pFlow;
+        pTable->count++;
+        pTable->pSlots[ slot ] = pTable->count;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_FlowTableRemove( DefenderFlowTable_t * pTable,
+                                           const DefenderFlow_t * pFlow,
+                                           DefenderFlow_t * pOutFlow )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    uint32_t slot = 0U, index, lastSlot = 0U;
+    uint8_t found;
+
+    if( ( pTable == NULL ) || ( pTable->pFlows == NULL ) || ( pTable->pSlots == NULL ) || ( pFlow == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pTable: %p, pFlow: %p.",
+                    ( void * ) pTable,
+                    ( const void * ) pFlow ) );
+    }
+    else if( findSlot( pTable, pFlow, &( slot ) ) == 0U )
+    {
+        ret = DefenderError;
+
+        LogDebug( ( "The flow is not in the table." ) );
+    }
+    else
+    {
+        index = pTable->pSlots[ slot ] - 1U;
+
+        if( pOutFlow != NULL )
+        {
+            *pOutFlow = pTable->pFlows[ index ];
+        }
+
+        clearSlot( pTable, slot );
+        pTable->count--;
+
+        /* Move the last flow into the gap to keep the flows dense. */
+        if( index != pTable->count )
+        {
+            found = findSlot( pTable, &( pTable->pFlows[ pTable->count ] ), &( lastSlot ) );
+            assert( found == 1U );
+            ( void ) found;
+
+            pTable->pFlows[ index ] = pTable->pFlows[ pTable->count ];
+            pTable->pSlots[ lastSlot ] = index + 1U;
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_FlowTableClear( DefenderFlowTable_t * pTable )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+
+    if( ( pTable == NULL ) || ( pTable->pSlots == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pTable: %p.",
+                    ( void * ) pTable ) );
+    }
+    else
+    {
+        pTable->count = 0U;
+        ( void ) memset( pTable->pSlots, 0, ( size_t ) pTable->slotCount * sizeof( uint32_t ) );
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_FlowTableGetConnections( const DefenderFlowTable_t * pTable,
+                                                   DefenderConnectionTable_t * pConnections )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    const DefenderFlow_t * pFlow;
+    uint32_t i;
+
+    if( ( pTable == NULL ) || ( pTable->pFlows == NULL ) || ( pConnections == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pTable: %p, pConnections: %p.",
+                    ( const void * ) pTable,
+                    ( void * ) pConnections ) );
+    }
+    else
+    {
+        for( i = 0U; ( ret == DefenderSuccess ) && ( i < pTable->count ); i++ )
+        {
+            pFlow = &( pTable->pFlows[ i ] );
+
+            if( ( pFlow->protocol == DEFENDER_FLOW_PROTOCOL_TCP ) &&
+                ( pFlow->tcpState == DEFENDER_FLOW_TCP_STATE_ESTABLISHED ) )
+            {
+                ret = Defender_ConnectionTableAdd( pConnections,
+                                                   pFlow->destinationAddress,
+                                                   pFlow->destinationPort,
+                                                   pFlow->sourcePort,
+                                                   0U );
+            }
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,822 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_history.c
+ * @brief Implementation of the compressed history of a metric.
+ */
+
+/* Standard includes. */
+#include <assert.h>
+#include <inttypes.h>
+#include <stddef.h>
+#include <string.h>
+
+/* History include. */
+#include "defender_history.h"
+
+/**
+ * @brief Value of #DefenderHistory_t.lastLeading when no XOR was stored in
+ * the newest block.
+ */
+#define HISTORY_NO_WINDOW       64U
+
+/**
+ * @brief Bits of the leading zero count and of the length of a stored XOR.
+ */
+#define HISTORY_WINDOW_BITS     6U
+
+/**
+ * @brief State of the decompression of a block.
+ */
+typedef struct HistoryDecoder
+{
+    const uint8_t * pData; /**< @brief The data of the block. */
+    uint32_t bitOffset;    /**< @brief The next bit to read. */
+    uint32_t remaining;    /**< @brief Number of samples left, including the current one. */
+    uint64_t timestamp;    /**< @brief The time of the current sample. */
+    uint64_t value;        /**< @brief The value of the current sample. */
+    uint64_t delta;        /**< @brief Time between the current sample and the one before. */
+    uint32_t leading;      /**< @brief Leading zero bits of the last XOR read. */
+    uint32_t trailing;     /**< @brief Trailing zero bits of the last XOR read. */
+} HistoryDecoder_t;
+
+/**
+ * @brief Write bits into a block, most significant bit first.
+ *
+ * @param[in] pData The data of the block, zeroed after bitOffset.
+ * @param[in,out] pBitOffset The bit to write at, moved after the bits.
+ * @param[in] bits The bits, in the low bits.
+ * @param[in] bitCount Number of bits, up to 64.
+ */
+static void writeBits( uint8_t * pData,
+                       uint32_t * pBitOffset,
+                       uint64_t bits,
+                       uint32_t bitCount );
+
+/**
+ * @brief Read bits from a block, most significant bit first.
+ *
+ * @param[in] pData The data of the block.
+ * @param[in,out] pBitOffset The bit to read at, moved after the bits.
+ * @param[in] bitCount Number of bits, up to 64.
+ *
+ * @return The bits, in the low bits.
+ */
+static uint64_t readBits( const uint8_t * pData,
+                          uint32_t * pBitOffset,
+                          uint32_t bitCount );
+
+/**
+ * @brief Count the leading zero bits of a nonzero value.
+ *
+ * @param[in] value The value.
+ *
+ * @return The number of leading zero bits.
+ */
+static uint32_t countLeadingZeros( uint64_t value );
+
+/**
+ * @brief Count the trailing zero bits of a nonzero value.
+ *
+ * @param[in] value The value.
+ *
+ * @return The number of trailing zero bits.
+ */
+static uint32_t countTrailingZeros( uint64_t value );
+
+/**
+ * @brief Encode the change of interval between samples, so that small
+ * changes of either sign are small numbers.
+ *
+ * @param[in] deltaOfDelta The change of interval, modulo 2^64.
+ *
+ * @return The encoded change: twice its magnitude, plus 1 if negative.
+ */
+static uint64_t zigZagEncode( uint64_t deltaOfDelta );
+
+/**
+ * @brief Decode a change of interval encoded by #zigZagEncode.
+ *
+ * @param[in] encoded The encoded change.
+ *
+ * @return The change of interval, modulo 2^64.
+ */
+static uint64_t zigZagDecode( uint64_t encoded );
+
+/**
+ * @brief Get the number of bits of an encoded change of interval, without
+ * its prefix.
+ *
+ * @param[in] encoded The encoded change.
+ * @param[out] pPrefix The prefix of the bucket.
+ * @param[out] pPrefixLength Number of bits of the prefix.
+ *
+ * @return The number of bits after the prefix.
+ */
+static uint32_t timestampBucket( uint64_t encoded,
+                                 uint32_t * pPrefix,
+                                 uint32_t * pPrefixLength );
+
+/**
+ * @brief Get the number of bits of a compressed value.
+ *
+ * @param[in] pHistory The history.
+ * @param[in] xorValue The XOR of the value with the previous value.
+ *
+ * @return The number of bits.
+ */
+static uint32_t valueLength( const DefenderHistory_t * pHistory,
+                             uint64_t xorValue );
+
+/**
+ * @brief Write the compressed value of a sample.
+ *
+ * @param[in] pHistory The history.
+ * @param[in] pData The data of the newest block.
+ * @param[in,out] pBitOffset The bit to write at.
+ * @param[in] xorValue The XOR of the value with the previous value.
+ */
+static void writeValue( DefenderHistory_t * pHistory,
+                        uint8_t * pData,
+                        uint32_t * pBitOffset,
+                        uint64_t xorValue );
+
+/**
+ * @brief Start a new block with a sample, dropping the oldest block if all
+ * blocks are used.
+ *
+ * @param[in] pHistory The history.
+ * @param[in] timestampMs The time of the sample.
+ * @param[in] value The value of the sample.
+ */
+static void startBlock( DefenderHistory_t * pHistory,
+                        uint64_t timestampMs,
+                        uint64_t value );
+
+/**
+ * @brief Add a sample to a summary, as its newest sample.
+ *
+ * @param[in,out] pSummary The summary.
+ * @param[in] timestampMs The time of the sample.
+ * @param[in] value The value of the sample.
+ */
+static void addToSummary( DefenderHistorySummary_t * pSummary,
+                          uint64_t timestampMs,
+                          uint64_t value );
+
+/**
+ * @brief Add the samples of a summary to another summary, as its newest
+ * samples.
+ *
+ * @param[in,out] pSummary The summary to add to.
+ * @param[in] pNewer The summary of newer samples.
+ */
+static void mergeSummary( DefenderHistorySummary_t * pSummary,
+                          const DefenderHistorySummary_t * pNewer );
+
+/**
+ * @brief Get the index of a used block, from the oldest.
+ *
+ * @param[in] pHistory The history.
+ * @param[in] age 0 for the oldest block, up to usedCount - 1 for the newest.
+ *
+ * @return The index of the block.
+ */
+static uint32_t blockIndex( const DefenderHistory_t * pHistory,
+                            uint32_t age );
+
+/**
+ * @brief Start decompressing a block, at its first sample.
+ *
+ * @param[out] pDecoder The decoder.
+ * @param[in] pHistory The history.
+ * @param[in] index The index of the block.
+ */
+static void decoderStart( HistoryDecoder_t * pDecoder,
+                          const DefenderHistory_t * pHistory,
+                          uint32_t index );
+
+/**
+ * @brief Move a decoder to the next sample of its block.
+ *
+ * @param[in,out] pDecoder The decoder. Its remaining count becomes 0 after
+ * the last sample.
+ */
+static void decoderNext( HistoryDecoder_t * pDecoder );
+
+/**
+ * @brief Read the next compressed sample of a block.
+ *
+ * @param[in,out] pDecoder The decoder, at a sample which is not the last.
+ */
+static void decodeSample( HistoryDecoder_t * pDecoder );
+
+/*-----------------------------------------------------------*/
+
+static void writeBits( uint8_t * pData,
+                       uint32_t * pBitOffset,
+                       uint64_t bits,
+                       uint32_t bitCount )
+{
+    uint32_t left = bitCount, offset = *pBitOffset, freeBits, taken;
+
+    assert( bitCount <= 64U );
+
+    while( left > 0U )
+    {
+        freeBits = 8U - ( offset % 8U );
+        taken = ( left < freeBits ) ? left : freeBits;
+        pData[ offset / 8U ] |= ( uint8_t ) ( ( ( bits >> ( left - taken ) ) & ( ( 1U << taken ) - 1U ) ) <<
+                                              ( freeBits - taken ) );
+        offset += taken;
+        left -= taken;
+    }
+
+    *pBitOffset = offset;
+}
+/*-----------------------------------------------------------*/
+
+static uint64_t readBits( const uint8_t * pData,
+                          uint32_t * pBitOffset,
+                          uint32_t bitCount )
+{
+    uint32_t left = bitCount, offset = *pBitOffset, availableBits, taken;
+    uint64_t bits = 0U;
+
+    assert( bitCount <= 64U );
+
+    while( left > 0U )
+    {
+        availableBits = 8U - ( offset % 8U );
+        taken = ( left < availableBits ) ? left : availableBits;
+        bits = ( bits << taken ) |
+               ( ( ( uint64_t ) pData[ offset / 8U ] >> ( availableBits - taken ) ) & ( ( 1U << taken ) - 1U ) );
+        offset += taken;
+        left -= taken;
+    }
+
+    *pBitOffset = offset;
+
+    return bits;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t countLeadingZeros( uint64_t value )
+{
+    uint32_t count = 0U;
+
+    assert( value != 0U );
+
+    while( ( value & ( UINT64_C( 1 ) << ( 63U - count ) ) ) == 0U )
+    {
+        count++;
+    }
+
+    return count;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t countTrailingZeros( uint64_t value )
+{
+    uint32_t count = 0U;
+
+    assert( value != 0U );
+
+    while( ( value & ( UINT64_C( 1 ) << count ) ) == 0U )
+    {
+        count++;
+    }
+
+    return count;
+}
+/*-----------------------------------------------------------*/
+
+static uint64_t zigZagEncode( uint64_t deltaOfDelta )
+{
+    return ( ( deltaOfDelta >> 63 ) != 0U ) ? ( ( ( ~deltaOfDelta ) << 1 ) | 1U ) : ( deltaOfDelta << 1 );
+}
+/*-----------------------------------------------------------*/
+
+static uint64_t zigZagDecode( uint64_t encoded )
+{
+    return ( ( encoded & 1U ) != 0U ) ? ~( encoded >> 1 ) : ( encoded >> 1 );
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t timestampBucket( uint64_t encoded,
+                                 uint32_t * pPrefix,
+                                 uint32_t * pPrefixLength )
+{
+    uint32_t bitCount;
+
+    /* The buckets of Gorilla: '0' for the same interval, then '10', '110'
+     * and '1110' for small changes, and '1111' for any other change. */
+    if( encoded == 0U )
+    {
+        *pPrefix = 0x0U;
+        *pPrefixLength = 1U;
+        bitCount = 0U;
+    }
+    else if( encoded < ( UINT64_C( 1 ) << 7 ) )
+    {
+        *pPrefix = 0x2U;
+        *pPrefixLength = 2U;
+        bitCount = 7U;
+    }
+    else if( encoded < ( UINT64_C( 1 ) << 9 ) )
+    {
+        *pPrefix = 0x6U;
+        *pPrefixLength = 3U;
+        bitCount = 9U;
+    }
+    else if( encoded < ( UINT64_C( 1 ) << 12 ) )
+    {
+        *pPrefix = 0xEU;
+        *pPrefixLength = 4U;
+        bitCount = 12U;
+    }
+    else
+    {
+        *pPrefix = 0xFU;
+        *pPrefixLength = 4U;
+        bitCount = 64U;
+    }
+
+    return bitCount;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t valueLength( const DefenderHistory_t * pHistory,
+                             uint64_t xorValue )
+{
+    uint32_t length = 1U, leading, trailing;
+
+    if( xorValue != 0U )
+    {
+        leading = countLeadingZeros( xorValue );
+        trailing = countTrailingZeros( xorValue );
+
+        if( ( pHistory->lastLeading != HISTORY_NO_WINDOW ) &&
+            ( leading >= pHistory->lastLeading ) &&
+            ( trailing >= pHistory->lastTrailing ) )
+        {
+            /* '10' and the bits of the window of the last XOR. */
+            length = 2U + 64U - pHistory->lastLeading - pHistory->lastTrailing;
+        }
+        else
+        {
+            /* '11', the leading zero count, the length and the bits. */
+            length = 2U + ( 2U * HISTORY_WINDOW_BITS ) + 64U - leading - trailing;
+        }
+    }
+
+    return length;
+}
+/*-----------------------------------------------------------*/
+
+static void writeValue( DefenderHistory_t * pHistory,
+                        uint8_t * pData,
+                        uint32_t * pBitOffset,
+                        uint64_t xorValue )
+{
+    uint32_t leading, trailing, length;
+
+    if( xorValue == 0U )
+    {
+        writeBits( pData, pBitOffset, 0U, 1U );
+    }
+    else
+    {
+        leading = countLeadingZeros( xorValue );
+        trailing = countTrailingZeros( xorValue );
+
+        if( ( pHistory->lastLeading != HISTORY_NO_WINDOW ) &&
+            ( leading >= pHistory->lastLeading ) &&
+            ( trailing >= pHistory->lastTrailing ) )
+        {
+            writeBits( pData, pBitOffset, 0x2U, 2U );
+            writeBits( pData, pBitOffset, xorValue >> pHistory->lastTrailing,
+                       64U - pHistory->lastLeading - pHistory->lastTrailing );
+        }
+        else
+        {
+            length = 64U - leading - trailing;
+            writeBits( pData, pBitOffset, 0x3U, 2U );
+            writeBits( pData, pBitOffset, leading, HISTORY_WINDOW_BITS );
+            writeBits( pData, pBitOffset, length - 1U, HISTORY_WINDOW_BITS );
+            writeBits( pData, pBitOffset, xorValue >> trailing, length );
+            pHistory->lastLeading = leading;
+            pHistory->lastTrailing = trailing;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void startBlock( DefenderHistory_t * pHistory,
+                        uint64_t timestampMs,
+                        uint64_t value )
+{
+    DefenderHistoryBlock_t * pBlock;
+
+    if( pHistory->usedCount == 0U )
+    {
+        pHistory->headIndex = 0U;
+        pHistory->usedCount = 1U;
+    }
+    else
+    {
+        pHistory->headIndex = ( pHistory->headIndex + 1U ) % pHistory->blockCount;
+        pHistory->usedCount += ( pHistory->usedCount < pHistory->blockCount ) ? 1U : 0U;
+    }
+
+    pBlock = &( pHistory->pBlocks[ pHistory->headIndex ] );
+    ( void ) memset( &( pBlock->summary ), 0, sizeof( pBlock->summary ) );
+    addToSummary( &( pBlock->summary ), timestampMs, value );
+    pBlock->bitLength = 0U;
+    ( void ) memset( &( pHistory->pData[ ( size_t ) pHistory->headIndex * pHistory->blockLength ] ), 0,
+                     pHistory->blockLength );
+    pHistory->lastDelta = 0U;
+    pHistory->lastLeading = HISTORY_NO_WINDOW;
+    pHistory->lastTrailing = 0U;
+}
+/*-----------------------------------------------------------*/
+
+static void addToSummary( DefenderHistorySummary_t * pSummary,
+                          uint64_t timestampMs,
+                          uint64_t value )
+{
+    if( pSummary->count == 0U )
+    {
+        pSummary->firstTimestamp = timestampMs;
+        pSummary->firstValue = value;
+        pSummary->minValue = value;
+        pSummary->maxValue = value;
+    }
+    else
+    {
+        pSummary->minValue = ( value < pSummary->minValue ) ? value : pSummary->minValue;
+        pSummary->maxValue = ( value > pSummary->maxValue ) ? value : pSummary->maxValue;
+    }
+
+    pSummary->lastTimestamp = timestampMs;
+    pSummary->lastValue = value;
+    pSummary->sum += value;
+    pSummary->count++;
+}
+/*-----------------------------------------------------------*/
+
+static void mergeSummary( DefenderHistorySummary_t * pSummary,
+                          const DefenderHistorySummary_t * pNewer )
+{
+    if( pSummary->count == 0U )
+    {
+        *pSummary = *pNewer;
+    }
+    else if( pNewer->count > 0U )
+    {
+        pSummary->minValue = ( pNewer->minValue < pSummary->minValue ) ? pNewer->minValue : pSummary->minValue;
+        pSummary->maxValue = ( pNewer->maxValue > pSummary->maxValue ) ? pNewer->maxValue : pSummary->maxValue;
+        pSummary->lastTimestamp = pNewer->lastTimestamp;
+        pSummary->lastValue = pNewer->lastValue;
+        pSummary->sum += pNewer->sum;
+        pSummary->count += pNewer->count;
+    }
+    else
+    {
+        /* Empty else MISRA 15.7 */
+    }
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t blockIndex( const DefenderHistory_t * pHistory,
+                            uint32_t age )
+{
+    assert( age < pHistory->usedCount );
+
+    return ( pHistory->headIndex + pHistory->blockCount + 1U - pHistory->usedCount + age ) % pHistory->blockCount;
+}
+/*-----------------------------------------------------------*/
+
+static void decoderStart( HistoryDecoder_t * pDecoder,
+                          const DefenderHistory_t * pHistory,
+                          uint32_t index )
+{
+    const DefenderHistoryBlock_t * pBlock = &( pHistory->pBlocks[ index ] );
+
+    pDecoder->pData = &( pHistory->pData[ ( size_t ) index * pHistory->blockLength ] );
+    pDecoder->bitOffset = 0U;
+    pDecoder->remaining = pBlock->summary.count;
+    pDecoder->timestamp = pBlock->summary.firstTimestamp;
+    pDecoder->value = pBlock->summary.firstValue;
+    pDecoder->delta = 0U;
+    pDecoder->leading = HISTORY_NO_WINDOW;
+    pDecoder->trailing = 0U;
+}
+/*-----------------------------------------------------------*/
+
+static void decoderNext( HistoryDecoder_t * pDecoder )
+{
+    assert( pDecoder->remaining > 0U );
+
+    pDecoder->remaining--;
+
+    if( pDecoder->remaining > 0U )
+    {
+        decodeSample( pDecoder );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void decodeSample( HistoryDecoder_t * pDecoder )
+{
+    uint32_t prefixLength = 0U, bitCount;
+    uint64_t encoded = 0U;
+
+    /* The prefix of the timestamp bucket is up to four 1 bits. */
+    while( ( prefixLength < 4U ) && ( readBits( pDecoder->pData, &( pDecoder->bitOffset ), 1U ) != 0U ) )
+    {
+        prefixLength++;
+    }
+
+    if( prefixLength > 0U )
+    {
+        bitCount = ( prefixLength == 1U ) ? 7U : ( ( prefixLength == 2U ) ? 9U : ( ( prefixLength == 3U ) ? 12U : 64U ) );
+        encoded = readBits( pDecoder->pData, &( pDecoder->bitOffset ), bitCount );
+    }
+
+    pDecoder->delta += zigZagDecode( encoded );
+    pDecoder->timestamp += pDecoder->delta;
+
+    if( readBits( pDecoder->pData, &( pDecoder->bitOffset ), 1U ) != 0U )
+    {
+        if( readBits( pDecoder->pData, &( pDecoder->bitOffset ), 1U ) != 0U )
+        {
+            pDecoder->leading = ( uint32_t ) readBits( pDecoder->pData, &( pDecoder->bitOffset ), HISTORY_WINDOW_BITS );
+            pDecoder->trailing = 64U - pDecoder->leading -
+                                 ( ( uint32_t ) readBits( pDecoder->pData, &( pDecoder->bitOffset ), HISTORY_WINDOW_BITS ) + 1U );
+        }
+
+        pDecoder->value ^= readBits( pDecoder->pData, &( pDecoder->bitOffset ),
+                                     64U - pDecoder->leading - pDecoder->trailing ) << pDecoder->trailing;
+    }
+}
+/*-----------------------------------------------------------*/
+
+
+DefenderStatus_t Defender_HistoryInit( DefenderHistory_t * pHistory,
+                                       DefenderHistoryBlock_t * pBlocks,
+                                       uint32_t blockCount,
+                                       uint8_t * pData,
+                                       uint32_t blockLength )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+
+    /* Bit offsets in a block must fit in 32 bits. */
+    if( ( pHistory == NULL ) ||
+        ( pBlocks == NULL ) ||
+        ( blockCount == 0U ) ||
+        ( pData == NULL ) ||
+        ( blockLength < DEFENDER_HISTORY_MIN_BLOCK_LENGTH ) ||
+        ( blockLength > ( UINT32_MAX / 8U ) ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pHistory: %p, pBlocks: %p, blockCount: %u, "
+                    "pData: %p, blockLength: %u.",
+                    ( void * ) pHistory,
+                    ( void * ) pBlocks,
+                    ( unsigned int ) blockCount,
+                    ( void * ) pData,
+                    ( unsigned int ) blockLength ) );
+    }
+    else
+    {
+        pHistory->pBlocks = pBlocks;
+        pHistory->pData = pData;
+        pHistory->blockCount = blockCount;
+        pHistory->blockLength = blockLength;
+        pHistory->headIndex = 0U;
+        pHistory->usedCount = 0U;
+        pHistory->lastDelta = 0U;
+        pHistory->lastLeading = HISTORY_NO_WINDOW;
+        pHistory->lastTrailing = 0U;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_HistoryAppend( DefenderHistory_t * pHistory,
+                                         uint64_t timestampMs,
+                                         uint64_t value )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    DefenderHistoryBlock_t * pBlock = NULL;
+    uint8_t * pData = NULL;
+    uint64_t delta, encoded;
+    uint32_t prefix = 0U, prefixLength = 0U, bitCount;
+
+    if( ( pHistory == NULL ) || ( pHistory->pBlocks == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pHistory: %p.",
+                    ( void * ) pHistory ) );
+    }
+    else if( pHistory->usedCount == 0U )
+    {
+        startBlock( pHistory, timestampMs, value );
+    }
+    else
+    {
+        pBlock = &( pHistory->pBlocks[ pHistory->headIndex ] );
+        delta = timestampMs - pBlock->summary.lastTimestamp;
+
+        if( timestampMs <= pBlock->summary.lastTimestamp )
+        {
+            ret = DefenderError;
+
+            LogError( ( "The sample is not after the last sample. timestampMs: %" PRIu64 ", last: %" PRIu64 ".",
+                        timestampMs,
+                        pBlock->summary.lastTimestamp ) );
+        }
+        else
+        {
+            encoded = zigZagEncode( delta - pHistory->lastDelta );
+            bitCount = timestampBucket( encoded, &( prefix ), &( prefixLength ) );
+
+            if( ( ( ( uint64_t ) pHistory->blockLength * 8U ) - pBlock->bitLength ) <
+                ( ( uint64_t ) prefixLength + bitCount + valueLength( pHistory, value ^ pBlock->summary.lastValue ) ) )
+            {
+                startBlock( pHistory, timestampMs, value );
+            }
+            else
+            {
+                pData = &( pHistory->pData[ ( size_t ) pHistory->headIndex * pHistory->blockLength ] );
+
+                writeBits( pData, &( pBlock->bitLength ), prefix, prefixLength );
+                writeBits( pData, &( pBlock->bitLength ), encoded, bitCount );
+                writeValue( pHistory, pData, &( pBlock->bitLength ), value ^ pBlock->summary.lastValue );
+                pHistory->lastDelta = delta;
+                addToSummary( &( pBlock->summary ), timestampMs, value );
+            }
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_HistoryScan( const DefenderHistory_t * pHistory,
+                                       uint64_t startMs,
+                                       uint64_t endMs,
+                                       DefenderHistorySample_t * pSamples,
+                                       uint32_t sampleCapacity,
+                                       uint32_t * pOutCount )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    const DefenderHistorySummary_t * pSummary;
+    HistoryDecoder_t decoder;
+    uint32_t age, count = 0U;
+
+    if( ( pHistory == NULL ) ||
+        ( pHistory->pBlocks == NULL ) ||
+        ( startMs > endMs ) ||
+        ( pSamples == NULL ) ||
+        ( pOutCount == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pHistory: %p, startMs: %" PRIu64 ", endMs: %" PRIu64 ", "
+                    "pSamples: %p, pOutCount: %p.",
+                    ( const void * ) pHistory,
+                    startMs,
+                    endMs,
+                    ( void * ) pSamples,
+                    ( void * ) pOutCount ) );
+    }
+    else
+    {
+        for( age = 0U; ( ret == DefenderSuccess ) && ( age < pHistory->usedCount ); age++ )
+        {
+            pSummary = &( pHistory->pBlocks[ blockIndex( pHistory, age ) ].summary );
+
+            /* Blocks outside the range are not decompressed. */
+            if( ( pSummary->lastTimestamp >= startMs ) && ( pSummary->firstTimestamp <= endMs ) )
+            {
+                decoderStart( &( decoder ), pHistory, blockIndex( pHistory, age ) );
+
+                while( ( ret == DefenderSuccess ) && ( decoder.remaining > 0U ) && ( decoder.timestamp <= endMs ) )
+                {
+                    if( decoder.timestamp < startMs )
+                    {
+                        decoderNext( &( decoder ) );
+                    }
+                    else if( count == sampleCapacity )
+                    {
+                        ret = DefenderBufferTooSmall;
+                    }
+                    else
+                    {
+                        pSamples[ count ].timestamp = decoder.timestamp;
+                        pSamples[ count ].value = decoder.value;
+                        count++;
+                        decoderNext( &( decoder ) );
+                    }
+                }
+            }
+        }
+
+        *pOutCount = count;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_HistoryAggregate( const DefenderHistory_t * pHistory,
+                                            uint64_t startMs,
+                                            uint64_t endMs,
+                                            DefenderHistorySummary_t * pOutSummary )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    const DefenderHistorySummary_t * pSummary;
+    DefenderHistorySummary_t partial;
+    HistoryDecoder_t decoder;
+    uint32_t age;
+
+    if( ( pHistory == NULL ) ||
+        ( pHistory->pBlocks == NULL ) ||
+        ( startMs > endMs ) ||
+        ( pOutSummary == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pHistory: %p, startMs: %" PRIu64 ", endMs: %" PRIu64 ", pOutSummary: %p.",
+                    ( const void * ) pHistory,
+                    startMs,
+                    endMs,
+                    ( void * ) pOutSummary ) );
+    }
+    else
+    {
+        ( void ) memset( pOutSummary, 0, sizeof( DefenderHistorySummary_t ) );
+
+        for( age = 0U; age < pHistory->usedCount; age++ )
+        {
+            pSummary = &( pHistory->pBlocks[ blockIndex( pHistory, age ) ].summary );
+
+            if( ( pSummary->firstTimestamp >= startMs ) && ( pSummary->lastTimestamp <= endMs ) )
+            {
+                /* All samples of the block are in the range. */
+                mergeSummary( pOutSummary, pSummary );
+            }
+            else if( ( pSummary->lastTimestamp >= startMs ) && ( pSummary->firstTimestamp <= endMs ) )
+            {
+                ( void ) memset( &( partial ), 0, sizeof( partial ) );
+                decoderStart( &( decoder ), pHistory, blockIndex( pHistory, age ) );
+
+                while( ( decoder.remaining > 0U ) && ( decoder.timestamp <= endMs ) )
+                {
+                    if( decoder.timestamp >= startMs )
+                    {
+                        addToSummary( &( partial ), decoder.timestamp, decoder.value );
+                    }
+
+                    decoderNext( &( decoder ) );
+                }
+
+                mergeSummary( pOutSummary, &( partial ) );
+            }
+            else
+            {
+                /* Empty else: the block is outside the range. */
+            }
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
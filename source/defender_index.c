@@ -0,0 +1,483 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/**
+ * @file defender_index.c
+ * @brief Implementation of indexing the structure of JSON payloads.
+ */
+
+/* Standard includes. */
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Index API include. */
+#include "defender_index.h"
+
+#if ( DEFENDER_USE_SIMD == 1 ) && defined( __AVX2__ )
+    #include <immintrin.h>
+    #define INDEX_USE_AVX2
+#elif ( DEFENDER_USE_SIMD == 1 ) && defined( __ARM_NEON ) && defined( __aarch64__ )
+    #include <arm_neon.h>
+    #define INDEX_USE_NEON
+#endif
+
+/**
+ * @brief Number of bytes classified at a time, one per bit of a 64-bit mask.
+ */
+#define INDEX_BLOCK_SIZE    64U
+
+/**
+ * @brief Multiplier of the de Bruijn sequence used to find the lowest set bit.
+ */
+#define INDEX_DE_BRUIJN     UINT64_C( 0x03F79D71B4CB0A89 )
+
+/**
+ * @brief A 64-bit word with every byte set to the given byte.
+ */
+#define INDEX_REPEAT( byte )    ( UINT64_C( 0x0101010101010101 ) * ( uint64_t ) ( byte ) )
+
+/**
+ * @brief Characters of a block, one bit per byte of the block.
+ */
+typedef struct IndexBlock
+{
+    uint64_t quotes;      /**< Quotes. */
+    uint64_t backslashes; /**< Backslashes. */
+    uint64_t structurals; /**< Braces, brackets, colons and commas. */
+    uint64_t controls;    /**< Bytes below 0x20. */
+} IndexBlock_t;
+
+/**
+ * @brief State carried from one block to the next.
+ */
+typedef struct IndexState
+{
+    uint64_t isEscaped; /**< 1 if the first byte of the next block is escaped. */
+    uint64_t inString;  /**< All ones if the next block starts inside a string. */
+    uint64_t errors;    /**< Non-zero if an error has been found. */
+} IndexState_t;
+
+/**
+ * @brief Classify the bytes of a block.
+ *
+ * @param[in] pBlock The block of #INDEX_BLOCK_SIZE bytes.
+ * @param[out] pOutBlock The characters of the block.
+ */
+static void classifyBlock( const uint8_t * pBlock,
+                           IndexBlock_t * pOutBlock );
+
+/**
+ * @brief Find the bytes of a block which are escaped by a backslash.
+ *
+ * @param[in] backslashes The backslashes of the block.
+ * @param[in,out] pState The state carried between blocks.
+ *
+ * @return One bit for every escaped byte.
+ */
+static uint64_t findEscaped( uint64_t backslashes,
+                             IndexState_t * pState );
+
+/**
+ * @brief Compute the running XOR of the bits of a word, from the lowest bit.
+ *
+ * @param[in] bits The bits.
+ *
+ * @return Bit i is the XOR of bits 0 to i of the input.
+ */
+static uint64_t prefixXor( uint64_t bits );
+
+/**
+ * @brief Index the structural characters of a block.
+ *
+ * @param[in] pBlock The block of #INDEX_BLOCK_SIZE bytes.
+ * @param[in] blockStart The position of the block in the payload.
+ * @param[in,out] pState The state carried between blocks.
+ * @param[out] pOutIndex The positions of the structural characters.
+ * @param[in] indexLength The number of entries in pOutIndex.
+ * @param[in,out] pCount The number of positions written to pOutIndex.
+ *
+ * @return #DefenderSuccess if all positions fit in the index;
+ * #DefenderBufferTooSmall otherwise.
+ */
+static DefenderStatus_t indexBlock( const uint8_t * pBlock,
+                                    uint32_t blockStart,
+                                    IndexState_t * pState,
+                                    uint32_t * pOutIndex,
+                                    uint32_t indexLength,
+                                    uint32_t * pCount );
+/*-----------------------------------------------------------*/
+
+#if defined( INDEX_USE_AVX2 )
+
+/**
+ * @brief Classify 32 bytes with AVX2.
+ *
+ * @param[in] bytes The bytes.
+ * @param[out] pOutBlock The characters, in the low 32 bits of each mask.
+ */
+    static void classifyAvx2( __m256i bytes,
+                              IndexBlock_t * pOutBlock )
+    {
+        __m256i lower = _mm256_or_si256( bytes, _mm256_set1_epi8( 0x20 ) );
+        __m256i structurals;
+
+        /* Setting bit 5 turns brackets into braces. */
+        structurals = _mm256_or_si256( _mm256_cmpeq_epi8( lower, _mm256_set1_epi8( '{' ) ),
+                                       _mm256_cmpeq_epi8( lower, _mm256_set1_epi8( '}' ) ) );
+        structurals = _mm256_or_si256( structurals, _mm256_cmpeq_epi8( bytes, _mm256_set1_epi8( ':' ) ) );
+        structurals = _mm256_or_si256( structurals, _mm256_cmpeq_epi8( bytes, _mm256_set1_epi8( ',' ) ) );
+
+        pOutBlock->quotes = ( uint32_t ) _mm256_movemask_epi8( _mm256_cmpeq_epi8( bytes, _mm256_set1_epi8( '"' ) ) );
+        pOutBlock->backslashes = ( uint32_t ) _mm256_movemask_epi8( _mm256_cmpeq_epi8( bytes, _mm256_set1_epi8( '\\' ) ) );
+        pOutBlock->structurals = ( uint32_t ) _mm256_movemask_epi8( structurals );
+        /* A byte is below 0x20 if the unsigned maximum with 0x1F is 0x1F. */
+        pOutBlock->controls = ( uint32_t ) _mm256_movemask_epi8(
+            _mm256_cmpeq_epi8( _mm256_max_epu8( bytes, _mm256_set1_epi8( 0x1F ) ),
+                               _mm256_set1_epi8( 0x1F ) ) );
+    }
+/*-----------------------------------------------------------*/
+
+    static void classifyBlock( const uint8_t * pBlock,
+                               IndexBlock_t * pOutBlock )
+    {
+        IndexBlock_t high;
+
+        classifyAvx2( _mm256_loadu_si256( ( const __m256i * ) pBlock ), pOutBlock );
+        classifyAvx2( _mm256_loadu_si256( ( const __m256i * ) &( pBlock[ 32 ] ) ), &( high ) );
+
+        pOutBlock->quotes |= high.quotes << 32;
+        pOutBlock->backslashes |= high.backslashes << 32;
+        pOutBlock->structurals |= high.structurals << 32;
+        pOutBlock->controls |= high.controls << 32;
+    }
+/*-----------------------------------------------------------*/
+
+#elif defined( INDEX_USE_NEON )
+
+/**
+ * @brief Gather the comparison results of 64 bytes into one bit per byte.
+ *
+ * @param[in] pMatches Four comparison results of 16 bytes each.
+ *
+ * @return One bit for every matching byte.
+ */
+    static uint64_t toMask( const uint8x16_t * pMatches )
+    {
+        static const uint8_t bitValues[ 16 ] =
+        {
+            0x01U, 0x02U, 0x04U, 0x08U, 0x10U, 0x20U, 0x40U, 0x80U,
+            0x01U, 0x02U, 0x04U, 0x08U, 0x10U, 0x20U, 0x40U, 0x80U
+        };
+        uint8x16_t bits = vld1q_u8( bitValues );
+        uint8x16_t low = vpaddq_u8( vandq_u8( pMatches[ 0 ], bits ), vandq_u8( pMatches[ 1 ], bits ) );
+        uint8x16_t high = vpaddq_u8( vandq_u8( pMatches[ 2 ], bits ), vandq_u8( pMatches[ 3 ], bits ) );
+
+        /* Two more pairwise additions leave byte i holding bits 8i to 8i + 7. */
+        low = vpaddq_u8( low, high );
+        low = vpaddq_u8( low, low );
+
+        return vgetq_lane_u64( vreinterpretq_u64_u8( low ), 0 );
+    }
+/*-----------------------------------------------------------*/
+
+    static void classifyBlock( const uint8_t * pBlock,
+                               IndexBlock_t * pOutBlock )
+    {
+        uint8x16_t quotes[ 4 ], backslashes[ 4 ], structurals[ 4 ], controls[ 4 ];
+        uint8x16_t bytes, lower;
+        size_t i;
+
+        for( i = 0U; i < 4U; i++ )
+        {
+            bytes = vld1q_u8( &( pBlock[ 16U * i ] ) );
+            /* Setting bit 5 turns brackets into braces. */
+            lower = vorrq_u8( bytes, vdupq_n_u8( 0x20U ) );
+
+            quotes[ i ] = vceqq_u8( bytes, vdupq_n_u8( ( uint8_t ) '"' ) );
+            backslashes[ i ] = vceqq_u8( bytes, vdupq_n_u8( ( uint8_t ) '\\' ) );
+            structurals[ i ] = vorrq_u8( vorrq_u8( vceqq_u8( lower, vdupq_n_u8( ( uint8_t ) '{' ) ),
+                                                   vceqq_u8( lower, vdupq_n_u8( ( uint8_t ) '}' ) ) ),
+                                         vorrq_u8( vceqq_u8( bytes, vdupq_n_u8( ( uint8_t ) ':' ) ),
+                                                   vceqq_u8( bytes, vdupq_n_u8( ( uint8_t ) ',' ) ) ) );
+            controls[ i ] = vcltq_u8( bytes, vdupq_n_u8( 0x20U ) );
+        }
+
+        pOutBlock->quotes = toMask( quotes );
+        pOutBlock->backslashes = toMask( backslashes );
+        pOutBlock->structurals = toMask( structurals );
+        pOutBlock->controls = toMask( controls );
+    }
+/*-----------------------------------------------------------*/
+
+#else /* if defined( INDEX_USE_AVX2 ) */
+
+/**
+ * @brief Load 8 bytes into a word, with the first byte in the lowest bits.
+ *
+ * @param[in] pBytes The bytes.
+ *
+ * @return The word.
+ */
+    static uint64_t loadWord( const uint8_t * pBytes )
+    {
+        static const uint16_t byteOrder = 1U;
+        uint64_t word, swapped = 0U;
+        size_t i;
+
+        ( void ) memcpy( &( word ), pBytes, sizeof( word ) );
+
+        /* The check is a constant, so little endian targets keep a single
+         * load. */
+        if( *( ( const uint8_t * ) &( byteOrder ) ) == 0U )
+        {
+            for( i = 0U; i < 8U; i++ )
+            {
+                swapped = ( swapped << 8 ) | ( ( word >> ( 8U * i ) ) & 0xFFU );
+            }
+
+            word = swapped;
+        }
+
+        return word;
+    }
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Set the high bit of every zero byte of a word and clear all others.
+ *
+ * Unlike the usual "has zero byte" test, this never marks a byte which
+ * follows a zero byte, so every bit of the result is exact.
+ *
+ * @param[in] word The word.
+ *
+ * @return The high bits of the zero bytes.
+ */
+    static uint64_t zeroBytes( uint64_t word )
+    {
+        uint64_t low = INDEX_REPEAT( 0x7FU );
+
+        return ~( ( ( word & low ) + low ) | word | low );
+    }
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Gather the high bit of every byte of a word into the low 8 bits.
+ *
+ * @param[in] highBits A word with only the high bits of bytes set.
+ *
+ * @return Bit i is the high bit of byte i.
+ */
+    static uint64_t toMask( uint64_t highBits )
+    {
+        /* The multiplication moves the bit of byte i to bit 56 + i without
+         * any carries. */
+        return ( ( highBits >> 7 ) * UINT64_C( 0x0102040810204080 ) ) >> 56;
+    }
+/*-----------------------------------------------------------*/
+
+    static void classifyBlock( const uint8_t * pBlock,
+                               IndexBlock_t * pOutBlock )
+    {
+        uint64_t word, lower, low = INDEX_REPEAT( 0x7FU );
+        uint32_t shift;
+
+        ( void ) memset( pOutBlock, 0, sizeof( IndexBlock_t ) );
+
+        for( shift = 0U; shift < INDEX_BLOCK_SIZE; shift += 8U )
+        {
+            word = loadWord( &( pBlock[ shift ] ) );
+            /* Setting bit 5 turns brackets into braces. */
+            lower = word | INDEX_REPEAT( 0x20U );
+
+            pOutBlock->quotes |= toMask( zeroBytes( word ^ INDEX_REPEAT( '"' ) ) ) << shift;
+            pOutBlock->backslashes |= toMask( zeroBytes( word ^ INDEX_REPEAT( '\\' ) ) ) << shift;
+            pOutBlock->structurals |= toMask( zeroBytes( lower ^ INDEX_REPEAT( '{' ) ) |
+                                              zeroBytes( lower ^ INDEX_REPEAT( '}' ) ) |
+                                              zeroBytes( word ^ INDEX_REPEAT( ':' ) ) |
+                                              zeroBytes( word ^ INDEX_REPEAT( ',' ) ) ) << shift;
+            /* Adding 0x60 to the low 7 bits sets the high bit from 0x20 up. */
+            pOutBlock->controls |= toMask( ~( ( ( word & low ) + INDEX_REPEAT( 0x60U ) ) | word | low ) ) << shift;
+        }
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* if defined( INDEX_USE_AVX2 ) */
+
+static uint64_t findEscaped( uint64_t backslashes,
+                             IndexState_t * pState )
+{
+    uint64_t escaped = pState->isEscaped;
+    uint64_t remaining = backslashes & ~escaped;
+    uint64_t lowest;
+
+    pState->isEscaped = 0U;
+
+    /* Backslashes are rare, so every backslash which is not itself escaped
+     * simply escapes the byte after it. */
+    while( remaining != 0U )
+    {
+        lowest = remaining & ( ~remaining + 1U );
+        escaped |= lowest << 1;
+        remaining &= ~( lowest | ( lowest << 1 ) );
+        pState->isEscaped = lowest >> 63;
+    }
+
+    return escaped;
+}
+/*-----------------------------------------------------------*/
+
+static uint64_t prefixXor( uint64_t bits )
+{
+    uint64_t result = bits;
+
+    result ^= result << 1;
+    result ^= result << 2;
+    result ^= result << 4;
+    result ^= result << 8;
+    result ^= result << 16;
+    result ^= result << 32;
+
+    return result;
+}
+/*-----------------------------------------------------------*/
+
+static DefenderStatus_t indexBlock( const uint8_t * pBlock,
+                                    uint32_t blockStart,
+                                    IndexState_t * pState,
+                                    uint32_t * pOutIndex,
+                                    uint32_t indexLength,
+                                    uint32_t * pCount )
+{
+    static const uint8_t lowestBit[ 64 ] =
+    {
+        0U,  1U,  48U, 2U,  57U, 49U, 28U, 3U,  61U, 58U, 50U, 42U, 38U, 29U, 17U, 4U,
+        62U, 55U, 59U, 36U, 53U, 51U, 43U, 22U, 45U, 39U, 33U, 30U, 24U, 18U, 12U, 5U,
+        63U, 47U, 56U, 27U, 60U, 41U, 37U, 16U, 54U, 35U, 52U, 21U, 44U, 32U, 23U, 11U,
+        46U, 26U, 40U, 15U, 34U, 20U, 31U, 10U, 25U, 14U, 19U, 9U,  13U, 8U,  7U,  6U
+    };
+    DefenderStatus_t ret = DefenderSuccess;
+    IndexBlock_t block;
+    uint64_t escaped, quotes, inString, tokens, lowest;
+
+    assert( pState != NULL );
+    assert( pCount != NULL );
+
+    classifyBlock( pBlock, &( block ) );
+
+    escaped = findEscaped( block.backslashes, pState );
+    quotes = block.quotes & ~escaped;
+
+    /* A string covers its opening quote and its content, not its closing
+     * quote. */
+    inString = prefixXor( quotes ) ^ pState->inString;
+    pState->inString = ( uint64_t ) 0U - ( inString >> 63 );
+
+    pState->errors |= ( block.controls & inString & ~escaped ) |
+                      ( block.backslashes & ~inString );
+
+    tokens = ( block.structurals & ~inString ) | quotes;
+
+    while( ( tokens != 0U ) && ( ret == DefenderSuccess ) )
+    {
+        if( *pCount == indexLength )
+        {
+            ret = DefenderBufferTooSmall;
+        }
+        else
+        {
+            lowest = tokens & ( ~tokens + 1U );
+            pOutIndex[ *pCount ] = blockStart + ( uint32_t ) lowestBit[ ( lowest * INDEX_DE_BRUIJN ) >> 58 ];
+            ( *pCount )++;
+            tokens ^= lowest;
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_IndexStructurals( const char * pPayload,
+                                            uint32_t payloadLength,
+                                            uint32_t * pOutIndex,
+                                            uint32_t indexLength,
+                                            uint32_t * pOutCount )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    IndexState_t state = { 0U, 0U, 0U };
+    uint8_t lastBlock[ INDEX_BLOCK_SIZE ];
+    const uint8_t * pBlock;
+    uint32_t blockStart = 0U, blockLength, count = 0U;
+
+    if( ( pPayload == NULL ) || ( payloadLength == 0U ) ||
+        ( pOutIndex == NULL ) || ( indexLength == 0U ) || ( pOutCount == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pPayload: %p, payloadLength: %u, "
+                    "pOutIndex: %p, indexLength: %u, pOutCount: %p.",
+                    ( const void * ) pPayload,
+                    ( unsigned int ) payloadLength,
+                    ( void * ) pOutIndex,
+                    ( unsigned int ) indexLength,
+                    ( void * ) pOutCount ) );
+    }
+
+    while( ( ret == DefenderSuccess ) && ( state.errors == 0U ) && ( blockStart < payloadLength ) )
+    {
+        blockLength = payloadLength - blockStart;
+
+        if( blockLength < INDEX_BLOCK_SIZE )
+        {
+            /* Pad the last block with whitespace, which is never structural. */
+            ( void ) memset( &( lastBlock[ 0 ] ), ( int ) ' ', sizeof( lastBlock ) );
+            ( void ) memcpy( &( lastBlock[ 0 ] ), &( pPayload[ blockStart ] ), ( size_t ) blockLength );
+            pBlock = &( lastBlock[ 0 ] );
+        }
+        else
+        {
+            blockLength = INDEX_BLOCK_SIZE;
+            pBlock = ( const uint8_t * ) &( pPayload[ blockStart ] );
+        }
+
+        ret = indexBlock( pBlock, blockStart, &( state ), pOutIndex, indexLength, &( count ) );
+        blockStart += blockLength;
+    }
+
+    if( ( ret == DefenderSuccess ) && ( ( state.errors != 0U ) || ( state.inString != 0U ) ) )
+    {
+        ret = DefenderError;
+
+        LogDebug( ( "The payload has an unclosed string or an invalid character." ) );
+    }
+
+    if( ret == DefenderSuccess )
+    {
+        *pOutCount = count;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
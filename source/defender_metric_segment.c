@@ -0,0 +1,791 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_metric_segment.c
+ * @brief Implementation of sharing custom metrics through shared memory.
+ */
+
+/* Standard includes. */
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Metric segment include. */
+#include "defender_metric_segment.h"
+
+/* Writer include. */
+#include "defender_writer.h"
+
+/**
+ * @brief Magic bytes at the start of a metric segment.
+ */
+#define METRIC_SEGMENT_MAGIC                  "DDMS"
+
+/**
+ * @brief Length of the magic bytes.
+ */
+#define METRIC_SEGMENT_LENGTH_MAGIC           4U
+
+/**
+ * @brief Version of the layout of a metric segment.
+ */
+#define METRIC_SEGMENT_VERSION                1U
+
+/**
+ * @brief Offsets of the header fields of a metric segment.
+ */
+#define METRIC_SEGMENT_VERSION_OFFSET         4U
+#define METRIC_SEGMENT_RECORD_COUNT_OFFSET    8U
+#define METRIC_SEGMENT_VALUE_LENGTH_OFFSET    12U
+
+/**
+ * @brief Offsets of the header fields of a record.
+ */
+#define METRIC_RECORD_TYPE_OFFSET             4U
+#define METRIC_RECORD_LENGTH_OFFSET           8U
+
+/**
+ * @brief Number of times a record is read before it is left out of a report
+ * because it keeps changing.
+ */
+#define METRIC_SEGMENT_MAX_READS              16U
+
+/**
+ * @brief Parts of the custom metrics object.
+ */
+#define METRIC_NUMBER_START                   "\":[{\"" DEFENDER_REPORT_NUMBER_KEY "\":"
+#define METRIC_NUMBER_LIST_START              "\":[{\"" DEFENDER_REPORT_NUMBER_LIST_KEY "\":["
+#define METRIC_STRING_LIST_START              "\":[{\"" DEFENDER_REPORT_STRING_LIST_KEY "\":["
+#define METRIC_IP_LIST_START                  "\":[{\"" DEFENDER_REPORT_IP_LIST_KEY "\":["
+#define METRIC_NUMBER_END                     "}]"
+#define METRIC_LIST_END                       "]}]"
+
+/**
+ * @brief Compute the layout of a metric segment.
+ *
+ * @param[in] recordCount Number of records.
+ * @param[in] valueLength Maximum length of the value of a record.
+ * @param[out] pOutRecordLength The length of a record.
+ * @param[out] pOutLength The length of the segment.
+ *
+ * @return #DefenderSuccess if the segment fits in 32 bits;
+ * #DefenderBadParameter otherwise.
+ */
+static DefenderStatus_t getLayout( uint32_t recordCount,
+                                   uint32_t valueLength,
+                                   uint32_t * pOutRecordLength,
+                                   uint32_t * pOutLength );
+
+/**
+ * @brief Get a record of a segment.
+ *
+ * @param[in] pSegment The segment.
+ * @param[in] metricId The metric ID.
+ *
+ * @return The first byte of the record.
+ */
+static uint8_t * getRecord( const DefenderMetricSegment_t * pSegment,
+                            uint32_t metricId );
+
+/**
+ * @brief Get the sequence number of a record.
+ *
+ * @param[in] pRecord The record.
+ *
+ * @return The sequence number, which every access must go through.
+ */
+static volatile uint32_t * getSequence( uint8_t * pRecord );
+
+/**
+ * @brief Check that a value has the layout of its type.
+ *
+ * @param[in] type The type.
+ * @param[in] pValue The value.
+ * @param[in] valueLength The length of the value.
+ *
+ * @return 1 if the value is valid; 0 otherwise.
+ */
+static uint8_t isValidValue( uint32_t type,
+                             const uint8_t * pValue,
+                             uint32_t valueLength );
+
+/**
+ * @brief Append the elements of a list value to the serializer output.
+ *
+ * The value is checked while it is written, as a writer may change it at any
+ * time. No element is read past the end of the value.
+ *
+ * @param[in] pWriter The serializer state.
+ * @param[in] type The type of the value, which must be a list.
+ * @param[in] pValue The value.
+ * @param[in] valueLength The length of the value.
+ *
+ * @return 1 if every element lies within the value; 0 otherwise.
+ */
+static uint8_t writeListElements( DefenderWriter_t * pWriter,
+                                  uint32_t type,
+                                  const uint8_t * pValue,
+                                  uint32_t valueLength );
+
+/**
+ * @brief Append a metric to the serializer output, from a snapshot of its
+ * record.
+ *
+ * The value is checked as it is written, since a writer may change it
+ * between any two reads.
+ *
+ * @param[in] pWriter The serializer state.
+ * @param[in] type The type of the value.
+ * @param[in] pValue The value.
+ * @param[in] valueLength The length of the value.
+ *
+ * @return 1 if the value is valid and written; 0 if it is not valid.
+ */
+static uint8_t writeValue( DefenderWriter_t * pWriter,
+                           uint32_t type,
+                           const uint8_t * pValue,
+                           uint32_t valueLength );
+
+/**
+ * @brief Append the value of a record to the serializer output, reading the
+ * record again if it changes while it is written.
+ *
+ * Nothing is written for a record without a valid value.
+ *
+ * @param[in] pWriter The serializer state.
+ * @param[in] pSegment The segment.
+ * @param[in] metricId The metric ID.
+ *
+ * @return 1 if the value is written; 0 otherwise.
+ */
+static uint8_t writeRecord( DefenderWriter_t * pWriter,
+                            const DefenderMetricSegment_t * pSegment,
+                            uint32_t metricId );
+/*-----------------------------------------------------------*/
+
+static DefenderStatus_t getLayout( uint32_t recordCount,
+                                   uint32_t valueLength,
+                                   uint32_t * pOutRecordLength,
+                                   uint32_t * pOutLength )
+{
+    DefenderStatus_t ret = DefenderBadParameter;
+    uint32_t recordLength = 0U;
+
+    if( ( recordCount > 0U ) &&
+        ( valueLength <= ( UINT32_MAX - DEFENDER_METRIC_RECORD_HEADER_LENGTH - DEFENDER_METRIC_RECORD_ALIGNMENT ) ) )
+    {
+        recordLength = DEFENDER_METRIC_RECORD_HEADER_LENGTH + valueLength + DEFENDER_METRIC_RECORD_ALIGNMENT - 1U;
+        recordLength -= recordLength % DEFENDER_METRIC_RECORD_ALIGNMENT;
+
+        if( recordCount <= ( ( UINT32_MAX - DEFENDER_METRIC_SEGMENT_HEADER_LENGTH ) / recordLength ) )
+        {
+            *pOutRecordLength = recordLength;
+            *pOutLength = DEFENDER_METRIC_SEGMENT_HEADER_LENGTH + ( recordCount * recordLength );
+            ret = DefenderSuccess;
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t * getRecord( const DefenderMetricSegment_t * pSegment,
+                            uint32_t metricId )
+{
+    assert( metricId < pSegment->recordCount );
+
+    return &( pSegment->pMemory[ DEFENDER_METRIC_SEGMENT_HEADER_LENGTH + ( metricId * pSegment->recordLength ) ] );
+}
+/*-----------------------------------------------------------*/
+
+static volatile uint32_t * getSequence( uint8_t * pRecord )
+{
+    /* Records start on a multiple of DEFENDER_METRIC_RECORD_ALIGNMENT from
+     * memory aligned to 8 bytes, so the sequence number is aligned. */
+    /* coverity[misra_c_2012_rule_11_3_violation] */
+    return ( volatile uint32_t * ) pRecord;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t isValidValue( uint32_t type,
+                             const uint8_t * pValue,
+                             uint32_t valueLength )
+{
+    uint8_t valid = 0U;
+    uint32_t offset = 0U;
+    uint16_t stringLength = 0U;
+
+    if( type == ( uint32_t ) DefenderMetricNumber )
+    {
+        valid = ( valueLength == sizeof( uint64_t ) ) ? 1U : 0U;
+    }
+    else if( type == ( uint32_t ) DefenderMetricNumberList )
+    {
+        valid = ( ( valueLength % sizeof( uint64_t ) ) == 0U ) ? 1U : 0U;
+    }
+    else if( type == ( uint32_t ) DefenderMetricIpList )
+    {
+        valid = ( ( valueLength % sizeof( uint32_t ) ) == 0U ) ? 1U : 0U;
+    }
+    else if( type == ( uint32_t ) DefenderMetricStringList )
+    {
+        /* Every length must be followed by that many bytes. */
+        while( ( valueLength - offset ) >= sizeof( uint16_t ) )
+        {
+            ( void ) memcpy( &( stringLength ), &( pValue[ offset ] ), sizeof( uint16_t ) );
+            offset += sizeof( uint16_t );
+
+            if( stringLength > ( valueLength - offset ) )
+            {
+                break;
+            }
+
+            offset += stringLength;
+        }
+
+        valid = ( offset == valueLength ) ? 1U : 0U;
+    }
+    else
+    {
+        /* Empty else MISRA 15.7 */
+    }
+
+    return valid;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t writeListElements( DefenderWriter_t * pWriter,
+                                  uint32_t type,
+                                  const uint8_t * pValue,
+                                  uint32_t valueLength )
+{
+    uint8_t valid = 1U;
+    uint32_t offset = 0U, address = 0U;
+    uint64_t number = 0U;
+    uint16_t stringLength = 0U;
+
+    while( ( offset < valueLength ) && ( valid == 1U ) && ( pWriter->status == DefenderSuccess ) )
+    {
+        if( offset > 0U )
+        {
+            Defender_WriteBytes( pWriter, ",", 1U );
+        }
+
+        if( type == ( uint32_t ) DefenderMetricNumberList )
+        {
+            if( ( valueLength - offset ) < sizeof( uint64_t ) )
+            {
+                valid = 0U;
+            }
+            else
+            {
+                ( void ) memcpy( &( number ), &( pValue[ offset ] ), sizeof( uint64_t ) );
+                Defender_WriteDecimal( pWriter, number );
+                offset += sizeof( uint64_t );
+            }
+        }
+        else if( type == ( uint32_t ) DefenderMetricIpList )
+        {
+            if( ( valueLength - offset ) < sizeof( uint32_t ) )
+            {
+                valid = 0U;
+            }
+            else
+            {
+                ( void ) memcpy( &( address ), &( pValue[ offset ] ), sizeof( uint32_t ) );
+                Defender_WriteBytes( pWriter, "\"", 1U );
+                Defender_WriteIpv4Address( pWriter, address );
+                Defender_WriteBytes( pWriter, "\"", 1U );
+                offset += sizeof( uint32_t );
+            }
+        }
+        else
+        {
+            /* The length is copied once, so the bytes written are the bytes
+             * checked even if the writer changes the length meanwhile. */
+            if( ( valueLength - offset ) < sizeof( uint16_t ) )
+            {
+                valid = 0U;
+            }
+            else
+            {
+                ( void ) memcpy( &( stringLength ), &( pValue[ offset ] ), sizeof( uint16_t ) );
+                offset += sizeof( uint16_t );
+
+                if( stringLength > ( valueLength - offset ) )
+                {
+                    valid = 0U;
+                }
+                else
+                {
+                    Defender_WriteBytes( pWriter, "\"", 1U );
+                    /* coverity[misra_c_2012_rule_11_8_violation] */
+                    Defender_WriteEscaped( pWriter, ( const char * ) &( pValue[ offset ] ), stringLength );
+                    Defender_WriteBytes( pWriter, "\"", 1U );
+                    offset += stringLength;
+                }
+            }
+        }
+    }
+
+    return valid;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t writeValue( DefenderWriter_t * pWriter,
+                           uint32_t type,
+                           const uint8_t * pValue,
+                           uint32_t valueLength )
+{
+    uint8_t valid = 1U;
+    uint64_t number = 0U;
+
+    if( ( type == ( uint32_t ) DefenderMetricNumber ) && ( valueLength == sizeof( uint64_t ) ) )
+    {
+        ( void ) memcpy( &( number ), pValue, sizeof( uint64_t ) );
+        Defender_WriteBytes( pWriter, METRIC_NUMBER_START, STRING_LITERAL_LENGTH( METRIC_NUMBER_START ) );
+        Defender_WriteDecimal( pWriter, number );
+        Defender_WriteBytes( pWriter, METRIC_NUMBER_END, STRING_LITERAL_LENGTH( METRIC_NUMBER_END ) );
+    }
+    else if( ( type == ( uint32_t ) DefenderMetricNumberList ) ||
+             ( type == ( uint32_t ) DefenderMetricIpList ) ||
+             ( type == ( uint32_t ) DefenderMetricStringList ) )
+    {
+        if( type == ( uint32_t ) DefenderMetricNumberList )
+        {
+            Defender_WriteBytes( pWriter, METRIC_NUMBER_LIST_START, STRING_LITERAL_LENGTH( METRIC_NUMBER_LIST_START ) );
+        }
+        else if( type == ( uint32_t ) DefenderMetricIpList )
+        {
+            Defender_WriteBytes( pWriter, METRIC_IP_LIST_START, STRING_LITERAL_LENGTH( METRIC_IP_LIST_START ) );
+        }
+        else
+        {
+            Defender_WriteBytes( pWriter, METRIC_STRING_LIST_START, STRING_LITERAL_LENGTH( METRIC_STRING_LIST_START ) );
+        }
+
+        valid = writeListElements( pWriter, type, pValue, valueLength );
+        Defender_WriteBytes( pWriter, METRIC_LIST_END, STRING_LITERAL_LENGTH( METRIC_LIST_END ) );
+    }
+    else
+    {
+        valid = 0U;
+    }
+
+    /* Strings which are not valid UTF-8 make the value invalid. */
+    if( pWriter->status == DefenderError )
+    {
+        valid = 0U;
+    }
+
+    return valid;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t writeRecord( DefenderWriter_t * pWriter,
+                            const DefenderMetricSegment_t * pSegment,
+                            uint32_t metricId )
+{
+    uint8_t * pRecord = getRecord( pSegment, metricId );
+    volatile uint32_t * pSequence = getSequence( pRecord );
+    uint32_t start = pWriter->length, reads = 0U, sequence = 0U, type = 0U, valueLength = 0U;
+    uint8_t valid = 0U, stable = 0U;
+
+    for( reads = 0U; ( reads < METRIC_SEGMENT_MAX_READS ) && ( stable == 0U ); reads++ )
+    {
+        pWriter->length = start;
+        pWriter->status = DefenderSuccess;
+        sequence = *pSequence;
+
+        /* An odd sequence number means that a write is in progress. */
+        if( ( sequence & 1U ) == 0U )
+        {
+            DEFENDER_MEMORY_BARRIER();
+            ( void ) memcpy( &( type ), &( pRecord[ METRIC_RECORD_TYPE_OFFSET ] ), sizeof( uint32_t ) );
+            ( void ) memcpy( &( valueLength ), &( pRecord[ METRIC_RECORD_LENGTH_OFFSET ] ), sizeof( uint32_t ) );
+
+            if( ( sequence != 0U ) && ( valueLength <= pSegment->valueLength ) )
+            {
+                valid = writeValue( pWriter, type, &( pRecord[ DEFENDER_METRIC_RECORD_HEADER_LENGTH ] ), valueLength );
+            }
+            else
+            {
+                valid = 0U;
+            }
+
+            DEFENDER_MEMORY_BARRIER();
+            stable = ( *pSequence == sequence ) ? 1U : 0U;
+        }
+    }
+
+    if( ( stable == 0U ) || ( ( valid == 0U ) && ( sequence != 0U ) ) )
+    {
+        LogWarn( ( "Left out the custom metric of record %u. Record changing: %u.",
+                   ( unsigned int ) metricId,
+                   ( unsigned int ) ( 1U - stable ) ) );
+    }
+
+    /* Only a full buffer is an error. Invalid values are left out. */
+    if( ( stable == 0U ) || ( valid == 0U ) || ( pWriter->status != DefenderSuccess ) )
+    {
+        pWriter->length = start;
+        valid = 0U;
+
+        if( pWriter->status != DefenderBufferTooSmall )
+        {
+            pWriter->status = DefenderSuccess;
+        }
+    }
+
+    return valid;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_MetricSegmentGetSize( uint32_t recordCount,
+                                                uint32_t valueLength,
+                                                uint32_t * pOutLength )
+{
+    DefenderStatus_t ret = DefenderBadParameter;
+    uint32_t recordLength = 0U;
+
+    if( pOutLength != NULL )
+    {
+        ret = getLayout( recordCount, valueLength, &( recordLength ), pOutLength );
+    }
+
+    if( ret != DefenderSuccess )
+    {
+        LogError( ( "Invalid input parameter. recordCount: %u, valueLength: %u, pOutLength: %p.",
+                    ( unsigned int ) recordCount,
+                    ( unsigned int ) valueLength,
+                    ( void * ) pOutLength ) );
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_MetricSegmentInit( uint8_t * pMemory,
+                                             uint32_t memoryLength,
+                                             uint32_t recordCount,
+                                             uint32_t valueLength,
+                                             DefenderMetricSegment_t * pOutSegment )
+{
+    DefenderStatus_t ret = DefenderBadParameter;
+    uint32_t recordLength = 0U, length = 0U, version = METRIC_SEGMENT_VERSION;
+
+    if( ( pMemory != NULL ) &&
+        ( ( ( uintptr_t ) pMemory % sizeof( uint64_t ) ) == 0U ) &&
+        ( pOutSegment != NULL ) )
+    {
+        ret = getLayout( recordCount, valueLength, &( recordLength ), &( length ) );
+    }
+
+    if( ret != DefenderSuccess )
+    {
+        LogError( ( "Invalid input parameter. pMemory: %p, recordCount: %u, valueLength: %u, pOutSegment: %p.",
+                    ( void * ) pMemory,
+                    ( unsigned int ) recordCount,
+                    ( unsigned int ) valueLength,
+                    ( void * ) pOutSegment ) );
+    }
+    else if( memoryLength < length )
+    {
+        ret = DefenderBufferTooSmall;
+
+        LogError( ( "The memory is too small for the segment. memoryLength: %u, required: %u.",
+                    ( unsigned int ) memoryLength,
+                    ( unsigned int ) length ) );
+    }
+    else
+    {
+        ( void ) memset( pMemory, 0, length );
+        ( void ) memcpy( &( pMemory[ METRIC_SEGMENT_VERSION_OFFSET ] ), &( version ), sizeof( uint32_t ) );
+        ( void ) memcpy( &( pMemory[ METRIC_SEGMENT_RECORD_COUNT_OFFSET ] ), &( recordCount ), sizeof( uint32_t ) );
+        ( void ) memcpy( &( pMemory[ METRIC_SEGMENT_VALUE_LENGTH_OFFSET ] ), &( valueLength ), sizeof( uint32_t ) );
+
+        /* The magic is written last, so a process which attaches early does
+         * not see a segment which is half initialized. */
+        DEFENDER_MEMORY_BARRIER();
+        ( void ) memcpy( pMemory, METRIC_SEGMENT_MAGIC, METRIC_SEGMENT_LENGTH_MAGIC );
+
+        pOutSegment->pMemory = pMemory;
+        pOutSegment->recordCount = recordCount;
+        pOutSegment->valueLength = valueLength;
+        pOutSegment->recordLength = recordLength;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_MetricSegmentAttach( uint8_t * pMemory,
+                                               uint32_t memoryLength,
+                                               DefenderMetricSegment_t * pOutSegment )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    uint32_t version = 0U, recordCount = 0U, valueLength = 0U, recordLength = 0U, length = 0U;
+
+    if( ( pMemory == NULL ) ||
+        ( ( ( uintptr_t ) pMemory % sizeof( uint64_t ) ) != 0U ) ||
+        ( pOutSegment == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pMemory: %p, pOutSegment: %p.",
+                    ( void * ) pMemory,
+                    ( void * ) pOutSegment ) );
+    }
+    else if( ( memoryLength < DEFENDER_METRIC_SEGMENT_HEADER_LENGTH ) ||
+             ( memcmp( pMemory, METRIC_SEGMENT_MAGIC, METRIC_SEGMENT_LENGTH_MAGIC ) != 0 ) )
+    {
+        ret = DefenderError;
+
+        LogError( ( "The memory does not hold a metric segment." ) );
+    }
+    else
+    {
+        DEFENDER_MEMORY_BARRIER();
+        ( void ) memcpy( &( version ), &( pMemory[ METRIC_SEGMENT_VERSION_OFFSET ] ), sizeof( uint32_t ) );
+        ( void ) memcpy( &( recordCount ), &( pMemory[ METRIC_SEGMENT_RECORD_COUNT_OFFSET ] ), sizeof( uint32_t ) );
+        ( void ) memcpy( &( valueLength ), &( pMemory[ METRIC_SEGMENT_VALUE_LENGTH_OFFSET ] ), sizeof( uint32_t ) );
+
+        if( ( version != METRIC_SEGMENT_VERSION ) ||
+            ( getLayout( recordCount, valueLength, &( recordLength ), &( length ) ) != DefenderSuccess ) ||
+            ( memoryLength < length ) )
+        {
+            ret = DefenderError;
+
+            LogError( ( "Unsupported or truncated metric segment. Version: %u, recordCount: %u, "
+                        "valueLength: %u, memoryLength: %u.",
+                        ( unsigned int ) version,
+                        ( unsigned int ) recordCount,
+                        ( unsigned int ) valueLength,
+                        ( unsigned int ) memoryLength ) );
+        }
+        else
+        {
+            pOutSegment->pMemory = pMemory;
+            pOutSegment->recordCount = recordCount;
+            pOutSegment->valueLength = valueLength;
+            pOutSegment->recordLength = recordLength;
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_MetricSegmentWrite( const DefenderMetricSegment_t * pSegment,
+                                              uint32_t metricId,
+                                              DefenderMetricType_t type,
+                                              const uint8_t * pValue,
+                                              uint32_t valueLength )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    uint8_t * pRecord = NULL;
+    volatile uint32_t * pSequence = NULL;
+    uint32_t sequence = 0U, recordType = ( uint32_t ) type;
+
+    if( ( pSegment == NULL ) ||
+        ( pSegment->pMemory == NULL ) ||
+        ( metricId >= pSegment->recordCount ) ||
+        ( ( pValue == NULL ) && ( valueLength > 0U ) ) ||
+        ( isValidValue( recordType, pValue, valueLength ) == 0U ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pSegment: %p, metricId: %u, type: %d, pValue: %p, valueLength: %u.",
+                    ( const void * ) pSegment,
+                    ( unsigned int ) metricId,
+                    ( int ) type,
+                    ( const void * ) pValue,
+                    ( unsigned int ) valueLength ) );
+    }
+    else if( valueLength > pSegment->valueLength )
+    {
+        ret = DefenderBufferTooSmall;
+
+        LogError( ( "The value is longer than a record. valueLength: %u, maximum: %u.",
+                    ( unsigned int ) valueLength,
+                    ( unsigned int ) pSegment->valueLength ) );
+    }
+    else
+    {
+        pRecord = getRecord( pSegment, metricId );
+        pSequence = getSequence( pRecord );
+
+        /* Keeps the number odd if a previous writer stopped half way. */
+        sequence = *pSequence | 1U;
+        *pSequence = sequence;
+        DEFENDER_MEMORY_BARRIER();
+
+        ( void ) memcpy( &( pRecord[ METRIC_RECORD_TYPE_OFFSET ] ), &( recordType ), sizeof( uint32_t ) );
+        ( void ) memcpy( &( pRecord[ METRIC_RECORD_LENGTH_OFFSET ] ), &( valueLength ), sizeof( uint32_t ) );
+
+        if( valueLength > 0U )
+        {
+            ( void ) memcpy( &( pRecord[ DEFENDER_METRIC_RECORD_HEADER_LENGTH ] ), pValue, valueLength );
+        }
+
+        DEFENDER_MEMORY_BARRIER();
+
+        /* 0 means that the record has no value, so it is skipped on wrap. */
+        sequence++;
+        *pSequence = ( sequence == 0U ) ? 2U : sequence;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_MetricSegmentSerialize( const DefenderMetricSegment_t * pSegment,
+                                                  const char * const * ppMetricNames,
+                                                  const uint16_t * pMetricNameLengths,
+                                                  uint32_t metricNameCount,
+                                                  char * pBuffer,
+                                                  uint32_t bufferLength,
+                                                  uint32_t * pOutLength )
+{
+    DefenderStatus_t ret = DefenderBadParameter;
+    uint32_t length = 0U;
+
+    if( pOutLength == NULL )
+    {
+        LogError( ( "Invalid input parameter. pOutLength: %p.",
+                    ( void * ) pOutLength ) );
+    }
+    else
+    {
+        ret = Defender_MetricSegmentAppend( pSegment, ppMetricNames, pMetricNameLengths, metricNameCount,
+                                            pBuffer, bufferLength, &( length ) );
+
+        if( ret == DefenderSuccess )
+        {
+            *pOutLength = length;
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_MetricSegmentAppend( const DefenderMetricSegment_t * pSegment,
+                                               const char * const * ppMetricNames,
+                                               const uint16_t * pMetricNameLengths,
+                                               uint32_t metricNameCount,
+                                               char * pBuffer,
+                                               uint32_t bufferLength,
+                                               uint32_t * pInOutLength )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    DefenderWriter_t writer;
+    uint32_t metricId = 0U, prefixStart = 0U;
+    uint8_t hasMembers = 0U;
+
+    if( ( pSegment == NULL ) ||
+        ( pSegment->pMemory == NULL ) ||
+        ( ( metricNameCount > 0U ) && ( ( ppMetricNames == NULL ) || ( pMetricNameLengths == NULL ) ) ) ||
+        ( pBuffer == NULL ) ||
+        ( pInOutLength == NULL ) ||
+        ( *pInOutLength > bufferLength ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pSegment: %p, ppMetricNames: %p, pMetricNameLengths: %p, "
+                    "metricNameCount: %u, pBuffer: %p, bufferLength: %u, pInOutLength: %p.",
+                    ( const void * ) pSegment,
+                    ( const void * ) ppMetricNames,
+                    ( const void * ) pMetricNameLengths,
+                    ( unsigned int ) metricNameCount,
+                    ( void * ) pBuffer,
+                    ( unsigned int ) bufferLength,
+                    ( void * ) pInOutLength ) );
+    }
+    else
+    {
+        Defender_WriterInit( &( writer ), pBuffer, bufferLength );
+        writer.length = *pInOutLength;
+
+        ret = Defender_WriteObjectStart( &( writer ), &( hasMembers ) );
+
+        if( ret != DefenderSuccess )
+        {
+            LogError( ( "The buffer does not hold a custom metrics object. length: %u.",
+                        ( unsigned int ) *pInOutLength ) );
+        }
+        else
+        {
+            for( metricId = 0U;
+                 ( metricId < pSegment->recordCount ) && ( metricId < metricNameCount ) && ( writer.status == DefenderSuccess );
+                 metricId++ )
+            {
+                prefixStart = writer.length;
+
+                if( hasMembers == 1U )
+                {
+                    Defender_WriteBytes( &( writer ), ",", 1U );
+                }
+
+                Defender_WriteBytes( &( writer ), "\"", 1U );
+                Defender_WriteEscaped( &( writer ), ppMetricNames[ metricId ], pMetricNameLengths[ metricId ] );
+
+                /* The name is taken back if the record has no value. */
+                if( writer.status == DefenderSuccess )
+                {
+                    if( writeRecord( &( writer ), pSegment, metricId ) == 1U )
+                    {
+                        hasMembers = 1U;
+                    }
+                    else
+                    {
+                        writer.length = prefixStart;
+                    }
+                }
+            }
+
+            Defender_WriteObjectEnd( &( writer ), *pInOutLength );
+
+            ret = writer.status;
+
+            if( ret == DefenderSuccess )
+            {
+                *pInOutLength = writer.length;
+            }
+            else if( ret == DefenderBufferTooSmall )
+            {
+                LogError( ( "The buffer is too small for the custom metrics. bufferLength: %u.",
+                            ( unsigned int ) bufferLength ) );
+            }
+            else
+            {
+                LogError( ( "Invalid metric name. Metric ID: %u.", ( unsigned int ) metricId ) );
+            }
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
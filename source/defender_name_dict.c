@@ -0,0 +1,448 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_name_dict.c
+ * @brief Implementation of the front coded name dictionary.
+ */
+
+/* Standard includes. */
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Name dictionary include. */
+#include "defender_name_dict.h"
+
+/**
+ * @brief Compare two names as memcmp does, with a name before the longer
+ * names it is a prefix of.
+ *
+ * @param[in] pFirst The first name.
+ * @param[in] firstLength The length of the first name.
+ * @param[in] pSecond The second name.
+ * @param[in] secondLength The length of the second name.
+ *
+ * @return A negative number, 0, or a positive number if the first name is
+ * before, equal to, or after the second name.
+ */
+static int32_t compareNames( const char * pFirst,
+                             uint16_t firstLength,
+                             const char * pSecond,
+                             uint16_t secondLength );
+
+/**
+ * @brief Get the number of bytes two names share at their start.
+ *
+ * @param[in] pFirst The first name.
+ * @param[in] firstLength The length of the first name.
+ * @param[in] pSecond The second name.
+ * @param[in] secondLength The length of the second name.
+ *
+ * @return The length of the shared prefix.
+ */
+static uint16_t sharedLength( const char * pFirst,
+                              uint16_t firstLength,
+                              const char * pSecond,
+                              uint16_t secondLength );
+
+/**
+ * @brief Find the last bucket whose first name is not after a name.
+ *
+ * @param[in] pDict The name dictionary, with at least one name.
+ * @param[in] pThingName The name.
+ * @param[in] thingNameLength The length of the name.
+ *
+ * @return The bucket, or UINT32_MAX if the name is before the first name.
+ */
+static uint32_t findBucket( const DefenderNameDict_t * pDict,
+                            const char * pThingName,
+                            uint16_t thingNameLength );
+
+/**
+ * @brief Decode the name at an offset of the data.
+ *
+ * @param[in] pDict The name dictionary.
+ * @param[in] isFirst Whether the name is the first of its bucket, which is
+ * kept whole.
+ * @param[in,out] pOffset The offset of the name, moved to the next name.
+ * @param[in,out] pName The name before, replaced by the decoded name.
+ * @param[in,out] pNameLength The length of the name.
+ *
+ * @return 1 if the name is valid; 0 otherwise.
+ */
+static uint8_t decodeName( const DefenderNameDict_t * pDict,
+                           uint8_t isFirst,
+                           uint32_t * pOffset,
+                           char * pName,
+                           uint16_t * pNameLength );
+
+/*-----------------------------------------------------------*/
+
+static int32_t compareNames( const char * pFirst,
+                             uint16_t firstLength,
+                             const char * pSecond,
+                             uint16_t secondLength )
+{
+    int32_t result = memcmp( pFirst, pSecond, ( firstLength < secondLength ) ? firstLength : secondLength );
+
+    if( result == 0 )
+    {
+        result = ( int32_t ) firstLength - ( int32_t ) secondLength;
+    }
+
+    return result;
+}
+/*-----------------------------------------------------------*/
+
+static uint16_t sharedLength( const char * pFirst,
+                              uint16_t firstLength,
+                              const char * pSecond,
+                              uint16_t secondLength )
+{
+    uint16_t length = 0U;
+
+    while( ( length < firstLength ) && ( length < secondLength ) && ( pFirst[ length ] == pSecond[ length ] ) )
+    {
+        length++;
+    }
+
+    return length;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t findBucket( const DefenderNameDict_t * pDict,
+                            const char * pThingName,
+                            uint16_t thingNameLength )
+{
+    uint32_t low = 0U, high = ( ( pDict->nameCount - 1U ) / pDict->bucketSize ) + 1U, middle, offset;
+    uint32_t bucket = UINT32_MAX;
+
+    assert( pDict->nameCount > 0U );
+
+    /* Buckets below low start with a name which is not after the name, and
+     * buckets from high start with a name after it. */
+    while( low < high )
+    {
+        middle = low + ( ( high - low ) / 2U );
+        offset = pDict->pBucketOffsets[ middle ];
+
+        if( compareNames( ( const char * ) &( pDict->pData[ offset + 1U ] ), pDict->pData[ offset ],
+                          pThingName, thingNameLength ) <= 0 )
+        {
+            low = middle + 1U;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    if( low > 0U )
+    {
+        bucket = low - 1U;
+    }
+
+    return bucket;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t decodeName( const DefenderNameDict_t * pDict,
+                           uint8_t isFirst,
+                           uint32_t * pOffset,
+                           char * pName,
+                           uint16_t * pNameLength )
+{
+    uint32_t offset = *pOffset, headerLength = ( isFirst == 1U ) ? 1U : 2U;
+    uint16_t shared = 0U, suffixLength = 0U;
+    uint8_t valid = ( ( offset < pDict->dataLength ) && ( ( pDict->dataLength - offset ) >= headerLength ) ) ? 1U : 0U;
+
+    if( ( valid == 1U ) && ( isFirst == 1U ) )
+    {
+        /* The length and the whole name. */
+        suffixLength = pDict->pData[ offset ];
+    }
+    else if( valid == 1U )
+    {
+        /* The shared length, the length of the rest, and the rest. */
+        shared = pDict->pData[ offset ];
+        suffixLength = pDict->pData[ offset + 1U ];
+        valid = ( shared <= *pNameLength ) ? 1U : 0U;
+    }
+    else
+    {
+        /* Empty else MISRA 15.7 */
+    }
+
+    offset += headerLength;
+    valid = ( ( valid == 1U ) &&
+              ( ( shared + suffixLength ) <= DEFENDER_THINGNAME_MAX_LENGTH ) &&
+              ( suffixLength <= ( pDict->dataLength - offset ) ) ) ? 1U : 0U;
+
+    if( valid == 1U )
+    {
+        ( void ) memcpy( &( pName[ shared ] ), &( pDict->pData[ offset ] ), suffixLength );
+        *pNameLength = shared + suffixLength;
+        *pOffset = offset + suffixLength;
+    }
+
+    return valid;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_NameDictInit( DefenderNameDict_t * pDict,
+                                        uint8_t * pData,
+                                        uint32_t dataCapacity,
+                                        uint32_t * pBucketOffsets,
+                                        uint32_t bucketCapacity,
+                                        uint32_t bucketSize )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+
+    if( ( pDict == NULL ) ||
+        ( pData == NULL ) ||
+        ( pBucketOffsets == NULL ) ||
+        ( bucketCapacity == 0U ) ||
+        ( bucketSize == 0U ) ||
+        ( bucketSize > DEFENDER_NAME_DICT_MAX_BUCKET_SIZE ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pDict: %p, pData: %p, pBucketOffsets: %p, "
+                    "bucketCapacity: %u, bucketSize: %u.",
+                    ( void * ) pDict,
+                    ( void * ) pData,
+                    ( void * ) pBucketOffsets,
+                    ( unsigned int ) bucketCapacity,
+                    ( unsigned int ) bucketSize ) );
+    }
+    else
+    {
+        pDict->pData = pData;
+        pDict->dataCapacity = dataCapacity;
+        pDict->dataLength = 0U;
+        pDict->pBucketOffsets = pBucketOffsets;
+        pDict->bucketCapacity = bucketCapacity;
+        pDict->bucketSize = bucketSize;
+        pDict->nameCount = 0U;
+        pDict->lastNameLength = 0U;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_NameDictAppend( DefenderNameDict_t * pDict,
+                                          const char * pThingName,
+                                          uint16_t thingNameLength )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    uint8_t isFirst = 0U;
+    uint16_t shared = 0U;
+    uint32_t headerLength = 1U, bucket = 0U;
+
+    if( ( pDict == NULL ) ||
+        ( pDict->pData == NULL ) ||
+        ( pThingName == NULL ) ||
+        ( thingNameLength == 0U ) ||
+        ( thingNameLength > DEFENDER_THINGNAME_MAX_LENGTH ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pDict: %p, pThingName: %p, thingNameLength: %u.",
+                    ( void * ) pDict,
+                    ( const void * ) pThingName,
+                    ( unsigned int ) thingNameLength ) );
+    }
+    else if( ( pDict->nameCount > 0U ) &&
+             ( compareNames( pDict->lastName, pDict->lastNameLength, pThingName, thingNameLength ) >= 0 ) )
+    {
+        ret = DefenderError;
+
+        LogError( ( "The name is not after the last name: %.*s.",
+                    ( int ) thingNameLength,
+                    pThingName ) );
+    }
+    else
+    {
+        bucket = pDict->nameCount / pDict->bucketSize;
+        isFirst = ( ( pDict->nameCount % pDict->bucketSize ) == 0U ) ? 1U : 0U;
+
+        if( isFirst == 0U )
+        {
+            shared = sharedLength( pDict->lastName, pDict->lastNameLength, pThingName, thingNameLength );
+            headerLength = 2U;
+        }
+
+        if( ( isFirst == 1U ) && ( bucket >= pDict->bucketCapacity ) )
+        {
+            ret = DefenderBufferTooSmall;
+        }
+        else if( ( pDict->dataCapacity - pDict->dataLength ) < ( headerLength + thingNameLength - shared ) )
+        {
+            ret = DefenderBufferTooSmall;
+        }
+        else
+        {
+            /* Empty else MISRA 15.7 */
+        }
+    }
+
+    if( ( ret == DefenderSuccess ) && ( isFirst == 1U ) )
+    {
+        pDict->pBucketOffsets[ bucket ] = pDict->dataLength;
+        pDict->pData[ pDict->dataLength ] = ( uint8_t ) thingNameLength;
+    }
+    else if( ret == DefenderSuccess )
+    {
+        pDict->pData[ pDict->dataLength ] = ( uint8_t ) shared;
+        pDict->pData[ pDict->dataLength + 1U ] = ( uint8_t ) ( thingNameLength - shared );
+    }
+    else if( ret == DefenderBufferTooSmall )
+    {
+        LogError( ( "The name dictionary is full. nameCount: %u, dataLength: %u.",
+                    ( unsigned int ) pDict->nameCount,
+                    ( unsigned int ) pDict->dataLength ) );
+    }
+    else
+    {
+        /* Empty else MISRA 15.7 */
+    }
+
+    if( ret == DefenderSuccess )
+    {
+        ( void ) memcpy( &( pDict->pData[ pDict->dataLength + headerLength ] ), &( pThingName[ shared ] ),
+                         ( size_t ) thingNameLength - shared );
+        pDict->dataLength += headerLength + thingNameLength - shared;
+        ( void ) memcpy( pDict->lastName, pThingName, thingNameLength );
+        pDict->lastNameLength = thingNameLength;
+        pDict->nameCount++;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_NameDictFind( const DefenderNameDict_t * pDict,
+                                        const char * pThingName,
+                                        uint16_t thingNameLength,
+                                        uint32_t * pOutIndex )
+{
+    DefenderStatus_t ret = DefenderNoMatch;
+    char name[ DEFENDER_THINGNAME_MAX_LENGTH ];
+    uint16_t nameLength = 0U;
+    uint32_t bucket, index, end, offset = 0U;
+    int32_t order = -1;
+    uint8_t valid = 1U, isFirst;
+
+    if( ( pDict == NULL ) || ( pDict->pData == NULL ) || ( pThingName == NULL ) || ( pOutIndex == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pDict: %p, pThingName: %p, pOutIndex: %p.",
+                    ( const void * ) pDict,
+                    ( const void * ) pThingName,
+                    ( void * ) pOutIndex ) );
+    }
+    else if( ( pDict->nameCount > 0U ) && ( thingNameLength <= DEFENDER_THINGNAME_MAX_LENGTH ) )
+    {
+        bucket = findBucket( pDict, pThingName, thingNameLength );
+
+        if( bucket != UINT32_MAX )
+        {
+            index = bucket * pDict->bucketSize;
+            end = ( ( pDict->nameCount - index ) < pDict->bucketSize ) ? pDict->nameCount : ( index + pDict->bucketSize );
+            offset = pDict->pBucketOffsets[ bucket ];
+
+            /* Names are sorted, so the scan stops at the first name which is
+             * not before the name. */
+            while( ( valid == 1U ) && ( order < 0 ) && ( index < end ) )
+            {
+                isFirst = ( index == ( bucket * pDict->bucketSize ) ) ? 1U : 0U;
+                valid = decodeName( pDict, isFirst, &( offset ), name, &( nameLength ) );
+                order = compareNames( name, nameLength, pThingName, thingNameLength );
+                index++;
+            }
+
+            assert( valid == 1U );
+
+            if( order == 0 )
+            {
+                *pOutIndex = index - 1U;
+                ret = DefenderSuccess;
+            }
+        }
+    }
+    else
+    {
+        /* Empty else: no name can match. */
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_NameDictNext( const DefenderNameDict_t * pDict,
+                                        DefenderNameDictCursor_t * pCursor )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    uint8_t isFirst = 0U;
+
+    if( ( pDict == NULL ) || ( pDict->pData == NULL ) || ( pCursor == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pDict: %p, pCursor: %p.",
+                    ( const void * ) pDict,
+                    ( void * ) pCursor ) );
+    }
+    else if( pCursor->nextIndex >= pDict->nameCount )
+    {
+        ret = DefenderNoMatch;
+    }
+    else
+    {
+        isFirst = ( ( pCursor->nextIndex % pDict->bucketSize ) == 0U ) ? 1U : 0U;
+
+        if( isFirst == 1U )
+        {
+            pCursor->nextOffset = pDict->pBucketOffsets[ pCursor->nextIndex / pDict->bucketSize ];
+        }
+
+        if( decodeName( pDict, isFirst, &( pCursor->nextOffset ), pCursor->name, &( pCursor->nameLength ) ) == 0U )
+        {
+            ret = DefenderBadParameter;
+
+            LogError( ( "The cursor is not at a name of the dictionary. nextIndex: %u.",
+                        ( unsigned int ) pCursor->nextIndex ) );
+        }
+        else
+        {
+            pCursor->nextIndex++;
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,292 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_name_filter.c
+ * @brief Implementation of the blocked Bloom filter of thing names.
+ */
+
+/* Standard includes. */
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Name filter include. */
+#include "defender_name_filter.h"
+
+/**
+ * @brief Offset basis and prime of the 64-bit FNV-1a hash of thing names.
+ */
+#define NAME_FILTER_FNV_OFFSET    UINT64_C( 14695981039346656037 )
+#define NAME_FILTER_FNV_PRIME     UINT64_C( 1099511628211 )
+
+/**
+ * @brief Multipliers of the final mix of the hash.
+ */
+#define NAME_FILTER_MIX_FIRST     UINT64_C( 0xFF51AFD7ED558CCD )
+#define NAME_FILTER_MIX_SECOND    UINT64_C( 0xC4CEB9FE1A85EC53 )
+
+/**
+ * @brief Odd multipliers which pick the bit of each word of a block.
+ */
+static const uint32_t nameFilterSalts[ DEFENDER_NAME_FILTER_BLOCK_WORDS ] =
+{
+    0x47B6137BU, 0x44974D91U, 0x8824AD5BU, 0xA2B7289DU,
+    0x705495C7U, 0x2DF1424BU, 0x9EFC4947U, 0x5C6BFB31U
+};
+
+/**
+ * @brief Hash a thing name.
+ *
+ * The name is hashed with FNV-1a, and the result mixed so that all its bits
+ * depend on all bytes of the name.
+ *
+ * @param[in] pThingName The thing name.
+ * @param[in] thingNameLength The length of the thing name.
+ *
+ * @return The hash.
+ */
+static uint64_t hashName( const char * pThingName,
+                          uint16_t thingNameLength );
+
+/**
+ * @brief Get the block of a name hash.
+ *
+ * @param[in] pFilter The name filter.
+ * @param[in] hash The hash.
+ *
+ * @return The first word of the block.
+ */
+static uint32_t * getBlock( const DefenderNameFilter_t * pFilter,
+                            uint64_t hash );
+
+/**
+ * @brief Get the bit of a name hash in a word of a block.
+ *
+ * @param[in] hash The hash.
+ * @param[in] word The word of the block.
+ *
+ * @return A mask with the bit set.
+ */
+static uint32_t getBit( uint64_t hash,
+                        uint32_t word );
+
+/*-----------------------------------------------------------*/
+
+static uint64_t hashName( const char * pThingName,
+                          uint16_t thingNameLength )
+{
+    uint64_t hash = NAME_FILTER_FNV_OFFSET;
+    uint16_t i;
+
+    for( i = 0U; i < thingNameLength; i++ )
+    {
+        hash = ( hash ^ ( uint8_t ) pThingName[ i ] ) * NAME_FILTER_FNV_PRIME;
+    }
+
+    hash ^= hash >> 33;
+    hash *= NAME_FILTER_MIX_FIRST;
+    hash ^= hash >> 33;
+    hash *= NAME_FILTER_MIX_SECOND;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t * getBlock( const DefenderNameFilter_t * pFilter,
+                            uint64_t hash )
+{
+    /* The high 32 bits of the hash, scaled to the number of blocks. */
+    uint32_t block = ( uint32_t ) ( ( ( hash >> 32 ) * pFilter->blockCount ) >> 32 );
+
+    return &( pFilter->pBlocks[ block * DEFENDER_NAME_FILTER_BLOCK_WORDS ] );
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t getBit( uint64_t hash,
+                        uint32_t word )
+{
+    /* The top 5 bits of the low 32 bits of the hash times a different odd
+     * number for each word. */
+    uint32_t product = ( uint32_t ) hash * nameFilterSalts[ word ];
+
+    return ( uint32_t ) 1U << ( product >> 27 );
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_NameFilterInit( DefenderNameFilter_t * pFilter,
+                                          uint32_t * pBlocks,
+                                          uint32_t blockCount )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+
+    if( ( pFilter == NULL ) || ( pBlocks == NULL ) || ( blockCount == 0U ) ||
+        ( blockCount > ( UINT32_MAX / DEFENDER_NAME_FILTER_BLOCK_WORDS ) ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pFilter: %p, pBlocks: %p, blockCount: %u.",
+                    ( void * ) pFilter,
+                    ( void * ) pBlocks,
+                    ( unsigned int ) blockCount ) );
+    }
+    else
+    {
+        ( void ) memset( pBlocks, 0, ( size_t ) blockCount * DEFENDER_NAME_FILTER_BLOCK_WORDS * sizeof( uint32_t ) );
+
+        pFilter->pBlocks = pBlocks;
+        pFilter->blockCount = blockCount;
+        pFilter->nameCount = 0U;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_NameFilterAdd( DefenderNameFilter_t * pFilter,
+                                         const char * pThingName,
+                                         uint16_t thingNameLength )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    uint32_t * pBlock;
+    uint64_t hash;
+    uint32_t i;
+
+    if( ( pFilter == NULL ) || ( pFilter->pBlocks == NULL ) || ( pThingName == NULL ) ||
+        ( thingNameLength == 0U ) || ( thingNameLength > DEFENDER_THINGNAME_MAX_LENGTH ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pFilter: %p, pThingName: %p, thingNameLength: %u.",
+                    ( void * ) pFilter,
+                    ( const void * ) pThingName,
+                    ( unsigned int ) thingNameLength ) );
+    }
+    else
+    {
+        hash = hashName( pThingName, thingNameLength );
+        pBlock = getBlock( pFilter, hash );
+
+        for( i = 0U; i < DEFENDER_NAME_FILTER_BLOCK_WORDS; i++ )
+        {
+            pBlock[ i ] |= getBit( hash, i );
+        }
+
+        pFilter->nameCount++;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_NameFilterCheck( const DefenderNameFilter_t * pFilter,
+                                           const char * pThingName,
+                                           uint16_t thingNameLength )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    const uint32_t * pBlock;
+    uint32_t missing = 0U;
+    uint64_t hash;
+    uint32_t i;
+
+    if( ( pFilter == NULL ) || ( pFilter->pBlocks == NULL ) || ( pThingName == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pFilter: %p, pThingName: %p.",
+                    ( const void * ) pFilter,
+                    ( const void * ) pThingName ) );
+    }
+    else
+    {
+        hash = hashName( pThingName, thingNameLength );
+        pBlock = getBlock( pFilter, hash );
+
+        /* Test all words without branching on each one. */
+        for( i = 0U; i < DEFENDER_NAME_FILTER_BLOCK_WORDS; i++ )
+        {
+            missing |= getBit( hash, i ) & ~pBlock[ i ];
+        }
+
+        if( missing != 0U )
+        {
+            ret = DefenderNoMatch;
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_NameFilterMatchTopic( const DefenderNameFilter_t * pFilter,
+                                                const char * pTopic,
+                                                uint16_t topicLength,
+                                                DefenderTopic_t * pOutApi,
+                                                const char ** ppOutThingName,
+                                                uint16_t * pOutThingNameLength )
+{
+    DefenderStatus_t ret = DefenderNoMatch;
+    const char * pThingName;
+    const char * pSlash;
+    uint16_t thingNameLength;
+
+    if( ( pFilter == NULL ) || ( pFilter->pBlocks == NULL ) || ( pTopic == NULL ) || ( pOutApi == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pFilter: %p, pTopic: %p, pOutApi: %p.",
+                    ( const void * ) pFilter,
+                    ( const void * ) pTopic,
+                    ( void * ) pOutApi ) );
+    }
+    else if( topicLength > DEFENDER_API_LENGTH_PREFIX )
+    {
+        /* The thing name is between the prefix and the next slash. The prefix
+         * itself is matched by Defender_MatchTopic, only for the names which
+         * pass the filter. */
+        pThingName = &( pTopic[ DEFENDER_API_LENGTH_PREFIX ] );
+        thingNameLength = ( uint16_t ) ( topicLength - DEFENDER_API_LENGTH_PREFIX );
+        pSlash = memchr( pThingName, ( int ) '/', ( size_t ) thingNameLength );
+
+        if( pSlash != NULL )
+        {
+            thingNameLength = ( uint16_t ) ( pSlash - pThingName );
+        }
+
+        ret = Defender_NameFilterCheck( pFilter, pThingName, thingNameLength );
+    }
+    else
+    {
+        LogDebug( ( "The topic is too short to be a Device Defender topic." ) );
+    }
+
+    if( ret == DefenderSuccess )
+    {
+        ret = Defender_MatchTopic( pTopic, topicLength, pOutApi, ppOutThingName, pOutThingNameLength );
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
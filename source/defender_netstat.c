@@ -0,0 +1,777 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_netstat.c
+ * @brief Implementation of the procfs parsers and the network report writer.
+ */
+
+/* Standard includes. */
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Netstat API include. */
+#include "defender_netstat.h"
+
+/* Writer include. */
+#include "defender_writer.h"
+
+/**
+ * @brief TCP socket states of the "st" column.
+ */
+#define NETSTAT_TCP_ESTABLISHED    0x01U
+#define NETSTAT_TCP_LISTEN         0x0AU
+
+/**
+ * @brief State of an unconnected UDP socket.
+ */
+#define NETSTAT_UDP_UNCONNECTED    0x07U
+
+/**
+ * @brief Number of hex digits of the parts of a socket line.
+ */
+#define NETSTAT_WORD_DIGITS        8U
+#define NETSTAT_PORT_DIGITS        4U
+#define NETSTAT_STATE_DIGITS       2U
+
+/**
+ * @brief Number of 32-bit words of an IPv6 address.
+ */
+#define NETSTAT_IPV6_WORDS         4U
+
+/**
+ * @brief Number of counters of an interface line of /proc/net/dev, and the
+ * counters used in reports.
+ */
+#define NETSTAT_DEV_COUNTERS       16U
+#define NETSTAT_DEV_BYTES_IN       0U
+#define NETSTAT_DEV_PACKETS_IN     1U
+#define NETSTAT_DEV_BYTES_OUT      8U
+#define NETSTAT_DEV_PACKETS_OUT    9U
+
+/**
+ * @brief Parts of the network report.
+ */
+#define REPORT_START               "{\"" DEFENDER_REPORT_HEADER_KEY "\":{\"" DEFENDER_REPORT_ID_KEY "\":"
+#define REPORT_METRICS_START       ",\"" DEFENDER_REPORT_VERSION_KEY "\":\"1.0\"},\"" DEFENDER_REPORT_METRICS_KEY "\":{"
+#define REPORT_TCP_PORTS_START     "\"" DEFENDER_REPORT_TCP_LISTENING_PORTS_KEY "\":"
+#define REPORT_UDP_PORTS_START     ",\"" DEFENDER_REPORT_UDP_LISTENING_PORTS_KEY "\":"
+#define REPORT_PORTS_START         "{\"" DEFENDER_REPORT_PORTS_KEY "\":["
+#define REPORT_PORT_START          "{\"" DEFENDER_REPORT_PORT_KEY "\":"
+#define REPORT_PORTS_TOTAL_START   "],\"" DEFENDER_REPORT_TOTAL_KEY "\":"
+#define REPORT_BYTES_IN_START      ",\"" DEFENDER_REPORT_NETWORK_STATS_KEY "\":{\"" DEFENDER_REPORT_BYTES_IN_KEY "\":"
+#define REPORT_BYTES_OUT_START     ",\"" DEFENDER_REPORT_BYTES_OUT_KEY "\":"
+#define REPORT_PACKETS_IN_START    ",\"" DEFENDER_REPORT_PKTS_IN_KEY "\":"
+#define REPORT_PACKETS_OUT_START   ",\"" DEFENDER_REPORT_PKTS_OUT_KEY "\":"
+#define REPORT_CONNECTIONS_START   "},\"" DEFENDER_REPORT_TCP_CONNECTIONS_KEY "\":{\"" DEFENDER_REPORT_ESTABLISHED_CONNECTIONS_KEY "\":"
+#define REPORT_END                 "}}}"
+
+/**
+ * @brief State of a procfs parser.
+ */
+typedef struct ProcReader
+{
+    const char * pText; /**< The text. */
+    uint32_t length;    /**< Length of the text. */
+    uint32_t index;     /**< Index of the next character. */
+    uint8_t valid;      /**< 0 once a read fails. */
+} ProcReader_t;
+
+/**
+ * @brief A socket line of /proc/net/tcp or /proc/net/udp.
+ */
+typedef struct ProcSocket
+{
+    uint32_t remoteAddress; /**< The remote address, if isIpv4 is 1. */
+    uint16_t localPort;     /**< The local port. */
+    uint16_t remotePort;    /**< The remote port. */
+    uint8_t state;          /**< The socket state. */
+    uint8_t isIpv4;         /**< Whether the remote address is an IPv4 address. */
+} ProcSocket_t;
+
+/**
+ * @brief Get the value of a hex digit.
+ *
+ * @param[in] character The character.
+ *
+ * @return The value of the digit, or 16 if the character is not a hex digit.
+ */
+static uint32_t hexValue( char character );
+
+/**
+ * @brief Skip the spaces at the reader position.
+ *
+ * @param[in] pReader The reader.
+ */
+static void skipSpaces( ProcReader_t * pReader );
+
+/**
+ * @brief Move the reader past the end of the current line.
+ *
+ * @param[in] pReader The reader.
+ */
+static void skipLine( ProcReader_t * pReader );
+
+/**
+ * @brief Move the reader to the next non-empty line.
+ *
+ * @param[in] pReader The reader.
+ *
+ * @return 1 if there is a non-empty line; 0 at the end of the text.
+ */
+static uint8_t nextLine( ProcReader_t * pReader );
+
+/**
+ * @brief Read a character, which must be the given character.
+ *
+ * @param[in] pReader The reader.
+ * @param[in] character The expected character.
+ */
+static void readChar( ProcReader_t * pReader,
+                      char character );
+
+/**
+ * @brief Read a number of exactly digitCount hex digits.
+ *
+ * @param[in] pReader The reader.
+ * @param[in] digitCount The number of digits, at most 8.
+ *
+ * @return The number.
+ */
+static uint32_t readHex( ProcReader_t * pReader,
+                         uint32_t digitCount );
+
+/**
+ * @brief Read a decimal number of at least one digit.
+ *
+ * @param[in] pReader The reader.
+ *
+ * @return The number.
+ */
+static uint64_t readDecimal( ProcReader_t * pReader );
+
+/**
+ * @brief Read an IPv4 or IPv6 address and its port.
+ *
+ * procfs prints each 32-bit word of an address in network byte order as a
+ * host integer, so the bytes of the word are its bytes in host memory.
+ *
+ * @param[in] pReader The reader.
+ * @param[out] pAddress The IPv4 address, or the IPv4 address of an
+ * IPv4-mapped IPv6 address.
+ * @param[out] pIsIpv4 Whether the address is an IPv4 address.
+ *
+ * @return The port.
+ */
+static uint16_t readEndpoint( ProcReader_t * pReader,
+                              uint32_t * pAddress,
+                              uint8_t * pIsIpv4 );
+
+/**
+ * @brief Read a socket line, and move to the next line.
+ *
+ * @param[in] pReader The reader.
+ * @param[out] pSocket The socket.
+ */
+static void readSocket( ProcReader_t * pReader,
+                        ProcSocket_t * pSocket );
+
+/**
+ * @brief Append a port to an array of ports.
+ *
+ * @param[in] pPorts The array of ports.
+ * @param[in] portCapacity Number of entries in pPorts.
+ * @param[in] pPortCount Number of ports in pPorts.
+ * @param[in] port The port.
+ *
+ * @return #DefenderSuccess if the port is added;
+ * #DefenderBufferTooSmall if the array is full.
+ */
+static DefenderStatus_t appendPort( uint16_t * pPorts,
+                                    uint32_t portCapacity,
+                                    uint32_t * pPortCount,
+                                    uint16_t port );
+
+/**
+ * @brief Read an interface line of /proc/net/dev, add its counters unless
+ * it is the loopback interface, and move to the next line.
+ *
+ * @param[in] pReader The reader.
+ * @param[in] pStats The statistics to add to.
+ */
+static void readInterface( ProcReader_t * pReader,
+                           DefenderNetworkStats_t * pStats );
+
+/**
+ * @brief Write a listening ports object.
+ *
+ * @param[in] pWriter The writer.
+ * @param[in] pPorts The ports.
+ * @param[in] portCount Number of ports.
+ */
+static void writePorts( DefenderWriter_t * pWriter,
+                        const uint16_t * pPorts,
+                        uint32_t portCount );
+
+/**
+ * @brief Write the established connections object.
+ *
+ * @param[in] pWriter The writer.
+ * @param[in] pConnections The connections.
+ */
+static void writeConnections( DefenderWriter_t * pWriter,
+                              const DefenderConnectionTable_t * pConnections );
+
+/*-----------------------------------------------------------*/
+
+static uint32_t hexValue( char character )
+{
+    uint32_t value = 16U;
+
+    if( ( character >= '0' ) && ( character <= '9' ) )
+    {
+        value = ( uint32_t ) character - ( uint32_t ) '0';
+    }
+    else if( ( character >= 'A' ) && ( character <= 'F' ) )
+    {
+        value = ( ( uint32_t ) character - ( uint32_t ) 'A' ) + 10U;
+    }
+    else if( ( character >= 'a' ) && ( character <= 'f' ) )
+    {
+        value = ( ( uint32_t ) character - ( uint32_t ) 'a' ) + 10U;
+    }
+    else
+    {
+        /* Empty else MISRA 15.7 */
+    }
+
+    return value;
+}
+/*-----------------------------------------------------------*/
+
+static void skipSpaces( ProcReader_t * pReader )
+{
+    while( ( pReader->index < pReader->length ) && ( pReader->pText[ pReader->index ] == ' ' ) )
+    {
+        pReader->index++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void skipLine( ProcReader_t * pReader )
+{
+    while( ( pReader->index < pReader->length ) && ( pReader->pText[ pReader->index ] != '\n' ) )
+    {
+        pReader->index++;
+    }
+
+    if( pReader->index < pReader->length )
+    {
+        pReader->index++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t nextLine( ProcReader_t * pReader )
+{
+    skipSpaces( pReader );
+
+    while( ( pReader->index < pReader->length ) && ( pReader->pText[ pReader->index ] == '\n' ) )
+    {
+        pReader->index++;
+        skipSpaces( pReader );
+    }
+
+    return ( pReader->index < pReader->length ) ? 1U : 0U;
+}
+/*-----------------------------------------------------------*/
+
+static void readChar( ProcReader_t * pReader,
+                      char character )
+{
+    if( ( pReader->index < pReader->length ) && ( pReader->pText[ pReader->index ] == character ) )
+    {
+        pReader->index++;
+    }
+    else
+    {
+        pReader->valid = 0U;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t readHex( ProcReader_t * pReader,
+                         uint32_t digitCount )
+{
+    uint32_t value = 0U, digit = 0U, i;
+
+    assert( digitCount <= NETSTAT_WORD_DIGITS );
+
+    for( i = 0U; ( i < digitCount ) && ( pReader->valid == 1U ); i++ )
+    {
+        if( pReader->index < pReader->length )
+        {
+            digit = hexValue( pReader->pText[ pReader->index ] );
+        }
+
+        if( ( pReader->index < pReader->length ) && ( digit < 16U ) )
+        {
+            value = ( value << 4 ) | digit;
+            pReader->index++;
+        }
+        else
+        {
+            pReader->valid = 0U;
+        }
+    }
+
+    return value;
+}
+/*-----------------------------------------------------------*/
+
+static uint64_t readDecimal( ProcReader_t * pReader )
+{
+    uint64_t value = 0U, digit;
+    uint32_t start = pReader->index;
+
+    while( ( pReader->index < pReader->length ) &&
+           ( pReader->pText[ pReader->index ] >= '0' ) &&
+           ( pReader->pText[ pReader->index ] <= '9' ) )
+    {
+        digit = ( uint64_t ) pReader->pText[ pReader->index ] - ( uint64_t ) '0';
+
+        if( value > ( ( UINT64_MAX - digit ) / 10U ) )
+        {
+            pReader->valid = 0U;
+        }
+
+        value = ( value * 10U ) + digit;
+        pReader->index++;
+    }
+
+    if( pReader->index == start )
+    {
+        pReader->valid = 0U;
+    }
+
+    return value;
+}
+/*-----------------------------------------------------------*/
+
+static uint16_t readEndpoint( ProcReader_t * pReader,
+                              uint32_t * pAddress,
+                              uint8_t * pIsIpv4 )
+{
+    uint32_t words[ NETSTAT_IPV6_WORDS ] = { 0U };
+    uint32_t wordCount = 0U, word;
+    uint8_t bytes[ 4 ];
+
+    while( ( pReader->valid == 1U ) &&
+           ( wordCount < NETSTAT_IPV6_WORDS ) &&
+           ( pReader->index < pReader->length ) &&
+           ( pReader->pText[ pReader->index ] != ':' ) )
+    {
+        word = readHex( pReader, NETSTAT_WORD_DIGITS );
+        ( void ) memcpy( &( bytes[ 0 ] ), &( word ), sizeof( word ) );
+        words[ wordCount ] = ( ( uint32_t ) bytes[ 0 ] << 24 ) | ( ( uint32_t ) bytes[ 1 ] << 16 ) |
+                             ( ( uint32_t ) bytes[ 2 ] << 8 ) | ( uint32_t ) bytes[ 3 ];
+        wordCount++;
+    }
+
+    if( wordCount == 1U )
+    {
+        *pIsIpv4 = 1U;
+        *pAddress = words[ 0 ];
+    }
+    else if( wordCount == NETSTAT_IPV6_WORDS )
+    {
+        /* An IPv4-mapped IPv6 address is ::ffff:a.b.c.d. */
+        *pIsIpv4 = ( ( words[ 0 ] == 0U ) && ( words[ 1 ] == 0U ) && ( words[ 2 ] == 0xFFFFU ) ) ? 1U : 0U;
+        *pAddress = words[ 3 ];
+    }
+    else
+    {
+        *pIsIpv4 = 0U;
+        pReader->valid = 0U;
+    }
+
+    readChar( pReader, ':' );
+
+    return ( uint16_t ) readHex( pReader, NETSTAT_PORT_DIGITS );
+}
+/*-----------------------------------------------------------*/
+
+static void readSocket( ProcReader_t * pReader,
+                        ProcSocket_t * pSocket )
+{
+    uint32_t localAddress;
+    uint8_t isLocalIpv4;
+
+    /* The line starts with "sl:", the slot of the socket. */
+    ( void ) readDecimal( pReader );
+    readChar( pReader, ':' );
+    skipSpaces( pReader );
+    pSocket->localPort = readEndpoint( pReader, &( localAddress ), &( isLocalIpv4 ) );
+    readChar( pReader, ' ' );
+    skipSpaces( pReader );
+    pSocket->remotePort = readEndpoint( pReader, &( pSocket->remoteAddress ), &( pSocket->isIpv4 ) );
+    readChar( pReader, ' ' );
+    skipSpaces( pReader );
+    pSocket->state = ( uint8_t ) readHex( pReader, NETSTAT_STATE_DIGITS );
+    readChar( pReader, ' ' );
+    skipLine( pReader );
+}
+/*-----------------------------------------------------------*/
+
+static DefenderStatus_t appendPort( uint16_t * pPorts,
+                                    uint32_t portCapacity,
+                                    uint32_t * pPortCount,
+                                    uint16_t port )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+
+    if( *pPortCount < portCapacity )
+    {
+        pPorts[ *pPortCount ] = port;
+        ( *pPortCount )++;
+    }
+    else
+    {
+        ret = DefenderBufferTooSmall;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+static void readInterface( ProcReader_t * pReader,
+                           DefenderNetworkStats_t * pStats )
+{
+    uint64_t counters[ NETSTAT_DEV_COUNTERS ];
+    uint32_t nameStart = pReader->index, nameLength, i;
+
+    while( ( pReader->index < pReader->length ) &&
+           ( pReader->pText[ pReader->index ] != ':' ) &&
+           ( pReader->pText[ pReader->index ] != '\n' ) )
+    {
+        pReader->index++;
+    }
+
+    nameLength = pReader->index - nameStart;
+    readChar( pReader, ':' );
+
+    for( i = 0U; i < NETSTAT_DEV_COUNTERS; i++ )
+    {
+        skipSpaces( pReader );
+        counters[ i ] = readDecimal( pReader );
+    }
+
+    skipLine( pReader );
+
+    if( ( pReader->valid == 1U ) &&
+        ( ( nameLength != 2U ) || ( strncmp( &( pReader->pText[ nameStart ] ), "lo", 2U ) != 0 ) ) )
+    {
+        pStats->bytesIn += counters[ NETSTAT_DEV_BYTES_IN ];
+        pStats->packetsIn += counters[ NETSTAT_DEV_PACKETS_IN ];
+        pStats->bytesOut += counters[ NETSTAT_DEV_BYTES_OUT ];
+        pStats->packetsOut += counters[ NETSTAT_DEV_PACKETS_OUT ];
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void writePorts( DefenderWriter_t * pWriter,
+                        const uint16_t * pPorts,
+                        uint32_t portCount )
+{
+    uint32_t i, writtenCount = 0U;
+
+    Defender_WriteBytes( pWriter, REPORT_PORTS_START, STRING_LITERAL_LENGTH( REPORT_PORTS_START ) );
+
+    for( i = 0U; i < portCount; i++ )
+    {
+        if( ( i == 0U ) || ( pPorts[ i ] != pPorts[ i - 1U ] ) )
+        {
+            if( writtenCount > 0U )
+            {
+                Defender_WriteBytes( pWriter, ",", 1U );
+            }
+
+            Defender_WriteBytes( pWriter, REPORT_PORT_START, STRING_LITERAL_LENGTH( REPORT_PORT_START ) );
+            Defender_WriteDecimal( pWriter, pPorts[ i ] );
+            Defender_WriteBytes( pWriter, "}", 1U );
+            writtenCount++;
+        }
+    }
+
+    Defender_WriteBytes( pWriter, REPORT_PORTS_TOTAL_START, STRING_LITERAL_LENGTH( REPORT_PORTS_TOTAL_START ) );
+    Defender_WriteDecimal( pWriter, writtenCount );
+    Defender_WriteBytes( pWriter, "}", 1U );
+}
+/*-----------------------------------------------------------*/
+
+static void writeConnections( DefenderWriter_t * pWriter,
+                              const DefenderConnectionTable_t * pConnections )
+{
+    uint32_t connectionsLength = 0U;
+
+    if( pWriter->status == DefenderSuccess )
+    {
+        pWriter->status = Defender_ConnectionTableSerialize( pConnections,
+                                                             NULL,
+                                                             NULL,
+                                                             0U,
+                                                             &( pWriter->pBuffer[ pWriter->length ] ),
+                                                             pWriter->bufferLength - pWriter->length,
+                                                             &( connectionsLength ) );
+        pWriter->length += connectionsLength;
+    }
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_ParseTcpTable( const char * pText,
+                                         uint32_t textLength,
+                                         DefenderConnectionTable_t * pConnections,
+                                         uint16_t * pPorts,
+                                         uint32_t portCapacity,
+                                         uint32_t * pPortCount )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    ProcReader_t reader = { NULL, 0U, 0U, 1U };
+    ProcSocket_t socket;
+
+    if( ( pText == NULL ) ||
+        ( pConnections == NULL ) ||
+        ( ( pPorts == NULL ) && ( portCapacity > 0U ) ) ||
+        ( pPortCount == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pText: %p, pConnections: %p, "
+                    "pPorts: %p, portCapacity: %u, pPortCount: %p.",
+                    ( const void * ) pText,
+                    ( void * ) pConnections,
+                    ( void * ) pPorts,
+                    ( unsigned int ) portCapacity,
+                    ( void * ) pPortCount ) );
+    }
+    else
+    {
+        reader.pText = pText;
+        reader.length = textLength;
+
+        /* Skip the header line. */
+        skipLine( &( reader ) );
+
+        while( ( ret == DefenderSuccess ) && ( nextLine( &( reader ) ) == 1U ) )
+        {
+            readSocket( &( reader ), &( socket ) );
+
+            if( reader.valid == 0U )
+            {
+                ret = DefenderError;
+
+                LogError( ( "Invalid socket line before offset %u.", ( unsigned int ) reader.index ) );
+            }
+            else if( socket.state == NETSTAT_TCP_LISTEN )
+            {
+                ret = appendPort( pPorts, portCapacity, pPortCount, socket.localPort );
+            }
+            else if( ( socket.state == NETSTAT_TCP_ESTABLISHED ) && ( socket.isIpv4 == 1U ) )
+            {
+                ret = Defender_ConnectionTableAdd( pConnections, socket.remoteAddress,
+                                                   socket.remotePort, socket.localPort, 0U );
+            }
+            else
+            {
+                /* Empty else MISRA 15.7 */
+            }
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_ParseUdpTable( const char * pText,
+                                         uint32_t textLength,
+                                         uint16_t * pPorts,
+                                         uint32_t portCapacity,
+                                         uint32_t * pPortCount )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    ProcReader_t reader = { NULL, 0U, 0U, 1U };
+    ProcSocket_t socket;
+
+    if( ( pText == NULL ) ||
+        ( ( pPorts == NULL ) && ( portCapacity > 0U ) ) ||
+        ( pPortCount == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pText: %p, pPorts: %p, "
+                    "portCapacity: %u, pPortCount: %p.",
+                    ( const void * ) pText,
+                    ( void * ) pPorts,
+                    ( unsigned int ) portCapacity,
+                    ( void * ) pPortCount ) );
+    }
+    else
+    {
+        reader.pText = pText;
+        reader.length = textLength;
+
+        /* Skip the header line. */
+        skipLine( &( reader ) );
+
+        while( ( ret == DefenderSuccess ) && ( nextLine( &( reader ) ) == 1U ) )
+        {
+            readSocket( &( reader ), &( socket ) );
+
+            if( reader.valid == 0U )
+            {
+                ret = DefenderError;
+
+                LogError( ( "Invalid socket line before offset %u.", ( unsigned int ) reader.index ) );
+            }
+            else if( ( socket.state == NETSTAT_UDP_UNCONNECTED ) && ( socket.localPort != 0U ) )
+            {
+                ret = appendPort( pPorts, portCapacity, pPortCount, socket.localPort );
+            }
+            else
+            {
+                /* Empty else MISRA 15.7 */
+            }
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_ParseNetDev( const char * pText,
+                                       uint32_t textLength,
+                                       DefenderNetworkStats_t * pOutStats )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    ProcReader_t reader = { NULL, 0U, 0U, 1U };
+
+    if( ( pText == NULL ) || ( pOutStats == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pText: %p, pOutStats: %p.",
+                    ( const void * ) pText,
+                    ( void * ) pOutStats ) );
+    }
+    else
+    {
+        reader.pText = pText;
+        reader.length = textLength;
+        ( void ) memset( pOutStats, 0, sizeof( DefenderNetworkStats_t ) );
+
+        /* Skip the two header lines. */
+        skipLine( &( reader ) );
+        skipLine( &( reader ) );
+
+        while( ( reader.valid == 1U ) && ( nextLine( &( reader ) ) == 1U ) )
+        {
+            readInterface( &( reader ), pOutStats );
+        }
+
+        if( reader.valid == 0U )
+        {
+            ret = DefenderError;
+
+            LogError( ( "Invalid interface line before offset %u.", ( unsigned int ) reader.index ) );
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_SerializeNetworkReport( const DefenderNetworkMetrics_t * pMetrics,
+                                                  uint64_t reportId,
+                                                  char * pBuffer,
+                                                  uint32_t bufferLength,
+                                                  uint32_t * pOutLength )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    DefenderWriter_t writer;
+
+    if( ( pMetrics == NULL ) ||
+        ( pMetrics->pConnections == NULL ) ||
+        ( ( pMetrics->pTcpPorts == NULL ) && ( pMetrics->tcpPortCount > 0U ) ) ||
+        ( ( pMetrics->pUdpPorts == NULL ) && ( pMetrics->udpPortCount > 0U ) ) ||
+        ( pBuffer == NULL ) ||
+        ( pOutLength == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pMetrics: %p, pBuffer: %p, pOutLength: %p.",
+                    ( const void * ) pMetrics,
+                    ( void * ) pBuffer,
+                    ( void * ) pOutLength ) );
+    }
+    else
+    {
+        Defender_WriterInit( &( writer ), pBuffer, bufferLength );
+
+        Defender_WriteBytes( &( writer ), REPORT_START, STRING_LITERAL_LENGTH( REPORT_START ) );
+        Defender_WriteDecimal( &( writer ), reportId );
+        Defender_WriteBytes( &( writer ), REPORT_METRICS_START, STRING_LITERAL_LENGTH( REPORT_METRICS_START ) );
+        Defender_WriteBytes( &( writer ), REPORT_TCP_PORTS_START, STRING_LITERAL_LENGTH( REPORT_TCP_PORTS_START ) );
+        writePorts( &( writer ), pMetrics->pTcpPorts, pMetrics->tcpPortCount );
+        Defender_WriteBytes( &( writer ), REPORT_UDP_PORTS_START, STRING_LITERAL_LENGTH( REPORT_UDP_PORTS_START ) );
+        writePorts( &( writer ), pMetrics->pUdpPorts, pMetrics->udpPortCount );
+        Defender_WriteBytes( &( writer ), REPORT_BYTES_IN_START, STRING_LITERAL_LENGTH( REPORT_BYTES_IN_START ) );
+        Defender_WriteDecimal( &( writer ), pMetrics->stats.bytesIn );
+        Defender_WriteBytes( &( writer ), REPORT_BYTES_OUT_START, STRING_LITERAL_LENGTH( REPORT_BYTES_OUT_START ) );
+        Defender_WriteDecimal( &( writer ), pMetrics->stats.bytesOut );
+        Defender_WriteBytes( &( writer ), REPORT_PACKETS_IN_START, STRING_LITERAL_LENGTH( REPORT_PACKETS_IN_START ) );
+        Defender_WriteDecimal( &( writer ), pMetrics->stats.packetsIn );
+        Defender_WriteBytes( &( writer ), REPORT_PACKETS_OUT_START, STRING_LITERAL_LENGTH( REPORT_PACKETS_OUT_START ) );
+        Defender_WriteDecimal( &( writer ), pMetrics->stats.packetsOut );
+        Defender_WriteBytes( &( writer ), REPORT_CONNECTIONS_START, STRING_LITERAL_LENGTH( REPORT_CONNECTIONS_START ) );
+        writeConnections( &( writer ), pMetrics->pConnections );
+        Defender_WriteBytes( &( writer ), REPORT_END, STRING_LITERAL_LENGTH( REPORT_END ) );
+
+        ret = writer.status;
+
+        if( ret == DefenderSuccess )
+        {
+            *pOutLength = writer.length;
+        }
+        else
+        {
+            LogError( ( "Cannot write the report: %d. bufferLength: %u.",
+                        ( int ) ret,
+                        ( unsigned int ) bufferLength ) );
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,393 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_rate.c
+ * @brief Implementation of the rates of counters.
+ */
+
+/* Standard includes. */
+#include <assert.h>
+#include <inttypes.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Rate include. */
+#include "defender_rate.h"
+
+/* Writer include. */
+#include "defender_writer.h"
+
+/**
+ * @brief Milliseconds per second, scaled to the fixed point of a rate.
+ */
+#define RATE_SCALE             ( ( uint64_t ) 1000U << DEFENDER_RATE_FRACTION_BITS )
+
+/**
+ * @brief Parts of the custom metrics object.
+ */
+#define RATE_NUMBER_START      "\":[{\"" DEFENDER_REPORT_NUMBER_KEY "\":"
+#define RATE_NUMBER_END        "}]"
+
+/**
+ * @brief Get the amount counted since the last sample.
+ *
+ * @param[in] pRate The rate, with at least one sample.
+ * @param[in] value The new value of the counter.
+ * @param[out] pOutDelta The amount counted.
+ *
+ * @return 1 if the counter grew or wrapped; 0 if it was reset.
+ */
+static uint8_t getDelta( const DefenderRate_t * pRate,
+                         uint64_t value,
+                         uint64_t * pOutDelta );
+
+/**
+ * @brief Turn an amount counted over a time into a fixed point rate.
+ *
+ * @param[in] delta The amount.
+ * @param[in] elapsedMs The time, which is not 0.
+ *
+ * @return The amount per second in fixed point, saturated at UINT64_MAX.
+ */
+static uint64_t scaleRate( uint64_t delta,
+                           uint64_t elapsedMs );
+
+/**
+ * @brief Move a smoothed rate towards a new instant rate.
+ *
+ * The rate moves by 1 / 2^shift of the difference, and by at least one unit
+ * of the fixed point if the difference is not 0, so that a large shift does
+ * not stop the rate short of a steady instant rate.
+ *
+ * @param[in] rate The smoothed rate.
+ * @param[in] instant The instant rate.
+ * @param[in] shift The smoothing shift of the rate.
+ *
+ * @return The new smoothed rate.
+ */
+static uint64_t smoothRate( uint64_t rate,
+                            uint64_t instant,
+                            uint8_t shift );
+/*-----------------------------------------------------------*/
+
+static uint8_t getDelta( const DefenderRate_t * pRate,
+                         uint64_t value,
+                         uint64_t * pOutDelta )
+{
+    uint64_t half = ( uint64_t ) 1U << ( pRate->counterBits - 1U );
+    uint64_t maximum = ( half - 1U ) | half;
+    uint8_t counted = 1U;
+
+    assert( pRate->sampleCount > 0U );
+
+    if( value >= pRate->lastValue )
+    {
+        *pOutDelta = value - pRate->lastValue;
+    }
+    else if( ( pRate->lastValue >= half ) && ( value < half ) )
+    {
+        /* The counter went past its maximum back to 0. */
+        *pOutDelta = ( maximum - pRate->lastValue ) + value + 1U;
+    }
+    else
+    {
+        counted = 0U;
+    }
+
+    return counted;
+}
+/*-----------------------------------------------------------*/
+
+static uint64_t scaleRate( uint64_t delta,
+                           uint64_t elapsedMs )
+{
+    uint64_t rate = 0U;
+
+    assert( elapsedMs > 0U );
+
+    if( delta <= ( UINT64_MAX / RATE_SCALE ) )
+    {
+        rate = ( delta * RATE_SCALE ) / elapsedMs;
+    }
+    else if( ( delta / elapsedMs ) <= ( UINT64_MAX / RATE_SCALE ) )
+    {
+        /* Dividing first only loses less than one unit per millisecond. */
+        rate = ( delta / elapsedMs ) * RATE_SCALE;
+    }
+    else
+    {
+        rate = UINT64_MAX;
+    }
+
+    return rate;
+}
+/*-----------------------------------------------------------*/
+
+static uint64_t smoothRate( uint64_t rate,
+                            uint64_t instant,
+                            uint8_t shift )
+{
+    uint64_t difference = ( instant >= rate ) ? ( instant - rate ) : ( rate - instant );
+    uint64_t step = difference >> shift;
+
+    if( ( step == 0U ) && ( difference != 0U ) )
+    {
+        step = 1U;
+    }
+
+    return ( instant >= rate ) ? ( rate + step ) : ( rate - step );
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_RateInit( DefenderRate_t * pRate,
+                                    uint8_t counterBits,
+                                    uint8_t shift )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+
+    if( ( pRate == NULL ) ||
+        ( counterBits < 8U ) ||
+        ( counterBits > 64U ) ||
+        ( shift > DEFENDER_RATE_MAX_SHIFT ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pRate: %p, counterBits: %u, shift: %u.",
+                    ( void * ) pRate,
+                    ( unsigned int ) counterBits,
+                    ( unsigned int ) shift ) );
+    }
+    else
+    {
+        ( void ) memset( pRate, 0, sizeof( DefenderRate_t ) );
+        pRate->counterBits = counterBits;
+        pRate->shift = shift;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_RateUpdate( DefenderRate_t * pRate,
+                                      uint64_t value,
+                                      uint64_t timestampMs )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    uint64_t delta = 0U, instant = 0U;
+
+    if( ( pRate == NULL ) ||
+        ( pRate->counterBits < 8U ) ||
+        ( pRate->counterBits > 64U ) ||
+        ( ( pRate->counterBits < 64U ) && ( ( value >> pRate->counterBits ) != 0U ) ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pRate: %p, or the value is wider than the counter.",
+                    ( void * ) pRate ) );
+    }
+    else if( ( pRate->sampleCount > 0U ) && ( timestampMs <= pRate->lastTimestamp ) )
+    {
+        ret = DefenderError;
+
+        LogError( ( "The sample is not later than the last sample. timestampMs: %" PRIu64 ".",
+                    timestampMs ) );
+    }
+    else
+    {
+        if( ( pRate->sampleCount > 0U ) && ( getDelta( pRate, value, &( delta ) ) == 1U ) )
+        {
+            instant = scaleRate( delta, timestampMs - pRate->lastTimestamp );
+
+            if( pRate->sampleCount == 1U )
+            {
+                pRate->rate = instant;
+                pRate->sampleCount = 2U;
+            }
+            else
+            {
+                pRate->rate = smoothRate( pRate->rate, instant, pRate->shift );
+            }
+        }
+        else if( pRate->sampleCount == 0U )
+        {
+            pRate->sampleCount = 1U;
+        }
+        else
+        {
+            /* The counter was reset. The rate is kept. */
+        }
+
+        pRate->lastValue = value;
+        pRate->lastTimestamp = timestampMs;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_RateGet( const DefenderRate_t * pRate,
+                                   uint64_t * pOutPerSecond )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+
+    if( ( pRate == NULL ) || ( pOutPerSecond == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pRate: %p, pOutPerSecond: %p.",
+                    ( const void * ) pRate,
+                    ( void * ) pOutPerSecond ) );
+    }
+    else if( pRate->sampleCount < 2U )
+    {
+        ret = DefenderError;
+    }
+    else
+    {
+        /* Round to the nearest unit without overflowing near UINT64_MAX. */
+        *pOutPerSecond = ( pRate->rate >> DEFENDER_RATE_FRACTION_BITS ) +
+                         ( ( pRate->rate >> ( DEFENDER_RATE_FRACTION_BITS - 1U ) ) & 1U );
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_SerializeRates( const DefenderRate_t * pRates,
+                                          const char * const * ppNames,
+                                          const uint16_t * pNameLengths,
+                                          uint32_t rateCount,
+                                          char * pBuffer,
+                                          uint32_t bufferLength,
+                                          uint32_t * pOutLength )
+{
+    DefenderStatus_t ret = DefenderBadParameter;
+    uint32_t length = 0U;
+
+    if( pOutLength == NULL )
+    {
+        LogError( ( "Invalid input parameter. pOutLength: %p.",
+                    ( void * ) pOutLength ) );
+    }
+    else
+    {
+        ret = Defender_AppendRates( pRates, ppNames, pNameLengths, rateCount, pBuffer, bufferLength, &( length ) );
+
+        if( ret == DefenderSuccess )
+        {
+            *pOutLength = length;
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_AppendRates( const DefenderRate_t * pRates,
+                                       const char * const * ppNames,
+                                       const uint16_t * pNameLengths,
+                                       uint32_t rateCount,
+                                       char * pBuffer,
+                                       uint32_t bufferLength,
+                                       uint32_t * pInOutLength )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    DefenderWriter_t writer;
+    uint32_t i = 0U;
+    uint64_t perSecond = 0U;
+    uint8_t hasMembers = 0U;
+
+    if( ( ( rateCount > 0U ) && ( ( pRates == NULL ) || ( ppNames == NULL ) || ( pNameLengths == NULL ) ) ) ||
+        ( pBuffer == NULL ) ||
+        ( pInOutLength == NULL ) ||
+        ( *pInOutLength > bufferLength ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pRates: %p, ppNames: %p, pNameLengths: %p, "
+                    "rateCount: %u, pBuffer: %p, bufferLength: %u, pInOutLength: %p.",
+                    ( const void * ) pRates,
+                    ( const void * ) ppNames,
+                    ( const void * ) pNameLengths,
+                    ( unsigned int ) rateCount,
+                    ( void * ) pBuffer,
+                    ( unsigned int ) bufferLength,
+                    ( void * ) pInOutLength ) );
+    }
+    else
+    {
+        Defender_WriterInit( &( writer ), pBuffer, bufferLength );
+        writer.length = *pInOutLength;
+
+        ret = Defender_WriteObjectStart( &( writer ), &( hasMembers ) );
+
+        if( ret != DefenderSuccess )
+        {
+            LogError( ( "The buffer does not hold a custom metrics object. length: %u.",
+                        ( unsigned int ) *pInOutLength ) );
+        }
+        else
+        {
+            for( i = 0U; ( i < rateCount ) && ( writer.status == DefenderSuccess ); i++ )
+            {
+                if( Defender_RateGet( &( pRates[ i ] ), &( perSecond ) ) == DefenderSuccess )
+                {
+                    if( hasMembers == 1U )
+                    {
+                        Defender_WriteBytes( &( writer ), ",", 1U );
+                    }
+
+                    Defender_WriteBytes( &( writer ), "\"", 1U );
+                    Defender_WriteEscaped( &( writer ), ppNames[ i ], pNameLengths[ i ] );
+                    Defender_WriteBytes( &( writer ), RATE_NUMBER_START, STRING_LITERAL_LENGTH( RATE_NUMBER_START ) );
+                    Defender_WriteDecimal( &( writer ), perSecond );
+                    Defender_WriteBytes( &( writer ), RATE_NUMBER_END, STRING_LITERAL_LENGTH( RATE_NUMBER_END ) );
+                    hasMembers = 1U;
+                }
+            }
+
+            Defender_WriteObjectEnd( &( writer ), *pInOutLength );
+
+            ret = writer.status;
+
+            if( ret == DefenderSuccess )
+            {
+                *pInOutLength = writer.length;
+            }
+            else if( ret == DefenderBufferTooSmall )
+            {
+                LogError( ( "The buffer is too small for the rates. bufferLength: %u.",
+                            ( unsigned int ) bufferLength ) );
+            }
+            else
+            {
+                LogError( ( "Invalid metric name. Rate: %u.", ( unsigned int ) ( i - 1U ) ) );
+            }
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,927 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_response.c
+ * @brief Implementation of parsing the responses of AWS IoT Device Defender.
+ */
+
+/* Standard includes. */
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Response API include. */
+#include "defender_response.h"
+
+/* Index API include. */
+#include "defender_index.h"
+
+/**
+ * @brief Keys and values of a response.
+ */
+#define RESPONSE_THING_NAME_KEY                 "thingName"
+#define RESPONSE_LENGTH_THING_NAME_KEY          STRING_LITERAL_LENGTH( RESPONSE_THING_NAME_KEY )
+#define RESPONSE_REPORT_ID_KEY                  "reportId"
+#define RESPONSE_LENGTH_REPORT_ID_KEY           STRING_LITERAL_LENGTH( RESPONSE_REPORT_ID_KEY )
+#define RESPONSE_STATUS_KEY                     "status"
+#define RESPONSE_LENGTH_STATUS_KEY              STRING_LITERAL_LENGTH( RESPONSE_STATUS_KEY )
+#define RESPONSE_STATUS_DETAILS_KEY             "statusDetails"
+#define RESPONSE_LENGTH_STATUS_DETAILS_KEY      STRING_LITERAL_LENGTH( RESPONSE_STATUS_DETAILS_KEY )
+#define RESPONSE_TIMESTAMP_KEY                  "timestamp"
+#define RESPONSE_LENGTH_TIMESTAMP_KEY           STRING_LITERAL_LENGTH( RESPONSE_TIMESTAMP_KEY )
+#define RESPONSE_ERROR_CODE_KEY                 "ErrorCode"
+#define RESPONSE_LENGTH_ERROR_CODE_KEY          STRING_LITERAL_LENGTH( RESPONSE_ERROR_CODE_KEY )
+#define RESPONSE_ERROR_MESSAGE_KEY              "ErrorMessage"
+#define RESPONSE_LENGTH_ERROR_MESSAGE_KEY       STRING_LITERAL_LENGTH( RESPONSE_ERROR_MESSAGE_KEY )
+#define RESPONSE_STATUS_ACCEPTED                "ACCEPTED"
+#define RESPONSE_LENGTH_STATUS_ACCEPTED         STRING_LITERAL_LENGTH( RESPONSE_STATUS_ACCEPTED )
+#define RESPONSE_STATUS_REJECTED                "REJECTED"
+#define RESPONSE_LENGTH_STATUS_REJECTED         STRING_LITERAL_LENGTH( RESPONSE_STATUS_REJECTED )
+
+/**
+ * @brief Characters which end a number or a literal.
+ *
+ * Quotes are included so that a literal never contains the start of a string.
+ */
+#define RESPONSE_DELIMITERS                     ",}] \t\r\n\""
+
+/**
+ * @brief Position of the parser in a payload.
+ *
+ * When the payload has been indexed with #Defender_IndexStructurals, strings
+ * and containers are skipped with the index instead of byte by byte.
+ */
+typedef struct ResponseCursor
+{
+    const char * pBuffer;
+    uint32_t length;
+    uint32_t index;
+    const uint32_t * pStructurals; /**< The structural index, or NULL. */
+    uint32_t structuralCount;      /**< The number of entries in the index. */
+    uint32_t structural;           /**< The first entry at or after index. */
+} ResponseCursor_t;
+
+/**
+ * @brief Find the entry of the structural index at the cursor.
+ *
+ * @param[in] pCursor The cursor.
+ *
+ * @return 1 if the character at the cursor is in the index; 0 otherwise.
+ */
+static uint8_t seekStructural( ResponseCursor_t * pCursor );
+
+/**
+ * @brief Advance the cursor past any JSON whitespace.
+ *
+ * @param[in] pCursor The cursor.
+ */
+static void skipWhitespace( ResponseCursor_t * pCursor );
+
+/**
+ * @brief Consume a character after optional whitespace.
+ *
+ * @param[in] pCursor The cursor.
+ * @param[in] expected The expected character.
+ *
+ * @return #DefenderSuccess if the character is consumed; #DefenderError
+ * otherwise.
+ */
+static DefenderStatus_t consumeChar( ResponseCursor_t * pCursor,
+                                     char expected );
+
+/**
+ * @brief Skip a JSON string with the structural index.
+ *
+ * @param[in] pCursor The cursor, just after the opening quote.
+ * @param[out] ppOutString The string without quotes and without unescaping.
+ * @param[out] pOutLength The length of the string.
+ *
+ * @return 1 if the string is skipped; 0 if the opening quote is not in the
+ * index.
+ */
+static uint8_t skipIndexedString( ResponseCursor_t * pCursor,
+                                  const char ** ppOutString,
+                                  uint32_t * pOutLength );
+
+/**
+ * @brief Parse a JSON string after optional whitespace.
+ *
+ * @param[in] pCursor The cursor.
+ * @param[out] ppOutString The string without quotes and without unescaping.
+ * @param[out] pOutLength The length of the string.
+ *
+ * @return #DefenderSuccess if a string is parsed; #DefenderError otherwise.
+ */
+static DefenderStatus_t parseString( ResponseCursor_t * pCursor,
+                                     const char ** ppOutString,
+                                     uint32_t * pOutLength );
+
+/**
+ * @brief Parse a non-negative JSON integer that fits in 64 bits after
+ * optional whitespace.
+ *
+ * @param[in] pCursor The cursor.
+ * @param[out] pOutValue The integer.
+ *
+ * @return #DefenderSuccess if an integer is parsed; #DefenderError otherwise.
+ */
+static DefenderStatus_t parseUint64( ResponseCursor_t * pCursor,
+                                     uint64_t * pOutValue );
+
+/**
+ * @brief Skip a JSON object or array with the structural index.
+ *
+ * @param[in] pCursor The cursor, at the opening bracket.
+ * @param[out] pOutRet #DefenderSuccess if the brackets are balanced;
+ * #DefenderError otherwise.
+ *
+ * @return 1 if the container is skipped; 0 if the opening bracket is not in
+ * the index.
+ */
+static uint8_t skipIndexedContainer( ResponseCursor_t * pCursor,
+                                     DefenderStatus_t * pOutRet );
+
+/**
+ * @brief Skip a JSON object or array.
+ *
+ * @param[in] pCursor The cursor, at the opening bracket.
+ *
+ * @return #DefenderSuccess if the brackets are balanced; #DefenderError
+ * otherwise.
+ */
+static DefenderStatus_t skipContainer( ResponseCursor_t * pCursor );
+
+/**
+ * @brief Skip a JSON value after optional whitespace.
+ *
+ * Strings are checked for a closing quote and objects and arrays for balanced
+ * brackets. Skipped values are not checked any further.
+ *
+ * @param[in] pCursor The cursor.
+ *
+ * @return #DefenderSuccess if a value is skipped; #DefenderError otherwise.
+ */
+static DefenderStatus_t skipValue( ResponseCursor_t * pCursor );
+
+/**
+ * @brief Move to the next member of an object.
+ *
+ * Must first be called just after the opening brace with *pIsFirst set to 1.
+ *
+ * @param[in] pCursor The cursor.
+ * @param[in,out] pIsFirst Whether no member has been read yet.
+ * @param[out] ppOutKey The key of the member.
+ * @param[out] pOutKeyLength The length of the key.
+ * @param[out] pOutIsEnd Set to 1 if the end of the object is reached.
+ *
+ * @return #DefenderSuccess if the next member or the end of the object is
+ * found; #DefenderError otherwise.
+ */
+static DefenderStatus_t nextMember( ResponseCursor_t * pCursor,
+                                    uint8_t * pIsFirst,
+                                    const char ** ppOutKey,
+                                    uint32_t * pOutKeyLength,
+                                    uint8_t * pOutIsEnd );
+
+/**
+ * @brief Check if a key is equal to a literal.
+ *
+ * @param[in] pKey The key.
+ * @param[in] keyLength The length of the key.
+ * @param[in] pLiteral The literal.
+ * @param[in] literalLength The length of the literal.
+ *
+ * @return 1 if they are equal; 0 otherwise.
+ */
+static uint8_t keyEquals( const char * pKey,
+                          uint32_t keyLength,
+                          const char * pLiteral,
+                          uint32_t literalLength );
+
+/**
+ * @brief Parse the value of the status key.
+ *
+ * @param[in] pCursor The cursor.
+ * @param[out] pOutStatus The report status.
+ *
+ * @return #DefenderSuccess if the value is a known status; #DefenderError
+ * otherwise.
+ */
+static DefenderStatus_t parseStatus( ResponseCursor_t * pCursor,
+                                     DefenderReportStatus_t * pOutStatus );
+
+/**
+ * @brief Parse the value of the thing name key.
+ *
+ * @param[in] pCursor The cursor.
+ * @param[out] pResponse The response to update.
+ *
+ * @return #DefenderSuccess if the value is a valid thing name; #DefenderError
+ * otherwise.
+ */
+static DefenderStatus_t parseThingName( ResponseCursor_t * pCursor,
+                                        DefenderResponse_t * pResponse );
+
+/**
+ * @brief Parse the value of the status details key.
+ *
+ * @param[in] pCursor The cursor.
+ * @param[out] pResponse The response to update.
+ *
+ * @return #DefenderSuccess if the value is parsed; #DefenderError otherwise.
+ */
+static DefenderStatus_t parseStatusDetails( ResponseCursor_t * pCursor,
+                                            DefenderResponse_t * pResponse );
+
+/**
+ * @brief Parse the value of a member of the response object.
+ *
+ * @param[in] pCursor The cursor.
+ * @param[in] pKey The key of the member.
+ * @param[in] keyLength The length of the key.
+ * @param[out] pResponse The response to update.
+ * @param[in,out] pFoundKeys Bit 0 is set when the report ID is found and bit
+ * 1 when the status is found.
+ *
+ * @return #DefenderSuccess if the value is parsed; #DefenderError otherwise.
+ */
+static DefenderStatus_t parseMember( ResponseCursor_t * pCursor,
+                                     const char * pKey,
+                                     uint32_t keyLength,
+                                     DefenderResponse_t * pResponse,
+                                     uint8_t * pFoundKeys );
+
+/**
+ * @brief Parse a response from the start of the payload.
+ *
+ * @param[in] pCursor The cursor, at the start of the payload.
+ * @param[out] pResponse The parsed response.
+ *
+ * @return #DefenderSuccess if the response is parsed; #DefenderError
+ * otherwise.
+ */
+static DefenderStatus_t parseResponse( ResponseCursor_t * pCursor,
+                                       DefenderResponse_t * pResponse );
+/*-----------------------------------------------------------*/
+
+static uint8_t seekStructural( ResponseCursor_t * pCursor )
+{
+    assert( pCursor != NULL );
+
+    while( ( pCursor->structural < pCursor->structuralCount ) &&
+           ( pCursor->pStructurals[ pCursor->structural ] < pCursor->index ) )
+    {
+        pCursor->structural++;
+    }
+
+    return ( ( pCursor->structural < pCursor->structuralCount ) &&
+             ( pCursor->pStructurals[ pCursor->structural ] == pCursor->index ) ) ? 1U : 0U;
+}
+/*-----------------------------------------------------------*/
+
+static void skipWhitespace( ResponseCursor_t * pCursor )
+{
+    char c;
+
+    assert( pCursor != NULL );
+
+    while( pCursor->index < pCursor->length )
+    {
+        c = pCursor->pBuffer[ pCursor->index ];
+
+        if( ( c != ' ' ) && ( c != '\t' ) && ( c != '\n' ) && ( c != '\r' ) )
+        {
+            break;
+        }
+
+        pCursor->index++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static DefenderStatus_t consumeChar( ResponseCursor_t * pCursor,
+                                     char expected )
+{
+    DefenderStatus_t ret = DefenderError;
+
+    assert( pCursor != NULL );
+
+    skipWhitespace( pCursor );
+
+    if( ( pCursor->index < pCursor->length ) &&
+        ( pCursor->pBuffer[ pCursor->index ] == expected ) )
+    {
+        pCursor->index++;
+        ret = DefenderSuccess;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t skipIndexedString( ResponseCursor_t * pCursor,
+                                  const char ** ppOutString,
+                                  uint32_t * pOutLength )
+{
+    uint8_t isSkipped = 0U;
+    uint32_t closing;
+
+    /* Look up the opening quote, just before the cursor. */
+    pCursor->index--;
+
+    if( seekStructural( pCursor ) == 1U )
+    {
+        /* The index only has strings which are closed, and nothing inside
+         * them, so the next entry is the closing quote. */
+        assert( ( pCursor->structural + 1U ) < pCursor->structuralCount );
+
+        closing = pCursor->pStructurals[ pCursor->structural + 1U ];
+        *ppOutString = &( pCursor->pBuffer[ pCursor->index + 1U ] );
+        *pOutLength = closing - ( pCursor->index + 1U );
+        pCursor->index = closing;
+        pCursor->structural += 2U;
+        isSkipped = 1U;
+    }
+
+    pCursor->index++;
+
+    return isSkipped;
+}
+/*-----------------------------------------------------------*/
+
+static DefenderStatus_t parseString( ResponseCursor_t * pCursor,
+                                     const char ** ppOutString,
+                                     uint32_t * pOutLength )
+{
+    DefenderStatus_t ret = consumeChar( pCursor, '"' );
+    uint32_t start = pCursor->index;
+    uint8_t isClosed = 0U;
+    char c;
+
+    assert( ppOutString != NULL );
+    assert( pOutLength != NULL );
+
+    if( ( ret == DefenderSuccess ) && ( pCursor->pStructurals != NULL ) )
+    {
+        isClosed = skipIndexedString( pCursor, ppOutString, pOutLength );
+    }
+
+    while( ( ret == DefenderSuccess ) && ( isClosed == 0U ) && ( pCursor->index < pCursor->length ) )
+    {
+        c = pCursor->pBuffer[ pCursor->index ];
+
+        if( c == '"' )
+        {
+            *ppOutString = &( pCursor->pBuffer[ start ] );
+            *pOutLength = pCursor->index - start;
+            isClosed = 1U;
+        }
+        else if( ( ( uint8_t ) c ) < 0x20U )
+        {
+            /* Control characters must be escaped in JSON strings. */
+            ret = DefenderError;
+        }
+        else if( c == '\\' )
+        {
+            /* Skip the escaped character. */
+            pCursor->index++;
+        }
+        else
+        {
+            /* Empty else MISRA 15.7 */
+        }
+
+        pCursor->index++;
+    }
+
+    if( isClosed == 0U )
+    {
+        ret = DefenderError;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+static DefenderStatus_t parseUint64( ResponseCursor_t * pCursor,
+                                     uint64_t * pOutValue )
+{
+    DefenderStatus_t ret = DefenderError;
+    uint64_t value = 0U, digit;
+    uint32_t start;
+    char c;
+
+    assert( pOutValue != NULL );
+
+    skipWhitespace( pCursor );
+    start = pCursor->index;
+
+    while( pCursor->index < pCursor->length )
+    {
+        c = pCursor->pBuffer[ pCursor->index ];
+
+        if( ( c < '0' ) || ( c > '9' ) )
+        {
+            break;
+        }
+
+        digit = ( uint64_t ) c - ( uint64_t ) '0';
+
+        if( value > ( ( UINT64_MAX - digit ) / 10U ) )
+        {
+            break;
+        }
+
+        value = ( value * 10U ) + digit;
+        pCursor->index++;
+    }
+
+    /* At least one digit, no leading zeros, and the number must end here, so
+     * fractions, exponents and numbers that overflow are rejected. strchr
+     * would match the terminator of the delimiters, so NUL is not one. */
+    if( ( pCursor->index > start ) &&
+        ( ( pCursor->pBuffer[ start ] != '0' ) || ( pCursor->index == ( start + 1U ) ) ) &&
+        ( ( pCursor->index == pCursor->length ) ||
+          ( ( pCursor->pBuffer[ pCursor->index ] != '\0' ) &&
+            ( strchr( RESPONSE_DELIMITERS, ( int ) pCursor->pBuffer[ pCursor->index ] ) != NULL ) ) ) )
+    {
+        *pOutValue = value;
+        ret = DefenderSuccess;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t skipIndexedContainer( ResponseCursor_t * pCursor,
+                                     DefenderStatus_t * pOutRet )
+{
+    uint8_t isSkipped = seekStructural( pCursor );
+    uint32_t depth = 0U;
+    char c;
+
+    while( ( isSkipped == 1U ) && ( pCursor->structural < pCursor->structuralCount ) )
+    {
+        pCursor->index = pCursor->pStructurals[ pCursor->structural ];
+        c = pCursor->pBuffer[ pCursor->index ];
+        pCursor->structural++;
+
+        if( c == '"' )
+        {
+            /* Move to the closing quote. */
+            pCursor->index = pCursor->pStructurals[ pCursor->structural ];
+            pCursor->structural++;
+        }
+        else if( ( c == '{' ) || ( c == '[' ) )
+        {
+            depth++;
+        }
+        else if( ( c == '}' ) || ( c == ']' ) )
+        {
+            depth--;
+        }
+        else
+        {
+            /* Empty else MISRA 15.7 */
+        }
+
+        if( depth == 0U )
+        {
+            break;
+        }
+    }
+
+    if( isSkipped == 1U )
+    {
+        pCursor->index++;
+        *pOutRet = ( depth == 0U ) ? DefenderSuccess : DefenderError;
+    }
+
+    return isSkipped;
+}
+/*-----------------------------------------------------------*/
+
+static DefenderStatus_t skipContainer( ResponseCursor_t * pCursor )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    uint32_t depth = 0U, length = 0U;
+    const char * pString = NULL;
+    char c;
+
+    assert( pCursor != NULL );
+
+    do
+    {
+        c = pCursor->pBuffer[ pCursor->index ];
+
+        if( c == '"' )
+        {
+            ret = parseString( pCursor, &( pString ), &( length ) );
+        }
+        else
+        {
+            if( ( c == '{' ) || ( c == '[' ) )
+            {
+                depth++;
+            }
+            else if( ( c == '}' ) || ( c == ']' ) )
+            {
+                depth--;
+            }
+            else
+            {
+                /* Empty else MISRA 15.7 */
+            }
+
+            pCursor->index++;
+        }
+    } while( ( ret == DefenderSuccess ) && ( depth > 0U ) && ( pCursor->index < pCursor->length ) );
+
+    if( depth > 0U )
+    {
+        ret = DefenderError;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+static DefenderStatus_t skipValue( ResponseCursor_t * pCursor )
+{
+    DefenderStatus_t ret = DefenderError;
+    uint32_t start = 0U, length = 0U;
+    const char * pString = NULL;
+    char c;
+
+    skipWhitespace( pCursor );
+
+    if( pCursor->index < pCursor->length )
+    {
+        c = pCursor->pBuffer[ pCursor->index ];
+
+        if( c == '"' )
+        {
+            ret = parseString( pCursor, &( pString ), &( length ) );
+        }
+        else if( ( c == '{' ) || ( c == '[' ) )
+        {
+            if( ( pCursor->pStructurals == NULL ) ||
+                ( skipIndexedContainer( pCursor, &( ret ) ) == 0U ) )
+            {
+                ret = skipContainer( pCursor );
+            }
+        }
+        else
+        {
+            /* Numbers, true, false and null end at the next delimiter. */
+            start = pCursor->index;
+
+            while( ( pCursor->index < pCursor->length ) &&
+                   ( strchr( RESPONSE_DELIMITERS, ( int ) pCursor->pBuffer[ pCursor->index ] ) == NULL ) )
+            {
+                pCursor->index++;
+            }
+
+            ret = ( pCursor->index > start ) ? DefenderSuccess : DefenderError;
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+static DefenderStatus_t nextMember( ResponseCursor_t * pCursor,
+                                    uint8_t * pIsFirst,
+                                    const char ** ppOutKey,
+                                    uint32_t * pOutKeyLength,
+                                    uint8_t * pOutIsEnd )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+
+    assert( pIsFirst != NULL );
+    assert( pOutIsEnd != NULL );
+
+    *pOutIsEnd = 0U;
+
+    if( consumeChar( pCursor, '}' ) == DefenderSuccess )
+    {
+        *pOutIsEnd = 1U;
+    }
+    else if( *pIsFirst == 0U )
+    {
+        ret = consumeChar( pCursor, ',' );
+    }
+    else
+    {
+        /* Empty else MISRA 15.7 */
+    }
+
+    if( ( ret == DefenderSuccess ) && ( *pOutIsEnd == 0U ) )
+    {
+        ret = parseString( pCursor, ppOutKey, pOutKeyLength );
+
+        if( ret == DefenderSuccess )
+        {
+            ret = consumeChar( pCursor, ':' );
+        }
+
+        *pIsFirst = 0U;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t keyEquals( const char * pKey,
+                          uint32_t keyLength,
+                          const char * pLiteral,
+                          uint32_t literalLength )
+{
+    return ( ( keyLength == literalLength ) &&
+             ( memcmp( pKey, pLiteral, ( size_t ) literalLength ) == 0 ) ) ? 1U : 0U;
+}
+/*-----------------------------------------------------------*/
+
+static DefenderStatus_t parseStatus( ResponseCursor_t * pCursor,
+                                     DefenderReportStatus_t * pOutStatus )
+{
+    const char * pValue = NULL;
+    uint32_t valueLength = 0U;
+    DefenderStatus_t ret = parseString( pCursor, &( pValue ), &( valueLength ) );
+
+    if( ret == DefenderSuccess )
+    {
+        if( keyEquals( pValue, valueLength, RESPONSE_STATUS_ACCEPTED, RESPONSE_LENGTH_STATUS_ACCEPTED ) == 1U )
+        {
+            *pOutStatus = DefenderReportAccepted;
+        }
+        else if( keyEquals( pValue, valueLength, RESPONSE_STATUS_REJECTED, RESPONSE_LENGTH_STATUS_REJECTED ) == 1U )
+        {
+            *pOutStatus = DefenderReportRejected;
+        }
+        else
+        {
+            ret = DefenderError;
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+static DefenderStatus_t parseThingName( ResponseCursor_t * pCursor,
+                                        DefenderResponse_t * pResponse )
+{
+    const char * pValue = NULL;
+    uint32_t valueLength = 0U;
+    DefenderStatus_t ret = parseString( pCursor, &( pValue ), &( valueLength ) );
+
+    if( ret == DefenderSuccess )
+    {
+        if( ( valueLength == 0U ) || ( valueLength > DEFENDER_THINGNAME_MAX_LENGTH ) )
+        {
+            ret = DefenderError;
+        }
+        else
+        {
+            pResponse->pThingName = pValue;
+            pResponse->thingNameLength = ( uint16_t ) valueLength;
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+static DefenderStatus_t parseStatusDetails( ResponseCursor_t * pCursor,
+                                            DefenderResponse_t * pResponse )
+{
+    DefenderStatus_t ret = consumeChar( pCursor, '{' );
+    const char * pKey = NULL;
+    uint32_t keyLength = 0U;
+    uint8_t isFirst = 1U, isEnd = 0U;
+
+    while( ( ret == DefenderSuccess ) && ( isEnd == 0U ) )
+    {
+        ret = nextMember( pCursor, &( isFirst ), &( pKey ), &( keyLength ), &( isEnd ) );
+
+        if( ( ret != DefenderSuccess ) || ( isEnd == 1U ) )
+        {
+            /* Nothing more to parse. */
+        }
+        else if( keyEquals( pKey, keyLength, RESPONSE_ERROR_CODE_KEY, RESPONSE_LENGTH_ERROR_CODE_KEY ) == 1U )
+        {
+            ret = parseString( pCursor, &( pResponse->pErrorCode ), &( pResponse->errorCodeLength ) );
+        }
+        else if( keyEquals( pKey, keyLength, RESPONSE_ERROR_MESSAGE_KEY, RESPONSE_LENGTH_ERROR_MESSAGE_KEY ) == 1U )
+        {
+            ret = parseString( pCursor, &( pResponse->pErrorMessage ), &( pResponse->errorMessageLength ) );
+        }
+        else
+        {
+            ret = skipValue( pCursor );
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+static DefenderStatus_t parseMember( ResponseCursor_t * pCursor,
+                                     const char * pKey,
+                                     uint32_t keyLength,
+                                     DefenderResponse_t * pResponse,
+                                     uint8_t * pFoundKeys )
+{
+    DefenderStatus_t ret;
+
+    if( keyEquals( pKey, keyLength, RESPONSE_REPORT_ID_KEY, RESPONSE_LENGTH_REPORT_ID_KEY ) == 1U )
+    {
+        ret = parseUint64( pCursor, &( pResponse->reportId ) );
+        *pFoundKeys |= 1U;
+    }
+    else if( keyEquals( pKey, keyLength, RESPONSE_STATUS_KEY, RESPONSE_LENGTH_STATUS_KEY ) == 1U )
+    {
+        ret = parseStatus( pCursor, &( pResponse->status ) );
+        *pFoundKeys |= 2U;
+    }
+    else if( keyEquals( pKey, keyLength, RESPONSE_THING_NAME_KEY, RESPONSE_LENGTH_THING_NAME_KEY ) == 1U )
+    {
+        ret = parseThingName( pCursor, pResponse );
+    }
+    else if( keyEquals( pKey, keyLength, RESPONSE_STATUS_DETAILS_KEY, RESPONSE_LENGTH_STATUS_DETAILS_KEY ) == 1U )
+    {
+        ret = parseStatusDetails( pCursor, pResponse );
+    }
+    else if( keyEquals( pKey, keyLength, RESPONSE_TIMESTAMP_KEY, RESPONSE_LENGTH_TIMESTAMP_KEY ) == 1U )
+    {
+        ret = parseUint64( pCursor, &( pResponse->timestamp ) );
+    }
+    else
+    {
+        ret = skipValue( pCursor );
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+static DefenderStatus_t parseResponse( ResponseCursor_t * pCursor,
+                                       DefenderResponse_t * pResponse )
+{
+    DefenderStatus_t ret;
+    const char * pKey = NULL;
+    uint32_t keyLength = 0U;
+    uint8_t isFirst = 1U, isEnd = 0U, foundKeys = 0U;
+
+    ( void ) memset( pResponse, 0, sizeof( DefenderResponse_t ) );
+
+    ret = consumeChar( pCursor, '{' );
+
+    while( ( ret == DefenderSuccess ) && ( isEnd == 0U ) )
+    {
+        ret = nextMember( pCursor, &( isFirst ), &( pKey ), &( keyLength ), &( isEnd ) );
+
+        if( ( ret == DefenderSuccess ) && ( isEnd == 0U ) )
+        {
+            ret = parseMember( pCursor, pKey, keyLength, pResponse, &( foundKeys ) );
+        }
+    }
+
+    if( ret == DefenderSuccess )
+    {
+        skipWhitespace( pCursor );
+
+        if( ( pCursor->index != pCursor->length ) || ( foundKeys != 3U ) )
+        {
+            ret = DefenderError;
+        }
+    }
+
+    if( ret == DefenderError )
+    {
+        LogDebug( ( "The payload is not a Device Defender response." ) );
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_ParseResponse( const char * pPayload,
+                                         uint32_t payloadLength,
+                                         DefenderResponse_t * pOutResponse )
+{
+    DefenderStatus_t ret;
+    ResponseCursor_t cursor;
+
+    if( ( pPayload == NULL ) || ( payloadLength == 0U ) || ( pOutResponse == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pPayload: %p, payloadLength: %u, pOutResponse: %p.",
+                    ( const void * ) pPayload,
+                    ( unsigned int ) payloadLength,
+                    ( void * ) pOutResponse ) );
+    }
+    else
+    {
+        ( void ) memset( &( cursor ), 0, sizeof( cursor ) );
+        cursor.pBuffer = pPayload;
+        cursor.length = payloadLength;
+
+        ret = parseResponse( &( cursor ), pOutResponse );
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_ParseResponses( const DefenderPayload_t * pPayloads,
+                                          uint32_t payloadCount,
+                                          uint32_t * pIndexBuffer,
+                                          uint32_t indexBufferLength,
+                                          DefenderResponse_t * pOutResponses,
+                                          uint32_t * pOutParsedCount )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    ResponseCursor_t cursor;
+    uint32_t i, parsedCount = 0U;
+
+    if( ( pPayloads == NULL ) || ( payloadCount == 0U ) ||
+        ( pIndexBuffer == NULL ) || ( indexBufferLength == 0U ) ||
+        ( pOutResponses == NULL ) || ( pOutParsedCount == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pPayloads: %p, payloadCount: %u, "
+                    "pIndexBuffer: %p, indexBufferLength: %u, pOutResponses: %p, "
+                    "pOutParsedCount: %p.",
+                    ( const void * ) pPayloads,
+                    ( unsigned int ) payloadCount,
+                    ( void * ) pIndexBuffer,
+                    ( unsigned int ) indexBufferLength,
+                    ( void * ) pOutResponses,
+                    ( void * ) pOutParsedCount ) );
+    }
+    else
+    {
+        for( i = 0U; i < payloadCount; i++ )
+        {
+            ( void ) memset( &( cursor ), 0, sizeof( cursor ) );
+            cursor.pBuffer = pPayloads[ i ].pPayload;
+            cursor.length = pPayloads[ i ].payloadLength;
+
+            if( ( cursor.pBuffer == NULL ) || ( cursor.length == 0U ) )
+            {
+                ( void ) memset( &( pOutResponses[ i ] ), 0, sizeof( DefenderResponse_t ) );
+            }
+            else
+            {
+                /* Payloads which cannot be indexed are parsed byte by byte, so
+                 * that the result never depends on the size of the index. */
+                if( Defender_IndexStructurals( cursor.pBuffer, cursor.length,
+                                               pIndexBuffer, indexBufferLength,
+                                               &( cursor.structuralCount ) ) == DefenderSuccess )
+                {
+                    cursor.pStructurals = pIndexBuffer;
+                }
+
+                if( parseResponse( &( cursor ), &( pOutResponses[ i ] ) ) == DefenderSuccess )
+                {
+                    parsedCount++;
+                }
+                else
+                {
+                    ( void ) memset( &( pOutResponses[ i ] ), 0, sizeof( DefenderResponse_t ) );
+                }
+            }
+        }
+
+        *pOutParsedCount = parsedCount;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
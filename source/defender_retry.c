@@ -0,0 +1,226 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_retry.c
+ * @brief Implementation of the retry manager of reports.
+ */
+
+/* Standard includes. */
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Retry manager include. */
+#include "defender_retry.h"
+
+/**
+ * @brief State of the random number generator when the seed is 0, which
+ * xorshift cannot use.
+ */
+#define RETRY_DEFAULT_SEED         UINT64_C( 0x9E3779B97F4A7C15 )
+
+/**
+ * @brief Multiplier of the output of the xorshift64* generator.
+ */
+#define RETRY_RANDOM_MULTIPLIER    UINT64_C( 0x2545F4914F6CDD1D )
+
+/**
+ * @brief Get the next random number of a retry manager.
+ *
+ * @param[in] pManager The retry manager.
+ *
+ * @return A random number.
+ */
+static uint64_t nextRandom( DefenderRetryManager_t * pManager );
+
+/**
+ * @brief Draw the next delay of a thing with decorrelated jitter.
+ *
+ * @param[in] pManager The retry manager.
+ * @param[in] lastDelayMs The last delay of the thing, or 0.
+ *
+ * @return A delay between the base delay and three times the last delay,
+ * and not more than the maximum delay.
+ */
+static uint32_t nextDelay( DefenderRetryManager_t * pManager,
+                           uint32_t lastDelayMs );
+
+/*-----------------------------------------------------------*/
+
+static uint64_t nextRandom( DefenderRetryManager_t * pManager )
+{
+    uint64_t state = pManager->randomState;
+
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    pManager->randomState = state;
+
+    return state * RETRY_RANDOM_MULTIPLIER;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t nextDelay( DefenderRetryManager_t * pManager,
+                           uint32_t lastDelayMs )
+{
+    uint64_t upper = 3U * ( uint64_t ) ( ( lastDelayMs == 0U ) ? pManager->baseDelayMs : lastDelayMs );
+
+    if( upper > pManager->maxDelayMs )
+    {
+        upper = pManager->maxDelayMs;
+    }
+
+    assert( upper >= pManager->baseDelayMs );
+
+    return pManager->baseDelayMs +
+           ( uint32_t ) ( nextRandom( pManager ) % ( upper - pManager->baseDelayMs + 1U ) );
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_RetryInit( DefenderRetryManager_t * pManager,
+                                     DefenderRetryEntry_t * pEntries,
+                                     uint32_t entryCount,
+                                     uint32_t baseDelayMs,
+                                     uint32_t maxDelayMs,
+                                     uint32_t maxOutstanding,
+                                     uint64_t seed )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+
+    if( ( pManager == NULL ) || ( pEntries == NULL ) || ( entryCount == 0U ) ||
+        ( baseDelayMs == 0U ) || ( maxDelayMs < baseDelayMs ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pManager: %p, pEntries: %p, entryCount: %u, "
+                    "baseDelayMs: %u, maxDelayMs: %u.",
+                    ( void * ) pManager,
+                    ( void * ) pEntries,
+                    ( unsigned int ) entryCount,
+                    ( unsigned int ) baseDelayMs,
+                    ( unsigned int ) maxDelayMs ) );
+    }
+    else
+    {
+        ( void ) memset( pEntries, 0, ( size_t ) entryCount * sizeof( DefenderRetryEntry_t ) );
+
+        pManager->pEntries = pEntries;
+        pManager->entryCount = entryCount;
+        pManager->baseDelayMs = baseDelayMs;
+        pManager->maxDelayMs = maxDelayMs;
+        pManager->maxOutstanding = maxOutstanding;
+        pManager->outstanding = 0U;
+        pManager->randomState = ( seed == 0U ) ? RETRY_DEFAULT_SEED : seed;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_RetryOnFailure( DefenderRetryManager_t * pManager,
+                                          uint32_t thingId,
+                                          uint64_t nowMs,
+                                          uint64_t scheduledMs,
+                                          uint64_t * pOutDeadline )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    DefenderRetryEntry_t * pEntry;
+    uint64_t retryMs;
+
+    if( ( pManager == NULL ) || ( pManager->pEntries == NULL ) ||
+        ( thingId >= pManager->entryCount ) || ( pOutDeadline == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pManager: %p, thingId: %u, pOutDeadline: %p.",
+                    ( void * ) pManager,
+                    ( unsigned int ) thingId,
+                    ( void * ) pOutDeadline ) );
+    }
+    else
+    {
+        pEntry = &( pManager->pEntries[ thingId ] );
+        pEntry->lastDelayMs = nextDelay( pManager, pEntry->lastDelayMs );
+        retryMs = nowMs + pEntry->lastDelayMs;
+
+        if( ( retryMs >= scheduledMs ) ||
+            ( ( pEntry->pending == 0U ) && ( pManager->outstanding >= pManager->maxOutstanding ) ) )
+        {
+            /* The next scheduled report is the retry. */
+            ret = DefenderNoMatch;
+            *pOutDeadline = scheduledMs;
+
+            if( pEntry->pending != 0U )
+            {
+                pEntry->pending = 0U;
+                pManager->outstanding--;
+            }
+        }
+        else
+        {
+            *pOutDeadline = retryMs;
+
+            if( pEntry->pending == 0U )
+            {
+                pEntry->pending = 1U;
+                pManager->outstanding++;
+            }
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_RetryOnSuccess( DefenderRetryManager_t * pManager,
+                                          uint32_t thingId )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    DefenderRetryEntry_t * pEntry;
+
+    if( ( pManager == NULL ) || ( pManager->pEntries == NULL ) || ( thingId >= pManager->entryCount ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pManager: %p, thingId: %u.",
+                    ( void * ) pManager,
+                    ( unsigned int ) thingId ) );
+    }
+    else
+    {
+        pEntry = &( pManager->pEntries[ thingId ] );
+
+        if( pEntry->pending != 0U )
+        {
+            pEntry->pending = 0U;
+            pManager->outstanding--;
+        }
+
+        pEntry->lastDelayMs = 0U;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
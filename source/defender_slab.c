@@ -0,0 +1,195 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_slab.c
+ * @brief Implementation of the slab of objects.
+ */
+
+/* Standard includes. */
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Slab include. */
+#include "defender_slab.h"
+
+/**
+ * @brief Index of the end of the list of freed objects.
+ */
+#define SLAB_NO_INDEX    UINT32_MAX
+
+/**
+ * @brief Get an object of a slab.
+ *
+ * @param[in] pSlab The slab.
+ * @param[in] index The index of the object.
+ *
+ * @return The first byte of the object.
+ */
+static uint8_t * getObject( const DefenderSlab_t * pSlab,
+                            uint32_t index );
+
+/*-----------------------------------------------------------*/
+
+static uint8_t * getObject( const DefenderSlab_t * pSlab,
+                            uint32_t index )
+{
+    assert( index < pSlab->objectCount );
+
+    return &( pSlab->pObjects[ ( size_t ) index * pSlab->objectLength ] );
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_SlabInit( DefenderSlab_t * pSlab,
+                                    uint8_t * pMemory,
+                                    uint32_t memoryLength,
+                                    uint32_t objectLength )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    uint32_t skipped = 0U, alignedLength = 0U;
+
+    if( ( pSlab == NULL ) ||
+        ( pMemory == NULL ) ||
+        ( objectLength == 0U ) ||
+        ( objectLength > ( UINT32_MAX - DEFENDER_SLAB_ALIGNMENT ) ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pSlab: %p, pMemory: %p, objectLength: %u.",
+                    ( void * ) pSlab,
+                    ( void * ) pMemory,
+                    ( unsigned int ) objectLength ) );
+    }
+    else
+    {
+        /* Skip to the first cache line boundary. */
+        skipped = ( uint32_t ) ( ( DEFENDER_SLAB_ALIGNMENT - ( ( uintptr_t ) pMemory % DEFENDER_SLAB_ALIGNMENT ) ) %
+                                 DEFENDER_SLAB_ALIGNMENT );
+        alignedLength = ( objectLength + DEFENDER_SLAB_ALIGNMENT - 1U ) & ~( DEFENDER_SLAB_ALIGNMENT - 1U );
+
+        if( ( memoryLength < skipped ) || ( ( memoryLength - skipped ) < alignedLength ) )
+        {
+            ret = DefenderBufferTooSmall;
+
+            LogError( ( "The memory cannot hold an object. memoryLength: %u, objectLength: %u.",
+                        ( unsigned int ) memoryLength,
+                        ( unsigned int ) objectLength ) );
+        }
+        else
+        {
+            pSlab->pObjects = &( pMemory[ skipped ] );
+            pSlab->objectLength = alignedLength;
+            pSlab->objectCount = ( memoryLength - skipped ) / alignedLength;
+            pSlab->usedCount = 0U;
+            pSlab->freshIndex = 0U;
+            pSlab->freeIndex = SLAB_NO_INDEX;
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_SlabAlloc( DefenderSlab_t * pSlab,
+                                     void ** ppOutObject )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    uint32_t index = 0U;
+
+    if( ( pSlab == NULL ) || ( pSlab->pObjects == NULL ) || ( ppOutObject == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pSlab: %p, ppOutObject: %p.",
+                    ( void * ) pSlab,
+                    ( void * ) ppOutObject ) );
+    }
+    else if( pSlab->freeIndex != SLAB_NO_INDEX )
+    {
+        /* A freed object holds the index of the next freed object. */
+        index = pSlab->freeIndex;
+        ( void ) memcpy( &( pSlab->freeIndex ), getObject( pSlab, index ), sizeof( uint32_t ) );
+        *ppOutObject = getObject( pSlab, index );
+        pSlab->usedCount++;
+    }
+    else if( pSlab->freshIndex < pSlab->objectCount )
+    {
+        *ppOutObject = getObject( pSlab, pSlab->freshIndex );
+        pSlab->freshIndex++;
+        pSlab->usedCount++;
+    }
+    else
+    {
+        ret = DefenderBufferTooSmall;
+
+        LogError( ( "All objects of the slab are allocated. objectCount: %u.",
+                    ( unsigned int ) pSlab->objectCount ) );
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_SlabFree( DefenderSlab_t * pSlab,
+                                    void * pObject )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    uintptr_t offset = 0U;
+    uint32_t index = 0U;
+
+    if( ( pSlab == NULL ) || ( pSlab->pObjects == NULL ) || ( pObject == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pSlab: %p, pObject: %p.",
+                    ( void * ) pSlab,
+                    pObject ) );
+    }
+    else
+    {
+        /* Pointers into other memory are compared as integers, since
+         * comparing them as pointers is undefined. */
+        offset = ( uintptr_t ) pObject - ( uintptr_t ) pSlab->pObjects;
+
+        if( ( pSlab->usedCount == 0U ) ||
+            ( offset >= ( ( uintptr_t ) pSlab->freshIndex * pSlab->objectLength ) ) ||
+            ( ( offset % pSlab->objectLength ) != 0U ) )
+        {
+            ret = DefenderBadParameter;
+
+            LogError( ( "The pointer is not an allocated object of the slab. pObject: %p.", pObject ) );
+        }
+        else
+        {
+            index = ( uint32_t ) ( offset / pSlab->objectLength );
+            ( void ) memcpy( getObject( pSlab, index ), &( pSlab->freeIndex ), sizeof( uint32_t ) );
+            pSlab->freeIndex = index;
+            pSlab->usedCount--;
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,399 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_sort.c
+ * @brief Implementation of the radix sorts of report lists.
+ */
+
+/* Standard includes. */
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Sort API include. */
+#include "defender_sort.h"
+
+/**
+ * @brief Number of values of a sort digit.
+ */
+#define SORT_RADIX         256U
+
+/**
+ * @brief Number of values whose digits are taken at a time, so that the list
+ * type is handled by one call per block instead of one per value.
+ */
+#define SORT_BLOCK_SIZE    64U
+
+/**
+ * @brief Get a byte of a block of ports for #Defender_RadixSort.
+ *
+ * @param[in] pList The ports.
+ * @param[in] start The index of the first port of the block.
+ * @param[in] length The number of ports in the block.
+ * @param[in] pass The byte, 0 for the least significant one.
+ * @param[out] pDigits The byte of each port of the block.
+ */
+static void getPortDigits( const void * pList,
+                           uint32_t start,
+                           uint32_t length,
+                           uint32_t pass,
+                           uint8_t * pDigits );
+
+/**
+ * @brief Copy a block of ports to their positions in another list for
+ * #Defender_RadixSort.
+ *
+ * @param[in] pSource The ports to read.
+ * @param[in] start The index of the first port of the block in pSource.
+ * @param[in] length The number of ports in the block.
+ * @param[out] pDestination The ports to write.
+ * @param[in] pIndices The index in pDestination of each port of the block.
+ */
+static void movePorts( const void * pSource,
+                       uint32_t start,
+                       uint32_t length,
+                       void * pDestination,
+                       const uint32_t * pIndices );
+
+/**
+ * @brief Get a byte of a block of addresses for #Defender_RadixSort.
+ *
+ * @param[in] pList The addresses.
+ * @param[in] start The index of the first IPv4 address of the block.
+ * @param[in] length The number of addresses in the block.
+ * @param[in] pass The byte, 0 for the least significant one.
+ * @param[out] pDigits The byte of each IPv4 address of the block.
+ */
+static void getAddressDigits( const void * pList,
+                              uint32_t start,
+                              uint32_t length,
+                              uint32_t pass,
+                              uint8_t * pDigits );
+
+/**
+ * @brief Copy a block of addresses to their positions in another list for
+ * #Defender_RadixSort.
+ *
+ * @param[in] pSource The addresses to read.
+ * @param[in] start The index of the first IPv4 address of the block in pSource.
+ * @param[in] length The number of addresses in the block.
+ * @param[out] pDestination The addresses to write.
+ * @param[in] pIndices The index in pDestination of each IPv4 address of the block.
+ */
+static void moveAddresses( const void * pSource,
+                           uint32_t start,
+                           uint32_t length,
+                           void * pDestination,
+                           const uint32_t * pIndices );
+
+/**
+ * @brief Get a byte of a block of numbers for #Defender_RadixSort.
+ *
+ * @param[in] pList The numbers.
+ * @param[in] start The index of the first number of the block.
+ * @param[in] length The number of numbers in the block.
+ * @param[in] pass The byte, 0 for the least significant one.
+ * @param[out] pDigits The byte of each number of the block.
+ */
+static void getNumberDigits( const void * pList,
+                             uint32_t start,
+                             uint32_t length,
+                             uint32_t pass,
+                             uint8_t * pDigits );
+
+/**
+ * @brief Copy a block of numbers to their positions in another list for
+ * #Defender_RadixSort.
+ *
+ * @param[in] pSource The numbers to read.
+ * @param[in] start The index of the first number of the block in pSource.
+ * @param[in] length The number of numbers in the block.
+ * @param[out] pDestination The numbers to write.
+ * @param[in] pIndices The index in pDestination of each number of the block.
+ */
+static void moveNumbers( const void * pSource,
+                         uint32_t start,
+                         uint32_t length,
+                         void * pDestination,
+                         const uint32_t * pIndices );
+/*-----------------------------------------------------------*/
+
+void * Defender_RadixSort( void * pList,
+                           void * pScratch,
+                           uint32_t count,
+                           uint32_t keyWidth,
+                           DefenderRadixDigits_t getDigits,
+                           DefenderRadixMove_t move )
+{
+    uint32_t offsets[ SORT_RADIX ];
+    uint32_t indices[ SORT_BLOCK_SIZE ];
+    uint8_t digits[ SORT_BLOCK_SIZE ];
+    void * pSource = pList, * pDestination = pScratch, * pSwap = NULL;
+    uint32_t i = 0U, start = 0U, length = 0U, pass = 0U, total = 0U, digitCount = 0U;
+
+    assert( pList != NULL );
+    assert( pScratch != NULL );
+    assert( getDigits != NULL );
+    assert( move != NULL );
+
+    for( pass = 0U; ( pass < keyWidth ) && ( count > 1U ); pass++ )
+    {
+        ( void ) memset( offsets, 0, sizeof( offsets ) );
+
+        for( start = 0U; start < count; start += length )
+        {
+            length = ( ( count - start ) < SORT_BLOCK_SIZE ) ? ( count - start ) : SORT_BLOCK_SIZE;
+            getDigits( pSource, start, length, pass, digits );
+
+            for( i = 0U; i < length; i++ )
+            {
+                offsets[ digits[ i ] ]++;
+            }
+        }
+
+        /* A pass over a byte which is the same for all values would not
+         * change the order. */
+        getDigits( pSource, 0U, 1U, pass, digits );
+
+        if( offsets[ digits[ 0 ] ] != count )
+        {
+            total = 0U;
+
+            for( i = 0U; i < SORT_RADIX; i++ )
+            {
+                digitCount = offsets[ i ];
+                offsets[ i ] = total;
+                total += digitCount;
+            }
+
+            for( start = 0U; start < count; start += length )
+            {
+                length = ( ( count - start ) < SORT_BLOCK_SIZE ) ? ( count - start ) : SORT_BLOCK_SIZE;
+                getDigits( pSource, start, length, pass, digits );
+
+                for( i = 0U; i < length; i++ )
+                {
+                    indices[ i ] = offsets[ digits[ i ] ];
+                    offsets[ digits[ i ] ]++;
+                }
+
+                move( pSource, start, length, pDestination, indices );
+            }
+
+            pSwap = pSource;
+            pSource = pDestination;
+            pDestination = pSwap;
+        }
+    }
+
+    return pSource;
+}
+/*-----------------------------------------------------------*/
+
+static void getPortDigits( const void * pList,
+                           uint32_t start,
+                           uint32_t length,
+                           uint32_t pass,
+                           uint8_t * pDigits )
+{
+    const uint16_t * pPorts = ( const uint16_t * ) pList;
+    uint32_t i = 0U;
+
+    for( i = 0U; i < length; i++ )
+    {
+        pDigits[ i ] = ( uint8_t ) ( ( ( uint32_t ) pPorts[ start + i ] >> ( pass * 8U ) ) & 0xFFU );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void movePorts( const void * pSource,
+                       uint32_t start,
+                       uint32_t length,
+                       void * pDestination,
+                       const uint32_t * pIndices )
+{
+    const uint16_t * pFrom = &( ( ( const uint16_t * ) pSource )[ start ] );
+    uint16_t * pTo = ( uint16_t * ) pDestination;
+    uint32_t i = 0U;
+
+    for( i = 0U; i < length; i++ )
+    {
+        pTo[ pIndices[ i ] ] = pFrom[ i ];
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void getAddressDigits( const void * pList,
+                              uint32_t start,
+                              uint32_t length,
+                              uint32_t pass,
+                              uint8_t * pDigits )
+{
+    const uint32_t * pAddresses = ( const uint32_t * ) pList;
+    uint32_t i = 0U;
+
+    for( i = 0U; i < length; i++ )
+    {
+        pDigits[ i ] = ( uint8_t ) ( ( pAddresses[ start + i ] >> ( pass * 8U ) ) & 0xFFU );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void moveAddresses( const void * pSource,
+                           uint32_t start,
+                           uint32_t length,
+                           void * pDestination,
+                           const uint32_t * pIndices )
+{
+    const uint32_t * pFrom = &( ( ( const uint32_t * ) pSource )[ start ] );
+    uint32_t * pTo = ( uint32_t * ) pDestination;
+    uint32_t i = 0U;
+
+    for( i = 0U; i < length; i++ )
+    {
+        pTo[ pIndices[ i ] ] = pFrom[ i ];
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void getNumberDigits( const void * pList,
+                             uint32_t start,
+                             uint32_t length,
+                             uint32_t pass,
+                             uint8_t * pDigits )
+{
+    const uint64_t * pNumbers = ( const uint64_t * ) pList;
+    uint32_t i = 0U;
+
+    for( i = 0U; i < length; i++ )
+    {
+        pDigits[ i ] = ( uint8_t ) ( ( pNumbers[ start + i ] >> ( pass * 8U ) ) & 0xFFU );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void moveNumbers( const void * pSource,
+                         uint32_t start,
+                         uint32_t length,
+                         void * pDestination,
+                         const uint32_t * pIndices )
+{
+    const uint64_t * pFrom = &( ( ( const uint64_t * ) pSource )[ start ] );
+    uint64_t * pTo = ( uint64_t * ) pDestination;
+    uint32_t i = 0U;
+
+    for( i = 0U; i < length; i++ )
+    {
+        pTo[ pIndices[ i ] ] = pFrom[ i ];
+    }
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_SortPorts( uint16_t * pPorts,
+                                     uint16_t * pScratch,
+                                     uint32_t count )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    const void * pSorted = NULL;
+
+    if( ( pPorts == NULL ) || ( pScratch == NULL ) || ( pPorts == pScratch ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pPorts: %p, pScratch: %p.",
+                    ( void * ) pPorts,
+                    ( void * ) pScratch ) );
+    }
+    else
+    {
+        pSorted = Defender_RadixSort( pPorts, pScratch, count, 2U, getPortDigits, movePorts );
+
+        if( pSorted != pPorts )
+        {
+            ( void ) memcpy( pPorts, pSorted, count * sizeof( uint16_t ) );
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_SortAddresses( uint32_t * pAddresses,
+                                         uint32_t * pScratch,
+                                         uint32_t count )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    const void * pSorted = NULL;
+
+    if( ( pAddresses == NULL ) || ( pScratch == NULL ) || ( pAddresses == pScratch ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pAddresses: %p, pScratch: %p.",
+                    ( void * ) pAddresses,
+                    ( void * ) pScratch ) );
+    }
+    else
+    {
+        pSorted = Defender_RadixSort( pAddresses, pScratch, count, 4U, getAddressDigits, moveAddresses );
+
+        if( pSorted != pAddresses )
+        {
+            ( void ) memcpy( pAddresses, pSorted, count * sizeof( uint32_t ) );
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_SortNumbers( uint64_t * pNumbers,
+                                       uint64_t * pScratch,
+                                       uint32_t count )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    const void * pSorted = NULL;
+
+    if( ( pNumbers == NULL ) || ( pScratch == NULL ) || ( pNumbers == pScratch ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pNumbers: %p, pScratch: %p.",
+                    ( void * ) pNumbers,
+                    ( void * ) pScratch ) );
+    }
+    else
+    {
+        pSorted = Defender_RadixSort( pNumbers, pScratch, count, 8U, getNumberDigits, moveNumbers );
+
+        if( pSorted != pNumbers )
+        {
+            ( void ) memcpy( pNumbers, pSorted, count * sizeof( uint64_t ) );
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,712 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_thing_store.c
+ * @brief Implementation of the thing store.
+ */
+
+/* Standard includes. */
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Thing store include. */
+#include "defender_thing_store.h"
+
+/**
+ * @brief Offset basis and prime of the 32-bit FNV-1a hash of thing names.
+ */
+#define THING_STORE_FNV_OFFSET    2166136261U
+#define THING_STORE_FNV_PRIME     16777619U
+
+/**
+ * @brief Multiplier which spreads the bits of a name hash before it is
+ * reduced to a slot.
+ */
+#define THING_STORE_MULTIPLIER    0x9E3779B1U
+
+/**
+ * @brief Thing ID of the end of the list of free entries.
+ */
+#define THING_STORE_NO_ID         UINT32_MAX
+
+/**
+ * @brief Most digits of the number of a dense name, so that it fits in 32
+ * bits.
+ */
+#define THING_STORE_MAX_DIGITS    9U
+
+/**
+ * @brief Where a thing name is, or would be, in the store.
+ */
+typedef struct ThingLookup
+{
+    uint8_t dense;  /**< @brief Whether the name is in the dense array. */
+    uint32_t index; /**< @brief Index in the dense array, or slot. */
+    uint32_t hash;  /**< @brief Hash of the name, if it is not dense. */
+} ThingLookup_t;
+
+/**
+ * @brief Hash a thing name.
+ *
+ * @param[in] pThingName The thing name.
+ * @param[in] thingNameLength The length of the thing name.
+ *
+ * @return The hash.
+ */
+static uint32_t hashName( const char * pThingName,
+                          uint16_t thingNameLength );
+
+/**
+ * @brief Get the home slot of a name hash.
+ *
+ * @param[in] hash The hash.
+ * @param[in] slotCount The number of slots.
+ *
+ * @return The slot.
+ */
+static uint32_t getHomeSlot( uint32_t hash,
+                             uint32_t slotCount );
+
+/**
+ * @brief Find the slot of a thing name, or the empty slot where it would be
+ * inserted.
+ *
+ * @param[in] pStore The thing store.
+ * @param[in] pThingName The thing name.
+ * @param[in] thingNameLength The length of the thing name.
+ * @param[in] hash The hash of the thing name.
+ * @param[out] pSlot The slot.
+ *
+ * @return 1 if the thing is in the store; 0 otherwise.
+ */
+static uint8_t findSlot( const DefenderThingStore_t * pStore,
+                         const char * pThingName,
+                         uint16_t thingNameLength,
+                         uint32_t hash,
+                         uint32_t * pSlot );
+
+/**
+ * @brief Empty a slot, and move the slots after it back so that every name
+ * can still be reached from its home slot.
+ *
+ * @param[in] pStore The thing store.
+ * @param[in] slot The slot to empty.
+ */
+static void clearSlot( DefenderThingStore_t * pStore,
+                       uint32_t slot );
+
+/**
+ * @brief Parse the number of a name made of the dense prefix and digits.
+ *
+ * @param[in] pStore The thing store.
+ * @param[in] pThingName The thing name.
+ * @param[in] thingNameLength The length of the thing name.
+ * @param[out] pIndex The index of the name in the dense array.
+ *
+ * @return 1 if the name is in the dense array; 0 otherwise.
+ */
+static uint8_t getDenseIndex( const DefenderThingStore_t * pStore,
+                              const char * pThingName,
+                              uint16_t thingNameLength,
+                              uint32_t * pIndex );
+
+/**
+ * @brief Find a thing name in the dense array or in the hash index.
+ *
+ * @param[in] pStore The thing store.
+ * @param[in] pThingName The thing name.
+ * @param[in] thingNameLength The length of the thing name.
+ * @param[out] pLookup Where the name is, or would be inserted.
+ * @param[out] pThingId The ID of the thing, if it is found.
+ *
+ * @return 1 if the thing is in the store; 0 otherwise.
+ */
+static uint8_t lookupName( const DefenderThingStore_t * pStore,
+                           const char * pThingName,
+                           uint16_t thingNameLength,
+                           ThingLookup_t * pLookup,
+                           uint32_t * pThingId );
+
+/**
+ * @brief Take a free thing ID, and fill its entries for a new thing.
+ *
+ * @param[in] pStore The thing store, which is not full.
+ * @param[in] pThingName The thing name.
+ * @param[in] thingNameLength The length of the thing name.
+ *
+ * @return The thing ID.
+ */
+static uint32_t takeId( DefenderThingStore_t * pStore,
+                        const char * pThingName,
+                        uint16_t thingNameLength );
+
+/**
+ * @brief Check the parameters shared by the functions of the store.
+ *
+ * @param[in] pStore The thing store.
+ *
+ * @return 1 if the store is initialized; 0 otherwise.
+ */
+static uint8_t isValidStore( const DefenderThingStore_t * pStore );
+
+/**
+ * @brief Check whether a thing ID belongs to a thing in the store.
+ *
+ * @param[in] pStore The thing store.
+ * @param[in] thingId The thing ID.
+ *
+ * @return 1 if the thing is in the store; 0 otherwise.
+ */
+static uint8_t isUsedId( const DefenderThingStore_t * pStore,
+                         uint32_t thingId );
+
+/*-----------------------------------------------------------*/
+
+static uint32_t hashName( const char * pThingName,
+                          uint16_t thingNameLength )
+{
+    uint32_t hash = THING_STORE_FNV_OFFSET;
+    uint16_t i;
+
+    for( i = 0U; i < thingNameLength; i++ )
+    {
+        hash = ( hash ^ ( uint8_t ) pThingName[ i ] ) * THING_STORE_FNV_PRIME;
+    }
+
+    return hash;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t getHomeSlot( uint32_t hash,
+                             uint32_t slotCount )
+{
+    uint32_t mixed = hash * THING_STORE_MULTIPLIER;
+
+    /* Take the high bits of the product, which depend on all bits of the
+     * hash, scaled to the number of slots. */
+    return ( uint32_t ) ( ( ( uint64_t ) mixed * slotCount ) >> 32 );
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t findSlot( const DefenderThingStore_t * pStore,
+                         const char * pThingName,
+                         uint16_t thingNameLength,
+                         uint32_t hash,
+                         uint32_t * pSlot )
+{
+    uint32_t slotMask = pStore->slotCount - 1U;
+    uint32_t slot = getHomeSlot( hash, pStore->slotCount );
+    const DefenderThingCold_t * pCold;
+    uint8_t found = 0U;
+
+    /* There are more slots than things, so the search ends at an empty slot
+     * if the thing is not found. Only names with the same hash are read. */
+    while( ( found == 0U ) && ( pStore->pSlots[ slot ] != 0U ) )
+    {
+        if( ( uint32_t ) ( pStore->pSlots[ slot ] >> 32 ) == hash )
+        {
+            pCold = &( pStore->pCold[ ( uint32_t ) pStore->pSlots[ slot ] - 1U ] );
+            found = ( ( pCold->thingNameLength == thingNameLength ) &&
+                      ( memcmp( pCold->thingName, pThingName, thingNameLength ) == 0 ) ) ? 1U : 0U;
+        }
+
+        if( found == 0U )
+        {
+            slot = ( slot + 1U ) & slotMask;
+        }
+    }
+
+    *pSlot = slot;
+
+    return found;
+}
+/*-----------------------------------------------------------*/
+
+static void clearSlot( DefenderThingStore_t * pStore,
+                       uint32_t slot )
+{
+    uint32_t slotMask = pStore->slotCount - 1U;
+    uint32_t hole = slot, next = ( slot + 1U ) & slotMask, home;
+
+    while( pStore->pSlots[ next ] != 0U )
+    {
+        home = getHomeSlot( ( uint32_t ) ( pStore->pSlots[ next ] >> 32 ), pStore->slotCount );
+
+        /* The name in the next slot can fill the hole unless its home slot
+         * lies after the hole, up to the next slot. */
+        if( ( ( next - home ) & slotMask ) >= ( ( next - hole ) & slotMask ) )
+        {
+            pStore->pSlots[ hole ] = pStore->pSlots[ next ];
+            hole = next;
+        }
+
+        next = ( next + 1U ) & slotMask;
+    }
+
+    pStore->pSlots[ hole ] = 0U;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t getDenseIndex( const DefenderThingStore_t * pStore,
+                              const char * pThingName,
+                              uint16_t thingNameLength,
+                              uint32_t * pIndex )
+{
+    uint32_t index = 0U;
+    uint16_t i;
+    uint8_t dense = ( ( pStore->pDenseIds != NULL ) &&
+                      ( thingNameLength == ( pStore->densePrefixLength + pStore->denseDigitCount ) ) &&
+                      ( memcmp( pThingName, pStore->pDensePrefix, pStore->densePrefixLength ) == 0 ) ) ? 1U : 0U;
+
+    for( i = pStore->densePrefixLength; ( dense == 1U ) && ( i < thingNameLength ); i++ )
+    {
+        if( ( pThingName[ i ] >= '0' ) && ( pThingName[ i ] <= '9' ) )
+        {
+            index = ( index * 10U ) + ( uint32_t ) ( ( uint8_t ) pThingName[ i ] - ( uint8_t ) '0' );
+        }
+        else
+        {
+            dense = 0U;
+        }
+    }
+
+    *pIndex = index;
+
+    return ( ( dense == 1U ) && ( index < pStore->denseCount ) ) ? 1U : 0U;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t lookupName( const DefenderThingStore_t * pStore,
+                           const char * pThingName,
+                           uint16_t thingNameLength,
+                           ThingLookup_t * pLookup,
+                           uint32_t * pThingId )
+{
+    uint8_t found;
+
+    pLookup->dense = getDenseIndex( pStore, pThingName, thingNameLength, &( pLookup->index ) );
+    pLookup->hash = 0U;
+
+    if( pLookup->dense == 1U )
+    {
+        /* The number gives the entry, so no name is compared. */
+        found = ( pStore->pDenseIds[ pLookup->index ] != 0U ) ? 1U : 0U;
+        *pThingId = pStore->pDenseIds[ pLookup->index ] - 1U;
+    }
+    else
+    {
+        pLookup->hash = hashName( pThingName, thingNameLength );
+        found = findSlot( pStore, pThingName, thingNameLength, pLookup->hash, &( pLookup->index ) );
+        *pThingId = ( uint32_t ) pStore->pSlots[ pLookup->index ] - 1U;
+    }
+
+    return found;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t takeId( DefenderThingStore_t * pStore,
+                        const char * pThingName,
+                        uint16_t thingNameLength )
+{
+    uint32_t thingId;
+
+    assert( pStore->count < pStore->capacity );
+
+    /* Reuse the ID of a removed thing before taking a new one. */
+    if( pStore->freeId != THING_STORE_NO_ID )
+    {
+        thingId = pStore->freeId;
+        pStore->freeId = pStore->pHot[ thingId ].thingId;
+    }
+    else
+    {
+        thingId = pStore->idCount;
+        pStore->idCount++;
+    }
+
+    pStore->pHot[ thingId ].deadline = 0U;
+    pStore->pHot[ thingId ].thingId = thingId;
+    pStore->pHot[ thingId ].flags = DEFENDER_THING_FLAG_USED;
+    pStore->pCold[ thingId ].reportId = 0U;
+    pStore->pCold[ thingId ].reportHash = 0U;
+    pStore->pCold[ thingId ].thingNameLength = thingNameLength;
+    ( void ) memcpy( pStore->pCold[ thingId ].thingName, pThingName, thingNameLength );
+    pStore->count++;
+
+    return thingId;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t isValidStore( const DefenderThingStore_t * pStore )
+{
+    return ( ( pStore != NULL ) &&
+             ( pStore->pHot != NULL ) &&
+             ( pStore->pCold != NULL ) &&
+             ( pStore->pSlots != NULL ) ) ? 1U : 0U;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t isUsedId( const DefenderThingStore_t * pStore,
+                         uint32_t thingId )
+{
+    return ( ( thingId < pStore->idCount ) &&
+             ( ( pStore->pHot[ thingId ].flags & DEFENDER_THING_FLAG_USED ) != 0U ) ) ? 1U : 0U;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_ThingStoreInit( DefenderThingStore_t * pStore,
+                                          DefenderThingHot_t * pHot,
+                                          DefenderThingCold_t * pCold,
+                                          uint32_t capacity,
+                                          uint64_t * pSlots,
+                                          uint32_t slotCount )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+
+    if( ( pStore == NULL ) ||
+        ( pHot == NULL ) ||
+        ( pCold == NULL ) ||
+        ( pSlots == NULL ) ||
+        ( slotCount <= capacity ) ||
+        ( ( slotCount & ( slotCount - 1U ) ) != 0U ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pStore: %p, pHot: %p, pCold: %p, capacity: %u, "
+                    "pSlots: %p, slotCount: %u.",
+                    ( void * ) pStore,
+                    ( void * ) pHot,
+                    ( void * ) pCold,
+                    ( unsigned int ) capacity,
+                    ( void * ) pSlots,
+                    ( unsigned int ) slotCount ) );
+    }
+    else
+    {
+        pStore->pHot = pHot;
+        pStore->pCold = pCold;
+        pStore->pSlots = pSlots;
+        pStore->capacity = capacity;
+        pStore->slotCount = slotCount;
+        pStore->count = 0U;
+        pStore->idCount = 0U;
+        pStore->freeId = THING_STORE_NO_ID;
+        pStore->pDensePrefix = NULL;
+        pStore->pDenseIds = NULL;
+        pStore->denseCount = 0U;
+        pStore->densePrefixLength = 0U;
+        pStore->denseDigitCount = 0U;
+        ( void ) memset( pSlots, 0, ( size_t ) slotCount * sizeof( uint64_t ) );
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_ThingStoreSetDense( DefenderThingStore_t * pStore,
+                                              const char * pPrefix,
+                                              uint16_t prefixLength,
+                                              uint16_t digitCount,
+                                              uint32_t * pDenseIds,
+                                              uint32_t denseCount )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+
+    if( ( isValidStore( pStore ) == 0U ) ||
+        ( pPrefix == NULL ) ||
+        ( digitCount == 0U ) ||
+        ( digitCount > THING_STORE_MAX_DIGITS ) ||
+        ( prefixLength > ( DEFENDER_THINGNAME_MAX_LENGTH - digitCount ) ) ||
+        ( pDenseIds == NULL ) ||
+        ( denseCount == 0U ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pStore: %p, pPrefix: %p, prefixLength: %u, digitCount: %u, "
+                    "pDenseIds: %p, denseCount: %u.",
+                    ( void * ) pStore,
+                    ( const void * ) pPrefix,
+                    ( unsigned int ) prefixLength,
+                    ( unsigned int ) digitCount,
+                    ( void * ) pDenseIds,
+                    ( unsigned int ) denseCount ) );
+    }
+    else if( pStore->count != 0U )
+    {
+        ret = DefenderError;
+
+        LogError( ( "The dense array can only be set on an empty store. count: %u.",
+                    ( unsigned int ) pStore->count ) );
+    }
+    else
+    {
+        pStore->pDensePrefix = pPrefix;
+        pStore->pDenseIds = pDenseIds;
+        pStore->denseCount = denseCount;
+        pStore->densePrefixLength = prefixLength;
+        pStore->denseDigitCount = digitCount;
+        ( void ) memset( pDenseIds, 0, ( size_t ) denseCount * sizeof( uint32_t ) );
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_ThingStoreAdd( DefenderThingStore_t * pStore,
+                                         const char * pThingName,
+                                         uint16_t thingNameLength,
+                                         uint32_t * pOutThingId )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    ThingLookup_t lookup;
+    uint32_t thingId = 0U;
+
+    if( ( isValidStore( pStore ) == 0U ) ||
+        ( pThingName == NULL ) ||
+        ( thingNameLength == 0U ) ||
+        ( thingNameLength > DEFENDER_THINGNAME_MAX_LENGTH ) ||
+        ( pOutThingId == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pStore: %p, pThingName: %p, thingNameLength: %u, pOutThingId: %p.",
+                    ( void * ) pStore,
+                    ( const void * ) pThingName,
+                    ( unsigned int ) thingNameLength,
+                    ( void * ) pOutThingId ) );
+    }
+    else if( lookupName( pStore, pThingName, thingNameLength, &( lookup ), &( thingId ) ) == 1U )
+    {
+        *pOutThingId = thingId;
+    }
+    else if( pStore->count == pStore->capacity )
+    {
+        ret = DefenderBufferTooSmall;
+
+        LogError( ( "The thing store is full. capacity: %u.",
+                    ( unsigned int ) pStore->capacity ) );
+    }
+    else
+    {
+        thingId = takeId( pStore, pThingName, thingNameLength );
+
+        if( lookup.dense == 1U )
+        {
+            pStore->pDenseIds[ lookup.index ] = thingId + 1U;
+        }
+        else
+        {
+            pStore->pSlots[ lookup.index ] = ( ( uint64_t ) lookup.hash << 32 ) | ( ( uint64_t ) thingId + 1U );
+        }
+
+        *pOutThingId = thingId;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_ThingStoreFind( const DefenderThingStore_t * pStore,
+                                          const char * pThingName,
+                                          uint16_t thingNameLength,
+                                          uint32_t * pOutThingId )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    ThingLookup_t lookup;
+    uint32_t thingId = 0U;
+
+    if( ( isValidStore( pStore ) == 0U ) || ( pThingName == NULL ) || ( pOutThingId == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pStore: %p, pThingName: %p, pOutThingId: %p.",
+                    ( const void * ) pStore,
+                    ( const void * ) pThingName,
+                    ( void * ) pOutThingId ) );
+    }
+    else if( lookupName( pStore, pThingName, thingNameLength, &( lookup ), &( thingId ) ) == 1U )
+    {
+        *pOutThingId = thingId;
+    }
+    else
+    {
+        ret = DefenderNoMatch;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_ThingStoreRemove( DefenderThingStore_t * pStore,
+                                            uint32_t thingId )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    const DefenderThingCold_t * pCold;
+    ThingLookup_t lookup;
+    uint32_t foundId = 0U;
+    uint8_t found;
+
+    if( isValidStore( pStore ) == 0U )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pStore: %p.", ( void * ) pStore ) );
+    }
+    else if( isUsedId( pStore, thingId ) == 0U )
+    {
+        ret = DefenderError;
+
+        LogError( ( "No thing has this ID. thingId: %u.", ( unsigned int ) thingId ) );
+    }
+    else
+    {
+        pCold = &( pStore->pCold[ thingId ] );
+        found = lookupName( pStore, pCold->thingName, pCold->thingNameLength, &( lookup ), &( foundId ) );
+        assert( ( found == 1U ) && ( foundId == thingId ) );
+        ( void ) found;
+        ( void ) foundId;
+
+        if( lookup.dense == 1U )
+        {
+            pStore->pDenseIds[ lookup.index ] = 0U;
+        }
+        else
+        {
+            clearSlot( pStore, lookup.index );
+        }
+
+        pStore->pHot[ thingId ].flags = 0U;
+        pStore->pHot[ thingId ].thingId = pStore->freeId;
+        pStore->freeId = thingId;
+        pStore->count--;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_ThingStoreNextDue( const DefenderThingStore_t * pStore,
+                                             uint64_t nowMs,
+                                             uint32_t startId,
+                                             uint32_t * pOutThingId )
+{
+    DefenderStatus_t ret = DefenderNoMatch;
+    const DefenderThingHot_t * pHot;
+    uint32_t thingId;
+
+    if( ( isValidStore( pStore ) == 0U ) || ( pOutThingId == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pStore: %p, pOutThingId: %p.",
+                    ( const void * ) pStore,
+                    ( void * ) pOutThingId ) );
+    }
+    else
+    {
+        for( thingId = startId; ( ret == DefenderNoMatch ) && ( thingId < pStore->idCount ); thingId++ )
+        {
+            pHot = &( pStore->pHot[ thingId ] );
+
+            /* A due thing is used and has no report in flight. */
+            if( ( pHot->flags == DEFENDER_THING_FLAG_USED ) && ( pHot->deadline <= nowMs ) )
+            {
+                *pOutThingId = thingId;
+                ret = DefenderSuccess;
+            }
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_ThingStoreBeginReport( DefenderThingStore_t * pStore,
+                                                 uint32_t thingId,
+                                                 uint64_t reportId,
+                                                 uint64_t reportHash )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+
+    if( isValidStore( pStore ) == 0U )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pStore: %p.", ( void * ) pStore ) );
+    }
+    else if( isUsedId( pStore, thingId ) == 0U )
+    {
+        ret = DefenderError;
+
+        LogError( ( "No thing has this ID. thingId: %u.", ( unsigned int ) thingId ) );
+    }
+    else
+    {
+        pStore->pHot[ thingId ].flags |= DEFENDER_THING_FLAG_IN_FLIGHT;
+        pStore->pCold[ thingId ].reportId = reportId;
+        pStore->pCold[ thingId ].reportHash = reportHash;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_ThingStoreEndReport( DefenderThingStore_t * pStore,
+                                               uint32_t thingId,
+                                               uint64_t reportId,
+                                               uint64_t nextDeadline )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+
+    if( isValidStore( pStore ) == 0U )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pStore: %p.", ( void * ) pStore ) );
+    }
+    else if( isUsedId( pStore, thingId ) == 0U )
+    {
+        ret = DefenderError;
+
+        LogError( ( "No thing has this ID. thingId: %u.", ( unsigned int ) thingId ) );
+    }
+    else if( ( ( pStore->pHot[ thingId ].flags & DEFENDER_THING_FLAG_IN_FLIGHT ) == 0U ) ||
+             ( pStore->pCold[ thingId ].reportId != reportId ) )
+    {
+        ret = DefenderNoMatch;
+
+        LogDebug( ( "The thing has no report in flight with this ID. thingId: %u.",
+                    ( unsigned int ) thingId ) );
+    }
+    else
+    {
+        pStore->pHot[ thingId ].flags &= ~DEFENDER_THING_FLAG_IN_FLIGHT;
+        pStore->pHot[ thingId ].deadline = nextDeadline;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
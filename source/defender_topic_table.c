@@ -0,0 +1,661 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_topic_table.c
+ * @brief Implementation of the precomputed Device Defender topic table.
+ */
+
+/* Standard includes. */
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Topic table include. */
+#include "defender_topic_table.h"
+
+/**
+ * @brief Magic bytes at the start of a topic table image.
+ */
+#define TOPIC_TABLE_MAGIC                 "DDTT"
+
+/**
+ * @brief Length of the magic bytes.
+ */
+#define TOPIC_TABLE_LENGTH_MAGIC          4U
+
+/**
+ * @brief Offsets of the header fields in a topic table image.
+ */
+#define TOPIC_TABLE_VERSION_OFFSET        4U
+#define TOPIC_TABLE_COUNT_OFFSET          8U
+#define TOPIC_TABLE_POOL_LENGTH_OFFSET    12U
+
+/**
+ * @brief Offsets of the fields in a topic table entry.
+ */
+#define TOPIC_TABLE_ENTRY_NAME_LENGTH_OFFSET    0U
+#define TOPIC_TABLE_ENTRY_TOPIC_OFFSET          4U
+
+/**
+ * @brief Length of all the topic strings of a thing, excluding the six copies
+ * of the thing name.
+ */
+#define TOPIC_TABLE_THING_OVERHEAD                       \
+    ( ( uint32_t ) DEFENDER_API_LENGTH_JSON_PUBLISH( 0U ) +  \
+      ( uint32_t ) DEFENDER_API_LENGTH_JSON_ACCEPTED( 0U ) + \
+      ( uint32_t ) DEFENDER_API_LENGTH_JSON_REJECTED( 0U ) + \
+      ( uint32_t ) DEFENDER_API_LENGTH_CBOR_PUBLISH( 0U ) +  \
+      ( uint32_t ) DEFENDER_API_LENGTH_CBOR_ACCEPTED( 0U ) + \
+      ( uint32_t ) DEFENDER_API_LENGTH_CBOR_REJECTED( 0U ) )
+
+/**
+ * @brief Read a little endian 16 bit value.
+ *
+ * @param[in] pBuffer Location of the value.
+ *
+ * @return The value.
+ */
+static uint16_t readUint16( const uint8_t * pBuffer );
+
+/**
+ * @brief Read a little endian 32 bit value.
+ *
+ * @param[in] pBuffer Location of the value.
+ *
+ * @return The value.
+ */
+static uint32_t readUint32( const uint8_t * pBuffer );
+
+/**
+ * @brief Write a little endian 16 bit value.
+ *
+ * @param[in] pBuffer Location to write the value to.
+ * @param[in] value The value.
+ */
+static void writeUint16( uint8_t * pBuffer,
+                         uint16_t value );
+
+/**
+ * @brief Write a little endian 32 bit value.
+ *
+ * @param[in] pBuffer Location to write the value to.
+ * @param[in] value The value.
+ */
+static void writeUint32( uint8_t * pBuffer,
+                         uint32_t value );
+
+/**
+ * @brief Get the topic length for a valid thing name length and defender API.
+ *
+ * @param[in] thingNameLength The length of the thing name.
+ * @param[in] api The defender API value.
+ *
+ * @return The topic length.
+ */
+static uint32_t getTopicLength( uint16_t thingNameLength,
+                                DefenderTopic_t api );
+
+/**
+ * @brief Compare two thing names.
+ *
+ * Bytes are compared as unsigned values. A name which is a prefix of another
+ * name is ordered first.
+ *
+ * @param[in] pName1 First thing name.
+ * @param[in] name1Length Length of the first thing name.
+ * @param[in] pName2 Second thing name.
+ * @param[in] name2Length Length of the second thing name.
+ *
+ * @return Negative, zero or positive if the first name is ordered before, same
+ * as or after the second name.
+ */
+static int32_t compareThingNames( const char * pName1,
+                                  uint16_t name1Length,
+                                  const char * pName2,
+                                  uint16_t name2Length );
+
+/**
+ * @brief Get a topic string of a table entry with bounds checks.
+ *
+ * @param[in] pTable The topic table.
+ * @param[in] index The index of the entry.
+ * @param[in] api The defender API value.
+ * @param[out] ppOutTopic The topic string.
+ * @param[out] pOutTopicLength The length of the topic string.
+ * @param[out] pOutThingNameLength The length of the thing name of the entry.
+ *
+ * @return #DefenderSuccess if the entry is valid; #DefenderError otherwise.
+ */
+static DefenderStatus_t getEntryTopic( const DefenderTopicTable_t * pTable,
+                                       uint32_t index,
+                                       DefenderTopic_t api,
+                                       const char ** ppOutTopic,
+                                       uint16_t * pOutTopicLength,
+                                       uint16_t * pOutThingNameLength );
+/*-----------------------------------------------------------*/
+
+static uint16_t readUint16( const uint8_t * pBuffer )
+{
+    assert( pBuffer != NULL );
+
+    return ( uint16_t ) ( ( uint16_t ) pBuffer[ 0 ] |
+                          ( uint16_t ) ( ( uint16_t ) pBuffer[ 1 ] << 8U ) );
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t readUint32( const uint8_t * pBuffer )
+{
+    assert( pBuffer != NULL );
+
+    return ( ( uint32_t ) pBuffer[ 0 ] ) |
+           ( ( uint32_t ) pBuffer[ 1 ] << 8U ) |
+           ( ( uint32_t ) pBuffer[ 2 ] << 16U ) |
+           ( ( uint32_t ) pBuffer[ 3 ] << 24U );
+}
+/*-----------------------------------------------------------*/
+
+static void writeUint16( uint8_t * pBuffer,
+                         uint16_t value )
+{
+    assert( pBuffer != NULL );
+
+    pBuffer[ 0 ] = ( uint8_t ) ( value & 0xFFU );
+    pBuffer[ 1 ] = ( uint8_t ) ( value >> 8U );
+}
+/*-----------------------------------------------------------*/
+
+static void writeUint32( uint8_t * pBuffer,
+                         uint32_t value )
+{
+    assert( pBuffer != NULL );
+
+    pBuffer[ 0 ] = ( uint8_t ) ( value & 0xFFU );
+    pBuffer[ 1 ] = ( uint8_t ) ( ( value >> 8U ) & 0xFFU );
+    pBuffer[ 2 ] = ( uint8_t ) ( ( value >> 16U ) & 0xFFU );
+    pBuffer[ 3 ] = ( uint8_t ) ( value >> 24U );
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t getTopicLength( uint16_t thingNameLength,
+                                DefenderTopic_t api )
+{
+    uint16_t topicLength = 0U;
+
+    assert( ( thingNameLength != 0U ) && ( thingNameLength <= DEFENDER_THINGNAME_MAX_LENGTH ) );
+    assert( ( api > DefenderInvalidTopic ) && ( api < DefenderMaxTopic ) );
+
+    /* The parameters are valid, so this call cannot fail. */
+    ( void ) Defender_GetTopicLength( thingNameLength, api, &( topicLength ) );
+
+    return ( uint32_t ) topicLength;
+}
+/*-----------------------------------------------------------*/
+
+static int32_t compareThingNames( const char * pName1,
+                                  uint16_t name1Length,
+                                  const char * pName2,
+                                  uint16_t name2Length )
+{
+    int32_t ret = 0;
+    uint16_t commonLength = ( name1Length < name2Length ) ? name1Length : name2Length;
+
+    assert( pName1 != NULL );
+    assert( pName2 != NULL );
+
+    /* memcmp compares bytes as unsigned char. */
+    ret = ( int32_t ) memcmp( ( const void * ) pName1,
+                              ( const void * ) pName2,
+                              ( size_t ) commonLength );
+
+    if( ret == 0 )
+    {
+        ret = ( int32_t ) name1Length - ( int32_t ) name2Length;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+static DefenderStatus_t getEntryTopic( const DefenderTopicTable_t * pTable,
+                                       uint32_t index,
+                                       DefenderTopic_t api,
+                                       const char ** ppOutTopic,
+                                       uint16_t * pOutTopicLength,
+                                       uint16_t * pOutThingNameLength )
+{
+    DefenderStatus_t ret = DefenderError;
+    const uint8_t * pEntry = NULL;
+    uint16_t thingNameLength = 0U;
+    uint32_t topicOffset = 0U, topicLength = 0U;
+
+    assert( pTable != NULL );
+    assert( index < pTable->thingCount );
+    assert( ( api > DefenderInvalidTopic ) && ( api < DefenderMaxTopic ) );
+
+    pEntry = &( pTable->pEntries[ index * DEFENDER_TOPIC_TABLE_ENTRY_LENGTH ] );
+    thingNameLength = readUint16( &( pEntry[ TOPIC_TABLE_ENTRY_NAME_LENGTH_OFFSET ] ) );
+    topicOffset = readUint32( &( pEntry[ TOPIC_TABLE_ENTRY_TOPIC_OFFSET +
+                                         ( 4U * ( uint32_t ) api ) ] ) );
+
+    if( ( thingNameLength != 0U ) && ( thingNameLength <= DEFENDER_THINGNAME_MAX_LENGTH ) )
+    {
+        topicLength = getTopicLength( thingNameLength, api );
+
+        if( ( topicOffset <= pTable->poolLength ) &&
+            ( topicLength <= ( pTable->poolLength - topicOffset ) ) )
+        {
+            /* The pool holds characters written by Defender_GetTopic. */
+            *ppOutTopic = ( const char * ) &( pTable->pPool[ topicOffset ] );
+            *pOutTopicLength = ( uint16_t ) topicLength;
+            *pOutThingNameLength = thingNameLength;
+            ret = DefenderSuccess;
+        }
+    }
+
+    if( ret != DefenderSuccess )
+    {
+        LogError( ( "Corrupt topic table entry. Index: %u.", ( unsigned int ) index ) );
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_TopicTableGetSize( const char * const * ppThingNames,
+                                             const uint16_t * pThingNameLengths,
+                                             uint32_t thingCount,
+                                             uint32_t * pOutLength )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    uint32_t i = 0U, thingLength = 0U, length = 0U;
+
+    if( ( ppThingNames == NULL ) ||
+        ( pThingNameLengths == NULL ) ||
+        ( pOutLength == NULL ) ||
+        ( thingCount > ( ( UINT32_MAX - DEFENDER_TOPIC_TABLE_HEADER_LENGTH ) /
+                         DEFENDER_TOPIC_TABLE_ENTRY_LENGTH ) ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. ppThingNames: %p, pThingNameLengths: %p, "
+                    "thingCount: %u, pOutLength: %p.",
+                    ( const void * ) ppThingNames,
+                    ( const void * ) pThingNameLengths,
+                    ( unsigned int ) thingCount,
+                    ( void * ) pOutLength ) );
+    }
+
+    if( ret == DefenderSuccess )
+    {
+        length = DEFENDER_TOPIC_TABLE_HEADER_LENGTH + ( thingCount * DEFENDER_TOPIC_TABLE_ENTRY_LENGTH );
+
+        for( i = 0U; i < thingCount; i++ )
+        {
+            if( ( ppThingNames[ i ] == NULL ) ||
+                ( pThingNameLengths[ i ] == 0U ) ||
+                ( pThingNameLengths[ i ] > DEFENDER_THINGNAME_MAX_LENGTH ) )
+            {
+                ret = DefenderBadParameter;
+
+                LogError( ( "Invalid thing name. Index: %u, pThingName: %p, thingNameLength: %u.",
+                            ( unsigned int ) i,
+                            ( const void * ) ppThingNames[ i ],
+                            ( unsigned int ) pThingNameLengths[ i ] ) );
+                break;
+            }
+
+            thingLength = TOPIC_TABLE_THING_OVERHEAD +
+                          ( ( uint32_t ) DefenderMaxTopic * ( uint32_t ) pThingNameLengths[ i ] );
+
+            if( thingLength > ( UINT32_MAX - length ) )
+            {
+                ret = DefenderBadParameter;
+
+                LogError( ( "The topic table for %u things does not fit in 32 bits.",
+                            ( unsigned int ) thingCount ) );
+                break;
+            }
+
+            length += thingLength;
+        }
+    }
+
+    if( ret == DefenderSuccess )
+    {
+        *pOutLength = length;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_TopicTableBuild( uint8_t * pBuffer,
+                                           uint32_t bufferLength,
+                                           const char * const * ppThingNames,
+                                           const uint16_t * pThingNameLengths,
+                                           uint32_t thingCount,
+                                           uint32_t * pOutLength )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    uint32_t i = 0U, j = 0U, tableLength = 0U, entriesLength = 0U;
+    uint32_t poolLength = 0U, poolOffset = 0U, remainingLength = 0U;
+    uint16_t topicLength = 0U;
+    uint8_t * pEntry = NULL;
+    char * pPool = NULL;
+
+    /* The following variable is to address MISRA Rule 7.4 violation of
+     * passing const char * for const void * param of memcpy. */
+    const char * pTopicTableMagic = TOPIC_TABLE_MAGIC;
+
+    if( ( pBuffer == NULL ) || ( pOutLength == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pBuffer: %p, pOutLength: %p.",
+                    ( void * ) pBuffer,
+                    ( void * ) pOutLength ) );
+    }
+
+    if( ret == DefenderSuccess )
+    {
+        ret = Defender_TopicTableGetSize( ppThingNames,
+                                          pThingNameLengths,
+                                          thingCount,
+                                          &( tableLength ) );
+    }
+
+    if( ret == DefenderSuccess )
+    {
+        for( i = 1U; i < thingCount; i++ )
+        {
+            if( compareThingNames( ppThingNames[ i - 1U ], pThingNameLengths[ i - 1U ],
+                                   ppThingNames[ i ], pThingNameLengths[ i ] ) >= 0 )
+            {
+                ret = DefenderBadParameter;
+
+                LogError( ( "Thing names are not sorted or not unique. Index: %u.",
+                            ( unsigned int ) i ) );
+                break;
+            }
+        }
+    }
+
+    if( ( ret == DefenderSuccess ) && ( bufferLength < tableLength ) )
+    {
+        ret = DefenderBufferTooSmall;
+
+        LogError( ( "The buffer is too small to hold the topic table. "
+                    "Provided buffer size: %u, Required buffer size: %u.",
+                    ( unsigned int ) bufferLength,
+                    ( unsigned int ) tableLength ) );
+    }
+
+    if( ret == DefenderSuccess )
+    {
+        entriesLength = thingCount * DEFENDER_TOPIC_TABLE_ENTRY_LENGTH;
+        poolLength = tableLength - DEFENDER_TOPIC_TABLE_HEADER_LENGTH - entriesLength;
+
+        ( void ) memcpy( ( void * ) pBuffer,
+                         ( const void * ) pTopicTableMagic,
+                         ( size_t ) TOPIC_TABLE_LENGTH_MAGIC );
+        writeUint32( &( pBuffer[ TOPIC_TABLE_VERSION_OFFSET ] ), DEFENDER_TOPIC_TABLE_VERSION );
+        writeUint32( &( pBuffer[ TOPIC_TABLE_COUNT_OFFSET ] ), thingCount );
+        writeUint32( &( pBuffer[ TOPIC_TABLE_POOL_LENGTH_OFFSET ] ), poolLength );
+
+        /* The pool holds characters only. */
+        pPool = ( char * ) &( pBuffer[ DEFENDER_TOPIC_TABLE_HEADER_LENGTH + entriesLength ] );
+
+        for( i = 0U; i < thingCount; i++ )
+        {
+            pEntry = &( pBuffer[ DEFENDER_TOPIC_TABLE_HEADER_LENGTH +
+                                 ( i * DEFENDER_TOPIC_TABLE_ENTRY_LENGTH ) ] );
+
+            writeUint16( &( pEntry[ TOPIC_TABLE_ENTRY_NAME_LENGTH_OFFSET ] ), pThingNameLengths[ i ] );
+            writeUint16( &( pEntry[ TOPIC_TABLE_ENTRY_NAME_LENGTH_OFFSET + 2U ] ), 0U );
+
+            for( j = 0U; j < ( uint32_t ) DefenderMaxTopic; j++ )
+            {
+                remainingLength = poolLength - poolOffset;
+
+                if( remainingLength > ( uint32_t ) UINT16_MAX )
+                {
+                    remainingLength = ( uint32_t ) UINT16_MAX;
+                }
+
+                /* The size calculated above guarantees that the topic fits, so
+                 * this call cannot fail. */
+                ( void ) Defender_GetTopic( &( pPool[ poolOffset ] ),
+                                            ( uint16_t ) remainingLength,
+                                            ppThingNames[ i ],
+                                            pThingNameLengths[ i ],
+                                            ( DefenderTopic_t ) j,
+                                            &( topicLength ) );
+
+                writeUint32( &( pEntry[ TOPIC_TABLE_ENTRY_TOPIC_OFFSET + ( 4U * j ) ] ),
+                             poolOffset );
+                poolOffset += topicLength;
+            }
+        }
+
+        *pOutLength = tableLength;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_TopicTableInit( DefenderTopicTable_t * pTable,
+                                          const uint8_t * pBuffer,
+                                          uint32_t bufferLength )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    uint32_t thingCount = 0U, poolLength = 0U, entriesLength = 0U;
+
+    /* The following variable is to address MISRA Rule 7.4 violation of
+     * passing const char * for const void * param of memcmp. */
+    const char * pTopicTableMagic = TOPIC_TABLE_MAGIC;
+
+    if( ( pTable == NULL ) ||
+        ( pBuffer == NULL ) ||
+        ( bufferLength < DEFENDER_TOPIC_TABLE_HEADER_LENGTH ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pTable: %p, pBuffer: %p, bufferLength: %u.",
+                    ( void * ) pTable,
+                    ( const void * ) pBuffer,
+                    ( unsigned int ) bufferLength ) );
+    }
+
+    if( ret == DefenderSuccess )
+    {
+        if( ( memcmp( ( const void * ) pBuffer,
+                      ( const void * ) pTopicTableMagic,
+                      ( size_t ) TOPIC_TABLE_LENGTH_MAGIC ) != 0 ) ||
+            ( readUint32( &( pBuffer[ TOPIC_TABLE_VERSION_OFFSET ] ) ) != DEFENDER_TOPIC_TABLE_VERSION ) )
+        {
+            ret = DefenderBadParameter;
+
+            LogError( ( "The buffer does not contain a version %u topic table.",
+                        ( unsigned int ) DEFENDER_TOPIC_TABLE_VERSION ) );
+        }
+    }
+
+    if( ret == DefenderSuccess )
+    {
+        thingCount = readUint32( &( pBuffer[ TOPIC_TABLE_COUNT_OFFSET ] ) );
+        poolLength = readUint32( &( pBuffer[ TOPIC_TABLE_POOL_LENGTH_OFFSET ] ) );
+
+        /* The entries and the pool must exactly fill the rest of the buffer. */
+        if( thingCount > ( ( bufferLength - DEFENDER_TOPIC_TABLE_HEADER_LENGTH ) /
+                           DEFENDER_TOPIC_TABLE_ENTRY_LENGTH ) )
+        {
+            ret = DefenderBadParameter;
+        }
+        else
+        {
+            entriesLength = thingCount * DEFENDER_TOPIC_TABLE_ENTRY_LENGTH;
+
+            if( poolLength != ( bufferLength - DEFENDER_TOPIC_TABLE_HEADER_LENGTH - entriesLength ) )
+            {
+                ret = DefenderBadParameter;
+            }
+        }
+
+        if( ret != DefenderSuccess )
+        {
+            LogError( ( "Topic table header does not match the buffer length. "
+                        "thingCount: %u, poolLength: %u, bufferLength: %u.",
+                        ( unsigned int ) thingCount,
+                        ( unsigned int ) poolLength,
+                        ( unsigned int ) bufferLength ) );
+        }
+    }
+
+    if( ret == DefenderSuccess )
+    {
+        pTable->pEntries = &( pBuffer[ DEFENDER_TOPIC_TABLE_HEADER_LENGTH ] );
+        pTable->pPool = &( pBuffer[ DEFENDER_TOPIC_TABLE_HEADER_LENGTH + entriesLength ] );
+        pTable->thingCount = thingCount;
+        pTable->poolLength = poolLength;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_TopicTableFind( const DefenderTopicTable_t * pTable,
+                                          const char * pThingName,
+                                          uint16_t thingNameLength,
+                                          uint32_t * pOutIndex )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    uint32_t low = 0U, high = 0U, middle = 0U;
+    const char * pTopic = NULL;
+    uint16_t topicLength = 0U, entryNameLength = 0U;
+    int32_t comparison = 0;
+
+    if( ( pTable == NULL ) ||
+        ( pThingName == NULL ) ||
+        ( thingNameLength == 0U ) || ( thingNameLength > DEFENDER_THINGNAME_MAX_LENGTH ) ||
+        ( pOutIndex == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pTable: %p, pThingName: %p, "
+                    "thingNameLength: %u, pOutIndex: %p.",
+                    ( const void * ) pTable,
+                    ( const void * ) pThingName,
+                    ( unsigned int ) thingNameLength,
+                    ( void * ) pOutIndex ) );
+    }
+
+    if( ret == DefenderSuccess )
+    {
+        ret = DefenderNoMatch;
+        high = pTable->thingCount;
+
+        /* Binary search over [low, high). */
+        while( low < high )
+        {
+            middle = low + ( ( high - low ) / 2U );
+
+            if( getEntryTopic( pTable,
+                               middle,
+                               DefenderJsonReportPublish,
+                               &( pTopic ),
+                               &( topicLength ),
+                               &( entryNameLength ) ) != DefenderSuccess )
+            {
+                ret = DefenderError;
+                break;
+            }
+
+            /* Thing name comes after the defender prefix. */
+            comparison = compareThingNames( &( pTopic[ DEFENDER_API_LENGTH_PREFIX ] ),
+                                            entryNameLength,
+                                            pThingName,
+                                            thingNameLength );
+
+            if( comparison == 0 )
+            {
+                *pOutIndex = middle;
+                ret = DefenderSuccess;
+                break;
+            }
+            else if( comparison < 0 )
+            {
+                low = middle + 1U;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_TopicTableGetTopic( const DefenderTopicTable_t * pTable,
+                                              uint32_t index,
+                                              DefenderTopic_t api,
+                                              const char ** ppOutTopic,
+                                              uint16_t * pOutTopicLength )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+    uint16_t thingNameLength = 0U;
+
+    if( ( pTable == NULL ) ||
+        ( index >= pTable->thingCount ) ||
+        ( api <= DefenderInvalidTopic ) || ( api >= DefenderMaxTopic ) ||
+        ( ppOutTopic == NULL ) ||
+        ( pOutTopicLength == NULL ) )
+    {
+        ret = DefenderBadParameter;
+
+        LogError( ( "Invalid input parameter. pTable: %p, index: %u, api: %d, "
+                    "ppOutTopic: %p, pOutTopicLength: %p.",
+                    ( const void * ) pTable,
+                    ( unsigned int ) index,
+                    api,
+                    ( void * ) ppOutTopic,
+                    ( void * ) pOutTopicLength ) );
+    }
+
+    if( ret == DefenderSuccess )
+    {
+        ret = getEntryTopic( pTable,
+                             index,
+                             api,
+                             ppOutTopic,
+                             pOutTopicLength,
+                             &( thingNameLength ) );
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
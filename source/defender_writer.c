@@ -0,0 +1,169 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_writer.c
+ * @brief Implementation of writing JSON reports into a buffer.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Writer include. */
+#include "defender_writer.h"
+
+/* Escape API include. */
+#include "defender_escape.h"
+
+/**
+ * @brief Number of digits of the largest 64-bit number.
+ */
+#define WRITER_MAX_DIGITS    20U
+
+/*-----------------------------------------------------------*/
+
+void Defender_WriterInit( DefenderWriter_t * pWriter,
+                          char * pBuffer,
+                          uint32_t bufferLength )
+{
+    pWriter->pBuffer = pBuffer;
+    pWriter->bufferLength = bufferLength;
+    pWriter->length = 0U;
+    pWriter->status = DefenderSuccess;
+}
+/*-----------------------------------------------------------*/
+
+void Defender_WriteBytes( DefenderWriter_t * pWriter,
+                          const char * pBytes,
+                          uint32_t length )
+{
+    if( pWriter->status == DefenderSuccess )
+    {
+        if( length <= ( pWriter->bufferLength - pWriter->length ) )
+        {
+            ( void ) memcpy( &( pWriter->pBuffer[ pWriter->length ] ), pBytes, length );
+            pWriter->length += length;
+        }
+        else
+        {
+            pWriter->status = DefenderBufferTooSmall;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+void Defender_WriteEscaped( DefenderWriter_t * pWriter,
+                            const char * pString,
+                            uint32_t length )
+{
+    uint32_t escapedLength = 0U;
+
+    if( pWriter->status == DefenderSuccess )
+    {
+        pWriter->status = Defender_EscapeString( pString,
+                                                 length,
+                                                 &( pWriter->pBuffer[ pWriter->length ] ),
+                                                 pWriter->bufferLength - pWriter->length,
+                                                 &( escapedLength ) );
+        pWriter->length += escapedLength;
+    }
+}
+/*-----------------------------------------------------------*/
+
+void Defender_WriteDecimal( DefenderWriter_t * pWriter,
+                            uint64_t value )
+{
+    char digits[ WRITER_MAX_DIGITS ];
+    uint32_t start = WRITER_MAX_DIGITS;
+    uint64_t remaining = value;
+
+    do
+    {
+        start--;
+        digits[ start ] = ( char ) ( '0' + ( char ) ( remaining % 10U ) );
+        remaining /= 10U;
+    } while( remaining > 0U );
+
+    Defender_WriteBytes( pWriter, &( digits[ start ] ), WRITER_MAX_DIGITS - start );
+}
+/*-----------------------------------------------------------*/
+
+void Defender_WriteIpv4Address( DefenderWriter_t * pWriter,
+                                uint32_t address )
+{
+    Defender_WriteDecimal( pWriter, address >> 24 );
+    Defender_WriteBytes( pWriter, ".", 1U );
+    Defender_WriteDecimal( pWriter, ( address >> 16 ) & 0xFFU );
+    Defender_WriteBytes( pWriter, ".", 1U );
+    Defender_WriteDecimal( pWriter, ( address >> 8 ) & 0xFFU );
+    Defender_WriteBytes( pWriter, ".", 1U );
+    Defender_WriteDecimal( pWriter, address & 0xFFU );
+}
+/*-----------------------------------------------------------*/
+
+DefenderStatus_t Defender_WriteObjectStart( DefenderWriter_t * pWriter,
+                                            uint8_t * pOutHasMembers )
+{
+    DefenderStatus_t ret = DefenderSuccess;
+
+    *pOutHasMembers = 0U;
+
+    if( pWriter->length == 0U )
+    {
+        Defender_WriteBytes( pWriter, "{", 1U );
+    }
+    else if( ( pWriter->length >= 2U ) &&
+             ( pWriter->pBuffer[ 0 ] == '{' ) &&
+             ( pWriter->pBuffer[ pWriter->length - 1U ] == '}' ) )
+    {
+        *pOutHasMembers = ( pWriter->length > 2U ) ? 1U : 0U;
+        pWriter->length--;
+    }
+    else
+    {
+        ret = DefenderBadParameter;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+void Defender_WriteObjectEnd( DefenderWriter_t * pWriter,
+                              uint32_t startLength )
+{
+    Defender_WriteBytes( pWriter, "}", 1U );
+
+    if( pWriter->status != DefenderSuccess )
+    {
+        pWriter->length = startLength;
+
+        /* Of the bytes before the object was opened, only the closing brace
+         * of a given object can have been overwritten. */
+        if( startLength > 0U )
+        {
+            pWriter->pBuffer[ startLength - 1U ] = '}';
+        }
+    }
+}
+/*-----------------------------------------------------------*/
@@ -727,6 +727,24 @@ DefenderStatus_t Defender_GetTopic( char * pBuffer,
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Get the length of the topic string for a Device Defender operation.
+ *
+ * @param[in] thingNameLength The length of the thing name.
+ * @param[in] api The desired Device Defender API.
+ * @param[out] pOutLength The length of the topic string.
+ *
+ * @return #DefenderSuccess if the length is calculated;
+ * #DefenderBadParameter if invalid parameters are passed.
+ */
+/* @[declare_defender_gettopiclength] */
+DefenderStatus_t Defender_GetTopicLength( uint16_t thingNameLength,
+                                          DefenderTopic_t api,
+                                          uint16_t * pOutLength );
+/* @[declare_defender_gettopiclength] */
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Check if the given topic is one of the Device Defender topics.
  *
@@ -794,6 +812,68 @@ DefenderStatus_t Defender_MatchTopic( const char * pTopic,
                                       uint16_t * pOutThingNameLength );
 /* @[declare_defender_matchtopic] */
 
+/**
+ * @brief Check if a received MQTT PUBLISH packet is on one of the Device
+ * Defender topics, before the packet is deserialized.
+ *
+ * The topic is read in place from the variable header of the packet, so
+ * packets on other topics can be dropped without copying them. The function
+ * outputs which API the topic is for and where the payload starts.
+ *
+ * @param[in] packetType The first byte of the fixed header of the packet,
+ * which holds the packet type and the QoS.
+ * @param[in] pVariableHeader The bytes after the remaining length of the
+ * fixed header: the topic length, the topic and, for QoS 1 and 2, the packet
+ * identifier.
+ * @param[in] length The number of bytes received at pVariableHeader.
+ * @param[out] pOutApi The defender topic API value.
+ * @param[out] ppOutThingName Optional parameter to output the beginning of the
+ *             thing name in the packet. Pass NULL if not needed.
+ * @param[out] pOutThingNameLength Optional parameter to output the length of
+ *             the thing name. Pass NULL if not needed.
+ * @param[out] pOutPayloadOffset The offset from pVariableHeader of the byte
+ * after the topic and the packet identifier. With MQTT 3.1.1 this is the
+ * payload; with MQTT 5 the properties come first.
+ *
+ * @return #DefenderSuccess if the topic is one of the defender topics;
+ * #DefenderBadParameter if invalid parameters are passed or the packet is not
+ * a PUBLISH packet;
+ * #DefenderError if the packet is malformed or shorter than its topic;
+ * #DefenderNoMatch if the topic is NOT one of the defender topics.
+ *
+ * <b>Example</b>
+ * @code{c}
+ *
+ * // packetType, pPacket and packetLength are the first byte of a received
+ * // PUBLISH packet and the bytes after its remaining length.
+ * status = Defender_MatchPublish( packetType,
+ *                                 pPacket,
+ *                                 packetLength,
+ *                                 &( api ),
+ *                                 NULL,
+ *                                 NULL,
+ *                                 &( payloadOffset ) );
+ *
+ * if( status == DefenderSuccess )
+ * {
+ *      // Parse the response at &( pPacket[ payloadOffset ] ).
+ * }
+ * else
+ * {
+ *      // Not a Device Defender topic: pass the packet to the MQTT library.
+ * }
+ * @endcode
+ */
+/* @[declare_defender_matchpublish] */
+DefenderStatus_t Defender_MatchPublish( uint8_t packetType,
+                                        const uint8_t * pVariableHeader,
+                                        uint32_t length,
+                                        DefenderTopic_t * pOutApi,
+                                        const char ** ppOutThingName,
+                                        uint16_t * pOutThingNameLength,
+                                        uint32_t * pOutPayloadOffset );
+/* @[declare_defender_matchpublish] */
+
 /*-----------------------------------------------------------*/
 
 /* *INDENT-OFF* */
@@ -0,0 +1,345 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender.hpp
+ * @brief Header-only C++20 interface for the AWS IoT Device Defender Client
+ * Library.
+ *
+ * The topic builders are templated on the Device Defender API, so the format
+ * and suffix are chosen at compile time. Topics of thing names known at
+ * compile time are built entirely at compile time with #defender::topic.
+ * Topic matching wraps #Defender_MatchTopic and returns views into the
+ * provided topic, so nothing is copied.
+ *
+ * @code{cpp}
+ * // Topic built at compile time.
+ * constexpr std::string_view publishTopic =
+ *     defender::topic< DefenderJsonReportPublish, "MyThing" >.view();
+ *
+ * // Topic built at run time into a caller provided buffer.
+ * char buffer[ defender::maxTopicLength ];
+ * std::string_view acceptedTopic =
+ *     defender::getTopic< DefenderJsonReportAccepted >( buffer, thingName );
+ *
+ * // Matching an incoming topic.
+ * if( defender::TopicMatch match = defender::matchTopic( incomingTopic ) )
+ * {
+ *     // match.api and match.thingName are valid.
+ * }
+ * @endcode
+ */
+
+#ifndef DEFENDER_HPP_
+#define DEFENDER_HPP_
+
+/* Standard includes. */
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+/* Defender API include. */
+#include "defender.h"
+
+namespace defender
+{
+    /**
+     * @brief Length of the longest topic for the longest thing name.
+     */
+    inline constexpr std::size_t maxTopicLength = DEFENDER_API_MAX_LENGTH( DEFENDER_THINGNAME_MAX_LENGTH );
+
+    /**
+     * @brief Whether a value is one of the six Device Defender APIs.
+     */
+    constexpr bool isValidApi( DefenderTopic_t api ) noexcept
+    {
+        return ( api > DefenderInvalidTopic ) && ( api < DefenderMaxTopic );
+    }
+
+    /**
+     * @brief Whether a length is a valid thing name length.
+     */
+    constexpr bool isValidThingNameLength( std::size_t thingNameLength ) noexcept
+    {
+        return ( thingNameLength != 0U ) && ( thingNameLength <= DEFENDER_THINGNAME_MAX_LENGTH );
+    }
+
+    /**
+     * @cond DOXYGEN_IGNORE
+     * Doxygen should ignore this namespace as it is private.
+     */
+    namespace detail
+    {
+        inline constexpr std::string_view prefix { DEFENDER_API_PREFIX };
+        inline constexpr std::string_view bridge { DEFENDER_API_BRIDGE };
+
+        constexpr std::string_view format( DefenderTopic_t api ) noexcept
+        {
+            return ( api < DefenderCborReportPublish ) ?
+                   std::string_view { DEFENDER_API_JSON_FORMAT } :
+                   std::string_view { DEFENDER_API_CBOR_FORMAT };
+        }
+
+        constexpr std::string_view suffix( DefenderTopic_t api ) noexcept
+        {
+            std::string_view ret { DEFENDER_API_NULL_SUFFIX };
+
+            if( ( api == DefenderJsonReportAccepted ) || ( api == DefenderCborReportAccepted ) )
+            {
+                ret = DEFENDER_API_ACCEPTED_SUFFIX;
+            }
+            else if( ( api == DefenderJsonReportRejected ) || ( api == DefenderCborReportRejected ) )
+            {
+                ret = DEFENDER_API_REJECTED_SUFFIX;
+            }
+
+            return ret;
+        }
+
+        constexpr char * append( char * pOut,
+                                 std::string_view part ) noexcept
+        {
+            for( char c : part )
+            {
+                *pOut = c;
+                pOut++;
+            }
+
+            return pOut;
+        }
+
+        constexpr void write( char * pOut,
+                              DefenderTopic_t api,
+                              std::string_view thingName ) noexcept
+        {
+            pOut = append( pOut, prefix );
+            pOut = append( pOut, thingName );
+            pOut = append( pOut, bridge );
+            pOut = append( pOut, format( api ) );
+            ( void ) append( pOut, suffix( api ) );
+        }
+    }
+    /** @endcond */
+
+    /**
+     * @brief Length of the topic of an API for a thing name length.
+     *
+     * The API and thing name length must be valid.
+     */
+    constexpr std::size_t topicLength( DefenderTopic_t api,
+                                       std::size_t thingNameLength ) noexcept
+    {
+        return detail::prefix.size() + thingNameLength + detail::bridge.size() +
+               detail::format( api ).size() + detail::suffix( api ).size();
+    }
+
+    /**
+     * @brief A thing name that can be passed as a template argument.
+     *
+     * Constructed implicitly from a string literal.
+     */
+    template< std::size_t N >
+    struct ThingName
+    {
+        /**
+         * @brief The thing name, including the terminating NULL character.
+         */
+        char value[ N ] {};
+
+        /**
+         * @brief Copy a string literal.
+         */
+        consteval ThingName( const char ( &name )[ N ] ) noexcept
+        {
+            for( std::size_t i = 0U; i < N; i++ )
+            {
+                value[ i ] = name[ i ];
+            }
+        }
+
+        /**
+         * @brief The thing name without the terminating NULL character.
+         */
+        constexpr std::string_view view() const noexcept
+        {
+            return std::string_view { value, N - 1U };
+        }
+    };
+
+    /**
+     * @brief A topic string stored by value.
+     *
+     * The string is NULL terminated so that it can also be used as a C string.
+     * The terminator is not part of the length.
+     */
+    template< std::size_t Length >
+    struct Topic
+    {
+        /**
+         * @brief The topic string.
+         */
+        char value[ Length + 1U ] {};
+
+        /**
+         * @brief The topic string as a view.
+         */
+        constexpr std::string_view view() const noexcept
+        {
+            return std::string_view { value, Length };
+        }
+
+        /**
+         * @brief Pointer to the topic string, to pass to an MQTT client.
+         */
+        constexpr const char * data() const noexcept
+        {
+            return value;
+        }
+
+        /**
+         * @brief Length of the topic string, to pass to an MQTT client.
+         */
+        static constexpr std::uint16_t length = static_cast< std::uint16_t >( Length );
+    };
+
+    /**
+     * @brief Build a topic at compile time.
+     *
+     * @tparam Api The Device Defender API.
+     * @tparam Name The thing name, a string literal.
+     */
+    template< DefenderTopic_t Api, ThingName Name >
+    consteval auto makeTopic() noexcept
+    {
+        static_assert( isValidApi( Api ), "Invalid Device Defender API." );
+        static_assert( isValidThingNameLength( Name.view().size() ), "Invalid thing name length." );
+
+        Topic< topicLength( Api, Name.view().size() ) > ret;
+
+        detail::write( ret.value, Api, Name.view() );
+
+        return ret;
+    }
+
+    /**
+     * @brief A topic built at compile time.
+     *
+     * For example, `defender::topic< DefenderJsonReportPublish, "MyThing" >`
+     * holds `"$aws/things/MyThing/defender/metrics/json"`.
+     */
+    template< DefenderTopic_t Api, ThingName Name >
+    inline constexpr auto topic = makeTopic< Api, Name >();
+
+    /**
+     * @brief Build a topic at run time into a caller provided buffer.
+     *
+     * The format and suffix are chosen at compile time, so no API dispatch is
+     * done at run time. The topic is not NULL terminated.
+     *
+     * @tparam Api The Device Defender API.
+     * @param[in] buffer The buffer to write the topic to.
+     * @param[in] thingName The thing name.
+     *
+     * @return A view of the topic in the buffer, or an empty view if the thing
+     * name is invalid or the buffer is too small.
+     */
+    template< DefenderTopic_t Api >
+    constexpr std::string_view getTopic( std::span< char > buffer,
+                                         std::string_view thingName ) noexcept
+    {
+        static_assert( isValidApi( Api ), "Invalid Device Defender API." );
+
+        std::string_view ret {};
+
+        if( isValidThingNameLength( thingName.size() ) &&
+            ( buffer.size() >= topicLength( Api, thingName.size() ) ) )
+        {
+            detail::write( buffer.data(), Api, thingName );
+            ret = std::string_view { buffer.data(), topicLength( Api, thingName.size() ) };
+        }
+
+        return ret;
+    }
+
+    /**
+     * @brief Result of #defender::matchTopic.
+     *
+     * Converts to true if the topic is a Device Defender topic.
+     */
+    struct TopicMatch
+    {
+        /**
+         * @brief The matched API, or #DefenderInvalidTopic.
+         */
+        DefenderTopic_t api = DefenderInvalidTopic;
+
+        /**
+         * @brief View of the thing name within the matched topic.
+         */
+        std::string_view thingName {};
+
+        /**
+         * @brief Whether the topic matched.
+         */
+        constexpr explicit operator bool() const noexcept
+        {
+            return api != DefenderInvalidTopic;
+        }
+    };
+
+    /**
+     * @brief Check if a topic is a Device Defender topic.
+     *
+     * @param[in] topic The topic to match.
+     *
+     * @return The API and the thing name of the topic. The thing name is a
+     * view into the topic, so it is valid as long as the topic is.
+     */
+    inline TopicMatch matchTopic( std::string_view topic ) noexcept
+    {
+        TopicMatch ret {};
+        DefenderTopic_t api = DefenderInvalidTopic;
+        const char * pThingName = nullptr;
+        std::uint16_t thingNameLength = 0U;
+
+        /* Topics shorter than the shortest Device Defender topic are rejected
+         * without calling into the C library. */
+        if( ( topic.size() >= topicLength( DefenderJsonReportPublish, 1U ) ) &&
+            ( topic.size() <= UINT16_MAX ) &&
+            ( Defender_MatchTopic( topic.data(),
+                                   static_cast< std::uint16_t >( topic.size() ),
+                                   &api,
+                                   &pThingName,
+                                   &thingNameLength ) == DefenderSuccess ) )
+        {
+            ret.api = api;
+            ret.thingName = std::string_view { pThingName, thingNameLength };
+        }
+
+        return ret;
+    }
+}
+
+#endif /* DEFENDER_HPP_ */
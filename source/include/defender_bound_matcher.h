@@ -0,0 +1,177 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_bound_matcher.h
+ * @brief Interface for matching the Device Defender topics of one thing.
+ *
+ * A device knows its thing name, so only six topics can ever match. A bound
+ * matcher builds these six topics once with #Defender_GetTopic, and matches
+ * an incoming topic with a table probe and one memcmp, instead of matching
+ * the prefix, the thing name and the bridge again for every message:
+ *
+ * @code{c}
+ * char topics[ DEFENDER_BOUND_MATCHER_BUFFER_LENGTH( THING_NAME_LENGTH ) ];
+ *
+ * Defender_BoundMatcherInit( &matcher, topics, sizeof( topics ), THING_NAME, THING_NAME_LENGTH );
+ *
+ * // When a publish arrives:
+ * if( Defender_BoundMatcherMatch( &matcher, pTopic, topicLength, &api ) == DefenderSuccess )
+ * {
+ *     // Handle the response.
+ * }
+ * @endcode
+ *
+ * The table is indexed by the topic length, which tells a publish topic from
+ * a response topic, and by a key byte taken from the report format and from
+ * the suffix, which tells the topics of the same length apart.
+ */
+
+#ifndef DEFENDER_BOUND_MATCHER_H_
+#define DEFENDER_BOUND_MATCHER_H_
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* Defender API include. */
+#include "defender.h"
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+/**
+ * @ingroup defender_constants
+ * @brief Length of the buffer which holds the six topics of a thing.
+ *
+ * @param[in] thingNameLength Length of the thing name.
+ */
+#define DEFENDER_BOUND_MATCHER_BUFFER_LENGTH( thingNameLength )               \
+    ( DEFENDER_API_LENGTH_JSON_PUBLISH( ( uint32_t ) ( thingNameLength ) ) +  \
+      DEFENDER_API_LENGTH_JSON_ACCEPTED( ( uint32_t ) ( thingNameLength ) ) + \
+      DEFENDER_API_LENGTH_JSON_REJECTED( ( uint32_t ) ( thingNameLength ) ) + \
+      DEFENDER_API_LENGTH_CBOR_PUBLISH( ( uint32_t ) ( thingNameLength ) ) +  \
+      DEFENDER_API_LENGTH_CBOR_ACCEPTED( ( uint32_t ) ( thingNameLength ) ) + \
+      DEFENDER_API_LENGTH_CBOR_REJECTED( ( uint32_t ) ( thingNameLength ) ) )
+
+/**
+ * @ingroup defender_constants
+ * @brief Number of keys of each topic length in the table of a bound matcher.
+ */
+#define DEFENDER_BOUND_MATCHER_KEY_COUNT    16U
+
+/**
+ * @ingroup defender_struct_types
+ * @brief A bound matcher.
+ *
+ * @note The fields are set by #Defender_BoundMatcherInit. The topics are not
+ * owned by the matcher, and must stay valid as long as the matcher is used.
+ */
+typedef struct DefenderBoundMatcher
+{
+    const char * pTopics;                                  /**< @brief The six topics. */
+    uint16_t topicOffsets[ DefenderMaxTopic ];             /**< @brief Offset of each topic in pTopics. */
+    uint16_t topicLengths[ DefenderMaxTopic ];             /**< @brief Length of each topic. */
+    uint16_t publishLength;                                /**< @brief Length of the publish topics. */
+    uint16_t responseLength;                               /**< @brief Length of the response topics. */
+    uint8_t slots[ 2 ][ DEFENDER_BOUND_MATCHER_KEY_COUNT ]; /**< @brief The topic plus one for each length and key, or 0. */
+} DefenderBoundMatcher_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Build the topics of a thing and initialize a bound matcher.
+ *
+ * @param[out] pMatcher The bound matcher.
+ * @param[in] pBuffer The buffer to write the six topics into.
+ * @param[in] bufferLength The length of the buffer, at least
+ * #DEFENDER_BOUND_MATCHER_BUFFER_LENGTH for the thing name length.
+ * @param[in] pThingName The thing name.
+ * @param[in] thingNameLength The length of the thing name.
+ *
+ * @return #DefenderSuccess if the matcher is initialized;
+ * #DefenderBadParameter if invalid parameters are passed;
+ * #DefenderBufferTooSmall if the buffer cannot hold the topics.
+ */
+/* @[declare_defender_boundmatcherinit] */
+DefenderStatus_t Defender_BoundMatcherInit( DefenderBoundMatcher_t * pMatcher,
+                                            char * pBuffer,
+                                            uint32_t bufferLength,
+                                            const char * pThingName,
+                                            uint16_t thingNameLength );
+/* @[declare_defender_boundmatcherinit] */
+
+/**
+ * @brief Check if a topic is one of the Device Defender topics of the thing
+ * of a bound matcher.
+ *
+ * @param[in] pMatcher The bound matcher.
+ * @param[in] pTopic The topic string to check.
+ * @param[in] topicLength The length of the topic string.
+ * @param[out] pOutApi The Device Defender API the topic is for.
+ *
+ * @return #DefenderSuccess if the topic is one of the topics of the thing;
+ * #DefenderNoMatch if it is not (pOutApi gets #DefenderInvalidTopic);
+ * #DefenderBadParameter if invalid parameters are passed.
+ */
+/* @[declare_defender_boundmatchermatch] */
+DefenderStatus_t Defender_BoundMatcherMatch( const DefenderBoundMatcher_t * pMatcher,
+                                             const char * pTopic,
+                                             uint16_t topicLength,
+                                             DefenderTopic_t * pOutApi );
+/* @[declare_defender_boundmatchermatch] */
+
+/**
+ * @brief Get one of the topics of the thing of a bound matcher, for example
+ * to subscribe or to publish.
+ *
+ * The returned topic string points into the buffer of the matcher and is not
+ * NULL terminated.
+ *
+ * @param[in] pMatcher The bound matcher.
+ * @param[in] api The desired Device Defender API.
+ * @param[out] ppOutTopic The topic string.
+ * @param[out] pOutTopicLength The length of the topic string.
+ *
+ * @return #DefenderSuccess if the topic is returned;
+ * #DefenderBadParameter if invalid parameters are passed.
+ */
+/* @[declare_defender_boundmatchergettopic] */
+DefenderStatus_t Defender_BoundMatcherGetTopic( const DefenderBoundMatcher_t * pMatcher,
+                                                DefenderTopic_t api,
+                                                const char ** ppOutTopic,
+                                                uint16_t * pOutTopicLength );
+/* @[declare_defender_boundmatchergettopic] */
+
+/*-----------------------------------------------------------*/
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* DEFENDER_BOUND_MATCHER_H_ */
@@ -0,0 +1,118 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_bulk.h
+ * @brief Interface for generating Device Defender topics for many things.
+ *
+ * Bulk generation is split in two steps. #Defender_GetTopicOffsets computes
+ * where the topic of each thing starts in a single output buffer.
+ * #Defender_GetTopicRange then writes the topics of a range of things into
+ * their precomputed locations. Calls for disjoint ranges write disjoint parts
+ * of the buffer, so an application can hand ranges to as many threads as it
+ * likes without any synchronization apart from waiting for all of them to
+ * finish.
+ */
+
+#ifndef DEFENDER_BULK_H_
+#define DEFENDER_BULK_H_
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* Defender API include. */
+#include "defender.h"
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Calculate the location of the topic of each thing in a bulk buffer.
+ *
+ * Topics are placed back to back in the order of the things. On success,
+ * pOutOffsets[ i ] is the offset of the topic of thing i, and
+ * pOutOffsets[ thingCount ] is the total length of all topics.
+ *
+ * @param[in] pThingNameLengths Array of thing name lengths.
+ * @param[in] thingCount Number of entries in the above array.
+ * @param[in] api The desired Device Defender API.
+ * @param[out] pOutOffsets Array of thingCount + 1 offsets.
+ *
+ * @return #DefenderSuccess if the offsets are calculated;
+ * #DefenderBadParameter if invalid parameters are passed or the total length
+ * does not fit in 32 bits.
+ */
+/* @[declare_defender_gettopicoffsets] */
+DefenderStatus_t Defender_GetTopicOffsets( const uint16_t * pThingNameLengths,
+                                           uint32_t thingCount,
+                                           DefenderTopic_t api,
+                                           uint32_t * pOutOffsets );
+/* @[declare_defender_gettopicoffsets] */
+
+/**
+ * @brief Write the topics of a range of things into a bulk buffer.
+ *
+ * Writes the topics of things first to last - 1 at the offsets calculated by
+ * #Defender_GetTopicOffsets. Only the bytes from pOffsets[ first ] up to
+ * pOffsets[ last ] are written.
+ *
+ * @param[in] pBuffer The bulk buffer.
+ * @param[in] bufferLength The length of the bulk buffer.
+ * @param[in] pOffsets The offsets calculated by #Defender_GetTopicOffsets.
+ * @param[in] ppThingNames Array of thing names.
+ * @param[in] pThingNameLengths Array of thing name lengths.
+ * @param[in] first Index of the first thing to write.
+ * @param[in] last Index one past the last thing to write.
+ * @param[in] api The desired Device Defender API.
+ *
+ * @return #DefenderSuccess if the topics are written;
+ * #DefenderBadParameter if invalid parameters are passed or the offsets do not
+ * match the thing name lengths; #DefenderBufferTooSmall if the buffer cannot
+ * hold the topics of the range.
+ */
+/* @[declare_defender_gettopicrange] */
+DefenderStatus_t Defender_GetTopicRange( char * pBuffer,
+                                         uint32_t bufferLength,
+                                         const uint32_t * pOffsets,
+                                         const char * const * ppThingNames,
+                                         const uint16_t * pThingNameLengths,
+                                         uint32_t first,
+                                         uint32_t last,
+                                         DefenderTopic_t api );
+/* @[declare_defender_gettopicrange] */
+
+/*-----------------------------------------------------------*/
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* DEFENDER_BULK_H_ */
@@ -102,6 +102,59 @@
     #define DEFENDER_USE_LONG_KEYS    0
 #endif
 
+/**
+ * @brief Set it to 1 to compare the fixed parts of topics 8 bytes at a time.
+ *
+ * #Defender_MatchTopic runs on every incoming publish. With this macro set to
+ * 1, the "$aws/things/" prefix and the "/defender/metrics/" bridge are
+ * compared with a few 64-bit loads and XORs instead of a byte by byte
+ * comparison. The loads are done with memcpy, so the topic does not need to
+ * be aligned.
+ *
+ * <b>Default value</b>: 0 so that memcmp is used. Set it to 1 on targets
+ * where memcmp is slow.
+ */
+#ifndef DEFENDER_USE_WORD_COMPARE
+    #define DEFENDER_USE_WORD_COMPARE    0
+#endif
+
+/**
+ * @brief Set it to 1 to use SIMD instructions in #Defender_IndexStructurals
+ * and #Defender_EscapeString.
+ *
+ * AVX2 instructions are used when the compiler targets them, for example with
+ * the -mavx2 option of GCC, and NEON instructions are used on AArch64. On
+ * other targets, and when this macro is 0, bytes are classified with portable
+ * 64-bit word operations.
+ *
+ * <b>Default value</b>: 0 so that the library only uses standard C.
+ */
+#ifndef DEFENDER_USE_SIMD
+    #define DEFENDER_USE_SIMD    0
+#endif
+
+/**
+ * @brief Macro used by the metric segment to order its memory accesses with
+ * the accesses of other processes.
+ *
+ * The sequence locks of the records of a metric segment need a full memory
+ * barrier between writing the sequence number and writing the value, and
+ * between reading them. It must also stop the compiler from moving memory
+ * accesses across it.
+ *
+ * <b>Default value</b>: `__sync_synchronize()` with GCC and Clang. Other
+ * compilers must define this macro in the defender_config.h file to use
+ * #Defender_MetricSegmentWrite and #Defender_MetricSegmentSerialize from more
+ * than one thread or process.
+ */
+#ifndef DEFENDER_MEMORY_BARRIER
+    #if defined( __GNUC__ )
+        #define DEFENDER_MEMORY_BARRIER()    __sync_synchronize()
+    #else
+        #define DEFENDER_MEMORY_BARRIER()
+    #endif
+#endif
+
 /**
  * @brief Macro used in the Device Defender client library to log error messages.
  *
@@ -0,0 +1,237 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_connection_table.h
+ * @brief Interface for building the established connections of a report.
+ *
+ * A connection table keeps every field of the connections in a separate array
+ * (structure of arrays) instead of an array of connection structures:
+ *
+ *     pRemoteAddresses:  | addr 0 | addr 1 | addr 2 | ...
+ *     pRemotePorts:      | port 0 | port 1 | port 2 | ...
+ *     pLocalPorts:       | port 0 | port 1 | port 2 | ...
+ *     pInterfaceIds:     | id 0 | id 1 | id 2 | ...
+ *
+ * Filtering by local port then reads only the local ports, and removing
+ * duplicates compares whole arrays element by element. These loops work on
+ * blocks of connections and compile to SIMD instructions where the compiler
+ * supports them. The serializer reads the arrays directly.
+ *
+ * All memory is provided by the application. A typical use is:
+ *
+ * @code{c}
+ * Defender_ConnectionTableInit( &table, addresses, remotePorts, localPorts, interfaceIds, 64 );
+ * // For every connection read from the network stack:
+ * Defender_ConnectionTableAdd( &table, remoteAddress, remotePort, localPort, interfaceId );
+ * Defender_ConnectionTableFilterLocalPort( &table, 1, 49151 );
+ * Defender_ConnectionTableSort( &table, &scratchTable );
+ * Defender_ConnectionTableDedup( &table );
+ * Defender_ConnectionTableSerialize( &table, ppInterfaceNames, pInterfaceNameLengths, 2,
+ *                                    pBuffer, bufferLength, &length );
+ * @endcode
+ */
+
+#ifndef DEFENDER_CONNECTION_TABLE_H_
+#define DEFENDER_CONNECTION_TABLE_H_
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* Defender API include. */
+#include "defender.h"
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+/**
+ * @ingroup defender_struct_types
+ * @brief A table of established connections, one array per field.
+ *
+ * The arrays are provided by the application and have capacity entries each.
+ * The first count entries of every array hold the connections.
+ */
+typedef struct DefenderConnectionTable
+{
+    uint32_t * pRemoteAddresses; /**< @brief IPv4 remote addresses. a.b.c.d is stored as ( a << 24 ) | ( b << 16 ) | ( c << 8 ) | d. */
+    uint16_t * pRemotePorts;     /**< @brief Remote ports. */
+    uint16_t * pLocalPorts;      /**< @brief Local ports. */
+    uint8_t * pInterfaceIds;     /**< @brief Indexes of the local interfaces in the interface names passed to #Defender_ConnectionTableSerialize. */
+    uint32_t count;              /**< @brief Number of connections in the table. */
+    uint32_t capacity;           /**< @brief Number of entries in each array. */
+} DefenderConnectionTable_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Initialize an empty connection table.
+ *
+ * @param[out] pTable The connection table to initialize.
+ * @param[in] pRemoteAddresses Array for the remote addresses.
+ * @param[in] pRemotePorts Array for the remote ports.
+ * @param[in] pLocalPorts Array for the local ports.
+ * @param[in] pInterfaceIds Array for the interface indexes.
+ * @param[in] capacity Number of entries in each of the above arrays.
+ *
+ * @return #DefenderSuccess if the table is initialized;
+ * #DefenderBadParameter if invalid parameters are passed.
+ */
+/* @[declare_defender_connectiontableinit] */
+DefenderStatus_t Defender_ConnectionTableInit( DefenderConnectionTable_t * pTable,
+                                               uint32_t * pRemoteAddresses,
+                                               uint16_t * pRemotePorts,
+                                               uint16_t * pLocalPorts,
+                                               uint8_t * pInterfaceIds,
+                                               uint32_t capacity );
+/* @[declare_defender_connectiontableinit] */
+
+/**
+ * @brief Add a connection to the end of a connection table.
+ *
+ * @param[in] pTable The connection table.
+ * @param[in] remoteAddress The IPv4 remote address.
+ * @param[in] remotePort The remote port.
+ * @param[in] localPort The local port.
+ * @param[in] interfaceId The index of the local interface.
+ *
+ * @return #DefenderSuccess if the connection is added;
+ * #DefenderBadParameter if invalid parameters are passed;
+ * #DefenderBufferTooSmall if the table is full.
+ */
+/* @[declare_defender_connectiontableadd] */
+DefenderStatus_t Defender_ConnectionTableAdd( DefenderConnectionTable_t * pTable,
+                                              uint32_t remoteAddress,
+                                              uint16_t remotePort,
+                                              uint16_t localPort,
+                                              uint8_t interfaceId );
+/* @[declare_defender_connectiontableadd] */
+
+/**
+ * @brief Sort a connection table by remote address, then remote port, local
+ * port and interface.
+ *
+ * The table is sorted with a least significant digit radix sort over bytes,
+ * which takes a fixed number of passes over the arrays and never compares
+ * connections. Passes over bytes which are the same for all connections, such
+ * as the interface of a device with one interface, are skipped. The sort is
+ * stable and uses 1.3 KB of stack.
+ *
+ * @param[in] pTable The connection table.
+ * @param[in] pScratchTable A table whose arrays are used as scratch memory.
+ * Its capacity must be at least the count of pTable. Its contents are
+ * overwritten.
+ *
+ * @return #DefenderSuccess if the table is sorted;
+ * #DefenderBadParameter if invalid parameters are passed.
+ */
+/* @[declare_defender_connectiontablesort] */
+DefenderStatus_t Defender_ConnectionTableSort( DefenderConnectionTable_t * pTable,
+                                               DefenderConnectionTable_t * pScratchTable );
+/* @[declare_defender_connectiontablesort] */
+
+/**
+ * @brief Remove repeated connections from a sorted connection table.
+ *
+ * Only connections next to an equal connection are removed, so the table must
+ * be sorted with #Defender_ConnectionTableSort first.
+ *
+ * @param[in] pTable The connection table.
+ *
+ * @return #DefenderSuccess if the duplicates are removed;
+ * #DefenderBadParameter if invalid parameters are passed.
+ */
+/* @[declare_defender_connectiontablededup] */
+DefenderStatus_t Defender_ConnectionTableDedup( DefenderConnectionTable_t * pTable );
+/* @[declare_defender_connectiontablededup] */
+
+/**
+ * @brief Keep only the connections with a local port in a range.
+ *
+ * The order of the kept connections does not change.
+ *
+ * @param[in] pTable The connection table.
+ * @param[in] minLocalPort The lowest local port to keep.
+ * @param[in] maxLocalPort The highest local port to keep.
+ *
+ * @return #DefenderSuccess if the table is filtered;
+ * #DefenderBadParameter if invalid parameters are passed.
+ */
+/* @[declare_defender_connectiontablefilterlocalport] */
+DefenderStatus_t Defender_ConnectionTableFilterLocalPort( DefenderConnectionTable_t * pTable,
+                                                          uint16_t minLocalPort,
+                                                          uint16_t maxLocalPort );
+/* @[declare_defender_connectiontablefilterlocalport] */
+
+/**
+ * @brief Write the established connections object of a report.
+ *
+ * The output is the value of #DEFENDER_REPORT_ESTABLISHED_CONNECTIONS_KEY,
+ * with the key names selected by #DEFENDER_USE_LONG_KEYS. For example, with
+ * short keys:
+ *
+ * @code{.json}
+ * {"cs":[{"li":"eth0","lp":443,"rad":"10.0.0.1:8883"}],"t":1}
+ * @endcode
+ *
+ * The local interface is left out of connections whose interface index is
+ * not less than interfaceCount. Interface names are escaped with
+ * #Defender_EscapeString.
+ *
+ * @param[in] pTable The connection table.
+ * @param[in] ppInterfaceNames Array of interface names. Can be NULL if
+ * interfaceCount is 0.
+ * @param[in] pInterfaceNameLengths Array of interface name lengths. Can be
+ * NULL if interfaceCount is 0.
+ * @param[in] interfaceCount Number of entries in the above arrays.
+ * @param[in] pBuffer The buffer to write the object into.
+ * @param[in] bufferLength The length of the buffer.
+ * @param[out] pOutLength The length of the object.
+ *
+ * @return #DefenderSuccess if the object is written;
+ * #DefenderBadParameter if invalid parameters are passed;
+ * #DefenderBufferTooSmall if the buffer cannot hold the object;
+ * #DefenderError if an interface name which is written is not valid UTF-8.
+ */
+/* @[declare_defender_connectiontableserialize] */
+DefenderStatus_t Defender_ConnectionTableSerialize( const DefenderConnectionTable_t * pTable,
+                                                    const char * const * ppInterfaceNames,
+                                                    const uint16_t * pInterfaceNameLengths,
+                                                    uint8_t interfaceCount,
+                                                    char * pBuffer,
+                                                    uint32_t bufferLength,
+                                                    uint32_t * pOutLength );
+/* @[declare_defender_connectiontableserialize] */
+
+/*-----------------------------------------------------------*/
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* DEFENDER_CONNECTION_TABLE_H_ */
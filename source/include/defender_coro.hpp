@@ -0,0 +1,726 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_coro.hpp
+ * @brief Optional C++20 coroutine interface for publishing JSON reports and
+ * waiting for their accepted or rejected responses.
+ *
+ * A #defender::coro::ReportSession publishes reports of one thing through an
+ * application provided publisher, and resumes the waiting coroutine through an
+ * application provided executor when the response arrives:
+ *
+ * @code{cpp}
+ * defender::coro::Task<> reportLoop( std::allocator_arg_t,
+ *                                    FrameAllocator allocator,
+ *                                    Session & session )
+ * {
+ *     for( std::uint64_t reportId = 1U; ; reportId++ )
+ *     {
+ *         std::span< const char > report = buildReport( reportId );
+ *         defender::coro::ReportResult result = co_await session.publishReport( report, reportId );
+ *
+ *         if( result.reportStatus == DefenderReportRejected )
+ *         {
+ *             log( result.errorCode() );
+ *         }
+ *
+ *         co_await sleepFor( reportPeriod );
+ *     }
+ * }
+ *
+ * // The MQTT receive callback hands every message to the session.
+ * session.onMessage( topic, payload );
+ * @endcode
+ *
+ * The awaiter of a report lives in the frame of the waiting coroutine and is
+ * linked into the pending list of the session, so nothing is allocated per
+ * report other than the coroutine frame. Frames of #defender::coro::Task are
+ * allocated with the allocator passed after std::allocator_arg, if any.
+ *
+ * A session is not thread safe. All of its functions, and the executor, must
+ * run on the same thread.
+ */
+
+#ifndef DEFENDER_CORO_HPP_
+#define DEFENDER_CORO_HPP_
+
+/* Standard includes. */
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <new>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+/* Defender API includes. */
+#include "defender.hpp"
+#include "defender_response.h"
+
+namespace defender::coro
+{
+    /**
+     * @brief An executor resumes coroutines posted to it, later and on the
+     * thread that runs the session.
+     */
+    template< typename T >
+    concept Executor = requires( T & executor, std::coroutine_handle<> handle )
+    {
+        executor.post( handle );
+    };
+
+    /**
+     * @brief A publisher publishes an MQTT message and returns whether it was
+     * sent.
+     */
+    template< typename T >
+    concept Publisher = requires( T & publisher, std::string_view topic, std::span< const char > payload )
+    {
+        { publisher.publish( topic, payload ) } -> std::convertible_to< bool >;
+    };
+
+    /**
+     * @brief Maximum length of the error code kept in a #ReportResult.
+     *
+     * Error codes of the service are short names such as "InvalidJson". Longer
+     * error codes are truncated.
+     */
+    inline constexpr std::size_t errorCodeMaxLength = 32U;
+
+    /**
+     * @brief Result of publishing a report.
+     */
+    struct ReportResult
+    {
+        /**
+         * @brief #DefenderSuccess if a response was received, #DefenderError if
+         * the report could not be published or the session was cancelled.
+         */
+        DefenderStatus_t status = DefenderError;
+
+        /**
+         * @brief Whether the report was accepted or rejected.
+         */
+        DefenderReportStatus_t reportStatus = DefenderReportStatusUnknown;
+
+        /**
+         * @brief The time of the response in milliseconds, or 0.
+         */
+        std::uint64_t timestamp = 0U;
+
+        /**
+         * @brief Storage for the error code of a rejected report.
+         */
+        char errorCodeValue[ errorCodeMaxLength ] {};
+
+        /**
+         * @brief Length of the error code.
+         */
+        std::size_t errorCodeLength = 0U;
+
+        /**
+         * @brief The error code of a rejected report, or an empty view.
+         */
+        constexpr std::string_view errorCode() const noexcept
+        {
+            return std::string_view { errorCodeValue, errorCodeLength };
+        }
+    };
+
+    /**
+     * @cond DOXYGEN_IGNORE
+     * Doxygen should ignore this namespace as it is private.
+     */
+    namespace detail
+    {
+        /* Coroutine frames are followed by a trailer that records how to free
+         * them, so that operator delete works for every allocator:
+         *
+         *     +---------------+------------------+-----------+
+         *     |     Frame     | Deallocate func. | Allocator |
+         *     +---------------+------------------+-----------+
+         */
+        using FrameDeallocate = void ( * )( void * pFrame,
+                                            std::size_t frameSize ) noexcept;
+
+        constexpr std::size_t alignUp( std::size_t size,
+                                       std::size_t alignment ) noexcept
+        {
+            return ( size + alignment - 1U ) & ~( alignment - 1U );
+        }
+
+        template< typename Allocator >
+        struct FrameLayout
+        {
+            static constexpr std::size_t functionOffset( std::size_t frameSize ) noexcept
+            {
+                return alignUp( frameSize, alignof( FrameDeallocate ) );
+            }
+
+            static constexpr std::size_t allocatorOffset( std::size_t frameSize ) noexcept
+            {
+                return alignUp( functionOffset( frameSize ) + sizeof( FrameDeallocate ), alignof( Allocator ) );
+            }
+
+            static constexpr std::size_t units( std::size_t frameSize ) noexcept
+            {
+                return ( allocatorOffset( frameSize ) + sizeof( Allocator ) + sizeof( std::max_align_t ) - 1U ) /
+                       sizeof( std::max_align_t );
+            }
+        };
+
+        template< typename Allocator >
+        void deallocateFrame( void * pFrame,
+                              std::size_t frameSize ) noexcept
+        {
+            using Layout = FrameLayout< Allocator >;
+            std::byte * pBytes = static_cast< std::byte * >( pFrame );
+            Allocator * pAllocator = std::launder( reinterpret_cast< Allocator * >( pBytes + Layout::allocatorOffset( frameSize ) ) );
+            Allocator allocator( std::move( *pAllocator ) );
+
+            pAllocator->~Allocator();
+            std::allocator_traits< Allocator >::deallocate( allocator,
+                                                            static_cast< std::max_align_t * >( pFrame ),
+                                                            Layout::units( frameSize ) );
+        }
+
+        template< typename Allocator >
+        void * allocateFrame( std::size_t frameSize,
+                              const Allocator & allocator )
+        {
+            using Rebound = typename std::allocator_traits< Allocator >::template rebind_alloc< std::max_align_t >;
+            using Layout = FrameLayout< Rebound >;
+            Rebound rebound( allocator );
+            void * pFrame = std::allocator_traits< Rebound >::allocate( rebound, Layout::units( frameSize ) );
+            std::byte * pBytes = static_cast< std::byte * >( pFrame );
+
+            ::new( static_cast< void * >( pBytes + Layout::functionOffset( frameSize ) ) )
+            FrameDeallocate( &deallocateFrame< Rebound >);
+            ::new( static_cast< void * >( pBytes + Layout::allocatorOffset( frameSize ) ) )
+            Rebound( std::move( rebound ) );
+
+            return pFrame;
+        }
+
+        /* Promise operators which allocate frames with the allocator passed
+         * after std::allocator_arg, for free and member coroutines. */
+        struct FrameAllocation
+        {
+            static void * operator new( std::size_t frameSize )
+            {
+                return allocateFrame( frameSize, std::allocator< std::max_align_t > {} );
+            }
+
+            template< typename Allocator, typename ... Args >
+            static void * operator new( std::size_t frameSize,
+                                        std::allocator_arg_t,
+                                        const Allocator & allocator,
+                                        const Args & ... )
+            {
+                return allocateFrame( frameSize, allocator );
+            }
+
+            template< typename This, typename Allocator, typename ... Args >
+            static void * operator new( std::size_t frameSize,
+                                        const This &,
+                                        std::allocator_arg_t,
+                                        const Allocator & allocator,
+                                        const Args & ... )
+            {
+                return allocateFrame( frameSize, allocator );
+            }
+
+            static void operator delete( void * pFrame,
+                                         std::size_t frameSize ) noexcept
+            {
+                std::byte * pBytes = static_cast< std::byte * >( pFrame );
+                FrameDeallocate deallocate =
+                    *std::launder( reinterpret_cast< FrameDeallocate * >( pBytes + alignUp( frameSize, alignof( FrameDeallocate ) ) ) );
+
+                deallocate( pFrame, frameSize );
+            }
+        };
+
+        struct PromiseBase : FrameAllocation
+        {
+            std::coroutine_handle<> continuation {};
+            bool isDetached = false;
+
+            struct FinalAwaiter
+            {
+                bool await_ready() const noexcept
+                {
+                    return false;
+                }
+
+                template< typename Promise >
+                std::coroutine_handle<> await_suspend( std::coroutine_handle< Promise > handle ) noexcept
+                {
+                    std::coroutine_handle<> next = std::noop_coroutine();
+                    PromiseBase & promise = handle.promise();
+
+                    if( promise.continuation )
+                    {
+                        next = promise.continuation;
+                    }
+                    else if( promise.isDetached )
+                    {
+                        handle.destroy();
+                    }
+
+                    return next;
+                }
+
+                void await_resume() const noexcept
+                {
+                }
+            };
+
+            std::suspend_always initial_suspend() const noexcept
+            {
+                return {};
+            }
+
+            FinalAwaiter final_suspend() const noexcept
+            {
+                return {};
+            }
+
+            void unhandled_exception() const noexcept
+            {
+                std::terminate();
+            }
+        };
+
+        template< typename T >
+        struct Promise : PromiseBase
+        {
+            std::optional< T > value {};
+
+            template< typename U >
+            void return_value( U && result ) noexcept( std::is_nothrow_constructible_v< T, U && >)
+            {
+                value.emplace( std::forward< U >( result ) );
+            }
+        };
+
+        template<>
+        struct Promise< void > : PromiseBase
+        {
+            void return_void() const noexcept
+            {
+            }
+        };
+    }
+    /** @endcond */
+
+    /**
+     * @brief A lazily started coroutine.
+     *
+     * A task starts when it is awaited, and resumes its awaiter when it
+     * finishes. A Task<> can also be started on an executor with
+     * #defender::coro::spawn, in which case it frees itself when it finishes.
+     *
+     * Pass std::allocator_arg and an allocator as the first parameters of a
+     * coroutine, or just after the object parameter of a member coroutine, to
+     * allocate its frame with that allocator. Exceptions escaping a task call
+     * std::terminate.
+     */
+    template< typename T = void >
+    class [[nodiscard]] Task
+    {
+        public:
+
+            /**
+             * @brief The promise of the task.
+             */
+            struct promise_type : detail::Promise< T >
+            {
+                Task get_return_object() noexcept
+                {
+                    return Task { std::coroutine_handle< promise_type >::from_promise( *this ) };
+                }
+            };
+
+            Task( Task && other ) noexcept : handle( std::exchange( other.handle, {} ) )
+            {
+            }
+
+            Task( const Task & ) = delete;
+            Task & operator=( const Task & ) = delete;
+            Task & operator=( Task && ) = delete;
+
+            ~Task()
+            {
+                if( handle )
+                {
+                    handle.destroy();
+                }
+            }
+
+            /**
+             * @brief Start the task and wait for its result.
+             */
+            auto operator co_await() && noexcept
+            {
+                struct Awaiter
+                {
+                    std::coroutine_handle< promise_type > handle;
+
+                    bool await_ready() const noexcept
+                    {
+                        return false;
+                    }
+
+                    std::coroutine_handle<> await_suspend( std::coroutine_handle<> awaiting ) noexcept
+                    {
+                        handle.promise().continuation = awaiting;
+
+                        return handle;
+                    }
+
+                    T await_resume() noexcept
+                    {
+                        if constexpr( !std::is_void_v< T >)
+                        {
+                            return std::move( *handle.promise().value );
+                        }
+                    }
+                };
+
+                return Awaiter { handle };
+            }
+
+            template< Executor E >
+            friend void spawn( E & executor,
+                               Task< void > task ) noexcept;
+
+        private:
+
+            explicit Task( std::coroutine_handle< promise_type > coroutine ) noexcept : handle( coroutine )
+            {
+            }
+
+            std::coroutine_handle< promise_type > handle;
+    };
+
+    /**
+     * @brief Start a task on an executor without waiting for it.
+     *
+     * The frame of the task is freed when the task finishes.
+     */
+    template< Executor E >
+    void spawn( E & executor,
+                Task< void > task ) noexcept
+    {
+        std::coroutine_handle< Task< void >::promise_type > handle = std::exchange( task.handle, {} );
+
+        handle.promise().isDetached = true;
+        executor.post( handle );
+    }
+
+    template< Executor E, Publisher P >
+    class ReportSession;
+
+    /**
+     * @brief Awaitable returned by #defender::coro::ReportSession::publishReport.
+     *
+     * Publishes the report when awaited and resumes with the #ReportResult.
+     */
+    template< Executor E, Publisher P >
+    class [[nodiscard]] ReportAwaiter
+    {
+        public:
+
+            ReportAwaiter( const ReportAwaiter & ) = delete;
+            ReportAwaiter & operator=( const ReportAwaiter & ) = delete;
+
+            bool await_ready() const noexcept
+            {
+                return false;
+            }
+
+            bool await_suspend( std::coroutine_handle<> awaiting ) noexcept
+            {
+                bool isSuspended = true;
+
+                /* Link before publishing, as a response may be handled before
+                 * publish returns. After a successful publish this object
+                 * may already be resumed, so it must not be used again. */
+                handle = awaiting;
+                session.link( *this );
+
+                if( !session.publisher.publish( session.publishTopic(), payload ) )
+                {
+                    session.unlink( *this );
+                    isSuspended = false;
+                }
+
+                return isSuspended;
+            }
+
+            ReportResult await_resume() const noexcept
+            {
+                return result;
+            }
+
+        private:
+
+            friend class ReportSession< E, P >;
+
+            ReportAwaiter( ReportSession< E, P > & reportSession,
+                           std::span< const char > report,
+                           std::uint64_t id ) noexcept :
+                session( reportSession ),
+                payload( report ),
+                reportId( id )
+            {
+            }
+
+            ReportSession< E, P > & session;
+            std::span< const char > payload;
+            std::uint64_t reportId;
+            ReportResult result {};
+            std::coroutine_handle<> handle {};
+            ReportAwaiter * pNext = nullptr;
+    };
+
+    /**
+     * @brief Publishes the JSON reports of one thing and matches their
+     * responses.
+     *
+     * The application must subscribe to #acceptedTopic and #rejectedTopic and
+     * pass every received message to #onMessage.
+     */
+    template< Executor E, Publisher P >
+    class ReportSession
+    {
+        public:
+
+            /**
+             * @brief Create a session for a thing.
+             *
+             * The thing name must be valid, which can be checked with
+             * #defender::isValidThingNameLength.
+             */
+            ReportSession( E & reportExecutor,
+                           P & reportPublisher,
+                           std::string_view thingName ) noexcept :
+                executor( reportExecutor ),
+                publisher( reportPublisher ),
+                thingNameLength( thingName.size() )
+            {
+                publishTopicLength = getTopic< DefenderJsonReportPublish >( publishTopicBuffer, thingName ).size();
+                acceptedTopicLength = getTopic< DefenderJsonReportAccepted >( acceptedTopicBuffer, thingName ).size();
+                rejectedTopicLength = getTopic< DefenderJsonReportRejected >( rejectedTopicBuffer, thingName ).size();
+            }
+
+            ReportSession( const ReportSession & ) = delete;
+            ReportSession & operator=( const ReportSession & ) = delete;
+
+            /**
+             * @brief Cancels all pending reports.
+             */
+            ~ReportSession()
+            {
+                cancelAll();
+            }
+
+            /**
+             * @brief Publish a report and wait for its response.
+             *
+             * @param[in] report The serialized JSON report. It must stay valid
+             * until the awaiter resumes.
+             * @param[in] reportId The report ID in the report.
+             */
+            ReportAwaiter< E, P > publishReport( std::span< const char > report,
+                                                 std::uint64_t reportId ) noexcept
+            {
+                return ReportAwaiter< E, P > { *this, report, reportId };
+            }
+
+            /**
+             * @brief Handle a received MQTT message.
+             *
+             * The topic is matched with #Defender_MatchTopic. A response whose
+             * status contradicts its accepted or rejected topic is ignored.
+             *
+             * @return true if the message is the response to a pending report,
+             * which is then resumed through the executor; false otherwise.
+             */
+            bool onMessage( std::string_view topic,
+                            std::span< const char > payload ) noexcept
+            {
+                const TopicMatch match = matchTopic( topic );
+                DefenderReportStatus_t topicStatus = DefenderReportStatusUnknown;
+                DefenderResponse_t response;
+                ReportAwaiter< E, P > * pAwaiter = nullptr;
+                bool isHandled = false;
+
+                if( match.thingName == thingName() )
+                {
+                    if( match.api == DefenderJsonReportAccepted )
+                    {
+                        topicStatus = DefenderReportAccepted;
+                    }
+                    else if( match.api == DefenderJsonReportRejected )
+                    {
+                        topicStatus = DefenderReportRejected;
+                    }
+                }
+
+                if( ( topicStatus != DefenderReportStatusUnknown ) &&
+                    !payload.empty() && ( payload.size() <= UINT32_MAX ) &&
+                    ( Defender_ParseResponse( payload.data(),
+                                              static_cast< std::uint32_t >( payload.size() ),
+                                              &response ) == DefenderSuccess ) &&
+                    ( response.status == topicStatus ) )
+                {
+                    pAwaiter = find( response.reportId );
+                }
+
+                if( pAwaiter != nullptr )
+                {
+                    unlink( *pAwaiter );
+                    pAwaiter->result.status = DefenderSuccess;
+                    pAwaiter->result.reportStatus = response.status;
+                    pAwaiter->result.timestamp = response.timestamp;
+                    pAwaiter->result.errorCodeLength = ( response.errorCodeLength < errorCodeMaxLength ) ?
+                                                       response.errorCodeLength : errorCodeMaxLength;
+
+                    for( std::size_t i = 0U; i < pAwaiter->result.errorCodeLength; i++ )
+                    {
+                        pAwaiter->result.errorCodeValue[ i ] = response.pErrorCode[ i ];
+                    }
+
+                    executor.post( pAwaiter->handle );
+                    isHandled = true;
+                }
+
+                return isHandled;
+            }
+
+            /**
+             * @brief Resume all pending reports with #DefenderError, for
+             * example when the MQTT connection is lost.
+             */
+            void cancelAll() noexcept
+            {
+                ReportAwaiter< E, P > * pAwaiter = nullptr;
+
+                while( pPending != nullptr )
+                {
+                    pAwaiter = pPending;
+                    pPending = pAwaiter->pNext;
+                    pAwaiter->result.status = DefenderError;
+                    executor.post( pAwaiter->handle );
+                }
+            }
+
+            /**
+             * @brief The topic reports are published to.
+             */
+            std::string_view publishTopic() const noexcept
+            {
+                return std::string_view { publishTopicBuffer, publishTopicLength };
+            }
+
+            /**
+             * @brief The topic of accepted responses.
+             */
+            std::string_view acceptedTopic() const noexcept
+            {
+                return std::string_view { acceptedTopicBuffer, acceptedTopicLength };
+            }
+
+            /**
+             * @brief The topic of rejected responses.
+             */
+            std::string_view rejectedTopic() const noexcept
+            {
+                return std::string_view { rejectedTopicBuffer, rejectedTopicLength };
+            }
+
+        private:
+
+            friend class ReportAwaiter< E, P >;
+
+            std::string_view thingName() const noexcept
+            {
+                return publishTopic().substr( DEFENDER_API_LENGTH_PREFIX, thingNameLength );
+            }
+
+            void link( ReportAwaiter< E, P > & awaiter ) noexcept
+            {
+                awaiter.pNext = pPending;
+                pPending = &awaiter;
+            }
+
+            void unlink( ReportAwaiter< E, P > & awaiter ) noexcept
+            {
+                ReportAwaiter< E, P > ** ppLink = &pPending;
+
+                while( ( *ppLink != nullptr ) && ( *ppLink != &awaiter ) )
+                {
+                    ppLink = &( ( *ppLink )->pNext );
+                }
+
+                if( *ppLink != nullptr )
+                {
+                    *ppLink = awaiter.pNext;
+                }
+            }
+
+            ReportAwaiter< E, P > * find( std::uint64_t reportId ) const noexcept
+            {
+                ReportAwaiter< E, P > * pAwaiter = pPending;
+
+                while( ( pAwaiter != nullptr ) && ( pAwaiter->reportId != reportId ) )
+                {
+                    pAwaiter = pAwaiter->pNext;
+                }
+
+                return pAwaiter;
+            }
+
+            E & executor;
+            P & publisher;
+            ReportAwaiter< E, P > * pPending = nullptr;
+            char publishTopicBuffer[ maxTopicLength ] {};
+            char acceptedTopicBuffer[ maxTopicLength ] {};
+            char rejectedTopicBuffer[ maxTopicLength ] {};
+            std::size_t thingNameLength = 0U;
+            std::size_t publishTopicLength = 0U;
+            std::size_t acceptedTopicLength = 0U;
+            std::size_t rejectedTopicLength = 0U;
+    };
+}
+
+#endif /* DEFENDER_CORO_HPP_ */
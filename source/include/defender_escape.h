@@ -0,0 +1,98 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_escape.h
+ * @brief Interface for escaping strings written into JSON reports.
+ *
+ * The values of a #DEFENDER_REPORT_STRING_LIST_KEY custom metric, thing
+ * names and interface names must be escaped before they are written between
+ * quotes in a report. Most of these strings are plain ASCII with no
+ * character to escape, so #Defender_EscapeString looks for quotes,
+ * backslashes, control characters and non-ASCII bytes in many bytes at a
+ * time and copies the runs between them with memcpy. Only the bytes it finds
+ * are handled one at a time.
+ *
+ * By default the search uses portable 64-bit word operations, 8 bytes at a
+ * time. When #DEFENDER_USE_SIMD is set to 1, AVX2 instructions check 32 bytes
+ * at a time, or NEON instructions 16 bytes at a time, if the compiler targets
+ * them.
+ */
+
+#ifndef DEFENDER_ESCAPE_H_
+#define DEFENDER_ESCAPE_H_
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* Defender API include. */
+#include "defender.h"
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Escape a string for a JSON report and check that it is valid UTF-8.
+ *
+ * Quotes and backslashes are escaped with a backslash. Control characters
+ * are written as \\b, \\f, \\n, \\r, \\t, or \\u00XX for the others. UTF-8
+ * sequences are checked and copied as they are. The output does not include
+ * the surrounding quotes.
+ *
+ * An output buffer 6 times as long as the string is always large enough.
+ *
+ * @param[in] pString The string.
+ * @param[in] stringLength The length of the string.
+ * @param[in] pBuffer The buffer to write the escaped string into. Must not
+ * overlap the string.
+ * @param[in] bufferLength The length of the buffer.
+ * @param[out] pOutLength The length of the escaped string.
+ *
+ * @return #DefenderSuccess if the string is escaped;
+ * #DefenderBadParameter if invalid parameters are passed;
+ * #DefenderBufferTooSmall if the buffer cannot hold the escaped string;
+ * #DefenderError if the string is not valid UTF-8.
+ */
+/* @[declare_defender_escapestring] */
+DefenderStatus_t Defender_EscapeString( const char * pString,
+                                        uint32_t stringLength,
+                                        char * pBuffer,
+                                        uint32_t bufferLength,
+                                        uint32_t * pOutLength );
+/* @[declare_defender_escapestring] */
+
+/*-----------------------------------------------------------*/
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* DEFENDER_ESCAPE_H_ */
@@ -0,0 +1,239 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_flow_table.h
+ * @brief Interface for keeping the forwarded flows of a NAT gateway between
+ * reports.
+ *
+ * On a NAT gateway most connections are forwarded and never appear in the
+ * socket tables of the gateway. A collector which follows the connection
+ * tracking events of the kernel keeps the flows in a flow table: every new or
+ * updated flow is passed to #Defender_FlowTableUpdate and every destroyed flow
+ * to #Defender_FlowTableRemove, so the table always holds the current flows
+ * and a report does not need a full dump of the kernel table.
+ *
+ * The flows are kept in a dense array, so the established connections of a
+ * report are built with one pass over the flows, and the byte counters of
+ * every flow can be read from the array directly:
+ *
+ * @code{c}
+ * for( i = 0; i < table.count; i++ )
+ * {
+ *     const DefenderFlow_t * pFlow = &( table.pFlows[ i ] );
+ *     // Use pFlow->bytesOriginal and pFlow->bytesReply.
+ * }
+ * @endcode
+ *
+ * The flows are found with an open addressing hash index of slots, separate
+ * from the flows. All memory is provided by the application.
+ */
+
+#ifndef DEFENDER_FLOW_TABLE_H_
+#define DEFENDER_FLOW_TABLE_H_
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* Defender API include. */
+#include "defender.h"
+
+/* Connection table include. */
+#include "defender_connection_table.h"
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+/**
+ * @ingroup defender_constants
+ * @brief IP protocol number of TCP.
+ */
+#define DEFENDER_FLOW_PROTOCOL_TCP    6U
+
+/**
+ * @ingroup defender_constants
+ * @brief IP protocol number of UDP.
+ */
+#define DEFENDER_FLOW_PROTOCOL_UDP    17U
+
+/**
+ * @ingroup defender_constants
+ * @brief TCP state of a flow whose state is not known.
+ *
+ * TCP states are numbered as the connection tracking of the Linux kernel
+ * numbers them (enum tcp_conntrack). An update with this state keeps the
+ * state of the flow, as not every event carries the state.
+ */
+#define DEFENDER_FLOW_TCP_STATE_NONE    0U
+
+/**
+ * @ingroup defender_constants
+ * @brief TCP state of an established connection.
+ */
+#define DEFENDER_FLOW_TCP_STATE_ESTABLISHED    3U
+
+/**
+ * @ingroup defender_struct_types
+ * @brief A flow, identified by the tuple of its original direction.
+ *
+ * IPv4 addresses a.b.c.d are stored as ( a << 24 ) | ( b << 16 ) | ( c << 8 ) | d.
+ */
+typedef struct DefenderFlow
+{
+    uint32_t sourceAddress;      /**< @brief Source address of the original direction. */
+    uint32_t destinationAddress; /**< @brief Destination address of the original direction. */
+    uint16_t sourcePort;         /**< @brief Source port of the original direction. */
+    uint16_t destinationPort;    /**< @brief Destination port of the original direction. */
+    uint8_t protocol;            /**< @brief IP protocol number. */
+    uint8_t tcpState;            /**< @brief TCP state of a TCP flow, such as #DEFENDER_FLOW_TCP_STATE_ESTABLISHED. */
+    uint64_t bytesOriginal;      /**< @brief Bytes sent in the original direction. */
+    uint64_t bytesReply;         /**< @brief Bytes sent in the reply direction. */
+} DefenderFlow_t;
+
+/**
+ * @ingroup defender_struct_types
+ * @brief A table of flows with a hash index.
+ */
+typedef struct DefenderFlowTable
+{
+    DefenderFlow_t * pFlows; /**< @brief The flows. The first count entries are used. */
+    uint32_t count;          /**< @brief Number of flows. */
+    uint32_t capacity;       /**< @brief Number of entries in pFlows. */
+    uint32_t * pSlots;       /**< @brief Hash index. A slot holds 0 or the index of a flow plus one. */
+    uint32_t slotCount;      /**< @brief Number of slots, a power of two. */
+} DefenderFlowTable_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Initialize an empty flow table.
+ *
+ * The slot count must be a power of two larger than the capacity. Twice the
+ * capacity or more keeps lookups short.
+ *
+ * @param[out] pTable The flow table to initialize.
+ * @param[in] pFlows Array for the flows.
+ * @param[in] capacity Number of entries in pFlows.
+ * @param[in] pSlots Array for the hash index.
+ * @param[in] slotCount Number of entries in pSlots.
+ *
+ * @return #DefenderSuccess if the table is initialized;
+ * #DefenderBadParameter if invalid parameters are passed.
+ */
+/* @[declare_defender_flowtableinit] */
+DefenderStatus_t Defender_FlowTableInit( DefenderFlowTable_t * pTable,
+                                         DefenderFlow_t * pFlows,
+                                         uint32_t capacity,
+                                         uint32_t * pSlots,
+                                         uint32_t slotCount );
+/* @[declare_defender_flowtableinit] */
+
+/**
+ * @brief Add a flow, or update the byte counters and TCP state of a flow in
+ * the table.
+ *
+ * The TCP state is kept if pFlow has #DEFENDER_FLOW_TCP_STATE_NONE.
+ *
+ * @param[in] pTable The flow table.
+ * @param[in] pFlow The flow, its byte counters and its TCP state.
+ *
+ * @return #DefenderSuccess if the flow is added or updated;
+ * #DefenderBadParameter if invalid parameters are passed;
+ * #DefenderBufferTooSmall if the flow is new and the table is full.
+ */
+/* @[declare_defender_flowtableupdate] */
+DefenderStatus_t Defender_FlowTableUpdate( DefenderFlowTable_t * pTable,
+                                           const DefenderFlow_t * pFlow );
+/* @[declare_defender_flowtableupdate] */
+
+/**
+ * @brief Remove a flow from the table.
+ *
+ * The last flow of the array takes the place of the removed flow, so the
+ * order of the flows changes.
+ *
+ * @param[in] pTable The flow table.
+ * @param[in] pFlow The flow to remove. Only the tuple is used.
+ * @param[out] pOutFlow The removed flow with its last byte counters, so
+ * that the bytes of flows which end between two reports can be counted. Can
+ * be NULL.
+ *
+ * @return #DefenderSuccess if the flow is removed;
+ * #DefenderBadParameter if invalid parameters are passed;
+ * #DefenderError if the flow is not in the table.
+ */
+/* @[declare_defender_flowtableremove] */
+DefenderStatus_t Defender_FlowTableRemove( DefenderFlowTable_t * pTable,
+                                           const DefenderFlow_t * pFlow,
+                                           DefenderFlow_t * pOutFlow );
+/* @[declare_defender_flowtableremove] */
+
+/**
+ * @brief Remove every flow from the table, keeping its arrays.
+ *
+ * A collector which lost events, and rebuilds the table from a full dump of
+ * the kernel table, clears the table first.
+ *
+ * @param[in] pTable The flow table.
+ *
+ * @return #DefenderSuccess if the table is cleared;
+ * #DefenderBadParameter if invalid parameters are passed.
+ */
+/* @[declare_defender_flowtableclear] */
+DefenderStatus_t Defender_FlowTableClear( DefenderFlowTable_t * pTable );
+/* @[declare_defender_flowtableclear] */
+
+/**
+ * @brief Add the established TCP flows of the table to a connection table.
+ *
+ * Only TCP flows in state #DEFENDER_FLOW_TCP_STATE_ESTABLISHED are added, so
+ * connections being opened or closed are left out. Each flow is added as a
+ * connection from the source port of its original direction to the
+ * destination address and port, with interface index 0.
+ *
+ * @param[in] pTable The flow table.
+ * @param[in] pConnections The connection table to add connections to.
+ *
+ * @return #DefenderSuccess if the connections are added;
+ * #DefenderBadParameter if invalid parameters are passed;
+ * #DefenderBufferTooSmall if the connection table is full. The connections
+ * added before are kept.
+ */
+/* @[declare_defender_flowtablegetconnections] */
+DefenderStatus_t Defender_FlowTableGetConnections( const DefenderFlowTable_t * pTable,
+                                                   DefenderConnectionTable_t * pConnections );
+/* @[declare_defender_flowtablegetconnections] */
+
+/*-----------------------------------------------------------*/
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* DEFENDER_FLOW_TABLE_H_ */
@@ -0,0 +1,246 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_history.h
+ * @brief Interface for keeping the recent history of a metric in a fixed
+ * amount of memory, such as the bytes out over the last day.
+ *
+ * A history keeps the samples of one metric, for example one of the counters
+ * of #DEFENDER_REPORT_NETWORK_STATS_KEY, the number of established
+ * connections, or the number of a custom metric. A device keeps one history
+ * per metric, to find trends before sending a report, or to send the reports
+ * it could not send during an outage:
+ *
+ * @code{c}
+ * Defender_HistoryInit( &bytesOutHistory, blocks, 96U, data, 256U );
+ *
+ * // At every collection:
+ * Defender_HistoryAppend( &bytesOutHistory, nowMs, stats.bytesOut );
+ *
+ * // The bytes out over the last day:
+ * Defender_HistoryAggregate( &bytesOutHistory, nowMs - 86400000U, nowMs, &summary );
+ * bytesOut = summary.lastValue - summary.firstValue;
+ * @endcode
+ *
+ * Samples are compressed as in the Gorilla time series database: a timestamp
+ * is stored as the change from the previous interval between samples, which
+ * takes 1 bit when samples are taken at a fixed interval, and a value as the
+ * XOR with the previous value, which takes 1 bit when the value does not
+ * change and a few bits more when only its low bits change. Compressed
+ * samples are written into a ring of blocks of the same length. When the
+ * newest block is full, the oldest block is dropped to start a new one.
+ *
+ * Each block has a summary of its samples, so aggregates over a range only
+ * decompress the blocks at the ends of the range, and range scans skip the
+ * blocks outside the range.
+ */
+
+#ifndef DEFENDER_HISTORY_H_
+#define DEFENDER_HISTORY_H_
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* Defender API include. */
+#include "defender.h"
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+/**
+ * @ingroup defender_constants
+ * @brief Smallest length of the data of a block, which holds the longest
+ * compressed sample.
+ */
+#define DEFENDER_HISTORY_MIN_BLOCK_LENGTH    19U
+
+/**
+ * @ingroup defender_struct_types
+ * @brief A sample of a metric.
+ */
+typedef struct DefenderHistorySample
+{
+    uint64_t timestamp; /**< @brief The time of the sample, in milliseconds. */
+    uint64_t value;     /**< @brief The value of the metric. */
+} DefenderHistorySample_t;
+
+/**
+ * @ingroup defender_struct_types
+ * @brief Summary of the samples of a block or of a range.
+ *
+ * @note The sum wraps around when it does not fit in 64 bits.
+ */
+typedef struct DefenderHistorySummary
+{
+    uint64_t firstTimestamp; /**< @brief The time of the first sample. */
+    uint64_t firstValue;     /**< @brief The value of the first sample. */
+    uint64_t lastTimestamp;  /**< @brief The time of the last sample. */
+    uint64_t lastValue;      /**< @brief The value of the last sample. */
+    uint64_t minValue;       /**< @brief The smallest value. */
+    uint64_t maxValue;       /**< @brief The largest value. */
+    uint64_t sum;            /**< @brief The sum of the values. */
+    uint32_t count;          /**< @brief Number of samples. The other fields are 0 if there is none. */
+} DefenderHistorySummary_t;
+
+/**
+ * @ingroup defender_struct_types
+ * @brief A block of a history.
+ *
+ * The first sample of a block is kept uncompressed in its summary, and the
+ * other samples are compressed into the data of the block.
+ */
+typedef struct DefenderHistoryBlock
+{
+    DefenderHistorySummary_t summary; /**< @brief Summary of the samples of the block. */
+    uint32_t bitLength;               /**< @brief Number of bits used in the data of the block. */
+} DefenderHistoryBlock_t;
+
+/**
+ * @ingroup defender_struct_types
+ * @brief The history of a metric.
+ *
+ * @note The fields are set by #Defender_HistoryInit. The memory is not owned
+ * by the history, and must stay valid as long as the history is used.
+ */
+typedef struct DefenderHistory
+{
+    DefenderHistoryBlock_t * pBlocks; /**< @brief The blocks. */
+    uint8_t * pData;                  /**< @brief The data of the blocks, blockLength bytes each. */
+    uint32_t blockCount;              /**< @brief Number of blocks. */
+    uint32_t blockLength;             /**< @brief Length of the data of a block. */
+    uint32_t headIndex;               /**< @brief The block of the newest samples. */
+    uint32_t usedCount;               /**< @brief Number of blocks which hold samples. */
+    uint64_t lastDelta;               /**< @brief Time between the last two samples of the newest block. */
+    uint32_t lastLeading;             /**< @brief Leading zero bits of the last stored XOR, or 64 if there is none. */
+    uint32_t lastTrailing;            /**< @brief Trailing zero bits of the last stored XOR. */
+} DefenderHistory_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Initialize an empty history.
+ *
+ * A history with n blocks keeps between n - 1 and n blocks of samples. A
+ * block of 256 bytes holds about 100 samples taken at a fixed interval of a
+ * counter which grows by less than 1024 between samples, and 1000 samples of
+ * a value which does not change.
+ *
+ * @param[out] pHistory The history.
+ * @param[in] pBlocks Array of blockCount blocks.
+ * @param[in] blockCount Number of blocks.
+ * @param[in] pData The data of the blocks, of blockCount * blockLength bytes.
+ * @param[in] blockLength Length of the data of a block, at least
+ * #DEFENDER_HISTORY_MIN_BLOCK_LENGTH.
+ *
+ * @return #DefenderSuccess if the history is initialized;
+ * #DefenderBadParameter if invalid parameters are passed.
+ */
+/* @[declare_defender_historyinit] */
+DefenderStatus_t Defender_HistoryInit( DefenderHistory_t * pHistory,
+                                       DefenderHistoryBlock_t * pBlocks,
+                                       uint32_t blockCount,
+                                       uint8_t * pData,
+                                       uint32_t blockLength );
+/* @[declare_defender_historyinit] */
+
+/**
+ * @brief Add a sample to a history.
+ *
+ * @param[in] pHistory The history.
+ * @param[in] timestampMs The time of the sample, in milliseconds.
+ * @param[in] value The value of the metric.
+ *
+ * @return #DefenderSuccess if the sample is added;
+ * #DefenderBadParameter if invalid parameters are passed;
+ * #DefenderError if the time is not after the time of the last sample. The
+ * sample is not added.
+ */
+/* @[declare_defender_historyappend] */
+DefenderStatus_t Defender_HistoryAppend( DefenderHistory_t * pHistory,
+                                         uint64_t timestampMs,
+                                         uint64_t value );
+/* @[declare_defender_historyappend] */
+
+/**
+ * @brief Get the samples of a history between two times.
+ *
+ * The samples are returned from the oldest to the newest. When there are more
+ * samples than pSamples can hold, the oldest ones are returned, and the scan
+ * can go on from the time after the last one returned.
+ *
+ * @param[in] pHistory The history.
+ * @param[in] startMs The earliest time of the samples, inclusive.
+ * @param[in] endMs The latest time of the samples, inclusive.
+ * @param[out] pSamples Array for the samples.
+ * @param[in] sampleCapacity Number of entries in pSamples.
+ * @param[out] pOutCount The number of samples returned.
+ *
+ * @return #DefenderSuccess if all samples in the range are returned;
+ * #DefenderBadParameter if invalid parameters are passed;
+ * #DefenderBufferTooSmall if pSamples is full before the end of the range.
+ */
+/* @[declare_defender_historyscan] */
+DefenderStatus_t Defender_HistoryScan( const DefenderHistory_t * pHistory,
+                                       uint64_t startMs,
+                                       uint64_t endMs,
+                                       DefenderHistorySample_t * pSamples,
+                                       uint32_t sampleCapacity,
+                                       uint32_t * pOutCount );
+/* @[declare_defender_historyscan] */
+
+/**
+ * @brief Summarize the samples of a history between two times.
+ *
+ * Blocks whose samples are all in the range are summarized from their summary
+ * without decompressing them.
+ *
+ * @param[in] pHistory The history.
+ * @param[in] startMs The earliest time of the samples, inclusive.
+ * @param[in] endMs The latest time of the samples, inclusive.
+ * @param[out] pOutSummary The summary. Its count is 0 if there is no sample in
+ * the range.
+ *
+ * @return #DefenderSuccess if the samples are summarized;
+ * #DefenderBadParameter if invalid parameters are passed.
+ */
+/* @[declare_defender_historyaggregate] */
+DefenderStatus_t Defender_HistoryAggregate( const DefenderHistory_t * pHistory,
+                                            uint64_t startMs,
+                                            uint64_t endMs,
+                                            DefenderHistorySummary_t * pOutSummary );
+/* @[declare_defender_historyaggregate] */
+
+/*-----------------------------------------------------------*/
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* DEFENDER_HISTORY_H_ */
@@ -0,0 +1,96 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/**
+ * @file defender_index.h
+ * @brief Interface for indexing the structure of JSON payloads.
+ *
+ * #Defender_IndexStructurals finds the position of every brace, bracket,
+ * colon, comma and quote which is not inside a string, in the way of the first
+ * stage of simdjson. A parser can then jump from one of these positions to the
+ * next instead of looking at every byte, for example from the opening quote of
+ * a string to its closing quote.
+ *
+ * The payload is classified 64 bytes at a time. By default the classification
+ * uses portable 64-bit word operations. When #DEFENDER_USE_SIMD is set to 1,
+ * AVX2 or NEON instructions are used instead if the compiler targets them.
+ */
+
+#ifndef DEFENDER_INDEX_H_
+#define DEFENDER_INDEX_H_
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* Defender API include. */
+#include "defender.h"
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Find the structural characters of a JSON payload.
+ *
+ * The positions are written in increasing order. Both the opening and the
+ * closing quote of every string are included, so the closing quote of a
+ * string is always the position after its opening quote. A payload never has
+ * more structural characters than bytes, so an index as long as the payload is
+ * always large enough.
+ *
+ * @param[in] pPayload The JSON payload.
+ * @param[in] payloadLength The length of the payload.
+ * @param[out] pOutIndex The positions of the structural characters.
+ * @param[in] indexLength The number of entries in pOutIndex.
+ * @param[out] pOutCount The number of structural characters.
+ *
+ * @return #DefenderSuccess if the payload is indexed;
+ * #DefenderBadParameter if invalid parameters are passed;
+ * #DefenderBufferTooSmall if the payload has more than indexLength structural
+ * characters;
+ * #DefenderError if a string is not closed or contains an unescaped control
+ * character, or if there is a backslash outside a string.
+ */
+/* @[declare_defender_indexstructurals] */
+DefenderStatus_t Defender_IndexStructurals( const char * pPayload,
+                                            uint32_t payloadLength,
+                                            uint32_t * pOutIndex,
+                                            uint32_t indexLength,
+                                            uint32_t * pOutCount );
+/* @[declare_defender_indexstructurals] */
+
+/*-----------------------------------------------------------*/
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* DEFENDER_INDEX_H_ */
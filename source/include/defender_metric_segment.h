@@ -0,0 +1,287 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_metric_segment.h
+ * @brief Interface for sharing custom metrics between processes through a
+ * block of shared memory.
+ *
+ * A metric segment is a fixed layout of records, one per metric ID. Processes
+ * which own custom metrics write their values into the records, and the
+ * process which sends reports writes the custom metrics object of a report
+ * straight from the records. No values are sent over sockets or copied into
+ * the reporting process first.
+ *
+ * Each record is protected by a sequence lock. A writer makes the sequence
+ * number odd, stores the value and makes it even again. A reader serializes
+ * the record and then checks that the sequence number is even and did not
+ * change, or serializes it again. Writers never wait for readers, and a
+ * reader never sees half of a value. Each record must only have one writer
+ * at a time. Records take whole cache lines, so writers of different records
+ * do not slow each other down.
+ *
+ * On Linux, the memory can come from shm_open and mmap:
+ *
+ * @code{c}
+ * Defender_MetricSegmentGetSize( 32, 64, &size );
+ * fd = shm_open( "/defender_metrics", O_CREAT | O_RDWR, 0600 );
+ * ftruncate( fd, size );
+ * pMemory = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+ *
+ * // In the reporting process:
+ * Defender_MetricSegmentInit( pMemory, size, 32, 64, &segment );
+ * // In the other processes:
+ * Defender_MetricSegmentAttach( pMemory, size, &segment );
+ * @endcode
+ *
+ * The memory barrier used by the sequence locks is #DEFENDER_MEMORY_BARRIER.
+ */
+
+#ifndef DEFENDER_METRIC_SEGMENT_H_
+#define DEFENDER_METRIC_SEGMENT_H_
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* Defender API include. */
+#include "defender.h"
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+/**
+ * @ingroup defender_constants
+ * @brief Length of the header of a metric segment.
+ */
+#define DEFENDER_METRIC_SEGMENT_HEADER_LENGTH    64U
+
+/**
+ * @ingroup defender_constants
+ * @brief Length of the header of a record, before the value.
+ */
+#define DEFENDER_METRIC_RECORD_HEADER_LENGTH     16U
+
+/**
+ * @ingroup defender_constants
+ * @brief Records are padded to a multiple of this length.
+ */
+#define DEFENDER_METRIC_RECORD_ALIGNMENT         64U
+
+/**
+ * @ingroup defender_enum_types
+ * @brief Type of a custom metric, and layout of its value in a record.
+ */
+typedef enum
+{
+    DefenderMetricNumber = 1,  /**< One uint64_t. */
+    DefenderMetricNumberList,  /**< An array of uint64_t. */
+    DefenderMetricStringList,  /**< Strings, each a uint16_t length followed by the bytes of the string. */
+    DefenderMetricIpList       /**< An array of uint32_t IPv4 addresses. a.b.c.d is ( a << 24 ) | ( b << 16 ) | ( c << 8 ) | d. */
+} DefenderMetricType_t;
+
+/**
+ * @ingroup defender_struct_types
+ * @brief A metric segment mapped in the current process.
+ *
+ * @note The memory is not owned by the segment, and must stay mapped as long
+ * as the segment is used.
+ */
+typedef struct DefenderMetricSegment
+{
+    uint8_t * pMemory;     /**< @brief The memory of the segment. */
+    uint32_t recordCount;  /**< @brief Number of records. */
+    uint32_t valueLength;  /**< @brief Maximum length of the value of a record. */
+    uint32_t recordLength; /**< @brief Length of a record, including the header and padding. */
+} DefenderMetricSegment_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Get the memory needed by a metric segment.
+ *
+ * @param[in] recordCount Number of records, so metric IDs are from 0 to
+ * recordCount - 1.
+ * @param[in] valueLength Maximum length of the value of a record.
+ * @param[out] pOutLength The length of the segment.
+ *
+ * @return #DefenderSuccess if the length is computed;
+ * #DefenderBadParameter if invalid parameters are passed or the segment is
+ * longer than UINT32_MAX.
+ */
+/* @[declare_defender_metricsegmentgetsize] */
+DefenderStatus_t Defender_MetricSegmentGetSize( uint32_t recordCount,
+                                                uint32_t valueLength,
+                                                uint32_t * pOutLength );
+/* @[declare_defender_metricsegmentgetsize] */
+
+/**
+ * @brief Create a metric segment with no values in the given memory.
+ *
+ * Called once, before any process attaches to the segment.
+ *
+ * @param[in] pMemory The memory of the segment. Must be aligned to 8 bytes.
+ * @param[in] memoryLength The length of the memory.
+ * @param[in] recordCount Number of records.
+ * @param[in] valueLength Maximum length of the value of a record.
+ * @param[out] pOutSegment The segment.
+ *
+ * @return #DefenderSuccess if the segment is created;
+ * #DefenderBadParameter if invalid parameters are passed;
+ * #DefenderBufferTooSmall if the memory is shorter than the length given by
+ * #Defender_MetricSegmentGetSize.
+ */
+/* @[declare_defender_metricsegmentinit] */
+DefenderStatus_t Defender_MetricSegmentInit( uint8_t * pMemory,
+                                             uint32_t memoryLength,
+                                             uint32_t recordCount,
+                                             uint32_t valueLength,
+                                             DefenderMetricSegment_t * pOutSegment );
+/* @[declare_defender_metricsegmentinit] */
+
+/**
+ * @brief Attach to a metric segment created by #Defender_MetricSegmentInit.
+ *
+ * @param[in] pMemory The memory of the segment. Must be aligned to 8 bytes.
+ * @param[in] memoryLength The length of the memory.
+ * @param[out] pOutSegment The segment.
+ *
+ * @return #DefenderSuccess if the segment is attached;
+ * #DefenderBadParameter if invalid parameters are passed;
+ * #DefenderError if the memory does not hold a metric segment of this
+ * version, or is too short for it.
+ */
+/* @[declare_defender_metricsegmentattach] */
+DefenderStatus_t Defender_MetricSegmentAttach( uint8_t * pMemory,
+                                               uint32_t memoryLength,
+                                               DefenderMetricSegment_t * pOutSegment );
+/* @[declare_defender_metricsegmentattach] */
+
+/**
+ * @brief Store the value of a custom metric in its record.
+ *
+ * @param[in] pSegment The segment.
+ * @param[in] metricId The metric ID, which is the index of its record.
+ * @param[in] type The type of the metric.
+ * @param[in] pValue The value, laid out as described by #DefenderMetricType_t.
+ * @param[in] valueLength The length of the value.
+ *
+ * @return #DefenderSuccess if the value is stored;
+ * #DefenderBadParameter if invalid parameters are passed, including a value
+ * which does not match its type;
+ * #DefenderBufferTooSmall if the value is longer than the records of the
+ * segment.
+ */
+/* @[declare_defender_metricsegmentwrite] */
+DefenderStatus_t Defender_MetricSegmentWrite( const DefenderMetricSegment_t * pSegment,
+                                              uint32_t metricId,
+                                              DefenderMetricType_t type,
+                                              const uint8_t * pValue,
+                                              uint32_t valueLength );
+/* @[declare_defender_metricsegmentwrite] */
+
+/**
+ * @brief Write the custom metrics object of a report from a metric segment.
+ *
+ * The output is the value of #DEFENDER_REPORT_CUSTOM_METRICS_KEY, for
+ * example:
+ *
+ * @code{.json}
+ * {"cpu_usage":[{"number":26}],"peers":[{"ip_list":["10.0.0.1"]}]}
+ * @endcode
+ *
+ * Records without a value, records of metric IDs without a name, and records
+ * which are written to every time they are read are left out. Records whose
+ * value is not valid, because the writer did not use
+ * #Defender_MetricSegmentWrite, are also left out with a warning.
+ *
+ * @param[in] pSegment The segment.
+ * @param[in] ppMetricNames Array of metric names, indexed by metric ID.
+ * @param[in] pMetricNameLengths Array of metric name lengths.
+ * @param[in] metricNameCount Number of entries in the above arrays.
+ * @param[in] pBuffer The buffer to write the object into.
+ * @param[in] bufferLength The length of the buffer.
+ * @param[out] pOutLength The length of the object.
+ *
+ * @return #DefenderSuccess if the object is written;
+ * #DefenderBadParameter if invalid parameters are passed;
+ * #DefenderBufferTooSmall if the buffer cannot hold the object;
+ * #DefenderError if a metric name is not valid UTF-8.
+ */
+/* @[declare_defender_metricsegmentserialize] */
+DefenderStatus_t Defender_MetricSegmentSerialize( const DefenderMetricSegment_t * pSegment,
+                                                  const char * const * ppMetricNames,
+                                                  const uint16_t * pMetricNameLengths,
+                                                  uint32_t metricNameCount,
+                                                  char * pBuffer,
+                                                  uint32_t bufferLength,
+                                                  uint32_t * pOutLength );
+/* @[declare_defender_metricsegmentserialize] */
+
+/**
+ * @brief Add the metrics of a metric segment to a custom metrics object, so
+ * that one report can hold them and other custom metrics.
+ *
+ * The buffer holds either nothing, or a custom metrics object written by
+ * #Defender_MetricSegmentSerialize, #Defender_MetricSegmentAppend,
+ * #Defender_SerializeRates or #Defender_AppendRates. The metrics are added to
+ * that object as #Defender_MetricSegmentSerialize writes them.
+ *
+ * @param[in] pSegment The segment.
+ * @param[in] ppMetricNames Array of metric names, indexed by metric ID.
+ * @param[in] pMetricNameLengths Array of metric name lengths.
+ * @param[in] metricNameCount Number of entries in the above arrays.
+ * @param[in] pBuffer The buffer holding the object.
+ * @param[in] bufferLength The length of the buffer.
+ * @param[in,out] pInOutLength The length of the object in the buffer, 0 for
+ * no object. Set to the length of the object with the metrics.
+ *
+ * @return #DefenderSuccess if the metrics are added;
+ * #DefenderBadParameter if invalid parameters are passed, or the buffer does
+ * not hold an object;
+ * #DefenderBufferTooSmall if the buffer cannot hold the object;
+ * #DefenderError if a metric name is not valid UTF-8. On errors, the object
+ * given in the buffer is kept and pInOutLength is not changed.
+ */
+/* @[declare_defender_metricsegmentappend] */
+DefenderStatus_t Defender_MetricSegmentAppend( const DefenderMetricSegment_t * pSegment,
+                                               const char * const * ppMetricNames,
+                                               const uint16_t * pMetricNameLengths,
+                                               uint32_t metricNameCount,
+                                               char * pBuffer,
+                                               uint32_t bufferLength,
+                                               uint32_t * pInOutLength );
+/* @[declare_defender_metricsegmentappend] */
+
+/*-----------------------------------------------------------*/
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* DEFENDER_METRIC_SEGMENT_H_ */
@@ -0,0 +1,216 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_name_dict.h
+ * @brief Interface for a compact, read-mostly set of thing names, such as all
+ * the things a gateway manages.
+ *
+ * The names of a fleet share long prefixes, such as "sensor-0001234". A name
+ * dictionary keeps the names in sorted order and front codes them: in each
+ * bucket of names, the first name is kept whole, and every other name as the
+ * length of the prefix it shares with the name before it and the rest of its
+ * bytes. A million names of 15 bytes take about 6 MB this way, instead of the
+ * 128 MB of DEFENDER_THINGNAME_MAX_LENGTH bytes per name:
+ *
+ * @code{c}
+ * Defender_NameDictInit( &dict, pData, dataLength, pBucketOffsets, bucketCapacity, 16U );
+ *
+ * // For every name, in sorted order:
+ * Defender_NameDictAppend( &dict, pThingName, thingNameLength );
+ *
+ * // When a response arrives:
+ * Defender_MatchTopic( pTopic, topicLength, &api, &pThingName, &thingNameLength );
+ * Defender_NameDictFind( &dict, pThingName, thingNameLength, &nameIndex );
+ *
+ * // To build the topics of all things:
+ * cursor.nextIndex = 0U;
+ *
+ * while( Defender_NameDictNext( &dict, &cursor ) == DefenderSuccess )
+ * {
+ *     Defender_GetTopic( pBuffer, bufferLength, cursor.name, cursor.nameLength, api, &topicLength );
+ * }
+ * @endcode
+ *
+ * A name is found with a binary search over the first names of the buckets,
+ * whose first levels stay in the cache, and a scan of one bucket, which takes
+ * a cache line or two. The index of a name is its rank in the sorted order,
+ * so it can index arrays of per-thing state.
+ */
+
+#ifndef DEFENDER_NAME_DICT_H_
+#define DEFENDER_NAME_DICT_H_
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* Defender API include. */
+#include "defender.h"
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+/**
+ * @ingroup defender_constants
+ * @brief Largest number of names in a bucket.
+ */
+#define DEFENDER_NAME_DICT_MAX_BUCKET_SIZE    256U
+
+/**
+ * @ingroup defender_struct_types
+ * @brief A name dictionary.
+ *
+ * @note The fields are set by #Defender_NameDictInit and
+ * #Defender_NameDictAppend. The memory is not owned by the dictionary, and
+ * must stay valid as long as the dictionary is used.
+ */
+typedef struct DefenderNameDict
+{
+    uint8_t * pData;                                  /**< @brief The front coded names. */
+    uint32_t dataCapacity;                            /**< @brief Length of pData. */
+    uint32_t dataLength;                              /**< @brief Number of bytes of pData used. */
+    uint32_t * pBucketOffsets;                        /**< @brief Offset in pData of the first name of each bucket. */
+    uint32_t bucketCapacity;                          /**< @brief Number of entries in pBucketOffsets. */
+    uint32_t bucketSize;                              /**< @brief Number of names in a bucket. */
+    uint32_t nameCount;                               /**< @brief Number of names. */
+    uint16_t lastNameLength;                          /**< @brief Length of the last name appended. */
+    char lastName[ DEFENDER_THINGNAME_MAX_LENGTH ];   /**< @brief The last name appended. */
+} DefenderNameDict_t;
+
+/**
+ * @ingroup defender_struct_types
+ * @brief A position in a name dictionary, and the name at that position.
+ */
+typedef struct DefenderNameDictCursor
+{
+    uint32_t nextIndex;                           /**< @brief Index of the next name. Set to 0 to start at the first name. */
+    uint32_t nextOffset;                          /**< @brief Offset in the data of the next name. */
+    uint16_t nameLength;                          /**< @brief Length of the current name. */
+    char name[ DEFENDER_THINGNAME_MAX_LENGTH ];   /**< @brief The current name. */
+} DefenderNameDictCursor_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Initialize an empty name dictionary.
+ *
+ * A name takes 2 bytes plus the bytes it does not share with the name before
+ * it, and the first name of a bucket 1 byte plus its length. Larger buckets
+ * take less memory, and smaller buckets make lookups faster; 16 is a good
+ * start.
+ *
+ * @param[out] pDict The name dictionary.
+ * @param[in] pData The memory of the names.
+ * @param[in] dataCapacity The length of pData.
+ * @param[in] pBucketOffsets Array of bucket offsets, one per bucketSize names.
+ * @param[in] bucketCapacity Number of entries in pBucketOffsets.
+ * @param[in] bucketSize Number of names in a bucket, up to
+ * #DEFENDER_NAME_DICT_MAX_BUCKET_SIZE.
+ *
+ * @return #DefenderSuccess if the dictionary is initialized;
+ * #DefenderBadParameter if invalid parameters are passed.
+ */
+/* @[declare_defender_namedictinit] */
+DefenderStatus_t Defender_NameDictInit( DefenderNameDict_t * pDict,
+                                        uint8_t * pData,
+                                        uint32_t dataCapacity,
+                                        uint32_t * pBucketOffsets,
+                                        uint32_t bucketCapacity,
+                                        uint32_t bucketSize );
+/* @[declare_defender_namedictinit] */
+
+/**
+ * @brief Add a name after the last name of a dictionary.
+ *
+ * Names must be added in increasing order of their bytes, compared as with
+ * memcmp, with a name before the longer names it is a prefix of.
+ *
+ * @param[in] pDict The name dictionary.
+ * @param[in] pThingName The thing name.
+ * @param[in] thingNameLength The length of the thing name.
+ *
+ * @return #DefenderSuccess if the name is added;
+ * #DefenderBadParameter if invalid parameters are passed, including an empty
+ * thing name or one longer than #DEFENDER_THINGNAME_MAX_LENGTH;
+ * #DefenderError if the name is not after the last name;
+ * #DefenderBufferTooSmall if the data or the bucket offsets are full.
+ */
+/* @[declare_defender_namedictappend] */
+DefenderStatus_t Defender_NameDictAppend( DefenderNameDict_t * pDict,
+                                          const char * pThingName,
+                                          uint16_t thingNameLength );
+/* @[declare_defender_namedictappend] */
+
+/**
+ * @brief Find the index of a name, for example from the thing name returned
+ * by #Defender_MatchTopic.
+ *
+ * @param[in] pDict The name dictionary.
+ * @param[in] pThingName The thing name.
+ * @param[in] thingNameLength The length of the thing name.
+ * @param[out] pOutIndex The index of the name, from 0 for the first name.
+ *
+ * @return #DefenderSuccess if the name is found;
+ * #DefenderNoMatch if the name is not in the dictionary;
+ * #DefenderBadParameter if invalid parameters are passed.
+ */
+/* @[declare_defender_namedictfind] */
+DefenderStatus_t Defender_NameDictFind( const DefenderNameDict_t * pDict,
+                                        const char * pThingName,
+                                        uint16_t thingNameLength,
+                                        uint32_t * pOutIndex );
+/* @[declare_defender_namedictfind] */
+
+/**
+ * @brief Move a cursor to the next name of a dictionary.
+ *
+ * A cursor whose next index is 0 moves to the first name. A cursor can also
+ * start at any other multiple of the bucket size, which lets threads build
+ * the topics of different buckets.
+ *
+ * @param[in] pDict The name dictionary.
+ * @param[in,out] pCursor The cursor. Its name is the next name.
+ *
+ * @return #DefenderSuccess if the cursor moved to the next name;
+ * #DefenderNoMatch if there is no next name;
+ * #DefenderBadParameter if invalid parameters are passed, including a cursor
+ * which did not come from this dictionary.
+ */
+/* @[declare_defender_namedictnext] */
+DefenderStatus_t Defender_NameDictNext( const DefenderNameDict_t * pDict,
+                                        DefenderNameDictCursor_t * pCursor );
+/* @[declare_defender_namedictnext] */
+
+/*-----------------------------------------------------------*/
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* DEFENDER_NAME_DICT_H_ */
@@ -0,0 +1,199 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_name_filter.h
+ * @brief Interface for a Bloom filter of thing names, which drops the topics
+ * of things a gateway does not manage before they are looked up.
+ *
+ * On a shared broker, a gateway also receives the Device Defender topics of
+ * things managed by other gateways. A name filter holds the names of the
+ * managed things in a blocked Bloom filter: the name hash picks one block of
+ * 32 bytes, and sets or tests one bit in each of its 8 words. A name which
+ * was never added is found absent with one cache line read, and a name which
+ * was added is always found present:
+ *
+ * @code{c}
+ * Defender_NameFilterInit( &filter, pBlocks, blockCount );
+ *
+ * // For every managed thing, at any time:
+ * Defender_NameFilterAdd( &filter, pThingName, thingNameLength );
+ *
+ * // When a publish arrives:
+ * if( Defender_NameFilterMatchTopic( &filter, pTopic, topicLength, &api,
+ *                                    &pThingName, &thingNameLength ) == DefenderSuccess )
+ * {
+ *     // Look the thing up, it is most likely managed.
+ * }
+ * @endcode
+ *
+ * With #DEFENDER_NAME_FILTER_NAMES_PER_BLOCK names per block, about 1 in 100
+ * names which were not added is found present. Names cannot be removed; a
+ * removed thing only costs a lookup, and the filter can be rebuilt when many
+ * things were removed.
+ */
+
+#ifndef DEFENDER_NAME_FILTER_H_
+#define DEFENDER_NAME_FILTER_H_
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* Defender API include. */
+#include "defender.h"
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+/**
+ * @ingroup defender_constants
+ * @brief Number of 32-bit words in a block of a name filter.
+ */
+#define DEFENDER_NAME_FILTER_BLOCK_WORDS       8U
+
+/**
+ * @ingroup defender_constants
+ * @brief Number of names per block which gives about 1% false positives.
+ */
+#define DEFENDER_NAME_FILTER_NAMES_PER_BLOCK    24U
+
+/**
+ * @ingroup defender_struct_types
+ * @brief A name filter.
+ *
+ * @note The fields are set by #Defender_NameFilterInit and
+ * #Defender_NameFilterAdd. The blocks are not owned by the filter, and must
+ * stay valid as long as the filter is used.
+ */
+typedef struct DefenderNameFilter
+{
+    uint32_t * pBlocks;  /**< @brief The blocks, #DEFENDER_NAME_FILTER_BLOCK_WORDS words each. */
+    uint32_t blockCount; /**< @brief Number of blocks. */
+    uint32_t nameCount;  /**< @brief Number of names added. */
+} DefenderNameFilter_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Initialize an empty name filter.
+ *
+ * For N names, use about N / #DEFENDER_NAME_FILTER_NAMES_PER_BLOCK blocks.
+ * The blocks are best aligned to 32 bytes, so that a block is in one cache
+ * line.
+ *
+ * @param[out] pFilter The name filter.
+ * @param[in] pBlocks Array of blockCount * #DEFENDER_NAME_FILTER_BLOCK_WORDS
+ * words. It is cleared.
+ * @param[in] blockCount Number of blocks.
+ *
+ * @return #DefenderSuccess if the filter is initialized;
+ * #DefenderBadParameter if invalid parameters are passed.
+ */
+/* @[declare_defender_namefilterinit] */
+DefenderStatus_t Defender_NameFilterInit( DefenderNameFilter_t * pFilter,
+                                          uint32_t * pBlocks,
+                                          uint32_t blockCount );
+/* @[declare_defender_namefilterinit] */
+
+/**
+ * @brief Add a thing name to a name filter.
+ *
+ * Names can be added at any time, including between checks. Adding a name
+ * twice has no effect apart from counting it twice.
+ *
+ * @param[in] pFilter The name filter.
+ * @param[in] pThingName The thing name.
+ * @param[in] thingNameLength The length of the thing name, from 1 to
+ * #DEFENDER_THINGNAME_MAX_LENGTH.
+ *
+ * @return #DefenderSuccess if the name is added;
+ * #DefenderBadParameter if invalid parameters are passed.
+ */
+/* @[declare_defender_namefilteradd] */
+DefenderStatus_t Defender_NameFilterAdd( DefenderNameFilter_t * pFilter,
+                                         const char * pThingName,
+                                         uint16_t thingNameLength );
+/* @[declare_defender_namefilteradd] */
+
+/**
+ * @brief Check whether a thing name may have been added to a name filter.
+ *
+ * @param[in] pFilter The name filter.
+ * @param[in] pThingName The thing name.
+ * @param[in] thingNameLength The length of the thing name.
+ *
+ * @return #DefenderSuccess if the name may have been added;
+ * #DefenderNoMatch if the name was not added;
+ * #DefenderBadParameter if invalid parameters are passed.
+ */
+/* @[declare_defender_namefiltercheck] */
+DefenderStatus_t Defender_NameFilterCheck( const DefenderNameFilter_t * pFilter,
+                                           const char * pThingName,
+                                           uint16_t thingNameLength );
+/* @[declare_defender_namefiltercheck] */
+
+/**
+ * @brief Match a topic as #Defender_MatchTopic does, for the things of a name
+ * filter only.
+ *
+ * The thing name is taken from the topic and checked against the filter
+ * first, so the topics of things which were not added are dropped before the
+ * rest of the topic is matched.
+ *
+ * @param[in] pFilter The name filter.
+ * @param[in] pTopic The topic string to match.
+ * @param[in] topicLength The length of the topic string.
+ * @param[out] pOutApi The Device Defender API the topic is for.
+ * @param[out] ppOutThingName Optional parameter to get the start of the thing
+ * name in the topic.
+ * @param[out] pOutThingNameLength Optional parameter to get the length of the
+ * thing name.
+ *
+ * @return #DefenderSuccess if the topic is a Device Defender topic of a thing
+ * which may have been added;
+ * #DefenderNoMatch if it is not a Device Defender topic, or the thing was not
+ * added;
+ * #DefenderBadParameter if invalid parameters are passed.
+ */
+/* @[declare_defender_namefiltermatchtopic] */
+DefenderStatus_t Defender_NameFilterMatchTopic( const DefenderNameFilter_t * pFilter,
+                                                const char * pTopic,
+                                                uint16_t topicLength,
+                                                DefenderTopic_t * pOutApi,
+                                                const char ** ppOutThingName,
+                                                uint16_t * pOutThingNameLength );
+/* @[declare_defender_namefiltermatchtopic] */
+
+/*-----------------------------------------------------------*/
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* DEFENDER_NAME_FILTER_H_ */
@@ -0,0 +1,226 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_netstat.h
+ * @brief Interface for reading the network metrics of a Linux network
+ * namespace from procfs and writing them as a report.
+ *
+ * The parsers take the text of the procfs files of one network namespace,
+ * which the application reads into its own buffer:
+ *
+ * - /proc/net/tcp and /proc/net/tcp6 with #Defender_ParseTcpTable,
+ * - /proc/net/udp and /proc/net/udp6 with #Defender_ParseUdpTable,
+ * - /proc/net/dev with #Defender_ParseNetDev.
+ *
+ * The files of a namespace other than the one of the process can be read by
+ * a thread which has joined the namespace with setns, through
+ * /proc/thread-self/net. The parsers do no I/O and allocate no memory, so a
+ * collector can reuse the same buffers for every namespace. A typical use is:
+ *
+ * @code{c}
+ * Defender_ConnectionTableInit( &connections, addresses, remotePorts, localPorts, interfaceIds, 256 );
+ * metrics.pConnections = &connections;
+ * Defender_ParseTcpTable( pTcpText, tcpTextLength, &connections,
+ *                         tcpPorts, 64, &metrics.tcpPortCount );
+ * Defender_ParseUdpTable( pUdpText, udpTextLength, udpPorts, 64, &metrics.udpPortCount );
+ * Defender_ParseNetDev( pDevText, devTextLength, &metrics.stats );
+ * Defender_SerializeNetworkReport( &metrics, reportId, pBuffer, bufferLength, &length );
+ * @endcode
+ */
+
+#ifndef DEFENDER_NETSTAT_H_
+#define DEFENDER_NETSTAT_H_
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* Defender API include. */
+#include "defender.h"
+
+/* Connection table include. */
+#include "defender_connection_table.h"
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+/**
+ * @ingroup defender_struct_types
+ * @brief Network statistics of all interfaces of a namespace, except the
+ * loopback interface.
+ */
+typedef struct DefenderNetworkStats
+{
+    uint64_t bytesIn;    /**< @brief Received bytes. */
+    uint64_t bytesOut;   /**< @brief Transmitted bytes. */
+    uint64_t packetsIn;  /**< @brief Received packets. */
+    uint64_t packetsOut; /**< @brief Transmitted packets. */
+} DefenderNetworkStats_t;
+
+/**
+ * @ingroup defender_struct_types
+ * @brief The network metrics of one report.
+ */
+typedef struct DefenderNetworkMetrics
+{
+    const DefenderConnectionTable_t * pConnections; /**< @brief Established TCP connections. */
+    const uint16_t * pTcpPorts;                     /**< @brief Listening TCP ports. Can be NULL if tcpPortCount is 0. */
+    uint32_t tcpPortCount;                          /**< @brief Number of listening TCP ports. */
+    const uint16_t * pUdpPorts;                     /**< @brief Listening UDP ports. Can be NULL if udpPortCount is 0. */
+    uint32_t udpPortCount;                          /**< @brief Number of listening UDP ports. */
+    DefenderNetworkStats_t stats;                   /**< @brief Network statistics. */
+} DefenderNetworkMetrics_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Parse the TCP sockets of /proc/net/tcp or /proc/net/tcp6.
+ *
+ * Established IPv4 connections, including IPv4-mapped IPv6 connections, are
+ * added to pConnections with interface index 0. Other established IPv6
+ * connections are skipped, as a connection table holds IPv4 addresses. The
+ * local ports of listening sockets are appended to pPorts, so the same arrays
+ * can be passed for both files.
+ *
+ * Addresses are converted with the byte order of the host which runs the
+ * parser, so the text must come from the same host.
+ *
+ * @param[in] pText The text of the file, starting with its header line.
+ * @param[in] textLength The length of the text.
+ * @param[in] pConnections The connection table to add connections to.
+ * @param[in] pPorts Array to append listening ports to.
+ * @param[in] portCapacity Number of entries in pPorts.
+ * @param[in,out] pPortCount Number of ports in pPorts. Updated with the
+ * appended ports.
+ *
+ * @return #DefenderSuccess if the text is parsed;
+ * #DefenderBadParameter if invalid parameters are passed;
+ * #DefenderBufferTooSmall if the connection table or pPorts is full. The
+ * sockets parsed before are kept;
+ * #DefenderError if a line is not a socket.
+ */
+/* @[declare_defender_parsetcptable] */
+DefenderStatus_t Defender_ParseTcpTable( const char * pText,
+                                         uint32_t textLength,
+                                         DefenderConnectionTable_t * pConnections,
+                                         uint16_t * pPorts,
+                                         uint32_t portCapacity,
+                                         uint32_t * pPortCount );
+/* @[declare_defender_parsetcptable] */
+
+/**
+ * @brief Parse the UDP sockets of /proc/net/udp or /proc/net/udp6.
+ *
+ * The local ports of bound sockets which are not connected are appended to
+ * pPorts.
+ *
+ * @param[in] pText The text of the file, starting with its header line.
+ * @param[in] textLength The length of the text.
+ * @param[in] pPorts Array to append listening ports to.
+ * @param[in] portCapacity Number of entries in pPorts.
+ * @param[in,out] pPortCount Number of ports in pPorts. Updated with the
+ * appended ports.
+ *
+ * @return #DefenderSuccess if the text is parsed;
+ * #DefenderBadParameter if invalid parameters are passed;
+ * #DefenderBufferTooSmall if pPorts is full. The ports parsed before are
+ * kept;
+ * #DefenderError if a line is not a socket.
+ */
+/* @[declare_defender_parseudptable] */
+DefenderStatus_t Defender_ParseUdpTable( const char * pText,
+                                         uint32_t textLength,
+                                         uint16_t * pPorts,
+                                         uint32_t portCapacity,
+                                         uint32_t * pPortCount );
+/* @[declare_defender_parseudptable] */
+
+/**
+ * @brief Parse the interface statistics of /proc/net/dev.
+ *
+ * The counters of all interfaces except "lo" are added up.
+ *
+ * @param[in] pText The text of the file, starting with its two header lines.
+ * @param[in] textLength The length of the text.
+ * @param[out] pOutStats The network statistics.
+ *
+ * @return #DefenderSuccess if the text is parsed;
+ * #DefenderBadParameter if invalid parameters are passed;
+ * #DefenderError if a line is not an interface.
+ */
+/* @[declare_defender_parsenetdev] */
+DefenderStatus_t Defender_ParseNetDev( const char * pText,
+                                       uint32_t textLength,
+                                       DefenderNetworkStats_t * pOutStats );
+/* @[declare_defender_parsenetdev] */
+
+/**
+ * @brief Write a JSON report with the given network metrics.
+ *
+ * The key names are selected by #DEFENDER_USE_LONG_KEYS. For example, with
+ * short keys:
+ *
+ * @code{.json}
+ * {"hed":{"rid":42,"v":"1.0"},
+ *  "met":{"tp":{"pts":[{"pt":22}],"t":1},
+ *         "up":{"pts":[{"pt":53}],"t":1},
+ *         "ns":{"bi":930,"bo":1030,"pi":13,"po":13},
+ *         "tc":{"ec":{"cs":[{"lp":22,"rad":"10.0.0.1:50000"}],"t":1}}}}
+ * @endcode
+ *
+ * Ports are written in the given order, and a port equal to the port before
+ * it is written once, so sorted ports are written without duplicates. The
+ * connections are written with #Defender_ConnectionTableSerialize, without
+ * local interfaces.
+ *
+ * @param[in] pMetrics The network metrics.
+ * @param[in] reportId The report ID.
+ * @param[in] pBuffer The buffer to write the report into.
+ * @param[in] bufferLength The length of the buffer.
+ * @param[out] pOutLength The length of the report.
+ *
+ * @return #DefenderSuccess if the report is written;
+ * #DefenderBadParameter if invalid parameters are passed;
+ * #DefenderBufferTooSmall if the buffer cannot hold the report.
+ */
+/* @[declare_defender_serializenetworkreport] */
+DefenderStatus_t Defender_SerializeNetworkReport( const DefenderNetworkMetrics_t * pMetrics,
+                                                  uint64_t reportId,
+                                                  char * pBuffer,
+                                                  uint32_t bufferLength,
+                                                  uint32_t * pOutLength );
+/* @[declare_defender_serializenetworkreport] */
+
+/*-----------------------------------------------------------*/
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* DEFENDER_NETSTAT_H_ */
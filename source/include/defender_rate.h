@@ -0,0 +1,246 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_rate.h
+ * @brief Interface for computing rates of counters, such as bytes per second,
+ * from the samples taken at each collection.
+ *
+ * The counters of a device, such as the bytes in
+ * #DEFENDER_REPORT_NETWORK_STATS_KEY or the connections opened since boot,
+ * only grow. A rate turns two samples of a counter into an amount per second
+ * and smooths it with an exponentially weighted moving average, so that no
+ * history of samples is kept:
+ *
+ * @code{c}
+ * Defender_RateInit( &bytesInRate, 64U, 2U );
+ *
+ * // At every collection:
+ * Defender_RateUpdate( &bytesInRate, stats.bytesIn, nowMs );
+ *
+ * // At report time, the value of the custom metrics key:
+ * Defender_SerializeRates( rates, names, nameLengths, 2U, pBuffer, length, &written );
+ *
+ * // Or, to add the rates to the custom metrics of a metric segment:
+ * Defender_AppendRates( rates, names, nameLengths, 2U, pBuffer, length, &written );
+ * @endcode
+ *
+ * Rates are kept in fixed point, with #DEFENDER_RATE_FRACTION_BITS bits below
+ * the unit, so an update costs one division and a few additions and shifts.
+ */
+
+#ifndef DEFENDER_RATE_H_
+#define DEFENDER_RATE_H_
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* Defender API include. */
+#include "defender.h"
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+/**
+ * @ingroup defender_constants
+ * @brief Number of bits below the unit in #DefenderRate_t.rate.
+ */
+#define DEFENDER_RATE_FRACTION_BITS    8U
+
+/**
+ * @ingroup defender_constants
+ * @brief Largest smoothing shift of a rate.
+ */
+#define DEFENDER_RATE_MAX_SHIFT        15U
+
+/**
+ * @ingroup defender_struct_types
+ * @brief The state of the rate of one counter.
+ *
+ * The state has a fixed size and holds no pointers, so rates can be kept in
+ * arrays, one per metric.
+ */
+typedef struct DefenderRate
+{
+    uint64_t lastValue;     /**< @brief The value of the counter at the last sample. */
+    uint64_t lastTimestamp; /**< @brief The time of the last sample, in milliseconds. */
+    uint64_t rate;          /**< @brief The smoothed amount per second, in fixed point. */
+    uint8_t counterBits;    /**< @brief Width of the counter, after which it wraps to 0. */
+    uint8_t shift;          /**< @brief Each sample moves the rate by 1 / 2^shift of the difference. */
+    uint8_t sampleCount;    /**< @brief 0 before the first sample, 1 after it, 2 once the rate is known. */
+} DefenderRate_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Initialize the rate of a counter.
+ *
+ * @param[out] pRate The rate.
+ * @param[in] counterBits The width of the counter, from 8 to 64. A 32-bit
+ * counter, such as the byte counters of a 32-bit kernel, wraps to 0 after
+ * UINT32_MAX.
+ * @param[in] shift How slowly the rate follows the samples, up to
+ * #DEFENDER_RATE_MAX_SHIFT. With 0, the rate is the rate between the last two
+ * samples. With 2, each sample moves the rate by a quarter of the difference.
+ *
+ * @return #DefenderSuccess if the rate is initialized;
+ * #DefenderBadParameter if invalid parameters are passed.
+ */
+/* @[declare_defender_rateinit] */
+DefenderStatus_t Defender_RateInit( DefenderRate_t * pRate,
+                                    uint8_t counterBits,
+                                    uint8_t shift );
+/* @[declare_defender_rateinit] */
+
+/**
+ * @brief Update a rate with a new sample of its counter.
+ *
+ * A counter which is lower than at the last sample either wrapped or was
+ * reset. It wrapped if it was in the upper half of its range and is now in the
+ * lower half, and the amount across the wrap is counted. Otherwise it was
+ * reset, for example by a restart of its owner. The amount counted before the
+ * reset is unknown, so the sample only becomes the base of the next one, and
+ * the rate does not change.
+ *
+ * @param[in] pRate The rate.
+ * @param[in] value The value of the counter.
+ * @param[in] timestampMs The time of the sample, in milliseconds, from a clock
+ * which does not go back.
+ *
+ * @return #DefenderSuccess if the sample is used;
+ * #DefenderBadParameter if invalid parameters are passed, including a value
+ * wider than the counter;
+ * #DefenderError if the sample is not later than the last sample. The rate is
+ * not changed.
+ */
+/* @[declare_defender_rateupdate] */
+DefenderStatus_t Defender_RateUpdate( DefenderRate_t * pRate,
+                                      uint64_t value,
+                                      uint64_t timestampMs );
+/* @[declare_defender_rateupdate] */
+
+/**
+ * @brief Get the rate of a counter, rounded to an amount per second.
+ *
+ * @param[in] pRate The rate.
+ * @param[out] pOutPerSecond The rate.
+ *
+ * @return #DefenderSuccess if the rate is known;
+ * #DefenderBadParameter if invalid parameters are passed;
+ * #DefenderError if fewer than two samples were taken since the rate was
+ * initialized.
+ */
+/* @[declare_defender_rateget] */
+DefenderStatus_t Defender_RateGet( const DefenderRate_t * pRate,
+                                   uint64_t * pOutPerSecond );
+/* @[declare_defender_rateget] */
+
+/**
+ * @brief Write rates as the custom metrics object of a report.
+ *
+ * The output is the value of #DEFENDER_REPORT_CUSTOM_METRICS_KEY, with each
+ * rate rounded to an amount per second, for example:
+ *
+ * @code{.json}
+ * {"bytes_in_rate":[{"number":1250}],"connections_rate":[{"number":3}]}
+ * @endcode
+ *
+ * Rates which are not known yet are left out.
+ *
+ * @param[in] pRates Array of rates.
+ * @param[in] ppNames Array of the metric names of the rates.
+ * @param[in] pNameLengths Array of the lengths of the metric names.
+ * @param[in] rateCount Number of entries in the above arrays.
+ * @param[in] pBuffer The buffer to write the object into.
+ * @param[in] bufferLength The length of the buffer.
+ * @param[out] pOutLength The length of the object.
+ *
+ * @return #DefenderSuccess if the object is written;
+ * #DefenderBadParameter if invalid parameters are passed;
+ * #DefenderBufferTooSmall if the buffer cannot hold the object;
+ * #DefenderError if a metric name is not valid UTF-8.
+ */
+/* @[declare_defender_serializerates] */
+DefenderStatus_t Defender_SerializeRates( const DefenderRate_t * pRates,
+                                          const char * const * ppNames,
+                                          const uint16_t * pNameLengths,
+                                          uint32_t rateCount,
+                                          char * pBuffer,
+                                          uint32_t bufferLength,
+                                          uint32_t * pOutLength );
+/* @[declare_defender_serializerates] */
+
+/**
+ * @brief Add rates to a custom metrics object, so that one report can hold
+ * rates and other custom metrics.
+ *
+ * The buffer holds either nothing, or a custom metrics object written by
+ * #Defender_SerializeRates, #Defender_AppendRates,
+ * #Defender_MetricSegmentSerialize or #Defender_MetricSegmentAppend. The
+ * rates are added to that object as #Defender_SerializeRates writes them:
+ *
+ * @code{c}
+ * Defender_MetricSegmentSerialize( &segment, metricNames, metricNameLengths, metricCount,
+ *                                  pBuffer, bufferLength, &length );
+ * Defender_AppendRates( rates, names, nameLengths, 2U, pBuffer, bufferLength, &length );
+ * @endcode
+ *
+ * @param[in] pRates Array of rates.
+ * @param[in] ppNames Array of the metric names of the rates.
+ * @param[in] pNameLengths Array of the lengths of the metric names.
+ * @param[in] rateCount Number of entries in the above arrays.
+ * @param[in] pBuffer The buffer holding the object.
+ * @param[in] bufferLength The length of the buffer.
+ * @param[in,out] pInOutLength The length of the object in the buffer, 0 for
+ * no object. Set to the length of the object with the rates.
+ *
+ * @return #DefenderSuccess if the rates are added;
+ * #DefenderBadParameter if invalid parameters are passed, or the buffer does
+ * not hold an object;
+ * #DefenderBufferTooSmall if the buffer cannot hold the object;
+ * #DefenderError if a metric name is not valid UTF-8. On errors, the object
+ * given in the buffer is kept and pInOutLength is not changed.
+ */
+/* @[declare_defender_appendrates] */
+DefenderStatus_t Defender_AppendRates( const DefenderRate_t * pRates,
+                                       const char * const * ppNames,
+                                       const uint16_t * pNameLengths,
+                                       uint32_t rateCount,
+                                       char * pBuffer,
+                                       uint32_t bufferLength,
+                                       uint32_t * pInOutLength );
+/* @[declare_defender_appendrates] */
+
+/*-----------------------------------------------------------*/
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* DEFENDER_RATE_H_ */
@@ -0,0 +1,169 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_response.h
+ * @brief Interface for parsing the responses of AWS IoT Device Defender to
+ * JSON reports.
+ *
+ * The service publishes a response on the accepted or rejected topic for every
+ * report it receives, for example:
+ *
+ * @code{.json}
+ * {
+ *     "thingName": "MyThing",
+ *     "reportId": 1530304554,
+ *     "status": "REJECTED",
+ *     "statusDetails": {
+ *         "ErrorCode": "InvalidJson",
+ *         "ErrorMessage": "Report is not valid JSON."
+ *     },
+ *     "timestamp": 1530304555000
+ * }
+ * @endcode
+ *
+ * #Defender_ParseResponse extracts these fields without copying. String fields
+ * point into the payload and are returned as they appear in the payload,
+ * without unescaping.
+ */
+
+#ifndef DEFENDER_RESPONSE_H_
+#define DEFENDER_RESPONSE_H_
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* Defender API include. */
+#include "defender.h"
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+/**
+ * @ingroup defender_enum_types
+ * @brief Status of a report in a response.
+ */
+typedef enum
+{
+    DefenderReportStatusUnknown = 0, /**< The response does not have a known status. */
+    DefenderReportAccepted,          /**< The report was accepted. */
+    DefenderReportRejected           /**< The report was rejected. */
+} DefenderReportStatus_t;
+
+/**
+ * @ingroup defender_struct_types
+ * @brief A parsed response to a report.
+ *
+ * Optional fields which are not present in the response are set to NULL or 0.
+ */
+typedef struct DefenderResponse
+{
+    uint64_t reportId;              /**< The report ID. Always present. */
+    DefenderReportStatus_t status;  /**< The report status. Always present. */
+    const char * pThingName;        /**< The thing name. Optional. */
+    uint16_t thingNameLength;       /**< Length of the thing name. */
+    const char * pErrorCode;        /**< The error code of a rejected report. Optional. */
+    uint32_t errorCodeLength;       /**< Length of the error code. */
+    const char * pErrorMessage;     /**< The error message of a rejected report. Optional. */
+    uint32_t errorMessageLength;    /**< Length of the error message. */
+    uint64_t timestamp;             /**< The time of the response in milliseconds. Optional. */
+} DefenderResponse_t;
+
+/**
+ * @ingroup defender_struct_types
+ * @brief A payload received on a response topic.
+ */
+typedef struct DefenderPayload
+{
+    const char * pPayload;  /**< The payload. */
+    uint32_t payloadLength; /**< Length of the payload. */
+} DefenderPayload_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Parse a response published by the service on a JSON accepted or
+ * rejected topic.
+ *
+ * Unknown keys are skipped, so responses with additional fields are still
+ * parsed.
+ *
+ * @param[in] pPayload The payload of the response.
+ * @param[in] payloadLength The length of the payload.
+ * @param[out] pOutResponse The parsed response.
+ *
+ * @return #DefenderSuccess if the response is parsed;
+ * #DefenderBadParameter if invalid parameters are passed;
+ * #DefenderError if the payload is not valid JSON, is not an object, or does
+ * not have a report ID and a status.
+ */
+/* @[declare_defender_parseresponse] */
+DefenderStatus_t Defender_ParseResponse( const char * pPayload,
+                                         uint32_t payloadLength,
+                                         DefenderResponse_t * pOutResponse );
+/* @[declare_defender_parseresponse] */
+
+/**
+ * @brief Parse many responses, using a structural index of each payload.
+ *
+ * Each payload is first indexed with #Defender_IndexStructurals into
+ * pIndexBuffer, so that strings and skipped values are passed over without
+ * looking at every byte. The results are the same as those of
+ * #Defender_ParseResponse. A payload which cannot be indexed, for example
+ * because pIndexBuffer is too small, is parsed without the index. An index as
+ * long as the longest payload is always large enough.
+ *
+ * @param[in] pPayloads Array of payloads.
+ * @param[in] payloadCount Number of entries in the above array.
+ * @param[in] pIndexBuffer Scratch buffer for the structural index.
+ * @param[in] indexBufferLength Number of entries in pIndexBuffer.
+ * @param[out] pOutResponses Array of payloadCount parsed responses. The
+ * response of a payload which is not parsed has all fields set to 0, so its
+ * status is #DefenderReportStatusUnknown.
+ * @param[out] pOutParsedCount The number of payloads which are parsed.
+ *
+ * @return #DefenderSuccess if all payloads are processed;
+ * #DefenderBadParameter if invalid parameters are passed.
+ */
+/* @[declare_defender_parseresponses] */
+DefenderStatus_t Defender_ParseResponses( const DefenderPayload_t * pPayloads,
+                                          uint32_t payloadCount,
+                                          uint32_t * pIndexBuffer,
+                                          uint32_t indexBufferLength,
+                                          DefenderResponse_t * pOutResponses,
+                                          uint32_t * pOutParsedCount );
+/* @[declare_defender_parseresponses] */
+
+/*-----------------------------------------------------------*/
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* DEFENDER_RESPONSE_H_ */
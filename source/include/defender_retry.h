@@ -0,0 +1,187 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_retry.h
+ * @brief Interface for retrying rejected and timed out reports without
+ * retrying all at once.
+ *
+ * When the service throttles or rejects reports across a fleet, for example
+ * after an outage, devices which retry after a fixed delay all retry at the
+ * same time, and the surge slows the recovery. A retry manager spreads the
+ * retries of the things of a gateway with decorrelated jitter: each delay is
+ * random between the base delay and three times the delay before it, up to a
+ * maximum. It also caps the number of things with a retry outstanding, and
+ * folds a retry into the next scheduled report when that report comes first,
+ * so that a thing never sends both:
+ *
+ * @code{c}
+ * Defender_RetryInit( &retry, pEntries, thingCapacity, 1000U, 60000U, 64U, deviceSeed );
+ *
+ * // When a report is rejected, or its response does not arrive in time:
+ * Defender_RetryOnFailure( &retry, thingId, nowMs, scheduledMs, &deadline );
+ * Defender_ThingStoreEndReport( &store, thingId, reportId, deadline );
+ *
+ * // When a report is accepted:
+ * Defender_RetryOnSuccess( &retry, thingId );
+ * Defender_ThingStoreEndReport( &store, thingId, reportId, scheduledMs );
+ * @endcode
+ *
+ * The deadline is either the time of the retry or the scheduled time of the
+ * next report, whichever the manager picks; in both cases the report built
+ * then has the latest metrics. Entries are indexed by thing ID, the same as
+ * the entries of a thing store.
+ */
+
+#ifndef DEFENDER_RETRY_H_
+#define DEFENDER_RETRY_H_
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* Defender API include. */
+#include "defender.h"
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+/**
+ * @ingroup defender_struct_types
+ * @brief The retry state of one thing.
+ */
+typedef struct DefenderRetryEntry
+{
+    uint32_t lastDelayMs; /**< @brief The last delay, or 0 if the last report was accepted. */
+    uint32_t pending;     /**< @brief 1 if a retry is outstanding, 0 otherwise. */
+} DefenderRetryEntry_t;
+
+/**
+ * @ingroup defender_struct_types
+ * @brief A retry manager.
+ *
+ * @note The fields are set by #Defender_RetryInit. The entries are not owned
+ * by the manager, and must stay valid as long as the manager is used.
+ */
+typedef struct DefenderRetryManager
+{
+    DefenderRetryEntry_t * pEntries; /**< @brief Retry state, indexed by thing ID. */
+    uint32_t entryCount;             /**< @brief Number of entries. */
+    uint32_t baseDelayMs;            /**< @brief Shortest delay of a retry. */
+    uint32_t maxDelayMs;             /**< @brief Longest delay of a retry. */
+    uint32_t maxOutstanding;         /**< @brief Largest number of things with a retry outstanding. */
+    uint32_t outstanding;            /**< @brief Number of things with a retry outstanding. */
+    uint64_t randomState;            /**< @brief State of the random number generator of the delays. */
+} DefenderRetryManager_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Initialize a retry manager with no retry outstanding.
+ *
+ * @param[out] pManager The retry manager.
+ * @param[in] pEntries Array of entries, one per thing ID. It is cleared.
+ * @param[in] entryCount Number of entries in pEntries.
+ * @param[in] baseDelayMs The shortest delay of a retry, in milliseconds.
+ * @param[in] maxDelayMs The longest delay of a retry, in milliseconds, not
+ * less than baseDelayMs.
+ * @param[in] maxOutstanding The largest number of things with a retry
+ * outstanding. The reports of other things wait for their next scheduled
+ * report.
+ * @param[in] seed Seed of the delays. Use a different seed on each device, for
+ * example from its serial number, so that devices do not retry together.
+ *
+ * @return #DefenderSuccess if the manager is initialized;
+ * #DefenderBadParameter if invalid parameters are passed.
+ */
+/* @[declare_defender_retryinit] */
+DefenderStatus_t Defender_RetryInit( DefenderRetryManager_t * pManager,
+                                     DefenderRetryEntry_t * pEntries,
+                                     uint32_t entryCount,
+                                     uint32_t baseDelayMs,
+                                     uint32_t maxDelayMs,
+                                     uint32_t maxOutstanding,
+                                     uint64_t seed );
+/* @[declare_defender_retryinit] */
+
+/**
+ * @brief Pick when a thing reports again after its report was rejected or
+ * timed out.
+ *
+ * The delay is drawn with decorrelated jitter from the last delay of the
+ * thing. The retry is merged into the next scheduled report when it would
+ * not be earlier, or when the number of outstanding retries is at the cap.
+ * A thing whose retry also failed keeps its outstanding retry, with a longer
+ * delay.
+ *
+ * @param[in] pManager The retry manager.
+ * @param[in] thingId The ID of the thing.
+ * @param[in] nowMs The current time, in milliseconds.
+ * @param[in] scheduledMs The time of the next scheduled report of the thing,
+ * in milliseconds.
+ * @param[out] pOutDeadline The time of the next report of the thing.
+ *
+ * @return #DefenderSuccess if a retry is scheduled before the next scheduled
+ * report;
+ * #DefenderNoMatch if the retry is merged into the next scheduled report, and
+ * pOutDeadline is scheduledMs;
+ * #DefenderBadParameter if invalid parameters are passed.
+ */
+/* @[declare_defender_retryonfailure] */
+DefenderStatus_t Defender_RetryOnFailure( DefenderRetryManager_t * pManager,
+                                          uint32_t thingId,
+                                          uint64_t nowMs,
+                                          uint64_t scheduledMs,
+                                          uint64_t * pOutDeadline );
+/* @[declare_defender_retryonfailure] */
+
+/**
+ * @brief Record that a report of a thing was accepted, or that the thing was
+ * removed.
+ *
+ * The outstanding retry of the thing, if any, ends, and its next failure
+ * starts again from the base delay.
+ *
+ * @param[in] pManager The retry manager.
+ * @param[in] thingId The ID of the thing.
+ *
+ * @return #DefenderSuccess if the state of the thing is reset;
+ * #DefenderBadParameter if invalid parameters are passed.
+ */
+/* @[declare_defender_retryonsuccess] */
+DefenderStatus_t Defender_RetryOnSuccess( DefenderRetryManager_t * pManager,
+                                          uint32_t thingId );
+/* @[declare_defender_retryonsuccess] */
+
+/*-----------------------------------------------------------*/
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* DEFENDER_RETRY_H_ */
@@ -0,0 +1,164 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_slab.h
+ * @brief Interface for a pool of fixed size objects, such as the contexts of
+ * the things of a gateway.
+ *
+ * A gateway whose things come and go allocates and frees a context for every
+ * thing. A slab carves the contexts out of one block of memory, so adding and
+ * removing things never calls the general purpose allocator and never
+ * fragments its heap:
+ *
+ * @code{c}
+ * typedef struct ThingContext
+ * {
+ *     char thingName[ DEFENDER_THINGNAME_MAX_LENGTH ];
+ *     char publishTopic[ DEFENDER_API_MAX_LENGTH( DEFENDER_THINGNAME_MAX_LENGTH ) ];
+ *     uint64_t deadline;
+ * } ThingContext_t;
+ *
+ * Defender_SlabInit( &slab, pMemory, memoryLength, sizeof( ThingContext_t ) );
+ *
+ * // When a thing joins:
+ * Defender_SlabAlloc( &slab, &pObject );
+ * // When it leaves:
+ * Defender_SlabFree( &slab, pObject );
+ * @endcode
+ *
+ * Objects start on a multiple of #DEFENDER_SLAB_ALIGNMENT bytes, so no two
+ * objects share a cache line. Both functions take constant time: freed
+ * objects are kept in a list threaded through the objects themselves, and
+ * objects which were never used are taken in order. Initializing a slab does
+ * not write to its memory, so memory from mmap, including huge pages with
+ * MAP_HUGETLB, is only touched as objects are used.
+ */
+
+#ifndef DEFENDER_SLAB_H_
+#define DEFENDER_SLAB_H_
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* Defender API include. */
+#include "defender.h"
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+/**
+ * @ingroup defender_constants
+ * @brief Alignment of the objects of a slab: the length of a cache line.
+ */
+#define DEFENDER_SLAB_ALIGNMENT    64U
+
+/**
+ * @ingroup defender_struct_types
+ * @brief A slab of objects.
+ *
+ * @note The fields are set by #Defender_SlabInit. The memory is not owned by
+ * the slab, and must stay valid as long as the slab is used.
+ */
+typedef struct DefenderSlab
+{
+    uint8_t * pObjects;    /**< @brief The first object. */
+    uint32_t objectLength; /**< @brief Length of an object, rounded up to #DEFENDER_SLAB_ALIGNMENT. */
+    uint32_t objectCount;  /**< @brief Number of objects. */
+    uint32_t usedCount;    /**< @brief Number of allocated objects. */
+    uint32_t freshIndex;   /**< @brief Objects from this index were never allocated. */
+    uint32_t freeIndex;    /**< @brief The first freed object, or UINT32_MAX. */
+} DefenderSlab_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Initialize a slab in a block of memory.
+ *
+ * @param[out] pSlab The slab.
+ * @param[in] pMemory The memory of the objects. Up to
+ * #DEFENDER_SLAB_ALIGNMENT - 1 bytes at its start are skipped to align the
+ * first object.
+ * @param[in] memoryLength The length of the memory.
+ * @param[in] objectLength The length of an object.
+ *
+ * @return #DefenderSuccess if the slab is initialized;
+ * #DefenderBadParameter if invalid parameters are passed;
+ * #DefenderBufferTooSmall if the memory cannot hold one object.
+ */
+/* @[declare_defender_slabinit] */
+DefenderStatus_t Defender_SlabInit( DefenderSlab_t * pSlab,
+                                    uint8_t * pMemory,
+                                    uint32_t memoryLength,
+                                    uint32_t objectLength );
+/* @[declare_defender_slabinit] */
+
+/**
+ * @brief Allocate an object from a slab.
+ *
+ * The content of the object is not initialized. The object most recently
+ * freed is allocated first, since its memory is the most likely to be in the
+ * cache.
+ *
+ * @param[in] pSlab The slab.
+ * @param[out] ppOutObject The object.
+ *
+ * @return #DefenderSuccess if an object is allocated;
+ * #DefenderBadParameter if invalid parameters are passed;
+ * #DefenderBufferTooSmall if all objects are allocated.
+ */
+/* @[declare_defender_slaballoc] */
+DefenderStatus_t Defender_SlabAlloc( DefenderSlab_t * pSlab,
+                                     void ** ppOutObject );
+/* @[declare_defender_slaballoc] */
+
+/**
+ * @brief Return an object to its slab.
+ *
+ * An object must not be freed twice.
+ *
+ * @param[in] pSlab The slab.
+ * @param[in] pObject The object.
+ *
+ * @return #DefenderSuccess if the object is freed;
+ * #DefenderBadParameter if invalid parameters are passed, including a pointer
+ * which is not the start of an allocated object of the slab.
+ */
+/* @[declare_defender_slabfree] */
+DefenderStatus_t Defender_SlabFree( DefenderSlab_t * pSlab,
+                                    void * pObject );
+/* @[declare_defender_slabfree] */
+
+/*-----------------------------------------------------------*/
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* DEFENDER_SLAB_H_ */
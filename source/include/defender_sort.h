@@ -0,0 +1,178 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_sort.h
+ * @brief Interface for putting the lists of a report in a canonical order.
+ *
+ * Network stacks return ports and connections in an order which changes from
+ * one call to the next, so two reports of the same state can differ byte by
+ * byte. Sorting every list before serializing a report makes the same state
+ * always produce the same bytes, so reports can be hashed, cached and
+ * compared.
+ *
+ * The lists are sorted with a least significant digit radix sort over bytes.
+ * It takes one pass over the list per byte of the values, never compares
+ * values, and reads and writes memory sequentially. Passes over a byte which
+ * is the same for all values, such as the high byte of a list of small
+ * ports, are skipped. The sorts use a scratch array of the same size as the
+ * list, which can be taken from the buffer the report is built in, and 1.3 KB
+ * of stack.
+ *
+ * Use #Defender_ConnectionTableSort for the established connections.
+ */
+
+#ifndef DEFENDER_SORT_H_
+#define DEFENDER_SORT_H_
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* Defender API include. */
+#include "defender.h"
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Sort a list of ports in ascending order.
+ *
+ * Use it for the values of #DEFENDER_REPORT_TCP_LISTENING_PORTS_KEY and
+ * #DEFENDER_REPORT_UDP_LISTENING_PORTS_KEY.
+ *
+ * @param[in,out] pPorts The ports.
+ * @param[in] pScratch Scratch array of count entries. Its contents are
+ * overwritten.
+ * @param[in] count Number of ports.
+ *
+ * @return #DefenderSuccess if the ports are sorted;
+ * #DefenderBadParameter if invalid parameters are passed.
+ */
+/* @[declare_defender_sortports] */
+DefenderStatus_t Defender_SortPorts( uint16_t * pPorts,
+                                     uint16_t * pScratch,
+                                     uint32_t count );
+/* @[declare_defender_sortports] */
+
+/**
+ * @brief Sort a list of IPv4 addresses in ascending order.
+ *
+ * Use it for the values of a #DEFENDER_REPORT_IP_LIST_KEY custom metric.
+ * a.b.c.d is stored as ( a << 24 ) | ( b << 16 ) | ( c << 8 ) | d.
+ *
+ * @param[in,out] pAddresses The addresses.
+ * @param[in] pScratch Scratch array of count entries. Its contents are
+ * overwritten.
+ * @param[in] count Number of addresses.
+ *
+ * @return #DefenderSuccess if the addresses are sorted;
+ * #DefenderBadParameter if invalid parameters are passed.
+ */
+/* @[declare_defender_sortaddresses] */
+DefenderStatus_t Defender_SortAddresses( uint32_t * pAddresses,
+                                         uint32_t * pScratch,
+                                         uint32_t count );
+/* @[declare_defender_sortaddresses] */
+
+/**
+ * @brief Sort a list of numbers in ascending order.
+ *
+ * Use it for the values of a #DEFENDER_REPORT_NUMBER_LIST_KEY custom metric.
+ *
+ * @param[in,out] pNumbers The numbers.
+ * @param[in] pScratch Scratch array of count entries. Its contents are
+ * overwritten.
+ * @param[in] count Number of numbers.
+ *
+ * @return #DefenderSuccess if the numbers are sorted;
+ * #DefenderBadParameter if invalid parameters are passed.
+ */
+/* @[declare_defender_sortnumbers] */
+DefenderStatus_t Defender_SortNumbers( uint64_t * pNumbers,
+                                       uint64_t * pScratch,
+                                       uint32_t count );
+/* @[declare_defender_sortnumbers] */
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Get a byte of the sort key of a block of values of a list for
+ * #Defender_RadixSort.
+ *
+ * Pass 0 takes the least significant byte of the key.
+ */
+typedef void ( * DefenderRadixDigits_t )( const void * pList,
+                                          uint32_t start,
+                                          uint32_t length,
+                                          uint32_t pass,
+                                          uint8_t * pDigits );
+
+/**
+ * @brief Copy a block of values of a list to the given indices of another
+ * list of the same type for #Defender_RadixSort.
+ */
+typedef void ( * DefenderRadixMove_t )( const void * pSource,
+                                        uint32_t start,
+                                        uint32_t length,
+                                        void * pDestination,
+                                        const uint32_t * pIndices );
+
+/**
+ * @brief Radix sort a list of any type in ascending order of a key.
+ *
+ * The sorts above and #Defender_ConnectionTableSort are built on it. The
+ * list is handed to getDigits and move in blocks of values, so the type of
+ * the list costs one call per block. It is used by the library itself and is
+ * not meant to be called by applications.
+ *
+ * @param[in] pList The list.
+ * @param[in] pScratch A list of the same type with room for count values.
+ * @param[in] count Number of values.
+ * @param[in] keyWidth Number of bytes of the key, which is one pass each.
+ * @param[in] getDigits Gets a byte of the key of a block of values.
+ * @param[in] move Copies a block of values from one list to the other.
+ *
+ * @return pList or pScratch, whichever holds the sorted values.
+ */
+void * Defender_RadixSort( void * pList,
+                           void * pScratch,
+                           uint32_t count,
+                           uint32_t keyWidth,
+                           DefenderRadixDigits_t getDigits,
+                           DefenderRadixMove_t move );
+
+/*-----------------------------------------------------------*/
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* DEFENDER_SORT_H_ */
@@ -0,0 +1,338 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_thing_store.h
+ * @brief Interface for keeping the state of every thing of a gateway, split
+ * into the fields used on every pass and the fields used rarely.
+ *
+ * A gateway reporting for many things looks at the deadline of every thing
+ * each time it schedules reports, and at the report in flight of one thing
+ * each time a response arrives. The names of the things are only needed to
+ * build topics and reports. A thing store keeps the deadlines and flags in a
+ * dense array of 16 byte hot entries, four to a cache line, and the names and
+ * report details in a separate array of cold entries, both indexed by the
+ * thing ID:
+ *
+ * @code{c}
+ * // When a thing joins the gateway:
+ * Defender_ThingStoreAdd( &store, pThingName, thingNameLength, &thingId );
+ * store.pHot[ thingId ].deadline = nowMs;
+ *
+ * // When scheduling reports:
+ * for( thingId = 0; Defender_ThingStoreNextDue( &store, nowMs, thingId, &thingId ) == DefenderSuccess; thingId++ )
+ * {
+ *     // Build and publish the report, then:
+ *     Defender_ThingStoreBeginReport( &store, thingId, reportId, reportHash );
+ * }
+ *
+ * // When a response arrives:
+ * Defender_MatchTopic( pTopic, topicLength, &api, &pThingName, &thingNameLength );
+ * Defender_ThingStoreFind( &store, pThingName, thingNameLength, &thingId );
+ * Defender_ThingStoreEndReport( &store, thingId, response.reportId, nowMs + periodMs );
+ * @endcode
+ *
+ * Thing IDs stay the same while a thing is in the store, and the IDs of
+ * removed things are given to the next things added, so the hot entries stay
+ * dense. Names are found with an open addressing hash index of slots, which
+ * keeps the hash of each name so that a lookup reads one cold entry. The
+ * topics of a thing are built from its name with #Defender_GetTopic. All
+ * memory is provided by the application.
+ *
+ * Fleets whose thing names are a fixed prefix and a fixed number of digits,
+ * such as "sensor-00012345", can skip the hash index with
+ * #Defender_ThingStoreSetDense: the digits of such a name are parsed into an
+ * index of an array of thing IDs, so finding the thing of a response reads
+ * neither the slots nor the cold entries. Other names still use the hash
+ * index.
+ */
+
+#ifndef DEFENDER_THING_STORE_H_
+#define DEFENDER_THING_STORE_H_
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* Defender API include. */
+#include "defender.h"
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+/**
+ * @ingroup defender_constants
+ * @brief Flag of a hot entry which holds a thing.
+ */
+#define DEFENDER_THING_FLAG_USED         0x1U
+
+/**
+ * @ingroup defender_constants
+ * @brief Flag of a hot entry whose thing has a report waiting for a
+ * response.
+ */
+#define DEFENDER_THING_FLAG_IN_FLIGHT    0x2U
+
+/**
+ * @ingroup defender_struct_types
+ * @brief The fields of a thing used on every scheduling pass.
+ */
+typedef struct DefenderThingHot
+{
+    uint64_t deadline; /**< @brief Time of the next report, in milliseconds. Set by the application. */
+    uint32_t thingId;  /**< @brief ID of the thing. In a free entry, the ID of the next free entry. */
+    uint32_t flags;    /**< @brief #DEFENDER_THING_FLAG_USED and #DEFENDER_THING_FLAG_IN_FLIGHT. */
+} DefenderThingHot_t;
+
+/**
+ * @ingroup defender_struct_types
+ * @brief The fields of a thing used rarely.
+ */
+typedef struct DefenderThingCold
+{
+    uint64_t reportId;                                 /**< @brief ID of the report in flight, or of the last report. */
+    uint64_t reportHash;                               /**< @brief Hash of that report, given by the application. */
+    uint16_t thingNameLength;                          /**< @brief Length of the thing name. */
+    char thingName[ DEFENDER_THINGNAME_MAX_LENGTH ];   /**< @brief The thing name. */
+} DefenderThingCold_t;
+
+/**
+ * @ingroup defender_struct_types
+ * @brief A thing store.
+ *
+ * @note The fields are set by #Defender_ThingStoreInit. The application may
+ * read the entries of things in the store, and set their deadlines, but must
+ * change the rest only through the functions of the store.
+ */
+typedef struct DefenderThingStore
+{
+    DefenderThingHot_t * pHot;   /**< @brief Hot entries, indexed by thing ID. */
+    DefenderThingCold_t * pCold; /**< @brief Cold entries, indexed by thing ID. */
+    uint64_t * pSlots;           /**< @brief Index of the names: the hash of a name, and its thing ID plus one. */
+    uint32_t capacity;           /**< @brief Number of entries in pHot and pCold. */
+    uint32_t slotCount;          /**< @brief Number of slots, a power of two larger than capacity. */
+    uint32_t count;              /**< @brief Number of things in the store. */
+    uint32_t idCount;            /**< @brief Thing IDs below this have been used. Scans stop here. */
+    uint32_t freeId;             /**< @brief The first free thing ID below idCount, or UINT32_MAX. */
+    const char * pDensePrefix;   /**< @brief Prefix of the names of the dense array, or NULL. */
+    uint32_t * pDenseIds;        /**< @brief Thing ID plus one of each number, or 0. */
+    uint32_t denseCount;         /**< @brief Number of entries in pDenseIds. */
+    uint16_t densePrefixLength;  /**< @brief Length of the prefix. */
+    uint16_t denseDigitCount;    /**< @brief Number of digits after the prefix. */
+} DefenderThingStore_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Initialize an empty thing store.
+ *
+ * @param[out] pStore The thing store.
+ * @param[in] pHot Array of capacity hot entries.
+ * @param[in] pCold Array of capacity cold entries.
+ * @param[in] capacity The maximum number of things.
+ * @param[in] pSlots Array of slotCount slots.
+ * @param[in] slotCount Number of slots, a power of two larger than capacity.
+ * Twice the capacity keeps lookups short.
+ *
+ * @return #DefenderSuccess if the store is initialized;
+ * #DefenderBadParameter if invalid parameters are passed.
+ */
+/* @[declare_defender_thingstoreinit] */
+DefenderStatus_t Defender_ThingStoreInit( DefenderThingStore_t * pStore,
+                                          DefenderThingHot_t * pHot,
+                                          DefenderThingCold_t * pCold,
+                                          uint32_t capacity,
+                                          uint64_t * pSlots,
+                                          uint32_t slotCount );
+/* @[declare_defender_thingstoreinit] */
+
+/**
+ * @brief Find the things whose names are a prefix and a number in an array
+ * instead of the hash index.
+ *
+ * A name is in the dense array when it is the prefix followed by exactly
+ * digitCount decimal digits, and the number they make is below denseCount.
+ * For example, with the prefix "sensor-", 8 digits and a dense count of
+ * 1000000, "sensor-00012345" is found at index 12345, while "sensor-12345"
+ * and "sensor-01000000" are found with the hash index. The fixed number of
+ * digits gives every number a single name.
+ *
+ * @param[in] pStore The thing store. It must be empty.
+ * @param[in] pPrefix The prefix, which must stay valid as long as the store
+ * is used. It may be empty.
+ * @param[in] prefixLength The length of the prefix.
+ * @param[in] digitCount The number of digits after the prefix, from 1 to 9.
+ * @param[in] pDenseIds Array of denseCount entries, one per number.
+ * @param[in] denseCount The number of entries in pDenseIds.
+ *
+ * @return #DefenderSuccess if the dense array is set;
+ * #DefenderBadParameter if invalid parameters are passed, including names
+ * longer than #DEFENDER_THINGNAME_MAX_LENGTH;
+ * #DefenderError if the store is not empty.
+ */
+/* @[declare_defender_thingstoresetdense] */
+DefenderStatus_t Defender_ThingStoreSetDense( DefenderThingStore_t * pStore,
+                                              const char * pPrefix,
+                                              uint16_t prefixLength,
+                                              uint16_t digitCount,
+                                              uint32_t * pDenseIds,
+                                              uint32_t denseCount );
+/* @[declare_defender_thingstoresetdense] */
+
+/**
+ * @brief Add a thing to a thing store.
+ *
+ * A new thing has a deadline of 0, so it is due at once, and no report in
+ * flight. Adding a thing which is already in the store returns its ID and
+ * changes nothing.
+ *
+ * @param[in] pStore The thing store.
+ * @param[in] pThingName The thing name.
+ * @param[in] thingNameLength The length of the thing name.
+ * @param[out] pOutThingId The ID of the thing.
+ *
+ * @return #DefenderSuccess if the thing is in the store;
+ * #DefenderBadParameter if invalid parameters are passed, including an empty
+ * thing name or one longer than #DEFENDER_THINGNAME_MAX_LENGTH;
+ * #DefenderBufferTooSmall if the store is full.
+ */
+/* @[declare_defender_thingstoreadd] */
+DefenderStatus_t Defender_ThingStoreAdd( DefenderThingStore_t * pStore,
+                                         const char * pThingName,
+                                         uint16_t thingNameLength,
+                                         uint32_t * pOutThingId );
+/* @[declare_defender_thingstoreadd] */
+
+/**
+ * @brief Find the ID of a thing, for example from the thing name returned by
+ * #Defender_MatchTopic.
+ *
+ * @param[in] pStore The thing store.
+ * @param[in] pThingName The thing name.
+ * @param[in] thingNameLength The length of the thing name.
+ * @param[out] pOutThingId The ID of the thing.
+ *
+ * @return #DefenderSuccess if the thing is found;
+ * #DefenderNoMatch if the thing is not in the store;
+ * #DefenderBadParameter if invalid parameters are passed.
+ */
+/* @[declare_defender_thingstorefind] */
+DefenderStatus_t Defender_ThingStoreFind( const DefenderThingStore_t * pStore,
+                                          const char * pThingName,
+                                          uint16_t thingNameLength,
+                                          uint32_t * pOutThingId );
+/* @[declare_defender_thingstorefind] */
+
+/**
+ * @brief Remove a thing from a thing store. Its ID is given to a later
+ * thing.
+ *
+ * @param[in] pStore The thing store.
+ * @param[in] thingId The ID of the thing.
+ *
+ * @return #DefenderSuccess if the thing is removed;
+ * #DefenderBadParameter if invalid parameters are passed;
+ * #DefenderError if no thing has this ID.
+ */
+/* @[declare_defender_thingstoreremove] */
+DefenderStatus_t Defender_ThingStoreRemove( DefenderThingStore_t * pStore,
+                                            uint32_t thingId );
+/* @[declare_defender_thingstoreremove] */
+
+/**
+ * @brief Find the next thing whose report is due.
+ *
+ * Only the hot entries are read. A thing is due when its deadline is not
+ * later than the current time and it has no report in flight.
+ *
+ * @param[in] pStore The thing store.
+ * @param[in] nowMs The current time, in milliseconds.
+ * @param[in] startId The first thing ID to look at.
+ * @param[out] pOutThingId The ID of the first due thing from startId.
+ *
+ * @return #DefenderSuccess if a due thing is found;
+ * #DefenderNoMatch if no thing from startId is due;
+ * #DefenderBadParameter if invalid parameters are passed.
+ */
+/* @[declare_defender_thingstorenextdue] */
+DefenderStatus_t Defender_ThingStoreNextDue( const DefenderThingStore_t * pStore,
+                                             uint64_t nowMs,
+                                             uint32_t startId,
+                                             uint32_t * pOutThingId );
+/* @[declare_defender_thingstorenextdue] */
+
+/**
+ * @brief Record that a report of a thing was published and waits for a
+ * response.
+ *
+ * @param[in] pStore The thing store.
+ * @param[in] thingId The ID of the thing.
+ * @param[in] reportId The ID of the report.
+ * @param[in] reportHash A hash of the report, kept for the application, for
+ * example to skip reports which did not change.
+ *
+ * @return #DefenderSuccess if the report is recorded;
+ * #DefenderBadParameter if invalid parameters are passed;
+ * #DefenderError if no thing has this ID.
+ */
+/* @[declare_defender_thingstorebeginreport] */
+DefenderStatus_t Defender_ThingStoreBeginReport( DefenderThingStore_t * pStore,
+                                                 uint32_t thingId,
+                                                 uint64_t reportId,
+                                                 uint64_t reportHash );
+/* @[declare_defender_thingstorebeginreport] */
+
+/**
+ * @brief Record the response to the report in flight of a thing, or its
+ * timeout, and set the deadline of the next report.
+ *
+ * @param[in] pStore The thing store.
+ * @param[in] thingId The ID of the thing.
+ * @param[in] reportId The report ID of the response.
+ * @param[in] nextDeadline The time of the next report, in milliseconds.
+ *
+ * @return #DefenderSuccess if the report was in flight;
+ * #DefenderNoMatch if the thing has no report in flight with this ID, for
+ * example because the response is late. Nothing is changed;
+ * #DefenderBadParameter if invalid parameters are passed;
+ * #DefenderError if no thing has this ID.
+ */
+/* @[declare_defender_thingstoreendreport] */
+DefenderStatus_t Defender_ThingStoreEndReport( DefenderThingStore_t * pStore,
+                                               uint32_t thingId,
+                                               uint64_t reportId,
+                                               uint64_t nextDeadline );
+/* @[declare_defender_thingstoreendreport] */
+
+/*-----------------------------------------------------------*/
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* DEFENDER_THING_STORE_H_ */
@@ -0,0 +1,221 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_topic_table.h
+ * @brief Interface for the precomputed Device Defender topic table.
+ *
+ * A topic table holds all six Device Defender topic strings for a fleet of
+ * things in a single, position independent binary image. The image is built
+ * once (for example, offline with the tool in tools/fleet) and then used in
+ * place, without any parsing or copying, from whatever memory the application
+ * puts it in: a read-only mapping of a file, a flash partition or a static
+ * array.
+ *
+ * The binary layout is (all integers are little endian):
+ *
+ *     +--------------------------------------------------+
+ *     | Header: magic "DDTT", version, thing count,      |
+ *     |         string pool length (4 x uint32)          |
+ *     +--------------------------------------------------+
+ *     | Entry 0 .. Entry N-1, sorted by thing name:      |
+ *     |   uint16 thing name length, uint16 reserved,     |
+ *     |   uint32 pool offset for each DefenderTopic_t    |
+ *     +--------------------------------------------------+
+ *     | String pool with the topic strings               |
+ *     +--------------------------------------------------+
+ */
+
+#ifndef DEFENDER_TOPIC_TABLE_H_
+#define DEFENDER_TOPIC_TABLE_H_
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* Defender API include. */
+#include "defender.h"
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+/**
+ * @ingroup defender_constants
+ * @brief Version of the topic table binary layout.
+ */
+#define DEFENDER_TOPIC_TABLE_VERSION          1U
+
+/**
+ * @ingroup defender_constants
+ * @brief Length of the topic table header in bytes.
+ */
+#define DEFENDER_TOPIC_TABLE_HEADER_LENGTH    16U
+
+/**
+ * @ingroup defender_constants
+ * @brief Length of one topic table entry in bytes.
+ */
+#define DEFENDER_TOPIC_TABLE_ENTRY_LENGTH     ( 4U + ( 4U * ( uint32_t ) DefenderMaxTopic ) )
+
+/**
+ * @ingroup defender_struct_types
+ * @brief A loaded topic table.
+ *
+ * @note The fields are set by #Defender_TopicTableInit and point into the
+ * memory which holds the table image. That memory must remain valid, and
+ * unchanged, for as long as the table is used.
+ */
+typedef struct DefenderTopicTable
+{
+    const uint8_t * pEntries; /**< @brief Start of the sorted entry array. */
+    const uint8_t * pPool;    /**< @brief Start of the string pool. */
+    uint32_t thingCount;      /**< @brief Number of things in the table. */
+    uint32_t poolLength;      /**< @brief Length of the string pool in bytes. */
+} DefenderTopicTable_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Calculate the size of the topic table image for a list of things.
+ *
+ * @param[in] ppThingNames Array of thing names.
+ * @param[in] pThingNameLengths Array of thing name lengths.
+ * @param[in] thingCount Number of entries in the above arrays.
+ * @param[out] pOutLength The size of the topic table image in bytes.
+ *
+ * @return #DefenderSuccess if the size is calculated;
+ * #DefenderBadParameter if invalid parameters are passed or the image would
+ * not fit in 32 bits.
+ */
+/* @[declare_defender_topictablegetsize] */
+DefenderStatus_t Defender_TopicTableGetSize( const char * const * ppThingNames,
+                                             const uint16_t * pThingNameLengths,
+                                             uint32_t thingCount,
+                                             uint32_t * pOutLength );
+/* @[declare_defender_topictablegetsize] */
+
+/**
+ * @brief Build the topic table image for a list of things.
+ *
+ * The thing names must be sorted in strictly ascending order, comparing bytes
+ * as unsigned values and placing a name before any longer name it is a prefix
+ * of. Building does not sort because it uses no memory apart from the output
+ * buffer.
+ *
+ * @param[in] pBuffer The buffer to write the topic table image into.
+ * @param[in] bufferLength The length of the buffer.
+ * @param[in] ppThingNames Array of sorted thing names.
+ * @param[in] pThingNameLengths Array of thing name lengths.
+ * @param[in] thingCount Number of entries in the above arrays.
+ * @param[out] pOutLength The length of the image written to the buffer.
+ *
+ * @return #DefenderSuccess if the image is written to the buffer;
+ * #DefenderBadParameter if invalid parameters are passed or the thing names
+ * are not sorted; #DefenderBufferTooSmall if the buffer cannot hold the image.
+ */
+/* @[declare_defender_topictablebuild] */
+DefenderStatus_t Defender_TopicTableBuild( uint8_t * pBuffer,
+                                           uint32_t bufferLength,
+                                           const char * const * ppThingNames,
+                                           const uint16_t * pThingNameLengths,
+                                           uint32_t thingCount,
+                                           uint32_t * pOutLength );
+/* @[declare_defender_topictablebuild] */
+
+/**
+ * @brief Load a topic table image.
+ *
+ * Only the header is validated, so loading takes the same time regardless of
+ * the number of things in the table. Entries are bounds checked when they are
+ * accessed.
+ *
+ * @param[out] pTable The topic table to initialize.
+ * @param[in] pBuffer The topic table image.
+ * @param[in] bufferLength The length of the topic table image.
+ *
+ * @return #DefenderSuccess if the table is loaded;
+ * #DefenderBadParameter if invalid parameters are passed or the image header
+ * is not valid.
+ */
+/* @[declare_defender_topictableinit] */
+DefenderStatus_t Defender_TopicTableInit( DefenderTopicTable_t * pTable,
+                                          const uint8_t * pBuffer,
+                                          uint32_t bufferLength );
+/* @[declare_defender_topictableinit] */
+
+/**
+ * @brief Find the index of a thing in a topic table.
+ *
+ * @param[in] pTable The topic table.
+ * @param[in] pThingName The thing name to find.
+ * @param[in] thingNameLength The length of the thing name.
+ * @param[out] pOutIndex The index of the thing in the table.
+ *
+ * @return #DefenderSuccess if the thing is found;
+ * #DefenderNoMatch if the thing is not in the table;
+ * #DefenderBadParameter if invalid parameters are passed;
+ * #DefenderError if a table entry on the search path is corrupt.
+ */
+/* @[declare_defender_topictablefind] */
+DefenderStatus_t Defender_TopicTableFind( const DefenderTopicTable_t * pTable,
+                                          const char * pThingName,
+                                          uint16_t thingNameLength,
+                                          uint32_t * pOutIndex );
+/* @[declare_defender_topictablefind] */
+
+/**
+ * @brief Get a topic string from a topic table.
+ *
+ * The returned topic string points into the table image and is not NULL
+ * terminated.
+ *
+ * @param[in] pTable The topic table.
+ * @param[in] index The index of the thing, less than the thing count.
+ * @param[in] api The desired Device Defender API.
+ * @param[out] ppOutTopic The topic string.
+ * @param[out] pOutTopicLength The length of the topic string.
+ *
+ * @return #DefenderSuccess if the topic is found;
+ * #DefenderBadParameter if invalid parameters are passed;
+ * #DefenderError if the table entry is corrupt.
+ */
+/* @[declare_defender_topictablegettopic] */
+DefenderStatus_t Defender_TopicTableGetTopic( const DefenderTopicTable_t * pTable,
+                                              uint32_t index,
+                                              DefenderTopic_t api,
+                                              const char ** ppOutTopic,
+                                              uint16_t * pOutTopicLength );
+/* @[declare_defender_topictablegettopic] */
+
+/*-----------------------------------------------------------*/
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* DEFENDER_TOPIC_TABLE_H_ */
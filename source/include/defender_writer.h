@@ -0,0 +1,162 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_writer.h
+ * @brief Internal interface for writing JSON reports into a buffer.
+ *
+ * The serializers of the library write their output through a
+ * #DefenderWriter_t. Every write is checked against the end of the buffer,
+ * and the first write which fails sets the status of the writer, after
+ * which the other writes do nothing. A serializer therefore checks the
+ * status once, at the end, instead of after every write.
+ *
+ * These functions are used by the library itself and are not meant to be
+ * called by applications.
+ */
+
+#ifndef DEFENDER_WRITER_H_
+#define DEFENDER_WRITER_H_
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* Defender API include. */
+#include "defender.h"
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+/**
+ * @ingroup defender_struct_types
+ * @brief State of a serializer writing into a buffer.
+ */
+typedef struct DefenderWriter
+{
+    char * pBuffer;          /**< @brief The output buffer. */
+    uint32_t bufferLength;   /**< @brief Length of the output buffer. */
+    uint32_t length;         /**< @brief Number of bytes written. */
+    DefenderStatus_t status; /**< @brief The error of the first write which fails. */
+} DefenderWriter_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Start writing at the beginning of a buffer.
+ *
+ * @param[out] pWriter The writer.
+ * @param[in] pBuffer The output buffer.
+ * @param[in] bufferLength The length of the buffer.
+ */
+void Defender_WriterInit( DefenderWriter_t * pWriter,
+                          char * pBuffer,
+                          uint32_t bufferLength );
+
+/**
+ * @brief Append bytes to the output.
+ *
+ * @param[in] pWriter The writer.
+ * @param[in] pBytes The bytes.
+ * @param[in] length The number of bytes.
+ */
+void Defender_WriteBytes( DefenderWriter_t * pWriter,
+                          const char * pBytes,
+                          uint32_t length );
+
+/**
+ * @brief Append a string to the output, escaped with #Defender_EscapeString.
+ *
+ * A string which is not valid UTF-8 sets the status to #DefenderError.
+ *
+ * @param[in] pWriter The writer.
+ * @param[in] pString The string.
+ * @param[in] length The length of the string.
+ */
+void Defender_WriteEscaped( DefenderWriter_t * pWriter,
+                            const char * pString,
+                            uint32_t length );
+
+/**
+ * @brief Append a number in decimal to the output.
+ *
+ * @param[in] pWriter The writer.
+ * @param[in] value The number.
+ */
+void Defender_WriteDecimal( DefenderWriter_t * pWriter,
+                            uint64_t value );
+
+/**
+ * @brief Append an IPv4 address in dotted decimal to the output.
+ *
+ * @param[in] pWriter The writer.
+ * @param[in] address The address a.b.c.d, stored as
+ * ( a << 24 ) | ( b << 16 ) | ( c << 8 ) | d.
+ */
+void Defender_WriteIpv4Address( DefenderWriter_t * pWriter,
+                                uint32_t address );
+
+/**
+ * @brief Open a JSON object to add members to.
+ *
+ * With no output yet, a new object is started. Otherwise the output must be
+ * one JSON object, whose closing brace is taken off so that members can be
+ * added after its last member.
+ *
+ * @param[in] pWriter The writer.
+ * @param[out] pOutHasMembers 1 if the object already has members; 0
+ * otherwise.
+ *
+ * @return #DefenderSuccess if the object is open, or if the write of its
+ * opening brace fails, which sets the status of the writer;
+ * #DefenderBadParameter if the output is not an object. The output is not
+ * changed.
+ */
+DefenderStatus_t Defender_WriteObjectStart( DefenderWriter_t * pWriter,
+                                            uint8_t * pOutHasMembers );
+
+/**
+ * @brief Close a JSON object opened with #Defender_WriteObjectStart.
+ *
+ * If a write failed, the output is put back as it was before the object was
+ * opened, so an object given to #Defender_WriteObjectStart is kept whole.
+ *
+ * @param[in] pWriter The writer.
+ * @param[in] startLength The length of the output before the object was
+ * opened.
+ */
+void Defender_WriteObjectEnd( DefenderWriter_t * pWriter,
+                              uint32_t startLength );
+
+/*-----------------------------------------------------------*/
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* DEFENDER_WRITER_H_ */
@@ -0,0 +1,229 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_bound_matcher_utest.c
+ * @brief Unit tests for the bound matcher of the Device Defender library.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Test framework include. */
+#include "unity.h"
+
+/* Bound matcher include. */
+#include "defender_bound_matcher.h"
+
+/**
+ * @brief Length of the longest topic.
+ */
+#define TEST_TOPIC_LENGTH     DEFENDER_API_MAX_LENGTH( DEFENDER_THINGNAME_MAX_LENGTH )
+
+/**
+ * @brief Length of the buffer of the test matcher.
+ */
+#define TEST_BUFFER_LENGTH    ( ( uint32_t ) DEFENDER_BOUND_MATCHER_BUFFER_LENGTH( DEFENDER_THINGNAME_MAX_LENGTH ) )
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Buffer of the test matcher.
+ */
+static char testBuffer[ TEST_BUFFER_LENGTH ];
+
+/**
+ * @brief The test matcher.
+ */
+static DefenderBoundMatcher_t testMatcher;
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Check that the bound matcher of a thing name matches the topics of
+ * that thing, and only them.
+ */
+static void checkThing( const char * pThingName,
+                        uint16_t thingNameLength )
+{
+    static const char changes[] = { 'a', 'c', 'j', 'r', '/', '\0' };
+    char topic[ TEST_TOPIC_LENGTH + 1U ];
+    const char * pTopic;
+    uint16_t topicLength, matcherTopicLength, i;
+    DefenderTopic_t matchedApi;
+    uint32_t api, change;
+    char original;
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_BoundMatcherInit( &( testMatcher ), testBuffer,
+                                                                   ( uint32_t ) DEFENDER_BOUND_MATCHER_BUFFER_LENGTH( thingNameLength ),
+                                                                   pThingName, thingNameLength ) );
+
+    for( api = 0U; api < ( uint32_t ) DefenderMaxTopic; api++ )
+    {
+        TEST_ASSERT_EQUAL( DefenderSuccess, Defender_GetTopic( topic, sizeof( topic ), pThingName, thingNameLength,
+                                                               ( DefenderTopic_t ) api, &( topicLength ) ) );
+        TEST_ASSERT_EQUAL( DefenderSuccess, Defender_BoundMatcherGetTopic( &( testMatcher ), ( DefenderTopic_t ) api,
+                                                                           &( pTopic ), &( matcherTopicLength ) ) );
+        TEST_ASSERT_EQUAL( topicLength, matcherTopicLength );
+        TEST_ASSERT_EQUAL_MEMORY( topic, pTopic, topicLength );
+
+        TEST_ASSERT_EQUAL( DefenderSuccess, Defender_BoundMatcherMatch( &( testMatcher ), topic, topicLength, &( matchedApi ) ) );
+        TEST_ASSERT_EQUAL( api, matchedApi );
+
+        /* Shorter and longer topics do not match. */
+        TEST_ASSERT_EQUAL( DefenderNoMatch, Defender_BoundMatcherMatch( &( testMatcher ), topic, topicLength - 1U, &( matchedApi ) ) );
+        TEST_ASSERT_EQUAL( DefenderInvalidTopic, matchedApi );
+        topic[ topicLength ] = '/';
+        TEST_ASSERT_EQUAL( DefenderNoMatch, Defender_BoundMatcherMatch( &( testMatcher ), topic, topicLength + 1U, &( matchedApi ) ) );
+
+        /* A topic with any byte changed does not match, unless it is another
+         * topic of the thing. */
+        for( i = 0U; i < topicLength; i++ )
+        {
+            original = topic[ i ];
+
+            for( change = 0U; change < sizeof( changes ); change++ )
+            {
+                topic[ i ] = changes[ change ];
+
+                if( topic[ i ] != original )
+                {
+                    TEST_ASSERT_EQUAL( Defender_MatchTopic( topic, topicLength, &( matchedApi ), NULL, NULL ) == DefenderSuccess ?
+                                       ( ( memcmp( &( topic[ DEFENDER_API_LENGTH_PREFIX ] ), pThingName, thingNameLength ) == 0 ) &&
+                                         ( topic[ DEFENDER_API_LENGTH_PREFIX + thingNameLength ] == '/' ) ?
+                                         DefenderSuccess : DefenderNoMatch ) : DefenderNoMatch,
+                                       Defender_BoundMatcherMatch( &( testMatcher ), topic, topicLength, &( matchedApi ) ) );
+                }
+            }
+
+            topic[ i ] = original;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* ============================   UNITY FIXTURES ============================ */
+
+/* Called before each test method. */
+void setUp()
+{
+    ( void ) memset( &( testMatcher ), 0, sizeof( testMatcher ) );
+}
+
+/* Called after each test method. */
+void tearDown()
+{
+}
+
+/* Called at the beginning of the whole suite. */
+void suiteSetUp()
+{
+}
+
+/* Called at the end of the whole suite. */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test invalid parameters.
+ */
+void test_BoundMatcher_BadParameters( void )
+{
+    DefenderTopic_t api;
+    const char * pTopic;
+    uint16_t topicLength;
+
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_BoundMatcherInit( NULL, testBuffer, TEST_BUFFER_LENGTH, "thing", 5U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_BoundMatcherInit( &( testMatcher ), NULL, TEST_BUFFER_LENGTH, "thing", 5U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_BoundMatcherInit( &( testMatcher ), testBuffer, TEST_BUFFER_LENGTH, NULL, 5U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_BoundMatcherInit( &( testMatcher ), testBuffer, TEST_BUFFER_LENGTH, "thing", 0U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_BoundMatcherInit( &( testMatcher ), testBuffer, TEST_BUFFER_LENGTH, testBuffer,
+                                                                        DEFENDER_THINGNAME_MAX_LENGTH + 1U ) );
+    TEST_ASSERT_EQUAL( DefenderBufferTooSmall, Defender_BoundMatcherInit( &( testMatcher ), testBuffer,
+                                                                          ( uint32_t ) DEFENDER_BOUND_MATCHER_BUFFER_LENGTH( 5U ) - 1U, "thing", 5U ) );
+
+    /* The matcher is not initialized. */
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_BoundMatcherMatch( &( testMatcher ), "topic", 5U, &( api ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_BoundMatcherGetTopic( &( testMatcher ), DefenderJsonReportPublish,
+                                                                            &( pTopic ), &( topicLength ) ) );
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_BoundMatcherInit( &( testMatcher ), testBuffer,
+                                                                   ( uint32_t ) DEFENDER_BOUND_MATCHER_BUFFER_LENGTH( 5U ), "thing", 5U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_BoundMatcherMatch( NULL, "topic", 5U, &( api ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_BoundMatcherMatch( &( testMatcher ), NULL, 5U, &( api ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_BoundMatcherMatch( &( testMatcher ), "topic", 5U, NULL ) );
+
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_BoundMatcherGetTopic( NULL, DefenderJsonReportPublish, &( pTopic ), &( topicLength ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_BoundMatcherGetTopic( &( testMatcher ), DefenderJsonReportPublish, NULL, &( topicLength ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_BoundMatcherGetTopic( &( testMatcher ), DefenderJsonReportPublish, &( pTopic ), NULL ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_BoundMatcherGetTopic( &( testMatcher ), DefenderInvalidTopic, &( pTopic ), &( topicLength ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_BoundMatcherGetTopic( &( testMatcher ), DefenderMaxTopic, &( pTopic ), &( topicLength ) ) );
+
+    /* A short topic does not match. */
+    TEST_ASSERT_EQUAL( DefenderNoMatch, Defender_BoundMatcherMatch( &( testMatcher ), "topic", 5U, &( api ) ) );
+    TEST_ASSERT_EQUAL( DefenderInvalidTopic, api );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test the topics of things, including names with the letters the
+ * matcher uses as keys.
+ */
+void test_BoundMatcher_Match( void )
+{
+    char longName[ DEFENDER_THINGNAME_MAX_LENGTH ];
+
+    checkThing( "thing", 5U );
+    checkThing( "j", 1U );
+    checkThing( "cbor/accepted", 13U );
+    checkThing( "sensor-00000042", 15U );
+
+    ( void ) memset( longName, 'r', sizeof( longName ) );
+    checkThing( longName, sizeof( longName ) );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that the topics of another thing with a name of the same
+ * length do not match.
+ */
+void test_BoundMatcher_OtherThing( void )
+{
+    char topic[ TEST_TOPIC_LENGTH ];
+    uint16_t topicLength;
+    DefenderTopic_t matchedApi;
+    uint32_t api;
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_BoundMatcherInit( &( testMatcher ), testBuffer, TEST_BUFFER_LENGTH,
+                                                                   "sensor-00000042", 15U ) );
+
+    for( api = 0U; api < ( uint32_t ) DefenderMaxTopic; api++ )
+    {
+        TEST_ASSERT_EQUAL( DefenderSuccess, Defender_GetTopic( topic, sizeof( topic ), "sensor-00000043", 15U,
+                                                               ( DefenderTopic_t ) api, &( topicLength ) ) );
+        TEST_ASSERT_EQUAL( DefenderNoMatch, Defender_BoundMatcherMatch( &( testMatcher ), topic, topicLength, &( matchedApi ) ) );
+    }
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,309 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_bulk_utest.c
+ * @brief Unit tests for bulk Device Defender topic generation.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Test framework include. */
+#include "unity.h"
+
+/* Bulk API include. */
+#include "defender_bulk.h"
+
+/* Things used in the tests. */
+#define TEST_THING_COUNT           3U
+
+/* Length of the bulk buffer used in tests. A guard region follows the
+ * writable part and must never change. */
+#define TEST_BULK_BUFFER_LENGTH    512U
+#define TEST_BULK_GUARD_LENGTH     32U
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Thing names used in the tests.
+ */
+static const char * const testThingNames[ TEST_THING_COUNT ] =
+{
+    "Thermostat",
+    "A",
+    "Gateway-0001"
+};
+
+/**
+ * @brief Lengths of the above thing names.
+ */
+static const uint16_t testThingNameLengths[ TEST_THING_COUNT ] = { 10U, 1U, 12U };
+
+/**
+ * @brief Bulk buffer used in tests.
+ */
+static char testBulkBuffer[ TEST_BULK_BUFFER_LENGTH + TEST_BULK_GUARD_LENGTH ];
+
+/**
+ * @brief Offsets used in tests.
+ */
+static uint32_t testOffsets[ TEST_THING_COUNT + 1U ];
+/*-----------------------------------------------------------*/
+
+/* ============================   UNITY FIXTURES ============================ */
+
+/* Called before each test method. */
+void setUp()
+{
+    memset( &( testBulkBuffer[ 0 ] ), 0xA5, sizeof( testBulkBuffer ) );
+    memset( &( testOffsets[ 0 ] ), 0, sizeof( testOffsets ) );
+}
+
+/* Called after each test method. */
+void tearDown()
+{
+    TEST_ASSERT_EACH_EQUAL_HEX8( 0xA5,
+                                 &( testBulkBuffer[ TEST_BULK_BUFFER_LENGTH ] ),
+                                 TEST_BULK_GUARD_LENGTH );
+}
+
+/* Called at the beginning of the whole suite. */
+void suiteSetUp()
+{
+}
+
+/* Called at the end of the whole suite. */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that offsets are the prefix sums of the topic lengths.
+ */
+void test_Defender_GetTopicOffsets_Happy( void )
+{
+    DefenderStatus_t ret;
+
+    ret = Defender_GetTopicOffsets( testThingNameLengths, TEST_THING_COUNT,
+                                    DefenderJsonReportAccepted, testOffsets );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( 0U, testOffsets[ 0 ] );
+    TEST_ASSERT_EQUAL( DEFENDER_API_LENGTH_JSON_ACCEPTED( 10U ), testOffsets[ 1 ] );
+    TEST_ASSERT_EQUAL( DEFENDER_API_LENGTH_JSON_ACCEPTED( 10U ) +
+                       DEFENDER_API_LENGTH_JSON_ACCEPTED( 1U ), testOffsets[ 2 ] );
+    TEST_ASSERT_EQUAL( DEFENDER_API_LENGTH_JSON_ACCEPTED( 10U ) +
+                       DEFENDER_API_LENGTH_JSON_ACCEPTED( 1U ) +
+                       DEFENDER_API_LENGTH_JSON_ACCEPTED( 12U ), testOffsets[ 3 ] );
+
+    /* No things. */
+    ret = Defender_GetTopicOffsets( testThingNameLengths, 0U,
+                                    DefenderJsonReportAccepted, testOffsets );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( 0U, testOffsets[ 0 ] );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that offsets reject invalid parameters.
+ */
+void test_Defender_GetTopicOffsets_BadParams( void )
+{
+    DefenderStatus_t ret;
+    const uint16_t badLengths[ 2 ] = { 5U, 0U };
+    const uint16_t longLengths[ 1 ] = { DEFENDER_THINGNAME_MAX_LENGTH + 1U };
+
+    ret = Defender_GetTopicOffsets( NULL, TEST_THING_COUNT, DefenderJsonReportPublish, testOffsets );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_GetTopicOffsets( testThingNameLengths, UINT32_MAX, DefenderJsonReportPublish, testOffsets );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_GetTopicOffsets( testThingNameLengths, TEST_THING_COUNT, DefenderInvalidTopic, testOffsets );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_GetTopicOffsets( testThingNameLengths, TEST_THING_COUNT, DefenderMaxTopic, testOffsets );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_GetTopicOffsets( testThingNameLengths, TEST_THING_COUNT, DefenderJsonReportPublish, NULL );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_GetTopicOffsets( badLengths, 2U, DefenderJsonReportPublish, testOffsets );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_GetTopicOffsets( longLengths, 1U, DefenderJsonReportPublish, testOffsets );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that offsets detect 32 bit overflow.
+ */
+void test_Defender_GetTopicOffsets_Overflow( void )
+{
+    DefenderStatus_t ret;
+    static uint16_t lengths[ 25200000 ];
+    static uint32_t offsets[ 25200000 + 1 ];
+    uint32_t i;
+
+    for( i = 0U; i < 25200000U; i++ )
+    {
+        lengths[ i ] = DEFENDER_THINGNAME_MAX_LENGTH;
+    }
+
+    ret = Defender_GetTopicOffsets( lengths, 25200000U, DefenderCborReportAccepted, offsets );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that writing disjoint ranges produces the same topics as
+ * Defender_GetTopic.
+ */
+void test_Defender_GetTopicRange_Happy( void )
+{
+    DefenderStatus_t ret;
+    char expectedTopic[ DEFENDER_API_MAX_LENGTH( DEFENDER_THINGNAME_MAX_LENGTH ) ];
+    uint16_t expectedLength = 0U;
+    uint32_t i;
+
+    ret = Defender_GetTopicOffsets( testThingNameLengths, TEST_THING_COUNT,
+                                    DefenderCborReportRejected, testOffsets );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+
+    /* Write the second range first to show ranges are independent. */
+    ret = Defender_GetTopicRange( &( testBulkBuffer[ 0 ] ), TEST_BULK_BUFFER_LENGTH, testOffsets,
+                                  testThingNames, testThingNameLengths,
+                                  1U, TEST_THING_COUNT, DefenderCborReportRejected );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EACH_EQUAL_HEX8( 0xA5, &( testBulkBuffer[ 0 ] ), testOffsets[ 1 ] );
+
+    ret = Defender_GetTopicRange( &( testBulkBuffer[ 0 ] ), TEST_BULK_BUFFER_LENGTH, testOffsets,
+                                  testThingNames, testThingNameLengths,
+                                  0U, 1U, DefenderCborReportRejected );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+
+    /* Empty range. */
+    ret = Defender_GetTopicRange( &( testBulkBuffer[ 0 ] ), TEST_BULK_BUFFER_LENGTH, testOffsets,
+                                  testThingNames, testThingNameLengths,
+                                  2U, 2U, DefenderCborReportRejected );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+
+    for( i = 0U; i < TEST_THING_COUNT; i++ )
+    {
+        ret = Defender_GetTopic( &( expectedTopic[ 0 ] ), sizeof( expectedTopic ),
+                                 testThingNames[ i ], testThingNameLengths[ i ],
+                                 DefenderCborReportRejected, &( expectedLength ) );
+        TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+        TEST_ASSERT_EQUAL( expectedLength, testOffsets[ i + 1U ] - testOffsets[ i ] );
+        TEST_ASSERT_EQUAL_STRING_LEN( &( expectedTopic[ 0 ] ),
+                                      &( testBulkBuffer[ testOffsets[ i ] ] ),
+                                      expectedLength );
+    }
+
+    TEST_ASSERT_EACH_EQUAL_HEX8( 0xA5,
+                                 &( testBulkBuffer[ testOffsets[ TEST_THING_COUNT ] ] ),
+                                 TEST_BULK_BUFFER_LENGTH - testOffsets[ TEST_THING_COUNT ] );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that writing a range rejects invalid parameters.
+ */
+void test_Defender_GetTopicRange_BadParams( void )
+{
+    DefenderStatus_t ret;
+    const char * const nullNames[ TEST_THING_COUNT ] = { "Thermostat", NULL, "Gateway-0001" };
+
+    ret = Defender_GetTopicOffsets( testThingNameLengths, TEST_THING_COUNT,
+                                    DefenderJsonReportPublish, testOffsets );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+
+    ret = Defender_GetTopicRange( NULL, TEST_BULK_BUFFER_LENGTH, testOffsets, testThingNames,
+                                  testThingNameLengths, 0U, TEST_THING_COUNT, DefenderJsonReportPublish );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_GetTopicRange( &( testBulkBuffer[ 0 ] ), TEST_BULK_BUFFER_LENGTH, NULL, testThingNames,
+                                  testThingNameLengths, 0U, TEST_THING_COUNT, DefenderJsonReportPublish );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_GetTopicRange( &( testBulkBuffer[ 0 ] ), TEST_BULK_BUFFER_LENGTH, testOffsets, NULL,
+                                  testThingNameLengths, 0U, TEST_THING_COUNT, DefenderJsonReportPublish );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_GetTopicRange( &( testBulkBuffer[ 0 ] ), TEST_BULK_BUFFER_LENGTH, testOffsets, testThingNames,
+                                  NULL, 0U, TEST_THING_COUNT, DefenderJsonReportPublish );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_GetTopicRange( &( testBulkBuffer[ 0 ] ), TEST_BULK_BUFFER_LENGTH, testOffsets, testThingNames,
+                                  testThingNameLengths, 2U, 1U, DefenderJsonReportPublish );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_GetTopicRange( &( testBulkBuffer[ 0 ] ), TEST_BULK_BUFFER_LENGTH, testOffsets, testThingNames,
+                                  testThingNameLengths, 0U, TEST_THING_COUNT, DefenderInvalidTopic );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_GetTopicRange( &( testBulkBuffer[ 0 ] ), TEST_BULK_BUFFER_LENGTH, testOffsets, testThingNames,
+                                  testThingNameLengths, 0U, TEST_THING_COUNT, DefenderMaxTopic );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    /* NULL thing name in the range. */
+    ret = Defender_GetTopicRange( &( testBulkBuffer[ 0 ] ), TEST_BULK_BUFFER_LENGTH, testOffsets, nullNames,
+                                  testThingNameLengths, 0U, TEST_THING_COUNT, DefenderJsonReportPublish );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    /* Offsets calculated for a different API. */
+    ret = Defender_GetTopicRange( &( testBulkBuffer[ 0 ] ), TEST_BULK_BUFFER_LENGTH, testOffsets, testThingNames,
+                                  testThingNameLengths, 0U, TEST_THING_COUNT, DefenderJsonReportAccepted );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    /* Decreasing offsets. */
+    testOffsets[ 1 ] = testOffsets[ 2 ] + 1U;
+    ret = Defender_GetTopicRange( &( testBulkBuffer[ 0 ] ), TEST_BULK_BUFFER_LENGTH, testOffsets, testThingNames,
+                                  testThingNameLengths, 1U, 2U, DefenderJsonReportPublish );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    TEST_ASSERT_EACH_EQUAL_HEX8( 0xA5, &( testBulkBuffer[ 0 ] ), TEST_BULK_BUFFER_LENGTH );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that writing a range fails when the buffer is too small.
+ */
+void test_Defender_GetTopicRange_BufferTooSmall( void )
+{
+    DefenderStatus_t ret;
+
+    ret = Defender_GetTopicOffsets( testThingNameLengths, TEST_THING_COUNT,
+                                    DefenderJsonReportPublish, testOffsets );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+
+    ret = Defender_GetTopicRange( &( testBulkBuffer[ 0 ] ), testOffsets[ TEST_THING_COUNT ] - 1U,
+                                  testOffsets, testThingNames, testThingNameLengths,
+                                  0U, TEST_THING_COUNT, DefenderJsonReportPublish );
+    TEST_ASSERT_EQUAL( DefenderBufferTooSmall, ret );
+    TEST_ASSERT_EACH_EQUAL_HEX8( 0xA5, &( testBulkBuffer[ 0 ] ), TEST_BULK_BUFFER_LENGTH );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,465 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_connection_table_utest.c
+ * @brief Unit tests for the connection table of the Device Defender library.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Test framework include. */
+#include "unity.h"
+
+/* Connection table include. */
+#include "defender_connection_table.h"
+
+/**
+ * @brief Capacity of the tables used in the tests, over several blocks of
+ * the dedup and filter loops.
+ */
+#define TEST_CAPACITY         300U
+
+/**
+ * @brief Length of the buffer used in the serializer tests.
+ */
+#define TEST_BUFFER_LENGTH    256U
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Arrays of the table under test.
+ */
+static uint32_t testAddresses[ TEST_CAPACITY ];
+static uint16_t testRemotePorts[ TEST_CAPACITY ];
+static uint16_t testLocalPorts[ TEST_CAPACITY ];
+static uint8_t testInterfaceIds[ TEST_CAPACITY ];
+
+/**
+ * @brief Arrays of the scratch table.
+ */
+static uint32_t scratchAddresses[ TEST_CAPACITY ];
+static uint16_t scratchRemotePorts[ TEST_CAPACITY ];
+static uint16_t scratchLocalPorts[ TEST_CAPACITY ];
+static uint8_t scratchInterfaceIds[ TEST_CAPACITY ];
+
+/**
+ * @brief Tables used in the tests.
+ */
+static DefenderConnectionTable_t testTable;
+static DefenderConnectionTable_t scratchTable;
+
+/**
+ * @brief State of the pseudo random generator used to fill tables.
+ */
+static uint32_t randomState;
+
+/**
+ * @brief Buffer used in the serializer tests.
+ */
+static char testBuffer[ TEST_BUFFER_LENGTH ];
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Get a pseudo random number.
+ */
+static uint32_t nextRandom( void )
+{
+    randomState = ( randomState * 1103515245U ) + 12345U;
+
+    return randomState >> 8;
+}
+
+/**
+ * @brief Fill the table under test with pseudo random connections, with few
+ * distinct values so that there are duplicates.
+ */
+static void fillTable( uint32_t count,
+                       uint8_t interfaceCount )
+{
+    uint32_t i;
+
+    for( i = 0U; i < count; i++ )
+    {
+        TEST_ASSERT_EQUAL( DefenderSuccess,
+                           Defender_ConnectionTableAdd( &( testTable ),
+                                                        0x0A000000U | ( nextRandom() & 0x030103U ),
+                                                        ( uint16_t ) ( 8000U + ( nextRandom() % 3U ) * 300U ),
+                                                        ( uint16_t ) ( 440U + ( nextRandom() % 4U ) ),
+                                                        ( uint8_t ) ( nextRandom() % interfaceCount ) ) );
+    }
+}
+
+/**
+ * @brief Compare two connections of the table under test in sort order.
+ */
+static int compareConnections( uint32_t index1,
+                               uint32_t index2 )
+{
+    int ret = 0;
+
+    if( testAddresses[ index1 ] != testAddresses[ index2 ] )
+    {
+        ret = ( testAddresses[ index1 ] < testAddresses[ index2 ] ) ? -1 : 1;
+    }
+    else if( testRemotePorts[ index1 ] != testRemotePorts[ index2 ] )
+    {
+        ret = ( testRemotePorts[ index1 ] < testRemotePorts[ index2 ] ) ? -1 : 1;
+    }
+    else if( testLocalPorts[ index1 ] != testLocalPorts[ index2 ] )
+    {
+        ret = ( testLocalPorts[ index1 ] < testLocalPorts[ index2 ] ) ? -1 : 1;
+    }
+    else if( testInterfaceIds[ index1 ] != testInterfaceIds[ index2 ] )
+    {
+        ret = ( testInterfaceIds[ index1 ] < testInterfaceIds[ index2 ] ) ? -1 : 1;
+    }
+    else
+    {
+        ret = 0;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Sum of the fields of the connections, which does not depend on
+ * their order.
+ */
+static uint32_t sumConnections( void )
+{
+    uint32_t i, sum = 0U;
+
+    for( i = 0U; i < testTable.count; i++ )
+    {
+        sum += testAddresses[ i ] + testRemotePorts[ i ] + testLocalPorts[ i ] + testInterfaceIds[ i ];
+    }
+
+    return sum;
+}
+/*-----------------------------------------------------------*/
+
+/* ============================   UNITY FIXTURES ============================ */
+
+/* Called before each test method. */
+void setUp()
+{
+    randomState = 1U;
+
+    TEST_ASSERT_EQUAL( DefenderSuccess,
+                       Defender_ConnectionTableInit( &( testTable ), testAddresses, testRemotePorts,
+                                                     testLocalPorts, testInterfaceIds, TEST_CAPACITY ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess,
+                       Defender_ConnectionTableInit( &( scratchTable ), scratchAddresses, scratchRemotePorts,
+                                                     scratchLocalPorts, scratchInterfaceIds, TEST_CAPACITY ) );
+    ( void ) memset( &( testBuffer[ 0 ] ), 0, sizeof( testBuffer ) );
+}
+
+/* Called after each test method. */
+void tearDown()
+{
+}
+
+/* Called at the beginning of the whole suite. */
+void suiteSetUp()
+{
+}
+
+/* Called at the end of the whole suite. */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test adding connections up to the capacity of a table.
+ */
+void test_Defender_ConnectionTableAdd_Happy( void )
+{
+    DefenderStatus_t ret;
+
+    testTable.capacity = 2U;
+
+    ret = Defender_ConnectionTableAdd( &( testTable ), 0x0A000001U, 8883U, 443U, 1U );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    ret = Defender_ConnectionTableAdd( &( testTable ), 0x0A000002U, 8884U, 444U, 2U );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( 2U, testTable.count );
+    TEST_ASSERT_EQUAL_HEX32( 0x0A000002U, testAddresses[ 1 ] );
+    TEST_ASSERT_EQUAL( 8884U, testRemotePorts[ 1 ] );
+    TEST_ASSERT_EQUAL( 444U, testLocalPorts[ 1 ] );
+    TEST_ASSERT_EQUAL( 2U, testInterfaceIds[ 1 ] );
+
+    ret = Defender_ConnectionTableAdd( &( testTable ), 0x0A000003U, 8885U, 445U, 3U );
+    TEST_ASSERT_EQUAL( DefenderBufferTooSmall, ret );
+    TEST_ASSERT_EQUAL( 2U, testTable.count );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that sorting orders by address, remote port, local port and
+ * interface, with and without skipped passes.
+ */
+void test_Defender_ConnectionTableSort_Happy( void )
+{
+    DefenderStatus_t ret;
+    uint32_t i, sum;
+    uint8_t interfaceCounts[ 2 ] = { 3U, 1U };
+    uint8_t j;
+
+    for( j = 0U; j < 2U; j++ )
+    {
+        testTable.count = 0U;
+        fillTable( TEST_CAPACITY, interfaceCounts[ j ] );
+        sum = sumConnections();
+
+        ret = Defender_ConnectionTableSort( &( testTable ), &( scratchTable ) );
+        TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+        TEST_ASSERT_EQUAL( TEST_CAPACITY, testTable.count );
+        TEST_ASSERT_EQUAL( sum, sumConnections() );
+
+        for( i = 1U; i < testTable.count; i++ )
+        {
+            TEST_ASSERT_TRUE( compareConnections( i - 1U, i ) <= 0 );
+        }
+    }
+
+    /* Tables of one connection are already sorted. */
+    testTable.count = 1U;
+    ret = Defender_ConnectionTableSort( &( testTable ), &( scratchTable ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+
+    ret = Defender_ConnectionTableSort( &( testTable ), &( testTable ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    testTable.count = 2U;
+    scratchTable.capacity = 1U;
+    ret = Defender_ConnectionTableSort( &( testTable ), &( scratchTable ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_ConnectionTableSort( &( testTable ), NULL );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that dedup removes repeated connections across blocks.
+ */
+void test_Defender_ConnectionTableDedup_Happy( void )
+{
+    DefenderStatus_t ret;
+    uint32_t i, distinct = 1U;
+
+    fillTable( TEST_CAPACITY, 2U );
+    ret = Defender_ConnectionTableSort( &( testTable ), &( scratchTable ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+
+    for( i = 1U; i < testTable.count; i++ )
+    {
+        if( compareConnections( i - 1U, i ) != 0 )
+        {
+            distinct++;
+        }
+    }
+
+    TEST_ASSERT_TRUE( distinct < TEST_CAPACITY );
+
+    ret = Defender_ConnectionTableDedup( &( testTable ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( distinct, testTable.count );
+
+    for( i = 1U; i < testTable.count; i++ )
+    {
+        TEST_ASSERT_TRUE( compareConnections( i - 1U, i ) < 0 );
+    }
+
+    /* Nothing left to remove. */
+    ret = Defender_ConnectionTableDedup( &( testTable ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( distinct, testTable.count );
+
+    testTable.count = 0U;
+    ret = Defender_ConnectionTableDedup( &( testTable ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( 0U, testTable.count );
+
+    ret = Defender_ConnectionTableDedup( NULL );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test filtering by local port.
+ */
+void test_Defender_ConnectionTableFilterLocalPort_Happy( void )
+{
+    DefenderStatus_t ret;
+    uint32_t i, expected = 0U;
+
+    fillTable( TEST_CAPACITY, 2U );
+
+    for( i = 0U; i < TEST_CAPACITY; i++ )
+    {
+        if( ( testLocalPorts[ i ] == 441U ) || ( testLocalPorts[ i ] == 442U ) )
+        {
+            expected++;
+        }
+    }
+
+    /* Keeping every port changes nothing. */
+    ret = Defender_ConnectionTableFilterLocalPort( &( testTable ), 0U, 65535U );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( TEST_CAPACITY, testTable.count );
+
+    ret = Defender_ConnectionTableFilterLocalPort( &( testTable ), 441U, 442U );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( expected, testTable.count );
+
+    for( i = 0U; i < testTable.count; i++ )
+    {
+        TEST_ASSERT_TRUE( ( testLocalPorts[ i ] == 441U ) || ( testLocalPorts[ i ] == 442U ) );
+    }
+
+    ret = Defender_ConnectionTableFilterLocalPort( &( testTable ), 443U, 443U );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( 0U, testTable.count );
+
+    ret = Defender_ConnectionTableFilterLocalPort( &( testTable ), 443U, 442U );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_ConnectionTableFilterLocalPort( NULL, 0U, 1U );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test writing the established connections object.
+ */
+void test_Defender_ConnectionTableSerialize_Happy( void )
+{
+    static const char expected[] =
+        "{\"cs\":[{\"li\":\"eth0\",\"lp\":443,\"rad\":\"10.0.0.1:8883\"},"
+        "{\"lp\":0,\"rad\":\"255.255.255.255:65535\"}],\"t\":2}";
+    const char * interfaceNames[ 1 ] = { "eth0" };
+    uint16_t interfaceNameLengths[ 1 ] = { 4U };
+    DefenderStatus_t ret;
+    uint32_t length = 0U, bufferLength;
+
+    ret = Defender_ConnectionTableSerialize( &( testTable ), NULL, NULL, 0U,
+                                             &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( STRING_LITERAL_LENGTH( "{\"cs\":[],\"t\":0}" ), length );
+    TEST_ASSERT_EQUAL_STRING_LEN( "{\"cs\":[],\"t\":0}", testBuffer, length );
+
+    ( void ) Defender_ConnectionTableAdd( &( testTable ), 0x0A000001U, 8883U, 443U, 0U );
+    ( void ) Defender_ConnectionTableAdd( &( testTable ), 0xFFFFFFFFU, 65535U, 0U, 1U );
+
+    ret = Defender_ConnectionTableSerialize( &( testTable ), interfaceNames, interfaceNameLengths, 1U,
+                                             &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( STRING_LITERAL_LENGTH( expected ), length );
+    TEST_ASSERT_EQUAL_STRING_LEN( expected, testBuffer, length );
+
+    /* Interface names are escaped. */
+    interfaceNames[ 0 ] = "a\"b";
+    interfaceNameLengths[ 0 ] = 3U;
+    testTable.count = 1U;
+
+    ret = Defender_ConnectionTableSerialize( &( testTable ), interfaceNames, interfaceNameLengths, 1U,
+                                             &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL_STRING_LEN( "{\"cs\":[{\"li\":\"a\\\"b\",", testBuffer, 20U );
+
+    interfaceNames[ 0 ] = "\xC3";
+    interfaceNameLengths[ 0 ] = 1U;
+    ret = Defender_ConnectionTableSerialize( &( testTable ), interfaceNames, interfaceNameLengths, 1U,
+                                             &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderError, ret );
+
+    interfaceNames[ 0 ] = "eth0";
+    interfaceNameLengths[ 0 ] = 4U;
+    testTable.count = 2U;
+
+    /* Every shorter buffer is too small, and the length is not written. */
+    for( bufferLength = 0U; bufferLength < STRING_LITERAL_LENGTH( expected ); bufferLength++ )
+    {
+        length = 0U;
+        ret = Defender_ConnectionTableSerialize( &( testTable ), interfaceNames, interfaceNameLengths, 1U,
+                                                 &( testBuffer[ 0 ] ), bufferLength, &( length ) );
+        TEST_ASSERT_EQUAL( DefenderBufferTooSmall, ret );
+        TEST_ASSERT_EQUAL( 0U, length );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that invalid parameters are rejected.
+ */
+void test_Defender_ConnectionTable_BadParams( void )
+{
+    DefenderStatus_t ret;
+    uint32_t length = 0U;
+
+    ret = Defender_ConnectionTableInit( NULL, testAddresses, testRemotePorts, testLocalPorts, testInterfaceIds, 1U );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_ConnectionTableInit( &( testTable ), NULL, testRemotePorts, testLocalPorts, testInterfaceIds, 1U );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_ConnectionTableInit( &( testTable ), testAddresses, NULL, testLocalPorts, testInterfaceIds, 1U );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_ConnectionTableInit( &( testTable ), testAddresses, testRemotePorts, NULL, testInterfaceIds, 1U );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_ConnectionTableInit( &( testTable ), testAddresses, testRemotePorts, testLocalPorts, NULL, 1U );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_ConnectionTableAdd( NULL, 0U, 0U, 0U, 0U );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_ConnectionTableSerialize( NULL, NULL, NULL, 0U, &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_ConnectionTableSerialize( &( testTable ), NULL, NULL, 1U, &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_ConnectionTableSerialize( &( testTable ), NULL, NULL, 0U, NULL, TEST_BUFFER_LENGTH, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_ConnectionTableSerialize( &( testTable ), NULL, NULL, 0U, &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, NULL );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    /* Tables with missing arrays or a count over the capacity. */
+    testTable.pInterfaceIds = NULL;
+    ret = Defender_ConnectionTableDedup( &( testTable ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    testTable.pInterfaceIds = testInterfaceIds;
+    testTable.count = TEST_CAPACITY + 1U;
+    ret = Defender_ConnectionTableSort( &( testTable ), &( scratchTable ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,416 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_coro_utest.cpp
+ * @brief Unit tests for the C++ coroutine interface of the Device Defender
+ * library.
+ */
+
+/* Standard includes. */
+#include <cstring>
+
+/* Test framework include. */
+#include "unity.h"
+
+/* Defender coroutine API include. */
+#include "defender_coro.hpp"
+
+/* Thing name used in the tests. */
+#define TEST_THING_NAME          "TestThing"
+
+/* Report published in the tests. */
+#define TEST_REPORT              "{\"header\":{\"report_id\":1}}"
+
+/* Responses used in the tests. */
+#define TEST_ACCEPTED_1          "{\"thingName\":\"TestThing\",\"reportId\":1,\"status\":\"ACCEPTED\",\"timestamp\":42}"
+#define TEST_ACCEPTED_2          "{\"thingName\":\"TestThing\",\"reportId\":2,\"status\":\"ACCEPTED\"}"
+#define TEST_REJECTED_2          "{\"reportId\":2,\"status\":\"REJECTED\",\"statusDetails\":{\"ErrorCode\":\"InvalidJson\"}}"
+#define TEST_REJECTED_LONG_CODE  "{\"reportId\":1,\"status\":\"REJECTED\",\"statusDetails\":{\"ErrorCode\":" \
+                                 "\"ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789\"}}"
+
+/* Maximum number of coroutines queued on the test executor. */
+#define TEST_EXECUTOR_CAPACITY   8U
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Executor which resumes coroutines when run.
+ */
+struct TestExecutor
+{
+    std::coroutine_handle<> queue[ TEST_EXECUTOR_CAPACITY ];
+    std::size_t count = 0U;
+
+    void post( std::coroutine_handle<> handle ) noexcept
+    {
+        TEST_ASSERT_TRUE( count < TEST_EXECUTOR_CAPACITY );
+        queue[ count ] = handle;
+        count++;
+    }
+
+    void run() noexcept
+    {
+        std::size_t i = 0U;
+
+        /* Coroutines may post more coroutines while running. */
+        while( i < count )
+        {
+            queue[ i ].resume();
+            i++;
+        }
+
+        count = 0U;
+    }
+};
+
+/**
+ * @brief Publisher which records the last message.
+ */
+struct TestPublisher
+{
+    bool isConnected = true;
+    std::size_t publishCount = 0U;
+    std::string_view topic {};
+    std::span< const char > payload {};
+
+    bool publish( std::string_view publishTopic,
+                  std::span< const char > publishPayload ) noexcept
+    {
+        publishCount++;
+        topic = publishTopic;
+        payload = publishPayload;
+
+        return isConnected;
+    }
+};
+
+using TestSession = defender::coro::ReportSession< TestExecutor, TestPublisher >;
+
+/**
+ * @brief Number of bytes allocated by the test allocator and not freed yet.
+ */
+static std::size_t testAllocatedBytes = 0U;
+
+/**
+ * @brief Allocator which counts allocated bytes.
+ */
+template< typename T >
+struct TestAllocator
+{
+    using value_type = T;
+
+    TestAllocator() noexcept = default;
+
+    template< typename U >
+    TestAllocator( const TestAllocator< U > & ) noexcept
+    {
+    }
+
+    T * allocate( std::size_t count )
+    {
+        testAllocatedBytes += count * sizeof( T );
+
+        return static_cast< T * >( ::operator new( count * sizeof( T ) ) );
+    }
+
+    void deallocate( T * pMemory,
+                     std::size_t count ) noexcept
+    {
+        testAllocatedBytes -= count * sizeof( T );
+        ::operator delete( pMemory );
+    }
+};
+
+/**
+ * @brief Test fixtures.
+ */
+static TestExecutor testExecutor;
+static TestPublisher testPublisher;
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Publish one report and store the result.
+ */
+static defender::coro::Task<> publishOnce( std::allocator_arg_t,
+                                           TestAllocator< char >,
+                                           TestSession & session,
+                                           std::uint64_t reportId,
+                                           defender::coro::ReportResult & result )
+{
+    result = co_await session.publishReport( std::span< const char >( TEST_REPORT, std::strlen( TEST_REPORT ) ),
+                                             reportId );
+}
+
+/**
+ * @brief Publish one report and return whether it was accepted.
+ */
+static defender::coro::Task< bool > isAccepted( TestSession & session,
+                                                std::uint64_t reportId )
+{
+    defender::coro::ReportResult result =
+        co_await session.publishReport( std::span< const char >( TEST_REPORT, std::strlen( TEST_REPORT ) ),
+                                        reportId );
+
+    co_return result.reportStatus == DefenderReportAccepted;
+}
+
+/**
+ * @brief Await a child task.
+ */
+static defender::coro::Task<> publishThroughChild( TestSession & session,
+                                                   bool & accepted )
+{
+    accepted = co_await isAccepted( session, 1U );
+}
+
+/**
+ * @brief Deliver a response.
+ */
+static bool deliver( TestSession & session,
+                     std::string_view topic,
+                     const char * pResponse )
+{
+    return session.onMessage( topic, std::span< const char >( pResponse, std::strlen( pResponse ) ) );
+}
+/*-----------------------------------------------------------*/
+
+extern "C" {
+/* ============================   UNITY FIXTURES ============================ */
+
+/* Called before each test method. */
+void setUp()
+{
+    testExecutor.count = 0U;
+    testPublisher = TestPublisher {};
+}
+
+/* Called after each test method. */
+void tearDown()
+{
+    /* Every coroutine frame must be freed. */
+    TEST_ASSERT_EQUAL( 0U, testAllocatedBytes );
+}
+
+/* Called at the beginning of the whole suite. */
+void suiteSetUp()
+{
+}
+
+/* Called at the end of the whole suite. */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that the session uses the topics of its thing.
+ */
+void test_Defender_Coro_Topics( void )
+{
+    TestSession session( testExecutor, testPublisher, TEST_THING_NAME );
+
+    TEST_ASSERT_TRUE( session.publishTopic() == DEFENDER_API_JSON_PUBLISH( TEST_THING_NAME ) );
+    TEST_ASSERT_TRUE( session.acceptedTopic() == DEFENDER_API_JSON_ACCEPTED( TEST_THING_NAME ) );
+    TEST_ASSERT_TRUE( session.rejectedTopic() == DEFENDER_API_JSON_REJECTED( TEST_THING_NAME ) );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test publishing a report which is accepted.
+ */
+void test_Defender_Coro_Accepted( void )
+{
+    TestSession session( testExecutor, testPublisher, TEST_THING_NAME );
+    defender::coro::ReportResult result;
+
+    defender::coro::spawn( testExecutor, publishOnce( std::allocator_arg, {}, session, 1U, result ) );
+    TEST_ASSERT_TRUE( testAllocatedBytes > 0U );
+    TEST_ASSERT_EQUAL( 0U, testPublisher.publishCount );
+
+    /* The report is published when the coroutine runs. */
+    testExecutor.run();
+    TEST_ASSERT_EQUAL( 1U, testPublisher.publishCount );
+    TEST_ASSERT_TRUE( testPublisher.topic == session.publishTopic() );
+    TEST_ASSERT_EQUAL_STRING_LEN( TEST_REPORT, testPublisher.payload.data(), testPublisher.payload.size() );
+    TEST_ASSERT_EQUAL( DefenderError, result.status );
+
+    /* The response resumes the coroutine through the executor. */
+    TEST_ASSERT_TRUE( deliver( session, session.acceptedTopic(), TEST_ACCEPTED_1 ) );
+    TEST_ASSERT_EQUAL( 1U, testExecutor.count );
+    TEST_ASSERT_EQUAL( DefenderError, result.status );
+    testExecutor.run();
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, result.status );
+    TEST_ASSERT_EQUAL( DefenderReportAccepted, result.reportStatus );
+    TEST_ASSERT_TRUE( result.timestamp == 42U );
+    TEST_ASSERT_TRUE( result.errorCode().empty() );
+
+    /* The same response again is not for a pending report. */
+    TEST_ASSERT_FALSE( deliver( session, session.acceptedTopic(), TEST_ACCEPTED_1 ) );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that responses are matched to reports by report ID.
+ */
+void test_Defender_Coro_OutOfOrder( void )
+{
+    TestSession session( testExecutor, testPublisher, TEST_THING_NAME );
+    defender::coro::ReportResult result1, result2, result3;
+
+    defender::coro::spawn( testExecutor, publishOnce( std::allocator_arg, {}, session, 1U, result1 ) );
+    defender::coro::spawn( testExecutor, publishOnce( std::allocator_arg, {}, session, 2U, result2 ) );
+    defender::coro::spawn( testExecutor, publishOnce( std::allocator_arg, {}, session, 3U, result3 ) );
+    testExecutor.run();
+    TEST_ASSERT_EQUAL( 3U, testPublisher.publishCount );
+
+    TEST_ASSERT_TRUE( deliver( session, session.rejectedTopic(), TEST_REJECTED_2 ) );
+    testExecutor.run();
+    TEST_ASSERT_EQUAL( DefenderSuccess, result2.status );
+    TEST_ASSERT_EQUAL( DefenderReportRejected, result2.reportStatus );
+    TEST_ASSERT_TRUE( result2.errorCode() == "InvalidJson" );
+    TEST_ASSERT_EQUAL( DefenderError, result1.status );
+
+    TEST_ASSERT_TRUE( deliver( session, session.rejectedTopic(), TEST_REJECTED_LONG_CODE ) );
+    testExecutor.run();
+    TEST_ASSERT_EQUAL( DefenderReportRejected, result1.reportStatus );
+    TEST_ASSERT_EQUAL( defender::coro::errorCodeMaxLength, result1.errorCode().size() );
+    TEST_ASSERT_TRUE( result1.errorCode() == "ABCDEFGHIJKLMNOPQRSTUVWXYZ012345" );
+
+    /* The last report is cancelled when the session ends. */
+    session.cancelAll();
+    testExecutor.run();
+    TEST_ASSERT_EQUAL( DefenderError, result3.status );
+    TEST_ASSERT_EQUAL( DefenderReportStatusUnknown, result3.reportStatus );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that a report which cannot be published resumes immediately.
+ */
+void test_Defender_Coro_PublishFailed( void )
+{
+    TestSession session( testExecutor, testPublisher, TEST_THING_NAME );
+    defender::coro::ReportResult result;
+
+    testPublisher.isConnected = false;
+    defender::coro::spawn( testExecutor, publishOnce( std::allocator_arg, {}, session, 1U, result ) );
+    testExecutor.run();
+
+    TEST_ASSERT_EQUAL( 1U, testPublisher.publishCount );
+    TEST_ASSERT_EQUAL( DefenderError, result.status );
+
+    /* The report is not pending. */
+    TEST_ASSERT_FALSE( deliver( session, session.acceptedTopic(), TEST_ACCEPTED_1 ) );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that other messages are ignored.
+ */
+void test_Defender_Coro_IgnoredMessages( void )
+{
+    TestSession session( testExecutor, testPublisher, TEST_THING_NAME );
+    defender::coro::ReportResult result;
+
+    defender::coro::spawn( testExecutor, publishOnce( std::allocator_arg, {}, session, 2U, result ) );
+    testExecutor.run();
+
+    TEST_ASSERT_FALSE( deliver( session, DEFENDER_API_JSON_ACCEPTED( "OtherThing" ), TEST_ACCEPTED_2 ) );
+    TEST_ASSERT_FALSE( deliver( session, session.publishTopic(), TEST_ACCEPTED_2 ) );
+    TEST_ASSERT_FALSE( deliver( session, session.acceptedTopic(), TEST_ACCEPTED_1 ) );
+    TEST_ASSERT_FALSE( deliver( session, session.acceptedTopic(), "{\"reportId\":2}" ) );
+    TEST_ASSERT_FALSE( deliver( session, session.acceptedTopic(), "" ) );
+    TEST_ASSERT_EQUAL( 0U, testExecutor.count );
+    TEST_ASSERT_EQUAL( DefenderError, result.status );
+
+    TEST_ASSERT_TRUE( deliver( session, session.acceptedTopic(), TEST_ACCEPTED_2 ) );
+    testExecutor.run();
+    TEST_ASSERT_EQUAL( DefenderSuccess, result.status );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that a response whose status contradicts its topic is ignored.
+ */
+void test_Defender_Coro_ContradictingStatus( void )
+{
+    TestSession session( testExecutor, testPublisher, TEST_THING_NAME );
+    defender::coro::ReportResult result;
+
+    defender::coro::spawn( testExecutor, publishOnce( std::allocator_arg, {}, session, 2U, result ) );
+    testExecutor.run();
+
+    TEST_ASSERT_FALSE( deliver( session, session.acceptedTopic(), TEST_REJECTED_2 ) );
+    TEST_ASSERT_FALSE( deliver( session, session.rejectedTopic(), TEST_ACCEPTED_2 ) );
+    TEST_ASSERT_FALSE( deliver( session, DEFENDER_API_CBOR_ACCEPTED( TEST_THING_NAME ), TEST_ACCEPTED_2 ) );
+    TEST_ASSERT_FALSE( deliver( session, DEFENDER_API_JSON_ACCEPTED( "TestThing2" ), TEST_ACCEPTED_2 ) );
+    TEST_ASSERT_EQUAL( 0U, testExecutor.count );
+    TEST_ASSERT_EQUAL( DefenderError, result.status );
+
+    TEST_ASSERT_TRUE( deliver( session, session.rejectedTopic(), TEST_REJECTED_2 ) );
+    testExecutor.run();
+    TEST_ASSERT_EQUAL( DefenderSuccess, result.status );
+    TEST_ASSERT_EQUAL( DefenderReportRejected, result.reportStatus );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test awaiting a task which returns a value. Frames of coroutines
+ * without an allocator use the default allocator.
+ */
+void test_Defender_Coro_NestedTask( void )
+{
+    TestSession session( testExecutor, testPublisher, TEST_THING_NAME );
+    bool accepted = false;
+
+    defender::coro::spawn( testExecutor, publishThroughChild( session, accepted ) );
+    testExecutor.run();
+    TEST_ASSERT_EQUAL( 1U, testPublisher.publishCount );
+
+    TEST_ASSERT_TRUE( deliver( session, session.acceptedTopic(), TEST_ACCEPTED_1 ) );
+    testExecutor.run();
+    TEST_ASSERT_TRUE( accepted );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that a task which is never started frees its frame.
+ */
+void test_Defender_Coro_TaskNotStarted( void )
+{
+    TestSession session( testExecutor, testPublisher, TEST_THING_NAME );
+    defender::coro::ReportResult result;
+
+    {
+        defender::coro::Task<> task = publishOnce( std::allocator_arg, {}, session, 1U, result );
+        TEST_ASSERT_TRUE( testAllocatedBytes > 0U );
+    }
+
+    TEST_ASSERT_EQUAL( 0U, testAllocatedBytes );
+    TEST_ASSERT_EQUAL( 0U, testPublisher.publishCount );
+}
+/*-----------------------------------------------------------*/
+}
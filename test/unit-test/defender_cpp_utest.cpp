@@ -0,0 +1,232 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_cpp_utest.cpp
+ * @brief Unit tests for the C++ interface of the Device Defender library.
+ */
+
+/* Standard includes. */
+#include <cstring>
+
+/* Test framework include. */
+#include "unity.h"
+
+/* Defender C++ API include. */
+#include "defender.hpp"
+
+/* Thing name used in the tests. */
+#define TEST_THING_NAME    "TestThing"
+/*-----------------------------------------------------------*/
+
+/* The topics built at compile time must be identical to the C macros. */
+static_assert( defender::topic< DefenderJsonReportPublish, TEST_THING_NAME >.view() ==
+               DEFENDER_API_JSON_PUBLISH( TEST_THING_NAME ) );
+static_assert( defender::topic< DefenderJsonReportAccepted, TEST_THING_NAME >.view() ==
+               DEFENDER_API_JSON_ACCEPTED( TEST_THING_NAME ) );
+static_assert( defender::topic< DefenderJsonReportRejected, TEST_THING_NAME >.view() ==
+               DEFENDER_API_JSON_REJECTED( TEST_THING_NAME ) );
+static_assert( defender::topic< DefenderCborReportPublish, TEST_THING_NAME >.view() ==
+               DEFENDER_API_CBOR_PUBLISH( TEST_THING_NAME ) );
+static_assert( defender::topic< DefenderCborReportAccepted, TEST_THING_NAME >.view() ==
+               DEFENDER_API_CBOR_ACCEPTED( TEST_THING_NAME ) );
+static_assert( defender::topic< DefenderCborReportRejected, TEST_THING_NAME >.view() ==
+               DEFENDER_API_CBOR_REJECTED( TEST_THING_NAME ) );
+
+/* The lengths must match the C length macros. */
+static_assert( defender::topic< DefenderJsonReportAccepted, TEST_THING_NAME >.length ==
+               DEFENDER_API_LENGTH_JSON_ACCEPTED( STRING_LITERAL_LENGTH( TEST_THING_NAME ) ) );
+static_assert( defender::topicLength( DefenderCborReportRejected, DEFENDER_THINGNAME_MAX_LENGTH ) ==
+               defender::maxTopicLength );
+
+/* Topics can also be built at compile time into a buffer. */
+static_assert( []()
+{
+    char buffer[ defender::maxTopicLength ] {};
+    std::string_view topic = defender::getTopic< DefenderJsonReportRejected >( buffer, TEST_THING_NAME );
+
+    return topic == DEFENDER_API_JSON_REJECTED( TEST_THING_NAME );
+}() );
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Topic buffer used in tests, with a guard after the writable part.
+ */
+static char testTopicBuffer[ defender::maxTopicLength + 32U ];
+/*-----------------------------------------------------------*/
+
+extern "C" {
+/* ============================   UNITY FIXTURES ============================ */
+
+/* Called before each test method. */
+void setUp()
+{
+    std::memset( &( testTopicBuffer[ 0 ] ), 0xA5, sizeof( testTopicBuffer ) );
+}
+
+/* Called after each test method. */
+void tearDown()
+{
+    TEST_ASSERT_EACH_EQUAL_HEX8( 0xA5,
+                                 &( testTopicBuffer[ defender::maxTopicLength ] ),
+                                 32U );
+}
+
+/* Called at the beginning of the whole suite. */
+void suiteSetUp()
+{
+}
+
+/* Called at the end of the whole suite. */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that the compile time topics are NULL terminated.
+ */
+void test_Defender_Cpp_CompileTimeTopic( void )
+{
+    constexpr auto topic = defender::topic< DefenderCborReportAccepted, TEST_THING_NAME >;
+
+    TEST_ASSERT_EQUAL_STRING( DEFENDER_API_CBOR_ACCEPTED( TEST_THING_NAME ), topic.data() );
+    TEST_ASSERT_EQUAL( std::strlen( topic.data() ), topic.length );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that run time topics match the C API.
+ */
+void test_Defender_Cpp_GetTopic_Happy( void )
+{
+    char expected[ defender::maxTopicLength ];
+    char thingName[ DEFENDER_THINGNAME_MAX_LENGTH ];
+    uint16_t expectedLength = 0U;
+    std::string_view topic;
+
+    std::memset( &( thingName[ 0 ] ), 'x', sizeof( thingName ) );
+
+    ( void ) Defender_GetTopic( &( expected[ 0 ] ), sizeof( expected ),
+                                &( thingName[ 0 ] ), sizeof( thingName ),
+                                DefenderCborReportRejected, &( expectedLength ) );
+    topic = defender::getTopic< DefenderCborReportRejected >(
+        std::span< char >( testTopicBuffer, defender::maxTopicLength ),
+        std::string_view( thingName, sizeof( thingName ) ) );
+
+    TEST_ASSERT_EQUAL( expectedLength, topic.size() );
+    TEST_ASSERT_EQUAL_PTR( &( testTopicBuffer[ 0 ] ), topic.data() );
+    TEST_ASSERT_EQUAL_STRING_LEN( &( expected[ 0 ] ), topic.data(), expectedLength );
+
+    topic = defender::getTopic< DefenderJsonReportPublish >(
+        std::span< char >( testTopicBuffer, defender::maxTopicLength ), "A" );
+    TEST_ASSERT_EQUAL( DEFENDER_API_LENGTH_JSON_PUBLISH( 1U ), topic.size() );
+    TEST_ASSERT_EQUAL_STRING_LEN( DEFENDER_API_JSON_PUBLISH( "A" ), topic.data(), topic.size() );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that run time topics are not written for invalid input.
+ */
+void test_Defender_Cpp_GetTopic_Invalid( void )
+{
+    char thingName[ DEFENDER_THINGNAME_MAX_LENGTH + 1U ];
+    std::string_view topic;
+
+    std::memset( &( thingName[ 0 ] ), 'x', sizeof( thingName ) );
+
+    topic = defender::getTopic< DefenderJsonReportAccepted >(
+        std::span< char >( testTopicBuffer, defender::maxTopicLength ), "" );
+    TEST_ASSERT_TRUE( topic.empty() );
+
+    topic = defender::getTopic< DefenderJsonReportAccepted >(
+        std::span< char >( testTopicBuffer, defender::maxTopicLength ),
+        std::string_view( thingName, sizeof( thingName ) ) );
+    TEST_ASSERT_TRUE( topic.empty() );
+
+    /* One byte too small. */
+    topic = defender::getTopic< DefenderJsonReportAccepted >(
+        std::span< char >( testTopicBuffer, DEFENDER_API_LENGTH_JSON_ACCEPTED( 9U ) - 1U ),
+        TEST_THING_NAME );
+    TEST_ASSERT_TRUE( topic.empty() );
+
+    TEST_ASSERT_EACH_EQUAL_HEX8( 0xA5, &( testTopicBuffer[ 0 ] ), defender::maxTopicLength );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that every API is matched with a view of the thing name.
+ */
+void test_Defender_Cpp_MatchTopic_Happy( void )
+{
+    static const std::string_view topics[] =
+    {
+        defender::topic< DefenderJsonReportPublish, TEST_THING_NAME >.view(),
+        defender::topic< DefenderJsonReportAccepted, TEST_THING_NAME >.view(),
+        defender::topic< DefenderJsonReportRejected, TEST_THING_NAME >.view(),
+        defender::topic< DefenderCborReportPublish, TEST_THING_NAME >.view(),
+        defender::topic< DefenderCborReportAccepted, TEST_THING_NAME >.view(),
+        defender::topic< DefenderCborReportRejected, TEST_THING_NAME >.view(),
+    };
+    defender::TopicMatch match;
+    int i;
+
+    for( i = 0; i < static_cast< int >( DefenderMaxTopic ); i++ )
+    {
+        match = defender::matchTopic( topics[ i ] );
+
+        TEST_ASSERT_TRUE( static_cast< bool >( match ) );
+        TEST_ASSERT_EQUAL( i, match.api );
+        TEST_ASSERT_EQUAL_PTR( topics[ i ].data() + DEFENDER_API_LENGTH_PREFIX, match.thingName.data() );
+        TEST_ASSERT_EQUAL( STRING_LITERAL_LENGTH( TEST_THING_NAME ), match.thingName.size() );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that non Device Defender topics are not matched.
+ */
+void test_Defender_Cpp_MatchTopic_NoMatch( void )
+{
+    static char longTopic[ UINT16_MAX + 1U ];
+    defender::TopicMatch match;
+
+    match = defender::matchTopic( std::string_view() );
+    TEST_ASSERT_FALSE( static_cast< bool >( match ) );
+    TEST_ASSERT_EQUAL( DefenderInvalidTopic, match.api );
+    TEST_ASSERT_TRUE( match.thingName.empty() );
+
+    match = defender::matchTopic( "$aws/things/TestThing/shadow/get" );
+    TEST_ASSERT_FALSE( static_cast< bool >( match ) );
+
+    match = defender::matchTopic( "$aws/things/TestThing/defender/metrics/json/accepted/extra" );
+    TEST_ASSERT_FALSE( static_cast< bool >( match ) );
+
+    /* Longer than any MQTT topic. */
+    match = defender::matchTopic( std::string_view( longTopic, sizeof( longTopic ) ) );
+    TEST_ASSERT_FALSE( static_cast< bool >( match ) );
+}
+/*-----------------------------------------------------------*/
+}
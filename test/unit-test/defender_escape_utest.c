@@ -0,0 +1,227 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_escape_utest.c
+ * @brief Unit tests for escaping strings in the Device Defender library.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Test framework include. */
+#include "unity.h"
+
+/* Escape API include. */
+#include "defender_escape.h"
+
+/**
+ * @brief Length of the strings built by the tests, over several blocks.
+ */
+#define TEST_STRING_LENGTH    80U
+
+/**
+ * @brief Length of the output buffer.
+ */
+#define TEST_BUFFER_LENGTH    ( 6U * TEST_STRING_LENGTH )
+
+/**
+ * @brief Escape a string literal into the test buffer.
+ */
+#define ESCAPE( string, pLength ) \
+    Defender_EscapeString( string, ( uint32_t ) STRING_LITERAL_LENGTH( string ), &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, pLength )
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief String and output buffer used in the tests.
+ */
+static char testString[ TEST_STRING_LENGTH ];
+static char testBuffer[ TEST_BUFFER_LENGTH ];
+/*-----------------------------------------------------------*/
+
+/* ============================   UNITY FIXTURES ============================ */
+
+/* Called before each test method. */
+void setUp()
+{
+    ( void ) memset( &( testString[ 0 ] ), 'a', sizeof( testString ) );
+    ( void ) memset( &( testBuffer[ 0 ] ), 0, sizeof( testBuffer ) );
+}
+
+/* Called after each test method. */
+void tearDown()
+{
+}
+
+/* Called at the beginning of the whole suite. */
+void suiteSetUp()
+{
+}
+
+/* Called at the end of the whole suite. */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test escaping quotes, backslashes and control characters, and
+ * copying valid UTF-8.
+ */
+void test_Defender_EscapeString_Happy( void )
+{
+    static const char expected[] =
+        "say \\\"hi\\\" C:\\\\dir\\b\\f\\n\\r\\t\\u0000\\u001f\x7F"
+        "caf\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x98\x80 \xF4\x8F\xBF\xBF";
+    DefenderStatus_t ret;
+    uint32_t length = 0U;
+
+    ret = ESCAPE( "say \"hi\" C:\\dir\b\f\n\r\t\0\x1F\x7F"
+                  "caf\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x98\x80 \xF4\x8F\xBF\xBF", &( length ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( STRING_LITERAL_LENGTH( expected ), length );
+    TEST_ASSERT_EQUAL_MEMORY( expected, testBuffer, length );
+
+    /* Clean strings longer than a block are copied as they are. */
+    ret = Defender_EscapeString( &( testString[ 0 ] ), TEST_STRING_LENGTH, &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( TEST_STRING_LENGTH, length );
+    TEST_ASSERT_EQUAL_MEMORY( testString, testBuffer, length );
+
+    ret = Defender_EscapeString( &( testString[ 0 ] ), 0U, &( testBuffer[ 0 ] ), 0U, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( 0U, length );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test a character to escape at every position of a string, so that
+ * it is found in every position of a block and in the last bytes.
+ */
+void test_Defender_EscapeString_EveryPosition( void )
+{
+    DefenderStatus_t ret;
+    uint32_t length = 0U, position;
+
+    for( position = 0U; position < TEST_STRING_LENGTH; position++ )
+    {
+        testString[ position ] = '"';
+
+        ret = Defender_EscapeString( &( testString[ 0 ] ), TEST_STRING_LENGTH, &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) );
+        TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+        TEST_ASSERT_EQUAL( TEST_STRING_LENGTH + 1U, length );
+        TEST_ASSERT_EQUAL_MEMORY( testString, testBuffer, position );
+        TEST_ASSERT_EQUAL( '\\', testBuffer[ position ] );
+        TEST_ASSERT_EQUAL( '"', testBuffer[ position + 1U ] );
+        TEST_ASSERT_EQUAL_MEMORY( &( testString[ position + 1U ] ), &( testBuffer[ position + 2U ] ),
+                                  TEST_STRING_LENGTH - position - 1U );
+
+        testString[ position ] = 'a';
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that invalid UTF-8 is rejected.
+ */
+void test_Defender_EscapeString_InvalidUtf8( void )
+{
+    static const char * const invalid[] =
+    {
+        "\x80",             /* Continuation byte without a start byte. */
+        "\xC0\xAF",         /* Overlong encoding of '/'. */
+        "\xC1\xBF",         /* Overlong encoding. */
+        "\xE0\x80\xAF",     /* Overlong encoding of '/'. */
+        "\xED\xA0\x80",     /* Surrogate. */
+        "\xF0\x80\x80\xAF", /* Overlong encoding of '/'. */
+        "\xF4\x90\x80\x80", /* Above U+10FFFF. */
+        "\xF5\x80\x80\x80", /* Invalid start byte. */
+        "\xFF",             /* Invalid start byte. */
+        "\xE2\x28\xA1",     /* Bad continuation byte. */
+        "\xF0\x9F\x98\x28", /* Bad last continuation byte. */
+        "\xE2\x82",         /* Sequence cut short. */
+        "\xC3"              /* Sequence cut short. */
+    };
+    DefenderStatus_t ret;
+    uint32_t length = 5U, i;
+
+    for( i = 0U; i < ( sizeof( invalid ) / sizeof( invalid[ 0 ] ) ); i++ )
+    {
+        ret = Defender_EscapeString( invalid[ i ], ( uint32_t ) strlen( invalid[ i ] ),
+                                     &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) );
+        TEST_ASSERT_EQUAL( DefenderError, ret );
+        TEST_ASSERT_EQUAL( 5U, length );
+    }
+
+    /* Invalid bytes after a clean block. */
+    testString[ TEST_STRING_LENGTH - 1U ] = ( char ) 0xC3;
+    ret = Defender_EscapeString( &( testString[ 0 ] ), TEST_STRING_LENGTH, &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderError, ret );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that the buffer length is checked.
+ */
+void test_Defender_EscapeString_BufferTooSmall( void )
+{
+    static const char string[] = "ab\"cd\x01\xC3\xA9" "efghijklmnopqrstuvwxyz";
+    DefenderStatus_t ret;
+    uint32_t length = 0U, expectedLength, bufferLength;
+
+    ret = Defender_EscapeString( string, STRING_LITERAL_LENGTH( string ), &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( expectedLength ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( STRING_LITERAL_LENGTH( string ) + 6U, expectedLength );
+
+    for( bufferLength = 0U; bufferLength < expectedLength; bufferLength++ )
+    {
+        ret = Defender_EscapeString( string, STRING_LITERAL_LENGTH( string ), &( testBuffer[ 0 ] ), bufferLength, &( length ) );
+        TEST_ASSERT_EQUAL( DefenderBufferTooSmall, ret );
+    }
+
+    ret = Defender_EscapeString( string, STRING_LITERAL_LENGTH( string ), &( testBuffer[ 0 ] ), expectedLength, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( expectedLength, length );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that invalid parameters are rejected.
+ */
+void test_Defender_EscapeString_BadParams( void )
+{
+    DefenderStatus_t ret;
+    uint32_t length = 0U;
+
+    ret = Defender_EscapeString( NULL, 1U, &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_EscapeString( "a", 1U, NULL, TEST_BUFFER_LENGTH, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_EscapeString( "a", 1U, &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, NULL );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+}
+/*-----------------------------------------------------------*/
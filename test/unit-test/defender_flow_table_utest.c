@@ -0,0 +1,463 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_flow_table_utest.c
+ * @brief Unit tests for the flow table of the Device Defender library.
+ */
+
+/* Standard includes. */
+#include <stdbool.h>
+#include <string.h>
+
+/* Test framework include. */
+#include "unity.h"
+
+/* Flow table include. */
+#include "defender_flow_table.h"
+
+/**
+ * @brief Number of flows of the test table.
+ */
+#define TEST_CAPACITY      48U
+
+/**
+ * @brief Number of slots of the test table. Few slots for the capacity make
+ * long runs of used slots, which wrap around the end of the slots.
+ */
+#define TEST_SLOT_COUNT    64U
+
+/**
+ * @brief Number of different flows used by the random test.
+ */
+#define TEST_FLOW_KINDS    96U
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Memory of the test table.
+ */
+static DefenderFlow_t testFlows[ TEST_CAPACITY ];
+static uint32_t testSlots[ TEST_SLOT_COUNT ];
+
+/**
+ * @brief The test table.
+ */
+static DefenderFlowTable_t testTable;
+
+/**
+ * @brief State of the random number generator.
+ */
+static uint32_t randomState;
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Small xorshift random number generator, so that tests repeat.
+ */
+static uint32_t nextRandom( void )
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+
+    return randomState;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Make flow number kind of the random test.
+ */
+static DefenderFlow_t makeFlow( uint32_t kind,
+                                uint64_t bytes )
+{
+    DefenderFlow_t flow;
+
+    ( void ) memset( &( flow ), 0, sizeof( flow ) );
+    flow.sourceAddress = 0xC0A80000U | ( kind % 7U );
+    flow.destinationAddress = 0x0A000000U | ( kind / 7U );
+    flow.sourcePort = ( uint16_t ) ( 40000U + ( kind % 3U ) );
+    flow.destinationPort = 443U;
+    flow.protocol = ( ( kind % 2U ) == 0U ) ? DEFENDER_FLOW_PROTOCOL_TCP : DEFENDER_FLOW_PROTOCOL_UDP;
+    flow.tcpState = ( ( kind % 2U ) == 0U ) ? DEFENDER_FLOW_TCP_STATE_ESTABLISHED : DEFENDER_FLOW_TCP_STATE_NONE;
+    flow.bytesOriginal = bytes;
+    flow.bytesReply = bytes * 2U;
+
+    return flow;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Find a flow by scanning the flows.
+ */
+static uint32_t scanForFlow( const DefenderFlow_t * pFlow )
+{
+    uint32_t i, index = UINT32_MAX;
+
+    for( i = 0U; i < testTable.count; i++ )
+    {
+        if( ( testFlows[ i ].sourceAddress == pFlow->sourceAddress ) &&
+            ( testFlows[ i ].destinationAddress == pFlow->destinationAddress ) &&
+            ( testFlows[ i ].sourcePort == pFlow->sourcePort ) &&
+            ( testFlows[ i ].destinationPort == pFlow->destinationPort ) &&
+            ( testFlows[ i ].protocol == pFlow->protocol ) )
+        {
+            index = i;
+        }
+    }
+
+    return index;
+}
+/*-----------------------------------------------------------*/
+
+/* ============================   UNITY FIXTURES ============================ */
+
+/* Called before each test method. */
+void setUp()
+{
+    randomState = 1U;
+
+    TEST_ASSERT_EQUAL( DefenderSuccess,
+                       Defender_FlowTableInit( &( testTable ), testFlows, TEST_CAPACITY,
+                                               testSlots, TEST_SLOT_COUNT ) );
+}
+
+/* Called after each test method. */
+void tearDown()
+{
+}
+
+/* Called at the beginning of the whole suite. */
+void suiteSetUp()
+{
+}
+
+/* Called at the end of the whole suite. */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test adding, updating and removing flows.
+ */
+void test_Defender_FlowTable_Happy( void )
+{
+    DefenderFlow_t flow, removed;
+    DefenderStatus_t ret;
+
+    flow = makeFlow( 0U, 100U );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_FlowTableUpdate( &( testTable ), &( flow ) ) );
+    flow = makeFlow( 1U, 200U );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_FlowTableUpdate( &( testTable ), &( flow ) ) );
+    flow = makeFlow( 2U, 300U );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_FlowTableUpdate( &( testTable ), &( flow ) ) );
+    TEST_ASSERT_EQUAL( 3U, testTable.count );
+
+    /* Updating a flow only changes its counters. */
+    flow = makeFlow( 0U, 150U );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_FlowTableUpdate( &( testTable ), &( flow ) ) );
+    TEST_ASSERT_EQUAL( 3U, testTable.count );
+    TEST_ASSERT_TRUE( testFlows[ 0 ].bytesOriginal == 150U );
+    TEST_ASSERT_TRUE( testFlows[ 0 ].bytesReply == 300U );
+
+    /* Removing the first flow moves the last one into its place. */
+    flow = makeFlow( 0U, 0U );
+    ret = Defender_FlowTableRemove( &( testTable ), &( flow ), &( removed ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_TRUE( removed.bytesOriginal == 150U );
+    TEST_ASSERT_EQUAL( 2U, testTable.count );
+    TEST_ASSERT_TRUE( testFlows[ 0 ].bytesOriginal == 300U );
+
+    ret = Defender_FlowTableRemove( &( testTable ), &( flow ), NULL );
+    TEST_ASSERT_EQUAL( DefenderError, ret );
+
+    /* The moved flow is still found. */
+    flow = makeFlow( 2U, 0U );
+    ret = Defender_FlowTableRemove( &( testTable ), &( flow ), NULL );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+
+    flow = makeFlow( 1U, 0U );
+    ret = Defender_FlowTableRemove( &( testTable ), &( flow ), NULL );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( 0U, testTable.count );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test random updates and removals against a scan of the flows.
+ */
+void test_Defender_FlowTable_Random( void )
+{
+    DefenderFlow_t flow;
+    DefenderStatus_t ret;
+    uint32_t round, kind, index, count, i;
+    bool present[ TEST_FLOW_KINDS ] = { false };
+
+    for( round = 0U; round < 20000U; round++ )
+    {
+        kind = nextRandom() % TEST_FLOW_KINDS;
+        flow = makeFlow( kind, round );
+        count = testTable.count;
+
+        if( ( nextRandom() % 2U ) == 0U )
+        {
+            ret = Defender_FlowTableUpdate( &( testTable ), &( flow ) );
+
+            if( ( present[ kind ] == false ) && ( count == TEST_CAPACITY ) )
+            {
+                TEST_ASSERT_EQUAL( DefenderBufferTooSmall, ret );
+            }
+            else
+            {
+                TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+                present[ kind ] = true;
+                index = scanForFlow( &( flow ) );
+                TEST_ASSERT_TRUE( index < testTable.count );
+                TEST_ASSERT_TRUE( testFlows[ index ].bytesOriginal == round );
+            }
+        }
+        else
+        {
+            ret = Defender_FlowTableRemove( &( testTable ), &( flow ), NULL );
+            TEST_ASSERT_EQUAL( present[ kind ] ? DefenderSuccess : DefenderError, ret );
+            present[ kind ] = false;
+            TEST_ASSERT_EQUAL( UINT32_MAX, scanForFlow( &( flow ) ) );
+        }
+    }
+
+    /* Every present flow is found through the index, and only once. */
+    count = 0U;
+
+    for( i = 0U; i < TEST_FLOW_KINDS; i++ )
+    {
+        if( present[ i ] == true )
+        {
+            flow = makeFlow( i, 0U );
+            TEST_ASSERT_EQUAL( DefenderSuccess, Defender_FlowTableRemove( &( testTable ), &( flow ), NULL ) );
+            count++;
+        }
+    }
+
+    TEST_ASSERT_TRUE( count > 0U );
+    TEST_ASSERT_EQUAL( 0U, testTable.count );
+
+    for( i = 0U; i < TEST_SLOT_COUNT; i++ )
+    {
+        TEST_ASSERT_EQUAL( 0U, testSlots[ i ] );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test clearing a table and filling it again.
+ */
+void test_Defender_FlowTableClear( void )
+{
+    DefenderFlow_t flow;
+    uint32_t kind, i;
+
+    for( kind = 0U; kind < TEST_CAPACITY; kind++ )
+    {
+        flow = makeFlow( kind, kind );
+        TEST_ASSERT_EQUAL( DefenderSuccess, Defender_FlowTableUpdate( &( testTable ), &( flow ) ) );
+    }
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_FlowTableClear( &( testTable ) ) );
+    TEST_ASSERT_EQUAL( 0U, testTable.count );
+
+    for( i = 0U; i < TEST_SLOT_COUNT; i++ )
+    {
+        TEST_ASSERT_EQUAL( 0U, testSlots[ i ] );
+    }
+
+    /* The cleared flows are not found, and the table can be filled again. */
+    flow = makeFlow( 0U, 0U );
+    TEST_ASSERT_EQUAL( DefenderError, Defender_FlowTableRemove( &( testTable ), &( flow ), NULL ) );
+
+    for( kind = 0U; kind < TEST_CAPACITY; kind++ )
+    {
+        flow = makeFlow( kind, kind + 1U );
+        TEST_ASSERT_EQUAL( DefenderSuccess, Defender_FlowTableUpdate( &( testTable ), &( flow ) ) );
+    }
+
+    TEST_ASSERT_EQUAL( TEST_CAPACITY, testTable.count );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test building connections from the TCP flows.
+ */
+void test_Defender_FlowTableGetConnections( void )
+{
+    uint32_t addresses[ 2 ];
+    uint16_t remotePorts[ 2 ], localPorts[ 2 ];
+    uint8_t interfaceIds[ 2 ];
+    DefenderConnectionTable_t connections;
+    DefenderFlow_t flow;
+    DefenderStatus_t ret;
+    uint32_t kind;
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_ConnectionTableInit( &( connections ), addresses, remotePorts,
+                                                                      localPorts, interfaceIds, 2U ) );
+
+    /* Two TCP flows and one UDP flow. */
+    for( kind = 0U; kind < 3U; kind++ )
+    {
+        flow = makeFlow( kind * 2U, 0U );
+        flow.protocol = ( kind == 1U ) ? DEFENDER_FLOW_PROTOCOL_UDP : DEFENDER_FLOW_PROTOCOL_TCP;
+        TEST_ASSERT_EQUAL( DefenderSuccess, Defender_FlowTableUpdate( &( testTable ), &( flow ) ) );
+    }
+
+    ret = Defender_FlowTableGetConnections( &( testTable ), &( connections ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( 2U, connections.count );
+    TEST_ASSERT_EQUAL_HEX32( 0x0A000000U, addresses[ 0 ] );
+    TEST_ASSERT_EQUAL( 443U, remotePorts[ 0 ] );
+    TEST_ASSERT_EQUAL( 40000U, localPorts[ 0 ] );
+    TEST_ASSERT_EQUAL( 0U, interfaceIds[ 0 ] );
+    TEST_ASSERT_EQUAL( 40001U, localPorts[ 1 ] );
+
+    /* The connection table is full. */
+    ret = Defender_FlowTableGetConnections( &( testTable ), &( connections ) );
+    TEST_ASSERT_EQUAL( DefenderBufferTooSmall, ret );
+
+    ret = Defender_FlowTableGetConnections( NULL, &( connections ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_FlowTableGetConnections( &( testTable ), NULL );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that only established TCP flows become connections, as their
+ * state changes.
+ */
+void test_Defender_FlowTableGetConnections_TcpStates( void )
+{
+    /* Conntrack TCP states: SYN_SENT, ESTABLISHED, FIN_WAIT, TIME_WAIT,
+     * CLOSE_WAIT and ESTABLISHED again. */
+    static const uint8_t states[ 6 ] = { 1U, DEFENDER_FLOW_TCP_STATE_ESTABLISHED, 4U, 7U, 5U, DEFENDER_FLOW_TCP_STATE_ESTABLISHED };
+    uint32_t addresses[ 6 ];
+    uint16_t remotePorts[ 6 ], localPorts[ 6 ];
+    uint8_t interfaceIds[ 6 ];
+    DefenderConnectionTable_t connections;
+    DefenderFlow_t flow;
+    uint32_t kind;
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_ConnectionTableInit( &( connections ), addresses, remotePorts,
+                                                                      localPorts, interfaceIds, 6U ) );
+
+    for( kind = 0U; kind < 6U; kind++ )
+    {
+        flow = makeFlow( kind * 2U, 0U );
+        flow.tcpState = states[ kind ];
+        TEST_ASSERT_EQUAL( DefenderSuccess, Defender_FlowTableUpdate( &( testTable ), &( flow ) ) );
+    }
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_FlowTableGetConnections( &( testTable ), &( connections ) ) );
+    TEST_ASSERT_EQUAL( 2U, connections.count );
+    TEST_ASSERT_EQUAL( 40002U, localPorts[ 0 ] );
+    TEST_ASSERT_EQUAL( 40001U, localPorts[ 1 ] );
+    TEST_ASSERT_EQUAL_HEX32( 0x0A000000U, addresses[ 0 ] );
+    TEST_ASSERT_EQUAL_HEX32( 0x0A000001U, addresses[ 1 ] );
+
+    /* The first flow is established and the second is closing. An update
+     * without a state keeps the state. */
+    flow = makeFlow( 0U, 10U );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_FlowTableUpdate( &( testTable ), &( flow ) ) );
+    flow = makeFlow( 2U, 10U );
+    flow.tcpState = 4U;
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_FlowTableUpdate( &( testTable ), &( flow ) ) );
+    flow = makeFlow( 2U, 20U );
+    flow.tcpState = DEFENDER_FLOW_TCP_STATE_NONE;
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_FlowTableUpdate( &( testTable ), &( flow ) ) );
+    TEST_ASSERT_EQUAL( 4U, testFlows[ 1 ].tcpState );
+    TEST_ASSERT_TRUE( testFlows[ 1 ].bytesOriginal == 20U );
+
+    connections.count = 0U;
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_FlowTableGetConnections( &( testTable ), &( connections ) ) );
+    TEST_ASSERT_EQUAL( 2U, connections.count );
+    TEST_ASSERT_EQUAL( 40000U, localPorts[ 0 ] );
+    TEST_ASSERT_EQUAL_HEX32( 0x0A000000U, addresses[ 0 ] );
+    TEST_ASSERT_EQUAL( 40001U, localPorts[ 1 ] );
+    TEST_ASSERT_EQUAL_HEX32( 0x0A000001U, addresses[ 1 ] );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test invalid parameters.
+ */
+void test_Defender_FlowTable_BadParameters( void )
+{
+    DefenderFlowTable_t table;
+    DefenderFlow_t flow = makeFlow( 0U, 0U );
+    DefenderStatus_t ret;
+
+    ret = Defender_FlowTableInit( NULL, testFlows, TEST_CAPACITY, testSlots, TEST_SLOT_COUNT );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_FlowTableInit( &( table ), NULL, TEST_CAPACITY, testSlots, TEST_SLOT_COUNT );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_FlowTableInit( &( table ), testFlows, TEST_CAPACITY, NULL, TEST_SLOT_COUNT );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    /* The slots must outnumber the flows and be a power of two. */
+    ret = Defender_FlowTableInit( &( table ), testFlows, TEST_CAPACITY, testSlots, TEST_CAPACITY );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_FlowTableInit( &( table ), testFlows, TEST_CAPACITY, testSlots, TEST_SLOT_COUNT - 1U );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_FlowTableUpdate( NULL, &( flow ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_FlowTableUpdate( &( testTable ), NULL );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_FlowTableRemove( NULL, &( flow ), NULL );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_FlowTableRemove( &( testTable ), NULL, NULL );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ( void ) memset( &( table ), 0, sizeof( table ) );
+
+    ret = Defender_FlowTableUpdate( &( table ), &( flow ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_FlowTableRemove( &( table ), &( flow ), NULL );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_FlowTableGetConnections( &( table ), NULL );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_FlowTableClear( &( table ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_FlowTableClear( NULL );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+}
+/*-----------------------------------------------------------*/
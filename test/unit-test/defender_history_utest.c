@@ -0,0 +1,383 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_history_utest.c
+ * @brief Unit tests for the metric history of the Device Defender library.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Test framework include. */
+#include "unity.h"
+
+/* History include. */
+#include "defender_history.h"
+
+/**
+ * @brief Number of blocks of the test history.
+ */
+#define TEST_BLOCK_COUNT     8U
+
+/**
+ * @brief Length of the data of a block of the test history.
+ */
+#define TEST_BLOCK_LENGTH    256U
+
+/**
+ * @brief Largest number of samples of a test.
+ */
+#define TEST_SAMPLE_COUNT    4096U
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Memory of the test history.
+ */
+static DefenderHistoryBlock_t testBlocks[ TEST_BLOCK_COUNT ];
+static uint8_t testData[ TEST_BLOCK_COUNT * TEST_BLOCK_LENGTH ];
+
+/**
+ * @brief The test history.
+ */
+static DefenderHistory_t testHistory;
+
+/**
+ * @brief The samples added to the test history, and the samples read back.
+ */
+static DefenderHistorySample_t addedSamples[ TEST_SAMPLE_COUNT ];
+static DefenderHistorySample_t readSamples[ TEST_SAMPLE_COUNT ];
+
+/**
+ * @brief State of the random number generator.
+ */
+static uint32_t randomState;
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Small xorshift random number generator, so that tests repeat.
+ */
+static uint32_t nextRandom( void )
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+
+    return randomState;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Add count samples to the test history, from a mix of regular and
+ * irregular intervals and of slow and random values.
+ */
+static void addSamples( uint32_t count )
+{
+    uint64_t timestamp = 1000U, value = 0U;
+    uint32_t i;
+
+    for( i = 0U; i < count; i++ )
+    {
+        switch( ( i / 64U ) % 4U )
+        {
+            case 0U:
+                /* A counter collected every minute. */
+                timestamp += 60000U;
+                value += nextRandom() % 1024U;
+                break;
+
+            case 1U:
+                /* Jitter in the interval, and a value which does not change. */
+                timestamp += 59800U + ( nextRandom() % 400U );
+                break;
+
+            case 2U:
+                /* Gaps of any length, and values of any size. */
+                timestamp += 1U + ( ( uint64_t ) nextRandom() << ( nextRandom() % 16U ) );
+                value = ( ( uint64_t ) nextRandom() << 32 ) | nextRandom();
+                break;
+
+            default:
+                /* A value going down. */
+                timestamp += 1000U * ( 1U + ( nextRandom() % 5U ) );
+                value -= nextRandom() % 100000U;
+                break;
+        }
+
+        addedSamples[ i ].timestamp = timestamp;
+        addedSamples[ i ].value = value;
+        TEST_ASSERT_EQUAL( DefenderSuccess, Defender_HistoryAppend( &( testHistory ), timestamp, value ) );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Scan the whole test history, and return the index in addedSamples
+ * of the oldest sample kept.
+ */
+static uint32_t checkScan( uint32_t addedCount )
+{
+    uint32_t count = 0U, first, i;
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_HistoryScan( &( testHistory ), 0U, UINT64_MAX, readSamples,
+                                                              TEST_SAMPLE_COUNT, &( count ) ) );
+    TEST_ASSERT_GREATER_THAN( 0U, count );
+    TEST_ASSERT_LESS_OR_EQUAL( addedCount, count );
+    first = addedCount - count;
+
+    for( i = 0U; i < count; i++ )
+    {
+        TEST_ASSERT_EQUAL_UINT64( addedSamples[ first + i ].timestamp, readSamples[ i ].timestamp );
+        TEST_ASSERT_EQUAL_UINT64( addedSamples[ first + i ].value, readSamples[ i ].value );
+    }
+
+    return first;
+}
+/*-----------------------------------------------------------*/
+
+/* ============================   UNITY FIXTURES ============================ */
+
+/* Called before each test method. */
+void setUp()
+{
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_HistoryInit( &( testHistory ), testBlocks, TEST_BLOCK_COUNT,
+                                                              testData, TEST_BLOCK_LENGTH ) );
+    randomState = 2463534242U;
+}
+
+/* Called after each test method. */
+void tearDown()
+{
+}
+
+/* Called at the beginning of the whole suite. */
+void suiteSetUp()
+{
+}
+
+/* Called at the end of the whole suite. */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test invalid parameters.
+ */
+void test_History_BadParameters( void )
+{
+    DefenderHistorySummary_t summary;
+    DefenderHistory_t history;
+    uint32_t count = 0U;
+
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_HistoryInit( NULL, testBlocks, 1U, testData, 19U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_HistoryInit( &( history ), NULL, 1U, testData, 19U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_HistoryInit( &( history ), testBlocks, 0U, testData, 19U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_HistoryInit( &( history ), testBlocks, 1U, NULL, 19U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_HistoryInit( &( history ), testBlocks, 1U, testData, 18U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_HistoryInit( &( history ), testBlocks, 1U, testData, UINT32_MAX ) );
+
+    ( void ) memset( &( history ), 0, sizeof( history ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_HistoryAppend( NULL, 1U, 1U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_HistoryAppend( &( history ), 1U, 1U ) );
+
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_HistoryScan( NULL, 0U, 1U, readSamples, 1U, &( count ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_HistoryScan( &( history ), 0U, 1U, readSamples, 1U, &( count ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_HistoryScan( &( testHistory ), 2U, 1U, readSamples, 1U, &( count ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_HistoryScan( &( testHistory ), 0U, 1U, NULL, 1U, &( count ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_HistoryScan( &( testHistory ), 0U, 1U, readSamples, 1U, NULL ) );
+
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_HistoryAggregate( NULL, 0U, 1U, &( summary ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_HistoryAggregate( &( history ), 0U, 1U, &( summary ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_HistoryAggregate( &( testHistory ), 2U, 1U, &( summary ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_HistoryAggregate( &( testHistory ), 0U, 1U, NULL ) );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that samples are read back as they were added, and that
+ * samples which are not after the last one are refused.
+ */
+void test_History_RoundTrip( void )
+{
+    DefenderHistorySummary_t summary;
+    uint32_t count = 0U;
+
+    /* An empty history has no sample. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_HistoryScan( &( testHistory ), 0U, UINT64_MAX, readSamples,
+                                                              TEST_SAMPLE_COUNT, &( count ) ) );
+    TEST_ASSERT_EQUAL( 0U, count );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_HistoryAggregate( &( testHistory ), 0U, UINT64_MAX, &( summary ) ) );
+    TEST_ASSERT_EQUAL( 0U, summary.count );
+
+    addSamples( 200U );
+    TEST_ASSERT_EQUAL( 0U, checkScan( 200U ) );
+
+    TEST_ASSERT_EQUAL( DefenderError, Defender_HistoryAppend( &( testHistory ), addedSamples[ 199 ].timestamp, 1U ) );
+    TEST_ASSERT_EQUAL( DefenderError, Defender_HistoryAppend( &( testHistory ), addedSamples[ 199 ].timestamp - 1U, 1U ) );
+    TEST_ASSERT_EQUAL( 0U, checkScan( 200U ) );
+
+    /* Times up to the largest one. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_HistoryAppend( &( testHistory ), UINT64_MAX, UINT64_MAX ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_HistoryScan( &( testHistory ), UINT64_MAX, UINT64_MAX, readSamples,
+                                                              TEST_SAMPLE_COUNT, &( count ) ) );
+    TEST_ASSERT_EQUAL( 1U, count );
+    TEST_ASSERT_EQUAL_UINT64( UINT64_MAX, readSamples[ 0 ].value );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test how small regular samples are.
+ */
+void test_History_Compression( void )
+{
+    uint64_t value = 0U;
+    uint32_t i;
+
+    /* A counter collected every minute which grows by less than 1024 takes 1
+     * bit for the time and up to 2 + 12 + 64 - 53 bits for the value. */
+    for( i = 0U; i < 600U; i++ )
+    {
+        value += 1U + ( nextRandom() % 1023U );
+        addedSamples[ i ].timestamp = 60000U * ( i + 1U );
+        addedSamples[ i ].value = value;
+        TEST_ASSERT_EQUAL( DefenderSuccess, Defender_HistoryAppend( &( testHistory ), addedSamples[ i ].timestamp, value ) );
+    }
+
+    TEST_ASSERT_EQUAL( 0U, checkScan( 600U ) );
+    TEST_ASSERT_GREATER_THAN( 90U, testBlocks[ 0 ].summary.count );
+
+    /* A value which does not change takes 2 bits, after the first interval. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_HistoryInit( &( testHistory ), testBlocks, TEST_BLOCK_COUNT,
+                                                              testData, TEST_BLOCK_LENGTH ) );
+
+    for( i = 0U; i < 950U; i++ )
+    {
+        TEST_ASSERT_EQUAL( DefenderSuccess, Defender_HistoryAppend( &( testHistory ), 60000U * ( i + 1U ), 42U ) );
+    }
+
+    TEST_ASSERT_EQUAL( 1U, testHistory.usedCount );
+    TEST_ASSERT_EQUAL( 950U, testBlocks[ 0 ].summary.count );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that the oldest blocks are dropped when the history is full.
+ */
+void test_History_Ring( void )
+{
+    uint32_t round, first = 0U, previousFirst = 0U;
+
+    /* Many small blocks, dropped many times. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_HistoryInit( &( testHistory ), testBlocks, 3U, testData,
+                                                              DEFENDER_HISTORY_MIN_BLOCK_LENGTH ) );
+    addSamples( 2000U );
+    first = checkScan( 2000U );
+    TEST_ASSERT_GREATER_THAN( 0U, first );
+    TEST_ASSERT_EQUAL( 3U, testHistory.usedCount );
+
+    /* A larger history keeps the newest samples of each round. */
+    for( round = 1U; round <= 4U; round++ )
+    {
+        TEST_ASSERT_EQUAL( DefenderSuccess, Defender_HistoryInit( &( testHistory ), testBlocks, TEST_BLOCK_COUNT,
+                                                                  testData, TEST_BLOCK_LENGTH ) );
+        addSamples( 1000U * round );
+        first = checkScan( 1000U * round );
+        TEST_ASSERT_GREATER_OR_EQUAL( previousFirst, first );
+        previousFirst = first;
+    }
+
+    TEST_ASSERT_GREATER_THAN( 0U, first );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test scans and aggregates of ranges against the added samples.
+ */
+void test_History_Ranges( void )
+{
+    DefenderHistorySummary_t summary, expected;
+    uint32_t first, trial, i, start, end, count = 0U, total;
+    uint64_t startMs, endMs;
+
+    addSamples( 3000U );
+    first = checkScan( 3000U );
+
+    for( trial = 0U; trial < 500U; trial++ )
+    {
+        start = first + ( nextRandom() % ( 3000U - first ) );
+        end = start + ( nextRandom() % ( 3000U - start ) );
+
+        /* Ranges which start and end between samples, or at samples. */
+        startMs = addedSamples[ start ].timestamp - ( ( ( trial % 2U ) == 0U ) ? 1U : 0U );
+        endMs = addedSamples[ end ].timestamp + ( ( ( trial % 3U ) == 0U ) ? 1U : 0U );
+
+        ( void ) memset( &( expected ), 0, sizeof( expected ) );
+        expected.firstTimestamp = addedSamples[ start ].timestamp;
+        expected.firstValue = addedSamples[ start ].value;
+        expected.lastTimestamp = addedSamples[ end ].timestamp;
+        expected.lastValue = addedSamples[ end ].value;
+        expected.minValue = UINT64_MAX;
+
+        for( i = start; i <= end; i++ )
+        {
+            expected.minValue = ( addedSamples[ i ].value < expected.minValue ) ? addedSamples[ i ].value : expected.minValue;
+            expected.maxValue = ( addedSamples[ i ].value > expected.maxValue ) ? addedSamples[ i ].value : expected.maxValue;
+            expected.sum += addedSamples[ i ].value;
+            expected.count++;
+        }
+
+        TEST_ASSERT_EQUAL( DefenderSuccess, Defender_HistoryAggregate( &( testHistory ), startMs, endMs, &( summary ) ) );
+        TEST_ASSERT_EQUAL( 0, memcmp( &( expected ), &( summary ), sizeof( summary ) ) );
+
+        TEST_ASSERT_EQUAL( DefenderSuccess, Defender_HistoryScan( &( testHistory ), startMs, endMs, readSamples,
+                                                                  TEST_SAMPLE_COUNT, &( count ) ) );
+        TEST_ASSERT_EQUAL( end - start + 1U, count );
+        TEST_ASSERT_EQUAL( 0, memcmp( &( addedSamples[ start ] ), readSamples, count * sizeof( DefenderHistorySample_t ) ) );
+    }
+
+    /* A scan goes on from the time after the last sample it returned. */
+    startMs = 0U;
+    total = 0U;
+
+    while( Defender_HistoryScan( &( testHistory ), startMs, UINT64_MAX, readSamples, 7U, &( count ) ) == DefenderBufferTooSmall )
+    {
+        TEST_ASSERT_EQUAL( 7U, count );
+        TEST_ASSERT_EQUAL_UINT64( addedSamples[ first + total ].timestamp, readSamples[ 0 ].timestamp );
+        startMs = readSamples[ 6 ].timestamp + 1U;
+        total += count;
+    }
+
+    TEST_ASSERT_EQUAL( 3000U - first, total + count );
+
+    /* Ranges before and after all samples. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_HistoryAggregate( &( testHistory ), 0U, addedSamples[ first ].timestamp - 1U,
+                                                                   &( summary ) ) );
+    TEST_ASSERT_EQUAL( 0U, summary.count );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_HistoryScan( &( testHistory ), addedSamples[ 2999 ].timestamp + 1U, UINT64_MAX,
+                                                              readSamples, 1U, &( count ) ) );
+    TEST_ASSERT_EQUAL( 0U, count );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,231 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/**
+ * @file defender_index_utest.c
+ * @brief Unit tests for the structural index of the Device Defender library.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Test framework include. */
+#include "unity.h"
+
+/* Index API include. */
+#include "defender_index.h"
+
+/**
+ * @brief Length of the payloads built by the tests, over three blocks.
+ */
+#define TEST_PAYLOAD_LENGTH    ( 3U * 64U )
+
+/**
+ * @brief Index a string literal.
+ */
+#define INDEX( payload, pIndex, indexLength, pCount ) \
+    Defender_IndexStructurals( payload, ( uint32_t ) STRING_LITERAL_LENGTH( payload ), pIndex, indexLength, pCount )
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Payload and index used in the tests.
+ */
+static char testPayload[ TEST_PAYLOAD_LENGTH ];
+static uint32_t testIndex[ TEST_PAYLOAD_LENGTH ];
+/*-----------------------------------------------------------*/
+
+/* ============================   UNITY FIXTURES ============================ */
+
+/* Called before each test method. */
+void setUp()
+{
+    ( void ) memset( &( testPayload[ 0 ] ), ' ', sizeof( testPayload ) );
+    ( void ) memset( &( testIndex[ 0 ] ), 0xA5, sizeof( testIndex ) );
+}
+
+/* Called after each test method. */
+void tearDown()
+{
+}
+
+/* Called at the beginning of the whole suite. */
+void suiteSetUp()
+{
+}
+
+/* Called at the end of the whole suite. */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that structural characters are found outside strings only.
+ */
+void test_Defender_IndexStructurals_Happy( void )
+{
+    static const uint32_t expected[] = { 0, 1, 3, 5, 7, 9, 11, 15, 16, 17, 19, 23, 24, 25, 26, 27 };
+    DefenderStatus_t ret;
+    uint32_t count = 0U;
+
+    ret = INDEX( "{\"a\" : [1, \"x,y\"], \"b\\\\\":{}}", &( testIndex[ 0 ] ), TEST_PAYLOAD_LENGTH, &( count ) );
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( sizeof( expected ) / sizeof( expected[ 0 ] ), count );
+    TEST_ASSERT_EQUAL_UINT32_ARRAY( expected, testIndex, count );
+
+    /* Nothing structural at all. */
+    ret = INDEX( " 123 ", &( testIndex[ 0 ] ), TEST_PAYLOAD_LENGTH, &( count ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( 0U, count );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test strings and escapes which cross the boundary between blocks.
+ */
+void test_Defender_IndexStructurals_CrossBlock( void )
+{
+    DefenderStatus_t ret;
+    uint32_t count = 0U;
+
+    /* A string from byte 10 to byte 150 with an escaped quote at byte 64,
+     * escaped by the backslash at the end of the first block. */
+    testPayload[ 0 ] = '[';
+    testPayload[ 10 ] = '"';
+    testPayload[ 63 ] = '\\';
+    testPayload[ 64 ] = '"';
+    testPayload[ 100 ] = ',';
+    testPayload[ 150 ] = '"';
+    /* Two escaped backslashes across the second boundary, in a string. */
+    testPayload[ 126 ] = '\\';
+    testPayload[ 127 ] = '\\';
+    testPayload[ 128 ] = '\\';
+    testPayload[ 129 ] = '\\';
+    testPayload[ 151 ] = ',';
+    testPayload[ 160 ] = '"';
+    testPayload[ 191 ] = '"';
+
+    ret = Defender_IndexStructurals( &( testPayload[ 0 ] ), 191U, &( testIndex[ 0 ] ), TEST_PAYLOAD_LENGTH, &( count ) );
+    TEST_ASSERT_EQUAL( DefenderError, ret );
+
+    testPayload[ 190 ] = ']';
+    testPayload[ 189 ] = '"';
+
+    ret = Defender_IndexStructurals( &( testPayload[ 0 ] ), 191U, &( testIndex[ 0 ] ), TEST_PAYLOAD_LENGTH, &( count ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( 7U, count );
+    TEST_ASSERT_EQUAL( 0U, testIndex[ 0 ] );
+    TEST_ASSERT_EQUAL( 10U, testIndex[ 1 ] );
+    TEST_ASSERT_EQUAL( 150U, testIndex[ 2 ] );
+    TEST_ASSERT_EQUAL( 151U, testIndex[ 3 ] );
+    TEST_ASSERT_EQUAL( 160U, testIndex[ 4 ] );
+    TEST_ASSERT_EQUAL( 189U, testIndex[ 5 ] );
+    TEST_ASSERT_EQUAL( 190U, testIndex[ 6 ] );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that payloads which cannot be valid JSON are rejected.
+ */
+void test_Defender_IndexStructurals_Invalid( void )
+{
+    DefenderStatus_t ret;
+    uint32_t count = 0U;
+
+    /* Unclosed strings. */
+    ret = INDEX( "{\"a", &( testIndex[ 0 ] ), TEST_PAYLOAD_LENGTH, &( count ) );
+    TEST_ASSERT_EQUAL( DefenderError, ret );
+
+    ret = INDEX( "{\"a\\\"}", &( testIndex[ 0 ] ), TEST_PAYLOAD_LENGTH, &( count ) );
+    TEST_ASSERT_EQUAL( DefenderError, ret );
+
+    /* Control characters must be escaped in strings, and are whitespace or
+     * invalid outside of them. */
+    ret = INDEX( "\"a\tb\"", &( testIndex[ 0 ] ), TEST_PAYLOAD_LENGTH, &( count ) );
+    TEST_ASSERT_EQUAL( DefenderError, ret );
+
+    ret = INDEX( "\"a\\\tb\"\t", &( testIndex[ 0 ] ), TEST_PAYLOAD_LENGTH, &( count ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( 2U, count );
+
+    /* Backslashes are only valid in strings. */
+    ret = INDEX( "[\\\"a\"]", &( testIndex[ 0 ] ), TEST_PAYLOAD_LENGTH, &( count ) );
+    TEST_ASSERT_EQUAL( DefenderError, ret );
+
+    /* The index must not be written on errors found in a later block. */
+    testPayload[ 0 ] = '{';
+    testPayload[ 100 ] = '\\';
+    count = 5U;
+
+    ret = Defender_IndexStructurals( &( testPayload[ 0 ] ), TEST_PAYLOAD_LENGTH, &( testIndex[ 0 ] ), TEST_PAYLOAD_LENGTH, &( count ) );
+    TEST_ASSERT_EQUAL( DefenderError, ret );
+    TEST_ASSERT_EQUAL( 5U, count );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that the index length is checked.
+ */
+void test_Defender_IndexStructurals_BufferTooSmall( void )
+{
+    DefenderStatus_t ret;
+    uint32_t count = 0U;
+
+    ret = INDEX( "{\"a\":1}", &( testIndex[ 0 ] ), 4U, &( count ) );
+    TEST_ASSERT_EQUAL( DefenderBufferTooSmall, ret );
+    TEST_ASSERT_EQUAL_HEX32( 0xA5A5A5A5U, testIndex[ 4 ] );
+
+    ret = INDEX( "{\"a\":1}", &( testIndex[ 0 ] ), 5U, &( count ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( 5U, count );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that invalid parameters are rejected.
+ */
+void test_Defender_IndexStructurals_BadParams( void )
+{
+    DefenderStatus_t ret;
+    uint32_t count = 0U;
+
+    ret = Defender_IndexStructurals( NULL, 1U, &( testIndex[ 0 ] ), TEST_PAYLOAD_LENGTH, &( count ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_IndexStructurals( "{}", 0U, &( testIndex[ 0 ] ), TEST_PAYLOAD_LENGTH, &( count ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_IndexStructurals( "{}", 2U, NULL, TEST_PAYLOAD_LENGTH, &( count ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_IndexStructurals( "{}", 2U, &( testIndex[ 0 ] ), 0U, &( count ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_IndexStructurals( "{}", 2U, &( testIndex[ 0 ] ), TEST_PAYLOAD_LENGTH, NULL );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,607 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_metric_segment_utest.c
+ * @brief Unit tests for the metric segment of the Device Defender library.
+ */
+
+/* Standard includes. */
+#include <string.h>
+#include <pthread.h>
+
+/* Test framework include. */
+#include "unity.h"
+
+/* Metric segment include. */
+#include "defender_metric_segment.h"
+
+/* Rate include. */
+#include "defender_rate.h"
+
+/**
+ * @brief Number of records of the test segment.
+ */
+#define TEST_RECORD_COUNT     5U
+
+/**
+ * @brief Maximum value length of the test segment.
+ */
+#define TEST_VALUE_LENGTH     40U
+
+/**
+ * @brief Length of the test segment: a header and 5 records of 64 bytes.
+ */
+#define TEST_SEGMENT_LENGTH   ( 64U + ( 5U * 64U ) )
+
+/**
+ * @brief Length of the buffer used in the serializer tests.
+ */
+#define TEST_BUFFER_LENGTH    256U
+
+/**
+ * @brief Number of serializations made in the test of concurrent writes.
+ */
+#define TEST_SERIALIZE_COUNT  100000U
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Memory of the test segment, aligned to 8 bytes.
+ */
+static uint64_t testMemory[ TEST_SEGMENT_LENGTH / 8U ];
+
+/**
+ * @brief The test segment.
+ */
+static DefenderMetricSegment_t testSegment;
+
+/**
+ * @brief Buffer used in the serializer tests.
+ */
+static char testBuffer[ TEST_BUFFER_LENGTH ];
+
+/**
+ * @brief Metric names of the test segment. The last record has no name.
+ */
+static const char * testNames[ TEST_RECORD_COUNT - 1U ] = { "cpu", "peers", "temps", "users" };
+static uint16_t testNameLengths[ TEST_RECORD_COUNT - 1U ] = { 3U, 5U, 5U, 5U };
+
+/**
+ * @brief State shared with the writer thread of the test of concurrent writes.
+ */
+typedef struct TestWriterState
+{
+    pthread_mutex_t mutex; /**< @brief Guards the other members. */
+    int stop;              /**< @brief Set to stop the writer. */
+    int failed;            /**< @brief Set by the writer if a write fails. */
+} TestWriterState_t;
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Write the values used in the serializer tests.
+ */
+static void writeTestValues( void )
+{
+    uint64_t number = 26U, numbers[ 2 ] = { 1U, UINT64_MAX };
+    uint32_t addresses[ 2 ] = { 0x0A000001U, 0xC0A80101U };
+    uint8_t strings[ 10 ];
+    uint16_t length;
+
+    length = 3U;
+    ( void ) memcpy( &( strings[ 0 ] ), &( length ), sizeof( length ) );
+    ( void ) memcpy( &( strings[ 2 ] ), "a\"b", 3U );
+    length = 3U;
+    ( void ) memcpy( &( strings[ 5 ] ), &( length ), sizeof( length ) );
+    ( void ) memcpy( &( strings[ 7 ] ), "caf", 3U );
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_MetricSegmentWrite( &( testSegment ), 0U, DefenderMetricNumber,
+                                                                     ( const uint8_t * ) &( number ), sizeof( number ) ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_MetricSegmentWrite( &( testSegment ), 1U, DefenderMetricIpList,
+                                                                     ( const uint8_t * ) addresses, sizeof( addresses ) ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_MetricSegmentWrite( &( testSegment ), 2U, DefenderMetricNumberList,
+                                                                     ( const uint8_t * ) numbers, sizeof( numbers ) ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_MetricSegmentWrite( &( testSegment ), 3U, DefenderMetricStringList,
+                                                                     strings, sizeof( strings ) ) );
+    /* The last record has a value but no name. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_MetricSegmentWrite( &( testSegment ), 4U, DefenderMetricNumber,
+                                                                     ( const uint8_t * ) &( number ), sizeof( number ) ) );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Replace the value of the fourth record, in turns, by a list of 20
+ * empty strings and by a list of one string of 38 bytes, until stopped.
+ *
+ * The length fields of one value fall in the string of the other, so a read
+ * mixing both values finds lengths running past the value.
+ *
+ * @param[in] pArgument The #TestWriterState_t shared with the test.
+ *
+ * @return NULL.
+ */
+static void * writeAlternateValues( void * pArgument )
+{
+    TestWriterState_t * pState = ( TestWriterState_t * ) pArgument;
+    uint8_t emptyStrings[ TEST_VALUE_LENGTH ] = { 0 }, longString[ TEST_VALUE_LENGTH ];
+    uint16_t length = TEST_VALUE_LENGTH - 2U;
+    uint32_t i;
+    int stop = 0, failed = 0;
+
+    ( void ) memcpy( &( longString[ 0 ] ), &( length ), sizeof( length ) );
+    ( void ) memset( &( longString[ 2 ] ), 'x', TEST_VALUE_LENGTH - 2U );
+
+    for( i = 0U; stop == 0; i++ )
+    {
+        if( Defender_MetricSegmentWrite( &( testSegment ), 3U, DefenderMetricStringList,
+                                         ( ( i % 2U ) == 0U ) ? longString : emptyStrings,
+                                         TEST_VALUE_LENGTH ) != DefenderSuccess )
+        {
+            failed = 1;
+        }
+
+        ( void ) pthread_mutex_lock( &( pState->mutex ) );
+        stop = pState->stop;
+        pState->failed |= failed;
+        ( void ) pthread_mutex_unlock( &( pState->mutex ) );
+    }
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+
+/* ============================   UNITY FIXTURES ============================ */
+
+/* Called before each test method. */
+void setUp()
+{
+    ( void ) memset( testMemory, 0xA5, sizeof( testMemory ) );
+    ( void ) memset( &( testBuffer[ 0 ] ), 0, sizeof( testBuffer ) );
+
+    TEST_ASSERT_EQUAL( DefenderSuccess,
+                       Defender_MetricSegmentInit( ( uint8_t * ) testMemory, sizeof( testMemory ),
+                                                   TEST_RECORD_COUNT, TEST_VALUE_LENGTH, &( testSegment ) ) );
+}
+
+/* Called after each test method. */
+void tearDown()
+{
+}
+
+/* Called at the beginning of the whole suite. */
+void suiteSetUp()
+{
+}
+
+/* Called at the end of the whole suite. */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test the length of segments.
+ */
+void test_Defender_MetricSegmentGetSize_Happy( void )
+{
+    DefenderStatus_t ret;
+    uint32_t length = 0U;
+
+    ret = Defender_MetricSegmentGetSize( TEST_RECORD_COUNT, TEST_VALUE_LENGTH, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( TEST_SEGMENT_LENGTH, length );
+
+    /* A 49 byte value makes records of two cache lines. */
+    ret = Defender_MetricSegmentGetSize( 2U, 49U, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( 64U + ( 2U * 128U ), length );
+
+    ret = Defender_MetricSegmentGetSize( 0U, 8U, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_MetricSegmentGetSize( 1U, UINT32_MAX, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_MetricSegmentGetSize( UINT32_MAX / 64U, 8U, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_MetricSegmentGetSize( 1U, 8U, NULL );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test creating a segment and attaching to it.
+ */
+void test_Defender_MetricSegmentAttach_Happy( void )
+{
+    DefenderMetricSegment_t segment;
+    DefenderStatus_t ret;
+    uint8_t * pMemory = ( uint8_t * ) testMemory;
+
+    ret = Defender_MetricSegmentAttach( pMemory, sizeof( testMemory ), &( segment ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL_PTR( pMemory, segment.pMemory );
+    TEST_ASSERT_EQUAL( TEST_RECORD_COUNT, segment.recordCount );
+    TEST_ASSERT_EQUAL( TEST_VALUE_LENGTH, segment.valueLength );
+    TEST_ASSERT_EQUAL( 64U, segment.recordLength );
+
+    /* Truncated memory. */
+    ret = Defender_MetricSegmentAttach( pMemory, sizeof( testMemory ) - 1U, &( segment ) );
+    TEST_ASSERT_EQUAL( DefenderError, ret );
+
+    ret = Defender_MetricSegmentAttach( pMemory, 63U, &( segment ) );
+    TEST_ASSERT_EQUAL( DefenderError, ret );
+
+    /* Unknown version. */
+    pMemory[ 4 ]++;
+    ret = Defender_MetricSegmentAttach( pMemory, sizeof( testMemory ), &( segment ) );
+    TEST_ASSERT_EQUAL( DefenderError, ret );
+
+    /* Not a segment. */
+    pMemory[ 0 ] = 0U;
+    ret = Defender_MetricSegmentAttach( pMemory, sizeof( testMemory ), &( segment ) );
+    TEST_ASSERT_EQUAL( DefenderError, ret );
+
+    ret = Defender_MetricSegmentAttach( NULL, sizeof( testMemory ), &( segment ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_MetricSegmentAttach( &( pMemory[ 4 ] ), sizeof( testMemory ) - 4U, &( segment ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_MetricSegmentAttach( pMemory, sizeof( testMemory ), NULL );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_MetricSegmentInit( pMemory, sizeof( testMemory ) - 1U, TEST_RECORD_COUNT, TEST_VALUE_LENGTH, &( segment ) );
+    TEST_ASSERT_EQUAL( DefenderBufferTooSmall, ret );
+
+    ret = Defender_MetricSegmentInit( &( pMemory[ 4 ] ), sizeof( testMemory ) - 4U, 1U, 8U, &( segment ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_MetricSegmentInit( NULL, sizeof( testMemory ), 1U, 8U, &( segment ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_MetricSegmentInit( pMemory, sizeof( testMemory ), 0U, 8U, &( segment ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_MetricSegmentInit( pMemory, sizeof( testMemory ), 1U, 8U, NULL );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test writing the custom metrics object.
+ */
+void test_Defender_MetricSegmentSerialize_Happy( void )
+{
+    static const char expected[] =
+        "{\"cpu\":[{\"number\":26}],"
+        "\"peers\":[{\"ip_list\":[\"10.0.0.1\",\"192.168.1.1\"]}],"
+        "\"temps\":[{\"number_list\":[1,18446744073709551615]}],"
+        "\"users\":[{\"string_list\":[\"a\\\"b\",\"caf\"]}]}";
+    DefenderStatus_t ret;
+    uint32_t length = 0U;
+
+    /* Records without a value are left out. */
+    ret = Defender_MetricSegmentSerialize( &( testSegment ), testNames, testNameLengths, TEST_RECORD_COUNT - 1U,
+                                           &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( 2U, length );
+    TEST_ASSERT_EQUAL_STRING_LEN( "{}", testBuffer, length );
+
+    writeTestValues();
+
+    ret = Defender_MetricSegmentSerialize( &( testSegment ), testNames, testNameLengths, TEST_RECORD_COUNT - 1U,
+                                           &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( STRING_LITERAL_LENGTH( expected ), length );
+    TEST_ASSERT_EQUAL_STRING_LEN( expected, testBuffer, length );
+
+    /* Values can be replaced, including by empty lists. */
+    ret = Defender_MetricSegmentWrite( &( testSegment ), 2U, DefenderMetricNumberList, NULL, 0U );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+
+    ret = Defender_MetricSegmentSerialize( &( testSegment ), testNames, testNameLengths, 3U,
+                                           &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL_STRING_LEN( "{\"cpu\":[{\"number\":26}],"
+                                  "\"peers\":[{\"ip_list\":[\"10.0.0.1\",\"192.168.1.1\"]}],"
+                                  "\"temps\":[{\"number_list\":[]}]}", testBuffer, length );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test one custom metrics object holding the metrics of a segment and
+ * rates, in either order.
+ */
+void test_Defender_MetricSegmentAppend_WithRates( void )
+{
+    static const char expectedRatesFirst[] =
+        "{\"bytes_in_rate\":[{\"number\":1250}],\"cpu\":[{\"number\":26}]}";
+    static const char expectedRatesLast[] =
+        "{\"cpu\":[{\"number\":26}],\"bytes_in_rate\":[{\"number\":1250}]}";
+    const char * rateName = "bytes_in_rate";
+    uint16_t rateNameLength = 13U;
+    DefenderRate_t rate;
+    uint32_t length = 0U;
+
+    writeTestValues();
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateInit( &( rate ), 64U, 0U ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( rate ), 0U, 0U ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( rate ), 2500U, 2000U ) );
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_SerializeRates( &( rate ), &( rateName ), &( rateNameLength ), 1U,
+                                                                 &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_MetricSegmentAppend( &( testSegment ), testNames, testNameLengths, 1U,
+                                                                      &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) ) );
+    TEST_ASSERT_EQUAL( STRING_LITERAL_LENGTH( expectedRatesFirst ), length );
+    TEST_ASSERT_EQUAL_STRING_LEN( expectedRatesFirst, testBuffer, length );
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_MetricSegmentSerialize( &( testSegment ), testNames, testNameLengths, 1U,
+                                                                         &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_AppendRates( &( rate ), &( rateName ), &( rateNameLength ), 1U,
+                                                              &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) ) );
+    TEST_ASSERT_EQUAL( STRING_LITERAL_LENGTH( expectedRatesLast ), length );
+    TEST_ASSERT_EQUAL_STRING_LEN( expectedRatesLast, testBuffer, length );
+
+    /* Without room, and with a buffer which holds no object, the given
+     * object is kept. */
+    length = 2U;
+    ( void ) memcpy( &( testBuffer[ 0 ] ), "{}", 2U );
+    TEST_ASSERT_EQUAL( DefenderBufferTooSmall, Defender_MetricSegmentAppend( &( testSegment ), testNames, testNameLengths, 1U,
+                                                                             &( testBuffer[ 0 ] ), 10U, &( length ) ) );
+    TEST_ASSERT_EQUAL( 2U, length );
+    TEST_ASSERT_EQUAL_STRING_LEN( "{}", testBuffer, length );
+
+    ( void ) memcpy( &( testBuffer[ 0 ] ), "{{", 2U );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_MetricSegmentAppend( &( testSegment ), testNames, testNameLengths, 1U,
+                                                                           &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) ) );
+    length = TEST_BUFFER_LENGTH + 1U;
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_MetricSegmentAppend( &( testSegment ), testNames, testNameLengths, 1U,
+                                                                           &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_MetricSegmentAppend( &( testSegment ), testNames, testNameLengths, 1U,
+                                                                           &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, NULL ) );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that records being written or holding invalid values are left
+ * out.
+ */
+void test_Defender_MetricSegmentSerialize_SkippedRecords( void )
+{
+    uint8_t * pMemory = ( uint8_t * ) testMemory;
+    DefenderStatus_t ret;
+    uint32_t length = 0U, sequence, type = 7U;
+
+    writeTestValues();
+
+    /* A write to the first record is in progress. */
+    ( void ) memcpy( &( sequence ), &( pMemory[ 64 ] ), sizeof( sequence ) );
+    sequence++;
+    ( void ) memcpy( &( pMemory[ 64 ] ), &( sequence ), sizeof( sequence ) );
+
+    /* The second record has an unknown type. */
+    ( void ) memcpy( &( pMemory[ 128 + 4 ] ), &( type ), sizeof( type ) );
+
+    /* The third record is longer than a record. */
+    ( void ) memcpy( &( pMemory[ 192 + 8 ] ), &( type ), sizeof( type ) );
+    pMemory[ 192 + 8 ] = TEST_VALUE_LENGTH + 8U;
+
+    /* The string of the fourth record is not valid UTF-8. */
+    pMemory[ 256 + 16 + 7 ] = 0xC3U;
+
+    ret = Defender_MetricSegmentSerialize( &( testSegment ), testNames, testNameLengths, TEST_RECORD_COUNT - 1U,
+                                           &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL_STRING_LEN( "{}", testBuffer, length );
+
+    /* Once the write is done, the first record is back. */
+    sequence++;
+    ( void ) memcpy( &( pMemory[ 64 ] ), &( sequence ), sizeof( sequence ) );
+
+    ret = Defender_MetricSegmentSerialize( &( testSegment ), testNames, testNameLengths, TEST_RECORD_COUNT - 1U,
+                                           &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL_STRING_LEN( "{\"cpu\":[{\"number\":26}]}", testBuffer, length );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that values whose elements do not fill their length exactly, as
+ * read while a writer changes them, are left out.
+ */
+void test_Defender_MetricSegmentSerialize_TornValues( void )
+{
+    uint8_t * pMemory = ( uint8_t * ) testMemory;
+    DefenderStatus_t ret;
+    uint32_t length = 0U;
+
+    writeTestValues();
+
+    /* The number is shorter than a number. */
+    pMemory[ 64 + 8 ] = 4U;
+
+    /* The last address of the second record is cut. */
+    pMemory[ 128 + 8 ] = 6U;
+
+    /* The last number of the third record is cut. */
+    pMemory[ 192 + 8 ] = 12U;
+
+    /* The second string of the fourth record runs past the value. */
+    pMemory[ 256 + 16 + 5 ] = 4U;
+
+    ret = Defender_MetricSegmentSerialize( &( testSegment ), testNames, testNameLengths, TEST_RECORD_COUNT - 1U,
+                                           &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL_STRING_LEN( "{}", testBuffer, length );
+
+    /* A length field cut by the end of the value. */
+    pMemory[ 256 + 8 ] = 6U;
+
+    ret = Defender_MetricSegmentSerialize( &( testSegment ), testNames, testNameLengths, TEST_RECORD_COUNT - 1U,
+                                           &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL_STRING_LEN( "{}", testBuffer, length );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test serializing a record while another thread replaces its value.
+ * Every serialization holds one of the two values, or leaves the record out.
+ */
+void test_Defender_MetricSegmentSerialize_ConcurrentWrites( void )
+{
+    static const char expectedEmpty[] =
+        "{\"users\":[{\"string_list\":[\"\",\"\",\"\",\"\",\"\",\"\",\"\",\"\",\"\",\"\","
+        "\"\",\"\",\"\",\"\",\"\",\"\",\"\",\"\",\"\",\"\"]}]}";
+    static const char expectedLong[] =
+        "{\"users\":[{\"string_list\":[\"xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx\"]}]}";
+    DefenderStatus_t ret;
+    TestWriterState_t state = { PTHREAD_MUTEX_INITIALIZER, 0, 0 };
+    pthread_t writer;
+    uint32_t length = 0U, serializations = 0U;
+
+    TEST_ASSERT_EQUAL( 0, pthread_create( &( writer ), NULL, writeAlternateValues, &( state ) ) );
+
+    for( serializations = 0U; serializations < TEST_SERIALIZE_COUNT; serializations++ )
+    {
+        ret = Defender_MetricSegmentSerialize( &( testSegment ), &( testNames[ 3 ] ), &( testNameLengths[ 3 ] ), 1U,
+                                               &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) );
+        TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+
+        if( length == STRING_LITERAL_LENGTH( expectedEmpty ) )
+        {
+            TEST_ASSERT_EQUAL_STRING_LEN( expectedEmpty, testBuffer, length );
+        }
+        else if( length == STRING_LITERAL_LENGTH( expectedLong ) )
+        {
+            TEST_ASSERT_EQUAL_STRING_LEN( expectedLong, testBuffer, length );
+        }
+        else
+        {
+            TEST_ASSERT_EQUAL_STRING_LEN( "{}", testBuffer, length );
+        }
+    }
+
+    ( void ) pthread_mutex_lock( &( state.mutex ) );
+    state.stop = 1;
+    ( void ) pthread_mutex_unlock( &( state.mutex ) );
+
+    TEST_ASSERT_EQUAL( 0, pthread_join( writer, NULL ) );
+    TEST_ASSERT_EQUAL( 0, state.failed );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that values are checked against their type and length.
+ */
+void test_Defender_MetricSegmentWrite_Invalid( void )
+{
+    uint8_t value[ TEST_VALUE_LENGTH + 1U ] = { 0 };
+    DefenderStatus_t ret;
+
+    ret = Defender_MetricSegmentWrite( &( testSegment ), 0U, DefenderMetricNumber, value, 4U );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_MetricSegmentWrite( &( testSegment ), 0U, DefenderMetricNumberList, value, 12U );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_MetricSegmentWrite( &( testSegment ), 0U, DefenderMetricIpList, value, 6U );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    /* A string length with fewer bytes after it, and a length cut short. */
+    value[ 0 ] = 5U;
+    ret = Defender_MetricSegmentWrite( &( testSegment ), 0U, DefenderMetricStringList, value, 6U );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    value[ 0 ] = 0U;
+    ret = Defender_MetricSegmentWrite( &( testSegment ), 0U, DefenderMetricStringList, value, 3U );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_MetricSegmentWrite( &( testSegment ), 0U, ( DefenderMetricType_t ) 0, value, 8U );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_MetricSegmentWrite( &( testSegment ), 0U, DefenderMetricNumberList, value, TEST_VALUE_LENGTH + 8U );
+    TEST_ASSERT_EQUAL( DefenderBufferTooSmall, ret );
+
+    ret = Defender_MetricSegmentWrite( &( testSegment ), TEST_RECORD_COUNT, DefenderMetricNumber, value, 8U );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_MetricSegmentWrite( &( testSegment ), 0U, DefenderMetricNumber, NULL, 8U );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_MetricSegmentWrite( NULL, 0U, DefenderMetricNumber, value, 8U );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that the buffer length and the parameters of the serializer
+ * are checked.
+ */
+void test_Defender_MetricSegmentSerialize_Errors( void )
+{
+    const char * badNames[ 1 ] = { "\xC3" };
+    DefenderStatus_t ret;
+    uint32_t length = 0U, expectedLength, bufferLength;
+
+    writeTestValues();
+
+    ret = Defender_MetricSegmentSerialize( &( testSegment ), testNames, testNameLengths, TEST_RECORD_COUNT - 1U,
+                                           &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( expectedLength ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+
+    for( bufferLength = 0U; bufferLength < expectedLength; bufferLength++ )
+    {
+        ret = Defender_MetricSegmentSerialize( &( testSegment ), testNames, testNameLengths, TEST_RECORD_COUNT - 1U,
+                                               &( testBuffer[ 0 ] ), bufferLength, &( length ) );
+        TEST_ASSERT_EQUAL( DefenderBufferTooSmall, ret );
+    }
+
+    ret = Defender_MetricSegmentSerialize( &( testSegment ), badNames, testNameLengths, 1U,
+                                           &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderError, ret );
+
+    ret = Defender_MetricSegmentSerialize( NULL, testNames, testNameLengths, 1U,
+                                           &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_MetricSegmentSerialize( &( testSegment ), NULL, testNameLengths, 1U,
+                                           &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_MetricSegmentSerialize( &( testSegment ), testNames, NULL, 1U,
+                                           &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_MetricSegmentSerialize( &( testSegment ), testNames, testNameLengths, 1U,
+                                           NULL, TEST_BUFFER_LENGTH, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_MetricSegmentSerialize( &( testSegment ), testNames, testNameLengths, 1U,
+                                           &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, NULL );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,390 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_name_dict_utest.c
+ * @brief Unit tests for the name dictionary of the Device Defender library.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Test framework include. */
+#include "unity.h"
+
+/* Name dictionary include. */
+#include "defender_name_dict.h"
+
+/**
+ * @brief Largest number of names of a test.
+ */
+#define TEST_NAME_COUNT      4096U
+
+/**
+ * @brief Length of the data of the test dictionary.
+ */
+#define TEST_DATA_LENGTH     ( 64U * 1024U )
+
+/**
+ * @brief Number of bucket offsets of the test dictionary.
+ */
+#define TEST_BUCKET_COUNT    TEST_NAME_COUNT
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief A name of a test.
+ */
+typedef struct TestName
+{
+    uint16_t length;
+    char name[ DEFENDER_THINGNAME_MAX_LENGTH ];
+} TestName_t;
+
+/**
+ * @brief Memory of the test dictionary.
+ */
+static uint8_t testData[ TEST_DATA_LENGTH ];
+static uint32_t testBucketOffsets[ TEST_BUCKET_COUNT ];
+
+/**
+ * @brief The test dictionary.
+ */
+static DefenderNameDict_t testDict;
+
+/**
+ * @brief The names added to the test dictionary.
+ */
+static TestName_t testNames[ TEST_NAME_COUNT ];
+
+/**
+ * @brief State of the random number generator.
+ */
+static uint32_t randomState;
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Small xorshift random number generator, so that tests repeat.
+ */
+static uint32_t nextRandom( void )
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+
+    return randomState;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Order names as the dictionary does.
+ */
+static int compareTestNames( const void * pFirst,
+                             const void * pSecond )
+{
+    const TestName_t * pA = ( const TestName_t * ) pFirst;
+    const TestName_t * pB = ( const TestName_t * ) pSecond;
+    int result = memcmp( pA->name, pB->name, ( pA->length < pB->length ) ? pA->length : pB->length );
+
+    return ( result != 0 ) ? result : ( ( int ) pA->length - ( int ) pB->length );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Find a name, returning UINT32_MAX if it is not in the dictionary.
+ */
+static uint32_t findName( const char * pName,
+                          uint16_t nameLength )
+{
+    uint32_t index = UINT32_MAX;
+    DefenderStatus_t ret;
+
+    ret = Defender_NameDictFind( &( testDict ), pName, nameLength, &( index ) );
+    TEST_ASSERT_TRUE( ( ret == DefenderSuccess ) || ( ret == DefenderNoMatch ) );
+
+    return ( ret == DefenderSuccess ) ? index : UINT32_MAX;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Fill the test dictionary with the sorted test names, and check that
+ * every name is found at its index and iterated in order.
+ */
+static void checkNames( uint32_t nameCount,
+                        uint32_t bucketSize )
+{
+    DefenderNameDictCursor_t cursor;
+    uint32_t i;
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_NameDictInit( &( testDict ), testData, TEST_DATA_LENGTH,
+                                                               testBucketOffsets, TEST_BUCKET_COUNT, bucketSize ) );
+
+    for( i = 0U; i < nameCount; i++ )
+    {
+        TEST_ASSERT_EQUAL( DefenderSuccess, Defender_NameDictAppend( &( testDict ), testNames[ i ].name,
+                                                                     testNames[ i ].length ) );
+    }
+
+    for( i = 0U; i < nameCount; i++ )
+    {
+        TEST_ASSERT_EQUAL( i, findName( testNames[ i ].name, testNames[ i ].length ) );
+    }
+
+    ( void ) memset( &( cursor ), 0xA5, sizeof( cursor ) );
+    cursor.nextIndex = 0U;
+
+    for( i = 0U; i < nameCount; i++ )
+    {
+        TEST_ASSERT_EQUAL( DefenderSuccess, Defender_NameDictNext( &( testDict ), &( cursor ) ) );
+        TEST_ASSERT_EQUAL( testNames[ i ].length, cursor.nameLength );
+        TEST_ASSERT_EQUAL_MEMORY( testNames[ i ].name, cursor.name, cursor.nameLength );
+    }
+
+    TEST_ASSERT_EQUAL( DefenderNoMatch, Defender_NameDictNext( &( testDict ), &( cursor ) ) );
+}
+/*-----------------------------------------------------------*/
+
+/* ============================   UNITY FIXTURES ============================ */
+
+/* Called before each test method. */
+void setUp()
+{
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_NameDictInit( &( testDict ), testData, TEST_DATA_LENGTH,
+                                                               testBucketOffsets, TEST_BUCKET_COUNT, 4U ) );
+    randomState = 2463534242U;
+}
+
+/* Called after each test method. */
+void tearDown()
+{
+}
+
+/* Called at the beginning of the whole suite. */
+void suiteSetUp()
+{
+}
+
+/* Called at the end of the whole suite. */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test invalid parameters.
+ */
+void test_NameDict_BadParameters( void )
+{
+    DefenderNameDict_t dict;
+    DefenderNameDictCursor_t cursor;
+    char longName[ DEFENDER_THINGNAME_MAX_LENGTH + 1U ];
+    uint32_t index = 0U;
+
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameDictInit( NULL, testData, 16U, testBucketOffsets, 1U, 4U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameDictInit( &( dict ), NULL, 16U, testBucketOffsets, 1U, 4U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameDictInit( &( dict ), testData, 16U, NULL, 1U, 4U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameDictInit( &( dict ), testData, 16U, testBucketOffsets, 0U, 4U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameDictInit( &( dict ), testData, 16U, testBucketOffsets, 1U, 0U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameDictInit( &( dict ), testData, 16U, testBucketOffsets, 1U,
+                                                                    DEFENDER_NAME_DICT_MAX_BUCKET_SIZE + 1U ) );
+
+    ( void ) memset( &( dict ), 0, sizeof( dict ) );
+    ( void ) memset( longName, 'a', sizeof( longName ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameDictAppend( NULL, "a", 1U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameDictAppend( &( dict ), "a", 1U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameDictAppend( &( testDict ), NULL, 1U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameDictAppend( &( testDict ), "a", 0U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameDictAppend( &( testDict ), longName, sizeof( longName ) ) );
+
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameDictFind( NULL, "a", 1U, &( index ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameDictFind( &( dict ), "a", 1U, &( index ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameDictFind( &( testDict ), NULL, 1U, &( index ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameDictFind( &( testDict ), "a", 1U, NULL ) );
+
+    cursor.nextIndex = 0U;
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameDictNext( NULL, &( cursor ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameDictNext( &( dict ), &( cursor ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameDictNext( &( testDict ), NULL ) );
+
+    /* An empty dictionary has no name. */
+    TEST_ASSERT_EQUAL( UINT32_MAX, findName( "a", 1U ) );
+    TEST_ASSERT_EQUAL( DefenderNoMatch, Defender_NameDictNext( &( testDict ), &( cursor ) ) );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test the names of a fleet, and names which are not in it.
+ */
+void test_NameDict_Fleet( void )
+{
+    static const char * const missingNames[] =
+    {
+        "a", "sensor-", "sensor-0000000", "sensor-000000000", "sensor-00000001", "sensor-00000002x",
+        "sensor-00004091", "sensor-00004093", "sensor-99999999", "zzz"
+    };
+    uint32_t i, nameLengths = 0U;
+
+    for( i = 0U; i < TEST_NAME_COUNT; i++ )
+    {
+        testNames[ i ].length = ( uint16_t ) snprintf( testNames[ i ].name, DEFENDER_THINGNAME_MAX_LENGTH,
+                                                       "sensor-%08u", ( unsigned int ) ( 2U * i ) );
+        nameLengths += testNames[ i ].length;
+    }
+
+    checkNames( TEST_NAME_COUNT, 16U );
+
+    for( i = 0U; i < ( sizeof( missingNames ) / sizeof( missingNames[ 0 ] ) ); i++ )
+    {
+        TEST_ASSERT_EQUAL( UINT32_MAX, findName( missingNames[ i ], ( uint16_t ) strlen( missingNames[ i ] ) ) );
+    }
+
+    TEST_ASSERT_EQUAL( TEST_NAME_COUNT - 1U, findName( "sensor-00008190", 15U ) );
+
+    /* Names of 15 bytes take less than 5 bytes each. */
+    TEST_ASSERT_LESS_THAN( nameLengths / 3U, testDict.dataLength );
+    TEST_ASSERT_LESS_THAN( 5U * TEST_NAME_COUNT, testDict.dataLength );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test random names of any length, with many shared prefixes, in
+ * buckets of several sizes.
+ */
+void test_NameDict_Random( void )
+{
+    static const uint32_t bucketSizes[] = { 1U, 3U, 16U, DEFENDER_NAME_DICT_MAX_BUCKET_SIZE };
+    TestName_t probe;
+    uint32_t i, j, count = 0U, size;
+    const TestName_t * pFound;
+
+    for( i = 0U; i < 1500U; i++ )
+    {
+        /* Few letters, so that names share prefixes and are prefixes of each
+         * other. */
+        testNames[ count ].length = ( uint16_t ) ( 1U + ( ( nextRandom() % 8U ) == 0U ?
+                                                          ( nextRandom() % DEFENDER_THINGNAME_MAX_LENGTH ) :
+                                                          ( nextRandom() % 6U ) ) );
+
+        for( j = 0U; j < testNames[ count ].length; j++ )
+        {
+            testNames[ count ].name[ j ] = ( char ) ( 'a' + ( nextRandom() % 3U ) );
+        }
+
+        count++;
+    }
+
+    /* Sort the names and drop duplicates. */
+    qsort( testNames, count, sizeof( TestName_t ), compareTestNames );
+
+    for( i = 1U, j = 1U; i < count; i++ )
+    {
+        if( compareTestNames( &( testNames[ i ] ), &( testNames[ j - 1U ] ) ) != 0 )
+        {
+            testNames[ j ] = testNames[ i ];
+            j++;
+        }
+    }
+
+    count = j;
+
+    for( size = 0U; size < ( sizeof( bucketSizes ) / sizeof( bucketSizes[ 0 ] ) ); size++ )
+    {
+        checkNames( count, bucketSizes[ size ] );
+
+        for( i = 0U; i < 2000U; i++ )
+        {
+            probe.length = ( uint16_t ) ( 1U + ( nextRandom() % 7U ) );
+
+            for( j = 0U; j < probe.length; j++ )
+            {
+                probe.name[ j ] = ( char ) ( 'a' + ( nextRandom() % 3U ) );
+            }
+
+            pFound = bsearch( &( probe ), testNames, count, sizeof( TestName_t ), compareTestNames );
+            TEST_ASSERT_EQUAL( ( pFound == NULL ) ? UINT32_MAX : ( uint32_t ) ( pFound - testNames ),
+                               findName( probe.name, probe.length ) );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test names out of order, full dictionaries and cursors.
+ */
+void test_NameDict_AppendErrors( void )
+{
+    DefenderNameDictCursor_t cursor;
+    uint32_t i, dataLength;
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_NameDictAppend( &( testDict ), "thing-b", 7U ) );
+    TEST_ASSERT_EQUAL( DefenderError, Defender_NameDictAppend( &( testDict ), "thing-b", 7U ) );
+    TEST_ASSERT_EQUAL( DefenderError, Defender_NameDictAppend( &( testDict ), "thing-a", 7U ) );
+    TEST_ASSERT_EQUAL( DefenderError, Defender_NameDictAppend( &( testDict ), "thing-", 6U ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_NameDictAppend( &( testDict ), "thing-ba", 8U ) );
+    TEST_ASSERT_EQUAL( 2U, testDict.nameCount );
+
+    /* Full data: "thing-bb" needs 3 bytes after "thing-ba", and "thing-bbb" needs 4. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_NameDictInit( &( testDict ), testData, 9U + 3U,
+                                                               testBucketOffsets, 2U, 2U ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_NameDictAppend( &( testDict ), "thing-ba", 8U ) );
+    TEST_ASSERT_EQUAL( DefenderBufferTooSmall, Defender_NameDictAppend( &( testDict ), "thing-bbb", 9U ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_NameDictAppend( &( testDict ), "thing-bb", 8U ) );
+    TEST_ASSERT_EQUAL( 12U, testDict.dataLength );
+
+    /* Full bucket offsets. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_NameDictInit( &( testDict ), testData, TEST_DATA_LENGTH,
+                                                               testBucketOffsets, 2U, 2U ) );
+
+    for( i = 0U; i < 4U; i++ )
+    {
+        testNames[ i ].length = ( uint16_t ) snprintf( testNames[ i ].name, DEFENDER_THINGNAME_MAX_LENGTH,
+                                                       "thing-%u", ( unsigned int ) i );
+        TEST_ASSERT_EQUAL( DefenderSuccess, Defender_NameDictAppend( &( testDict ), testNames[ i ].name,
+                                                                     testNames[ i ].length ) );
+    }
+
+    dataLength = testDict.dataLength;
+    TEST_ASSERT_EQUAL( DefenderBufferTooSmall, Defender_NameDictAppend( &( testDict ), "thing-4", 7U ) );
+    TEST_ASSERT_EQUAL( dataLength, testDict.dataLength );
+    TEST_ASSERT_EQUAL( 4U, testDict.nameCount );
+    TEST_ASSERT_EQUAL( 3U, findName( "thing-3", 7U ) );
+
+    /* A cursor can start at a bucket, but not at a bad offset. */
+    cursor.nextIndex = 2U;
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_NameDictNext( &( testDict ), &( cursor ) ) );
+    TEST_ASSERT_EQUAL_MEMORY( "thing-2", cursor.name, 7U );
+    cursor.nextOffset = dataLength - 1U;
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameDictNext( &( testDict ), &( cursor ) ) );
+    cursor.nextOffset = dataLength;
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameDictNext( &( testDict ), &( cursor ) ) );
+    cursor.nextOffset = testBucketOffsets[ 1 ] + 8U;
+    cursor.nameLength = 0U;
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameDictNext( &( testDict ), &( cursor ) ) );
+    testData[ testBucketOffsets[ 1 ] + 9U ] = 200U;
+    cursor.nameLength = 7U;
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameDictNext( &( testDict ), &( cursor ) ) );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,245 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_name_filter_utest.c
+ * @brief Unit tests for the name filter of the Device Defender library.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+/* Test framework include. */
+#include "unity.h"
+
+/* Name filter include. */
+#include "defender_name_filter.h"
+
+/**
+ * @brief Number of managed things of the tests.
+ */
+#define TEST_THING_COUNT    10000U
+
+/**
+ * @brief Number of blocks of the test filter.
+ */
+#define TEST_BLOCK_COUNT    ( ( TEST_THING_COUNT / DEFENDER_NAME_FILTER_NAMES_PER_BLOCK ) + 1U )
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Blocks of the test filter.
+ */
+static uint32_t testBlocks[ TEST_BLOCK_COUNT * DEFENDER_NAME_FILTER_BLOCK_WORDS ];
+
+/**
+ * @brief The test filter.
+ */
+static DefenderNameFilter_t testFilter;
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Add the managed things to the test filter.
+ */
+static void addThings( void )
+{
+    char name[ 32 ];
+    uint16_t nameLength;
+    uint32_t i, nameCount = testFilter.nameCount;
+
+    for( i = 0U; i < TEST_THING_COUNT; i++ )
+    {
+        nameLength = ( uint16_t ) snprintf( name, sizeof( name ), "sensor-%08u", ( unsigned int ) i );
+        TEST_ASSERT_EQUAL( DefenderSuccess, Defender_NameFilterAdd( &( testFilter ), name, nameLength ) );
+    }
+
+    TEST_ASSERT_EQUAL( nameCount + TEST_THING_COUNT, testFilter.nameCount );
+}
+/*-----------------------------------------------------------*/
+
+/* ============================   UNITY FIXTURES ============================ */
+
+/* Called before each test method. */
+void setUp()
+{
+    ( void ) memset( testBlocks, 0xFF, sizeof( testBlocks ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_NameFilterInit( &( testFilter ), testBlocks, TEST_BLOCK_COUNT ) );
+}
+
+/* Called after each test method. */
+void tearDown()
+{
+}
+
+/* Called at the beginning of the whole suite. */
+void suiteSetUp()
+{
+}
+
+/* Called at the end of the whole suite. */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test invalid parameters.
+ */
+void test_NameFilter_BadParameters( void )
+{
+    DefenderNameFilter_t filter;
+    DefenderTopic_t api;
+    char longName[ DEFENDER_THINGNAME_MAX_LENGTH + 1U ];
+
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameFilterInit( NULL, testBlocks, 1U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameFilterInit( &( filter ), NULL, 1U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameFilterInit( &( filter ), testBlocks, 0U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameFilterInit( &( filter ), testBlocks, UINT32_MAX ) );
+
+    ( void ) memset( &( filter ), 0, sizeof( filter ) );
+    ( void ) memset( longName, 'a', sizeof( longName ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameFilterAdd( NULL, "a", 1U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameFilterAdd( &( filter ), "a", 1U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameFilterAdd( &( testFilter ), NULL, 1U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameFilterAdd( &( testFilter ), "a", 0U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameFilterAdd( &( testFilter ), longName, sizeof( longName ) ) );
+
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameFilterCheck( NULL, "a", 1U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameFilterCheck( &( filter ), "a", 1U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameFilterCheck( &( testFilter ), NULL, 1U ) );
+
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameFilterMatchTopic( NULL, "a", 1U, &( api ), NULL, NULL ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameFilterMatchTopic( &( filter ), "a", 1U, &( api ), NULL, NULL ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameFilterMatchTopic( &( testFilter ), NULL, 1U, &( api ), NULL, NULL ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_NameFilterMatchTopic( &( testFilter ), "a", 1U, NULL, NULL, NULL ) );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that added names are always found, and other names rarely.
+ */
+void test_NameFilter_FalsePositives( void )
+{
+    char name[ 32 ];
+    uint16_t nameLength;
+    uint32_t i, found = 0U;
+
+    /* The filter starts empty even over memory which was not. */
+    TEST_ASSERT_EQUAL( DefenderNoMatch, Defender_NameFilterCheck( &( testFilter ), "sensor-00000000", 15U ) );
+
+    addThings();
+
+    for( i = 0U; i < TEST_THING_COUNT; i++ )
+    {
+        nameLength = ( uint16_t ) snprintf( name, sizeof( name ), "sensor-%08u", ( unsigned int ) i );
+        TEST_ASSERT_EQUAL( DefenderSuccess, Defender_NameFilterCheck( &( testFilter ), name, nameLength ) );
+    }
+
+    /* Names of other gateways, some of which only differ by a byte. */
+    for( i = 0U; i < ( 10U * TEST_THING_COUNT ); i++ )
+    {
+        nameLength = ( uint16_t ) snprintf( name, sizeof( name ), "sensor-%08u", ( unsigned int ) ( TEST_THING_COUNT + i ) );
+
+        if( Defender_NameFilterCheck( &( testFilter ), name, nameLength ) == DefenderSuccess )
+        {
+            found++;
+        }
+    }
+
+    TEST_ASSERT_LESS_THAN( ( 10U * TEST_THING_COUNT ) / 50U, found );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that names can be added between checks.
+ */
+void test_NameFilter_Incremental( void )
+{
+    TEST_ASSERT_EQUAL( DefenderNoMatch, Defender_NameFilterCheck( &( testFilter ), "gateway-thing", 13U ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_NameFilterAdd( &( testFilter ), "gateway-thing", 13U ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_NameFilterCheck( &( testFilter ), "gateway-thing", 13U ) );
+    TEST_ASSERT_EQUAL( DefenderNoMatch, Defender_NameFilterCheck( &( testFilter ), "gateway-thin", 12U ) );
+    TEST_ASSERT_EQUAL( 1U, testFilter.nameCount );
+
+    addThings();
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_NameFilterCheck( &( testFilter ), "gateway-thing", 13U ) );
+
+    /* A single block holds every name. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_NameFilterInit( &( testFilter ), testBlocks, 1U ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_NameFilterAdd( &( testFilter ), "gateway-thing", 13U ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_NameFilterCheck( &( testFilter ), "gateway-thing", 13U ) );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test matching the topics of managed and other things.
+ */
+void test_NameFilter_MatchTopic( void )
+{
+    char topic[ DEFENDER_API_MAX_LENGTH( DEFENDER_THINGNAME_MAX_LENGTH ) ];
+    uint16_t topicLength, thingNameLength;
+    const char * pThingName;
+    DefenderTopic_t api, matchedApi;
+    uint32_t i, found = 0U;
+
+    addThings();
+
+    for( i = 0U; i < ( uint32_t ) DefenderMaxTopic; i++ )
+    {
+        api = ( DefenderTopic_t ) i;
+        TEST_ASSERT_EQUAL( DefenderSuccess, Defender_GetTopic( topic, sizeof( topic ), "sensor-00000042", 15U, api, &( topicLength ) ) );
+        TEST_ASSERT_EQUAL( DefenderSuccess, Defender_NameFilterMatchTopic( &( testFilter ), topic, topicLength, &( matchedApi ),
+                                                                           &( pThingName ), &( thingNameLength ) ) );
+        TEST_ASSERT_EQUAL( api, matchedApi );
+        TEST_ASSERT_EQUAL( 15U, thingNameLength );
+        TEST_ASSERT_EQUAL_MEMORY( "sensor-00000042", pThingName, 15U );
+        TEST_ASSERT_EQUAL( DefenderSuccess, Defender_NameFilterMatchTopic( &( testFilter ), topic, topicLength, &( matchedApi ),
+                                                                           NULL, NULL ) );
+    }
+
+    /* The topics of other things are dropped. */
+    for( i = 0U; i < TEST_THING_COUNT; i++ )
+    {
+        topicLength = ( uint16_t ) snprintf( topic, sizeof( topic ), "$aws/things/other-%08u/defender/metrics/json/accepted",
+                                             ( unsigned int ) i );
+
+        if( Defender_NameFilterMatchTopic( &( testFilter ), topic, topicLength, &( matchedApi ), NULL, NULL ) == DefenderSuccess )
+        {
+            found++;
+        }
+    }
+
+    TEST_ASSERT_LESS_THAN( TEST_THING_COUNT / 50U, found );
+
+    /* Topics which are not Device Defender topics of a managed thing. */
+    TEST_ASSERT_EQUAL( DefenderNoMatch, Defender_NameFilterMatchTopic( &( testFilter ), "$aws/things/", 12U, &( matchedApi ), NULL, NULL ) );
+    TEST_ASSERT_EQUAL( DefenderNoMatch, Defender_NameFilterMatchTopic( &( testFilter ), "$aws/things/sensor-00000042", 27U,
+                                                                       &( matchedApi ), NULL, NULL ) );
+    TEST_ASSERT_EQUAL( DefenderNoMatch, Defender_NameFilterMatchTopic( &( testFilter ), "$aws/things/sensor-00000042/shadow/get", 38U,
+                                                                       &( matchedApi ), NULL, NULL ) );
+    TEST_ASSERT_EQUAL( DefenderNoMatch, Defender_NameFilterMatchTopic( &( testFilter ), "$aws/thangs/sensor-00000042/defender/metrics/json", 49U,
+                                                                       &( matchedApi ), NULL, NULL ) );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,401 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_netstat_utest.c
+ * @brief Unit tests for the procfs parsers of the Device Defender library.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Test framework include. */
+#include "unity.h"
+
+/* Netstat API include. */
+#include "defender_netstat.h"
+
+/**
+ * @brief Number of entries of the test arrays.
+ */
+#define TEST_CAPACITY         8U
+
+/**
+ * @brief Length of the buffer used in the serializer tests.
+ */
+#define TEST_BUFFER_LENGTH    512U
+
+/**
+ * @brief A /proc/net/tcp file with a listening socket on 127.0.0.1:53, an
+ * established connection from 10.0.0.1:50000 to port 22 and a socket in
+ * TIME_WAIT.
+ */
+#define TEST_TCP                                                                                                  \
+    "  sl  local_address rem_address   st tx_queue rx_queue tr tm->when retrnsmt   uid  timeout inode   \n"       \
+    "   0: 0100007F:0035 00000000:0000 0A 00000000:00000000 00:00000000 00000000   101        0 20281 1 0 \n"     \
+    "   1: 0500000A:0016 0100000A:C350 01 00000000:00000000 02:000A7C9A 00000000     0        0 31337 4 0 \n"     \
+    "   2: 0500000A:0016 0200000A:C351 06 00000000:00000000 03:00001716 00000000     0        0 0 3 0\n"
+
+/**
+ * @brief A /proc/net/tcp6 file with a listening socket on [::]:22, an
+ * established connection from the IPv4-mapped address ::ffff:10.0.0.3 and an
+ * established connection from an IPv6 address.
+ */
+#define TEST_TCP6                                                                                                           \
+    "  sl  local_address                         remote_address                        st tx_queue rx_queue tr\n"           \
+    "   0: 00000000000000000000000000000000:0016 00000000000000000000000000000000:0000 0A 00000000:00000000 00\n"           \
+    "   1: 0000000000000000FFFF00000500000A:0050 0000000000000000FFFF00000300000A:D431 01 00000000:00000000 00\n"           \
+    "   2: 000080FE00000000FF0000000100000A:0050 000080FE00000000FF0000000200000A:D432 01 00000000:00000000 00\n"
+
+/**
+ * @brief A /proc/net/udp file with a bound socket on port 53, a connected
+ * socket, printed in lowercase, and a socket without a port.
+ */
+#define TEST_UDP                                                                                          \
+    "   sl  local_address rem_address   st tx_queue rx_queue tr tm->when retrnsmt   uid  timeout inode\n" \
+    "  100: 3500007F:0035 00000000:0000 07 00000000:00000000 00:00000000 00000000   101        0 20280\n" \
+    "  101: 0500000a:d000 0800000a:0035 01 00000000:00000000 00:00000000 00000000     0        0 20282\n" \
+    "  102: 00000000:0000 00000000:0000 07 00000000:00000000 00:00000000 00000000     0        0 20283\n"
+
+/**
+ * @brief The header lines of /proc/net/dev.
+ */
+#define TEST_DEV_HEADER                                                                                           \
+    "Inter-|   Receive                                                |  Transmit\n"                             \
+    " face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs drop fifo colls carrier compressed\n"
+
+/**
+ * @brief A /proc/net/dev file with a loopback interface and two other
+ * interfaces.
+ */
+#define TEST_DEV                                                                                                    \
+    TEST_DEV_HEADER                                                                                                 \
+    "    lo: 59259063    9890    0    0    0     0          0         0 59259063    9890    0    0    0     0       0          0\n" \
+    "  eth0:      930      13    0    0    0     0          0         0     1030      13    0    0    0     0       0          0\n" \
+    "  eth1:18446744073709551615 1 0 0 0 0 0 0 1 2 0 0 0 0 0 0\n"
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Arrays of the test connection table.
+ */
+static uint32_t testAddresses[ TEST_CAPACITY ];
+static uint16_t testRemotePorts[ TEST_CAPACITY ];
+static uint16_t testLocalPorts[ TEST_CAPACITY ];
+static uint8_t testInterfaceIds[ TEST_CAPACITY ];
+
+/**
+ * @brief The test connection table.
+ */
+static DefenderConnectionTable_t testTable;
+
+/**
+ * @brief Arrays of ports.
+ */
+static uint16_t testTcpPorts[ TEST_CAPACITY ];
+static uint16_t testUdpPorts[ TEST_CAPACITY ];
+
+/**
+ * @brief Buffer used in the serializer tests.
+ */
+static char testBuffer[ TEST_BUFFER_LENGTH ];
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Convert a word printed by procfs to an address, as the parsers do
+ * on the host which prints it.
+ */
+static uint32_t toAddress( uint32_t printedWord )
+{
+    uint8_t bytes[ 4 ];
+
+    ( void ) memcpy( &( bytes[ 0 ] ), &( printedWord ), sizeof( printedWord ) );
+
+    return ( ( uint32_t ) bytes[ 0 ] << 24 ) | ( ( uint32_t ) bytes[ 1 ] << 16 ) |
+           ( ( uint32_t ) bytes[ 2 ] << 8 ) | ( uint32_t ) bytes[ 3 ];
+}
+/*-----------------------------------------------------------*/
+
+/* ============================   UNITY FIXTURES ============================ */
+
+/* Called before each test method. */
+void setUp()
+{
+    TEST_ASSERT_EQUAL( DefenderSuccess,
+                       Defender_ConnectionTableInit( &( testTable ), testAddresses, testRemotePorts,
+                                                     testLocalPorts, testInterfaceIds, TEST_CAPACITY ) );
+    ( void ) memset( &( testBuffer[ 0 ] ), 0, sizeof( testBuffer ) );
+}
+
+/* Called after each test method. */
+void tearDown()
+{
+}
+
+/* Called at the beginning of the whole suite. */
+void suiteSetUp()
+{
+}
+
+/* Called at the end of the whole suite. */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test parsing the TCP sockets of IPv4 and IPv6.
+ */
+void test_Defender_ParseTcpTable_Happy( void )
+{
+    DefenderStatus_t ret;
+    uint32_t portCount = 0U;
+
+    ret = Defender_ParseTcpTable( TEST_TCP, STRING_LITERAL_LENGTH( TEST_TCP ),
+                                  &( testTable ), testTcpPorts, TEST_CAPACITY, &( portCount ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( 1U, portCount );
+    TEST_ASSERT_EQUAL( 53U, testTcpPorts[ 0 ] );
+    TEST_ASSERT_EQUAL( 1U, testTable.count );
+    TEST_ASSERT_EQUAL_HEX32( toAddress( 0x0100000AU ), testAddresses[ 0 ] );
+    TEST_ASSERT_EQUAL( 50000U, testRemotePorts[ 0 ] );
+    TEST_ASSERT_EQUAL( 22U, testLocalPorts[ 0 ] );
+    TEST_ASSERT_EQUAL( 0U, testInterfaceIds[ 0 ] );
+
+    /* The sockets of tcp6 are appended. */
+    ret = Defender_ParseTcpTable( TEST_TCP6, STRING_LITERAL_LENGTH( TEST_TCP6 ),
+                                  &( testTable ), testTcpPorts, TEST_CAPACITY, &( portCount ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( 2U, portCount );
+    TEST_ASSERT_EQUAL( 22U, testTcpPorts[ 1 ] );
+    TEST_ASSERT_EQUAL( 2U, testTable.count );
+    TEST_ASSERT_EQUAL_HEX32( toAddress( 0x0300000AU ), testAddresses[ 1 ] );
+    TEST_ASSERT_EQUAL( 0xD431U, testRemotePorts[ 1 ] );
+    TEST_ASSERT_EQUAL( 80U, testLocalPorts[ 1 ] );
+
+    /* A file with only a header, without a final newline or empty. */
+    ret = Defender_ParseTcpTable( "  sl  local_address", 19U, &( testTable ), testTcpPorts, TEST_CAPACITY, &( portCount ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+
+    ret = Defender_ParseTcpTable( "\n\n   \n", 6U, &( testTable ), NULL, 0U, &( portCount ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( 2U, portCount );
+    TEST_ASSERT_EQUAL( 2U, testTable.count );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test parsing the UDP sockets.
+ */
+void test_Defender_ParseUdpTable_Happy( void )
+{
+    DefenderStatus_t ret;
+    uint32_t portCount = 0U;
+
+    ret = Defender_ParseUdpTable( TEST_UDP, STRING_LITERAL_LENGTH( TEST_UDP ), testUdpPorts, TEST_CAPACITY, &( portCount ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( 1U, portCount );
+    TEST_ASSERT_EQUAL( 53U, testUdpPorts[ 0 ] );
+
+    /* The port array is full. */
+    ret = Defender_ParseUdpTable( TEST_UDP, STRING_LITERAL_LENGTH( TEST_UDP ), testUdpPorts, 1U, &( portCount ) );
+    TEST_ASSERT_EQUAL( DefenderBufferTooSmall, ret );
+    TEST_ASSERT_EQUAL( 1U, portCount );
+
+    ret = Defender_ParseUdpTable( "h\n 0: 00000000:0035 00000000:0000 7\n", 36U, testUdpPorts, TEST_CAPACITY, &( portCount ) );
+    TEST_ASSERT_EQUAL( DefenderError, ret );
+
+    ret = Defender_ParseUdpTable( NULL, 1U, testUdpPorts, TEST_CAPACITY, &( portCount ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_ParseUdpTable( TEST_UDP, 1U, NULL, TEST_CAPACITY, &( portCount ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_ParseUdpTable( TEST_UDP, 1U, testUdpPorts, TEST_CAPACITY, NULL );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that invalid socket lines and full arrays are reported.
+ */
+void test_Defender_ParseTcpTable_Errors( void )
+{
+    static const char * const invalidLines[] =
+    {
+        "h\nx: 0100007F:0035 00000000:0000 0A \n",                 /* Slot is not a number. */
+        "h\n 0 0100007F:0035 00000000:0000 0A \n",                 /* No colon after the slot. */
+        "h\n 0: 0100007:0035 00000000:0000 0A \n",                 /* Short address. */
+        "h\n 0: 0100007G:0035 00000000:0000 0A \n",                /* Not a hex digit. */
+        "h\n 0: 0100007F0100007F:0035 00000000:0000 0A \n",        /* Two words. */
+        "h\n 0: 0100007F-0035 00000000:0000 0A \n",                /* No colon before the port. */
+        "h\n 0: 0100007F:035 00000000:0000 0A \n",                 /* Short port. */
+        "h\n 0: 0100007F:0035\n",                                  /* No remote address. */
+        "h\n 0: 0100007F:0035 00000000:0000 A \n",                 /* Short state. */
+        "h\n 0: 0100007F:0035 00000000:0000 0A",                   /* Truncated line. */
+        "h\n 99999999999999999999: 0100007F:0035 00000000:0000 0A \n" /* Slot out of range. */
+    };
+    DefenderStatus_t ret;
+    uint32_t portCount = 0U, i;
+
+    for( i = 0U; i < ( sizeof( invalidLines ) / sizeof( invalidLines[ 0 ] ) ); i++ )
+    {
+        ret = Defender_ParseTcpTable( invalidLines[ i ], ( uint32_t ) strlen( invalidLines[ i ] ),
+                                      &( testTable ), testTcpPorts, TEST_CAPACITY, &( portCount ) );
+        TEST_ASSERT_EQUAL( DefenderError, ret );
+    }
+
+    TEST_ASSERT_EQUAL( 0U, portCount );
+
+    /* The connection table is full. */
+    testTable.capacity = 0U;
+    ret = Defender_ParseTcpTable( TEST_TCP, STRING_LITERAL_LENGTH( TEST_TCP ),
+                                  &( testTable ), testTcpPorts, TEST_CAPACITY, &( portCount ) );
+    TEST_ASSERT_EQUAL( DefenderBufferTooSmall, ret );
+    TEST_ASSERT_EQUAL( 1U, portCount );
+
+    /* The port array is full. */
+    testTable.capacity = TEST_CAPACITY;
+    portCount = 0U;
+    ret = Defender_ParseTcpTable( TEST_TCP, STRING_LITERAL_LENGTH( TEST_TCP ),
+                                  &( testTable ), testTcpPorts, 0U, &( portCount ) );
+    TEST_ASSERT_EQUAL( DefenderBufferTooSmall, ret );
+    TEST_ASSERT_EQUAL( 0U, testTable.count );
+
+    ret = Defender_ParseTcpTable( NULL, 1U, &( testTable ), testTcpPorts, TEST_CAPACITY, &( portCount ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_ParseTcpTable( TEST_TCP, 1U, NULL, testTcpPorts, TEST_CAPACITY, &( portCount ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_ParseTcpTable( TEST_TCP, 1U, &( testTable ), NULL, TEST_CAPACITY, &( portCount ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_ParseTcpTable( TEST_TCP, 1U, &( testTable ), testTcpPorts, TEST_CAPACITY, NULL );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test parsing the interface statistics.
+ */
+void test_Defender_ParseNetDev_Happy( void )
+{
+    DefenderNetworkStats_t stats;
+    DefenderStatus_t ret;
+
+    ret = Defender_ParseNetDev( TEST_DEV, STRING_LITERAL_LENGTH( TEST_DEV ), &( stats ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+
+    /* The counters wrap like the counters of the kernel. */
+    TEST_ASSERT_TRUE( stats.bytesIn == 929U );
+    TEST_ASSERT_TRUE( stats.packetsIn == 14U );
+    TEST_ASSERT_TRUE( stats.bytesOut == 1031U );
+    TEST_ASSERT_TRUE( stats.packetsOut == 15U );
+
+    ret = Defender_ParseNetDev( TEST_DEV_HEADER, STRING_LITERAL_LENGTH( TEST_DEV_HEADER ), &( stats ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_TRUE( stats.bytesIn == 0U );
+
+    /* Too few counters, and an interface without a colon. */
+    ret = Defender_ParseNetDev( TEST_DEV_HEADER "eth0: 1 2 3\n", STRING_LITERAL_LENGTH( TEST_DEV_HEADER "eth0: 1 2 3\n" ), &( stats ) );
+    TEST_ASSERT_EQUAL( DefenderError, ret );
+
+    ret = Defender_ParseNetDev( TEST_DEV_HEADER "eth0\n", STRING_LITERAL_LENGTH( TEST_DEV_HEADER "eth0\n" ), &( stats ) );
+    TEST_ASSERT_EQUAL( DefenderError, ret );
+
+    ret = Defender_ParseNetDev( NULL, 1U, &( stats ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_ParseNetDev( TEST_DEV, 1U, NULL );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test writing a network report.
+ */
+void test_Defender_SerializeNetworkReport( void )
+{
+    static const char expected[] =
+        "{\"hed\":{\"rid\":42,\"v\":\"1.0\"},"
+        "\"met\":{\"tp\":{\"pts\":[{\"pt\":22},{\"pt\":53}],\"t\":2},"
+        "\"up\":{\"pts\":[],\"t\":0},"
+        "\"ns\":{\"bi\":930,\"bo\":1030,\"pi\":13,\"po\":14},"
+        "\"tc\":{\"ec\":{\"cs\":[{\"lp\":22,\"rad\":\"10.0.0.1:50000\"}],\"t\":1}}}}";
+    DefenderNetworkMetrics_t metrics;
+    DefenderStatus_t ret;
+    uint32_t length = 0U, bufferLength;
+
+    /* Repeated ports are written once. */
+    testTcpPorts[ 0 ] = 22U;
+    testTcpPorts[ 1 ] = 22U;
+    testTcpPorts[ 2 ] = 53U;
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_ConnectionTableAdd( &( testTable ), 0x0A000001U, 50000U, 22U, 0U ) );
+
+    metrics.pConnections = &( testTable );
+    metrics.pTcpPorts = testTcpPorts;
+    metrics.tcpPortCount = 3U;
+    metrics.pUdpPorts = NULL;
+    metrics.udpPortCount = 0U;
+    metrics.stats.bytesIn = 930U;
+    metrics.stats.bytesOut = 1030U;
+    metrics.stats.packetsIn = 13U;
+    metrics.stats.packetsOut = 14U;
+
+    ret = Defender_SerializeNetworkReport( &( metrics ), 42U, &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( STRING_LITERAL_LENGTH( expected ), length );
+    TEST_ASSERT_EQUAL_STRING_LEN( expected, testBuffer, length );
+
+    for( bufferLength = 0U; bufferLength < STRING_LITERAL_LENGTH( expected ); bufferLength++ )
+    {
+        ret = Defender_SerializeNetworkReport( &( metrics ), 42U, &( testBuffer[ 0 ] ), bufferLength, &( length ) );
+        TEST_ASSERT_EQUAL( DefenderBufferTooSmall, ret );
+    }
+
+    ret = Defender_SerializeNetworkReport( NULL, 42U, &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_SerializeNetworkReport( &( metrics ), 42U, NULL, TEST_BUFFER_LENGTH, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_SerializeNetworkReport( &( metrics ), 42U, &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, NULL );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    metrics.udpPortCount = 1U;
+    ret = Defender_SerializeNetworkReport( &( metrics ), 42U, &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    metrics.udpPortCount = 0U;
+    metrics.pTcpPorts = NULL;
+    ret = Defender_SerializeNetworkReport( &( metrics ), 42U, &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    metrics.pTcpPorts = testTcpPorts;
+    metrics.pConnections = NULL;
+    ret = Defender_SerializeNetworkReport( &( metrics ), 42U, &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+}
+/*-----------------------------------------------------------*/
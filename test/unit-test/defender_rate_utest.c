@@ -0,0 +1,373 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_rate_utest.c
+ * @brief Unit tests for the rates of the Device Defender library.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Test framework include. */
+#include "unity.h"
+
+/* Rate include. */
+#include "defender_rate.h"
+
+/**
+ * @brief Length of the buffer used in the serializer tests.
+ */
+#define TEST_BUFFER_LENGTH    128U
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Buffer used in the serializer tests.
+ */
+static char testBuffer[ TEST_BUFFER_LENGTH ];
+
+/**
+ * @brief The rate used in tests.
+ */
+static DefenderRate_t testRate;
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Get the rate per second, which must be known.
+ */
+static uint64_t getPerSecond( const DefenderRate_t * pRate )
+{
+    uint64_t perSecond = 0U;
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateGet( pRate, &( perSecond ) ) );
+
+    return perSecond;
+}
+/*-----------------------------------------------------------*/
+
+/* ============================   UNITY FIXTURES ============================ */
+
+/* Called before each test method. */
+void setUp()
+{
+    ( void ) memset( &( testBuffer[ 0 ] ), 0, sizeof( testBuffer ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateInit( &( testRate ), 64U, 0U ) );
+}
+
+/* Called after each test method. */
+void tearDown()
+{
+}
+
+/* Called at the beginning of the whole suite. */
+void suiteSetUp()
+{
+}
+
+/* Called at the end of the whole suite. */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test initializing rates.
+ */
+void test_Defender_RateInit( void )
+{
+    uint64_t perSecond = 0U;
+
+    TEST_ASSERT_EQUAL( 64U, testRate.counterBits );
+    TEST_ASSERT_EQUAL( 0U, testRate.sampleCount );
+    TEST_ASSERT_EQUAL( DefenderError, Defender_RateGet( &( testRate ), &( perSecond ) ) );
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateInit( &( testRate ), 8U, DEFENDER_RATE_MAX_SHIFT ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_RateInit( NULL, 32U, 0U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_RateInit( &( testRate ), 7U, 0U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_RateInit( &( testRate ), 65U, 0U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_RateInit( &( testRate ), 32U, DEFENDER_RATE_MAX_SHIFT + 1U ) );
+
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_RateGet( NULL, &( perSecond ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_RateGet( &( testRate ), NULL ) );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test rates of growing counters, with and without smoothing.
+ */
+void test_Defender_RateUpdate_Happy( void )
+{
+    uint64_t perSecond = 0U;
+
+    /* The first sample only sets the base. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( testRate ), 5000U, 10000U ) );
+    TEST_ASSERT_EQUAL( DefenderError, Defender_RateGet( &( testRate ), &( perSecond ) ) );
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( testRate ), 7000U, 12000U ) );
+    TEST_ASSERT_EQUAL( 1000U, getPerSecond( &( testRate ) ) );
+
+    /* Without smoothing, the rate is the rate of the last interval. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( testRate ), 7300U, 12100U ) );
+    TEST_ASSERT_EQUAL( 3000U, getPerSecond( &( testRate ) ) );
+
+    /* Rates below one per second are rounded. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( testRate ), 7301U, 15100U ) );
+    TEST_ASSERT_EQUAL( 0U, getPerSecond( &( testRate ) ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( testRate ), 7303U, 18100U ) );
+    TEST_ASSERT_EQUAL( 1U, getPerSecond( &( testRate ) ) );
+
+    /* With a shift of 2, each sample moves the rate by a quarter. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateInit( &( testRate ), 32U, 2U ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( testRate ), 0U, 0U ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( testRate ), 800U, 1000U ) );
+    TEST_ASSERT_EQUAL( 800U, getPerSecond( &( testRate ) ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( testRate ), 2400U, 2000U ) );
+    TEST_ASSERT_EQUAL( 1000U, getPerSecond( &( testRate ) ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( testRate ), 2400U, 3000U ) );
+    TEST_ASSERT_EQUAL( 750U, getPerSecond( &( testRate ) ) );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that a heavily smoothed rate reaches a slow steady rate.
+ */
+void test_Defender_RateUpdate_SlowRate( void )
+{
+    uint64_t timestampMs = 0U, value = 0U;
+    uint32_t i;
+
+    /* One per second is 256 in fixed point. Shifted by 15, every difference
+     * below 32768 would move the rate by nothing. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateInit( &( testRate ), 64U, DEFENDER_RATE_MAX_SHIFT ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( testRate ), 0U, 0U ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( testRate ), 0U, 1000U ) );
+    TEST_ASSERT_EQUAL( 0U, getPerSecond( &( testRate ) ) );
+
+    for( i = 0U; i < 300U; i++ )
+    {
+        value += 1U;
+        timestampMs += 1000U;
+        TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( testRate ), value, timestampMs + 1000U ) );
+    }
+
+    TEST_ASSERT_TRUE( testRate.rate == ( UINT64_C( 1 ) << DEFENDER_RATE_FRACTION_BITS ) );
+    TEST_ASSERT_EQUAL( 1U, getPerSecond( &( testRate ) ) );
+
+    /* The rate also falls back to 0 once the counter stops. */
+    for( i = 0U; i < 300U; i++ )
+    {
+        timestampMs += 1000U;
+        TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( testRate ), value, timestampMs + 1000U ) );
+    }
+
+    TEST_ASSERT_TRUE( testRate.rate == 0U );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test counters which wrap or are reset, and invalid samples.
+ */
+void test_Defender_RateUpdate_WrapAndReset( void )
+{
+    /* A 32-bit counter wrapping past UINT32_MAX. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateInit( &( testRate ), 32U, 0U ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( testRate ), 0xFFFFFF00U, 1000U ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( testRate ), 0x100U, 2000U ) );
+    TEST_ASSERT_EQUAL( 512U, getPerSecond( &( testRate ) ) );
+
+    /* A reset keeps the rate, and the next sample counts from the reset. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( testRate ), 0x80U, 3000U ) );
+    TEST_ASSERT_EQUAL( 512U, getPerSecond( &( testRate ) ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( testRate ), 0x180U, 4000U ) );
+    TEST_ASSERT_EQUAL( 256U, getPerSecond( &( testRate ) ) );
+
+    /* A drop from the lower half of the range is a reset, not a wrap. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( testRate ), 0x7FFFFFFFU, 5000U ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( testRate ), 0x10U, 6000U ) );
+    TEST_ASSERT_EQUAL( 0x7FFFFE7FU, getPerSecond( &( testRate ) ) );
+
+    /* A reset right after the first sample still leaves the rate unknown. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateInit( &( testRate ), 64U, 0U ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( testRate ), 100U, 1000U ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( testRate ), 10U, 2000U ) );
+    TEST_ASSERT_EQUAL( 1U, testRate.sampleCount );
+
+    /* A 64-bit counter wrapping past UINT64_MAX. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( testRate ), UINT64_MAX - 9U, 3000U ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( testRate ), 10U, 4000U ) );
+    TEST_ASSERT_EQUAL( 20U, getPerSecond( &( testRate ) ) );
+
+    /* Samples which are not later are refused. */
+    TEST_ASSERT_EQUAL( DefenderError, Defender_RateUpdate( &( testRate ), 20U, 4000U ) );
+    TEST_ASSERT_EQUAL( DefenderError, Defender_RateUpdate( &( testRate ), 20U, 3999U ) );
+    TEST_ASSERT_EQUAL( 10U, testRate.lastValue );
+
+    /* Values wider than the counter, and invalid rates. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateInit( &( testRate ), 16U, 0U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_RateUpdate( &( testRate ), 0x10000U, 1000U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_RateUpdate( NULL, 1U, 1000U ) );
+    testRate.counterBits = 0U;
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_RateUpdate( &( testRate ), 1U, 1000U ) );
+    testRate.counterBits = 65U;
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_RateUpdate( &( testRate ), 1U, 1000U ) );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test rates of amounts too large for the fixed point.
+ */
+void test_Defender_RateUpdate_Large( void )
+{
+    /* Large amounts are divided by the time first. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( testRate ), 0U, 1000U ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( testRate ), UINT64_C( 10000000000000000 ), 2000U ) );
+    TEST_ASSERT_EQUAL_UINT64( UINT64_C( 10000000000000000 ), getPerSecond( &( testRate ) ) );
+
+    /* Rates which do not fit saturate, and are still rounded. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( testRate ), UINT64_MAX - 1U, 2001U ) );
+    TEST_ASSERT_EQUAL_UINT64( UINT64_MAX, testRate.rate );
+    TEST_ASSERT_EQUAL_UINT64( ( UINT64_MAX >> DEFENDER_RATE_FRACTION_BITS ) + 1U, getPerSecond( &( testRate ) ) );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test writing rates as custom metrics.
+ */
+void test_Defender_SerializeRates( void )
+{
+    DefenderRate_t rates[ 3 ];
+    const char * names[ 3 ] = { "bytes_in_rate", "unknown", "opens_\"rate\"" };
+    uint16_t nameLengths[ 3 ] = { 13U, 7U, 12U };
+    const char * invalidName = "\xFF";
+    uint16_t invalidNameLength = 1U;
+    uint32_t length = 0U;
+    const char * expected = "{\"bytes_in_rate\":[{\"number\":1250}],\"opens_\\\"rate\\\"\":[{\"number\":3}]}";
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateInit( &( rates[ 0 ] ), 64U, 0U ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateInit( &( rates[ 1 ] ), 64U, 0U ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateInit( &( rates[ 2 ] ), 32U, 1U ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( rates[ 0 ] ), 0U, 0U ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( rates[ 0 ] ), 2500U, 2000U ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( rates[ 1 ] ), 10U, 0U ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( rates[ 2 ] ), 0U, 0U ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( rates[ 2 ] ), 6U, 2000U ) );
+
+    /* The rate without a second sample is left out. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_SerializeRates( rates, names, nameLengths, 3U, testBuffer,
+                                                                 TEST_BUFFER_LENGTH, &( length ) ) );
+    TEST_ASSERT_EQUAL( strlen( expected ), length );
+    TEST_ASSERT_EQUAL_STRING_LEN( expected, testBuffer, length );
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_SerializeRates( NULL, NULL, NULL, 0U, testBuffer,
+                                                                 TEST_BUFFER_LENGTH, &( length ) ) );
+    TEST_ASSERT_EQUAL_STRING_LEN( "{}", testBuffer, length );
+
+    /* Every shorter buffer is too small. */
+    for( length = 0U; length < strlen( expected ); length++ )
+    {
+        uint32_t written = 0U;
+
+        TEST_ASSERT_EQUAL( DefenderBufferTooSmall, Defender_SerializeRates( rates, names, nameLengths, 3U, testBuffer,
+                                                                            length, &( written ) ) );
+    }
+
+    TEST_ASSERT_EQUAL( DefenderError, Defender_SerializeRates( rates, &( invalidName ), &( invalidNameLength ), 1U,
+                                                               testBuffer, TEST_BUFFER_LENGTH, &( length ) ) );
+
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_SerializeRates( NULL, names, nameLengths, 3U, testBuffer,
+                                                                      TEST_BUFFER_LENGTH, &( length ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_SerializeRates( rates, NULL, nameLengths, 3U, testBuffer,
+                                                                      TEST_BUFFER_LENGTH, &( length ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_SerializeRates( rates, names, NULL, 3U, testBuffer,
+                                                                      TEST_BUFFER_LENGTH, &( length ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_SerializeRates( rates, names, nameLengths, 3U, NULL,
+                                                                      TEST_BUFFER_LENGTH, &( length ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_SerializeRates( rates, names, nameLengths, 3U, testBuffer,
+                                                                      TEST_BUFFER_LENGTH, NULL ) );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test adding rates to a custom metrics object.
+ */
+void test_Defender_AppendRates( void )
+{
+    static const char expected[] = "{\"cpu\":[{\"number\":26}],\"bytes_in_rate\":[{\"number\":1250}]}";
+    const char * name = "bytes_in_rate";
+    uint16_t nameLength = 13U;
+    uint32_t length = 0U, shortLength;
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( testRate ), 0U, 0U ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RateUpdate( &( testRate ), 2500U, 2000U ) );
+
+    /* A new object, an empty object, and an object with members. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_AppendRates( &( testRate ), &( name ), &( nameLength ), 1U,
+                                                              testBuffer, TEST_BUFFER_LENGTH, &( length ) ) );
+    TEST_ASSERT_EQUAL_STRING_LEN( "{\"bytes_in_rate\":[{\"number\":1250}]}", testBuffer, length );
+
+    ( void ) memcpy( testBuffer, "{}", 2U );
+    length = 2U;
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_AppendRates( &( testRate ), &( name ), &( nameLength ), 1U,
+                                                              testBuffer, TEST_BUFFER_LENGTH, &( length ) ) );
+    TEST_ASSERT_EQUAL_STRING_LEN( "{\"bytes_in_rate\":[{\"number\":1250}]}", testBuffer, length );
+
+    ( void ) memcpy( testBuffer, "{\"cpu\":[{\"number\":26}]}", 23U );
+    length = 23U;
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_AppendRates( &( testRate ), &( name ), &( nameLength ), 1U,
+                                                              testBuffer, TEST_BUFFER_LENGTH, &( length ) ) );
+    TEST_ASSERT_EQUAL( STRING_LITERAL_LENGTH( expected ), length );
+    TEST_ASSERT_EQUAL_STRING_LEN( expected, testBuffer, length );
+
+    /* Without room for the rates, the given object is kept. */
+    for( shortLength = 23U; shortLength < STRING_LITERAL_LENGTH( expected ); shortLength++ )
+    {
+        ( void ) memcpy( testBuffer, "{\"cpu\":[{\"number\":26}]}", 23U );
+        length = 23U;
+        TEST_ASSERT_EQUAL( DefenderBufferTooSmall, Defender_AppendRates( &( testRate ), &( name ), &( nameLength ), 1U,
+                                                                         testBuffer, shortLength, &( length ) ) );
+        TEST_ASSERT_EQUAL( 23U, length );
+        TEST_ASSERT_EQUAL_STRING_LEN( "{\"cpu\":[{\"number\":26}]}", testBuffer, length );
+    }
+
+    /* The buffer must hold an object no longer than the buffer. */
+    length = 1U;
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_AppendRates( &( testRate ), &( name ), &( nameLength ), 1U,
+                                                                   testBuffer, TEST_BUFFER_LENGTH, &( length ) ) );
+    ( void ) memcpy( testBuffer, "[]", 2U );
+    length = 2U;
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_AppendRates( &( testRate ), &( name ), &( nameLength ), 1U,
+                                                                   testBuffer, TEST_BUFFER_LENGTH, &( length ) ) );
+    ( void ) memcpy( testBuffer, "{]", 2U );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_AppendRates( &( testRate ), &( name ), &( nameLength ), 1U,
+                                                                   testBuffer, TEST_BUFFER_LENGTH, &( length ) ) );
+    TEST_ASSERT_EQUAL( 2U, length );
+    TEST_ASSERT_EQUAL_STRING_LEN( "{]", testBuffer, length );
+    length = TEST_BUFFER_LENGTH + 1U;
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_AppendRates( &( testRate ), &( name ), &( nameLength ), 1U,
+                                                                   testBuffer, TEST_BUFFER_LENGTH, &( length ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_AppendRates( &( testRate ), &( name ), &( nameLength ), 1U,
+                                                                   testBuffer, TEST_BUFFER_LENGTH, NULL ) );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,353 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_response_utest.c
+ * @brief Unit tests for parsing Device Defender responses.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Test framework include. */
+#include "unity.h"
+
+/* Response API include. */
+#include "defender_response.h"
+
+/* Responses used in the tests. */
+#define TEST_ACCEPTED_RESPONSE                                                 \
+    "{\"thingName\":\"TestThing\",\"reportId\":1530304554,"                     \
+    "\"status\":\"ACCEPTED\",\"timestamp\":1530304555000}"
+
+#define TEST_REJECTED_RESPONSE                                                 \
+    " {\n  \"reportId\" : 18446744073709551615,\n  \"thingName\": \"TestThing\",\n" \
+    "  \"status\": \"REJECTED\",\n  \"statusDetails\": {\n"                      \
+    "    \"ErrorCode\": \"InvalidJson\",\n"                                      \
+    "    \"ErrorMessage\": \"Report is \\\"not\\\" valid JSON.\",\n"             \
+    "    \"Extra\": [ 1, { \"a\": \"]}\" } ]\n  },\n  \"timestamp\": 0\n} \r\n"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Parse a string literal.
+ */
+#define PARSE( payload, pResponse ) \
+    Defender_ParseResponse( payload, ( uint32_t ) STRING_LITERAL_LENGTH( payload ), pResponse )
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Payloads which are not valid responses.
+ */
+static const char * const malformedPayloads[] =
+{
+    /* Not objects. */
+    " ",
+    "[]",
+    "\"status\"",
+    /* Missing required keys. */
+    "{}",
+    "{\"status\":\"ACCEPTED\"}",
+    "{\"reportId\":1}",
+    /* Bad status. */
+    "{\"status\":\"PENDING\",\"reportId\":1}",
+    "{\"status\":1,\"reportId\":1}",
+    /* Bad report IDs. */
+    "{\"status\":\"ACCEPTED\",\"reportId\":-1}",
+    "{\"status\":\"ACCEPTED\",\"reportId\":01}",
+    "{\"status\":\"ACCEPTED\",\"reportId\":1.5}",
+    "{\"status\":\"ACCEPTED\",\"reportId\":18446744073709551616}",
+    "{\"status\":\"ACCEPTED\",\"reportId\":\"1\"}",
+    "{\"status\":\"ACCEPTED\",\"reportId\":}",
+    /* Bad thing names. */
+    "{\"status\":\"ACCEPTED\",\"reportId\":1,\"thingName\":\"\"}",
+    "{\"status\":\"ACCEPTED\",\"reportId\":1,\"thingName\":\""
+    "12345678901234567890123456789012345678901234567890123456789012345678901234567890"
+    "123456789012345678901234567890123456789012345678901\"}",
+    /* Bad status details. */
+    "{\"status\":\"REJECTED\",\"reportId\":1,\"statusDetails\":\"x\"}",
+    "{\"status\":\"REJECTED\",\"reportId\":1,\"statusDetails\":{\"ErrorCode\":1}}",
+    "{\"status\":\"REJECTED\",\"reportId\":1,\"statusDetails\":{\"ErrorMessage\":1}}",
+    "{\"status\":\"REJECTED\",\"reportId\":1,\"statusDetails\":{\"ErrorCode\":\"x\"",
+    /* Bad structure. */
+    "{\"status\":\"ACCEPTED\",\"reportId\":1,}",
+    "{\"status\":\"ACCEPTED\" \"reportId\":1}",
+    "{\"status\" \"ACCEPTED\",\"reportId\":1}",
+    "{\"status\":\"ACCEPTED\",\"reportId\":1",
+    "{\"status\":\"ACCEPTED\",\"reportId\":1}x",
+    "{,\"status\":\"ACCEPTED\",\"reportId\":1}",
+    "{status:\"ACCEPTED\",\"reportId\":1}",
+    /* Bad strings. */
+    "{\"status\":\"ACCEPTED\",\"reportId\":1,\"a\":\"\n\"}",
+    "{\"status\":\"ACCEPTED\",\"reportId\":1,\"a\":\"abc",
+    "{\"status\":\"ACCEPTED\",\"reportId\":1,\"a\":\"abc\\",
+    /* Bad skipped values. */
+    "{\"status\":\"ACCEPTED\",\"reportId\":1,\"a\":}",
+    "{\"status\":\"ACCEPTED\",\"reportId\":1,\"a\":",
+    "{\"status\":\"ACCEPTED\",\"reportId\":1,\"a\":[{}",
+    "{\"status\":\"ACCEPTED\",\"reportId\":1,\"a\":[\"]}",
+    "{\"a\":x\"y,\"status\":\"ACCEPTED\",\"reportId\":1}",
+    "{\"a\":[\\\"],\"status\":\"ACCEPTED\",\"reportId\":1}",
+};
+
+/**
+ * @brief Number of malformed payloads.
+ */
+#define TEST_MALFORMED_COUNT    ( sizeof( malformedPayloads ) / sizeof( malformedPayloads[ 0 ] ) )
+/*-----------------------------------------------------------*/
+
+/* ============================   UNITY FIXTURES ============================ */
+
+/* Called before each test method. */
+void setUp()
+{
+}
+
+/* Called after each test method. */
+void tearDown()
+{
+}
+
+/* Called at the beginning of the whole suite. */
+void suiteSetUp()
+{
+}
+
+/* Called at the end of the whole suite. */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test parsing an accepted response.
+ */
+void test_Defender_ParseResponse_Accepted( void )
+{
+    DefenderStatus_t ret;
+    DefenderResponse_t response;
+
+    ret = PARSE( TEST_ACCEPTED_RESPONSE, &( response ) );
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( DefenderReportAccepted, response.status );
+    TEST_ASSERT_TRUE( response.reportId == 1530304554U );
+    TEST_ASSERT_TRUE( response.timestamp == 1530304555000ULL );
+    TEST_ASSERT_EQUAL( 9, response.thingNameLength );
+    TEST_ASSERT_EQUAL_STRING_LEN( "TestThing", response.pThingName, 9 );
+    TEST_ASSERT_NULL( response.pErrorCode );
+    TEST_ASSERT_EQUAL( 0, response.errorCodeLength );
+    TEST_ASSERT_NULL( response.pErrorMessage );
+    TEST_ASSERT_EQUAL( 0, response.errorMessageLength );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test parsing a rejected response with whitespace, escapes and
+ * unknown keys.
+ */
+void test_Defender_ParseResponse_Rejected( void )
+{
+    DefenderStatus_t ret;
+    DefenderResponse_t response;
+
+    ret = PARSE( TEST_REJECTED_RESPONSE, &( response ) );
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( DefenderReportRejected, response.status );
+    TEST_ASSERT_TRUE( response.reportId == UINT64_MAX );
+    TEST_ASSERT_TRUE( response.timestamp == 0U );
+    TEST_ASSERT_EQUAL_STRING_LEN( "TestThing", response.pThingName, response.thingNameLength );
+    TEST_ASSERT_EQUAL( 11, response.errorCodeLength );
+    TEST_ASSERT_EQUAL_STRING_LEN( "InvalidJson", response.pErrorCode, 11 );
+    TEST_ASSERT_EQUAL( strlen( "Report is \\\"not\\\" valid JSON." ), response.errorMessageLength );
+    TEST_ASSERT_EQUAL_STRING_LEN( "Report is \\\"not\\\" valid JSON.",
+                                  response.pErrorMessage,
+                                  response.errorMessageLength );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test parsing responses with only the required keys and with unknown
+ * values of every type.
+ */
+void test_Defender_ParseResponse_UnknownKeys( void )
+{
+    DefenderStatus_t ret;
+    DefenderResponse_t response;
+
+    ret = PARSE( "{\"status\":\"ACCEPTED\",\"reportId\":0}", &( response ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_TRUE( response.reportId == 0U );
+    TEST_ASSERT_NULL( response.pThingName );
+
+    ret = PARSE( "{\"a\":true,\"b\":null,\"c\":-1.5e3,\"d\":\"x\",\"e\":[],\"f\":{},"
+                 "\"status\":\"REJECTED\",\"reportId\":7,\"statusDetails\":{}}", &( response ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( DefenderReportRejected, response.status );
+    TEST_ASSERT_TRUE( response.reportId == 7U );
+    TEST_ASSERT_NULL( response.pErrorCode );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that invalid parameters are rejected.
+ */
+void test_Defender_ParseResponse_BadParams( void )
+{
+    DefenderStatus_t ret;
+    DefenderResponse_t response;
+
+    ret = Defender_ParseResponse( NULL, 10U, &( response ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_ParseResponse( TEST_ACCEPTED_RESPONSE, 0U, &( response ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = PARSE( TEST_ACCEPTED_RESPONSE, NULL );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that malformed payloads are rejected.
+ */
+void test_Defender_ParseResponse_Malformed( void )
+{
+    DefenderResponse_t response;
+    size_t i;
+
+    for( i = 0; i < TEST_MALFORMED_COUNT; i++ )
+    {
+        if( Defender_ParseResponse( malformedPayloads[ i ], ( uint32_t ) strlen( malformedPayloads[ i ] ), &( response ) ) != DefenderError )
+        {
+            TEST_FAIL_MESSAGE( malformedPayloads[ i ] );
+        }
+    }
+
+    /* A NUL does not end a number. */
+    TEST_ASSERT_EQUAL( DefenderError, PARSE( "{\"status\":\"ACCEPTED\",\"reportId\":1\0}", &( response ) ) );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that a batch is parsed the same as single responses, with and
+ * without enough room for the structural index.
+ */
+void test_Defender_ParseResponses_Happy( void )
+{
+    DefenderStatus_t ret;
+    DefenderPayload_t payloads[ 4 ];
+    DefenderResponse_t responses[ 4 ], expected[ 2 ];
+    uint32_t index[ sizeof( TEST_REJECTED_RESPONSE ) ];
+    /* An index of one entry is too small for any response. */
+    const uint32_t indexLengths[ 2 ] = { sizeof( index ) / sizeof( index[ 0 ] ), 1U };
+    uint32_t parsedCount = 0U;
+    size_t i;
+
+    payloads[ 0 ].pPayload = TEST_ACCEPTED_RESPONSE;
+    payloads[ 0 ].payloadLength = STRING_LITERAL_LENGTH( TEST_ACCEPTED_RESPONSE );
+    payloads[ 1 ].pPayload = malformedPayloads[ 0 ];
+    payloads[ 1 ].payloadLength = ( uint32_t ) strlen( malformedPayloads[ 0 ] );
+    payloads[ 2 ].pPayload = NULL;
+    payloads[ 2 ].payloadLength = 0U;
+    payloads[ 3 ].pPayload = TEST_REJECTED_RESPONSE;
+    payloads[ 3 ].payloadLength = STRING_LITERAL_LENGTH( TEST_REJECTED_RESPONSE );
+
+    ( void ) PARSE( TEST_ACCEPTED_RESPONSE, &( expected[ 0 ] ) );
+    ( void ) PARSE( TEST_REJECTED_RESPONSE, &( expected[ 1 ] ) );
+
+    for( i = 0; i < 2U; i++ )
+    {
+        ( void ) memset( &( responses[ 0 ] ), 0xA5, sizeof( responses ) );
+
+        ret = Defender_ParseResponses( payloads, 4U, &( index[ 0 ] ), indexLengths[ i ], &( responses[ 0 ] ), &( parsedCount ) );
+
+        TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+        TEST_ASSERT_EQUAL( 2U, parsedCount );
+        TEST_ASSERT_EQUAL_MEMORY( &( expected[ 0 ] ), &( responses[ 0 ] ), sizeof( DefenderResponse_t ) );
+        TEST_ASSERT_EQUAL( DefenderReportStatusUnknown, responses[ 1 ].status );
+        TEST_ASSERT_EQUAL( DefenderReportStatusUnknown, responses[ 2 ].status );
+        TEST_ASSERT_EQUAL_MEMORY( &( expected[ 1 ] ), &( responses[ 3 ] ), sizeof( DefenderResponse_t ) );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that malformed payloads are not parsed in a batch.
+ */
+void test_Defender_ParseResponses_Malformed( void )
+{
+    DefenderStatus_t ret;
+    DefenderPayload_t payloads[ TEST_MALFORMED_COUNT ];
+    DefenderResponse_t responses[ TEST_MALFORMED_COUNT ];
+    uint32_t index[ 256 ];
+    uint32_t parsedCount = 1U;
+    size_t i;
+
+    for( i = 0; i < TEST_MALFORMED_COUNT; i++ )
+    {
+        payloads[ i ].pPayload = malformedPayloads[ i ];
+        payloads[ i ].payloadLength = ( uint32_t ) strlen( malformedPayloads[ i ] );
+    }
+
+    ret = Defender_ParseResponses( payloads, ( uint32_t ) TEST_MALFORMED_COUNT, &( index[ 0 ] ), 256U,
+                                   &( responses[ 0 ] ), &( parsedCount ) );
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( 0U, parsedCount );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that invalid parameters are rejected by the batch parser.
+ */
+void test_Defender_ParseResponses_BadParams( void )
+{
+    DefenderStatus_t ret;
+    DefenderPayload_t payload = { TEST_ACCEPTED_RESPONSE, STRING_LITERAL_LENGTH( TEST_ACCEPTED_RESPONSE ) };
+    DefenderResponse_t response;
+    uint32_t index[ 4 ];
+    uint32_t parsedCount = 0U;
+
+    ret = Defender_ParseResponses( NULL, 1U, &( index[ 0 ] ), 4U, &( response ), &( parsedCount ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_ParseResponses( &( payload ), 0U, &( index[ 0 ] ), 4U, &( response ), &( parsedCount ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_ParseResponses( &( payload ), 1U, NULL, 4U, &( response ), &( parsedCount ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_ParseResponses( &( payload ), 1U, &( index[ 0 ] ), 0U, &( response ), &( parsedCount ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_ParseResponses( &( payload ), 1U, &( index[ 0 ] ), 4U, NULL, &( parsedCount ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_ParseResponses( &( payload ), 1U, &( index[ 0 ] ), 4U, &( response ), NULL );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,246 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_retry_utest.c
+ * @brief Unit tests for the retry manager of the Device Defender library.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Test framework include. */
+#include "unity.h"
+
+/* Retry manager include. */
+#include "defender_retry.h"
+
+/**
+ * @brief Number of things of the tests.
+ */
+#define TEST_THING_COUNT      1000U
+
+/**
+ * @brief Delays of the test manager, in milliseconds.
+ */
+#define TEST_BASE_DELAY_MS    1000U
+#define TEST_MAX_DELAY_MS     60000U
+
+/**
+ * @brief Time of the tests, and of the next scheduled reports.
+ */
+#define TEST_NOW_MS           UINT64_C( 1700000000000 )
+#define TEST_SCHEDULED_MS     ( TEST_NOW_MS + 3600000U )
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Entries of the test manager.
+ */
+static DefenderRetryEntry_t testEntries[ TEST_THING_COUNT ];
+
+/**
+ * @brief The test manager.
+ */
+static DefenderRetryManager_t testManager;
+/*-----------------------------------------------------------*/
+
+/* ============================   UNITY FIXTURES ============================ */
+
+/* Called before each test method. */
+void setUp()
+{
+    ( void ) memset( testEntries, 0xA5, sizeof( testEntries ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RetryInit( &( testManager ), testEntries, TEST_THING_COUNT,
+                                                            TEST_BASE_DELAY_MS, TEST_MAX_DELAY_MS, TEST_THING_COUNT, 1U ) );
+}
+
+/* Called after each test method. */
+void tearDown()
+{
+}
+
+/* Called at the beginning of the whole suite. */
+void suiteSetUp()
+{
+}
+
+/* Called at the end of the whole suite. */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test invalid parameters.
+ */
+void test_Retry_BadParameters( void )
+{
+    DefenderRetryManager_t manager;
+    uint64_t deadline;
+
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_RetryInit( NULL, testEntries, 1U, 1U, 1U, 1U, 1U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_RetryInit( &( manager ), NULL, 1U, 1U, 1U, 1U, 1U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_RetryInit( &( manager ), testEntries, 0U, 1U, 1U, 1U, 1U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_RetryInit( &( manager ), testEntries, 1U, 0U, 1U, 1U, 1U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_RetryInit( &( manager ), testEntries, 1U, 2U, 1U, 1U, 1U ) );
+
+    ( void ) memset( &( manager ), 0, sizeof( manager ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_RetryOnFailure( NULL, 0U, TEST_NOW_MS, TEST_SCHEDULED_MS, &( deadline ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_RetryOnFailure( &( manager ), 0U, TEST_NOW_MS, TEST_SCHEDULED_MS, &( deadline ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_RetryOnFailure( &( testManager ), TEST_THING_COUNT, TEST_NOW_MS,
+                                                                      TEST_SCHEDULED_MS, &( deadline ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_RetryOnFailure( &( testManager ), 0U, TEST_NOW_MS, TEST_SCHEDULED_MS, NULL ) );
+
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_RetryOnSuccess( NULL, 0U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_RetryOnSuccess( &( manager ), 0U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_RetryOnSuccess( &( testManager ), TEST_THING_COUNT ) );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that the delays of a thing grow with decorrelated jitter up to
+ * the maximum, and start again after a success.
+ */
+void test_Retry_Backoff( void )
+{
+    uint64_t deadline, lastDelay = TEST_BASE_DELAY_MS, delay, upper;
+    uint32_t i, maxCount = 0U;
+
+    for( i = 0U; i < 100U; i++ )
+    {
+        TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RetryOnFailure( &( testManager ), 7U, TEST_NOW_MS,
+                                                                     TEST_SCHEDULED_MS, &( deadline ) ) );
+        delay = deadline - TEST_NOW_MS;
+        upper = ( 3U * lastDelay < TEST_MAX_DELAY_MS ) ? ( 3U * lastDelay ) : TEST_MAX_DELAY_MS;
+
+        TEST_ASSERT_GREATER_OR_EQUAL( TEST_BASE_DELAY_MS, delay );
+        TEST_ASSERT_LESS_OR_EQUAL( upper, delay );
+        maxCount += ( delay > ( TEST_MAX_DELAY_MS / 2U ) ) ? 1U : 0U;
+        lastDelay = delay;
+
+        /* A thing whose retry failed is counted once. */
+        TEST_ASSERT_EQUAL( 1U, testManager.outstanding );
+    }
+
+    /* The delays reach the longer range. */
+    TEST_ASSERT_GREATER_THAN( 10U, maxCount );
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RetryOnSuccess( &( testManager ), 7U ) );
+    TEST_ASSERT_EQUAL( 0U, testManager.outstanding );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RetryOnSuccess( &( testManager ), 7U ) );
+    TEST_ASSERT_EQUAL( 0U, testManager.outstanding );
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RetryOnFailure( &( testManager ), 7U, TEST_NOW_MS,
+                                                                 TEST_SCHEDULED_MS, &( deadline ) ) );
+    TEST_ASSERT_LESS_OR_EQUAL( TEST_NOW_MS + ( 3U * TEST_BASE_DELAY_MS ), deadline );
+
+    /* With equal delays, every retry is after the base delay. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RetryInit( &( testManager ), testEntries, 1U, TEST_BASE_DELAY_MS,
+                                                            TEST_BASE_DELAY_MS, 1U, 0U ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RetryOnFailure( &( testManager ), 0U, TEST_NOW_MS,
+                                                                 TEST_SCHEDULED_MS, &( deadline ) ) );
+    TEST_ASSERT_EQUAL( TEST_NOW_MS + TEST_BASE_DELAY_MS, deadline );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that the retries of things failing together are spread, and
+ * differ between devices.
+ */
+void test_Retry_Spread( void )
+{
+    static uint64_t deadlines[ TEST_THING_COUNT ];
+    uint64_t deadline;
+    uint32_t i, buckets[ 4 ] = { 0U }, same = 0U;
+
+    for( i = 0U; i < TEST_THING_COUNT; i++ )
+    {
+        TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RetryOnFailure( &( testManager ), i, TEST_NOW_MS,
+                                                                     TEST_SCHEDULED_MS, &( deadlines[ i ] ) ) );
+        buckets[ ( ( deadlines[ i ] - TEST_NOW_MS - TEST_BASE_DELAY_MS ) * 4U ) / ( ( 2U * TEST_BASE_DELAY_MS ) + 1U ) ]++;
+    }
+
+    /* The first retries are spread over the base delay to three times it. */
+    for( i = 0U; i < 4U; i++ )
+    {
+        TEST_ASSERT_GREATER_THAN( TEST_THING_COUNT / 8U, buckets[ i ] );
+    }
+
+    /* Another device draws other delays. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RetryInit( &( testManager ), testEntries, TEST_THING_COUNT,
+                                                            TEST_BASE_DELAY_MS, TEST_MAX_DELAY_MS, TEST_THING_COUNT, 2U ) );
+
+    for( i = 0U; i < TEST_THING_COUNT; i++ )
+    {
+        TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RetryOnFailure( &( testManager ), i, TEST_NOW_MS,
+                                                                     TEST_SCHEDULED_MS, &( deadline ) ) );
+        same += ( deadline == deadlines[ i ] ) ? 1U : 0U;
+    }
+
+    TEST_ASSERT_LESS_THAN( TEST_THING_COUNT / 100U, same );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test the cap of outstanding retries and the merging of retries into
+ * the next scheduled report.
+ */
+void test_Retry_CapAndMerge( void )
+{
+    uint64_t deadline;
+    uint32_t i;
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RetryInit( &( testManager ), testEntries, TEST_THING_COUNT,
+                                                            TEST_BASE_DELAY_MS, TEST_MAX_DELAY_MS, 4U, 3U ) );
+
+    for( i = 0U; i < 10U; i++ )
+    {
+        TEST_ASSERT_EQUAL( ( i < 4U ) ? DefenderSuccess : DefenderNoMatch,
+                           Defender_RetryOnFailure( &( testManager ), i, TEST_NOW_MS, TEST_SCHEDULED_MS, &( deadline ) ) );
+        TEST_ASSERT_TRUE( ( i < 4U ) ? ( deadline < TEST_SCHEDULED_MS ) : ( deadline == TEST_SCHEDULED_MS ) );
+    }
+
+    TEST_ASSERT_EQUAL( 4U, testManager.outstanding );
+
+    /* A thing at the cap can still retry again. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RetryOnFailure( &( testManager ), 2U, TEST_NOW_MS, TEST_SCHEDULED_MS, &( deadline ) ) );
+    TEST_ASSERT_EQUAL( 4U, testManager.outstanding );
+
+    /* A success makes room for another thing. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RetryOnSuccess( &( testManager ), 0U ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_RetryOnFailure( &( testManager ), 9U, TEST_NOW_MS, TEST_SCHEDULED_MS, &( deadline ) ) );
+    TEST_ASSERT_EQUAL( 4U, testManager.outstanding );
+
+    /* A retry which would not be before the next scheduled report is merged
+     * into it, and is no longer outstanding. */
+    TEST_ASSERT_EQUAL( DefenderNoMatch, Defender_RetryOnFailure( &( testManager ), 1U, TEST_NOW_MS,
+                                                                 TEST_NOW_MS + TEST_BASE_DELAY_MS, &( deadline ) ) );
+    TEST_ASSERT_EQUAL( TEST_NOW_MS + TEST_BASE_DELAY_MS, deadline );
+    TEST_ASSERT_EQUAL( 3U, testManager.outstanding );
+    TEST_ASSERT_EQUAL( DefenderNoMatch, Defender_RetryOnFailure( &( testManager ), 5U, TEST_NOW_MS,
+                                                                 TEST_NOW_MS, &( deadline ) ) );
+    TEST_ASSERT_EQUAL( 3U, testManager.outstanding );
+}
+/*-----------------------------------------------------------*/
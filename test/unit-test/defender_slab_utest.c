@@ -0,0 +1,270 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_slab_utest.c
+ * @brief Unit tests for the slab of the Device Defender library.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Test framework include. */
+#include "unity.h"
+
+/* Slab include. */
+#include "defender_slab.h"
+
+/**
+ * @brief Length of the objects of the test slab. Rounded up to two cache
+ * lines.
+ */
+#define TEST_OBJECT_LENGTH    100U
+
+/**
+ * @brief Number of objects of the test slab.
+ */
+#define TEST_OBJECT_COUNT     8U
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Memory of the test slab, with room to skip to a cache line.
+ */
+static uint8_t testMemory[ ( TEST_OBJECT_COUNT * 128U ) + 64U ];
+
+/**
+ * @brief The test slab.
+ */
+static DefenderSlab_t testSlab;
+
+/**
+ * @brief State of the random number generator.
+ */
+static uint32_t randomState;
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Small xorshift random number generator, so that tests repeat.
+ */
+static uint32_t nextRandom( void )
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+
+    return randomState;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Allocate an object, which must succeed.
+ */
+static uint8_t * allocObject( void )
+{
+    void * pObject = NULL;
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_SlabAlloc( &( testSlab ), &( pObject ) ) );
+    TEST_ASSERT_EQUAL( 0U, ( uintptr_t ) pObject % DEFENDER_SLAB_ALIGNMENT );
+
+    return ( uint8_t * ) pObject;
+}
+/*-----------------------------------------------------------*/
+
+/* ============================   UNITY FIXTURES ============================ */
+
+/* Called before each test method. */
+void setUp()
+{
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_SlabInit( &( testSlab ), testMemory, sizeof( testMemory ),
+                                                           TEST_OBJECT_LENGTH ) );
+    randomState = 2463534242U;
+}
+
+/* Called after each test method. */
+void tearDown()
+{
+}
+
+/* Called at the beginning of the whole suite. */
+void suiteSetUp()
+{
+}
+
+/* Called at the end of the whole suite. */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test initializing slabs.
+ */
+void test_Defender_SlabInit( void )
+{
+    DefenderSlab_t slab;
+    uint8_t * pAligned = &( testMemory[ ( 64U - ( ( uintptr_t ) testMemory % 64U ) ) % 64U ] );
+
+    TEST_ASSERT_EQUAL_PTR( pAligned, testSlab.pObjects );
+    TEST_ASSERT_EQUAL( 128U, testSlab.objectLength );
+    TEST_ASSERT_EQUAL( TEST_OBJECT_COUNT, testSlab.objectCount );
+
+    /* Memory which is not aligned loses its start. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_SlabInit( &( slab ), &( pAligned[ 1 ] ), 63U + 64U, 64U ) );
+    TEST_ASSERT_EQUAL_PTR( &( pAligned[ 64 ] ), slab.pObjects );
+    TEST_ASSERT_EQUAL( 1U, slab.objectCount );
+    TEST_ASSERT_EQUAL( DefenderBufferTooSmall, Defender_SlabInit( &( slab ), &( pAligned[ 1 ] ), 63U + 63U, 64U ) );
+    TEST_ASSERT_EQUAL( DefenderBufferTooSmall, Defender_SlabInit( &( slab ), &( pAligned[ 1 ] ), 62U, 1U ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_SlabInit( &( slab ), pAligned, 64U, 1U ) );
+    TEST_ASSERT_EQUAL( 64U, slab.objectLength );
+
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_SlabInit( NULL, testMemory, sizeof( testMemory ), 8U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_SlabInit( &( slab ), NULL, sizeof( testMemory ), 8U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_SlabInit( &( slab ), testMemory, sizeof( testMemory ), 0U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_SlabInit( &( slab ), testMemory, sizeof( testMemory ),
+                                                                UINT32_MAX - 63U ) );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test allocating and freeing objects.
+ */
+void test_Defender_SlabAlloc_Happy( void )
+{
+    uint8_t * pObjects[ TEST_OBJECT_COUNT ];
+    void * pObject = NULL;
+    uint32_t i, j;
+
+    for( i = 0U; i < TEST_OBJECT_COUNT; i++ )
+    {
+        pObjects[ i ] = allocObject();
+        ( void ) memset( pObjects[ i ], ( int ) i, TEST_OBJECT_LENGTH );
+    }
+
+    TEST_ASSERT_EQUAL( DefenderBufferTooSmall, Defender_SlabAlloc( &( testSlab ), &( pObject ) ) );
+    TEST_ASSERT_EQUAL( TEST_OBJECT_COUNT, testSlab.usedCount );
+
+    /* Objects do not overlap. */
+    for( i = 0U; i < TEST_OBJECT_COUNT; i++ )
+    {
+        for( j = 0U; j < TEST_OBJECT_LENGTH; j++ )
+        {
+            TEST_ASSERT_EQUAL( i, pObjects[ i ][ j ] );
+        }
+    }
+
+    /* The last object freed is allocated first. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_SlabFree( &( testSlab ), pObjects[ 2 ] ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_SlabFree( &( testSlab ), pObjects[ 5 ] ) );
+    TEST_ASSERT_EQUAL( TEST_OBJECT_COUNT - 2U, testSlab.usedCount );
+    TEST_ASSERT_EQUAL_PTR( pObjects[ 5 ], allocObject() );
+    TEST_ASSERT_EQUAL_PTR( pObjects[ 2 ], allocObject() );
+    TEST_ASSERT_EQUAL( DefenderBufferTooSmall, Defender_SlabAlloc( &( testSlab ), &( pObject ) ) );
+
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_SlabAlloc( NULL, &( pObject ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_SlabAlloc( &( testSlab ), NULL ) );
+    testSlab.pObjects = NULL;
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_SlabAlloc( &( testSlab ), &( pObject ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_SlabFree( &( testSlab ), pObjects[ 0 ] ) );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test freeing pointers which are not allocated objects.
+ */
+void test_Defender_SlabFree_Invalid( void )
+{
+    uint8_t * pFirst;
+    uint8_t other = 0U;
+
+    /* Nothing is allocated yet. */
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_SlabFree( &( testSlab ), testSlab.pObjects ) );
+
+    pFirst = allocObject();
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_SlabFree( &( testSlab ), &( pFirst[ 1 ] ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_SlabFree( &( testSlab ), &( pFirst[ 128 ] ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_SlabFree( &( testSlab ), &( other ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_SlabFree( &( testSlab ), NULL ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_SlabFree( NULL, pFirst ) );
+    TEST_ASSERT_EQUAL( 1U, testSlab.usedCount );
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_SlabFree( &( testSlab ), pFirst ) );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test random allocations and frees against a list of the allocated
+ * objects.
+ */
+void test_Defender_SlabAlloc_Random( void )
+{
+    uint8_t * pAllocated[ TEST_OBJECT_COUNT ];
+    uint32_t allocatedCount = 0U, step, i, j;
+    void * pObject = NULL;
+
+    for( step = 0U; step < 10000U; step++ )
+    {
+        if( ( nextRandom() % 2U ) == 0U )
+        {
+            if( allocatedCount == TEST_OBJECT_COUNT )
+            {
+                TEST_ASSERT_EQUAL( DefenderBufferTooSmall, Defender_SlabAlloc( &( testSlab ), &( pObject ) ) );
+            }
+            else
+            {
+                pAllocated[ allocatedCount ] = allocObject();
+
+                /* An allocated object is never handed out twice. */
+                for( i = 0U; i < allocatedCount; i++ )
+                {
+                    TEST_ASSERT_NOT_EQUAL( pAllocated[ i ], pAllocated[ allocatedCount ] );
+                }
+
+                ( void ) memset( pAllocated[ allocatedCount ], ( int ) step, TEST_OBJECT_LENGTH );
+                allocatedCount++;
+            }
+        }
+        else if( allocatedCount > 0U )
+        {
+            i = nextRandom() % allocatedCount;
+
+            /* Other objects kept their content. */
+            for( j = 1U; j < TEST_OBJECT_LENGTH; j++ )
+            {
+                TEST_ASSERT_EQUAL( pAllocated[ i ][ 0 ], pAllocated[ i ][ j ] );
+            }
+
+            TEST_ASSERT_EQUAL( DefenderSuccess, Defender_SlabFree( &( testSlab ), pAllocated[ i ] ) );
+            allocatedCount--;
+            pAllocated[ i ] = pAllocated[ allocatedCount ];
+        }
+        else
+        {
+            /* Nothing to free. */
+        }
+
+        TEST_ASSERT_EQUAL( allocatedCount, testSlab.usedCount );
+    }
+}
+/*-----------------------------------------------------------*/
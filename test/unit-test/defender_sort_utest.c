@@ -0,0 +1,273 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_sort_utest.c
+ * @brief Unit tests for the radix sorts of the Device Defender library.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Test framework include. */
+#include "unity.h"
+
+/* Sort API include. */
+#include "defender_sort.h"
+
+/**
+ * @brief Number of values sorted by the tests.
+ */
+#define TEST_COUNT    257U
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Lists and scratch arrays used in the tests.
+ */
+static uint16_t testPorts[ TEST_COUNT ];
+static uint16_t scratchPorts[ TEST_COUNT ];
+static uint32_t testAddresses[ TEST_COUNT ];
+static uint32_t scratchAddresses[ TEST_COUNT ];
+static uint64_t testNumbers[ TEST_COUNT ];
+static uint64_t scratchNumbers[ TEST_COUNT ];
+
+/**
+ * @brief State of the pseudo random generator used to fill lists.
+ */
+static uint64_t randomState;
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Get a pseudo random number.
+ */
+static uint64_t nextRandom( void )
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 7;
+    randomState ^= randomState << 17;
+
+    return randomState;
+}
+/*-----------------------------------------------------------*/
+
+/* ============================   UNITY FIXTURES ============================ */
+
+/* Called before each test method. */
+void setUp()
+{
+    uint32_t i;
+
+    randomState = UINT64_C( 0x9E3779B97F4A7C15 );
+
+    for( i = 0U; i < TEST_COUNT; i++ )
+    {
+        testPorts[ i ] = ( uint16_t ) nextRandom();
+        testAddresses[ i ] = ( uint32_t ) nextRandom();
+        testNumbers[ i ] = nextRandom();
+    }
+}
+
+/* Called after each test method. */
+void tearDown()
+{
+}
+
+/* Called at the beginning of the whole suite. */
+void suiteSetUp()
+{
+}
+
+/* Called at the end of the whole suite. */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that ports are sorted, with and without skipped passes.
+ */
+void test_Defender_SortPorts_Happy( void )
+{
+    DefenderStatus_t ret;
+    uint32_t i, sum = 0U;
+
+    for( i = 0U; i < TEST_COUNT; i++ )
+    {
+        sum += testPorts[ i ];
+    }
+
+    ret = Defender_SortPorts( testPorts, scratchPorts, TEST_COUNT );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+
+    for( i = 1U; i < TEST_COUNT; i++ )
+    {
+        TEST_ASSERT_TRUE( testPorts[ i - 1U ] <= testPorts[ i ] );
+        sum -= testPorts[ i ];
+    }
+
+    TEST_ASSERT_EQUAL( testPorts[ 0 ], sum );
+
+    /* Ports below 256 skip the pass over the high byte, so the result is
+     * left in the scratch array and copied back. */
+    for( i = 0U; i < TEST_COUNT; i++ )
+    {
+        testPorts[ i ] = ( uint16_t ) ( ( TEST_COUNT - i ) & 0xFFU );
+    }
+
+    ret = Defender_SortPorts( testPorts, scratchPorts, TEST_COUNT );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( 0U, testPorts[ 0 ] );
+    TEST_ASSERT_EQUAL( 1U, testPorts[ 1 ] );
+    TEST_ASSERT_EQUAL( 1U, testPorts[ 2 ] );
+    TEST_ASSERT_EQUAL( 255U, testPorts[ TEST_COUNT - 1U ] );
+
+    /* Equal ports need no pass at all. */
+    ( void ) memset( testPorts, 0x11, sizeof( testPorts ) );
+    ret = Defender_SortPorts( testPorts, scratchPorts, TEST_COUNT );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( 0x1111U, testPorts[ TEST_COUNT - 1U ] );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that addresses are sorted.
+ */
+void test_Defender_SortAddresses_Happy( void )
+{
+    DefenderStatus_t ret;
+    uint32_t i;
+
+    ret = Defender_SortAddresses( testAddresses, scratchAddresses, TEST_COUNT );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+
+    for( i = 1U; i < TEST_COUNT; i++ )
+    {
+        TEST_ASSERT_TRUE( testAddresses[ i - 1U ] <= testAddresses[ i ] );
+    }
+
+    /* Addresses of one subnet only differ in the low byte. */
+    for( i = 0U; i < TEST_COUNT; i++ )
+    {
+        testAddresses[ i ] = 0xC0A80100U | ( ( i * 37U ) & 0xFFU );
+    }
+
+    ret = Defender_SortAddresses( testAddresses, scratchAddresses, TEST_COUNT );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL_HEX32( 0xC0A80100U, testAddresses[ 0 ] );
+    TEST_ASSERT_EQUAL_HEX32( 0xC0A801FFU, testAddresses[ TEST_COUNT - 1U ] );
+
+    for( i = 1U; i < TEST_COUNT; i++ )
+    {
+        TEST_ASSERT_TRUE( testAddresses[ i - 1U ] <= testAddresses[ i ] );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that numbers are sorted.
+ */
+void test_Defender_SortNumbers_Happy( void )
+{
+    DefenderStatus_t ret;
+    uint32_t i;
+
+    testNumbers[ 7 ] = UINT64_MAX;
+    testNumbers[ 8 ] = 0U;
+
+    ret = Defender_SortNumbers( testNumbers, scratchNumbers, TEST_COUNT );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_TRUE( testNumbers[ 0 ] == 0U );
+    TEST_ASSERT_TRUE( testNumbers[ TEST_COUNT - 1U ] == UINT64_MAX );
+
+    for( i = 1U; i < TEST_COUNT; i++ )
+    {
+        TEST_ASSERT_TRUE( testNumbers[ i - 1U ] <= testNumbers[ i ] );
+    }
+
+    for( i = 0U; i < TEST_COUNT; i++ )
+    {
+        testNumbers[ i ] = ( uint64_t ) ( TEST_COUNT - i );
+    }
+
+    ret = Defender_SortNumbers( testNumbers, scratchNumbers, TEST_COUNT );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+
+    for( i = 0U; i < TEST_COUNT; i++ )
+    {
+        TEST_ASSERT_TRUE( testNumbers[ i ] == ( uint64_t ) ( i + 1U ) );
+    }
+
+    /* Numbers which only differ in the high byte take one pass. */
+    for( i = 0U; i < TEST_COUNT; i++ )
+    {
+        testNumbers[ i ] = ( ( uint64_t ) ( ( i * 37U ) & 0xFFU ) << 56 ) | 0x1234U;
+    }
+
+    ret = Defender_SortNumbers( testNumbers, scratchNumbers, TEST_COUNT );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_TRUE( testNumbers[ 0 ] == 0x1234U );
+
+    for( i = 1U; i < TEST_COUNT; i++ )
+    {
+        TEST_ASSERT_TRUE( testNumbers[ i - 1U ] <= testNumbers[ i ] );
+    }
+
+    /* Empty lists and lists of one value are sorted. */
+    ret = Defender_SortNumbers( testNumbers, scratchNumbers, 0U );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    ret = Defender_SortNumbers( testNumbers, scratchNumbers, 1U );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that invalid parameters are rejected.
+ */
+void test_Defender_Sort_BadParams( void )
+{
+    DefenderStatus_t ret;
+
+    ret = Defender_SortPorts( NULL, scratchPorts, TEST_COUNT );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+    ret = Defender_SortPorts( testPorts, NULL, TEST_COUNT );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+    ret = Defender_SortPorts( testPorts, testPorts, TEST_COUNT );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_SortAddresses( NULL, scratchAddresses, TEST_COUNT );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+    ret = Defender_SortAddresses( testAddresses, NULL, TEST_COUNT );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+    ret = Defender_SortAddresses( testAddresses, testAddresses, TEST_COUNT );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_SortNumbers( NULL, scratchNumbers, TEST_COUNT );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+    ret = Defender_SortNumbers( testNumbers, NULL, TEST_COUNT );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+    ret = Defender_SortNumbers( testNumbers, testNumbers, TEST_COUNT );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,475 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_thing_store_utest.c
+ * @brief Unit tests for the thing store of the Device Defender library.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+/* Test framework include. */
+#include "unity.h"
+
+/* Thing store include. */
+#include "defender_thing_store.h"
+
+/**
+ * @brief Number of things of the test store.
+ */
+#define TEST_CAPACITY       48U
+
+/**
+ * @brief Number of slots of the test store. Few slots for the capacity make
+ * long runs of used slots, which wrap around the end of the slots.
+ */
+#define TEST_SLOT_COUNT     64U
+
+/**
+ * @brief Number of different names used by the random test.
+ */
+#define TEST_NAME_KINDS     96U
+
+/**
+ * @brief Length of the names of the random test.
+ */
+#define TEST_NAME_LENGTH    9U
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Memory of the test store.
+ */
+static DefenderThingHot_t testHot[ TEST_CAPACITY ];
+static DefenderThingCold_t testCold[ TEST_CAPACITY ];
+static uint64_t testSlots[ TEST_SLOT_COUNT ];
+
+/**
+ * @brief The test store.
+ */
+static DefenderThingStore_t testStore;
+
+/**
+ * @brief State of the random number generator.
+ */
+static uint32_t randomState;
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Small xorshift random number generator, so that tests repeat.
+ */
+static uint32_t nextRandom( void )
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+
+    return randomState;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Add a thing, which must succeed, and return its ID.
+ */
+static uint32_t addThing( const char * pThingName )
+{
+    uint32_t thingId = UINT32_MAX;
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_ThingStoreAdd( &( testStore ), pThingName,
+                                                                ( uint16_t ) strlen( pThingName ), &( thingId ) ) );
+
+    return thingId;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Find a thing, returning UINT32_MAX if it is not in the store.
+ */
+static uint32_t findThing( const char * pThingName )
+{
+    uint32_t thingId = UINT32_MAX;
+    DefenderStatus_t ret;
+
+    ret = Defender_ThingStoreFind( &( testStore ), pThingName, ( uint16_t ) strlen( pThingName ), &( thingId ) );
+    TEST_ASSERT_TRUE( ( ret == DefenderSuccess ) || ( ret == DefenderNoMatch ) );
+
+    return ( ret == DefenderSuccess ) ? thingId : UINT32_MAX;
+}
+/*-----------------------------------------------------------*/
+
+/* ============================   UNITY FIXTURES ============================ */
+
+/* Called before each test method. */
+void setUp()
+{
+    ( void ) memset( testHot, 0xA5, sizeof( testHot ) );
+    ( void ) memset( testCold, 0xA5, sizeof( testCold ) );
+    ( void ) memset( testSlots, 0xA5, sizeof( testSlots ) );
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_ThingStoreInit( &( testStore ), testHot, testCold, TEST_CAPACITY,
+                                                                 testSlots, TEST_SLOT_COUNT ) );
+    randomState = 2463534242U;
+}
+
+/* Called after each test method. */
+void tearDown()
+{
+}
+
+/* Called at the beginning of the whole suite. */
+void suiteSetUp()
+{
+}
+
+/* Called at the end of the whole suite. */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test initializing stores with invalid parameters.
+ */
+void test_Defender_ThingStoreInit_Invalid( void )
+{
+    DefenderThingStore_t store;
+
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_ThingStoreInit( NULL, testHot, testCold, 4U, testSlots, 8U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_ThingStoreInit( &( store ), NULL, testCold, 4U, testSlots, 8U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_ThingStoreInit( &( store ), testHot, NULL, 4U, testSlots, 8U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_ThingStoreInit( &( store ), testHot, testCold, 4U, NULL, 8U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_ThingStoreInit( &( store ), testHot, testCold, 8U, testSlots, 8U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_ThingStoreInit( &( store ), testHot, testCold, 4U, testSlots, 12U ) );
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_ThingStoreInit( &( store ), testHot, testCold, 0U, testSlots, 1U ) );
+    TEST_ASSERT_EQUAL( 0U, store.count );
+    TEST_ASSERT_EQUAL( 0U, testSlots[ 0 ] );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test adding and finding things.
+ */
+void test_Defender_ThingStoreAdd_Happy( void )
+{
+    uint32_t thingId = 0U, i;
+    char thingName[ DEFENDER_THINGNAME_MAX_LENGTH + 1U ];
+
+    TEST_ASSERT_EQUAL( 0U, addThing( "sensor-1" ) );
+    TEST_ASSERT_EQUAL( 1U, addThing( "sensor-2" ) );
+    TEST_ASSERT_EQUAL( 2U, addThing( "sensor" ) );
+
+    /* Adding a thing again changes nothing. */
+    testHot[ 1 ].deadline = 500U;
+    TEST_ASSERT_EQUAL( 1U, addThing( "sensor-2" ) );
+    TEST_ASSERT_EQUAL( 3U, testStore.count );
+    TEST_ASSERT_EQUAL_UINT64( 500U, testHot[ 1 ].deadline );
+
+    TEST_ASSERT_EQUAL( 0U, findThing( "sensor-1" ) );
+    TEST_ASSERT_EQUAL( 2U, findThing( "sensor" ) );
+    TEST_ASSERT_EQUAL( UINT32_MAX, findThing( "sensor-3" ) );
+    TEST_ASSERT_EQUAL( UINT32_MAX, findThing( "sensor-" ) );
+
+    /* New things are due at once. */
+    TEST_ASSERT_EQUAL_UINT64( 0U, testHot[ 0 ].deadline );
+    TEST_ASSERT_EQUAL( DEFENDER_THING_FLAG_USED, testHot[ 2 ].flags );
+    TEST_ASSERT_EQUAL( 2U, testHot[ 2 ].thingId );
+    TEST_ASSERT_EQUAL( 6U, testCold[ 2 ].thingNameLength );
+    TEST_ASSERT_EQUAL_STRING_LEN( "sensor", testCold[ 2 ].thingName, 6U );
+
+    /* Names with the same FNV-1a hash are told apart. */
+    TEST_ASSERT_EQUAL( 3U, addThing( "costarring" ) );
+    TEST_ASSERT_EQUAL( 4U, addThing( "liquid" ) );
+    TEST_ASSERT_EQUAL( 3U, findThing( "costarring" ) );
+    TEST_ASSERT_EQUAL( 4U, findThing( "liquid" ) );
+
+    /* The longest thing name. */
+    ( void ) memset( thingName, 'x', DEFENDER_THINGNAME_MAX_LENGTH );
+    thingName[ DEFENDER_THINGNAME_MAX_LENGTH ] = '\0';
+    TEST_ASSERT_EQUAL( 5U, addThing( thingName ) );
+
+    /* Fill the store. */
+    for( i = testStore.count; i < TEST_CAPACITY; i++ )
+    {
+        ( void ) snprintf( thingName, sizeof( thingName ), "thing-%u", ( unsigned int ) i );
+        TEST_ASSERT_EQUAL( i, addThing( thingName ) );
+    }
+
+    TEST_ASSERT_EQUAL( DefenderBufferTooSmall, Defender_ThingStoreAdd( &( testStore ), "full", 4U, &( thingId ) ) );
+    TEST_ASSERT_EQUAL( 1U, addThing( "sensor-2" ) );
+
+    for( i = 6U; i < TEST_CAPACITY; i++ )
+    {
+        ( void ) snprintf( thingName, sizeof( thingName ), "thing-%u", ( unsigned int ) i );
+        TEST_ASSERT_EQUAL( i, findThing( thingName ) );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test the parameters of adding and finding things.
+ */
+void test_Defender_ThingStoreAdd_Invalid( void )
+{
+    uint32_t thingId = 0U;
+    char thingName[ DEFENDER_THINGNAME_MAX_LENGTH + 1U ] = { 0 };
+
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_ThingStoreAdd( NULL, "a", 1U, &( thingId ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_ThingStoreAdd( &( testStore ), NULL, 1U, &( thingId ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_ThingStoreAdd( &( testStore ), "a", 0U, &( thingId ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_ThingStoreAdd( &( testStore ), thingName,
+                                                                     DEFENDER_THINGNAME_MAX_LENGTH + 1U, &( thingId ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_ThingStoreAdd( &( testStore ), "a", 1U, NULL ) );
+
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_ThingStoreFind( NULL, "a", 1U, &( thingId ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_ThingStoreFind( &( testStore ), NULL, 1U, &( thingId ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_ThingStoreFind( &( testStore ), "a", 1U, NULL ) );
+
+    testStore.pHot = NULL;
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_ThingStoreFind( &( testStore ), "a", 1U, &( thingId ) ) );
+    testStore.pHot = testHot;
+    testStore.pCold = NULL;
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_ThingStoreFind( &( testStore ), "a", 1U, &( thingId ) ) );
+    testStore.pCold = testCold;
+    testStore.pSlots = NULL;
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_ThingStoreFind( &( testStore ), "a", 1U, &( thingId ) ) );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test scheduling reports and handling their responses.
+ */
+void test_Defender_ThingStoreNextDue( void )
+{
+    uint32_t thingId = 0U;
+
+    ( void ) addThing( "a" );
+    ( void ) addThing( "b" );
+    ( void ) addThing( "c" );
+    testHot[ 0 ].deadline = 2000U;
+    testHot[ 1 ].deadline = 1000U;
+    testHot[ 2 ].deadline = 1500U;
+
+    TEST_ASSERT_EQUAL( DefenderNoMatch, Defender_ThingStoreNextDue( &( testStore ), 999U, 0U, &( thingId ) ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_ThingStoreNextDue( &( testStore ), 1500U, 0U, &( thingId ) ) );
+    TEST_ASSERT_EQUAL( 1U, thingId );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_ThingStoreNextDue( &( testStore ), 1500U, 2U, &( thingId ) ) );
+    TEST_ASSERT_EQUAL( 2U, thingId );
+    TEST_ASSERT_EQUAL( DefenderNoMatch, Defender_ThingStoreNextDue( &( testStore ), 1500U, 3U, &( thingId ) ) );
+
+    /* A thing with a report in flight is not due. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_ThingStoreBeginReport( &( testStore ), 1U, 77U, 0xABCDU ) );
+    TEST_ASSERT_EQUAL( DEFENDER_THING_FLAG_USED | DEFENDER_THING_FLAG_IN_FLIGHT, testHot[ 1 ].flags );
+    TEST_ASSERT_EQUAL_UINT64( 0xABCDU, testCold[ 1 ].reportHash );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_ThingStoreNextDue( &( testStore ), 1500U, 0U, &( thingId ) ) );
+    TEST_ASSERT_EQUAL( 2U, thingId );
+
+    /* Responses to other reports change nothing. */
+    TEST_ASSERT_EQUAL( DefenderNoMatch, Defender_ThingStoreEndReport( &( testStore ), 1U, 76U, 5000U ) );
+    TEST_ASSERT_EQUAL( DefenderNoMatch, Defender_ThingStoreEndReport( &( testStore ), 2U, 77U, 5000U ) );
+    TEST_ASSERT_EQUAL_UINT64( 1500U, testHot[ 2 ].deadline );
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_ThingStoreEndReport( &( testStore ), 1U, 77U, 5000U ) );
+    TEST_ASSERT_EQUAL( DEFENDER_THING_FLAG_USED, testHot[ 1 ].flags );
+    TEST_ASSERT_EQUAL_UINT64( 5000U, testHot[ 1 ].deadline );
+    TEST_ASSERT_EQUAL( DefenderNoMatch, Defender_ThingStoreEndReport( &( testStore ), 1U, 77U, 6000U ) );
+
+    /* Removed things are never due. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_ThingStoreRemove( &( testStore ), 2U ) );
+    TEST_ASSERT_EQUAL( DefenderNoMatch, Defender_ThingStoreNextDue( &( testStore ), 1999U, 0U, &( thingId ) ) );
+
+    /* Things which are not in the store. */
+    TEST_ASSERT_EQUAL( DefenderError, Defender_ThingStoreBeginReport( &( testStore ), 2U, 1U, 0U ) );
+    TEST_ASSERT_EQUAL( DefenderError, Defender_ThingStoreBeginReport( &( testStore ), 3U, 1U, 0U ) );
+    TEST_ASSERT_EQUAL( DefenderError, Defender_ThingStoreEndReport( &( testStore ), 2U, 1U, 0U ) );
+    TEST_ASSERT_EQUAL( DefenderError, Defender_ThingStoreRemove( &( testStore ), 2U ) );
+    TEST_ASSERT_EQUAL( DefenderError, Defender_ThingStoreRemove( &( testStore ), TEST_CAPACITY ) );
+
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_ThingStoreNextDue( NULL, 0U, 0U, &( thingId ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_ThingStoreNextDue( &( testStore ), 0U, 0U, NULL ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_ThingStoreBeginReport( NULL, 0U, 1U, 0U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_ThingStoreEndReport( NULL, 0U, 1U, 0U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_ThingStoreRemove( NULL, 0U ) );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Add and remove random things, and check the store against a list of
+ * the IDs of all names.
+ */
+static void checkRandomSteps( void )
+{
+    uint32_t modelIds[ TEST_NAME_KINDS ];
+    uint8_t usedIds[ TEST_CAPACITY ] = { 0 };
+    char thingName[ TEST_NAME_LENGTH + 1U ];
+    uint32_t i, step, kind, thingId = 0U, modelCount = 0U;
+    DefenderStatus_t ret;
+
+    for( i = 0U; i < TEST_NAME_KINDS; i++ )
+    {
+        modelIds[ i ] = UINT32_MAX;
+    }
+
+    for( step = 0U; step < 20000U; step++ )
+    {
+        kind = nextRandom() % TEST_NAME_KINDS;
+        ( void ) snprintf( thingName, sizeof( thingName ), "thing-%03u", ( unsigned int ) kind );
+
+        if( ( nextRandom() % 2U ) == 0U )
+        {
+            ret = Defender_ThingStoreAdd( &( testStore ), thingName, TEST_NAME_LENGTH, &( thingId ) );
+
+            if( modelIds[ kind ] != UINT32_MAX )
+            {
+                TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+                TEST_ASSERT_EQUAL( modelIds[ kind ], thingId );
+            }
+            else if( modelCount == TEST_CAPACITY )
+            {
+                TEST_ASSERT_EQUAL( DefenderBufferTooSmall, ret );
+            }
+            else
+            {
+                /* IDs stay below the capacity and are never shared. */
+                TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+                TEST_ASSERT_LESS_THAN( TEST_CAPACITY, thingId );
+                TEST_ASSERT_EQUAL( 0U, usedIds[ thingId ] );
+                usedIds[ thingId ] = 1U;
+                modelIds[ kind ] = thingId;
+                modelCount++;
+            }
+        }
+        else if( modelIds[ kind ] != UINT32_MAX )
+        {
+            TEST_ASSERT_EQUAL( DefenderSuccess, Defender_ThingStoreRemove( &( testStore ), modelIds[ kind ] ) );
+            usedIds[ modelIds[ kind ] ] = 0U;
+            modelIds[ kind ] = UINT32_MAX;
+            modelCount--;
+        }
+        else
+        {
+            TEST_ASSERT_EQUAL( UINT32_MAX, findThing( thingName ) );
+        }
+
+        TEST_ASSERT_EQUAL( modelCount, testStore.count );
+    }
+
+    for( kind = 0U; kind < TEST_NAME_KINDS; kind++ )
+    {
+        ( void ) snprintf( thingName, sizeof( thingName ), "thing-%03u", ( unsigned int ) kind );
+        TEST_ASSERT_EQUAL( modelIds[ kind ], findThing( thingName ) );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test random adds and removes against a list of the IDs of all
+ * names.
+ */
+void test_Defender_ThingStoreRemove_Random( void )
+{
+    checkRandomSteps();
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test random adds and removes with half of the names in a dense
+ * array and half in the hash index.
+ */
+void test_Defender_ThingStoreRemove_RandomDense( void )
+{
+    uint32_t denseIds[ TEST_NAME_KINDS / 2U ];
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_ThingStoreSetDense( &( testStore ), "thing-", 6U, 3U, denseIds,
+                                                                     TEST_NAME_KINDS / 2U ) );
+    checkRandomSteps();
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test which names are found in the dense array.
+ */
+void test_Defender_ThingStoreSetDense( void )
+{
+    static const char * const hashedNames[] =
+    {
+        "sensor-1234", "sensor-123456", "sensor-0100", "sensor-00x1", "sensos-0012", "SENSOR-0012", "sensor0012"
+    };
+    uint32_t denseIds[ 100 ];
+    uint32_t thingId = 0U, i, slotCount;
+
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_ThingStoreSetDense( NULL, "sensor-", 7U, 4U, denseIds, 100U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_ThingStoreSetDense( &( testStore ), NULL, 0U, 4U, denseIds, 100U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_ThingStoreSetDense( &( testStore ), "sensor-", 7U, 0U, denseIds, 100U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_ThingStoreSetDense( &( testStore ), "sensor-", 7U, 10U, denseIds, 100U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_ThingStoreSetDense( &( testStore ), "sensor-",
+                                                                          DEFENDER_THINGNAME_MAX_LENGTH - 3U, 4U, denseIds, 100U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_ThingStoreSetDense( &( testStore ), "sensor-", 7U, 4U, NULL, 100U ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_ThingStoreSetDense( &( testStore ), "sensor-", 7U, 4U, denseIds, 0U ) );
+
+    /* Only an empty store gets a dense array. */
+    thingId = addThing( "sensor-0012" );
+    TEST_ASSERT_EQUAL( DefenderError, Defender_ThingStoreSetDense( &( testStore ), "sensor-", 7U, 4U, denseIds, 100U ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_ThingStoreRemove( &( testStore ), thingId ) );
+
+    ( void ) memset( denseIds, 0xA5, sizeof( denseIds ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_ThingStoreSetDense( &( testStore ), "sensor-", 7U, 4U, denseIds, 100U ) );
+
+    /* Dense names use no slot, and their entry holds the ID plus one. */
+    TEST_ASSERT_EQUAL( UINT32_MAX, findThing( "sensor-0012" ) );
+    thingId = addThing( "sensor-0012" );
+    TEST_ASSERT_EQUAL( thingId + 1U, denseIds[ 12 ] );
+    TEST_ASSERT_EQUAL( thingId, addThing( "sensor-0012" ) );
+    TEST_ASSERT_EQUAL( thingId, findThing( "sensor-0012" ) );
+    TEST_ASSERT_EQUAL( addThing( "sensor-0099" ) + 1U, denseIds[ 99 ] );
+    TEST_ASSERT_EQUAL( addThing( "sensor-0000" ) + 1U, denseIds[ 0 ] );
+
+    for( i = 0U; i < TEST_SLOT_COUNT; i++ )
+    {
+        TEST_ASSERT_EQUAL( 0U, testSlots[ i ] );
+    }
+
+    /* Other names are in the hash index. */
+    for( i = 0U; i < ( sizeof( hashedNames ) / sizeof( hashedNames[ 0 ] ) ); i++ )
+    {
+        thingId = addThing( hashedNames[ i ] );
+        TEST_ASSERT_EQUAL( thingId, findThing( hashedNames[ i ] ) );
+    }
+
+    for( i = 0U, slotCount = 0U; i < TEST_SLOT_COUNT; i++ )
+    {
+        slotCount += ( testSlots[ i ] != 0U ) ? 1U : 0U;
+    }
+
+    TEST_ASSERT_EQUAL( sizeof( hashedNames ) / sizeof( hashedNames[ 0 ] ), slotCount );
+
+    /* Removing a dense thing clears its entry. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_ThingStoreRemove( &( testStore ), findThing( "sensor-0012" ) ) );
+    TEST_ASSERT_EQUAL( 0U, denseIds[ 12 ] );
+    TEST_ASSERT_EQUAL( UINT32_MAX, findThing( "sensor-0012" ) );
+    TEST_ASSERT_EQUAL( 9U, testStore.count );
+}
+/*-----------------------------------------------------------*/
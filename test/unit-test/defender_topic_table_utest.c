@@ -0,0 +1,515 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_topic_table_utest.c
+ * @brief Unit tests for the Device Defender topic table.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Test framework include. */
+#include "unity.h"
+
+/* Topic table include. */
+#include "defender_topic_table.h"
+
+/* Thing names used in the tests, in sorted order. */
+#define TEST_THING_NAME_1           "Sensor"
+#define TEST_THING_NAME_2           "Sensor01"
+#define TEST_THING_NAME_3           "Thermostat"
+#define TEST_THING_COUNT            3U
+
+/* Length of the buffer used to build topic tables in. */
+#define TEST_TABLE_BUFFER_LENGTH    2048U
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Sorted thing names used in the tests.
+ */
+static const char * const testThingNames[ TEST_THING_COUNT ] =
+{
+    TEST_THING_NAME_1,
+    TEST_THING_NAME_2,
+    TEST_THING_NAME_3
+};
+
+/**
+ * @brief Lengths of the above thing names.
+ */
+static const uint16_t testThingNameLengths[ TEST_THING_COUNT ] =
+{
+    STRING_LITERAL_LENGTH( TEST_THING_NAME_1 ),
+    STRING_LITERAL_LENGTH( TEST_THING_NAME_2 ),
+    STRING_LITERAL_LENGTH( TEST_THING_NAME_3 )
+};
+
+/**
+ * @brief Buffer used to build topic tables in.
+ */
+static uint8_t testTableBuffer[ TEST_TABLE_BUFFER_LENGTH ];
+
+/**
+ * @brief Length of the topic table built in setUp.
+ */
+static uint32_t testTableLength;
+/*-----------------------------------------------------------*/
+
+/* ============================   UNITY FIXTURES ============================ */
+
+/* Called before each test method. */
+void setUp()
+{
+    DefenderStatus_t ret;
+
+    memset( &( testTableBuffer[ 0 ] ), 0xA5, TEST_TABLE_BUFFER_LENGTH );
+
+    ret = Defender_TopicTableBuild( &( testTableBuffer[ 0 ] ),
+                                    TEST_TABLE_BUFFER_LENGTH,
+                                    testThingNames,
+                                    testThingNameLengths,
+                                    TEST_THING_COUNT,
+                                    &( testTableLength ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+}
+
+/* Called after each test method. */
+void tearDown()
+{
+}
+
+/* Called at the beginning of the whole suite. */
+void suiteSetUp()
+{
+}
+
+/* Called at the end of the whole suite. */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that the size matches the header, entries and all topic strings.
+ */
+void test_Defender_TopicTableGetSize_Happy( void )
+{
+    DefenderStatus_t ret;
+    uint32_t length = 0U, expectedLength = 0U, i;
+
+    ret = Defender_TopicTableGetSize( testThingNames,
+                                      testThingNameLengths,
+                                      TEST_THING_COUNT,
+                                      &( length ) );
+
+    expectedLength = DEFENDER_TOPIC_TABLE_HEADER_LENGTH +
+                     ( TEST_THING_COUNT * DEFENDER_TOPIC_TABLE_ENTRY_LENGTH );
+
+    for( i = 0U; i < TEST_THING_COUNT; i++ )
+    {
+        expectedLength += DEFENDER_API_LENGTH_JSON_PUBLISH( testThingNameLengths[ i ] ) +
+                          DEFENDER_API_LENGTH_JSON_ACCEPTED( testThingNameLengths[ i ] ) +
+                          DEFENDER_API_LENGTH_JSON_REJECTED( testThingNameLengths[ i ] ) +
+                          DEFENDER_API_LENGTH_CBOR_PUBLISH( testThingNameLengths[ i ] ) +
+                          DEFENDER_API_LENGTH_CBOR_ACCEPTED( testThingNameLengths[ i ] ) +
+                          DEFENDER_API_LENGTH_CBOR_REJECTED( testThingNameLengths[ i ] );
+    }
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( expectedLength, length );
+    TEST_ASSERT_EQUAL( expectedLength, testTableLength );
+
+    /* An empty table is just a header. */
+    ret = Defender_TopicTableGetSize( testThingNames,
+                                      testThingNameLengths,
+                                      0U,
+                                      &( length ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( DEFENDER_TOPIC_TABLE_HEADER_LENGTH, length );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that invalid parameters are rejected when calculating the size.
+ */
+void test_Defender_TopicTableGetSize_BadParams( void )
+{
+    DefenderStatus_t ret;
+    uint32_t length = 0U;
+    const char * const nullNames[ 1 ] = { NULL };
+    const uint16_t badLengths[ 2 ] = { 0U, DEFENDER_THINGNAME_MAX_LENGTH + 1U };
+
+    ret = Defender_TopicTableGetSize( NULL, testThingNameLengths, TEST_THING_COUNT, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_TopicTableGetSize( testThingNames, NULL, TEST_THING_COUNT, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_TopicTableGetSize( testThingNames, testThingNameLengths, TEST_THING_COUNT, NULL );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_TopicTableGetSize( testThingNames, testThingNameLengths, UINT32_MAX, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_TopicTableGetSize( nullNames, testThingNameLengths, 1U, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_TopicTableGetSize( testThingNames, &( badLengths[ 0 ] ), 1U, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_TopicTableGetSize( testThingNames, &( badLengths[ 1 ] ), 1U, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that the size calculation detects 32 bit overflow.
+ */
+void test_Defender_TopicTableGetSize_Overflow( void )
+{
+    DefenderStatus_t ret;
+    uint32_t length = 0U;
+    /* Large enough for the entries to fit in 32 bits but not the topics. */
+    static const char * names[ 4200000 ];
+    static uint16_t lengths[ 4200000 ];
+    uint32_t i;
+
+    for( i = 0U; i < 4200000U; i++ )
+    {
+        names[ i ] = TEST_THING_NAME_3;
+        lengths[ i ] = DEFENDER_THINGNAME_MAX_LENGTH;
+    }
+
+    ret = Defender_TopicTableGetSize( names, lengths, 4200000U, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that building rejects invalid parameters and unsorted names.
+ */
+void test_Defender_TopicTableBuild_BadParams( void )
+{
+    DefenderStatus_t ret;
+    uint32_t length = 0U;
+    const char * const unsortedNames[ 2 ] = { TEST_THING_NAME_2, TEST_THING_NAME_1 };
+    const uint16_t unsortedLengths[ 2 ] =
+    {
+        STRING_LITERAL_LENGTH( TEST_THING_NAME_2 ),
+        STRING_LITERAL_LENGTH( TEST_THING_NAME_1 )
+    };
+    const char * const duplicateNames[ 2 ] = { TEST_THING_NAME_1, TEST_THING_NAME_1 };
+    const uint16_t duplicateLengths[ 2 ] =
+    {
+        STRING_LITERAL_LENGTH( TEST_THING_NAME_1 ),
+        STRING_LITERAL_LENGTH( TEST_THING_NAME_1 )
+    };
+
+    ret = Defender_TopicTableBuild( NULL, TEST_TABLE_BUFFER_LENGTH,
+                                    testThingNames, testThingNameLengths,
+                                    TEST_THING_COUNT, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_TopicTableBuild( &( testTableBuffer[ 0 ] ), TEST_TABLE_BUFFER_LENGTH,
+                                    testThingNames, testThingNameLengths,
+                                    TEST_THING_COUNT, NULL );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_TopicTableBuild( &( testTableBuffer[ 0 ] ), TEST_TABLE_BUFFER_LENGTH,
+                                    NULL, testThingNameLengths,
+                                    TEST_THING_COUNT, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_TopicTableBuild( &( testTableBuffer[ 0 ] ), TEST_TABLE_BUFFER_LENGTH,
+                                    unsortedNames, unsortedLengths,
+                                    2U, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_TopicTableBuild( &( testTableBuffer[ 0 ] ), TEST_TABLE_BUFFER_LENGTH,
+                                    duplicateNames, duplicateLengths,
+                                    2U, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that building fails without writing when the buffer is too small.
+ */
+void test_Defender_TopicTableBuild_BufferTooSmall( void )
+{
+    DefenderStatus_t ret;
+    uint32_t length = 0U;
+
+    memset( &( testTableBuffer[ 0 ] ), 0xA5, TEST_TABLE_BUFFER_LENGTH );
+
+    ret = Defender_TopicTableBuild( &( testTableBuffer[ 0 ] ), testTableLength - 1U,
+                                    testThingNames, testThingNameLengths,
+                                    TEST_THING_COUNT, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBufferTooSmall, ret );
+    TEST_ASSERT_EACH_EQUAL_HEX8( 0xA5, &( testTableBuffer[ 0 ] ), TEST_TABLE_BUFFER_LENGTH );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that every topic in the table matches Defender_GetTopic.
+ */
+void test_Defender_TopicTable_AllTopics( void )
+{
+    DefenderStatus_t ret;
+    DefenderTopicTable_t table;
+    char expectedTopic[ DEFENDER_API_MAX_LENGTH( DEFENDER_THINGNAME_MAX_LENGTH ) ];
+    const char * pTopic = NULL;
+    uint16_t topicLength = 0U, expectedTopicLength = 0U;
+    uint32_t i, j;
+
+    ret = Defender_TopicTableInit( &( table ), &( testTableBuffer[ 0 ] ), testTableLength );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( TEST_THING_COUNT, table.thingCount );
+
+    for( i = 0U; i < TEST_THING_COUNT; i++ )
+    {
+        for( j = 0U; j < ( uint32_t ) DefenderMaxTopic; j++ )
+        {
+            ret = Defender_GetTopic( &( expectedTopic[ 0 ] ),
+                                     sizeof( expectedTopic ),
+                                     testThingNames[ i ],
+                                     testThingNameLengths[ i ],
+                                     ( DefenderTopic_t ) j,
+                                     &( expectedTopicLength ) );
+            TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+
+            ret = Defender_TopicTableGetTopic( &( table ),
+                                               i,
+                                               ( DefenderTopic_t ) j,
+                                               &( pTopic ),
+                                               &( topicLength ) );
+            TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+            TEST_ASSERT_EQUAL( expectedTopicLength, topicLength );
+            TEST_ASSERT_EQUAL_STRING_LEN( &( expectedTopic[ 0 ] ), pTopic, topicLength );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that every thing is found at its sorted index.
+ */
+void test_Defender_TopicTableFind_Happy( void )
+{
+    DefenderStatus_t ret;
+    DefenderTopicTable_t table;
+    uint32_t i, index = 0U;
+
+    ret = Defender_TopicTableInit( &( table ), &( testTableBuffer[ 0 ] ), testTableLength );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+
+    for( i = 0U; i < TEST_THING_COUNT; i++ )
+    {
+        ret = Defender_TopicTableFind( &( table ),
+                                       testThingNames[ i ],
+                                       testThingNameLengths[ i ],
+                                       &( index ) );
+        TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+        TEST_ASSERT_EQUAL( i, index );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that things not in the table are not found.
+ */
+void test_Defender_TopicTableFind_NoMatch( void )
+{
+    DefenderStatus_t ret;
+    DefenderTopicTable_t table;
+    uint32_t index = 0U;
+
+    ret = Defender_TopicTableInit( &( table ), &( testTableBuffer[ 0 ] ), testTableLength );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+
+    /* Before the first name. */
+    ret = Defender_TopicTableFind( &( table ), "A", 1U, &( index ) );
+    TEST_ASSERT_EQUAL( DefenderNoMatch, ret );
+
+    /* Prefix of an existing name. */
+    ret = Defender_TopicTableFind( &( table ), "Sensor0", 7U, &( index ) );
+    TEST_ASSERT_EQUAL( DefenderNoMatch, ret );
+
+    /* After the last name. */
+    ret = Defender_TopicTableFind( &( table ), "Zone", 4U, &( index ) );
+    TEST_ASSERT_EQUAL( DefenderNoMatch, ret );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that lookups validate their parameters.
+ */
+void test_Defender_TopicTable_LookupBadParams( void )
+{
+    DefenderStatus_t ret;
+    DefenderTopicTable_t table;
+    uint32_t index = 0U;
+    const char * pTopic = NULL;
+    uint16_t topicLength = 0U;
+
+    ret = Defender_TopicTableInit( &( table ), &( testTableBuffer[ 0 ] ), testTableLength );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+
+    ret = Defender_TopicTableFind( NULL, TEST_THING_NAME_1, 6U, &( index ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+    ret = Defender_TopicTableFind( &( table ), NULL, 6U, &( index ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+    ret = Defender_TopicTableFind( &( table ), TEST_THING_NAME_1, 0U, &( index ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+    ret = Defender_TopicTableFind( &( table ), TEST_THING_NAME_1, DEFENDER_THINGNAME_MAX_LENGTH + 1U, &( index ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+    ret = Defender_TopicTableFind( &( table ), TEST_THING_NAME_1, 6U, NULL );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_TopicTableGetTopic( NULL, 0U, DefenderJsonReportPublish, &( pTopic ), &( topicLength ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+    ret = Defender_TopicTableGetTopic( &( table ), TEST_THING_COUNT, DefenderJsonReportPublish, &( pTopic ), &( topicLength ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+    ret = Defender_TopicTableGetTopic( &( table ), 0U, DefenderInvalidTopic, &( pTopic ), &( topicLength ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+    ret = Defender_TopicTableGetTopic( &( table ), 0U, DefenderMaxTopic, &( pTopic ), &( topicLength ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+    ret = Defender_TopicTableGetTopic( &( table ), 0U, DefenderJsonReportPublish, NULL, &( topicLength ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+    ret = Defender_TopicTableGetTopic( &( table ), 0U, DefenderJsonReportPublish, &( pTopic ), NULL );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that loading rejects images with an invalid header.
+ */
+void test_Defender_TopicTableInit_BadImage( void )
+{
+    DefenderStatus_t ret;
+    DefenderTopicTable_t table;
+
+    ret = Defender_TopicTableInit( NULL, &( testTableBuffer[ 0 ] ), testTableLength );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_TopicTableInit( &( table ), NULL, testTableLength );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_TopicTableInit( &( table ), &( testTableBuffer[ 0 ] ), DEFENDER_TOPIC_TABLE_HEADER_LENGTH - 1U );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    /* Truncated image. */
+    ret = Defender_TopicTableInit( &( table ), &( testTableBuffer[ 0 ] ), testTableLength - 1U );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    /* Thing count larger than the image. */
+    ret = Defender_TopicTableInit( &( table ), &( testTableBuffer[ 0 ] ), DEFENDER_TOPIC_TABLE_HEADER_LENGTH );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    /* Wrong version. */
+    testTableBuffer[ 4 ] = 2U;
+    ret = Defender_TopicTableInit( &( table ), &( testTableBuffer[ 0 ] ), testTableLength );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    /* Wrong magic. */
+    testTableBuffer[ 4 ] = 1U;
+    testTableBuffer[ 0 ] = ( uint8_t ) 'X';
+    ret = Defender_TopicTableInit( &( table ), &( testTableBuffer[ 0 ] ), testTableLength );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that corrupt entries are detected on access.
+ */
+void test_Defender_TopicTable_CorruptEntry( void )
+{
+    DefenderStatus_t ret;
+    DefenderTopicTable_t table;
+    uint32_t index = 0U;
+    const char * pTopic = NULL;
+    uint16_t topicLength = 0U;
+    uint8_t * pEntry = &( testTableBuffer[ DEFENDER_TOPIC_TABLE_HEADER_LENGTH ] );
+
+    ret = Defender_TopicTableInit( &( table ), &( testTableBuffer[ 0 ] ), testTableLength );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+
+    /* Topic offset of the middle entry points past the end of the pool. */
+    pEntry[ DEFENDER_TOPIC_TABLE_ENTRY_LENGTH + 7U ] = 0xFFU;
+    ret = Defender_TopicTableFind( &( table ), TEST_THING_NAME_1, 6U, &( index ) );
+    TEST_ASSERT_EQUAL( DefenderError, ret );
+
+    /* Zero length thing name. */
+    pEntry[ 0 ] = 0U;
+    ret = Defender_TopicTableGetTopic( &( table ), 0U, DefenderCborReportRejected, &( pTopic ), &( topicLength ) );
+    TEST_ASSERT_EQUAL( DefenderError, ret );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test a table whose string pool is larger than 64 KB.
+ */
+void test_Defender_TopicTable_LargePool( void )
+{
+    DefenderStatus_t ret;
+    DefenderTopicTable_t table;
+    static uint8_t largeBuffer[ 256U * 1024U ];
+    static char names[ 200 ][ DEFENDER_THINGNAME_MAX_LENGTH ];
+    const char * pNames[ 200 ];
+    uint16_t lengths[ 200 ];
+    uint32_t i, length = 0U, index = 0U;
+    const char * pTopic = NULL;
+    uint16_t topicLength = 0U;
+
+    for( i = 0U; i < 200U; i++ )
+    {
+        memset( &( names[ i ][ 0 ] ), 'x', DEFENDER_THINGNAME_MAX_LENGTH );
+        names[ i ][ 0 ] = ( char ) ( '0' + ( i / 100U ) );
+        names[ i ][ 1 ] = ( char ) ( '0' + ( ( i / 10U ) % 10U ) );
+        names[ i ][ 2 ] = ( char ) ( '0' + ( i % 10U ) );
+        pNames[ i ] = &( names[ i ][ 0 ] );
+        lengths[ i ] = DEFENDER_THINGNAME_MAX_LENGTH;
+    }
+
+    ret = Defender_TopicTableBuild( &( largeBuffer[ 0 ] ), sizeof( largeBuffer ),
+                                    pNames, lengths, 200U, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+
+    ret = Defender_TopicTableInit( &( table ), &( largeBuffer[ 0 ] ), length );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_GREATER_THAN( UINT16_MAX, table.poolLength );
+
+    ret = Defender_TopicTableFind( &( table ), pNames[ 199 ], lengths[ 199 ], &( index ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( 199, index );
+
+    ret = Defender_TopicTableGetTopic( &( table ), index, DefenderCborReportRejected,
+                                       &( pTopic ), &( topicLength ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( DEFENDER_API_LENGTH_CBOR_REJECTED( DEFENDER_THINGNAME_MAX_LENGTH ), topicLength );
+    TEST_ASSERT_EQUAL_STRING_LEN( "$aws/things/199", pTopic, 15U );
+}
+/*-----------------------------------------------------------*/
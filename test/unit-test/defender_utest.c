@@ -434,6 +434,65 @@ void test_Defender_GetTopic_CborRejectedHappyPath( void )
 }
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Test that topic lengths match the length macros.
+ */
+void test_Defender_GetTopicLength_Happy( void )
+{
+    DefenderStatus_t ret;
+    uint16_t length = 0U;
+
+    ret = Defender_GetTopicLength( 10U, DefenderJsonReportPublish, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( DEFENDER_API_LENGTH_JSON_PUBLISH( 10U ), length );
+
+    ret = Defender_GetTopicLength( 10U, DefenderJsonReportAccepted, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( DEFENDER_API_LENGTH_JSON_ACCEPTED( 10U ), length );
+
+    ret = Defender_GetTopicLength( 10U, DefenderJsonReportRejected, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( DEFENDER_API_LENGTH_JSON_REJECTED( 10U ), length );
+
+    ret = Defender_GetTopicLength( 10U, DefenderCborReportPublish, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( DEFENDER_API_LENGTH_CBOR_PUBLISH( 10U ), length );
+
+    ret = Defender_GetTopicLength( 10U, DefenderCborReportAccepted, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( DEFENDER_API_LENGTH_CBOR_ACCEPTED( 10U ), length );
+
+    ret = Defender_GetTopicLength( DEFENDER_THINGNAME_MAX_LENGTH, DefenderCborReportRejected, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+    TEST_ASSERT_EQUAL( DEFENDER_API_LENGTH_CBOR_REJECTED( DEFENDER_THINGNAME_MAX_LENGTH ), length );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that topic length rejects invalid parameters.
+ */
+void test_Defender_GetTopicLength_BadParams( void )
+{
+    DefenderStatus_t ret;
+    uint16_t length = 0U;
+
+    ret = Defender_GetTopicLength( 0U, DefenderJsonReportPublish, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_GetTopicLength( DEFENDER_THINGNAME_MAX_LENGTH + 1U, DefenderJsonReportPublish, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_GetTopicLength( 10U, DefenderInvalidTopic, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_GetTopicLength( 10U, DefenderMaxTopic, &( length ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+
+    ret = Defender_GetTopicLength( 10U, DefenderJsonReportPublish, NULL );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, ret );
+}
+/*-----------------------------------------------------------*/
+
 void test_Defender_MatchTopic_BadParams( void )
 {
     DefenderStatus_t ret;
@@ -576,6 +635,44 @@ void test_Defender_MatchTopic_InvalidBridge( void )
 }
 /*-----------------------------------------------------------*/
 
+void test_Defender_MatchTopic_OneByteDifference( void )
+{
+    DefenderStatus_t ret;
+    DefenderTopic_t api;
+    /* One extra byte so that the topic can start at an odd address. */
+    char topic[ TEST_JSON_ACCEPTED_TOPIC_LENGTH + 1U ];
+    uint16_t i, start;
+
+    for( start = 0U; start < 2U; start++ )
+    {
+        ( void ) memcpy( &( topic[ start ] ), TEST_JSON_ACCEPTED_TOPIC, TEST_JSON_ACCEPTED_TOPIC_LENGTH );
+
+        ret = Defender_MatchTopic( &( topic[ start ] ), TEST_JSON_ACCEPTED_TOPIC_LENGTH, &( api ), NULL, NULL );
+        TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+
+        /* Change every byte of the prefix, the thing name and the bridge in
+         * turn. Only changes to the thing name still match. */
+        for( i = 0U; i < ( DEFENDER_API_LENGTH_PREFIX + TEST_THING_NAME_LENGTH + DEFENDER_API_LENGTH_BRIDGE ); i++ )
+        {
+            topic[ start + i ] ^= 0x01;
+
+            ret = Defender_MatchTopic( &( topic[ start ] ), TEST_JSON_ACCEPTED_TOPIC_LENGTH, &( api ), NULL, NULL );
+
+            if( ( i >= DEFENDER_API_LENGTH_PREFIX ) && ( i < ( DEFENDER_API_LENGTH_PREFIX + TEST_THING_NAME_LENGTH ) ) )
+            {
+                TEST_ASSERT_EQUAL( DefenderSuccess, ret );
+            }
+            else
+            {
+                TEST_ASSERT_EQUAL( DefenderNoMatch, ret );
+            }
+
+            topic[ start + i ] ^= 0x01;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
 void test_Defender_MatchTopic_IncompleteFormat( void )
 {
     DefenderStatus_t ret;
@@ -821,3 +918,119 @@ void test_Defender_MatchTopic_MissingOptionalParams( void )
     TEST_ASSERT_EQUAL( DefenderJsonReportPublish, api );
 }
 /*-----------------------------------------------------------*/
+
+/**
+ * @brief Write the variable header and the payload of a PUBLISH packet into
+ * the writable topic buffer.
+ *
+ * @return The length written.
+ */
+static uint32_t writePublish( const char * pTopic,
+                              uint16_t topicLength,
+                              uint8_t qos )
+{
+    uint8_t * pPacket = ( uint8_t * ) &( testTopicBuffer[ TEST_TOPIC_BUFFER_PREFIX_GUARD_LENGTH ] );
+    uint32_t length = 0U;
+
+    pPacket[ length++ ] = ( uint8_t ) ( topicLength >> 8 );
+    pPacket[ length++ ] = ( uint8_t ) topicLength;
+    ( void ) memcpy( &( pPacket[ length ] ), pTopic, topicLength );
+    length += topicLength;
+
+    if( qos > 0U )
+    {
+        pPacket[ length++ ] = 0x12U;
+        pPacket[ length++ ] = 0x34U;
+    }
+
+    ( void ) memcpy( &( pPacket[ length ] ), "{}", 2U );
+
+    return length + 2U;
+}
+/*-----------------------------------------------------------*/
+
+void test_Defender_MatchPublish_BadParams( void )
+{
+    const uint8_t * pPacket = ( const uint8_t * ) &( testTopicBuffer[ TEST_TOPIC_BUFFER_PREFIX_GUARD_LENGTH ] );
+    uint32_t length, payloadOffset;
+    DefenderTopic_t api;
+
+    length = writePublish( TEST_JSON_ACCEPTED_TOPIC, TEST_JSON_ACCEPTED_TOPIC_LENGTH, 0U );
+
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_MatchPublish( 0x30U, NULL, length, &( api ), NULL, NULL, &( payloadOffset ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_MatchPublish( 0x30U, pPacket, length, NULL, NULL, NULL, &( payloadOffset ) ) );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_MatchPublish( 0x30U, pPacket, length, &( api ), NULL, NULL, NULL ) );
+
+    /* A SUBSCRIBE packet. */
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_MatchPublish( 0x82U, pPacket, length, &( api ), NULL, NULL, &( payloadOffset ) ) );
+}
+/*-----------------------------------------------------------*/
+
+void test_Defender_MatchPublish_Malformed( void )
+{
+    const uint8_t * pPacket = ( const uint8_t * ) &( testTopicBuffer[ TEST_TOPIC_BUFFER_PREFIX_GUARD_LENGTH ] );
+    uint32_t length, payloadOffset = 0U;
+    DefenderTopic_t api;
+
+    length = writePublish( TEST_JSON_ACCEPTED_TOPIC, TEST_JSON_ACCEPTED_TOPIC_LENGTH, 1U );
+
+    /* QoS 3 is not valid. */
+    TEST_ASSERT_EQUAL( DefenderError, Defender_MatchPublish( 0x36U, pPacket, length, &( api ), NULL, NULL, &( payloadOffset ) ) );
+
+    /* Too short for the topic length, the topic or the packet identifier. */
+    TEST_ASSERT_EQUAL( DefenderError, Defender_MatchPublish( 0x30U, pPacket, 1U, &( api ), NULL, NULL, &( payloadOffset ) ) );
+    TEST_ASSERT_EQUAL( DefenderError, Defender_MatchPublish( 0x30U, pPacket, TEST_JSON_ACCEPTED_TOPIC_LENGTH + 1U,
+                                                             &( api ), NULL, NULL, &( payloadOffset ) ) );
+    TEST_ASSERT_EQUAL( DefenderError, Defender_MatchPublish( 0x32U, pPacket, TEST_JSON_ACCEPTED_TOPIC_LENGTH + 3U,
+                                                             &( api ), NULL, NULL, &( payloadOffset ) ) );
+    TEST_ASSERT_EQUAL( 0U, payloadOffset );
+
+    /* The topic and the packet identifier exactly fill the packet. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_MatchPublish( 0x32U, pPacket, TEST_JSON_ACCEPTED_TOPIC_LENGTH + 4U,
+                                                               &( api ), NULL, NULL, &( payloadOffset ) ) );
+    TEST_ASSERT_EQUAL( TEST_JSON_ACCEPTED_TOPIC_LENGTH + 4U, payloadOffset );
+}
+/*-----------------------------------------------------------*/
+
+void test_Defender_MatchPublish_NoMatch( void )
+{
+    const uint8_t * pPacket = ( const uint8_t * ) &( testTopicBuffer[ TEST_TOPIC_BUFFER_PREFIX_GUARD_LENGTH ] );
+    uint32_t length, payloadOffset = 0U;
+    DefenderTopic_t api;
+
+    length = writePublish( "$aws/things/" TEST_THING_NAME "/shadow/update", TEST_THING_NAME_LENGTH + 26U, 1U );
+    TEST_ASSERT_EQUAL( DefenderNoMatch, Defender_MatchPublish( 0x32U, pPacket, length, &( api ), NULL, NULL, &( payloadOffset ) ) );
+    TEST_ASSERT_EQUAL( 0U, payloadOffset );
+
+    /* The topic length is read as big endian. */
+    length = writePublish( TEST_JSON_ACCEPTED_TOPIC, TEST_JSON_ACCEPTED_TOPIC_LENGTH, 0U );
+    testTopicBuffer[ TEST_TOPIC_BUFFER_PREFIX_GUARD_LENGTH ] = ( char ) TEST_JSON_ACCEPTED_TOPIC_LENGTH;
+    testTopicBuffer[ TEST_TOPIC_BUFFER_PREFIX_GUARD_LENGTH + 1 ] = 0;
+    TEST_ASSERT_EQUAL( DefenderError, Defender_MatchPublish( 0x30U, pPacket, length, &( api ), NULL, NULL, &( payloadOffset ) ) );
+}
+/*-----------------------------------------------------------*/
+
+void test_Defender_MatchPublish_HappyPath( void )
+{
+    const uint8_t * pPacket = ( const uint8_t * ) &( testTopicBuffer[ TEST_TOPIC_BUFFER_PREFIX_GUARD_LENGTH ] );
+    uint32_t length, payloadOffset;
+    const char * pThingName;
+    uint16_t thingNameLength;
+    DefenderTopic_t api;
+    uint8_t qos;
+
+    for( qos = 0U; qos < 3U; qos++ )
+    {
+        length = writePublish( TEST_CBOR_REJECTED_TOPIC, TEST_CBOR_REJECTED_TOPIC_LENGTH, qos );
+
+        /* DUP and RETAIN flags do not matter. */
+        TEST_ASSERT_EQUAL( DefenderSuccess, Defender_MatchPublish( ( uint8_t ) ( 0x39U | ( qos << 1 ) ), pPacket, length, &( api ),
+                                                                   &( pThingName ), &( thingNameLength ), &( payloadOffset ) ) );
+        TEST_ASSERT_EQUAL( DefenderCborReportRejected, api );
+        TEST_ASSERT_EQUAL_PTR( &( pPacket[ 2U + DEFENDER_API_LENGTH_PREFIX ] ), pThingName );
+        TEST_ASSERT_EQUAL( TEST_THING_NAME_LENGTH, thingNameLength );
+        TEST_ASSERT_EQUAL( length - 2U, payloadOffset );
+        TEST_ASSERT_EQUAL_MEMORY( "{}", &( pPacket[ payloadOffset ] ), 2U );
+    }
+}
+/*-----------------------------------------------------------*/
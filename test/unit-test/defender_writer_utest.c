@@ -0,0 +1,187 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file defender_writer_utest.c
+ * @brief Unit tests for the report writer of the Device Defender library.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Test framework include. */
+#include "unity.h"
+
+/* Writer include. */
+#include "defender_writer.h"
+
+/**
+ * @brief Length of the output buffer.
+ */
+#define TEST_BUFFER_LENGTH    64U
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Output buffer and writer used in the tests.
+ */
+static char testBuffer[ TEST_BUFFER_LENGTH ];
+static DefenderWriter_t testWriter;
+/*-----------------------------------------------------------*/
+
+/* ============================   UNITY FIXTURES ============================ */
+
+/* Called before each test method. */
+void setUp()
+{
+    ( void ) memset( &( testBuffer[ 0 ] ), 0, sizeof( testBuffer ) );
+    Defender_WriterInit( &( testWriter ), &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH );
+}
+
+/* Called after each test method. */
+void tearDown()
+{
+}
+
+/* Called at the beginning of the whole suite. */
+void suiteSetUp()
+{
+}
+
+/* Called at the end of the whole suite. */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test writing bytes, escaped strings, numbers and addresses.
+ */
+void test_Defender_Writer_Happy( void )
+{
+    static const char expected[] = "[0,18446744073709551615,\"a\\\"b\",\"10.0.255.1\"]";
+
+    Defender_WriteBytes( &( testWriter ), "[", 1U );
+    Defender_WriteDecimal( &( testWriter ), 0U );
+    Defender_WriteBytes( &( testWriter ), ",", 1U );
+    Defender_WriteDecimal( &( testWriter ), UINT64_MAX );
+    Defender_WriteBytes( &( testWriter ), ",\"", 2U );
+    Defender_WriteEscaped( &( testWriter ), "a\"b", 3U );
+    Defender_WriteBytes( &( testWriter ), "\",\"", 3U );
+    Defender_WriteIpv4Address( &( testWriter ), 0x0A00FF01U );
+    Defender_WriteBytes( &( testWriter ), "\"]", 2U );
+
+    TEST_ASSERT_EQUAL( DefenderSuccess, testWriter.status );
+    TEST_ASSERT_EQUAL( STRING_LITERAL_LENGTH( expected ), testWriter.length );
+    TEST_ASSERT_EQUAL_MEMORY( expected, testBuffer, testWriter.length );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that the first write which fails stops the writes after it.
+ */
+void test_Defender_Writer_Errors( void )
+{
+    /* A number which does not fit. */
+    Defender_WriterInit( &( testWriter ), &( testBuffer[ 0 ] ), 4U );
+    Defender_WriteDecimal( &( testWriter ), 123U );
+    Defender_WriteDecimal( &( testWriter ), 45U );
+    TEST_ASSERT_EQUAL( DefenderBufferTooSmall, testWriter.status );
+    TEST_ASSERT_EQUAL( 3U, testWriter.length );
+
+    Defender_WriteBytes( &( testWriter ), "x", 1U );
+    Defender_WriteEscaped( &( testWriter ), "x", 1U );
+    TEST_ASSERT_EQUAL( DefenderBufferTooSmall, testWriter.status );
+    TEST_ASSERT_EQUAL( 3U, testWriter.length );
+
+    /* A string which is not valid UTF-8. */
+    Defender_WriterInit( &( testWriter ), &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH );
+    Defender_WriteEscaped( &( testWriter ), "caf\xC3", 4U );
+    TEST_ASSERT_EQUAL( DefenderError, testWriter.status );
+
+    Defender_WriteBytes( &( testWriter ), "x", 1U );
+    TEST_ASSERT_EQUAL( DefenderError, testWriter.status );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test opening new and given objects, and keeping a given object when
+ * a write fails.
+ */
+void test_Defender_Writer_Objects( void )
+{
+    uint8_t hasMembers = 1U;
+
+    /* A new object. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_WriteObjectStart( &( testWriter ), &( hasMembers ) ) );
+    TEST_ASSERT_EQUAL( 0U, hasMembers );
+    Defender_WriteObjectEnd( &( testWriter ), 0U );
+    TEST_ASSERT_EQUAL( DefenderSuccess, testWriter.status );
+    TEST_ASSERT_EQUAL_STRING_LEN( "{}", testBuffer, testWriter.length );
+
+    /* An empty object given in the output. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_WriteObjectStart( &( testWriter ), &( hasMembers ) ) );
+    TEST_ASSERT_EQUAL( 0U, hasMembers );
+    Defender_WriteBytes( &( testWriter ), "\"a\":1", 5U );
+    Defender_WriteObjectEnd( &( testWriter ), 2U );
+    TEST_ASSERT_EQUAL_STRING_LEN( "{\"a\":1}", testBuffer, testWriter.length );
+
+    /* An object with members. */
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_WriteObjectStart( &( testWriter ), &( hasMembers ) ) );
+    TEST_ASSERT_EQUAL( 1U, hasMembers );
+    Defender_WriteBytes( &( testWriter ), ",\"b\":2", 6U );
+    Defender_WriteObjectEnd( &( testWriter ), 7U );
+    TEST_ASSERT_EQUAL( DefenderSuccess, testWriter.status );
+    TEST_ASSERT_EQUAL_STRING_LEN( "{\"a\":1,\"b\":2}", testBuffer, testWriter.length );
+
+    /* The members do not fit, and the given object is kept. */
+    testWriter.bufferLength = 16U;
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_WriteObjectStart( &( testWriter ), &( hasMembers ) ) );
+    Defender_WriteBytes( &( testWriter ), ",\"c\":3", 6U );
+    Defender_WriteObjectEnd( &( testWriter ), 13U );
+    TEST_ASSERT_EQUAL( DefenderBufferTooSmall, testWriter.status );
+    TEST_ASSERT_EQUAL_STRING_LEN( "{\"a\":1,\"b\":2}", testBuffer, testWriter.length );
+
+    /* A new object which does not fit. */
+    Defender_WriterInit( &( testWriter ), &( testBuffer[ 0 ] ), 1U );
+    TEST_ASSERT_EQUAL( DefenderSuccess, Defender_WriteObjectStart( &( testWriter ), &( hasMembers ) ) );
+    Defender_WriteObjectEnd( &( testWriter ), 0U );
+    TEST_ASSERT_EQUAL( DefenderBufferTooSmall, testWriter.status );
+    TEST_ASSERT_EQUAL( 0U, testWriter.length );
+
+    /* Outputs which are not objects are not changed. */
+    Defender_WriterInit( &( testWriter ), &( testBuffer[ 0 ] ), TEST_BUFFER_LENGTH );
+    Defender_WriteBytes( &( testWriter ), "[]", 2U );
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_WriteObjectStart( &( testWriter ), &( hasMembers ) ) );
+    TEST_ASSERT_EQUAL( 2U, testWriter.length );
+
+    testWriter.length = 1U;
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_WriteObjectStart( &( testWriter ), &( hasMembers ) ) );
+
+    testBuffer[ 0 ] = '{';
+    testWriter.length = 2U;
+    TEST_ASSERT_EQUAL( DefenderBadParameter, Defender_WriteObjectStart( &( testWriter ), &( hasMembers ) ) );
+    TEST_ASSERT_EQUAL( DefenderSuccess, testWriter.status );
+}
+/*-----------------------------------------------------------*/
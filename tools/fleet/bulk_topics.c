@@ -0,0 +1,330 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file bulk_topics.c
+ * @brief Generates the topics of a large fleet with a pool of threads.
+ *
+ * Usage:
+ *   defender_bulk_topics [-n thing-count] [-t max-threads] [-a api]
+ *
+ * The tool creates thing-count synthetic thing names, computes the topic
+ * offsets once with Defender_GetTopicOffsets, and then generates all topics
+ * with 1, 2, 4, ... up to max-threads threads. Each thread writes a byte range
+ * of roughly equal size with Defender_GetTopicRange, so the threads share
+ * nothing and are only joined at the end. The output of every run is compared
+ * with the single thread output.
+ */
+
+/* Standard includes. */
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* POSIX includes. */
+#include <pthread.h>
+#include <unistd.h>
+
+/* Bulk API include. */
+#include "defender_bulk.h"
+
+/**
+ * @brief Work of one thread.
+ */
+typedef struct BulkWork
+{
+    pthread_t thread;
+    char * pBuffer;
+    uint32_t bufferLength;
+    const uint32_t * pOffsets;
+    const char * const * ppThingNames;
+    const uint16_t * pThingNameLengths;
+    uint32_t first;
+    uint32_t last;
+    DefenderTopic_t api;
+    DefenderStatus_t status;
+} BulkWork_t;
+
+/*-----------------------------------------------------------*/
+
+static void * bulkWorker( void * pArgument )
+{
+    BulkWork_t * pWork = ( BulkWork_t * ) pArgument;
+
+    pWork->status = Defender_GetTopicRange( pWork->pBuffer, pWork->bufferLength,
+                                            pWork->pOffsets, pWork->ppThingNames,
+                                            pWork->pThingNameLengths,
+                                            pWork->first, pWork->last, pWork->api );
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+
+/* Index of the first thing whose topic starts at or after byteOffset. */
+static uint32_t findFirstThing( const uint32_t * pOffsets,
+                                uint32_t thingCount,
+                                uint64_t byteOffset )
+{
+    uint32_t low = 0, high = thingCount, middle;
+
+    while( low < high )
+    {
+        middle = low + ( ( high - low ) / 2U );
+
+        if( pOffsets[ middle ] < byteOffset )
+        {
+            low = middle + 1U;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+/*-----------------------------------------------------------*/
+
+static double elapsedSeconds( const struct timespec * pStart )
+{
+    struct timespec now;
+
+    ( void ) clock_gettime( CLOCK_MONOTONIC, &( now ) );
+
+    return ( double ) ( now.tv_sec - pStart->tv_sec ) +
+           ( ( double ) ( now.tv_nsec - pStart->tv_nsec ) / 1e9 );
+}
+/*-----------------------------------------------------------*/
+
+static int generateTopics( char * pBuffer,
+                           const uint32_t * pOffsets,
+                           const char * const * ppThingNames,
+                           const uint16_t * pThingNameLengths,
+                           uint32_t thingCount,
+                           DefenderTopic_t api,
+                           uint32_t threadCount,
+                           BulkWork_t * pWork )
+{
+    uint64_t totalLength = pOffsets[ thingCount ];
+    uint32_t i, started = 0;
+    int ret = 0;
+
+    /* Split the output into ranges of equal bytes rather than equal things,
+     * so that threads with long thing names do not finish last. */
+    for( i = 0; i < threadCount; i++ )
+    {
+        pWork[ i ].pBuffer = pBuffer;
+        pWork[ i ].bufferLength = pOffsets[ thingCount ];
+        pWork[ i ].pOffsets = pOffsets;
+        pWork[ i ].ppThingNames = ppThingNames;
+        pWork[ i ].pThingNameLengths = pThingNameLengths;
+        pWork[ i ].first = findFirstThing( pOffsets, thingCount, ( totalLength * i ) / threadCount );
+        pWork[ i ].last = findFirstThing( pOffsets, thingCount, ( totalLength * ( i + 1U ) ) / threadCount );
+        pWork[ i ].api = api;
+        pWork[ i ].status = DefenderError;
+    }
+
+    /* The calling thread takes the first range itself. */
+    for( i = 1; ( ret == 0 ) && ( i < threadCount ); i++ )
+    {
+        ret = pthread_create( &( pWork[ i ].thread ), NULL, bulkWorker, &( pWork[ i ] ) );
+
+        if( ret == 0 )
+        {
+            started++;
+        }
+        else
+        {
+            fprintf( stderr, "Cannot create thread: %s\n", strerror( ret ) );
+        }
+    }
+
+    ( void ) bulkWorker( &( pWork[ 0 ] ) );
+
+    for( i = 1; i <= started; i++ )
+    {
+        ( void ) pthread_join( pWork[ i ].thread, NULL );
+    }
+
+    for( i = 0; ( ret == 0 ) && ( i < threadCount ); i++ )
+    {
+        if( pWork[ i ].status != DefenderSuccess )
+        {
+            fprintf( stderr, "Thread %u failed: %d.\n", ( unsigned int ) i, ( int ) pWork[ i ].status );
+            ret = -1;
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    uint32_t thingCount = 1000000, maxThreads, threadCount, nextThreadCount, i;
+    long cpuCount = sysconf( _SC_NPROCESSORS_ONLN );
+    DefenderTopic_t api = DefenderJsonReportAccepted;
+    char * pNames = NULL, * pReference = NULL, * pBuffer = NULL;
+    const char ** ppThingNames = NULL;
+    uint16_t * pThingNameLengths = NULL;
+    uint32_t * pOffsets = NULL;
+    BulkWork_t * pWork = NULL;
+    struct timespec start;
+    double seconds;
+    int option, ret = 0;
+
+    maxThreads = ( cpuCount > 0 ) ? ( uint32_t ) cpuCount : 1U;
+
+    while( ( option = getopt( argc, argv, "n:t:a:" ) ) != -1 )
+    {
+        if( option == 'n' )
+        {
+            thingCount = ( uint32_t ) strtoul( optarg, NULL, 10 );
+        }
+        else if( option == 't' )
+        {
+            maxThreads = ( uint32_t ) strtoul( optarg, NULL, 10 );
+        }
+        else if( option == 'a' )
+        {
+            api = ( DefenderTopic_t ) atoi( optarg );
+        }
+        else
+        {
+            ret = -1;
+        }
+    }
+
+    if( ( ret != 0 ) || ( thingCount == 0U ) || ( thingCount > 100000000U ) ||
+        ( maxThreads == 0U ) || ( maxThreads > 1024U ) ||
+        ( api <= DefenderInvalidTopic ) || ( api >= DefenderMaxTopic ) )
+    {
+        fprintf( stderr, "Usage: %s [-n thing-count] [-t max-threads] [-a api 0-%d]\n",
+                 argv[ 0 ], ( int ) DefenderMaxTopic - 1 );
+        ret = -1;
+    }
+
+    if( ret == 0 )
+    {
+        /* Synthetic thing names of 16 characters each. */
+        pNames = malloc( ( size_t ) thingCount * 17U );
+        ppThingNames = malloc( ( size_t ) thingCount * sizeof( const char * ) );
+        pThingNameLengths = malloc( ( size_t ) thingCount * sizeof( uint16_t ) );
+        pOffsets = malloc( ( ( size_t ) thingCount + 1U ) * sizeof( uint32_t ) );
+        pWork = calloc( maxThreads, sizeof( BulkWork_t ) );
+
+        if( ( pNames == NULL ) || ( ppThingNames == NULL ) || ( pThingNameLengths == NULL ) ||
+            ( pOffsets == NULL ) || ( pWork == NULL ) )
+        {
+            fprintf( stderr, "Out of memory.\n" );
+            ret = -1;
+        }
+    }
+
+    if( ret == 0 )
+    {
+        for( i = 0; i < thingCount; i++ )
+        {
+            ( void ) snprintf( &( pNames[ ( size_t ) i * 17U ] ), 17U, "thing-%010u", i );
+            ppThingNames[ i ] = &( pNames[ ( size_t ) i * 17U ] );
+            pThingNameLengths[ i ] = 16U;
+        }
+
+        if( Defender_GetTopicOffsets( pThingNameLengths, thingCount, api, pOffsets ) != DefenderSuccess )
+        {
+            fprintf( stderr, "The topics of %u things do not fit in one buffer.\n", ( unsigned int ) thingCount );
+            ret = -1;
+        }
+    }
+
+    if( ret == 0 )
+    {
+        pReference = malloc( pOffsets[ thingCount ] );
+        pBuffer = malloc( pOffsets[ thingCount ] );
+
+        if( ( pReference == NULL ) || ( pBuffer == NULL ) )
+        {
+            fprintf( stderr, "Out of memory.\n" );
+            ret = -1;
+        }
+        else
+        {
+            /* Touch the pages once so that page faults are not timed. */
+            ( void ) memset( pBuffer, 0, pOffsets[ thingCount ] );
+            ret = generateTopics( pReference, pOffsets, ppThingNames, pThingNameLengths,
+                                  thingCount, api, 1U, pWork );
+        }
+    }
+
+    if( ret == 0 )
+    {
+        printf( "%u things, %u bytes of topics.\n",
+                ( unsigned int ) thingCount, ( unsigned int ) pOffsets[ thingCount ] );
+        printf( "threads    seconds    MB/s       things/s\n" );
+    }
+
+    for( threadCount = 1U; ( ret == 0 ) && ( threadCount <= maxThreads ); threadCount = nextThreadCount )
+    {
+        ( void ) clock_gettime( CLOCK_MONOTONIC, &( start ) );
+        ret = generateTopics( pBuffer, pOffsets, ppThingNames, pThingNameLengths,
+                              thingCount, api, threadCount, pWork );
+        seconds = elapsedSeconds( &( start ) );
+
+        if( ( ret == 0 ) && ( memcmp( pBuffer, pReference, pOffsets[ thingCount ] ) != 0 ) )
+        {
+            fprintf( stderr, "Output of %u threads differs.\n", ( unsigned int ) threadCount );
+            ret = -1;
+        }
+
+        if( ret == 0 )
+        {
+            printf( "%-10u %-10.4f %-10.1f %.0f\n",
+                    ( unsigned int ) threadCount, seconds,
+                    ( double ) pOffsets[ thingCount ] / seconds / 1e6,
+                    ( double ) thingCount / seconds );
+            ( void ) memset( pBuffer, 0, pOffsets[ thingCount ] );
+        }
+
+        /* Also run exactly max-threads when it is not a power of two. */
+        nextThreadCount = threadCount * 2U;
+
+        if( ( threadCount < maxThreads ) && ( nextThreadCount > maxThreads ) )
+        {
+            nextThreadCount = maxThreads;
+        }
+    }
+
+    free( pNames );
+    free( ppThingNames );
+    free( pThingNameLengths );
+    free( pOffsets );
+    free( pWork );
+    free( pReference );
+    free( pBuffer );
+
+    return ( ret == 0 ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
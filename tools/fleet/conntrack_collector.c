@@ -0,0 +1,616 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file conntrack_collector.c
+ * @brief Keeps the forwarded flows of a NAT gateway from the connection
+ * tracking events of the kernel, and prints their connections and byte
+ * counters every report period.
+ *
+ * Usage:
+ *   defender_conntrack_collector [-p period-seconds] [-n periods] [-c capacity] [-f]
+ *
+ * The tool subscribes to the new, update and destroy events of ctnetlink and
+ * applies them to a flow table from defender_flow_table.h. The kernel table is
+ * dumped once at start, on a second socket after the subscription so that no
+ * event is missed, and again only if the kernel drops events because the
+ * socket buffer is full (ENOBUFS). A report period therefore costs one pass
+ * over the flow table, however many flows the gateway tracks.
+ *
+ * Every period the tool prints the established connections object of the TCP
+ * flows in state ESTABLISHED, and with -f one line per flow with its byte counters. Byte counters
+ * are only sent by the kernel when net.netfilter.nf_conntrack_acct is 1.
+ * The tool needs CAP_NET_ADMIN.
+ */
+
+/* Standard includes. */
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* POSIX and Linux includes. */
+#include <arpa/inet.h>
+#include <linux/netfilter/nfnetlink.h>
+#include <linux/netfilter/nfnetlink_compat.h>
+#include <linux/netfilter/nfnetlink_conntrack.h>
+#include <linux/netlink.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/* Device Defender includes. */
+#include "defender_flow_table.h"
+
+/**
+ * @brief Length of the netlink receive buffer.
+ */
+#define RECEIVE_BUFFER_LENGTH    ( 64U * 1024U )
+
+/**
+ * @brief Size requested for the kernel buffer of the event socket.
+ */
+#define EVENT_SOCKET_BUFFER      ( 8 * 1024 * 1024 )
+
+/**
+ * @brief Largest attribute type used by the tool, plus one.
+ */
+#define MAX_ATTRIBUTES           ( CTA_COUNTERS_REPLY + 1 )
+
+/**
+ * @brief State of the collector.
+ */
+typedef struct Collector
+{
+    DefenderFlowTable_t flows;
+    uint32_t droppedFlows;
+    uint32_t resyncs;
+    int eventSocket;
+} Collector_t;
+
+/*-----------------------------------------------------------*/
+
+/* Index the attributes of a buffer by type. Unknown types are ignored. */
+static void indexAttributes( const uint8_t * pBuffer,
+                             size_t length,
+                             const struct nlattr ** ppAttributes )
+{
+    const struct nlattr * pAttribute;
+    size_t offset = 0U;
+    uint16_t type;
+
+    ( void ) memset( ppAttributes, 0, MAX_ATTRIBUTES * sizeof( const struct nlattr * ) );
+
+    while( ( offset + NLA_HDRLEN ) <= length )
+    {
+        pAttribute = ( const struct nlattr * ) &( pBuffer[ offset ] );
+
+        if( ( pAttribute->nla_len < NLA_HDRLEN ) || ( ( offset + pAttribute->nla_len ) > length ) )
+        {
+            break;
+        }
+
+        type = pAttribute->nla_type & NLA_TYPE_MASK;
+
+        if( type < MAX_ATTRIBUTES )
+        {
+            ppAttributes[ type ] = pAttribute;
+        }
+
+        offset += NLA_ALIGN( pAttribute->nla_len );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static const uint8_t * attributeData( const struct nlattr * pAttribute )
+{
+    return ( const uint8_t * ) pAttribute + NLA_HDRLEN;
+}
+/*-----------------------------------------------------------*/
+
+static size_t attributeLength( const struct nlattr * pAttribute )
+{
+    return ( size_t ) pAttribute->nla_len - NLA_HDRLEN;
+}
+/*-----------------------------------------------------------*/
+
+/* Read a big endian integer attribute of up to 8 bytes. */
+static uint64_t readBigEndian( const struct nlattr * pAttribute )
+{
+    const uint8_t * pData = attributeData( pAttribute );
+    size_t length = attributeLength( pAttribute ), i;
+    uint64_t value = 0U;
+
+    for( i = 0U; ( i < length ) && ( i < 8U ); i++ )
+    {
+        value = ( value << 8 ) | pData[ i ];
+    }
+
+    return value;
+}
+/*-----------------------------------------------------------*/
+
+/* Read the byte counter of one direction, or 0 without accounting. */
+static uint64_t readCounter( const struct nlattr * pCounters )
+{
+    const struct nlattr * pAttributes[ MAX_ATTRIBUTES ];
+    uint64_t bytes = 0U;
+
+    if( pCounters != NULL )
+    {
+        indexAttributes( attributeData( pCounters ), attributeLength( pCounters ), pAttributes );
+
+        if( pAttributes[ CTA_COUNTERS_BYTES ] != NULL )
+        {
+            bytes = readBigEndian( pAttributes[ CTA_COUNTERS_BYTES ] );
+        }
+    }
+
+    return bytes;
+}
+/*-----------------------------------------------------------*/
+
+/* Read the TCP state of a flow, or DEFENDER_FLOW_TCP_STATE_NONE if the
+ * message does not carry it. */
+static uint8_t readTcpState( const struct nlattr * pProtoInfo )
+{
+    const struct nlattr * pProtocols[ MAX_ATTRIBUTES ];
+    const struct nlattr * pTcp[ MAX_ATTRIBUTES ];
+    uint8_t state = DEFENDER_FLOW_TCP_STATE_NONE;
+
+    if( pProtoInfo != NULL )
+    {
+        indexAttributes( attributeData( pProtoInfo ), attributeLength( pProtoInfo ), pProtocols );
+
+        if( pProtocols[ CTA_PROTOINFO_TCP ] != NULL )
+        {
+            indexAttributes( attributeData( pProtocols[ CTA_PROTOINFO_TCP ] ),
+                             attributeLength( pProtocols[ CTA_PROTOINFO_TCP ] ), pTcp );
+
+            if( pTcp[ CTA_PROTOINFO_TCP_STATE ] != NULL )
+            {
+                state = ( uint8_t ) readBigEndian( pTcp[ CTA_PROTOINFO_TCP_STATE ] );
+            }
+        }
+    }
+
+    return state;
+}
+/*-----------------------------------------------------------*/
+
+/* Read the flow of a ctnetlink message. Returns -1 for flows which are not
+ * IPv4 TCP or UDP flows. */
+static int readFlow( const struct nlmsghdr * pMessage,
+                     DefenderFlow_t * pFlow )
+{
+    const struct nlattr * pAttributes[ MAX_ATTRIBUTES ];
+    const struct nlattr * pTuple[ MAX_ATTRIBUTES ];
+    const struct nlattr * pIp[ MAX_ATTRIBUTES ];
+    const struct nlattr * pProto[ MAX_ATTRIBUTES ];
+    size_t headerLength = NLMSG_LENGTH( sizeof( struct nfgenmsg ) );
+    int ret = -1;
+
+    ( void ) memset( pFlow, 0, sizeof( DefenderFlow_t ) );
+
+    if( pMessage->nlmsg_len >= headerLength )
+    {
+        indexAttributes( ( const uint8_t * ) pMessage + NLMSG_ALIGN( headerLength ),
+                         pMessage->nlmsg_len - NLMSG_ALIGN( headerLength ), pAttributes );
+    }
+    else
+    {
+        pAttributes[ CTA_TUPLE_ORIG ] = NULL;
+    }
+
+    if( pAttributes[ CTA_TUPLE_ORIG ] != NULL )
+    {
+        indexAttributes( attributeData( pAttributes[ CTA_TUPLE_ORIG ] ),
+                         attributeLength( pAttributes[ CTA_TUPLE_ORIG ] ), pTuple );
+
+        if( ( pTuple[ CTA_TUPLE_IP ] != NULL ) && ( pTuple[ CTA_TUPLE_PROTO ] != NULL ) )
+        {
+            indexAttributes( attributeData( pTuple[ CTA_TUPLE_IP ] ), attributeLength( pTuple[ CTA_TUPLE_IP ] ), pIp );
+            indexAttributes( attributeData( pTuple[ CTA_TUPLE_PROTO ] ), attributeLength( pTuple[ CTA_TUPLE_PROTO ] ), pProto );
+
+            if( ( pIp[ CTA_IP_V4_SRC ] != NULL ) && ( pIp[ CTA_IP_V4_DST ] != NULL ) &&
+                ( pProto[ CTA_PROTO_NUM ] != NULL ) && ( pProto[ CTA_PROTO_SRC_PORT ] != NULL ) &&
+                ( pProto[ CTA_PROTO_DST_PORT ] != NULL ) )
+            {
+                pFlow->sourceAddress = ( uint32_t ) readBigEndian( pIp[ CTA_IP_V4_SRC ] );
+                pFlow->destinationAddress = ( uint32_t ) readBigEndian( pIp[ CTA_IP_V4_DST ] );
+                pFlow->protocol = ( uint8_t ) readBigEndian( pProto[ CTA_PROTO_NUM ] );
+                pFlow->sourcePort = ( uint16_t ) readBigEndian( pProto[ CTA_PROTO_SRC_PORT ] );
+                pFlow->destinationPort = ( uint16_t ) readBigEndian( pProto[ CTA_PROTO_DST_PORT ] );
+                pFlow->bytesOriginal = readCounter( pAttributes[ CTA_COUNTERS_ORIG ] );
+                pFlow->bytesReply = readCounter( pAttributes[ CTA_COUNTERS_REPLY ] );
+
+                if( pFlow->protocol == DEFENDER_FLOW_PROTOCOL_TCP )
+                {
+                    pFlow->tcpState = readTcpState( pAttributes[ CTA_PROTOINFO ] );
+                }
+                ret = 0;
+            }
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+/* Apply one ctnetlink message to the flow table. */
+static void applyMessage( Collector_t * pCollector,
+                          const struct nlmsghdr * pMessage )
+{
+    DefenderFlow_t flow;
+    uint16_t messageType = NFNL_MSG_TYPE( pMessage->nlmsg_type );
+
+    if( ( NFNL_SUBSYS_ID( pMessage->nlmsg_type ) == NFNL_SUBSYS_CTNETLINK ) &&
+        ( readFlow( pMessage, &( flow ) ) == 0 ) &&
+        ( ( flow.protocol == DEFENDER_FLOW_PROTOCOL_TCP ) || ( flow.protocol == DEFENDER_FLOW_PROTOCOL_UDP ) ) )
+    {
+        if( messageType == IPCTNL_MSG_CT_DELETE )
+        {
+            /* Flows which were dropped when the table was full are not
+             * found, which is fine. */
+            ( void ) Defender_FlowTableRemove( &( pCollector->flows ), &( flow ), NULL );
+        }
+        else if( Defender_FlowTableUpdate( &( pCollector->flows ), &( flow ) ) == DefenderBufferTooSmall )
+        {
+            pCollector->droppedFlows++;
+        }
+        else
+        {
+            /* The flow is added or updated. */
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* Receive and apply the messages waiting on a socket. Returns 1 at the end
+ * of a dump, 0 if more messages may come, and -1 on errors. */
+static int receiveMessages( Collector_t * pCollector,
+                            int fd,
+                            uint8_t * pBuffer )
+{
+    const struct nlmsghdr * pMessage;
+    ssize_t length;
+    size_t remaining;
+    int ret = 0;
+
+    length = recv( fd, pBuffer, RECEIVE_BUFFER_LENGTH, 0 );
+
+    if( length < 0 )
+    {
+        ret = -1;
+    }
+    else
+    {
+        remaining = ( size_t ) length;
+        pMessage = ( const struct nlmsghdr * ) pBuffer;
+
+        while( ( ret == 0 ) && NLMSG_OK( pMessage, remaining ) )
+        {
+            if( pMessage->nlmsg_type == NLMSG_DONE )
+            {
+                ret = 1;
+            }
+            else if( pMessage->nlmsg_type == NLMSG_ERROR )
+            {
+                errno = -( ( const struct nlmsgerr * ) NLMSG_DATA( pMessage ) )->error;
+                ret = ( errno == 0 ) ? 1 : -1;
+            }
+            else
+            {
+                applyMessage( pCollector, pMessage );
+            }
+
+            pMessage = NLMSG_NEXT( pMessage, remaining );
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+/* Dump the conntrack table of the kernel into the flow table. */
+static int dumpFlows( Collector_t * pCollector,
+                      uint8_t * pBuffer )
+{
+    struct
+    {
+        struct nlmsghdr header;
+        struct nfgenmsg message;
+    } request;
+    struct sockaddr_nl kernel = { .nl_family = AF_NETLINK };
+    int fd, ret;
+
+    ( void ) memset( &( request ), 0, sizeof( request ) );
+    request.header.nlmsg_len = NLMSG_LENGTH( sizeof( struct nfgenmsg ) );
+    request.header.nlmsg_type = ( NFNL_SUBSYS_CTNETLINK << 8 ) | IPCTNL_MSG_CT_GET;
+    request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    request.header.nlmsg_seq = 1U;
+    request.message.nfgen_family = AF_INET;
+    request.message.version = NFNETLINK_V0;
+
+    fd = socket( AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_NETFILTER );
+    ret = ( fd < 0 ) ? -1 : 0;
+
+    if( ( ret == 0 ) &&
+        ( sendto( fd, &( request ), request.header.nlmsg_len, 0,
+                  ( const struct sockaddr * ) &( kernel ), sizeof( kernel ) ) < 0 ) )
+    {
+        ret = -1;
+    }
+
+    while( ret == 0 )
+    {
+        ret = receiveMessages( pCollector, fd, pBuffer );
+    }
+
+    if( fd >= 0 )
+    {
+        ( void ) close( fd );
+    }
+
+    return ( ret == 1 ) ? 0 : -1;
+}
+/*-----------------------------------------------------------*/
+
+/* Print the connections of the established TCP flows and, if asked, every
+ * flow. */
+static int printReport( const Collector_t * pCollector,
+                        DefenderConnectionTable_t * pConnections,
+                        DefenderConnectionTable_t * pScratch,
+                        char * pBuffer,
+                        uint32_t bufferLength,
+                        int printFlows )
+{
+    const DefenderFlow_t * pFlow;
+    uint32_t length = 0U, i;
+    int ret = 0;
+
+    pConnections->count = 0U;
+
+    if( ( Defender_FlowTableGetConnections( &( pCollector->flows ), pConnections ) != DefenderSuccess ) ||
+        ( Defender_ConnectionTableSort( pConnections, pScratch ) != DefenderSuccess ) ||
+        ( Defender_ConnectionTableDedup( pConnections ) != DefenderSuccess ) ||
+        ( Defender_ConnectionTableSerialize( pConnections, NULL, NULL, 0U,
+                                             pBuffer, bufferLength, &( length ) ) != DefenderSuccess ) )
+    {
+        fprintf( stderr, "Cannot write the connections.\n" );
+        ret = -1;
+    }
+    else
+    {
+        printf( "%u flows, %u dropped, %u resyncs\n%.*s\n",
+                ( unsigned int ) pCollector->flows.count, ( unsigned int ) pCollector->droppedFlows,
+                ( unsigned int ) pCollector->resyncs, ( int ) length, pBuffer );
+    }
+
+    for( i = 0U; ( ret == 0 ) && ( printFlows != 0 ) && ( i < pCollector->flows.count ); i++ )
+    {
+        pFlow = &( pCollector->flows.pFlows[ i ] );
+        printf( "%s %u.%u.%u.%u:%u -> %u.%u.%u.%u:%u %llu %llu\n",
+                ( pFlow->protocol == DEFENDER_FLOW_PROTOCOL_TCP ) ? "tcp" : "udp",
+                ( unsigned int ) ( pFlow->sourceAddress >> 24 ), ( unsigned int ) ( ( pFlow->sourceAddress >> 16 ) & 0xFFU ),
+                ( unsigned int ) ( ( pFlow->sourceAddress >> 8 ) & 0xFFU ), ( unsigned int ) ( pFlow->sourceAddress & 0xFFU ),
+                ( unsigned int ) pFlow->sourcePort,
+                ( unsigned int ) ( pFlow->destinationAddress >> 24 ), ( unsigned int ) ( ( pFlow->destinationAddress >> 16 ) & 0xFFU ),
+                ( unsigned int ) ( ( pFlow->destinationAddress >> 8 ) & 0xFFU ), ( unsigned int ) ( pFlow->destinationAddress & 0xFFU ),
+                ( unsigned int ) pFlow->destinationPort,
+                ( unsigned long long ) pFlow->bytesOriginal, ( unsigned long long ) pFlow->bytesReply );
+    }
+
+    ( void ) fflush( stdout );
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+static int64_t nowMilliseconds( void )
+{
+    struct timespec now;
+
+    ( void ) clock_gettime( CLOCK_MONOTONIC, &( now ) );
+
+    return ( ( int64_t ) now.tv_sec * 1000 ) + ( now.tv_nsec / 1000000 );
+}
+/*-----------------------------------------------------------*/
+
+/* Apply events until the next report is due. */
+static int followEvents( Collector_t * pCollector,
+                         uint8_t * pBuffer,
+                         int64_t reportTime )
+{
+    struct pollfd pollFd = { .fd = pCollector->eventSocket, .events = POLLIN };
+    int64_t timeout = reportTime - nowMilliseconds();
+    int ret = 0;
+
+    while( ( ret == 0 ) && ( timeout > 0 ) )
+    {
+        if( poll( &( pollFd ), 1, ( int ) timeout ) > 0 )
+        {
+            ret = receiveMessages( pCollector, pCollector->eventSocket, pBuffer );
+
+            /* Events were lost, so the flow table is rebuilt from a dump. */
+            if( ( ret < 0 ) && ( errno == ENOBUFS ) )
+            {
+                ( void ) Defender_FlowTableClear( &( pCollector->flows ) );
+                pCollector->resyncs++;
+                ret = dumpFlows( pCollector, pBuffer );
+            }
+        }
+
+        timeout = reportTime - nowMilliseconds();
+    }
+
+    return ( ret < 0 ) ? -1 : 0;
+}
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    Collector_t collector;
+    DefenderConnectionTable_t connections, scratch;
+    struct sockaddr_nl groups = { .nl_family = AF_NETLINK };
+    uint32_t capacity = 65536U, slotCount = 2U, periodSeconds = 300U, periodCount = 0U, period;
+    uint32_t * pArrays = NULL;
+    DefenderFlow_t * pFlows = NULL;
+    uint32_t * pSlots = NULL;
+    uint8_t * pReceiveBuffer = NULL;
+    char * pReportBuffer = NULL;
+    uint32_t reportBufferLength;
+    int bufferSize = EVENT_SOCKET_BUFFER, printFlows = 0, option, ret = 0;
+    int64_t reportTime;
+
+    ( void ) memset( &( collector ), 0, sizeof( collector ) );
+    collector.eventSocket = -1;
+
+    while( ( option = getopt( argc, argv, "p:n:c:f" ) ) != -1 )
+    {
+        if( option == 'p' )
+        {
+            periodSeconds = ( uint32_t ) strtoul( optarg, NULL, 10 );
+        }
+        else if( option == 'n' )
+        {
+            periodCount = ( uint32_t ) strtoul( optarg, NULL, 10 );
+        }
+        else if( option == 'c' )
+        {
+            capacity = ( uint32_t ) strtoul( optarg, NULL, 10 );
+        }
+        else if( option == 'f' )
+        {
+            printFlows = 1;
+        }
+        else
+        {
+            ret = -1;
+        }
+    }
+
+    if( ( ret != 0 ) || ( optind != argc ) || ( periodSeconds == 0U ) ||
+        ( capacity == 0U ) || ( capacity > ( 1U << 24 ) ) )
+    {
+        fprintf( stderr, "Usage: %s [-p period-seconds] [-n periods] [-c capacity] [-f]\n", argv[ 0 ] );
+        ret = -1;
+    }
+
+    if( ret == 0 )
+    {
+        while( slotCount < ( capacity * 2U ) )
+        {
+            slotCount *= 2U;
+        }
+
+        /* A connection is at most 40 bytes in the report. */
+        reportBufferLength = ( capacity * 40U ) + 64U;
+        pFlows = malloc( ( size_t ) capacity * sizeof( DefenderFlow_t ) );
+        pSlots = malloc( ( size_t ) slotCount * sizeof( uint32_t ) );
+        pArrays = malloc( ( size_t ) capacity * 2U * ( sizeof( uint32_t ) + ( 2U * sizeof( uint16_t ) ) + 1U ) );
+        pReceiveBuffer = malloc( RECEIVE_BUFFER_LENGTH );
+        pReportBuffer = malloc( reportBufferLength );
+
+        if( ( pFlows == NULL ) || ( pSlots == NULL ) || ( pArrays == NULL ) ||
+            ( pReceiveBuffer == NULL ) || ( pReportBuffer == NULL ) )
+        {
+            fprintf( stderr, "Out of memory.\n" );
+            ret = -1;
+        }
+    }
+
+    if( ret == 0 )
+    {
+        uint32_t * pAddresses = pArrays;
+        uint16_t * pPorts = ( uint16_t * ) &( pAddresses[ capacity * 2U ] );
+        uint8_t * pInterfaceIds = ( uint8_t * ) &( pPorts[ capacity * 4U ] );
+
+        ( void ) Defender_FlowTableInit( &( collector.flows ), pFlows, capacity, pSlots, slotCount );
+        ( void ) Defender_ConnectionTableInit( &( connections ), pAddresses, pPorts, &( pPorts[ capacity ] ),
+                                               pInterfaceIds, capacity );
+        ( void ) Defender_ConnectionTableInit( &( scratch ), &( pAddresses[ capacity ] ), &( pPorts[ capacity * 2U ] ),
+                                               &( pPorts[ capacity * 3U ] ), &( pInterfaceIds[ capacity ] ), capacity );
+
+        /* Subscribe before the dump, so that changes during the dump are
+         * received as events. */
+        groups.nl_groups = NF_NETLINK_CONNTRACK_NEW | NF_NETLINK_CONNTRACK_UPDATE | NF_NETLINK_CONNTRACK_DESTROY;
+        collector.eventSocket = socket( AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_NETFILTER );
+
+        if( ( collector.eventSocket < 0 ) ||
+            ( bind( collector.eventSocket, ( const struct sockaddr * ) &( groups ), sizeof( groups ) ) != 0 ) )
+        {
+            fprintf( stderr, "Cannot subscribe to conntrack events: %s\n", strerror( errno ) );
+            ret = -1;
+        }
+        else if( setsockopt( collector.eventSocket, SOL_SOCKET, SO_RCVBUFFORCE, &( bufferSize ), sizeof( bufferSize ) ) != 0 )
+        {
+            ( void ) setsockopt( collector.eventSocket, SOL_SOCKET, SO_RCVBUF, &( bufferSize ), sizeof( bufferSize ) );
+        }
+        else
+        {
+            /* The larger buffer is set. */
+        }
+    }
+
+    if( ( ret == 0 ) && ( dumpFlows( &( collector ), pReceiveBuffer ) != 0 ) )
+    {
+        fprintf( stderr, "Cannot dump the conntrack table: %s\n", strerror( errno ) );
+        ret = -1;
+    }
+
+    reportTime = nowMilliseconds();
+
+    for( period = 0U; ( ret == 0 ) && ( ( periodCount == 0U ) || ( period < periodCount ) ); period++ )
+    {
+        ret = printReport( &( collector ), &( connections ), &( scratch ),
+                           pReportBuffer, reportBufferLength, printFlows );
+
+        if( ( ret == 0 ) && ( ( periodCount == 0U ) || ( ( period + 1U ) < periodCount ) ) )
+        {
+            reportTime += ( int64_t ) periodSeconds * 1000;
+            ret = followEvents( &( collector ), pReceiveBuffer, reportTime );
+
+            if( ret != 0 )
+            {
+                fprintf( stderr, "Cannot receive conntrack events: %s\n", strerror( errno ) );
+            }
+        }
+    }
+
+    if( collector.eventSocket >= 0 )
+    {
+        ( void ) close( collector.eventSocket );
+    }
+
+    free( pFlows );
+    free( pSlots );
+    free( pArrays );
+    free( pReceiveBuffer );
+    free( pReportBuffer );
+
+    return ( ret == 0 ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
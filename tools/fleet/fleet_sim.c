@@ -0,0 +1,774 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file fleet_sim.c
+ * @brief Simulates the things of a gateway to measure how many reports the
+ * gateway can send.
+ *
+ * Usage:
+ *   defender_fleet_sim [-n thing-count] [-t threads] [-i interval-ms]
+ *                      [-d seconds] [-p idle|server|busy|mixed] [-H]
+ *
+ * Every thread is a shard of the gateway which owns a part of the things. A
+ * shard keeps its things in a thing store, for the deadlines and the reports
+ * in flight, and their contexts in a slab, for the publish topic made with
+ * Defender_GetTopic and the counters of the simulated traffic. Both live in
+ * one mapping per shard, backed by huge pages with -H.
+ *
+ * A shard sends a report for every due thing: it makes up the metrics of the
+ * profile of the thing, serializes them with Defender_SerializeNetworkReport
+ * and publishes them to an in-process stand-in for the broker. The stand-in
+ * matches the topic, and queues an accepted response on the accepted topic of
+ * the thing. The shard then handles the responses as a gateway would: it
+ * matches the topic, finds the thing, parses the response and sets the next
+ * deadline of the thing.
+ *
+ * With an interval of 0, things are due again as soon as their response is
+ * handled, so the tool measures the most reports per second. With a longer
+ * interval, the deadlines of the things are spread over the first interval,
+ * and the lag of the reports behind their deadlines shows whether the gateway
+ * keeps up. At the end, the tool prints the reports per second, the CPU time
+ * per report, and the memory per thing.
+ */
+
+/* Standard includes. */
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* POSIX and Linux includes. */
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+/* Device Defender includes. */
+#include "defender.h"
+#include "defender_netstat.h"
+#include "defender_response.h"
+#include "defender_slab.h"
+#include "defender_thing_store.h"
+
+/**
+ * @brief Length of the simulated thing names, such as "sim-00000042".
+ */
+#define SIM_NAME_LENGTH         12U
+
+/**
+ * @brief Most ports and connections of a profile.
+ */
+#define SIM_MAX_PORTS           16U
+#define SIM_MAX_CONNECTIONS     128U
+
+/**
+ * @brief Length of the report buffer, enough for the busiest profile.
+ */
+#define SIM_REPORT_LENGTH       16384U
+
+/**
+ * @brief Number of responses the broker stand-in queues before the shard
+ * handles them.
+ */
+#define SIM_QUEUE_LENGTH        256U
+
+/**
+ * @brief Length of a response payload.
+ */
+#define SIM_RESPONSE_LENGTH     160U
+
+/**
+ * @brief Length of a huge page, to which huge page mappings are rounded.
+ */
+#define SIM_HUGE_PAGE_LENGTH    ( 2UL * 1024UL * 1024UL )
+
+/**
+ * @brief The metrics of a kind of thing.
+ */
+typedef struct SimProfile
+{
+    const char * pName;
+    uint32_t tcpPortCount;
+    uint32_t udpPortCount;
+    uint32_t connectionCount;
+    uint32_t bytesPerReport;
+} SimProfile_t;
+
+/**
+ * @brief The profiles. "mixed" picks idle, server and busy things at random.
+ */
+static const SimProfile_t profiles[] =
+{
+    { "idle",   1U,  0U,  1U,                  2000U    },
+    { "server", 4U,  2U,  16U,                 200000U  },
+    { "busy",   16U, 8U,  SIM_MAX_CONNECTIONS, 5000000U }
+};
+
+#define SIM_PROFILE_COUNT    ( sizeof( profiles ) / sizeof( profiles[ 0 ] ) )
+#define SIM_PROFILE_MIXED    SIM_PROFILE_COUNT
+
+/**
+ * @brief Context of a thing, allocated from the slab of its shard.
+ */
+typedef struct SimThing
+{
+    uint64_t bytesIn;
+    uint64_t bytesOut;
+    uint64_t packetsIn;
+    uint64_t packetsOut;
+    uint32_t seed;
+    uint16_t topicLength;
+    uint8_t profile;
+    char topic[];
+} SimThing_t;
+
+/**
+ * @brief A response queued by the broker stand-in.
+ */
+typedef struct SimMessage
+{
+    char topic[ DEFENDER_API_MAX_LENGTH( SIM_NAME_LENGTH ) ];
+    uint16_t topicLength;
+    char payload[ SIM_RESPONSE_LENGTH ];
+    uint32_t payloadLength;
+} SimMessage_t;
+
+/**
+ * @brief Settings shared by all shards.
+ */
+typedef struct SimConfig
+{
+    uint32_t thingCount;
+    uint32_t threadCount;
+    uint64_t intervalMs;
+    uint64_t durationMs;
+    uint32_t profile;
+    int hugePages;
+    pthread_barrier_t barrier;
+} SimConfig_t;
+
+/**
+ * @brief A shard of the gateway and its counters.
+ */
+typedef struct SimShard
+{
+    pthread_t thread;
+    const SimConfig_t * pConfig;
+    uint32_t index;
+    uint32_t firstThing;
+    uint32_t thingCount;
+    uint8_t * pMemory;
+    size_t memoryLength;
+    DefenderThingStore_t store;
+    DefenderSlab_t slab;
+    SimThing_t ** ppThings;
+    DefenderConnectionTable_t connections;
+    uint32_t remoteAddresses[ SIM_MAX_CONNECTIONS ];
+    uint16_t remotePorts[ SIM_MAX_CONNECTIONS ];
+    uint16_t localPorts[ SIM_MAX_CONNECTIONS ];
+    uint8_t interfaceIds[ SIM_MAX_CONNECTIONS ];
+    uint16_t tcpPorts[ SIM_MAX_PORTS ];
+    uint16_t udpPorts[ SIM_MAX_PORTS ];
+    char report[ SIM_REPORT_LENGTH ];
+    SimMessage_t queue[ SIM_QUEUE_LENGTH ];
+    uint32_t queueCount;
+    uint64_t nextReportId;
+    uint32_t randomState;
+    uint64_t published;
+    uint64_t accepted;
+    uint64_t failed;
+    uint64_t reportBytes;
+    uint64_t lagTotalMs;
+    uint64_t maxLagMs;
+    int ret;
+} SimShard_t;
+
+/*-----------------------------------------------------------*/
+
+static uint64_t nowMs( void )
+{
+    struct timespec now;
+
+    ( void ) clock_gettime( CLOCK_MONOTONIC, &( now ) );
+
+    return ( ( uint64_t ) now.tv_sec * 1000U ) + ( ( uint64_t ) now.tv_nsec / 1000000U );
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t nextRandom( uint32_t * pState )
+{
+    *pState ^= *pState << 13;
+    *pState ^= *pState >> 17;
+    *pState ^= *pState << 5;
+
+    return *pState;
+}
+/*-----------------------------------------------------------*/
+
+/* Map anonymous memory, from huge pages if asked and available. Transparent
+ * huge pages are asked for when no huge pages are reserved. */
+static uint8_t * mapMemory( size_t * pLength,
+                            int hugePages )
+{
+    void * pMemory = MAP_FAILED;
+
+    if( hugePages != 0 )
+    {
+        *pLength = ( *pLength + SIM_HUGE_PAGE_LENGTH - 1U ) & ~( SIM_HUGE_PAGE_LENGTH - 1U );
+        pMemory = mmap( NULL, *pLength, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+    }
+
+    if( pMemory == MAP_FAILED )
+    {
+        pMemory = mmap( NULL, *pLength, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+
+        if( ( pMemory != MAP_FAILED ) && ( hugePages != 0 ) )
+        {
+            ( void ) madvise( pMemory, *pLength, MADV_HUGEPAGE );
+        }
+    }
+
+    return ( pMemory == MAP_FAILED ) ? NULL : ( uint8_t * ) pMemory;
+}
+/*-----------------------------------------------------------*/
+
+/* Take the next block of a shard mapping, on a cache line, and return its
+ * offset. The mapping is made once all blocks are taken. */
+static size_t takeMemory( size_t * pOffset,
+                          size_t length )
+{
+    size_t offset = *pOffset;
+
+    *pOffset = ( offset + length + 63U ) & ~( size_t ) 63U;
+
+    return offset;
+}
+/*-----------------------------------------------------------*/
+
+/* Map the memory of a shard and add its things. */
+static int setupShard( SimShard_t * pShard )
+{
+    const SimConfig_t * pConfig = pShard->pConfig;
+    size_t offset = 0U, hotOffset, coldOffset, slotsOffset, thingsOffset, slabOffset;
+    uint32_t slotCount = 1U, objectLength, i, thingId = 0U;
+    char thingName[ SIM_NAME_LENGTH + 1U ];
+    SimThing_t * pThing;
+    void * pObject = NULL;
+    int ret = 0;
+
+    while( slotCount < ( 2U * pShard->thingCount ) )
+    {
+        slotCount *= 2U;
+    }
+
+    /* The topic is stored right after the context of the thing. */
+    objectLength = ( uint32_t ) sizeof( SimThing_t ) + DEFENDER_API_MAX_LENGTH( SIM_NAME_LENGTH );
+
+    hotOffset = takeMemory( &( offset ), pShard->thingCount * sizeof( DefenderThingHot_t ) );
+    coldOffset = takeMemory( &( offset ), pShard->thingCount * sizeof( DefenderThingCold_t ) );
+    slotsOffset = takeMemory( &( offset ), slotCount * sizeof( uint64_t ) );
+    thingsOffset = takeMemory( &( offset ), pShard->thingCount * sizeof( SimThing_t * ) );
+    slabOffset = takeMemory( &( offset ), ( size_t ) pShard->thingCount * ( ( objectLength + 63U ) & ~63U ) );
+
+    pShard->memoryLength = offset;
+    pShard->pMemory = mapMemory( &( pShard->memoryLength ), pConfig->hugePages );
+
+    if( ( pShard->pMemory == NULL ) || ( ( offset - slabOffset ) > UINT32_MAX ) )
+    {
+        fprintf( stderr, "Cannot map %zu bytes for shard %u. Use more threads.\n", offset, pShard->index );
+        ret = -1;
+    }
+    else
+    {
+        pShard->ppThings = ( SimThing_t ** ) &( pShard->pMemory[ thingsOffset ] );
+
+        if( ( Defender_ThingStoreInit( &( pShard->store ),
+                                       ( DefenderThingHot_t * ) &( pShard->pMemory[ hotOffset ] ),
+                                       ( DefenderThingCold_t * ) &( pShard->pMemory[ coldOffset ] ),
+                                       pShard->thingCount,
+                                       ( uint64_t * ) &( pShard->pMemory[ slotsOffset ] ),
+                                       slotCount ) != DefenderSuccess ) ||
+            ( Defender_SlabInit( &( pShard->slab ), &( pShard->pMemory[ slabOffset ] ),
+                                 ( uint32_t ) ( offset - slabOffset ), objectLength ) != DefenderSuccess ) ||
+            ( Defender_ConnectionTableInit( &( pShard->connections ), pShard->remoteAddresses, pShard->remotePorts,
+                                            pShard->localPorts, pShard->interfaceIds,
+                                            SIM_MAX_CONNECTIONS ) != DefenderSuccess ) )
+        {
+            fprintf( stderr, "Cannot set up shard %u.\n", pShard->index );
+            ret = -1;
+        }
+    }
+
+    for( i = 0U; ( ret == 0 ) && ( i < pShard->thingCount ); i++ )
+    {
+        ( void ) snprintf( thingName, sizeof( thingName ), "sim-%08u", ( unsigned int ) ( pShard->firstThing + i ) );
+
+        if( ( Defender_ThingStoreAdd( &( pShard->store ), thingName, SIM_NAME_LENGTH, &( thingId ) ) != DefenderSuccess ) ||
+            ( Defender_SlabAlloc( &( pShard->slab ), &( pObject ) ) != DefenderSuccess ) )
+        {
+            ret = -1;
+        }
+        else
+        {
+            pThing = ( SimThing_t * ) pObject;
+            ( void ) memset( pThing, 0, sizeof( SimThing_t ) );
+            pThing->seed = nextRandom( &( pShard->randomState ) );
+            pThing->profile = ( uint8_t ) pConfig->profile;
+
+            if( pConfig->profile == SIM_PROFILE_MIXED )
+            {
+                /* Mostly idle things, some servers and a few busy ones. */
+                pThing->profile = ( ( pThing->seed % 100U ) < 70U ) ? 0U : ( ( ( pThing->seed % 100U ) < 95U ) ? 1U : 2U );
+            }
+
+            ( void ) Defender_GetTopic( pThing->topic, DEFENDER_API_MAX_LENGTH( SIM_NAME_LENGTH ), thingName,
+                                        SIM_NAME_LENGTH, DefenderJsonReportPublish, &( pThing->topicLength ) );
+            pShard->ppThings[ thingId ] = pThing;
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+/* Find the report ID in a report, which the broker stand-in needs for the
+ * response. */
+static uint64_t findReportId( const char * pReport,
+                              uint32_t reportLength )
+{
+    static const char key[] = "\"" DEFENDER_REPORT_ID_KEY "\":";
+    uint64_t reportId = 0U;
+    uint32_t i = 0U;
+
+    while( ( ( i + sizeof( key ) - 1U ) < reportLength ) && ( memcmp( &( pReport[ i ] ), key, sizeof( key ) - 1U ) != 0 ) )
+    {
+        i++;
+    }
+
+    for( i += ( uint32_t ) sizeof( key ) - 1U; ( i < reportLength ) && ( pReport[ i ] >= '0' ) && ( pReport[ i ] <= '9' ); i++ )
+    {
+        reportId = ( reportId * 10U ) + ( uint64_t ) ( pReport[ i ] - '0' );
+    }
+
+    return reportId;
+}
+/*-----------------------------------------------------------*/
+
+/* Handle a response as a gateway would. */
+static void handleResponse( SimShard_t * pShard,
+                            const SimMessage_t * pMessage,
+                            uint64_t now )
+{
+    DefenderTopic_t api = DefenderInvalidTopic;
+    DefenderResponse_t response;
+    const char * pThingName = NULL;
+    uint16_t thingNameLength = 0U;
+    uint32_t thingId = 0U;
+
+    if( ( Defender_MatchTopic( pMessage->topic, pMessage->topicLength, &( api ), &( pThingName ),
+                               &( thingNameLength ) ) == DefenderSuccess ) &&
+        ( ( api == DefenderJsonReportAccepted ) || ( api == DefenderJsonReportRejected ) ) &&
+        ( Defender_ThingStoreFind( &( pShard->store ), pThingName, thingNameLength, &( thingId ) ) == DefenderSuccess ) &&
+        ( Defender_ParseResponse( pMessage->payload, pMessage->payloadLength, &( response ) ) == DefenderSuccess ) &&
+        ( Defender_ThingStoreEndReport( &( pShard->store ), thingId, response.reportId,
+                                        now + pShard->pConfig->intervalMs ) == DefenderSuccess ) )
+    {
+        if( response.status == DefenderReportAccepted )
+        {
+            pShard->accepted++;
+        }
+        else
+        {
+            pShard->failed++;
+        }
+    }
+    else
+    {
+        pShard->failed++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void handleResponses( SimShard_t * pShard )
+{
+    uint64_t now = nowMs();
+    uint32_t i;
+
+    for( i = 0U; i < pShard->queueCount; i++ )
+    {
+        handleResponse( pShard, &( pShard->queue[ i ] ), now );
+    }
+
+    pShard->queueCount = 0U;
+}
+/*-----------------------------------------------------------*/
+
+/* The broker stand-in: check the topic of a report, and queue the accepted
+ * response. */
+static void publishToBroker( SimShard_t * pShard,
+                             const char * pTopic,
+                             uint16_t topicLength,
+                             const char * pReport,
+                             uint32_t reportLength )
+{
+    DefenderTopic_t api = DefenderInvalidTopic;
+    const char * pThingName = NULL;
+    uint16_t thingNameLength = 0U;
+    SimMessage_t * pMessage;
+    int length;
+
+    if( pShard->queueCount == SIM_QUEUE_LENGTH )
+    {
+        handleResponses( pShard );
+    }
+
+    pMessage = &( pShard->queue[ pShard->queueCount ] );
+
+    if( ( Defender_MatchTopic( pTopic, topicLength, &( api ), &( pThingName ), &( thingNameLength ) ) != DefenderSuccess ) ||
+        ( api != DefenderJsonReportPublish ) ||
+        ( Defender_GetTopic( pMessage->topic, ( uint16_t ) sizeof( pMessage->topic ), pThingName, thingNameLength,
+                             DefenderJsonReportAccepted, &( pMessage->topicLength ) ) != DefenderSuccess ) )
+    {
+        pShard->failed++;
+    }
+    else
+    {
+        length = snprintf( pMessage->payload, sizeof( pMessage->payload ),
+                           "{\"thingName\":\"%.*s\",\"reportId\":%" PRIu64 ",\"status\":\"ACCEPTED\",\"timestamp\":%" PRIu64 "}",
+                           ( int ) thingNameLength, pThingName, findReportId( pReport, reportLength ), nowMs() );
+        pMessage->payloadLength = ( uint32_t ) length;
+        pShard->queueCount++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* Make up the metrics of a thing, and publish its report. */
+static void publishReport( SimShard_t * pShard,
+                           uint32_t thingId,
+                           uint64_t now )
+{
+    SimThing_t * pThing = pShard->ppThings[ thingId ];
+    const SimProfile_t * pProfile = &( profiles[ pThing->profile ] );
+    DefenderNetworkMetrics_t metrics;
+    uint64_t deadline = pShard->store.pHot[ thingId ].deadline, reportId, bytes;
+    uint32_t reportLength = 0U, i;
+
+    for( i = 0U; i < pProfile->tcpPortCount; i++ )
+    {
+        pShard->tcpPorts[ i ] = ( uint16_t ) ( 1024U + ( i * 64U ) + ( pThing->seed & 63U ) );
+    }
+
+    for( i = 0U; i < pProfile->udpPortCount; i++ )
+    {
+        pShard->udpPorts[ i ] = ( uint16_t ) ( 5000U + ( i * 64U ) + ( pThing->seed & 63U ) );
+    }
+
+    pShard->connections.count = 0U;
+
+    for( i = 0U; i < pProfile->connectionCount; i++ )
+    {
+        ( void ) Defender_ConnectionTableAdd( &( pShard->connections ),
+                                              0x0A000000U | ( nextRandom( &( pShard->randomState ) ) & 0xFFFFFFU ),
+                                              443U, ( uint16_t ) ( 40000U + i ), 0U );
+    }
+
+    bytes = ( pProfile->bytesPerReport / 2U ) + ( nextRandom( &( pShard->randomState ) ) % pProfile->bytesPerReport );
+    pThing->bytesIn += bytes;
+    pThing->bytesOut += bytes / 2U;
+    pThing->packetsIn += ( bytes / 1000U ) + 1U;
+    pThing->packetsOut += ( bytes / 2000U ) + 1U;
+
+    metrics.pConnections = &( pShard->connections );
+    metrics.pTcpPorts = pShard->tcpPorts;
+    metrics.tcpPortCount = pProfile->tcpPortCount;
+    metrics.pUdpPorts = pShard->udpPorts;
+    metrics.udpPortCount = pProfile->udpPortCount;
+    metrics.stats.bytesIn = pThing->bytesIn;
+    metrics.stats.bytesOut = pThing->bytesOut;
+    metrics.stats.packetsIn = pThing->packetsIn;
+    metrics.stats.packetsOut = pThing->packetsOut;
+
+    reportId = pShard->nextReportId;
+    pShard->nextReportId++;
+
+    if( Defender_SerializeNetworkReport( &( metrics ), reportId, pShard->report, SIM_REPORT_LENGTH,
+                                         &( reportLength ) ) != DefenderSuccess )
+    {
+        pShard->failed++;
+        pShard->store.pHot[ thingId ].deadline = now + pShard->pConfig->intervalMs;
+    }
+    else
+    {
+        ( void ) Defender_ThingStoreBeginReport( &( pShard->store ), thingId, reportId, 0U );
+        publishToBroker( pShard, pThing->topic, pThing->topicLength, pShard->report, reportLength );
+        pShard->published++;
+        pShard->reportBytes += reportLength;
+        pShard->lagTotalMs += now - deadline;
+        pShard->maxLagMs = ( ( now - deadline ) > pShard->maxLagMs ) ? ( now - deadline ) : pShard->maxLagMs;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void runShard( SimShard_t * pShard,
+                      uint64_t stopMs )
+{
+    uint32_t cursor = 0U, thingId = 0U;
+    uint64_t now = nowMs();
+    struct timespec pause = { 0, 1000000L };
+
+    while( now < stopMs )
+    {
+        if( Defender_ThingStoreNextDue( &( pShard->store ), now, cursor, &( thingId ) ) == DefenderSuccess )
+        {
+            publishReport( pShard, thingId, now );
+            cursor = thingId + 1U;
+        }
+        else if( cursor > 0U )
+        {
+            /* Look again from the first thing. */
+            cursor = 0U;
+            handleResponses( pShard );
+        }
+        else if( pShard->queueCount > 0U )
+        {
+            handleResponses( pShard );
+        }
+        else
+        {
+            /* No thing is due and no response is waiting. */
+            ( void ) nanosleep( &( pause ), NULL );
+        }
+
+        now = nowMs();
+    }
+
+    handleResponses( pShard );
+}
+/*-----------------------------------------------------------*/
+
+static void * shardWorker( void * pArgument )
+{
+    SimShard_t * pShard = ( SimShard_t * ) pArgument;
+    SimConfig_t * pConfig = ( SimConfig_t * ) pShard->pConfig;
+    uint64_t start;
+    uint32_t i;
+
+    /* Each shard maps and fills its own memory, so that it is local to the
+     * CPU which runs the shard. */
+    pShard->ret = setupShard( pShard );
+    ( void ) pthread_barrier_wait( &( pConfig->barrier ) );
+    ( void ) pthread_barrier_wait( &( pConfig->barrier ) );
+    start = nowMs();
+
+    for( i = 0U; ( pShard->ret == 0 ) && ( i < pShard->thingCount ); i++ )
+    {
+        /* Spread the first reports over the first interval. */
+        pShard->store.pHot[ i ].deadline = start +
+                                           ( ( pConfig->intervalMs > 0U ) ?
+                                             ( nextRandom( &( pShard->randomState ) ) % pConfig->intervalMs ) : 0U );
+    }
+
+    if( pShard->ret == 0 )
+    {
+        runShard( pShard, start + pConfig->durationMs );
+    }
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static double cpuSeconds( void )
+{
+    struct rusage usage;
+
+    ( void ) getrusage( RUSAGE_SELF, &( usage ) );
+
+    return ( double ) usage.ru_utime.tv_sec + ( ( double ) usage.ru_utime.tv_usec / 1e6 ) +
+           ( double ) usage.ru_stime.tv_sec + ( ( double ) usage.ru_stime.tv_usec / 1e6 );
+}
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    SimConfig_t config;
+    SimShard_t * pShards = NULL;
+    uint64_t published = 0U, accepted = 0U, failed = 0U, reportBytes = 0U, lagTotalMs = 0U, maxLagMs = 0U;
+    size_t memoryLength = 0U;
+    uint64_t setupStart, runStart, runMs;
+    double cpuStart, cpuUsed;
+    struct rusage usage;
+    uint32_t i;
+    int option, ret = 0;
+
+    ( void ) memset( &( config ), 0, sizeof( config ) );
+    config.thingCount = 100000U;
+    config.threadCount = ( uint32_t ) sysconf( _SC_NPROCESSORS_ONLN );
+    config.durationMs = 10000U;
+    config.profile = SIM_PROFILE_MIXED;
+
+    while( ( option = getopt( argc, argv, "n:t:i:d:p:H" ) ) != -1 )
+    {
+        if( option == 'n' )
+        {
+            config.thingCount = ( uint32_t ) strtoul( optarg, NULL, 10 );
+        }
+        else if( option == 't' )
+        {
+            config.threadCount = ( uint32_t ) strtoul( optarg, NULL, 10 );
+        }
+        else if( option == 'i' )
+        {
+            config.intervalMs = ( uint64_t ) strtoull( optarg, NULL, 10 );
+        }
+        else if( option == 'd' )
+        {
+            config.durationMs = ( uint64_t ) strtoull( optarg, NULL, 10 ) * 1000U;
+        }
+        else if( option == 'p' )
+        {
+            for( config.profile = 0U;
+                 ( config.profile < SIM_PROFILE_COUNT ) && ( strcmp( optarg, profiles[ config.profile ].pName ) != 0 );
+                 config.profile++ )
+            {
+            }
+
+            if( ( config.profile == SIM_PROFILE_COUNT ) && ( strcmp( optarg, "mixed" ) != 0 ) )
+            {
+                ret = -1;
+            }
+        }
+        else if( option == 'H' )
+        {
+            config.hugePages = 1;
+        }
+        else
+        {
+            ret = -1;
+        }
+    }
+
+    if( ( ret != 0 ) || ( optind != argc ) || ( config.thingCount == 0U ) || ( config.thingCount > 100000000U ) ||
+        ( config.threadCount == 0U ) || ( config.threadCount > 1024U ) || ( config.durationMs == 0U ) )
+    {
+        fprintf( stderr, "Usage: %s [-n thing-count] [-t threads] [-i interval-ms] [-d seconds] "
+                         "[-p idle|server|busy|mixed] [-H]\n", argv[ 0 ] );
+        ret = -1;
+    }
+
+    if( ret == 0 )
+    {
+        config.threadCount = ( config.threadCount < config.thingCount ) ? config.threadCount : config.thingCount;
+        pShards = calloc( config.threadCount, sizeof( SimShard_t ) );
+
+        if( ( pShards == NULL ) || ( pthread_barrier_init( &( config.barrier ), NULL, config.threadCount + 1U ) != 0 ) )
+        {
+            fprintf( stderr, "Out of memory.\n" );
+            ret = -1;
+        }
+    }
+
+    setupStart = nowMs();
+
+    /* Workers wait on the barrier, so a worker which cannot be created ends
+     * the tool. */
+    for( i = 0U; ( ret == 0 ) && ( i < config.threadCount ); i++ )
+    {
+        pShards[ i ].pConfig = &( config );
+        pShards[ i ].index = i;
+        pShards[ i ].firstThing = ( uint32_t ) ( ( ( uint64_t ) config.thingCount * i ) / config.threadCount );
+        pShards[ i ].thingCount = ( uint32_t ) ( ( ( uint64_t ) config.thingCount * ( i + 1U ) ) / config.threadCount ) -
+                                  pShards[ i ].firstThing;
+        pShards[ i ].nextReportId = 1U;
+        pShards[ i ].randomState = 2463534242U + i;
+
+        if( pthread_create( &( pShards[ i ].thread ), NULL, shardWorker, &( pShards[ i ] ) ) != 0 )
+        {
+            fprintf( stderr, "Cannot create thread: %s\n", strerror( errno ) );
+            exit( EXIT_FAILURE );
+        }
+    }
+
+    if( ret == 0 )
+    {
+        ( void ) pthread_barrier_wait( &( config.barrier ) );
+        printf( "Set up %u things in %u shards in %.3f s.\n", ( unsigned int ) config.thingCount,
+                ( unsigned int ) config.threadCount, ( double ) ( nowMs() - setupStart ) / 1e3 );
+
+        cpuStart = cpuSeconds();
+        runStart = nowMs();
+        ( void ) pthread_barrier_wait( &( config.barrier ) );
+
+        for( i = 0U; i < config.threadCount; i++ )
+        {
+            ( void ) pthread_join( pShards[ i ].thread, NULL );
+        }
+
+        runMs = nowMs() - runStart;
+        cpuUsed = cpuSeconds() - cpuStart;
+
+        for( i = 0U; i < config.threadCount; i++ )
+        {
+            ret = ( pShards[ i ].ret != 0 ) ? pShards[ i ].ret : ret;
+            published += pShards[ i ].published;
+            accepted += pShards[ i ].accepted;
+            failed += pShards[ i ].failed;
+            reportBytes += pShards[ i ].reportBytes;
+            lagTotalMs += pShards[ i ].lagTotalMs;
+            maxLagMs = ( pShards[ i ].maxLagMs > maxLagMs ) ? pShards[ i ].maxLagMs : maxLagMs;
+            memoryLength += pShards[ i ].memoryLength;
+        }
+    }
+
+    if( ret == 0 )
+    {
+        ( void ) getrusage( RUSAGE_SELF, &( usage ) );
+
+        printf( "Published %" PRIu64 " reports in %.3f s: %.0f reports/s, %" PRIu64 " accepted, %" PRIu64 " failed.\n",
+                published, ( double ) runMs / 1e3, ( double ) accepted * 1e3 / ( double ) runMs, accepted, failed );
+        printf( "CPU: %.2f us per report. Reports: %.0f bytes on average.\n",
+                ( accepted > 0U ) ? ( cpuUsed * 1e6 / ( double ) accepted ) : 0.0,
+                ( published > 0U ) ? ( ( double ) reportBytes / ( double ) published ) : 0.0 );
+        printf( "Memory: %.0f bytes of gateway state per thing, %.0f bytes of peak RSS per thing.\n",
+                ( double ) memoryLength / ( double ) config.thingCount,
+                ( double ) usage.ru_maxrss * 1024.0 / ( double ) config.thingCount );
+        printf( "Lag behind deadlines: %.1f ms on average, %" PRIu64 " ms at most.\n",
+                ( published > 0U ) ? ( ( double ) lagTotalMs / ( double ) published ) : 0.0, maxLagMs );
+    }
+
+    for( i = 0U; ( pShards != NULL ) && ( i < config.threadCount ); i++ )
+    {
+        if( pShards[ i ].pMemory != NULL )
+        {
+            ( void ) munmap( pShards[ i ].pMemory, pShards[ i ].memoryLength );
+        }
+    }
+
+    free( pShards );
+
+    return ( ret == 0 ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
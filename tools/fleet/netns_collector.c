@@ -0,0 +1,669 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file netns_collector.c
+ * @brief Collects a network report for every thing of a gateway which hosts
+ * each thing in its own network namespace.
+ *
+ * Usage:
+ *   defender_netns_collector [-t threads] [-r report-id] [-b buffer-length]
+ *                            [-c capacity] [-n rounds] thing=namespace ...
+ *
+ * The namespace of a thing is the path of a network namespace file, such as
+ * /run/netns/thing1 or /proc/1234/ns/net, a bare name which is looked up in
+ * /run/netns, or "-" for the namespace of the tool itself.
+ *
+ * A pool of worker threads first takes the things one at a time. A worker
+ * joins the namespace of the thing with setns, which only moves the calling
+ * thread, and opens /proc/thread-self/net/{tcp,tcp6,udp,udp6,dev}.
+ * /proc/self/net would show the namespace of the main thread instead. An open
+ * file stays bound to its namespace, so the files are opened once and every
+ * collection round only reads them again from offset 0.
+ *
+ * Every round reads the files again with pread. Every worker allocates its
+ * buffers once, so a round allocates nothing but the copy of each report.
+ *
+ * For every thing, in the order of the arguments, the tool prints the JSON
+ * publish topic returned by Defender_GetTopic and the report of the last
+ * round, each on its own line. The time of each round goes to stderr. Joining
+ * other namespaces needs CAP_SYS_ADMIN.
+ */
+
+/* Standard includes. */
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* POSIX and Linux includes. */
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+/* Device Defender includes. */
+#include "defender.h"
+#include "defender_netstat.h"
+#include "defender_sort.h"
+
+/**
+ * @brief Directory of named network namespaces, as used by "ip netns".
+ */
+#define NETNS_RUN_DIR     "/run/netns/"
+
+/**
+ * @brief Number of procfs files read for every thing.
+ */
+#define NET_FILE_COUNT    5U
+
+/**
+ * @brief Index of /proc/net/dev in the files of a thing. The files before it
+ * are TCP files, and then UDP files.
+ */
+#define NET_FILE_UDP      2U
+#define NET_FILE_DEV      4U
+
+/**
+ * @brief The procfs files read for every thing.
+ */
+static const char * const netFiles[ NET_FILE_COUNT ] = { "tcp", "tcp6", "udp", "udp6", "dev" };
+
+/**
+ * @brief A thing, its open procfs files and its report.
+ */
+typedef struct CollectorThing
+{
+    const char * pThingName;
+    const char * pNamespace;
+    int fds[ NET_FILE_COUNT ];
+    char topic[ DEFENDER_THINGNAME_MAX_LENGTH + 64U ];
+    uint16_t topicLength;
+    char * pReport;
+    uint32_t reportLength;
+    int failed;
+} CollectorThing_t;
+
+/**
+ * @brief State shared by all workers.
+ */
+typedef struct CollectorShared
+{
+    pthread_mutex_t mutex;
+    pthread_barrier_t barrier;
+    CollectorThing_t * pThings;
+    uint32_t thingCount;
+    uint32_t nextThing;
+    int hostNamespace;
+    uint64_t reportId;
+    uint32_t textLength;
+    uint32_t capacity;
+    uint32_t roundCount;
+} CollectorShared_t;
+
+/**
+ * @brief Buffers of one worker, reused for every thing and every round.
+ */
+typedef struct CollectorWorker
+{
+    pthread_t thread;
+    CollectorShared_t * pShared;
+    char * pText;
+    DefenderConnectionTable_t connections;
+    DefenderNetworkMetrics_t metrics;
+    uint16_t * pTcpPorts;
+    uint16_t * pUdpPorts;
+    DefenderConnectionTable_t scratch;
+    uint16_t * pScratchPorts;
+    char * pReport;
+    uint8_t * pMemory;
+} CollectorWorker_t;
+
+/*-----------------------------------------------------------*/
+
+/* Move the calling thread to the network namespace of a thing. */
+static int enterNamespace( const CollectorShared_t * pShared,
+                           const char * pNamespace )
+{
+    char path[ 256 ];
+    int fd, ret;
+
+    if( strcmp( pNamespace, "-" ) == 0 )
+    {
+        fd = dup( pShared->hostNamespace );
+    }
+    else
+    {
+        if( strchr( pNamespace, '/' ) != NULL )
+        {
+            ( void ) snprintf( path, sizeof( path ), "%s", pNamespace );
+        }
+        else
+        {
+            ( void ) snprintf( path, sizeof( path ), NETNS_RUN_DIR "%s", pNamespace );
+        }
+
+        fd = open( path, O_RDONLY | O_CLOEXEC );
+    }
+
+    ret = ( fd >= 0 ) ? setns( fd, CLONE_NEWNET ) : -1;
+
+    if( fd >= 0 )
+    {
+        ( void ) close( fd );
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+/* Get the topic of a thing and open its procfs files. A file which does not
+ * exist, such as tcp6 without IPv6, is left closed and reads as empty. */
+static int openThing( const CollectorShared_t * pShared,
+                      CollectorThing_t * pThing )
+{
+    char path[ 64 ];
+    uint32_t i;
+    int ret = 0;
+
+    if( Defender_GetTopic( pThing->topic, ( uint16_t ) sizeof( pThing->topic ),
+                           pThing->pThingName, ( uint16_t ) strnlen( pThing->pThingName, UINT16_MAX ),
+                           DefenderJsonReportPublish, &( pThing->topicLength ) ) != DefenderSuccess )
+    {
+        fprintf( stderr, "Invalid thing name.\n" );
+        ret = -1;
+    }
+    else if( enterNamespace( pShared, pThing->pNamespace ) != 0 )
+    {
+        fprintf( stderr, "Cannot enter namespace %s: %s\n", pThing->pNamespace, strerror( errno ) );
+        ret = -1;
+    }
+    else
+    {
+        for( i = 0U; ( ret == 0 ) && ( i < NET_FILE_COUNT ); i++ )
+        {
+            ( void ) snprintf( path, sizeof( path ), "/proc/thread-self/net/%s", netFiles[ i ] );
+            pThing->fds[ i ] = open( path, O_RDONLY | O_CLOEXEC );
+
+            if( ( pThing->fds[ i ] < 0 ) && ( errno != ENOENT ) )
+            {
+                fprintf( stderr, "Cannot open %s: %s\n", path, strerror( errno ) );
+                ret = -1;
+            }
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+/* Read a whole file of a thing into the buffer of a worker with pread, and
+ * return its length. */
+static uint32_t readFile( CollectorWorker_t * pWorker,
+                          CollectorThing_t * pThing,
+                          uint32_t file )
+{
+    const CollectorShared_t * pShared = pWorker->pShared;
+    int fd = pThing->fds[ file ];
+    uint32_t length = 0U;
+    ssize_t readLength = 1;
+
+    while( ( fd >= 0 ) && ( pThing->failed == 0 ) && ( readLength > 0 ) )
+    {
+        if( length == pShared->textLength )
+        {
+            fprintf( stderr, "%s does not fit in %u bytes. Use a larger -b.\n",
+                     netFiles[ file ], ( unsigned int ) pShared->textLength );
+            pThing->failed = 1;
+        }
+        else
+        {
+            readLength = pread( fd, &( pWorker->pText[ length ] ), pShared->textLength - length, length );
+
+            if( readLength < 0 )
+            {
+                pThing->failed = 1;
+            }
+            else
+            {
+                length += ( uint32_t ) readLength;
+            }
+        }
+    }
+
+    return length;
+}
+/*-----------------------------------------------------------*/
+
+/* Read and parse the files of a thing, and write its report. */
+static void collectThing( CollectorWorker_t * pWorker,
+                          CollectorThing_t * pThing )
+{
+    CollectorShared_t * pShared = pWorker->pShared;
+    uint32_t file, length, reportLength = 0U;
+    DefenderStatus_t status;
+    char * pReport;
+
+    pWorker->connections.count = 0U;
+    pWorker->metrics.tcpPortCount = 0U;
+    pWorker->metrics.udpPortCount = 0U;
+    ( void ) memset( &( pWorker->metrics.stats ), 0, sizeof( pWorker->metrics.stats ) );
+
+    for( file = 0U; ( pThing->failed == 0 ) && ( file < NET_FILE_COUNT ); file++ )
+    {
+        length = readFile( pWorker, pThing, file );
+
+        if( pThing->failed == 0 )
+        {
+            if( file < NET_FILE_UDP )
+            {
+                status = Defender_ParseTcpTable( pWorker->pText, length, &( pWorker->connections ), pWorker->pTcpPorts,
+                                                 pShared->capacity, &( pWorker->metrics.tcpPortCount ) );
+            }
+            else if( file < NET_FILE_DEV )
+            {
+                status = Defender_ParseUdpTable( pWorker->pText, length, pWorker->pUdpPorts, pShared->capacity,
+                                                 &( pWorker->metrics.udpPortCount ) );
+            }
+            else
+            {
+                status = Defender_ParseNetDev( pWorker->pText, length, &( pWorker->metrics.stats ) );
+            }
+
+            if( status != DefenderSuccess )
+            {
+                fprintf( stderr, "Cannot parse %s: %d. Use a larger -c if it is %d.\n",
+                         netFiles[ file ], ( int ) status, ( int ) DefenderBufferTooSmall );
+                pThing->failed = 1;
+            }
+        }
+    }
+
+    if( pThing->failed == 0 )
+    {
+        /* Sorted ports and connections make reports of the same state
+         * identical, and the serializer skips repeated ports. */
+        ( void ) Defender_SortPorts( pWorker->pTcpPorts, pWorker->pScratchPorts, pWorker->metrics.tcpPortCount );
+        ( void ) Defender_SortPorts( pWorker->pUdpPorts, pWorker->pScratchPorts, pWorker->metrics.udpPortCount );
+        ( void ) Defender_ConnectionTableSort( &( pWorker->connections ), &( pWorker->scratch ) );
+        ( void ) Defender_ConnectionTableDedup( &( pWorker->connections ) );
+
+        if( Defender_SerializeNetworkReport( &( pWorker->metrics ), pShared->reportId, pWorker->pReport,
+                                             pShared->textLength, &( reportLength ) ) != DefenderSuccess )
+        {
+            fprintf( stderr, "The report does not fit in %u bytes. Use a larger -b.\n",
+                     ( unsigned int ) pShared->textLength );
+            pThing->failed = 1;
+        }
+    }
+
+    if( pThing->failed == 0 )
+    {
+        pReport = realloc( pThing->pReport, reportLength );
+
+        if( pReport == NULL )
+        {
+            pThing->failed = 1;
+        }
+        else
+        {
+            ( void ) memcpy( pReport, pWorker->pReport, reportLength );
+            pThing->pReport = pReport;
+            pThing->reportLength = reportLength;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* Collect the things of one round, one thing at a time. */
+static void collectRound( CollectorWorker_t * pWorker )
+{
+    CollectorShared_t * pShared = pWorker->pShared;
+    uint32_t index;
+
+    do
+    {
+        ( void ) pthread_mutex_lock( &( pShared->mutex ) );
+        index = pShared->nextThing;
+
+        if( index < pShared->thingCount )
+        {
+            pShared->nextThing++;
+        }
+
+        ( void ) pthread_mutex_unlock( &( pShared->mutex ) );
+
+        if( index < pShared->thingCount )
+        {
+            collectThing( pWorker, &( pShared->pThings[ index ] ) );
+        }
+    } while( index < pShared->thingCount );
+}
+/*-----------------------------------------------------------*/
+
+static void * collectorWorker( void * pArgument )
+{
+    CollectorWorker_t * pWorker = ( CollectorWorker_t * ) pArgument;
+    CollectorShared_t * pShared = pWorker->pShared;
+    uint32_t index, round;
+    int done = 0;
+
+    /* Open the files of the things one at a time. */
+    while( done == 0 )
+    {
+        ( void ) pthread_mutex_lock( &( pShared->mutex ) );
+        index = pShared->nextThing;
+
+        if( index < pShared->thingCount )
+        {
+            pShared->nextThing++;
+        }
+
+        ( void ) pthread_mutex_unlock( &( pShared->mutex ) );
+
+        if( index < pShared->thingCount )
+        {
+            pShared->pThings[ index ].failed = openThing( pShared, &( pShared->pThings[ index ] ) );
+        }
+        else
+        {
+            done = 1;
+        }
+    }
+
+    ( void ) pthread_barrier_wait( &( pShared->barrier ) );
+
+    /* The main thread resets the next thing between the barriers. */
+    for( round = 0U; round < pShared->roundCount; round++ )
+    {
+        ( void ) pthread_barrier_wait( &( pShared->barrier ) );
+        collectRound( pWorker );
+        ( void ) pthread_barrier_wait( &( pShared->barrier ) );
+    }
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+
+/* Take the next aligned block of a worker allocation. */
+static void * takeMemory( uint8_t ** ppCursor,
+                          size_t length )
+{
+    void * pBlock = *ppCursor;
+
+    *ppCursor += ( length + 7U ) & ~( size_t ) 7U;
+
+    return pBlock;
+}
+/*-----------------------------------------------------------*/
+
+static int allocateWorker( CollectorWorker_t * pWorker,
+                           CollectorShared_t * pShared )
+{
+    size_t capacity = pShared->capacity, textLength = pShared->textLength, length;
+    uint8_t * pCursor;
+    int ret = 0;
+
+    /* The buffer of a file, a connection table and two port arrays for the
+     * metrics of a thing, then the sort scratch memory and the report. */
+    length = textLength + ( capacity * ( sizeof( uint32_t ) + ( 4U * sizeof( uint16_t ) ) + 1U ) ) +
+             textLength + ( capacity * ( sizeof( uint32_t ) + ( 3U * sizeof( uint16_t ) ) + 1U ) ) + 128U;
+
+    pWorker->pShared = pShared;
+    pWorker->pMemory = malloc( length );
+
+    if( pWorker->pMemory == NULL )
+    {
+        ret = -1;
+    }
+    else
+    {
+        pCursor = pWorker->pMemory;
+        pWorker->pText = takeMemory( &( pCursor ), textLength );
+        ( void ) Defender_ConnectionTableInit( &( pWorker->connections ),
+                                               takeMemory( &( pCursor ), capacity * sizeof( uint32_t ) ),
+                                               takeMemory( &( pCursor ), capacity * sizeof( uint16_t ) ),
+                                               takeMemory( &( pCursor ), capacity * sizeof( uint16_t ) ),
+                                               takeMemory( &( pCursor ), capacity ),
+                                               pShared->capacity );
+        pWorker->pTcpPorts = takeMemory( &( pCursor ), capacity * sizeof( uint16_t ) );
+        pWorker->pUdpPorts = takeMemory( &( pCursor ), capacity * sizeof( uint16_t ) );
+        pWorker->metrics.pConnections = &( pWorker->connections );
+        pWorker->metrics.pTcpPorts = pWorker->pTcpPorts;
+        pWorker->metrics.pUdpPorts = pWorker->pUdpPorts;
+
+        ( void ) Defender_ConnectionTableInit( &( pWorker->scratch ),
+                                               takeMemory( &( pCursor ), capacity * sizeof( uint32_t ) ),
+                                               takeMemory( &( pCursor ), capacity * sizeof( uint16_t ) ),
+                                               takeMemory( &( pCursor ), capacity * sizeof( uint16_t ) ),
+                                               takeMemory( &( pCursor ), capacity ),
+                                               pShared->capacity );
+        pWorker->pScratchPorts = takeMemory( &( pCursor ), capacity * sizeof( uint16_t ) );
+        pWorker->pReport = takeMemory( &( pCursor ), textLength );
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+static void freeWorker( CollectorWorker_t * pWorker )
+{
+    free( pWorker->pMemory );
+}
+/*-----------------------------------------------------------*/
+
+static double elapsedSeconds( const struct timespec * pStart )
+{
+    struct timespec now;
+
+    ( void ) clock_gettime( CLOCK_MONOTONIC, &( now ) );
+
+    return ( double ) ( now.tv_sec - pStart->tv_sec ) +
+           ( ( double ) ( now.tv_nsec - pStart->tv_nsec ) / 1e9 );
+}
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    CollectorShared_t shared;
+    CollectorWorker_t * pWorkers = NULL;
+    uint32_t threadCount = 4U, failures = 0U, i, file;
+    struct timespec start;
+    char * pSeparator;
+    int option, ret = 0;
+
+    ( void ) memset( &( shared ), 0, sizeof( shared ) );
+    shared.hostNamespace = -1;
+    shared.reportId = ( uint64_t ) time( NULL );
+    shared.textLength = 1024U * 1024U;
+    shared.capacity = 4096U;
+    shared.roundCount = 1U;
+
+    while( ( option = getopt( argc, argv, "t:r:b:c:n:" ) ) != -1 )
+    {
+        if( option == 't' )
+        {
+            threadCount = ( uint32_t ) strtoul( optarg, NULL, 10 );
+        }
+        else if( option == 'r' )
+        {
+            shared.reportId = ( uint64_t ) strtoull( optarg, NULL, 10 );
+        }
+        else if( option == 'b' )
+        {
+            shared.textLength = ( uint32_t ) strtoul( optarg, NULL, 10 );
+        }
+        else if( option == 'c' )
+        {
+            shared.capacity = ( uint32_t ) strtoul( optarg, NULL, 10 );
+        }
+        else if( option == 'n' )
+        {
+            shared.roundCount = ( uint32_t ) strtoul( optarg, NULL, 10 );
+        }
+        else
+        {
+            ret = -1;
+        }
+    }
+
+    shared.thingCount = ( uint32_t ) ( argc - optind );
+
+    if( ( ret != 0 ) || ( shared.thingCount == 0U ) || ( threadCount == 0U ) || ( threadCount > 1024U ) ||
+        ( shared.textLength < 1024U ) || ( shared.textLength > ( 64U * 1024U * 1024U ) ) ||
+        ( shared.capacity == 0U ) || ( shared.capacity > ( 1U << 20 ) ) ||
+        ( shared.roundCount == 0U ) )
+    {
+        fprintf( stderr, "Usage: %s [-t threads] [-r report-id] [-b buffer-length] [-c capacity] "
+                         "[-n rounds] thing=namespace ...\n", argv[ 0 ] );
+        ret = -1;
+    }
+
+    if( ret == 0 )
+    {
+        shared.pThings = calloc( shared.thingCount, sizeof( CollectorThing_t ) );
+        threadCount = ( threadCount < shared.thingCount ) ? threadCount : shared.thingCount;
+        pWorkers = calloc( threadCount, sizeof( CollectorWorker_t ) );
+        shared.hostNamespace = open( "/proc/thread-self/ns/net", O_RDONLY | O_CLOEXEC );
+
+        if( ( shared.pThings == NULL ) || ( pWorkers == NULL ) || ( shared.hostNamespace < 0 ) ||
+            ( pthread_mutex_init( &( shared.mutex ), NULL ) != 0 ) ||
+            ( pthread_barrier_init( &( shared.barrier ), NULL, threadCount + 1U ) != 0 ) )
+        {
+            fprintf( stderr, "Cannot set up the collector.\n" );
+            ret = -1;
+        }
+    }
+
+    for( i = 0U; ( ret == 0 ) && ( i < shared.thingCount ); i++ )
+    {
+        pSeparator = strchr( argv[ optind + ( int ) i ], '=' );
+
+        for( file = 0U; file < NET_FILE_COUNT; file++ )
+        {
+            shared.pThings[ i ].fds[ file ] = -1;
+        }
+
+        if( pSeparator == NULL )
+        {
+            fprintf( stderr, "Expected thing=namespace: %s\n", argv[ optind + ( int ) i ] );
+            ret = -1;
+        }
+        else
+        {
+            *pSeparator = '\0';
+            shared.pThings[ i ].pThingName = argv[ optind + ( int ) i ];
+            shared.pThings[ i ].pNamespace = &( pSeparator[ 1 ] );
+        }
+    }
+
+    for( i = 0U; ( ret == 0 ) && ( i < threadCount ); i++ )
+    {
+        ret = allocateWorker( &( pWorkers[ i ] ), &( shared ) );
+
+        if( ret != 0 )
+        {
+            fprintf( stderr, "Out of memory.\n" );
+        }
+    }
+
+    /* The workers move to other namespaces, so the main thread only
+     * coordinates the rounds. Workers wait on the barrier, so a worker which
+     * cannot be created ends the tool. */
+    for( i = 0U; ( ret == 0 ) && ( i < threadCount ); i++ )
+    {
+        ret = pthread_create( &( pWorkers[ i ].thread ), NULL, collectorWorker, &( pWorkers[ i ] ) );
+
+        if( ret != 0 )
+        {
+            fprintf( stderr, "Cannot create thread: %s\n", strerror( ret ) );
+            exit( EXIT_FAILURE );
+        }
+    }
+
+    if( ret == 0 )
+    {
+        ( void ) pthread_barrier_wait( &( shared.barrier ) );
+
+        for( i = 0U; i < shared.roundCount; i++ )
+        {
+            shared.nextThing = 0U;
+            ( void ) clock_gettime( CLOCK_MONOTONIC, &( start ) );
+            ( void ) pthread_barrier_wait( &( shared.barrier ) );
+            ( void ) pthread_barrier_wait( &( shared.barrier ) );
+            fprintf( stderr, "Round %u: %u things in %.3f ms.\n", ( unsigned int ) i,
+                     ( unsigned int ) shared.thingCount, elapsedSeconds( &( start ) ) * 1e3 );
+        }
+
+        for( i = 0U; i < threadCount; i++ )
+        {
+            ( void ) pthread_join( pWorkers[ i ].thread, NULL );
+        }
+    }
+
+    for( i = 0U; ( ret == 0 ) && ( i < shared.thingCount ); i++ )
+    {
+        if( shared.pThings[ i ].failed == 0 )
+        {
+            printf( "%.*s\n%.*s\n",
+                    ( int ) shared.pThings[ i ].topicLength, shared.pThings[ i ].topic,
+                    ( int ) shared.pThings[ i ].reportLength, shared.pThings[ i ].pReport );
+        }
+        else
+        {
+            fprintf( stderr, "No report for %s.\n", shared.pThings[ i ].pThingName );
+            failures++;
+        }
+    }
+
+    for( i = 0U; ( pWorkers != NULL ) && ( i < threadCount ); i++ )
+    {
+        freeWorker( &( pWorkers[ i ] ) );
+    }
+
+    for( i = 0U; ( shared.pThings != NULL ) && ( i < shared.thingCount ); i++ )
+    {
+        for( file = 0U; file < NET_FILE_COUNT; file++ )
+        {
+            if( shared.pThings[ i ].fds[ file ] >= 0 )
+            {
+                ( void ) close( shared.pThings[ i ].fds[ file ] );
+            }
+        }
+
+        free( shared.pThings[ i ].pReport );
+    }
+
+    if( shared.hostNamespace >= 0 )
+    {
+        ( void ) close( shared.hostNamespace );
+    }
+
+    free( pWorkers );
+    free( shared.pThings );
+
+    return ( ( ret == 0 ) && ( failures == 0U ) ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
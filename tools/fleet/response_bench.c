@@ -0,0 +1,268 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/**
+ * @file response_bench.c
+ * @brief Compares parsing responses byte by byte and with a structural index.
+ *
+ * Usage:
+ *   defender_response_bench [-n response-count] [-r rounds] [-m message-length]
+ *
+ * The tool builds response-count synthetic responses as a gateway would
+ * receive them: most are compact accepted responses, and every fourth one is
+ * an indented rejected response with an error message of message-length
+ * characters. It then times, as the best of rounds runs:
+ *
+ * - Defender_ParseResponse on every payload,
+ * - Defender_IndexStructurals on every payload, and
+ * - Defender_ParseResponses on all payloads at once,
+ *
+ * and checks that both parsers give the same responses.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* POSIX includes. */
+#include <unistd.h>
+
+/* Response API includes. */
+#include "defender_index.h"
+#include "defender_response.h"
+
+/**
+ * @brief Longest error message the tool generates.
+ */
+#define MAX_MESSAGE_LENGTH    4096U
+
+/*-----------------------------------------------------------*/
+
+static double elapsedSeconds( const struct timespec * pStart )
+{
+    struct timespec now;
+
+    ( void ) clock_gettime( CLOCK_MONOTONIC, &( now ) );
+
+    return ( double ) ( now.tv_sec - pStart->tv_sec ) +
+           ( ( double ) ( now.tv_nsec - pStart->tv_nsec ) / 1e9 );
+}
+/*-----------------------------------------------------------*/
+
+/* Write response i at pBuffer and return its length. */
+static uint32_t writeResponse( char * pBuffer,
+                               size_t bufferLength,
+                               uint32_t i,
+                               uint32_t messageLength )
+{
+    static char message[ MAX_MESSAGE_LENGTH + 1U ];
+    int length;
+    uint32_t j;
+
+    if( ( i % 4U ) != 3U )
+    {
+        length = snprintf( pBuffer, bufferLength,
+                           "{\"thingName\":\"thing-%010u\",\"reportId\":%u,"
+                           "\"status\":\"ACCEPTED\",\"timestamp\":%llu}",
+                           i, i, 1700000000000ULL + i );
+    }
+    else
+    {
+        for( j = 0; j < messageLength; j++ )
+        {
+            message[ j ] = ( char ) ( 'a' + ( ( i + j ) % 26U ) );
+        }
+
+        message[ messageLength ] = '\0';
+
+        length = snprintf( pBuffer, bufferLength,
+                           "{\n  \"thingName\": \"thing-%010u\",\n  \"reportId\": %u,\n"
+                           "  \"status\": \"REJECTED\",\n  \"statusDetails\": {\n"
+                           "    \"ErrorCode\": \"InvalidJson\",\n"
+                           "    \"ErrorMessage\": \"%s\"\n  },\n"
+                           "  \"timestamp\": %llu\n}",
+                           i, i, message, 1700000000000ULL + i );
+    }
+
+    return ( length > 0 ) ? ( uint32_t ) length : 0U;
+}
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    uint32_t responseCount = 100000, rounds = 5, messageLength = 200;
+    uint32_t i, round, parsedCount = 0, structuralCount, maxLength = 0;
+    size_t bufferLength = 0, used = 0;
+    char * pBuffer = NULL;
+    DefenderPayload_t * pPayloads = NULL;
+    DefenderResponse_t * pScalar = NULL, * pIndexed = NULL;
+    uint32_t * pIndex = NULL;
+    struct timespec start;
+    double seconds, scalarSeconds = 1e9, indexSeconds = 1e9, batchSeconds = 1e9;
+    int option, ret = 0;
+
+    while( ( option = getopt( argc, argv, "n:r:m:" ) ) != -1 )
+    {
+        if( option == 'n' )
+        {
+            responseCount = ( uint32_t ) strtoul( optarg, NULL, 10 );
+        }
+        else if( option == 'r' )
+        {
+            rounds = ( uint32_t ) strtoul( optarg, NULL, 10 );
+        }
+        else if( option == 'm' )
+        {
+            messageLength = ( uint32_t ) strtoul( optarg, NULL, 10 );
+        }
+        else
+        {
+            ret = -1;
+        }
+    }
+
+    if( ( ret != 0 ) || ( responseCount == 0U ) || ( responseCount > 10000000U ) ||
+        ( rounds == 0U ) || ( messageLength > MAX_MESSAGE_LENGTH ) )
+    {
+        fprintf( stderr, "Usage: %s [-n response-count] [-r rounds] [-m message-length 0-%u]\n",
+                 argv[ 0 ], MAX_MESSAGE_LENGTH );
+        ret = -1;
+    }
+
+    if( ret == 0 )
+    {
+        /* Every response fits in 256 bytes plus its error message. */
+        bufferLength = ( size_t ) responseCount * 256U +
+                       ( ( size_t ) ( responseCount / 4U ) + 1U ) * messageLength;
+        pBuffer = malloc( bufferLength );
+        pPayloads = malloc( ( size_t ) responseCount * sizeof( DefenderPayload_t ) );
+        pScalar = malloc( ( size_t ) responseCount * sizeof( DefenderResponse_t ) );
+        pIndexed = malloc( ( size_t ) responseCount * sizeof( DefenderResponse_t ) );
+        pIndex = malloc( ( 256U + MAX_MESSAGE_LENGTH ) * sizeof( uint32_t ) );
+
+        if( ( pBuffer == NULL ) || ( pPayloads == NULL ) || ( pScalar == NULL ) ||
+            ( pIndexed == NULL ) || ( pIndex == NULL ) )
+        {
+            fprintf( stderr, "Out of memory.\n" );
+            ret = -1;
+        }
+    }
+
+    if( ret == 0 )
+    {
+        for( i = 0; i < responseCount; i++ )
+        {
+            pPayloads[ i ].pPayload = &( pBuffer[ used ] );
+            pPayloads[ i ].payloadLength = writeResponse( &( pBuffer[ used ] ), bufferLength - used,
+                                                          i, messageLength );
+            used += pPayloads[ i ].payloadLength;
+
+            if( pPayloads[ i ].payloadLength > maxLength )
+            {
+                maxLength = pPayloads[ i ].payloadLength;
+            }
+        }
+
+        printf( "%u responses, %zu bytes, longest %u bytes.\n",
+                ( unsigned int ) responseCount, used, ( unsigned int ) maxLength );
+        printf( "DEFENDER_USE_SIMD: %d\n", DEFENDER_USE_SIMD );
+    }
+
+    for( round = 0; ( ret == 0 ) && ( round < rounds ); round++ )
+    {
+        ( void ) clock_gettime( CLOCK_MONOTONIC, &( start ) );
+
+        for( i = 0; i < responseCount; i++ )
+        {
+            if( Defender_ParseResponse( pPayloads[ i ].pPayload, pPayloads[ i ].payloadLength,
+                                        &( pScalar[ i ] ) ) != DefenderSuccess )
+            {
+                fprintf( stderr, "Response %u is not parsed.\n", ( unsigned int ) i );
+                ret = -1;
+                break;
+            }
+        }
+
+        seconds = elapsedSeconds( &( start ) );
+        scalarSeconds = ( seconds < scalarSeconds ) ? seconds : scalarSeconds;
+
+        ( void ) clock_gettime( CLOCK_MONOTONIC, &( start ) );
+
+        for( i = 0; ( ret == 0 ) && ( i < responseCount ); i++ )
+        {
+            if( Defender_IndexStructurals( pPayloads[ i ].pPayload, pPayloads[ i ].payloadLength,
+                                           pIndex, 256U + MAX_MESSAGE_LENGTH,
+                                           &( structuralCount ) ) != DefenderSuccess )
+            {
+                fprintf( stderr, "Response %u is not indexed.\n", ( unsigned int ) i );
+                ret = -1;
+            }
+        }
+
+        seconds = elapsedSeconds( &( start ) );
+        indexSeconds = ( seconds < indexSeconds ) ? seconds : indexSeconds;
+
+        ( void ) clock_gettime( CLOCK_MONOTONIC, &( start ) );
+
+        if( ret == 0 )
+        {
+            ( void ) Defender_ParseResponses( pPayloads, responseCount, pIndex, 256U + MAX_MESSAGE_LENGTH,
+                                              pIndexed, &( parsedCount ) );
+        }
+
+        seconds = elapsedSeconds( &( start ) );
+        batchSeconds = ( seconds < batchSeconds ) ? seconds : batchSeconds;
+
+        if( ( ret == 0 ) &&
+            ( ( parsedCount != responseCount ) ||
+              ( memcmp( pScalar, pIndexed, ( size_t ) responseCount * sizeof( DefenderResponse_t ) ) != 0 ) ) )
+        {
+            fprintf( stderr, "The parsers give different responses.\n" );
+            ret = -1;
+        }
+    }
+
+    if( ret == 0 )
+    {
+        printf( "stage                      seconds    MB/s       ns/response\n" );
+        printf( "%-26s %-10.4f %-10.1f %.1f\n", "Defender_ParseResponse", scalarSeconds,
+                ( double ) used / scalarSeconds / 1e6, scalarSeconds * 1e9 / responseCount );
+        printf( "%-26s %-10.4f %-10.1f %.1f\n", "Defender_IndexStructurals", indexSeconds,
+                ( double ) used / indexSeconds / 1e6, indexSeconds * 1e9 / responseCount );
+        printf( "%-26s %-10.4f %-10.1f %.1f\n", "Defender_ParseResponses", batchSeconds,
+                ( double ) used / batchSeconds / 1e6, batchSeconds * 1e9 / responseCount );
+    }
+
+    free( pBuffer );
+    free( pPayloads );
+    free( pScalar );
+    free( pIndexed );
+    free( pIndex );
+
+    return ( ret == 0 ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
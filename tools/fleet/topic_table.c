@@ -0,0 +1,404 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file topic_table.c
+ * @brief Command line tool to build and query precomputed topic tables.
+ *
+ * Usage:
+ *   defender_topic_table build <thing-names-file> <table-file>
+ *   defender_topic_table lookup <table-file> <thing-name>
+ *   defender_topic_table list <table-file>
+ *
+ * The thing names file has one thing name per line. The names are sorted and
+ * duplicates are removed before the table is built. The lookup and list
+ * commands map the table file read-only and use it in place, which is how an
+ * application is expected to load it.
+ */
+
+/* Standard includes. */
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* POSIX includes. */
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Topic table include. */
+#include "defender_topic_table.h"
+
+/**
+ * @brief A thing name read from the input file.
+ */
+typedef struct ThingName
+{
+    char * pName;
+    uint16_t length;
+} ThingName_t;
+
+/**
+ * @brief A read-only mapping of a topic table file.
+ */
+typedef struct MappedTable
+{
+    DefenderTopicTable_t table;
+    void * pMapping;
+    size_t mappingLength;
+} MappedTable_t;
+
+/*-----------------------------------------------------------*/
+
+static int compareThingNames( const void * pLeft,
+                              const void * pRight )
+{
+    const ThingName_t * pName1 = ( const ThingName_t * ) pLeft;
+    const ThingName_t * pName2 = ( const ThingName_t * ) pRight;
+    uint16_t commonLength = ( pName1->length < pName2->length ) ? pName1->length : pName2->length;
+    int ret = memcmp( pName1->pName, pName2->pName, commonLength );
+
+    if( ret == 0 )
+    {
+        ret = ( int ) pName1->length - ( int ) pName2->length;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+static int readThingNames( const char * pPath,
+                           ThingName_t ** ppOutNames,
+                           size_t * pOutCount )
+{
+    FILE * pFile = fopen( pPath, "r" );
+    ThingName_t * pNames = NULL, * pGrown;
+    size_t count = 0, capacity = 0, length;
+    char line[ DEFENDER_THINGNAME_MAX_LENGTH + 3 ];
+    int ret = 0;
+
+    if( pFile == NULL )
+    {
+        fprintf( stderr, "Cannot open %s: %s\n", pPath, strerror( errno ) );
+        ret = -1;
+    }
+
+    while( ( ret == 0 ) && ( fgets( line, sizeof( line ), pFile ) != NULL ) )
+    {
+        length = strcspn( line, "\r\n" );
+
+        if( ( length == strlen( line ) ) && ( feof( pFile ) == 0 ) )
+        {
+            fprintf( stderr, "Thing name longer than %u characters after \"%.16s\".\n",
+                     ( unsigned int ) DEFENDER_THINGNAME_MAX_LENGTH, line );
+            ret = -1;
+        }
+        else if( length > 0 )
+        {
+            if( count == capacity )
+            {
+                capacity = ( capacity == 0 ) ? 1024 : ( capacity * 2 );
+                pGrown = realloc( pNames, capacity * sizeof( ThingName_t ) );
+
+                if( pGrown == NULL )
+                {
+                    ret = -1;
+                }
+                else
+                {
+                    pNames = pGrown;
+                }
+            }
+
+            if( ret == 0 )
+            {
+                pNames[ count ].pName = strndup( line, length );
+                pNames[ count ].length = ( uint16_t ) length;
+                ret = ( pNames[ count ].pName == NULL ) ? -1 : 0;
+                count++;
+            }
+
+            if( ret != 0 )
+            {
+                fprintf( stderr, "Out of memory.\n" );
+            }
+        }
+    }
+
+    if( pFile != NULL )
+    {
+        fclose( pFile );
+    }
+
+    *ppOutNames = pNames;
+    *pOutCount = count;
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+static int buildTable( const char * pNamesPath,
+                       const char * pTablePath )
+{
+    ThingName_t * pNames = NULL;
+    const char ** ppNamePointers = NULL;
+    uint16_t * pNameLengths = NULL;
+    uint8_t * pTable = NULL;
+    size_t count = 0, unique = 0, i;
+    uint32_t tableLength = 0, writtenLength = 0;
+    DefenderStatus_t status;
+    FILE * pFile = NULL;
+    int ret = readThingNames( pNamesPath, &( pNames ), &( count ) );
+
+    if( ret == 0 )
+    {
+        qsort( pNames, count, sizeof( ThingName_t ), compareThingNames );
+
+        ppNamePointers = malloc( ( count + 1 ) * sizeof( const char * ) );
+        pNameLengths = malloc( ( count + 1 ) * sizeof( uint16_t ) );
+
+        for( i = 0; ( ppNamePointers != NULL ) && ( pNameLengths != NULL ) && ( i < count ); i++ )
+        {
+            if( ( unique == 0 ) || ( compareThingNames( &( pNames[ i - 1 ] ), &( pNames[ i ] ) ) != 0 ) )
+            {
+                ppNamePointers[ unique ] = pNames[ i ].pName;
+                pNameLengths[ unique ] = pNames[ i ].length;
+                unique++;
+            }
+        }
+
+        status = Defender_TopicTableGetSize( ppNamePointers, pNameLengths,
+                                             ( uint32_t ) unique, &( tableLength ) );
+
+        if( status == DefenderSuccess )
+        {
+            pTable = malloc( tableLength );
+            status = Defender_TopicTableBuild( pTable, tableLength,
+                                               ppNamePointers, pNameLengths,
+                                               ( uint32_t ) unique, &( writtenLength ) );
+        }
+
+        if( status != DefenderSuccess )
+        {
+            fprintf( stderr, "Failed to build the topic table: %d.\n", ( int ) status );
+            ret = -1;
+        }
+    }
+
+    if( ret == 0 )
+    {
+        pFile = fopen( pTablePath, "wb" );
+
+        if( ( pFile == NULL ) ||
+            ( fwrite( pTable, 1, writtenLength, pFile ) != writtenLength ) ||
+            ( fclose( pFile ) != 0 ) )
+        {
+            fprintf( stderr, "Cannot write %s: %s\n", pTablePath, strerror( errno ) );
+            ret = -1;
+        }
+        else
+        {
+            printf( "Wrote %zu things (%zu duplicates removed), %u bytes.\n",
+                    unique, count - unique, ( unsigned int ) writtenLength );
+        }
+    }
+
+    for( i = 0; i < count; i++ )
+    {
+        free( pNames[ i ].pName );
+    }
+
+    free( pNames );
+    free( ppNamePointers );
+    free( pNameLengths );
+    free( pTable );
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+static int mapTable( const char * pTablePath,
+                     MappedTable_t * pMapped )
+{
+    struct stat fileStat;
+    int fd = open( pTablePath, O_RDONLY );
+    int ret = 0;
+
+    pMapped->pMapping = MAP_FAILED;
+
+    if( ( fd < 0 ) || ( fstat( fd, &( fileStat ) ) != 0 ) )
+    {
+        fprintf( stderr, "Cannot open %s: %s\n", pTablePath, strerror( errno ) );
+        ret = -1;
+    }
+    else if( ( fileStat.st_size <= 0 ) || ( ( uint64_t ) fileStat.st_size > UINT32_MAX ) )
+    {
+        fprintf( stderr, "%s is not a topic table.\n", pTablePath );
+        ret = -1;
+    }
+    else
+    {
+        /* Shared read-only pages are backed by the page cache, so every
+         * process mapping the same file uses the same physical memory. */
+        pMapped->mappingLength = ( size_t ) fileStat.st_size;
+        pMapped->pMapping = mmap( NULL, pMapped->mappingLength, PROT_READ, MAP_SHARED, fd, 0 );
+
+        if( pMapped->pMapping == MAP_FAILED )
+        {
+            fprintf( stderr, "Cannot map %s: %s\n", pTablePath, strerror( errno ) );
+            ret = -1;
+        }
+        else if( Defender_TopicTableInit( &( pMapped->table ),
+                                          ( const uint8_t * ) pMapped->pMapping,
+                                          ( uint32_t ) pMapped->mappingLength ) != DefenderSuccess )
+        {
+            fprintf( stderr, "%s is not a valid topic table.\n", pTablePath );
+            ret = -1;
+        }
+    }
+
+    if( fd >= 0 )
+    {
+        ( void ) close( fd );
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+static void unmapTable( MappedTable_t * pMapped )
+{
+    if( pMapped->pMapping != MAP_FAILED )
+    {
+        ( void ) munmap( pMapped->pMapping, pMapped->mappingLength );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static int printTopics( const DefenderTopicTable_t * pTable,
+                        uint32_t index )
+{
+    const char * pTopic;
+    uint16_t topicLength;
+    int ret = 0, api;
+
+    for( api = 0; ( ret == 0 ) && ( api < ( int ) DefenderMaxTopic ); api++ )
+    {
+        if( Defender_TopicTableGetTopic( pTable, index, ( DefenderTopic_t ) api,
+                                         &( pTopic ), &( topicLength ) ) == DefenderSuccess )
+        {
+            printf( "%.*s\n", ( int ) topicLength, pTopic );
+        }
+        else
+        {
+            fprintf( stderr, "Corrupt entry %u.\n", ( unsigned int ) index );
+            ret = -1;
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+static int lookupThing( const char * pTablePath,
+                        const char * pThingName )
+{
+    MappedTable_t mapped;
+    uint32_t index = 0;
+    size_t length = strlen( pThingName );
+    DefenderStatus_t status;
+    int ret = mapTable( pTablePath, &( mapped ) );
+
+    if( ret == 0 )
+    {
+        status = Defender_TopicTableFind( &( mapped.table ), pThingName,
+                                          ( length > UINT16_MAX ) ? 0U : ( uint16_t ) length,
+                                          &( index ) );
+
+        if( status == DefenderSuccess )
+        {
+            ret = printTopics( &( mapped.table ), index );
+        }
+        else
+        {
+            fprintf( stderr, "%s is not in the table.\n", pThingName );
+            ret = -1;
+        }
+    }
+
+    unmapTable( &( mapped ) );
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+static int listThings( const char * pTablePath )
+{
+    MappedTable_t mapped;
+    uint32_t i;
+    int ret = mapTable( pTablePath, &( mapped ) );
+
+    for( i = 0; ( ret == 0 ) && ( i < mapped.table.thingCount ); i++ )
+    {
+        ret = printTopics( &( mapped.table ), i );
+    }
+
+    unmapTable( &( mapped ) );
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    int ret = -1;
+
+    if( ( argc == 4 ) && ( strcmp( argv[ 1 ], "build" ) == 0 ) )
+    {
+        ret = buildTable( argv[ 2 ], argv[ 3 ] );
+    }
+    else if( ( argc == 4 ) && ( strcmp( argv[ 1 ], "lookup" ) == 0 ) )
+    {
+        ret = lookupThing( argv[ 2 ], argv[ 3 ] );
+    }
+    else if( ( argc == 3 ) && ( strcmp( argv[ 1 ], "list" ) == 0 ) )
+    {
+        ret = listThings( argv[ 2 ] );
+    }
+    else
+    {
+        fprintf( stderr,
+                 "Usage:\n"
+                 "  %s build <thing-names-file> <table-file>\n"
+                 "  %s lookup <table-file> <thing-name>\n"
+                 "  %s list <table-file>\n",
+                 argv[ 0 ], argv[ 0 ], argv[ 0 ] );
+    }
+
+    return ( ret == 0 ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+/*-----------------------------------------------------------*/
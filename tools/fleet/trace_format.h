@@ -0,0 +1,196 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file trace_format.h
+ * @brief Binary trace of the MQTT messages of a gateway, for replaying them
+ * with defender_trace_replay.
+ *
+ * A trace is the 8 bytes "DDTRACE1" followed by one record per message. A
+ * record is a header of 14 bytes followed by the topic and the payload:
+ *
+ * | Offset | Length | Field                                            |
+ * |--------|--------|--------------------------------------------------|
+ * | 0      | 8      | Timestamp in microseconds, from any fixed origin |
+ * | 8      | 2      | Topic length                                     |
+ * | 10     | 4      | Payload length                                   |
+ * | 14     | ...    | Topic, then payload                              |
+ *
+ * Integers are little endian, and records are not padded. Records are in the
+ * order in which the messages were published or received, and the timestamps
+ * do not decrease.
+ *
+ * An integration captures a trace by opening a file, writing the magic with
+ * traceWriteMagic, and calling traceWriteRecord for every report it publishes
+ * and every message it receives. This header only needs standard C.
+ */
+
+#ifndef TRACE_FORMAT_H_
+#define TRACE_FORMAT_H_
+
+/* Standard includes. */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief The first bytes of a trace.
+ */
+#define TRACE_MAGIC                    "DDTRACE1"
+#define TRACE_MAGIC_LENGTH             8U
+
+/**
+ * @brief Length of the header of a record.
+ */
+#define TRACE_RECORD_HEADER_LENGTH     14U
+
+/**
+ * @brief A record of a trace. The topic and the payload point into the trace.
+ */
+typedef struct TraceRecord
+{
+    uint64_t timestampUs;
+    const char * pTopic;
+    uint16_t topicLength;
+    const char * pPayload;
+    uint32_t payloadLength;
+} TraceRecord_t;
+
+/*-----------------------------------------------------------*/
+
+static inline void traceStoreLittleEndian( uint8_t * pBytes,
+                                           uint64_t value,
+                                           size_t length )
+{
+    size_t i;
+
+    for( i = 0U; i < length; i++ )
+    {
+        pBytes[ i ] = ( uint8_t ) ( value >> ( 8U * i ) );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static inline uint64_t traceLoadLittleEndian( const uint8_t * pBytes,
+                                              size_t length )
+{
+    uint64_t value = 0U;
+    size_t i;
+
+    for( i = length; i > 0U; i-- )
+    {
+        value = ( value << 8 ) | pBytes[ i - 1U ];
+    }
+
+    return value;
+}
+/*-----------------------------------------------------------*/
+
+/* Write the magic at the start of a trace. Return 0 on success. */
+static inline int traceWriteMagic( FILE * pFile )
+{
+    return ( fwrite( TRACE_MAGIC, 1U, TRACE_MAGIC_LENGTH, pFile ) == TRACE_MAGIC_LENGTH ) ? 0 : -1;
+}
+/*-----------------------------------------------------------*/
+
+/* Write a record at the end of a trace. Return 0 on success. */
+static inline int traceWriteRecord( FILE * pFile,
+                                    uint64_t timestampUs,
+                                    const char * pTopic,
+                                    uint16_t topicLength,
+                                    const void * pPayload,
+                                    uint32_t payloadLength )
+{
+    uint8_t header[ TRACE_RECORD_HEADER_LENGTH ];
+    int ret = 0;
+
+    traceStoreLittleEndian( &( header[ 0 ] ), timestampUs, 8U );
+    traceStoreLittleEndian( &( header[ 8 ] ), topicLength, 2U );
+    traceStoreLittleEndian( &( header[ 10 ] ), payloadLength, 4U );
+
+    if( ( fwrite( header, 1U, sizeof( header ), pFile ) != sizeof( header ) ) ||
+        ( fwrite( pTopic, 1U, topicLength, pFile ) != topicLength ) ||
+        ( fwrite( pPayload, 1U, payloadLength, pFile ) != payloadLength ) )
+    {
+        ret = -1;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+/* Check the magic of a trace in memory. Return the offset of the first record,
+ * or 0 if the magic is wrong. */
+static inline size_t traceCheckMagic( const uint8_t * pTrace,
+                                      size_t traceLength )
+{
+    return ( ( traceLength >= TRACE_MAGIC_LENGTH ) &&
+             ( memcmp( pTrace, TRACE_MAGIC, TRACE_MAGIC_LENGTH ) == 0 ) ) ? TRACE_MAGIC_LENGTH : 0U;
+}
+/*-----------------------------------------------------------*/
+
+/* Read the record at *pOffset of a trace in memory, and move *pOffset to the
+ * next record. Return 1 if a record is read, 0 at the end of the trace, and -1
+ * if the record is cut short. */
+static inline int traceReadRecord( const uint8_t * pTrace,
+                                   size_t traceLength,
+                                   size_t * pOffset,
+                                   TraceRecord_t * pRecord )
+{
+    size_t offset = *pOffset;
+    int ret = 1;
+
+    if( offset == traceLength )
+    {
+        ret = 0;
+    }
+    else if( ( traceLength - offset ) < TRACE_RECORD_HEADER_LENGTH )
+    {
+        ret = -1;
+    }
+    else
+    {
+        pRecord->timestampUs = traceLoadLittleEndian( &( pTrace[ offset ] ), 8U );
+        pRecord->topicLength = ( uint16_t ) traceLoadLittleEndian( &( pTrace[ offset + 8U ] ), 2U );
+        pRecord->payloadLength = ( uint32_t ) traceLoadLittleEndian( &( pTrace[ offset + 10U ] ), 4U );
+        offset += TRACE_RECORD_HEADER_LENGTH;
+
+        if( ( traceLength - offset ) < ( ( size_t ) pRecord->topicLength + pRecord->payloadLength ) )
+        {
+            ret = -1;
+        }
+        else
+        {
+            pRecord->pTopic = ( const char * ) &( pTrace[ offset ] );
+            pRecord->pPayload = ( const char * ) &( pTrace[ offset + pRecord->topicLength ] );
+            *pOffset = offset + pRecord->topicLength + pRecord->payloadLength;
+        }
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* TRACE_FORMAT_H_ */
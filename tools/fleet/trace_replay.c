@@ -0,0 +1,603 @@
+/*
+ * AWS IoT Device Defender Client v1.4.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file trace_replay.c
+ * @brief Replays a trace of the MQTT messages of a gateway through the
+ * topic matcher, the response parser and the correlation of responses with
+ * reports.
+ *
+ * Usage:
+ *   defender_trace_replay [-n loops] [-r] [-s speed] [-c thing-capacity] trace
+ *   defender_trace_replay -g record-count trace
+ *
+ * The trace has the format of trace_format.h. For every record, the tool:
+ *
+ * - matches the topic with Defender_MatchTopic,
+ * - for a report, adds the thing to a thing store and starts its report with
+ *   the report ID of the payload, and
+ * - for a response, parses it with Defender_ParseResponse, finds the thing and
+ *   ends its report.
+ *
+ * By default, the records are replayed as fast as possible. With -r, they are
+ * replayed at the times they were recorded, or -s times faster. The trace is
+ * replayed loops times, each time with an empty thing store, so every loop
+ * does the same work. The tool prints the records per second, the histogram
+ * of the time spent on each record, and the histogram of the round trips of
+ * the reports in the trace, which are the times between the reports and their
+ * responses as recorded.
+ *
+ * With -g, the tool writes a synthetic trace instead, with a few thousand
+ * things, a rejected response every 50 reports and a shadow message every 10
+ * records. Use it to try the tool, but capture real traces to study the
+ * performance of a gateway.
+ */
+
+/* Standard includes. */
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* POSIX includes. */
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Device Defender includes. */
+#include "defender.h"
+#include "defender_netstat.h"
+#include "defender_response.h"
+#include "defender_thing_store.h"
+
+/* Trace format include. */
+#include "trace_format.h"
+
+/**
+ * @brief Number of sub-buckets of each power of two in the histograms.
+ */
+#define HISTOGRAM_SUB_BITS       3U
+#define HISTOGRAM_SUB_COUNT      ( 1U << HISTOGRAM_SUB_BITS )
+#define HISTOGRAM_BUCKETS        ( 64U * HISTOGRAM_SUB_COUNT )
+
+/**
+ * @brief Number of things in a synthetic trace.
+ */
+#define GENERATED_THINGS         4096U
+
+/**
+ * @brief Number of reports published together in a synthetic trace before
+ * their responses.
+ */
+#define GENERATED_BATCH          64U
+
+/**
+ * @brief Length of the buffers of a synthetic trace.
+ */
+#define GENERATED_LENGTH         1024U
+
+/**
+ * @brief A histogram of durations, with buckets of about 12% of their values.
+ */
+typedef struct Histogram
+{
+    uint64_t counts[ HISTOGRAM_BUCKETS ];
+    uint64_t total;
+    uint64_t sum;
+    uint64_t max;
+} Histogram_t;
+
+/**
+ * @brief State of a replay.
+ */
+typedef struct Replay
+{
+    DefenderThingStore_t store;
+    DefenderThingHot_t * pHot;
+    DefenderThingCold_t * pCold;
+    uint64_t * pSlots;
+    uint64_t * pPublishedUs;
+    uint32_t capacity;
+    uint32_t slotCount;
+    uint64_t reports;
+    uint64_t accepted;
+    uint64_t rejected;
+    uint64_t uncorrelated;
+    uint64_t unparsed;
+    uint64_t otherDefender;
+    uint64_t otherTopics;
+    uint64_t untracked;
+    Histogram_t roundTrips;
+} Replay_t;
+
+/*-----------------------------------------------------------*/
+
+static uint64_t nowNs( void )
+{
+    struct timespec now;
+
+    ( void ) clock_gettime( CLOCK_MONOTONIC, &( now ) );
+
+    return ( ( uint64_t ) now.tv_sec * 1000000000U ) + ( uint64_t ) now.tv_nsec;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t nextRandom( uint32_t * pState )
+{
+    *pState ^= *pState << 13;
+    *pState ^= *pState >> 17;
+    *pState ^= *pState << 5;
+
+    return *pState;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t histogramBucket( uint64_t value )
+{
+    uint32_t bucket = ( uint32_t ) value, msb = 0U;
+
+    if( value >= HISTOGRAM_SUB_COUNT )
+    {
+        while( ( value >> msb ) > 1U )
+        {
+            msb++;
+        }
+
+        bucket = ( ( msb - HISTOGRAM_SUB_BITS + 1U ) << HISTOGRAM_SUB_BITS ) +
+                 ( uint32_t ) ( ( value >> ( msb - HISTOGRAM_SUB_BITS ) ) & ( HISTOGRAM_SUB_COUNT - 1U ) );
+    }
+
+    return bucket;
+}
+/*-----------------------------------------------------------*/
+
+/* The smallest value of a bucket. */
+static uint64_t histogramValue( uint32_t bucket )
+{
+    uint64_t value = bucket;
+
+    if( bucket >= HISTOGRAM_SUB_COUNT )
+    {
+        value = ( uint64_t ) ( HISTOGRAM_SUB_COUNT + ( bucket & ( HISTOGRAM_SUB_COUNT - 1U ) ) ) <<
+                ( ( bucket >> HISTOGRAM_SUB_BITS ) - 1U );
+    }
+
+    return value;
+}
+/*-----------------------------------------------------------*/
+
+static void histogramAdd( Histogram_t * pHistogram,
+                          uint64_t value )
+{
+    pHistogram->counts[ histogramBucket( value ) ]++;
+    pHistogram->total++;
+    pHistogram->sum += value;
+    pHistogram->max = ( value > pHistogram->max ) ? value : pHistogram->max;
+}
+/*-----------------------------------------------------------*/
+
+static uint64_t histogramPercentile( const Histogram_t * pHistogram,
+                                     double percentile )
+{
+    uint64_t rank = ( uint64_t ) ( ( double ) pHistogram->total * percentile / 100.0 ), seen = 0U;
+    uint32_t bucket = 0U;
+
+    while( ( bucket < ( HISTOGRAM_BUCKETS - 1U ) ) && ( ( seen + pHistogram->counts[ bucket ] ) <= rank ) )
+    {
+        seen += pHistogram->counts[ bucket ];
+        bucket++;
+    }
+
+    return histogramValue( bucket );
+}
+/*-----------------------------------------------------------*/
+
+static void histogramPrint( const char * pName,
+                            const char * pUnit,
+                            const Histogram_t * pHistogram )
+{
+    if( pHistogram->total > 0U )
+    {
+        printf( "%s (%s): mean %.1f, p50 %" PRIu64 ", p90 %" PRIu64 ", p99 %" PRIu64 ", p99.9 %" PRIu64 ", max %" PRIu64 "\n",
+                pName, pUnit, ( double ) pHistogram->sum / ( double ) pHistogram->total,
+                histogramPercentile( pHistogram, 50.0 ), histogramPercentile( pHistogram, 90.0 ),
+                histogramPercentile( pHistogram, 99.0 ), histogramPercentile( pHistogram, 99.9 ), pHistogram->max );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* Find the report ID in a report. */
+static uint64_t findReportId( const char * pReport,
+                              uint32_t reportLength )
+{
+    static const char key[] = "\"" DEFENDER_REPORT_ID_KEY "\":";
+    uint64_t reportId = 0U;
+    uint32_t i = 0U;
+
+    while( ( ( i + sizeof( key ) - 1U ) < reportLength ) && ( memcmp( &( pReport[ i ] ), key, sizeof( key ) - 1U ) != 0 ) )
+    {
+        i++;
+    }
+
+    for( i += ( uint32_t ) sizeof( key ) - 1U; ( i < reportLength ) && ( pReport[ i ] >= '0' ) && ( pReport[ i ] <= '9' ); i++ )
+    {
+        reportId = ( reportId * 10U ) + ( uint64_t ) ( pReport[ i ] - '0' );
+    }
+
+    return reportId;
+}
+/*-----------------------------------------------------------*/
+
+static void replayReport( Replay_t * pReplay,
+                          const TraceRecord_t * pRecord,
+                          const char * pThingName,
+                          uint16_t thingNameLength )
+{
+    uint32_t thingId = 0U;
+
+    pReplay->reports++;
+
+    if( Defender_ThingStoreAdd( &( pReplay->store ), pThingName, thingNameLength, &( thingId ) ) == DefenderSuccess )
+    {
+        ( void ) Defender_ThingStoreBeginReport( &( pReplay->store ), thingId,
+                                                 findReportId( pRecord->pPayload, pRecord->payloadLength ), 0U );
+        pReplay->pPublishedUs[ thingId ] = pRecord->timestampUs;
+    }
+    else
+    {
+        pReplay->untracked++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void replayResponse( Replay_t * pReplay,
+                            const TraceRecord_t * pRecord )
+{
+    DefenderResponse_t response;
+    uint32_t thingId = 0U;
+
+    if( Defender_ParseResponse( pRecord->pPayload, pRecord->payloadLength, &( response ) ) != DefenderSuccess )
+    {
+        pReplay->unparsed++;
+    }
+    else if( ( response.pThingName == NULL ) ||
+             ( Defender_ThingStoreFind( &( pReplay->store ), response.pThingName, response.thingNameLength,
+                                        &( thingId ) ) != DefenderSuccess ) ||
+             ( Defender_ThingStoreEndReport( &( pReplay->store ), thingId, response.reportId, 0U ) != DefenderSuccess ) )
+    {
+        pReplay->uncorrelated++;
+    }
+    else
+    {
+        if( response.status == DefenderReportAccepted )
+        {
+            pReplay->accepted++;
+        }
+        else
+        {
+            pReplay->rejected++;
+        }
+
+        histogramAdd( &( pReplay->roundTrips ), pRecord->timestampUs - pReplay->pPublishedUs[ thingId ] );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void replayRecord( Replay_t * pReplay,
+                          const TraceRecord_t * pRecord )
+{
+    DefenderTopic_t api = DefenderInvalidTopic;
+    const char * pThingName = NULL;
+    uint16_t thingNameLength = 0U;
+
+    if( Defender_MatchTopic( pRecord->pTopic, pRecord->topicLength, &( api ), &( pThingName ),
+                             &( thingNameLength ) ) != DefenderSuccess )
+    {
+        pReplay->otherTopics++;
+    }
+    else if( api == DefenderJsonReportPublish )
+    {
+        replayReport( pReplay, pRecord, pThingName, thingNameLength );
+    }
+    else if( ( api == DefenderJsonReportAccepted ) || ( api == DefenderJsonReportRejected ) )
+    {
+        replayResponse( pReplay, pRecord );
+    }
+    else
+    {
+        /* CBOR reports and responses are matched only. */
+        pReplay->otherDefender++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* Replay a trace once. In real time, records are replayed when they are due,
+ * and the time spent on a record is measured from then. */
+static int replayTrace( Replay_t * pReplay,
+                        const uint8_t * pTrace,
+                        size_t traceLength,
+                        double speed,
+                        Histogram_t * pLatencies,
+                        uint64_t * pRecordCount )
+{
+    TraceRecord_t record;
+    uint64_t firstUs = UINT64_MAX, startNs = nowNs(), dueNs, beforeNs;
+    size_t offset = traceCheckMagic( pTrace, traceLength );
+    struct timespec pause;
+    int ret = 1;
+
+    while( ( ret = traceReadRecord( pTrace, traceLength, &( offset ), &( record ) ) ) == 1 )
+    {
+        if( speed > 0.0 )
+        {
+            firstUs = ( firstUs == UINT64_MAX ) ? record.timestampUs : firstUs;
+            dueNs = startNs + ( uint64_t ) ( ( double ) ( record.timestampUs - firstUs ) * 1e3 / speed );
+            beforeNs = nowNs();
+
+            if( dueNs > beforeNs )
+            {
+                pause.tv_sec = ( time_t ) ( ( dueNs - beforeNs ) / 1000000000U );
+                pause.tv_nsec = ( long ) ( ( dueNs - beforeNs ) % 1000000000U );
+                ( void ) nanosleep( &( pause ), NULL );
+            }
+        }
+
+        beforeNs = nowNs();
+        replayRecord( pReplay, &( record ) );
+        histogramAdd( pLatencies, nowNs() - beforeNs );
+        ( *pRecordCount )++;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+/* Write a synthetic trace. */
+static int generateTrace( const char * pPath,
+                          uint64_t recordCount )
+{
+    DefenderConnectionTable_t connections;
+    DefenderNetworkMetrics_t metrics;
+    uint32_t remoteAddress;
+    uint16_t remotePort, localPort, tcpPort = 443U, topicLength = 0U;
+    uint8_t interfaceId;
+    char thingName[ 16 ], topic[ DEFENDER_API_MAX_LENGTH( 16U ) ], payload[ GENERATED_LENGTH ];
+    uint32_t payloadLength = 0U, state = 2463534242U, i;
+    uint64_t written = 0U, timestampUs = 0U, reportId = 1U, firstThing = 0U;
+    FILE * pFile = fopen( pPath, "wb" );
+    int ret = ( ( pFile == NULL ) || ( traceWriteMagic( pFile ) != 0 ) ) ? -1 : 0;
+
+    ( void ) Defender_ConnectionTableInit( &( connections ), &( remoteAddress ), &( remotePort ), &( localPort ),
+                                           &( interfaceId ), 1U );
+    ( void ) memset( &( metrics ), 0, sizeof( metrics ) );
+    metrics.pConnections = &( connections );
+    metrics.pTcpPorts = &( tcpPort );
+    metrics.tcpPortCount = 1U;
+
+    while( ( ret == 0 ) && ( written < recordCount ) )
+    {
+        /* A batch of reports, then their responses 20 to 200 ms later. */
+        for( i = 0U; ( ret == 0 ) && ( i < GENERATED_BATCH ); i++ )
+        {
+            ( void ) snprintf( thingName, sizeof( thingName ), "thing-%06u",
+                               ( unsigned int ) ( ( firstThing + i ) % GENERATED_THINGS ) );
+            ( void ) Defender_GetTopic( topic, ( uint16_t ) sizeof( topic ), thingName, ( uint16_t ) strlen( thingName ),
+                                        DefenderJsonReportPublish, &( topicLength ) );
+            metrics.stats.bytesIn = reportId * 1000U;
+            metrics.stats.bytesOut = reportId * 500U;
+            ( void ) Defender_SerializeNetworkReport( &( metrics ), reportId + i, payload, sizeof( payload ), &( payloadLength ) );
+            timestampUs += 1U + ( nextRandom( &( state ) ) % 100U );
+            ret = traceWriteRecord( pFile, timestampUs, topic, topicLength, payload, payloadLength );
+
+            if( ( ret == 0 ) && ( ( i % 10U ) == 9U ) )
+            {
+                topicLength = ( uint16_t ) snprintf( topic, sizeof( topic ), "$aws/things/%s/shadow/update/delta", thingName );
+                ret = traceWriteRecord( pFile, timestampUs, topic, topicLength, "{}", 2U );
+                written++;
+            }
+        }
+
+        timestampUs += 20000U + ( nextRandom( &( state ) ) % 180000U );
+
+        for( i = 0U; ( ret == 0 ) && ( i < GENERATED_BATCH ); i++ )
+        {
+            ( void ) snprintf( thingName, sizeof( thingName ), "thing-%06u",
+                               ( unsigned int ) ( ( firstThing + i ) % GENERATED_THINGS ) );
+            ( void ) Defender_GetTopic( topic, ( uint16_t ) sizeof( topic ), thingName, ( uint16_t ) strlen( thingName ),
+                                        ( ( ( reportId + i ) % 50U ) == 0U ) ? DefenderJsonReportRejected : DefenderJsonReportAccepted,
+                                        &( topicLength ) );
+            payloadLength = ( uint32_t ) snprintf( payload, sizeof( payload ),
+                                                   ( ( ( reportId + i ) % 50U ) == 0U ) ?
+                                                   "{\"thingName\":\"%s\",\"reportId\":%" PRIu64 ",\"status\":\"REJECTED\","
+                                                   "\"statusDetails\":{\"ErrorCode\":\"InvalidJson\"},\"timestamp\":%" PRIu64 "}" :
+                                                   "{\"thingName\":\"%s\",\"reportId\":%" PRIu64 ",\"status\":\"ACCEPTED\",\"timestamp\":%" PRIu64 "}",
+                                                   thingName, reportId + i, timestampUs / 1000U );
+            timestampUs += 1U + ( i % 7U );
+            ret = traceWriteRecord( pFile, timestampUs, topic, topicLength, payload, payloadLength );
+        }
+
+        written += 2U * GENERATED_BATCH;
+        reportId += GENERATED_BATCH;
+        firstThing += GENERATED_BATCH;
+    }
+
+    if( ( pFile != NULL ) && ( fclose( pFile ) != 0 ) )
+    {
+        ret = -1;
+    }
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    Replay_t replay;
+    Histogram_t * pLatencies = calloc( 1U, sizeof( Histogram_t ) );
+    uint64_t generateCount = 0U, recordCount = 0U, startNs, elapsedNs;
+    uint32_t loops = 1U, loop;
+    double speed = 0.0;
+    const uint8_t * pTrace = MAP_FAILED;
+    struct stat status;
+    size_t traceLength = 0U;
+    int option, fd = -1, ret = 0;
+
+    ( void ) memset( &( replay ), 0, sizeof( replay ) );
+    replay.capacity = 65536U;
+
+    while( ( option = getopt( argc, argv, "n:rs:c:g:" ) ) != -1 )
+    {
+        if( option == 'n' )
+        {
+            loops = ( uint32_t ) strtoul( optarg, NULL, 10 );
+        }
+        else if( option == 'r' )
+        {
+            speed = ( speed > 0.0 ) ? speed : 1.0;
+        }
+        else if( option == 's' )
+        {
+            speed = strtod( optarg, NULL );
+        }
+        else if( option == 'c' )
+        {
+            replay.capacity = ( uint32_t ) strtoul( optarg, NULL, 10 );
+        }
+        else if( option == 'g' )
+        {
+            generateCount = ( uint64_t ) strtoull( optarg, NULL, 10 );
+        }
+        else
+        {
+            ret = -1;
+        }
+    }
+
+    if( ( ret != 0 ) || ( optind != ( argc - 1 ) ) || ( loops == 0U ) || ( speed < 0.0 ) ||
+        ( replay.capacity == 0U ) || ( replay.capacity > ( 1U << 30 ) ) || ( pLatencies == NULL ) )
+    {
+        fprintf( stderr, "Usage: %s [-n loops] [-r] [-s speed] [-c thing-capacity] trace\n"
+                         "       %s -g record-count trace\n", argv[ 0 ], argv[ 0 ] );
+        ret = -1;
+    }
+    else if( generateCount > 0U )
+    {
+        ret = generateTrace( argv[ optind ], generateCount );
+
+        if( ret != 0 )
+        {
+            fprintf( stderr, "Cannot write %s.\n", argv[ optind ] );
+        }
+    }
+    else
+    {
+        fd = open( argv[ optind ], O_RDONLY );
+
+        if( ( fd >= 0 ) && ( fstat( fd, &( status ) ) == 0 ) && ( status.st_size > 0 ) )
+        {
+            traceLength = ( size_t ) status.st_size;
+            pTrace = mmap( NULL, traceLength, PROT_READ, MAP_PRIVATE, fd, 0 );
+        }
+
+        for( replay.slotCount = 1U; replay.slotCount <= replay.capacity; replay.slotCount *= 2U )
+        {
+        }
+
+        replay.pHot = calloc( replay.capacity, sizeof( DefenderThingHot_t ) );
+        replay.pCold = calloc( replay.capacity, sizeof( DefenderThingCold_t ) );
+        replay.pSlots = calloc( replay.slotCount, sizeof( uint64_t ) );
+        replay.pPublishedUs = calloc( replay.capacity, sizeof( uint64_t ) );
+
+        if( ( pTrace == MAP_FAILED ) || ( traceCheckMagic( pTrace, traceLength ) == 0U ) )
+        {
+            fprintf( stderr, "Cannot read the trace %s.\n", argv[ optind ] );
+            ret = -1;
+        }
+        else if( ( replay.pHot == NULL ) || ( replay.pCold == NULL ) || ( replay.pSlots == NULL ) ||
+                 ( replay.pPublishedUs == NULL ) )
+        {
+            fprintf( stderr, "Out of memory.\n" );
+            ret = -1;
+        }
+        else
+        {
+            /* Empty else: the trace is replayed below. */
+        }
+    }
+
+    if( ( ret == 0 ) && ( generateCount == 0U ) )
+    {
+        ( void ) posix_madvise( ( void * ) pTrace, traceLength, POSIX_MADV_SEQUENTIAL );
+        startNs = nowNs();
+
+        for( loop = 0U; ( ret == 0 ) && ( loop < loops ); loop++ )
+        {
+            ( void ) Defender_ThingStoreInit( &( replay.store ), replay.pHot, replay.pCold, replay.capacity,
+                                              replay.pSlots, replay.slotCount );
+
+            if( replayTrace( &( replay ), pTrace, traceLength, speed, pLatencies, &( recordCount ) ) < 0 )
+            {
+                fprintf( stderr, "The trace is cut short after %" PRIu64 " records.\n", recordCount );
+                ret = -1;
+            }
+
+            /* Only the counters of the first loop are printed, as every loop
+             * does the same work. */
+            if( loop == 0U )
+            {
+                printf( "Records: %" PRIu64 " reports, %" PRIu64 " accepted, %" PRIu64 " rejected, %" PRIu64
+                        " uncorrelated, %" PRIu64 " unparsed, %" PRIu64 " other Defender, %" PRIu64 " other topics, %" PRIu64
+                        " untracked.\n", replay.reports, replay.accepted, replay.rejected, replay.uncorrelated,
+                        replay.unparsed, replay.otherDefender, replay.otherTopics, replay.untracked );
+            }
+        }
+
+        elapsedNs = nowNs() - startNs;
+        printf( "Replayed %" PRIu64 " records in %.3f s: %.0f records/s.\n", recordCount, ( double ) elapsedNs / 1e9,
+                ( double ) recordCount * 1e9 / ( double ) elapsedNs );
+        histogramPrint( "Time per record", "ns", pLatencies );
+        histogramPrint( "Recorded round trip", "us", &( replay.roundTrips ) );
+    }
+
+    if( pTrace != MAP_FAILED )
+    {
+        ( void ) munmap( ( void * ) pTrace, traceLength );
+    }
+
+    if( fd >= 0 )
+    {
+        ( void ) close( fd );
+    }
+
+    free( replay.pHot );
+    free( replay.pCold );
+    free( replay.pSlots );
+    free( replay.pPublishedUs );
+    free( pLatencies );
+
+    return ( ret == 0 ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}